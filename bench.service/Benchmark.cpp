@@ -0,0 +1,167 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#pragma warning(push, 4)
+
+// g_allocations
+//
+// Number of calls made to the global operator new by any thread
+static std::atomic<size_t> g_allocations{ 0 };
+
+// Benchmark::ThreadCounts (static)
+//
+const std::vector<size_t> Benchmark::ThreadCounts = { 1, 2, 4, 8, 16, 32 };
+
+//-----------------------------------------------------------------------------
+// operator new
+//
+// Replaces the global allocation function so that the benchmarks can report the
+// number of heap allocations made per operation
+//
+// Arguments:
+//
+//	size		- Number of bytes to allocate
+
+void* operator new(size_t size)
+{
+	++g_allocations;
+
+	void* block = malloc((size) ? size : 1);
+	if(block == nullptr) throw std::bad_alloc();
+
+	return block;
+}
+
+//-----------------------------------------------------------------------------
+// operator delete
+//
+// Replaces the global deallocation function to match operator new
+//
+// Arguments:
+//
+//	block		- Block allocated by operator new
+
+void operator delete(void* block) noexcept
+{
+	free(block);
+}
+
+//-----------------------------------------------------------------------------
+// Benchmark::Report (private, static)
+//
+// Writes a single benchmark result to the console
+//
+// Arguments:
+//
+//	name		- Benchmark name
+//	threads		- Number of threads that executed the operation
+//	operations	- Total number of operations executed across all threads
+//	ticks		- Elapsed performance counter ticks
+//	allocations	- Number of heap allocations made while executing the operations
+
+void Benchmark::Report(const char* name, size_t threads, size_t operations, int64_t ticks, size_t allocations)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	double seconds = static_cast<double>(ticks) / static_cast<double>(frequency.QuadPart);
+	double nsperop = (operations) ? (seconds * 1000000000.0) / static_cast<double>(operations) : 0.0;
+	double opspersec = (seconds > 0.0) ? static_cast<double>(operations) / seconds : 0.0;
+	double allocsperop = (operations) ? static_cast<double>(allocations) / static_cast<double>(operations) : 0.0;
+
+	printf("%-40s %3zu thread(s) %10zu ops %10.1f ns/op %14.0f ops/s %8.2f allocs/op\n", name, threads, operations, nsperop, opspersec, allocsperop);
+}
+
+//-----------------------------------------------------------------------------
+// Benchmark::Run (static)
+//
+// Executes an operation on the specified number of threads and reports the
+// aggregate throughput.  All threads are created before the clock starts and
+// are released together so that thread creation is not measured
+//
+// Arguments:
+//
+//	name		- Benchmark name
+//	threads		- Number of threads to execute the operation on
+//	iterations	- Number of times each thread executes the operation
+//	operation	- Operation to be executed
+
+void Benchmark::Run(const char* name, size_t threads, size_t iterations, operation_t const& operation)
+{
+	std::vector<std::thread> workers;
+	LARGE_INTEGER start, finish;
+
+	// Create a manual reset event to release all of the worker threads at once
+	HANDLE go = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+	if(go == nullptr) throw std::bad_alloc();
+
+	for(size_t thread = 0; thread < threads; thread++) {
+
+		workers.emplace_back([&, thread]() -> void {
+
+			WaitForSingleObject(go, INFINITE);
+			for(size_t iteration = 0; iteration < iterations; iteration++) operation(thread, iteration);
+		});
+	}
+
+	size_t allocations = g_allocations;
+	QueryPerformanceCounter(&start);
+	SetEvent(go);
+
+	for(auto& worker : workers) worker.join();
+	QueryPerformanceCounter(&finish);
+	allocations = g_allocations - allocations;
+
+	CloseHandle(go);
+	Report(name, threads, threads * iterations, finish.QuadPart - start.QuadPart, allocations);
+}
+
+//-----------------------------------------------------------------------------
+// Benchmark::Time (static)
+//
+// Executes an operation on the calling thread and reports the throughput
+//
+// Arguments:
+//
+//	name		- Benchmark name
+//	iterations	- Number of times to execute the operation
+//	operation	- Operation to be executed
+
+void Benchmark::Time(const char* name, size_t iterations, operation_t const& operation)
+{
+	LARGE_INTEGER start, finish;
+
+	size_t allocations = g_allocations;
+	QueryPerformanceCounter(&start);
+	for(size_t iteration = 0; iteration < iterations; iteration++) operation(0, iteration);
+	QueryPerformanceCounter(&finish);
+	allocations = g_allocations - allocations;
+
+	Report(name, 1, iterations, finish.QuadPart - start.QuadPart, allocations);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
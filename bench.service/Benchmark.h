@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __BENCHMARK_H_
+#define __BENCHMARK_H_
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// Benchmark
+//
+// Timing harness for the service benchmarks.  An operation is executed a fixed
+// number of times on each of a set of threads that are released together, and
+// the aggregate throughput and heap allocations are written to the console
+
+class Benchmark
+{
+public:
+
+	//-------------------------------------------------------------------------
+	// Type Declarations
+
+	// operation_t
+	//
+	// Operation executed by each benchmark thread, receives the zero-based thread
+	// index and the zero-based iteration number
+	using operation_t = std::function<void(size_t thread, size_t iteration)>;
+
+	//-------------------------------------------------------------------------
+	// Fields
+
+	// ThreadCounts
+	//
+	// Thread counts swept by the contention benchmarks
+	static const std::vector<size_t> ThreadCounts;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Run (static)
+	//
+	// Executes an operation on the specified number of threads and reports the throughput
+	static void Run(const char* name, size_t threads, size_t iterations, operation_t const& operation);
+
+	// Time (static)
+	//
+	// Executes an operation on the calling thread and reports the throughput
+	static void Time(const char* name, size_t iterations, operation_t const& operation);
+
+private:
+
+	Benchmark()=delete;
+	~Benchmark()=delete;
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// Report (static)
+	//
+	// Writes a single benchmark result to the console
+	static void Report(const char* name, size_t threads, size_t operations, int64_t ticks, size_t allocations);
+};
+
+//-----------------------------------------------------------------------------
+// Benchmarks
+//
+// Each benchmark is registered by name in the table in main.cpp
+
+// EventPollScaling
+//
+// Waits for a single ready socket among an increasing number of registered sockets
+void EventPollScaling(void);
+
+// FutexContention
+//
+// Acquires a futex-based mutex from an increasing number of threads
+void FutexContention(void);
+
+// HostFileSystemVectored
+//
+// Reads arrays of buffers from a host file with a single host call
+void HostFileSystemVectored(void);
+
+// PathLookupDepth
+//
+// Resolves cached paths of increasing depth through the dentry cache
+void PathLookupDepth(void);
+
+// PathLookupMiss
+//
+// Resolves missing paths with and without exceptions for the failures
+void PathLookupMiss(void);
+
+// PidNamespaceChurn
+//
+// Allocates and releases Pid instances from root and nested namespaces
+void PidNamespaceChurn(void);
+
+// ProcessHandlesFork
+//
+// Duplicates handle collections as fork(2) followed by exit, execve or open
+void ProcessHandlesFork(void);
+
+// ProcessHandlesLookup
+//
+// Looks up file descriptors from a shared handle collection
+void ProcessHandlesLookup(void);
+
+// RootFileSystemPopulate
+//
+// Populates rootfs from a large archive and looks up files from it
+void RootFileSystemPopulate(void);
+
+// TempFileSystemData
+//
+// Appends, reads and sparsely writes tmpfs file data
+void TempFileSystemData(void);
+
+// TempFileSystemFiles
+//
+// Creates and looks up files in a single large tmpfs directory
+void TempFileSystemFiles(void);
+
+// UnixSocketLatency
+//
+// Measures the round trip latency of connected stream and datagram sockets
+void UnixSocketLatency(void);
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __BENCHMARK_H_
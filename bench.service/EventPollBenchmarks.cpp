@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "EventPoll.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+// WAIT_ITERATIONS
+//
+// Number of waits made by each event poll benchmark
+static const size_t WAIT_ITERATIONS = 10000;
+
+//-----------------------------------------------------------------------------
+// EventPollScaling
+//
+// Registers an increasing number of datagram sockets, up to 10,000, and times
+// a wait that finds a single socket ready.  The epoll wait only visits the
+// signaled registration, so its cost should not change with the number of
+// registered sockets.  The same wait made through WaitHandles(), as poll() and
+// select() would, subscribes to and polls every socket and is shown for
+// comparison.  Registering the sockets is timed as well
+//
+// Arguments:
+//
+//	NONE
+
+void EventPollScaling(void)
+{
+	uapi::ucred credentials = { 0, 0, 0 };
+	uint8_t message = 0;
+
+	for(size_t count : { 10, 100, 1000, 10000 }) {
+
+		std::vector<std::pair<std::shared_ptr<UnixSocket>, std::shared_ptr<UnixSocket>>> pairs;
+		for(size_t index = 0; index < count; index++) 
+			pairs.push_back(UnixSocket::CreatePair(LINUX_SOCK_DGRAM, FileSystem::HandleFlags::None, credentials));
+
+		auto epoll = EventPoll::Create(FileSystem::HandleFlags::None);
+		char name[64];
+
+		// epoll_ctl(EPOLL_CTL_ADD)
+		sprintf_s(name, "epoll.add (%zu fds)", count);
+		Benchmark::Time(name, count, [&](size_t, size_t iteration) -> void {
+
+			uapi::epoll_event event = { LINUX_EPOLLIN, iteration };
+			epoll->Add(static_cast<int>(iteration), pairs[iteration].second, event);
+		});
+
+		// epoll_wait with a single ready socket, which is drained before the next wait
+		sprintf_s(name, "epoll.wait (%zu fds)", count);
+		Benchmark::Time(name, WAIT_ITERATIONS, [&](size_t, size_t iteration) -> void {
+
+			auto& pair = pairs[(iteration * 7919) % count];
+			pair.first->Send(&message, sizeof(message), 0, UnixSocket::handlelist_t(), nullptr, 0);
+
+			uapi::epoll_event event;
+			if(epoll->Wait(&event, 1, -1) != 1) throw LinuxException(LINUX_EIO);
+			pairs[static_cast<size_t>(event.data)].second->Receive(&message, sizeof(message), 0, nullptr, nullptr, nullptr);
+		});
+
+		// poll() with a single ready socket; the waits are far slower so fewer are made
+		std::vector<EventPoll::pollitem_t> items;
+		for(auto const& pair : pairs) items.push_back({ pair.second, LINUX_POLLIN, 0 });
+
+		sprintf_s(name, "poll (%zu fds)", count);
+		Benchmark::Time(name, std::max(static_cast<size_t>(10), WAIT_ITERATIONS * 10 / count), [&](size_t, size_t iteration) -> void {
+
+			auto& pair = pairs[(iteration * 7919) % count];
+			pair.first->Send(&message, sizeof(message), 0, UnixSocket::handlelist_t(), nullptr, 0);
+
+			if(EventPoll::WaitHandles(items, -1) != 1) throw LinuxException(LINUX_EIO);
+			pair.second->Receive(&message, sizeof(message), 0, nullptr, nullptr, nullptr);
+		});
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,95 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "Futex.h"
+#include "LinuxException.h"
+
+#pragma warning(push, 4)
+
+// MUTEX_ITERATIONS
+//
+// Number of times that each benchmark thread acquires the mutex
+static const size_t MUTEX_ITERATIONS = 50000;
+
+//-----------------------------------------------------------------------------
+// FutexContention
+//
+// Acquires and releases a single futex-based mutex from 2 to 32 threads.  The
+// mutex is the three state (unlocked, locked, contended) design that glibc uses,
+// so the futex is only waited on and woken when the mutex is contended.  This
+// measures the shared futex wait queues in the service; the process-private
+// futexes are implemented by the host process, whose sys_futex also forwards
+// shared futexes through the sys32_futex RPC client stub and cannot be linked
+// with the service implementation of the same name
+//
+// Arguments:
+//
+//	NONE
+
+void FutexContention(void)
+{
+	std::atomic<uint32_t> word(0);					// Futex word: 0, 1 (locked) or 2 (contended)
+	size_t counter = 0;								// Value protected by the mutex
+	size_t expected = 0;							// Expected value of the counter
+
+	Futex::key_t key = std::make_pair(static_cast<HANDLE>(nullptr), reinterpret_cast<uintptr_t>(&word));
+	Futex::compare_t contended = [&]() -> bool { return word.load() == 2; };
+
+	for(size_t threads : Benchmark::ThreadCounts) {
+
+		if(threads < 2) continue;
+		expected += threads * MUTEX_ITERATIONS;
+
+		Benchmark::Run("futex.mutex", threads, MUTEX_ITERATIONS, [&](size_t, size_t) -> void {
+
+			// Acquire: mark the mutex contended and wait whenever it's already held
+			uint32_t state = 0;
+			if(!word.compare_exchange_strong(state, 1)) {
+
+				if(state != 2) state = word.exchange(2);
+				while(state != 0) {
+
+					// EAGAIN indicates that the word changed before the wait could start
+					try { Futex::Wait(key, LINUX_FUTEX_BITSET_MATCH_ANY, contended, Futex::deadline_t::max()); }
+					catch(LinuxException&) { /* try again */ }
+
+					state = word.exchange(2);
+				}
+			}
+
+			++counter;
+
+			// Release: only a contended mutex needs to wake a waiter
+			if(word.exchange(0) == 2) Futex::Wake(key, 1, LINUX_FUTEX_BITSET_MATCH_ANY);
+		});
+	}
+
+	// The counter is only correct if the mutex provided mutual exclusion
+	if(counter != expected) throw LinuxException(LINUX_EIO);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "FileSystem.h"
+#include "HostFileSystem.h"
+#include "IoEngine.h"
+#include "LinuxException.h"
+#include "Win32Exception.h"
+
+#pragma warning(push, 4)
+
+// BLOCK_COUNT
+//
+// Number of blocks in the file read by the vectored read benchmark
+static const size_t BLOCK_COUNT = 1024;
+
+// BLOCK_LENGTH
+//
+// Length of each block in the file read by the vectored read benchmark
+static const size_t BLOCK_LENGTH = (64 << 10);
+
+// READ_ITERATIONS
+//
+// Number of reads made by each vectored read benchmark
+static const size_t READ_ITERATIONS = 20000;
+
+//-----------------------------------------------------------------------------
+// ReadVectors
+//
+// Reads a 64MiB host file at scattered block offsets into an array of buffers
+// that are not adjacent in memory, as guest iovecs generally are not.  The
+// preadv(2) path through FileSystem::ReadHandleV makes one host call for the
+// entire array, which is verified against the IoEngine completion count.  The
+// same read made one buffer at a time with ReadAt(), as ReadHandleV does for
+// a handle that does not implement ScatterGather, is shown for comparison
+//
+// Arguments:
+//
+//	root		- Host directory to create the benchmark file in
+
+static void ReadVectors(const char_t* root)
+{
+	auto ioengine = IoEngine::Create();
+	auto mount = HostFileSystem::Mount(ioengine, root, 0, nullptr, 0);
+	auto handle = mount->Root->CreateFile(mount, "data", 0644)->Node->Open(mount, FileSystem::HandleAccess::ReadWrite, FileSystem::HandleFlags::None);
+
+	std::vector<uint8_t> block(BLOCK_LENGTH, 0xA5);
+	for(size_t index = 0; index < BLOCK_COUNT; index++) {
+
+		uapi::loff_t offset = static_cast<uapi::loff_t>(index * BLOCK_LENGTH);
+		if(handle->WriteAt(offset, block.data(), BLOCK_LENGTH) != BLOCK_LENGTH) throw LinuxException(LINUX_EIO);
+	}
+
+	for(auto shape : { std::make_pair(8, static_cast<size_t>(512)), std::make_pair(16, static_cast<size_t>(4096)), std::make_pair(16, static_cast<size_t>(BLOCK_LENGTH / 16)) }) {
+
+		int iovcnt = shape.first;
+		size_t length = shape.second;
+
+		// Leave a gap after each buffer so that they cannot be read into directly
+		std::vector<uint8_t> pool(iovcnt * (length + 64));
+		std::vector<uapi::iovec> iov(iovcnt);
+		for(int index = 0; index < iovcnt; index++) iov[index] = { &pool[index * (length + 64)], length };
+
+		size_t total = iovcnt * length;
+		char name[64];
+
+		// preadv(2)
+		uint64_t completed = ioengine->Completed;
+		sprintf_s(name, "hostfs.preadv (%d x %zu bytes)", iovcnt, length);
+		Benchmark::Time(name, READ_ITERATIONS, [&](size_t, size_t iteration) -> void {
+
+			uapi::loff_t offset = static_cast<uapi::loff_t>(((iteration * 7919) % BLOCK_COUNT) * BLOCK_LENGTH);
+			if(FileSystem::ReadHandleV(handle, &offset, iov.data(), iovcnt) != total) throw LinuxException(LINUX_EIO);
+		});
+
+		if(ioengine->Completed - completed != READ_ITERATIONS) throw LinuxException(LINUX_EIO);
+
+		// pread(2) per buffer
+		sprintf_s(name, "hostfs.pread (%d x %zu bytes)", iovcnt, length);
+		Benchmark::Time(name, READ_ITERATIONS, [&](size_t, size_t iteration) -> void {
+
+			uapi::loff_t offset = static_cast<uapi::loff_t>(((iteration * 7919) % BLOCK_COUNT) * BLOCK_LENGTH);
+			for(int index = 0; index < iovcnt; index++) {
+
+				if(handle->ReadAt(offset, iov[index].iov_base, length) != length) throw LinuxException(LINUX_EIO);
+				offset += length;
+			}
+		});
+	}
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystemVectored
+//
+// Times vectored reads from a host file in a temporary directory, which is
+// removed once the benchmark has completed
+//
+// Arguments:
+//
+//	NONE
+
+void HostFileSystemVectored(void)
+{
+	char_t root[MAX_PATH];
+	char_t file[MAX_PATH];
+
+	DWORD length = GetTempPathA(MAX_PATH, root);
+	if((length == 0) || (length >= MAX_PATH)) throw Win32Exception();
+
+	sprintf_s(root + length, MAX_PATH - length, "zuki.bench.%u", GetCurrentProcessId());
+	sprintf_s(file, "%s\\data", root);
+	if(!CreateDirectoryA(root, nullptr)) throw Win32Exception();
+
+	// The mount and handles have to be released before the directory can be removed
+	try { ReadVectors(root); }
+	catch(...) { DeleteFileA(file); RemoveDirectoryA(root); throw; }
+
+	DeleteFileA(file);
+	RemoveDirectoryA(root);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,180 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "FileSystem.h"
+#include "LinuxException.h"
+#include "Namespace.h"
+#include "TempFileSystem.h"
+
+#pragma warning(push, 4)
+
+// LOOKUP_ITERATIONS
+//
+// Number of path lookups made by each benchmark
+static const size_t LOOKUP_ITERATIONS = 1000000;
+
+// MISS_ITERATIONS
+//
+// Number of failed path lookups made by each miss benchmark
+static const size_t MISS_ITERATIONS = 100000;
+
+//-----------------------------------------------------------------------------
+// RootAlias
+//
+// Alias for the root directory of the benchmark file system, the service
+// attaches VirtualMachine::RootAlias to the mounted root file system instead
+
+class RootAlias : public FileSystem::Alias
+{
+public:
+
+	// Instance Constructor
+	//
+	RootAlias(std::shared_ptr<FileSystem::Directory> dir) : m_dir(std::move(dir)) {}
+
+	//-------------------------------------------------------------------------
+	// FileSystem::Alias Implementation
+
+	// GetName
+	//
+	// Reads the name assigned to this alias
+	virtual uapi::size_t GetName(char_t* buffer, size_t count) const
+	{
+		UNREFERENCED_PARAMETER(count);
+
+		if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+		return 0;
+	}
+
+	// getName
+	//
+	// Gets the name assigned to this alias
+	virtual std::string getName(void) const { return std::string(); }
+
+	// getNode
+	//
+	// Gets the node to which this alias refers
+	virtual std::shared_ptr<FileSystem::Node> getNode(void) const { return m_dir; }
+
+private:
+
+	RootAlias(RootAlias const&)=delete;
+	RootAlias& operator=(RootAlias const&)=delete;
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	std::shared_ptr<FileSystem::Directory> const	m_dir;	// Attached directory
+};
+
+//-----------------------------------------------------------------------------
+// PathLookupDepth
+//
+// Resolves paths of increasing depth in a tmpfs instance after the dentry cache
+// has been populated by an initial lookup.  Each component is extracted into a
+// stack buffer and the Path instances come from a slab pool, so the lookups are
+// expected to report zero heap allocations per operation
+//
+// Arguments:
+//
+//	NONE
+
+void PathLookupDepth(void)
+{
+	auto ns = Namespace::Create();
+	auto mount = TempFileSystem::Mount("tmpfs", 0, nullptr, 0);
+	auto root = FileSystem::Path::Create(std::make_shared<RootAlias>(mount->Root), mount);
+
+	std::string path;
+	auto directory = mount->Root;
+
+	for(int depth = 1; depth <= 16; depth++) {
+
+		// Extend the directory tree by one level to reach the next depth
+		char name[32];
+		sprintf_s(name, "dir%d", depth);
+
+		auto alias = directory->CreateDirectory(mount, name, 0755);
+		directory = std::dynamic_pointer_cast<FileSystem::Directory>(alias->Node);
+		path += "/";
+		path += name;
+
+		if((depth & (depth - 1)) != 0) continue;
+
+		// Populate the dentry cache with the path components before timing the lookups
+		FileSystem::LookupPath(ns, root, root, path.c_str(), 0);
+
+		sprintf_s(name, "path.lookup (depth %d)", depth);
+		Benchmark::Time(name, LOOKUP_ITERATIONS, [&](size_t, size_t) -> void {
+
+			auto result = FileSystem::TryLookupPath(ns, root, root, path.c_str(), 0);
+			if(!result) throw LinuxException(result.Code);
+		});
+	}
+}
+
+//-----------------------------------------------------------------------------
+// PathLookupMiss
+//
+// Resolves paths that do not exist, as PATH searches and dynamic loader probing
+// do, through the error-returning TryLookupPath and through LookupPath, which
+// reports the failure by throwing LinuxException.  The difference between them
+// is the cost of raising and unwinding the exception
+//
+// Arguments:
+//
+//	NONE
+
+void PathLookupMiss(void)
+{
+	auto ns = Namespace::Create();
+	auto mount = TempFileSystem::Mount("tmpfs", 0, nullptr, 0);
+	auto root = FileSystem::Path::Create(std::make_shared<RootAlias>(mount->Root), mount);
+
+	// /usr/lib/x86_64-linux-gnu exists, the library being probed for does not
+	auto usr = std::dynamic_pointer_cast<FileSystem::Directory>(mount->Root->CreateDirectory(mount, "usr", 0755)->Node);
+	auto lib = std::dynamic_pointer_cast<FileSystem::Directory>(usr->CreateDirectory(mount, "lib", 0755)->Node);
+	lib->CreateDirectory(mount, "x86_64-linux-gnu", 0755);
+
+	const char_t* path = "/usr/lib/x86_64-linux-gnu/libmissing.so.1";
+
+	Benchmark::Time("path.miss (error code)", MISS_ITERATIONS, [&](size_t, size_t) -> void {
+
+		auto result = FileSystem::TryLookupPath(ns, root, root, path, 0);
+		if(result.Code != LINUX_ENOENT) throw LinuxException(LINUX_EINVAL);
+	});
+
+	Benchmark::Time("path.miss (exception)", MISS_ITERATIONS, [&](size_t, size_t) -> void {
+
+		try { FileSystem::LookupPath(ns, root, root, path, 0); }
+		catch(LinuxException& ex) { if(ex.Code != LINUX_ENOENT) throw; return; }
+
+		throw LinuxException(LINUX_EINVAL);
+	});
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
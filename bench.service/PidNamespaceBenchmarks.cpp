@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "Pid.h"
+#include "PidNamespace.h"
+
+#pragma warning(push, 4)
+
+// PID_ITERATIONS
+//
+// Number of Pid allocations made by each benchmark thread
+static const size_t PID_ITERATIONS = 100000;
+
+//-----------------------------------------------------------------------------
+// PidNamespaceChurn
+//
+// Allocates and immediately releases Pid instances from a root namespace and
+// from a namespace nested two levels deep, which must also allocate a pid_t
+// from each ancestor.  Each thread holds a small working set of live Pids so
+// the bitmap cursor has to skip over allocated values as it does under a
+// fork/exit storm
+//
+// Arguments:
+//
+//	NONE
+
+void PidNamespaceChurn(void)
+{
+	// WORKING_SET
+	//
+	// Number of Pid instances held by each thread at any one time
+	static const size_t WORKING_SET = 16;
+
+	auto root = PidNamespace::Create();
+	auto nested = PidNamespace::Create(PidNamespace::Create(root));
+
+	for(auto const& ns : { root, nested }) {
+
+		const char* name = (ns == root) ? "pid.allocate" : "pid.allocate.nested";
+
+		for(size_t threads : Benchmark::ThreadCounts) {
+
+			// Each thread replaces one slot of its working set per iteration
+			std::vector<std::vector<std::shared_ptr<Pid>>> pids(threads, std::vector<std::shared_ptr<Pid>>(WORKING_SET));
+
+			Benchmark::Run(name, threads, PID_ITERATIONS, [&](size_t thread, size_t iteration) -> void {
+
+				pids[thread][iteration % WORKING_SET] = ns->Allocate();
+			});
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "FileSystem.h"
+#include "ProcessHandles.h"
+#include "TempFileSystem.h"
+
+#pragma warning(push, 4)
+
+// FORK_OPERATIONS
+//
+// Approximate number of file descriptors copied or released by each fork
+// benchmark, the number of iterations is scaled down as the table grows
+static const size_t FORK_OPERATIONS = 4000000;
+
+// LOOKUP_ITERATIONS
+//
+// Number of file descriptor lookups made by each benchmark thread
+static const size_t LOOKUP_ITERATIONS = 1000000;
+
+//-----------------------------------------------------------------------------
+// CreateHandles
+//
+// Creates a handle collection populated with a number of file descriptors, the
+// descriptors all refer to handles against the root of a tmpfs instance
+//
+// Arguments:
+//
+//	count		- Number of file descriptors to allocate
+//	closeonexec	- Flag to set close-on-exec for every other file descriptor
+
+static std::shared_ptr<ProcessHandles> CreateHandles(int count, bool closeonexec)
+{
+	auto mount = TempFileSystem::Mount("tmpfs", 0, nullptr, 0);
+	auto handles = ProcessHandles::Create();
+
+	for(int index = 0; index < count; index++)
+		handles->Add(mount->Root->Open(mount, FileSystem::HandleAccess::ReadOnly, FileSystem::HandleFlags::None), 
+			closeonexec && ((index & 1) == 1));
+
+	return handles;
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandlesFork
+//
+// Duplicates handle collections of increasing size as fork(2) would, with the
+// child then exiting, calling execve(2) or opening another file descriptor.
+// Only the last of these has to copy the shared table
+//
+// Arguments:
+//
+//	NONE
+
+void ProcessHandlesFork(void)
+{
+	for(int count : { 64, 1024, 16384 }) {
+
+		auto parent = CreateHandles(count, true);
+		auto handle = parent->Get(0);
+
+		size_t iterations = std::max(static_cast<size_t>(100), FORK_OPERATIONS / count);
+		char name[64];
+
+		// fork + exit
+		sprintf_s(name, "fd.fork (%d fds)", count);
+		Benchmark::Time(name, iterations, [&](size_t, size_t) -> void {
+
+			auto child = ProcessHandles::Duplicate(parent);
+		});
+
+		// fork + execve
+		sprintf_s(name, "fd.fork.exec (%d fds)", count);
+		Benchmark::Time(name, iterations, [&](size_t, size_t) -> void {
+
+			auto child = ProcessHandles::Duplicate(parent);
+			child->RemoveCloseOnExecute();
+		});
+
+		// fork + open
+		sprintf_s(name, "fd.fork.open (%d fds)", count);
+		Benchmark::Time(name, iterations, [&](size_t, size_t) -> void {
+
+			auto child = ProcessHandles::Duplicate(parent);
+			child->Add(handle);
+		});
+	}
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandlesLookup
+//
+// Looks up file descriptors from a shared handle collection on an increasing
+// number of threads, as the threads of a single process would for read(2) and
+// write(2).  Lookups do not take a lock, so throughput should scale with the
+// number of threads rather than collapse
+//
+// Arguments:
+//
+//	NONE
+
+void ProcessHandlesLookup(void)
+{
+	// FD_COUNT
+	//
+	// Number of file descriptors in the collection
+	static const int FD_COUNT = 256;
+
+	auto handles = CreateHandles(FD_COUNT, false);
+
+	for(size_t threads : Benchmark::ThreadCounts) {
+
+		Benchmark::Run("fd.lookup", threads, LOOKUP_ITERATIONS, [&](size_t thread, size_t iteration) -> void {
+
+			// Stagger the threads so they are not all reading the same slot
+			handles->Get(static_cast<int>((thread * 17 + iteration) % FD_COUNT));
+		});
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,177 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "BufferStreamReader.h"
+#include "CpioArchive.h"
+#include "FileSystem.h"
+#include "LinuxException.h"
+#include "RootFileSystem.h"
+
+#pragma warning(push, 4)
+
+// DIRECTORY_COUNT
+//
+// Number of directories in the benchmark archive
+static const size_t DIRECTORY_COUNT = 500;
+
+// FILES_PER_DIRECTORY
+//
+// Number of regular files in each directory of the benchmark archive
+static const size_t FILES_PER_DIRECTORY = 99;
+
+// FILE_LENGTH
+//
+// Length of the data in each regular file of the benchmark archive
+static const size_t FILE_LENGTH = 256;
+
+// LOOKUP_ITERATIONS
+//
+// Number of lookups made by each benchmark thread
+static const size_t LOOKUP_ITERATIONS = 1000000;
+
+//-----------------------------------------------------------------------------
+// AppendEntry
+//
+// Appends a newc format entry to an in-memory CPIO archive
+//
+// Arguments:
+//
+//	archive		- Archive to append the entry to
+//	path		- Path of the entry
+//	mode		- Type and permissions of the entry
+//	length		- Length of the entry data, which is filled with a pattern
+
+static void AppendEntry(std::vector<char_t>& archive, const char_t* path, uapi::mode_t mode, size_t length)
+{
+	char_t header[sizeof(cpio_header_t) + 1];
+	size_t namesize = strlen(path) + 1;
+
+	sprintf_s(header, "070701%08X%08X%08X%08X%08X%08X%08X%08X%08X%08X%08X%08X%08X", 0, mode, 0, 0, 1, 0, 
+		static_cast<uint32_t>(length), 0, 0, 0, 0, static_cast<uint32_t>(namesize), 0);
+
+	archive.insert(archive.end(), header, header + sizeof(cpio_header_t));
+	archive.insert(archive.end(), path, path + namesize);
+	archive.resize(align::up(archive.size(), 4));
+
+	archive.resize(archive.size() + length, 'x');
+	archive.resize(align::up(archive.size(), 4));
+}
+
+//-----------------------------------------------------------------------------
+// CreateArchive
+//
+// Creates an in-memory CPIO archive with DIRECTORY_COUNT directories each
+// holding FILES_PER_DIRECTORY regular files
+//
+// Arguments:
+//
+//	NONE
+
+static std::vector<char_t> CreateArchive(void)
+{
+	std::vector<char_t> archive;
+	char_t path[64];
+
+	for(size_t dir = 0; dir < DIRECTORY_COUNT; dir++) {
+
+		sprintf_s(path, "dir%zu", dir);
+		AppendEntry(archive, path, LINUX_S_IFDIR | 0755, 0);
+
+		for(size_t file = 0; file < FILES_PER_DIRECTORY; file++) {
+
+			sprintf_s(path, "dir%zu/file%zu", dir, file);
+			AppendEntry(archive, path, LINUX_S_IFREG | 0644, FILE_LENGTH);
+		}
+	}
+
+	AppendEntry(archive, "TRAILER!!!", 0, 0);
+	return archive;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystemPopulate
+//
+// Populates a rootfs instance from a 50,000 entry archive and then looks up
+// randomly selected files from an increasing number of threads.  Directory
+// lookups do not take a lock, so throughput should scale with the threads
+//
+// Arguments:
+//
+//	NONE
+
+void RootFileSystemPopulate(void)
+{
+	// POPULATE_ITERATIONS
+	//
+	// Number of times the archive is loaded into a new file system
+	static const size_t POPULATE_ITERATIONS = 10;
+
+	auto archive = CreateArchive();
+	std::vector<std::shared_ptr<FileSystem::Mount>> mounts;
+
+	// The file systems are kept until the timing is complete so that tearing them
+	// down is not included in the measurement
+	char_t name[64];
+	sprintf_s(name, "rootfs.populate (%zu entries)", DIRECTORY_COUNT * (FILES_PER_DIRECTORY + 1));
+	Benchmark::Time(name, POPULATE_ITERATIONS, [&](size_t, size_t) -> void {
+
+		auto mount = RootFileSystem::Mount("rootfs", 0, nullptr, 0);
+		RootFileSystem::Populate(mount, std::make_unique<BufferStreamReader>(archive.data(), archive.size()));
+		mounts.push_back(std::move(mount));
+	});
+
+	auto mount = mounts.back();
+	mounts.clear();
+
+	// Resolve the directories up front, the lookups are made against the directory nodes
+	// directly so that the dentry cache does not absorb them
+	std::vector<std::shared_ptr<FileSystem::Directory>> directories;
+	for(size_t dir = 0; dir < DIRECTORY_COUNT; dir++) {
+
+		sprintf_s(name, "dir%zu", dir);
+		auto result = mount->Root->Lookup(mount, name);
+		if(!result) throw LinuxException(result.Code);
+
+		directories.push_back(std::dynamic_pointer_cast<FileSystem::Directory>(result.Value->Node));
+	}
+
+	for(size_t threads : Benchmark::ThreadCounts) {
+
+		Benchmark::Run("rootfs.lookup", threads, LOOKUP_ITERATIONS, [&](size_t thread, size_t iteration) -> void {
+
+			size_t index = (thread * 104729 + iteration * 7919) % (DIRECTORY_COUNT * FILES_PER_DIRECTORY);
+
+			char_t file[32];
+			sprintf_s(file, "file%zu", index % FILES_PER_DIRECTORY);
+
+			auto result = directories[index / FILES_PER_DIRECTORY]->Lookup(mount, file);
+			if(!result) throw LinuxException(result.Code);
+		});
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
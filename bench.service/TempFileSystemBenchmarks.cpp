@@ -0,0 +1,127 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "FileSystem.h"
+#include "LinuxException.h"
+#include "TempFileSystem.h"
+
+#pragma warning(push, 4)
+
+// FILE_COUNT
+//
+// Number of files created in a single directory by the file benchmarks
+static const size_t FILE_COUNT = 50000;
+
+// DATA_LENGTH
+//
+// Length of the file written and read by the data benchmarks
+static const size_t DATA_LENGTH = (64 << 20);
+
+//-----------------------------------------------------------------------------
+// TempFileSystemData
+//
+// Appends to, reads back and sparsely writes a tmpfs file with a range of I/O
+// sizes.  Appends and sequential reads should run at memory bandwidth, with the
+// small appends showing that appending does not depend on the file length
+//
+// Arguments:
+//
+//	NONE
+
+void TempFileSystemData(void)
+{
+	auto mount = TempFileSystem::Mount("tmpfs", 0, nullptr, 0);
+	std::vector<uint8_t> buffer(1 << 20, 0xA5);
+
+	for(size_t length : { static_cast<size_t>(100), static_cast<size_t>(4096), static_cast<size_t>(1 << 20) }) {
+
+		char name[64];
+		sprintf_s(name, "data%zu", length);
+
+		auto alias = mount->Root->CreateFile(mount, name, 0644);
+		auto writer = alias->Node->Open(mount, FileSystem::HandleAccess::WriteOnly, FileSystem::HandleFlags::Append);
+		auto reader = alias->Node->Open(mount, FileSystem::HandleAccess::ReadOnly, FileSystem::HandleFlags::None);
+
+		size_t iterations = DATA_LENGTH / length;
+
+		// O_APPEND writes
+		sprintf_s(name, "tmpfs.append (%zu bytes)", length);
+		Benchmark::Time(name, iterations, [&](size_t, size_t) -> void {
+
+			if(writer->Write(buffer.data(), length) != length) throw LinuxException(LINUX_EIO);
+		});
+
+		// Sequential reads of the data written above
+		sprintf_s(name, "tmpfs.read (%zu bytes)", length);
+		Benchmark::Time(name, iterations, [&](size_t, size_t) -> void {
+
+			if(reader->Read(buffer.data(), length) != length) throw LinuxException(LINUX_EIO);
+		});
+	}
+
+	// Single page writes scattered across a 64GiB sparse file, the holes between
+	// them do not consume any pages
+	auto sparse = mount->Root->CreateFile(mount, "sparse", 0644)->Node->Open(mount, FileSystem::HandleAccess::ReadWrite, FileSystem::HandleFlags::None);
+	Benchmark::Time("tmpfs.sparse (4096 bytes)", 16384, [&](size_t, size_t iteration) -> void {
+
+		uapi::loff_t offset = static_cast<uapi::loff_t>((iteration * 7919) % 16384) << 22;
+		if(sparse->WriteAt(offset, buffer.data(), 4096) != 4096) throw LinuxException(LINUX_EIO);
+	});
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystemFiles
+//
+// Creates a large number of files in a single tmpfs directory and then looks
+// them up by name.  The directories are hash indexed, so neither operation
+// should slow down as the directory grows
+//
+// Arguments:
+//
+//	NONE
+
+void TempFileSystemFiles(void)
+{
+	auto mount = TempFileSystem::Mount("tmpfs", 0, nullptr, 0);
+	auto directory = std::dynamic_pointer_cast<FileSystem::Directory>(mount->Root->CreateDirectory(mount, "files", 0755)->Node);
+
+	std::vector<std::string> names;
+	for(size_t index = 0; index < FILE_COUNT; index++) names.push_back("file" + std::to_string(index));
+
+	Benchmark::Time("tmpfs.create", FILE_COUNT, [&](size_t, size_t iteration) -> void {
+
+		directory->CreateFile(mount, names[iteration].c_str(), 0644);
+	});
+
+	Benchmark::Time("tmpfs.lookup", FILE_COUNT * 10, [&](size_t, size_t iteration) -> void {
+
+		auto result = directory->Lookup(mount, names[(iteration * 7919) % FILE_COUNT].c_str());
+		if(!result) throw LinuxException(result.Code);
+	});
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
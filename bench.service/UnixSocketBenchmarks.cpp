@@ -0,0 +1,135 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "LinuxException.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+// ROUNDTRIP_ITERATIONS
+//
+// Number of round trips made by each socket latency benchmark
+static const size_t ROUNDTRIP_ITERATIONS = 100000;
+
+//-----------------------------------------------------------------------------
+// ReceiveAll
+//
+// Receives an exact number of bytes from a socket, a stream socket can return
+// less than was requested if the data was sent in pieces
+//
+// Arguments:
+//
+//	socket		- Socket to receive the data from
+//	buffer		- Output buffer
+//	count		- Number of bytes to receive
+//	handles		- Optional list to receive SCM_RIGHTS handles
+
+static void ReceiveAll(std::shared_ptr<UnixSocket> const& socket, uint8_t* buffer, size_t count, UnixSocket::handlelist_t* handles)
+{
+	size_t received = 0;
+	while(received < count) {
+
+		uapi::size_t result = socket->Receive(buffer + received, count - received, 0, handles, nullptr, nullptr);
+		if(result == 0) throw LinuxException(LINUX_ECONNRESET);
+
+		received += result;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocketLatency
+//
+// Measures the round trip latency of connected socket pairs.  A peer thread
+// echoes every message back to the benchmark thread, so each operation is a
+// send and a blocking receive on both sides and the reported time per operation
+// is the full round trip.  The stream benchmark is repeated with a single
+// SCM_RIGHTS handle attached to each message
+//
+// Arguments:
+//
+//	NONE
+
+void UnixSocketLatency(void)
+{
+	uapi::ucred credentials = { 0, 0, 0 };
+
+	// roundtrip_t
+	//
+	// Describes a single round trip benchmark
+	struct roundtrip_t
+	{
+		int			type;		// LINUX_SOCK_STREAM or LINUX_SOCK_DGRAM
+		size_t		size;		// Size of each message
+		bool		rights;		// Flag to attach an SCM_RIGHTS handle
+	};
+
+	static const roundtrip_t roundtrips[] = {
+
+		{ LINUX_SOCK_STREAM,	1,		false },
+		{ LINUX_SOCK_STREAM,	64,		false },
+		{ LINUX_SOCK_STREAM,	4096,	false },
+		{ LINUX_SOCK_STREAM,	1,		true },
+		{ LINUX_SOCK_DGRAM,		1,		false },
+		{ LINUX_SOCK_DGRAM,		64,		false },
+		{ LINUX_SOCK_DGRAM,		4096,	false },
+	};
+
+	for(auto const& roundtrip : roundtrips) {
+
+		auto pair = UnixSocket::CreatePair(roundtrip.type, FileSystem::HandleFlags::None, credentials);
+		std::vector<uint8_t> message(roundtrip.size), reply(roundtrip.size);
+
+		// The peer thread echoes each message and any handles back to the sender
+		std::thread peer([&]() -> void {
+
+			std::vector<uint8_t> buffer(roundtrip.size);
+			for(size_t iteration = 0; iteration < ROUNDTRIP_ITERATIONS; iteration++) {
+
+				UnixSocket::handlelist_t handles;
+				ReceiveAll(pair.second, buffer.data(), buffer.size(), &handles);
+				pair.second->Send(buffer.data(), buffer.size(), 0, std::move(handles), nullptr, 0);
+			}
+		});
+
+		char name[64];
+		sprintf_s(name, "socket.%s (%zu bytes%s)", (roundtrip.type == LINUX_SOCK_STREAM) ? "stream" : "dgram", 
+			roundtrip.size, (roundtrip.rights) ? ", SCM_RIGHTS" : "");
+
+		Benchmark::Time(name, ROUNDTRIP_ITERATIONS, [&](size_t, size_t) -> void {
+
+			UnixSocket::handlelist_t handles, returned;
+			if(roundtrip.rights) handles.push_back(pair.second);
+
+			pair.first->Send(message.data(), message.size(), 0, std::move(handles), nullptr, 0);
+			ReceiveAll(pair.first, reply.data(), reply.size(), &returned);
+		});
+
+		peer.join();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#pragma warning(push, 4)
+
+// benchmark_t
+//
+// Associates a benchmark name with its entry point
+struct benchmark_t
+{
+	const char*		name;			// Benchmark name
+	void(*entry)(void);				// Benchmark entry point
+};
+
+// g_benchmarks
+//
+// Table of available benchmarks
+static const benchmark_t g_benchmarks[] = {
+
+	{ "epoll",		EventPollScaling },
+	{ "fd.fork",	ProcessHandlesFork },
+	{ "fd.lookup",	ProcessHandlesLookup },
+	{ "futex",		FutexContention },
+	{ "hostfs",		HostFileSystemVectored },
+	{ "path.depth",	PathLookupDepth },
+	{ "path.miss",	PathLookupMiss },
+	{ "pid",		PidNamespaceChurn },
+	{ "rootfs",		RootFileSystemPopulate },
+	{ "socket",		UnixSocketLatency },
+	{ "tmpfs.data",	TempFileSystemData },
+	{ "tmpfs.files",	TempFileSystemFiles },
+};
+
+//-----------------------------------------------------------------------------
+// main
+//
+// Executes the benchmarks named on the command line, or all of the benchmarks
+// if no names were specified.  The benchmarks are not run as part of the build
+// since the results are only meaningful on an otherwise idle release build
+//
+// Arguments:
+//
+//	argc		- Number of command line arguments
+//	argv		- Array of command line argument strings
+
+int main(int argc, char** argv)
+{
+	int executed = 0;
+
+	for(auto const& benchmark : g_benchmarks) {
+
+		bool selected = (argc < 2);
+		for(int index = 1; index < argc; index++) if(strcmp(argv[index], benchmark.name) == 0) selected = true;
+		if(!selected) continue;
+
+		try { benchmark.entry(); ++executed; }
+		catch(std::exception& ex) { fprintf(stderr, "%s: %s\n", benchmark.name, ex.what()); return 1; }
+	}
+
+	if(executed == 0) {
+
+		fprintf(stderr, "usage: %s [benchmark ...]\n\nbenchmarks:\n", argv[0]);
+		for(auto const& benchmark : g_benchmarks) fprintf(stderr, "  %s\n", benchmark.name);
+		return 1;
+	}
+
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
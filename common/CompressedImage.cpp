@@ -0,0 +1,307 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "CompressedImage.h"
+
+#include <algorithm>
+
+#pragma warning(push, 4)
+
+// COMPRESSION_METHOD
+//
+// Used when generating decompression exceptions
+static const tchar_t COMPRESSION_METHOD[] = _T("image");
+
+// MAXIMUM_BLOCK_SHIFT
+//
+// Largest supported data block size, as a power of two (1 MiB)
+static const uint16_t MAXIMUM_BLOCK_SHIFT = 20;
+
+// MINIMUM_BLOCK_SHIFT
+//
+// Smallest supported data block size, as a power of two (4 KiB)
+static const uint16_t MINIMUM_BLOCK_SHIFT = 12;
+
+// TABLE_ALIGNMENT
+//
+// Required alignment of each table within the image
+static const uint64_t TABLE_ALIGNMENT = 8;
+
+//-----------------------------------------------------------------------------
+// CompressedImage Constructor
+//
+// Arguments:
+//
+//	base		- Pointer to the start of the image
+//	length		- Length of the image, in bytes
+//	cacheblocks	- Maximum number of decompressed blocks to cache
+
+CompressedImage::CompressedImage(const void* base, size_t length, size_t cacheblocks) : m_base(reinterpret_cast<const uint8_t*>(base)), 
+	m_length(length), m_header(reinterpret_cast<const image_header_t*>(base)), m_cacheblocks(std::max(cacheblocks, static_cast<size_t>(1)))
+{
+	if(base == nullptr) throw Exception(E_POINTER);
+	if(length < sizeof(image_header_t)) throw Exception(E_DECOMPRESS_TRUNCATED, COMPRESSION_METHOD);
+
+	// Validate the magic number, version and block size from the image header
+	if(m_header->magic != IMAGE_MAGIC) throw Exception(E_DECOMPRESS_BADMAGIC, COMPRESSION_METHOD);
+	if(m_header->version != IMAGE_VERSION) throw Exception(E_DECOMPRESS_BADHEADER, COMPRESSION_METHOD);
+	if((m_header->blockshift < MINIMUM_BLOCK_SHIFT) || (m_header->blockshift > MAXIMUM_BLOCK_SHIFT)) 
+		throw Exception(E_DECOMPRESS_BADHEADER, COMPRESSION_METHOD);
+
+	m_blocksize = static_cast<size_t>(1) << m_header->blockshift;
+
+	// Verify that each table lies within the image; the table entries themselves are
+	// only validated as they are accessed so the cost does not scale with the image
+	CheckTable(m_header->nodetable, m_header->nodecount, sizeof(image_node_t), length);
+	CheckTable(m_header->dirtable, m_header->direntries, sizeof(image_dirent_t), length);
+	CheckTable(m_header->blocktable, m_header->blockcount, sizeof(image_block_t), length);
+	CheckTable(m_header->nametable, m_header->namelength, sizeof(char_t), length);
+
+	if(m_header->rootnode >= m_header->nodecount) throw Exception(E_DECOMPRESS_BADHEADER, COMPRESSION_METHOD);
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImage::CheckTable (private, static)
+//
+// Verifies that a table lies entirely within the image
+//
+// Arguments:
+//
+//	offset		- Offset of the table within the image
+//	count		- Number of entries in the table
+//	entrysize	- Size of each table entry, in bytes
+//	length		- Length of the image, in bytes
+
+void CompressedImage::CheckTable(uint64_t offset, uint64_t count, size_t entrysize, size_t length)
+{
+	if(offset & (TABLE_ALIGNMENT - 1)) throw Exception(E_DECOMPRESS_BADHEADER, COMPRESSION_METHOD);
+	if((offset > length) || (count > ((length - offset) / entrysize))) throw Exception(E_DECOMPRESS_TRUNCATED, COMPRESSION_METHOD);
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImage::GetBlock (private)
+//
+// Gets a decompressed data block, from the cache if possible
+//
+// Arguments:
+//
+//	index		- Index of the block in the block table
+//	entry		- Block table entry
+
+CompressedImage::block_t CompressedImage::GetBlock(uint64_t index, const image_block_t& entry)
+{
+	{
+		std::unique_lock<std::mutex> critsec(m_lock);
+
+		// Move a cached block to the front of the list when it's accessed
+		auto found = m_cachemap.find(index);
+		if(found != m_cachemap.end()) {
+
+			m_cache.splice(m_cache.begin(), m_cache, found->second);
+			return found->second->second;
+		}
+	}
+
+	if((entry.offset > m_length) || (entry.length > (m_length - entry.offset)) || (entry.length > INT32_MAX))
+		throw Exception(E_DECOMPRESS_CORRUPT, COMPRESSION_METHOD);
+
+	// Decompress the block outside of the lock; a block shorter than the block size is zero-filled
+	auto block = std::make_shared<std::vector<uint8_t>>(m_blocksize);
+	int result = LZ4_decompress_safe(reinterpret_cast<const char*>(m_base + entry.offset), reinterpret_cast<char*>(block->data()), 
+		static_cast<int>(entry.length), static_cast<int>(m_blocksize));
+	if(result < 0) throw Exception(E_DECOMPRESS_CORRUPT, COMPRESSION_METHOD);
+
+	std::unique_lock<std::mutex> critsec(m_lock);
+
+	// Another thread may have decompressed and cached the same block in the meantime
+	auto found = m_cachemap.find(index);
+	if(found != m_cachemap.end()) return found->second->second;
+
+	m_cache.emplace_front(index, block);
+	m_cachemap.emplace(index, m_cache.begin());
+
+	// Evict the least recently used blocks to keep the cache within its bounds
+	while(m_cache.size() > m_cacheblocks) {
+
+		m_cachemap.erase(m_cache.back().first);
+		m_cache.pop_back();
+	}
+
+	return block;
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImage::GetDirectoryEntry
+//
+// Accesses an entry of a directory node by index
+//
+// Arguments:
+//
+//	directory	- Directory node table entry
+//	index		- Index of the entry within the directory
+
+const image_dirent_t& CompressedImage::GetDirectoryEntry(const image_node_t& directory, uint64_t index) const
+{
+	if(index >= directory.size) throw Exception(E_BOUNDS);
+
+	// The entries for the directory must lie within the directory table
+	if((directory.start > m_header->direntries) || (directory.size > (m_header->direntries - directory.start)))
+		throw Exception(E_DECOMPRESS_CORRUPT, COMPRESSION_METHOD);
+
+	return reinterpret_cast<const image_dirent_t*>(m_base + m_header->dirtable)[directory.start + index];
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImage::GetName
+//
+// Accesses a string in the name table; the string is not null-terminated
+//
+// Arguments:
+//
+//	offset		- Offset of the string within the name table
+//	length		- Length of the string, in bytes
+
+const char_t* CompressedImage::GetName(uint64_t offset, uint64_t length) const
+{
+	if((offset > m_header->namelength) || (length > (m_header->namelength - offset)))
+		throw Exception(E_DECOMPRESS_CORRUPT, COMPRESSION_METHOD);
+
+	return reinterpret_cast<const char_t*>(m_base + m_header->nametable + offset);
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImage::GetNode
+//
+// Accesses a node table entry by index
+//
+// Arguments:
+//
+//	index		- Index of the node
+
+const image_node_t& CompressedImage::GetNode(uint32_t index) const
+{
+	if(index >= m_header->nodecount) throw Exception(E_DECOMPRESS_CORRUPT, COMPRESSION_METHOD);
+
+	return reinterpret_cast<const image_node_t*>(m_base + m_header->nodetable)[index];
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImage::Lookup
+//
+// Locates the index of a named child of a directory node
+//
+// Arguments:
+//
+//	directory	- Directory node table entry
+//	name		- Name of the child to locate
+//	namelength	- Length of the name, in bytes
+//	index		- Receives the index of the child node
+
+bool CompressedImage::Lookup(const image_node_t& directory, const char_t* name, size_t namelength, uint32_t* index) const
+{
+	uint64_t			low = 0;					// Lower bound of the search
+	uint64_t			high = directory.size;		// Upper bound of the search
+
+	if((name == nullptr) || (index == nullptr)) throw Exception(E_POINTER);
+
+	// Directory entries are sorted by name in byte order, shorter names first
+	while(low < high) {
+
+		uint64_t middle = low + ((high - low) >> 1);
+		auto const& entry = GetDirectoryEntry(directory, middle);
+
+		int result = memcmp(GetName(entry.name, entry.namelength), name, std::min(static_cast<size_t>(entry.namelength), namelength));
+		if(result == 0) result = (entry.namelength < namelength) ? -1 : ((entry.namelength > namelength) ? 1 : 0);
+
+		if(result == 0) { *index = entry.node; return true; }
+
+		if(result < 0) low = middle + 1;
+		else high = middle;
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImage::Read
+//
+// Reads data from a file node
+//
+// Arguments:
+//
+//	file		- File node table entry
+//	offset		- Offset within the file data to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+size_t CompressedImage::Read(const image_node_t& file, uint64_t offset, void* buffer, size_t count)
+{
+	uint8_t*			dest = reinterpret_cast<uint8_t*>(buffer);		// Destination pointer
+
+	if(buffer == nullptr) throw Exception(E_POINTER);
+
+	// Reads that start at or beyond the end of the file return no data
+	if(offset >= file.size) return 0;
+	count = static_cast<size_t>(std::min(static_cast<uint64_t>(count), file.size - offset));
+
+	// The block table entries for the file must lie within the block table
+	uint64_t blocks = (file.size >> m_header->blockshift) + ((file.size & (m_blocksize - 1)) ? 1 : 0);
+	if((file.start > m_header->blockcount) || (blocks > (m_header->blockcount - file.start)))
+		throw Exception(E_DECOMPRESS_CORRUPT, COMPRESSION_METHOD);
+
+	auto table = reinterpret_cast<const image_block_t*>(m_base + m_header->blocktable);
+
+	for(size_t remaining = count; remaining;) {
+
+		uint64_t index = file.start + (offset >> m_header->blockshift);
+		size_t blockoffset = static_cast<size_t>(offset & (m_blocksize - 1));
+		size_t length = std::min(remaining, m_blocksize - blockoffset);
+
+		auto const& entry = table[index];
+
+		// Sparse blocks are not stored in the image
+		if(entry.length == 0) memset(dest, 0, length);
+
+		// Uncompressed blocks are copied directly from the image
+		else if(entry.flags & IMAGE_BLOCK_UNCOMPRESSED) {
+
+			if((entry.offset > m_length) || (entry.length > (m_length - entry.offset)) || ((blockoffset + length) > entry.length))
+				throw Exception(E_DECOMPRESS_CORRUPT, COMPRESSION_METHOD);
+
+			memcpy(dest, m_base + entry.offset + blockoffset, length);
+		}
+
+		// Compressed blocks are decompressed into the block cache
+		else memcpy(dest, GetBlock(index, entry)->data() + blockoffset, length);
+
+		dest += length;
+		offset += length;
+		remaining -= length;
+	}
+
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
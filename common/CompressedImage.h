@@ -0,0 +1,247 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __COMPRESSEDIMAGE_H_
+#define __COMPRESSEDIMAGE_H_
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <lz4.h>
+#include "generic_text.h"
+#include "Exception.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// EXTERNAL DEPENDENCY: LZ4
+//
+// - Add the following files from external\lz4 to the parent project:
+//
+//	lz4.c
+//	lz4.h
+//
+// - Disable precompiled headers for all the above .c files
+// - Add external\lz4 to the project Additional Include Directories
+//-----------------------------------------------------------------------------
+
+// IMAGE_MAGIC
+//
+// Magic number at the start of a compressed image ("VMIF")
+#define IMAGE_MAGIC					0x46494D56
+
+// IMAGE_VERSION
+//
+// Version of the compressed image format described here
+#define IMAGE_VERSION				1
+
+// IMAGE_BLOCK_UNCOMPRESSED
+//
+// Flag indicating that a data block has been stored without compression
+#define IMAGE_BLOCK_UNCOMPRESSED	0x00000001
+
+// image_header_t
+//
+// Compressed image header, located at offset zero of the image
+struct image_header_t {
+
+	uint32_t	magic;					// IMAGE_MAGIC
+	uint16_t	version;				// IMAGE_VERSION
+	uint16_t	blockshift;				// Data block size, as a power of two (12 - 20)
+	uint32_t	nodecount;				// Number of entries in the node table
+	uint32_t	rootnode;				// Index of the root directory node
+	uint64_t	nodetable;				// Offset of the node table
+	uint64_t	direntries;				// Number of entries in the directory table
+	uint64_t	dirtable;				// Offset of the directory table
+	uint64_t	blockcount;				// Number of entries in the block table
+	uint64_t	blocktable;				// Offset of the block table
+	uint64_t	namelength;				// Length of the name table, in bytes
+	uint64_t	nametable;				// Offset of the name table
+};
+
+// image_node_t
+//
+// Compressed image node table entry
+struct image_node_t {
+
+	uint32_t	mode;					// Node type and permissions (S_IFxxx)
+	uint32_t	uid;					// Node owner uid
+	uint32_t	gid;					// Node owner gid
+	uint32_t	nlink;					// Number of links to this node
+	int64_t		mtime;					// Modification time, in seconds since the epoch
+	uint64_t	size;					// File data length, link target length or number of entries
+	uint64_t	start;					// First block, link target name offset or first entry
+	uint32_t	rdev;					// Device number for special file nodes
+	uint32_t	reserved;				// Reserved; must be zero
+};
+
+// image_dirent_t
+//
+// Compressed image directory table entry; the entries of each directory are
+// stored contiguously and are sorted by name (byte order) to allow binary search
+struct image_dirent_t {
+
+	uint32_t	node;					// Index of the referenced node
+	uint32_t	namelength;				// Length of the entry name, in bytes
+	uint64_t	name;					// Offset of the entry name in the name table
+};
+
+// image_block_t
+//
+// Compressed image block table entry; the blocks of each file are contiguous
+struct image_block_t {
+
+	uint64_t	offset;					// Offset of the block data
+	uint32_t	length;					// Stored length of the block data, zero if sparse
+	uint32_t	flags;					// Block flags (IMAGE_BLOCK_xxx)
+};
+
+//-----------------------------------------------------------------------------
+// CompressedImage
+//
+// Random-access reader for a block-compressed file system image.  The image is
+// a flat set of tables (nodes, directory entries, blocks and names) followed by
+// the file data, which is split into fixed-size blocks that are individually
+// compressed with LZ4.  The tables are accessed in place, only file data blocks
+// are decompressed, and only when they are read.  The decompressed blocks are
+// kept in a bounded least-recently-used cache.
+//
+// All values in the image are little-endian; the reader does not depend on any
+// platform services other than the standard library and LZ4.  Images are built
+// with CompressedImageWriter.
+
+class CompressedImage
+{
+public:
+
+	// Instance Constructor
+	//
+	CompressedImage(const void* base, size_t length, size_t cacheblocks);
+
+	// Destructor
+	//
+	~CompressedImage()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// GetDirectoryEntry
+	//
+	// Accesses an entry of a directory node by index
+	const image_dirent_t& GetDirectoryEntry(const image_node_t& directory, uint64_t index) const;
+
+	// GetName
+	//
+	// Accesses a string in the name table; the string is not null-terminated
+	const char_t* GetName(uint64_t offset, uint64_t length) const;
+
+	// GetNode
+	//
+	// Accesses a node table entry by index
+	const image_node_t& GetNode(uint32_t index) const;
+
+	// Lookup
+	//
+	// Locates the index of a named child of a directory node
+	bool Lookup(const image_node_t& directory, const char_t* name, size_t namelength, uint32_t* index) const;
+
+	// Read
+	//
+	// Reads data from a file node
+	size_t Read(const image_node_t& file, uint64_t offset, void* buffer, size_t count);
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// BlockSize
+	//
+	// Gets the size of a file data block
+	__declspec(property(get=getBlockSize)) size_t BlockSize;
+	size_t getBlockSize(void) const { return m_blocksize; }
+
+	// Length
+	//
+	// Gets the length of the image
+	__declspec(property(get=getLength)) size_t Length;
+	size_t getLength(void) const { return m_length; }
+
+	// NodeCount
+	//
+	// Gets the number of nodes in the image
+	__declspec(property(get=getNodeCount)) uint32_t NodeCount;
+	uint32_t getNodeCount(void) const { return m_header->nodecount; }
+
+	// RootNode
+	//
+	// Gets the index of the root directory node
+	__declspec(property(get=getRootNode)) uint32_t RootNode;
+	uint32_t getRootNode(void) const { return m_header->rootnode; }
+
+private:
+
+	CompressedImage(const CompressedImage&)=delete;
+	CompressedImage& operator=(const CompressedImage&)=delete;
+
+	// block_t
+	//
+	// Decompressed data block
+	using block_t = std::shared_ptr<const std::vector<uint8_t>>;
+
+	// cache_t
+	//
+	// Decompressed block cache, ordered from most to least recently used
+	using cache_t = std::list<std::pair<uint64_t, block_t>>;
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// CheckTable (static)
+	//
+	// Verifies that a table lies entirely within the image
+	static void CheckTable(uint64_t offset, uint64_t count, size_t entrysize, size_t length);
+
+	// GetBlock
+	//
+	// Gets a decompressed data block, from the cache if possible
+	block_t GetBlock(uint64_t index, const image_block_t& entry);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	const uint8_t*							m_base;			// Base pointer of the image
+	const size_t							m_length;		// Length of the image
+	const image_header_t*					m_header;		// Image header
+	size_t									m_blocksize;	// Data block size
+	cache_t									m_cache;		// Decompressed block cache
+	std::unordered_map<uint64_t, cache_t::iterator>	m_cachemap;	// Cache index
+	const size_t							m_cacheblocks;	// Maximum cached blocks
+	std::mutex								m_lock;			// Cache synchronization
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __COMPRESSEDIMAGE_H_
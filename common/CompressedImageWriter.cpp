@@ -0,0 +1,340 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "CompressedImageWriter.h"
+
+#include <algorithm>
+#include <linux/stat.h>
+
+#pragma warning(push, 4)
+
+// MAXIMUM_BLOCK_SHIFT
+//
+// Largest supported data block size, as a power of two (1 MiB)
+static const uint16_t MAXIMUM_BLOCK_SHIFT = 20;
+
+// MINIMUM_BLOCK_SHIFT
+//
+// Smallest supported data block size, as a power of two (4 KiB)
+static const uint16_t MINIMUM_BLOCK_SHIFT = 12;
+
+// TABLE_ALIGNMENT
+//
+// Required alignment of each table within the image
+static const uint64_t TABLE_ALIGNMENT = 8;
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter Constructor
+//
+// Arguments:
+//
+//	blockshift	- Data block size, as a power of two (12 - 20)
+
+CompressedImageWriter::CompressedImageWriter(uint16_t blockshift) : m_blockshift(blockshift)
+{
+	if((blockshift < MINIMUM_BLOCK_SHIFT) || (blockshift > MAXIMUM_BLOCK_SHIFT)) throw Exception(E_INVALIDARG);
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter::AddDirectory
+//
+// Adds a directory node to the image
+//
+// Arguments:
+//
+//	permissions	- Node permissions
+//	uid			- Node owner uid
+//	gid			- Node owner gid
+//	mtime		- Modification time, in seconds since the epoch
+
+uint32_t CompressedImageWriter::AddDirectory(uint32_t permissions, uint32_t uid, uint32_t gid, int64_t mtime)
+{
+	return AddNode(LINUX_S_IFDIR | (permissions & ~LINUX_S_IFMT), uid, gid, mtime);
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter::AddFile
+//
+// Adds a regular file node to the image
+//
+// Arguments:
+//
+//	permissions	- Node permissions
+//	uid			- Node owner uid
+//	gid			- Node owner gid
+//	mtime		- Modification time, in seconds since the epoch
+//	data		- File data
+//	length		- Length of the file data, in bytes
+
+uint32_t CompressedImageWriter::AddFile(uint32_t permissions, uint32_t uid, uint32_t gid, int64_t mtime, const void* data, size_t length)
+{
+	if((data == nullptr) && (length > 0)) throw Exception(E_POINTER);
+
+	uint32_t index = AddNode(LINUX_S_IFREG | (permissions & ~LINUX_S_IFMT), uid, gid, mtime);
+
+	auto source = reinterpret_cast<const uint8_t*>(data);
+	m_nodes[index].data.assign(source, source + length);
+
+	return index;
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter::AddNode (private)
+//
+// Adds a new node to the image
+//
+// Arguments:
+//
+//	mode		- Node type and permissions
+//	uid			- Node owner uid
+//	gid			- Node owner gid
+//	mtime		- Modification time, in seconds since the epoch
+
+uint32_t CompressedImageWriter::AddNode(uint32_t mode, uint32_t uid, uint32_t gid, int64_t mtime)
+{
+	if(m_nodes.size() >= UINT32_MAX) throw Exception(E_BOUNDS);
+
+	node_t node = {};
+	node.entry.mode = mode;
+	node.entry.uid = uid;
+	node.entry.gid = gid;
+	node.entry.mtime = mtime;
+
+	m_nodes.push_back(std::move(node));
+	return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter::AddSpecialFile
+//
+// Adds a device, fifo or socket node to the image
+//
+// Arguments:
+//
+//	mode		- Node type and permissions
+//	uid			- Node owner uid
+//	gid			- Node owner gid
+//	mtime		- Modification time, in seconds since the epoch
+//	rdev		- Device number
+
+uint32_t CompressedImageWriter::AddSpecialFile(uint32_t mode, uint32_t uid, uint32_t gid, int64_t mtime, uint32_t rdev)
+{
+	switch(mode & LINUX_S_IFMT) {
+
+		case LINUX_S_IFBLK: case LINUX_S_IFCHR: case LINUX_S_IFIFO: case LINUX_S_IFSOCK: break;
+		default: throw Exception(E_INVALIDARG);
+	}
+
+	uint32_t index = AddNode(mode, uid, gid, mtime);
+	m_nodes[index].entry.rdev = rdev;
+
+	return index;
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter::AddSymbolicLink
+//
+// Adds a symbolic link node to the image
+//
+// Arguments:
+//
+//	permissions	- Node permissions
+//	uid			- Node owner uid
+//	gid			- Node owner gid
+//	mtime		- Modification time, in seconds since the epoch
+//	target		- Symbolic link target
+
+uint32_t CompressedImageWriter::AddSymbolicLink(uint32_t permissions, uint32_t uid, uint32_t gid, int64_t mtime, const char_t* target)
+{
+	if(target == nullptr) throw Exception(E_POINTER);
+	if(*target == 0) throw Exception(E_INVALIDARG);
+
+	uint32_t index = AddNode(LINUX_S_IFLNK | (permissions & ~LINUX_S_IFMT), uid, gid, mtime);
+	m_nodes[index].data.assign(target, target + strlen(target));
+
+	return index;
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter::Link
+//
+// Adds a named entry for a node to a directory node
+//
+// Arguments:
+//
+//	directory	- Index of the directory node
+//	name		- Name of the directory entry
+//	node		- Index of the node to be linked
+
+void CompressedImageWriter::Link(uint32_t directory, const char_t* name, uint32_t node)
+{
+	if(name == nullptr) throw Exception(E_POINTER);
+	if((directory >= m_nodes.size()) || (node >= m_nodes.size())) throw Exception(E_BOUNDS);
+	if((m_nodes[directory].entry.mode & LINUX_S_IFMT) != LINUX_S_IFDIR) throw Exception(E_INVALIDARG);
+
+	// The name must be a single path component and must not already exist in the directory
+	std::string entry{ name };
+	if(entry.empty() || (entry == ".") || (entry == "..") || (entry.find('/') != std::string::npos)) throw Exception(E_INVALIDARG);
+	if(!m_nodes[directory].children.emplace(std::move(entry), node).second) throw Exception(E_INVALIDARG);
+}
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter::Write
+//
+// Generates the image
+//
+// Arguments:
+//
+//	root		- Index of the root directory node
+
+std::vector<uint8_t> CompressedImageWriter::Write(uint32_t root) const
+{
+	image_header_t					header = {};		// Image header
+	std::vector<image_node_t>		nodes;				// Node table
+	std::vector<image_dirent_t>		dirents;			// Directory table
+	std::vector<image_block_t>		blocks;				// Block table
+	std::string						names;				// Name table
+	std::vector<uint8_t>			data;				// File data
+
+	if(root >= m_nodes.size()) throw Exception(E_BOUNDS);
+	if((m_nodes[root].entry.mode & LINUX_S_IFMT) != LINUX_S_IFDIR) throw Exception(E_INVALIDARG);
+
+	size_t blocksize = static_cast<size_t>(1) << m_blockshift;
+	std::vector<char> compressed(LZ4_compressBound(static_cast<int>(blocksize)));
+
+	// Directories are linked by their entries and by their own entry for '.'; each subdirectory
+	// links back to its parent through '..'.  Other nodes are linked once for each entry
+	std::vector<uint32_t> links(m_nodes.size(), 0);
+	for(size_t index = 0; index < m_nodes.size(); index++) {
+
+		if((m_nodes[index].entry.mode & LINUX_S_IFMT) == LINUX_S_IFDIR) links[index]++;
+		for(auto const& child : m_nodes[index].children) {
+
+			links[child.second]++;
+			if((m_nodes[child.second].entry.mode & LINUX_S_IFMT) == LINUX_S_IFDIR) links[index]++;
+		}
+	}
+	links[root]++;
+
+	for(size_t index = 0; index < m_nodes.size(); index++) {
+
+		auto const& node = m_nodes[index];
+		image_node_t entry = node.entry;
+		entry.nlink = std::max(links[index], 1U);
+
+		switch(entry.mode & LINUX_S_IFMT) {
+
+			// Directory entries are stored contiguously and are already sorted by name
+			case LINUX_S_IFDIR:
+
+				entry.start = dirents.size();
+				entry.size = node.children.size();
+
+				for(auto const& child : node.children) {
+
+					dirents.push_back(image_dirent_t{ child.second, static_cast<uint32_t>(child.first.length()), names.length() });
+					names.append(child.first);
+				}
+				break;
+
+			// Symbolic link targets are stored in the name table
+			case LINUX_S_IFLNK:
+
+				entry.start = names.length();
+				entry.size = node.data.size();
+				names.append(node.data.begin(), node.data.end());
+				break;
+
+			// Regular file data is split into blocks; block offsets are relative to the start
+			// of the file data until the location of the file data has been determined
+			case LINUX_S_IFREG:
+
+				entry.start = blocks.size();
+				entry.size = node.data.size();
+
+				for(size_t offset = 0; offset < node.data.size(); offset += blocksize) {
+
+					const uint8_t* source = node.data.data() + offset;
+					size_t length = std::min(blocksize, node.data.size() - offset);
+
+					// Blocks that contain only zeros are not stored
+					if(std::all_of(source, source + length, [](uint8_t value) { return value == 0; })) {
+
+						blocks.push_back(image_block_t{ 0, 0, 0 });
+						continue;
+					}
+
+					int result = LZ4_compress_default(reinterpret_cast<const char*>(source), compressed.data(), static_cast<int>(length), 
+						static_cast<int>(compressed.size()));
+
+					// Blocks that do not become smaller when compressed are stored uncompressed
+					if((result <= 0) || (static_cast<size_t>(result) >= length)) {
+
+						blocks.push_back(image_block_t{ data.size(), static_cast<uint32_t>(length), IMAGE_BLOCK_UNCOMPRESSED });
+						data.insert(data.end(), source, source + length);
+					}
+
+					else {
+
+						blocks.push_back(image_block_t{ data.size(), static_cast<uint32_t>(result), 0 });
+						data.insert(data.end(), compressed.data(), compressed.data() + result);
+					}
+				}
+				break;
+		}
+
+		nodes.push_back(entry);
+	}
+
+	// Generate the image header; each table is aligned and the file data follows the name table
+	header.magic = IMAGE_MAGIC;
+	header.version = IMAGE_VERSION;
+	header.blockshift = m_blockshift;
+	header.nodecount = static_cast<uint32_t>(nodes.size());
+	header.rootnode = root;
+	header.nodetable = align::up(static_cast<uint64_t>(sizeof(image_header_t)), TABLE_ALIGNMENT);
+	header.direntries = dirents.size();
+	header.dirtable = align::up(header.nodetable + (nodes.size() * sizeof(image_node_t)), TABLE_ALIGNMENT);
+	header.blockcount = blocks.size();
+	header.blocktable = align::up(header.dirtable + (dirents.size() * sizeof(image_dirent_t)), TABLE_ALIGNMENT);
+	header.namelength = names.length();
+	header.nametable = align::up(header.blocktable + (blocks.size() * sizeof(image_block_t)), TABLE_ALIGNMENT);
+
+	uint64_t dataoffset = align::up(header.nametable + names.length(), TABLE_ALIGNMENT);
+	for(auto& block : blocks) if(block.length) block.offset += dataoffset;
+
+	std::vector<uint8_t> image(static_cast<size_t>(dataoffset + data.size()), 0);
+
+	memcpy(image.data(), &header, sizeof(image_header_t));
+	if(!nodes.empty()) memcpy(&image[static_cast<size_t>(header.nodetable)], nodes.data(), nodes.size() * sizeof(image_node_t));
+	if(!dirents.empty()) memcpy(&image[static_cast<size_t>(header.dirtable)], dirents.data(), dirents.size() * sizeof(image_dirent_t));
+	if(!blocks.empty()) memcpy(&image[static_cast<size_t>(header.blocktable)], blocks.data(), blocks.size() * sizeof(image_block_t));
+	if(!names.empty()) memcpy(&image[static_cast<size_t>(header.nametable)], names.data(), names.length());
+	if(!data.empty()) memcpy(&image[static_cast<size_t>(dataoffset)], data.data(), data.size());
+
+	return image;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __COMPRESSEDIMAGEWRITER_H_
+#define __COMPRESSEDIMAGEWRITER_H_
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "CompressedImage.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// CompressedImageWriter
+//
+// Builds a block-compressed file system image that can be read with the
+// CompressedImage class.  Nodes are added individually and are then linked
+// into their parent directories by name; the complete image is generated in
+// memory by Write().
+//
+// File data is split into fixed-size blocks.  Blocks that contain only zeros
+// are stored as sparse blocks, blocks that do not become smaller when they are
+// compressed with LZ4 are stored without compression.
+
+class CompressedImageWriter
+{
+public:
+
+	// Instance Constructor
+	//
+	explicit CompressedImageWriter(uint16_t blockshift);
+
+	// Destructor
+	//
+	~CompressedImageWriter()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// AddDirectory
+	//
+	// Adds a directory node to the image
+	uint32_t AddDirectory(uint32_t permissions, uint32_t uid, uint32_t gid, int64_t mtime);
+
+	// AddFile
+	//
+	// Adds a regular file node to the image
+	uint32_t AddFile(uint32_t permissions, uint32_t uid, uint32_t gid, int64_t mtime, const void* data, size_t length);
+
+	// AddSpecialFile
+	//
+	// Adds a device, fifo or socket node to the image
+	uint32_t AddSpecialFile(uint32_t mode, uint32_t uid, uint32_t gid, int64_t mtime, uint32_t rdev);
+
+	// AddSymbolicLink
+	//
+	// Adds a symbolic link node to the image
+	uint32_t AddSymbolicLink(uint32_t permissions, uint32_t uid, uint32_t gid, int64_t mtime, const char_t* target);
+
+	// Link
+	//
+	// Adds a named entry for a node to a directory node
+	void Link(uint32_t directory, const char_t* name, uint32_t node);
+
+	// Write
+	//
+	// Generates the image
+	std::vector<uint8_t> Write(uint32_t root) const;
+
+private:
+
+	CompressedImageWriter(const CompressedImageWriter&)=delete;
+	CompressedImageWriter& operator=(const CompressedImageWriter&)=delete;
+
+	// node_t
+	//
+	// Node being written to the image
+	struct node_t {
+
+		image_node_t						entry;		// Node table entry
+		std::vector<uint8_t>				data;		// File data or link target
+		std::map<std::string, uint32_t>		children;	// Directory entries, sorted by name
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// AddNode
+	//
+	// Adds a new node to the image
+	uint32_t AddNode(uint32_t mode, uint32_t uid, uint32_t gid, int64_t mtime);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	const uint16_t							m_blockshift;	// Data block size, as a power of two
+	std::vector<node_t>						m_nodes;		// Node table
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __COMPRESSEDIMAGEWRITER_H_
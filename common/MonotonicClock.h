@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __MONOTONICCLOCK_H_
+#define __MONOTONICCLOCK_H_
+#pragma once
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// MonotonicClock
+//
+// Source of the virtual machine's CLOCK_MONOTONIC.  The unbiased interrupt time
+// counts 100ns intervals since the system was started and, like CLOCK_MONOTONIC
+// on Linux, does not advance while the system is suspended.  The host and the
+// service both read the clock from here so that deadlines agree with each other
+// and with the times reported by clock_gettime(2)
+
+class MonotonicClock
+{
+public:
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Now (static)
+	//
+	// Gets the current CLOCK_MONOTONIC time in nanoseconds
+	static uint64_t Now(void)
+	{
+		ULONGLONG interrupttime;
+		QueryUnbiasedInterruptTime(&interrupttime);
+
+		return static_cast<uint64_t>(interrupttime) * 100;
+	}
+
+private:
+
+	MonotonicClock()=delete;
+	~MonotonicClock()=delete;
+	MonotonicClock(MonotonicClock const&)=delete;
+	MonotonicClock& operator=(MonotonicClock const&)=delete;
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __MONOTONICCLOCK_H_
@@ -72,6 +72,7 @@ NTAPI_FUNCTION(NtFreeVirtualMemory)
 NTAPI_FUNCTION(NtLockVirtualMemory)
 NTAPI_FUNCTION(NtMapViewOfSection)
 NTAPI_FUNCTION(NtProtectVirtualMemory)
+NTAPI_FUNCTION(NtQueryDirectoryFile)
 NTAPI_FUNCTION(NtReadVirtualMemory)
 NTAPI_FUNCTION(NtResumeProcess)
 NTAPI_FUNCTION(NtSuspendProcess)
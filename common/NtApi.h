@@ -41,6 +41,34 @@ public:
 	//-------------------------------------------------------------------------
 	// Type Declarations
 
+	// FILE_ID_BOTH_DIR_INFORMATION
+	//
+	// NTAPI structure not defined in the standard Win32 user-mode headers
+	typedef struct _FILE_ID_BOTH_DIR_INFORMATION {
+
+		ULONG			NextEntryOffset;
+		ULONG			FileIndex;
+		LARGE_INTEGER	CreationTime;
+		LARGE_INTEGER	LastAccessTime;
+		LARGE_INTEGER	LastWriteTime;
+		LARGE_INTEGER	ChangeTime;
+		LARGE_INTEGER	EndOfFile;
+		LARGE_INTEGER	AllocationSize;
+		ULONG			FileAttributes;
+		ULONG			FileNameLength;
+		ULONG			EaSize;
+		CCHAR			ShortNameLength;
+		WCHAR			ShortName[12];
+		LARGE_INTEGER	FileId;
+		WCHAR			FileName[1];
+
+	} FILE_ID_BOTH_DIR_INFORMATION, *PFILE_ID_BOTH_DIR_INFORMATION;
+
+	// FileIdBothDirectoryInformation
+	//
+	// NTAPI FILE_INFORMATION_CLASS constant not defined in the standard Win32 user-mode headers
+	static const FILE_INFORMATION_CLASS FileIdBothDirectoryInformation = static_cast<FILE_INFORMATION_CLASS>(37);
+
 	// DUPLICATE_SAME_ATTRIBUTES
 	//
 	// NTAPI constant not defined in the standard Win32 user-mode headers
@@ -84,6 +112,11 @@ public:
 	static const SECTION_INHERIT ViewShare = 1;
 	static const SECTION_INHERIT ViewUnmap = 2;
 
+	// STATUS_NO_MORE_FILES
+	//
+	// NTAPI constant not defined in the standard Win32 user-mode headers
+	static const NTSTATUS STATUS_NO_MORE_FILES = static_cast<NTSTATUS>(0x80000006L);
+
 	// STATUS_SUCCESS
 	//
 	// NTAPI constant not defined in the standard Win32 user-mode headers
@@ -100,6 +133,7 @@ public:
 	using NtLockVirtualMemoryFunc			= NTSTATUS(NTAPI*)(HANDLE, PVOID*, PSIZE_T, ULONG);
 	using NtMapViewOfSectionFunc			= NTSTATUS(NTAPI*)(HANDLE, HANDLE, PVOID*, ULONG_PTR, SIZE_T, PLARGE_INTEGER, PSIZE_T, SECTION_INHERIT, ULONG, ULONG);
 	using NtProtectVirtualMemoryFunc		= NTSTATUS(NTAPI*)(HANDLE, PVOID*, PSIZE_T, ULONG, PULONG);
+	using NtQueryDirectoryFileFunc			= NTSTATUS(NTAPI*)(HANDLE, HANDLE, PIO_APC_ROUTINE, PVOID, PIO_STATUS_BLOCK, PVOID, ULONG, FILE_INFORMATION_CLASS, BOOLEAN, PUNICODE_STRING, BOOLEAN);
 	using NtReadVirtualMemoryFunc			= NTSTATUS(NTAPI*)(HANDLE, LPCVOID, PVOID, SIZE_T, PSIZE_T);
 	using NtResumeProcessFunc				= NTSTATUS(NTAPI*)(HANDLE);
 	using NtSuspendProcessFunc				= NTSTATUS(NTAPI*)(HANDLE);
@@ -143,6 +177,7 @@ public:
 	static const NtLockVirtualMemoryFunc			NtLockVirtualMemory;
 	static const NtMapViewOfSectionFunc				NtMapViewOfSection;
 	static const NtProtectVirtualMemoryFunc			NtProtectVirtualMemory;
+	static const NtQueryDirectoryFileFunc			NtQueryDirectoryFile;
 	static const NtReadVirtualMemoryFunc			NtReadVirtualMemory;
 	static const NtResumeProcessFunc				NtResumeProcess;
 	static const NtSuspendProcessFunc				NtSuspendProcess;
@@ -0,0 +1,305 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __PIPERING_H_
+#define __PIPERING_H_
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#pragma warning(push, 4)				
+
+//-----------------------------------------------------------------------------
+// PipeRing
+//
+// Implements a lock-free single-producer/single-consumer byte ring that lives
+// in a block of memory shared between processes.  The control structure is
+// placed at the start of the block and the data area immediately follows it;
+// PipeRing itself only holds pointers into that block, so each process that
+// maps the block attaches its own instance to the same ring.
+//
+// Data is transferred with a plain memcpy into or out of the ring, the only
+// synchronization is a release store of the producer or consumer position.
+// Positions are free-running 32-bit counters; the capacity is a power of two
+// so they are reduced to an index with a mask and wrap around naturally.
+//
+// Blocking is left to the caller.  A side that is about to wait announces it
+// with PrepareReadWait/PrepareWriteWait and must then re-check the ring before
+// it actually sleeps; the opposite side calls ConsumeReadWait/ConsumeWriteWait
+// after it moves its position and wakes the waiter if that returns true.
+//
+// Notes:
+//
+//	- Only one thread may act as the producer and one as the consumer at any
+//	  given time; callers that share an end must serialize access to it.
+//
+//	- The control structure only uses fixed-size types and address-free
+//	  atomics so the layout is identical for 32 and 64-bit processes.
+//
+//	- The positions are not trusted; a ring whose positions are further apart
+//	  than the capacity reads as empty and full rather than overrunning the
+//	  data area.
+
+class PipeRing
+{
+public:
+
+	// Instance Constructor
+	//
+	// Attaches to a ring that has already been initialized in a memory block
+	explicit PipeRing(void* base) : m_ring(reinterpret_cast<ring_t*>(base)), 
+		m_data(reinterpret_cast<uint8_t*>(base) + sizeof(ring_t)), m_mask(m_ring->capacity - 1) { }
+
+	// Destructor
+	//
+	~PipeRing()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// AddReader / AddWriter
+	//
+	// Increments the number of open read or write ends of the ring
+	void AddReader(void) { m_ring->readers.fetch_add(1); }
+	void AddWriter(void) { m_ring->writers.fetch_add(1); }
+
+	// ConsumeReadWait
+	//
+	// Called by the producer after writing; indicates if the consumer needs to be woken
+	bool ConsumeReadWait(void) { return (m_ring->readwait.load() != 0) && (m_ring->readwait.exchange(0) != 0); }
+
+	// ConsumeWriteWait
+	//
+	// Called by the consumer after reading; indicates if the producer needs to be woken
+	bool ConsumeWriteWait(void) { return (m_ring->writewait.load() != 0) && (m_ring->writewait.exchange(0) != 0); }
+
+	// Initialize (static)
+	//
+	// Initializes a ring in a memory block, the data area is the largest power of two that fits
+	static size_t Initialize(void* base, size_t length)
+	{
+		if((base == nullptr) || (length < sizeof(ring_t) + MinimumCapacity)) return 0;
+
+		// Determine the largest power of two capacity that will fit in the block
+		size_t capacity = MinimumCapacity;
+		while((capacity << 1) <= (length - sizeof(ring_t)) && (capacity << 1) <= MaximumCapacity) capacity <<= 1;
+
+		ring_t* ring = new(base) ring_t;
+		ring->capacity = static_cast<uint32_t>(capacity);
+
+		return capacity;
+	}
+
+	// Peek
+	//
+	// Consumer: copies up to count bytes out of the ring without releasing them
+	size_t Peek(void* buffer, size_t count) const
+	{
+		uint32_t tail = m_ring->tail.load(std::memory_order_relaxed);
+		uint32_t available = m_ring->head.load(std::memory_order_acquire) - tail;
+
+		// The producer position is written by another process; one that is more than the
+		// capacity ahead of the consumer is invalid and the ring is treated as empty
+		if(available > m_mask + 1) return 0;
+
+		size_t peeked = (count < available) ? count : available;
+		if(peeked == 0) return 0;
+
+		// The data may wrap around the end of the ring, requiring two copies
+		size_t index = tail & m_mask;
+		size_t first = ((m_mask + 1) - index < peeked) ? (m_mask + 1) - index : peeked;
+
+		memcpy(buffer, m_data + index, first);
+		if(peeked > first) memcpy(reinterpret_cast<uint8_t*>(buffer) + first, m_data, peeked - first);
+
+		return peeked;
+	}
+
+	// PrepareReadWait
+	//
+	// Called by the consumer before blocking; the ring must be checked again before waiting
+	void PrepareReadWait(void) { m_ring->readwait.store(1); }
+
+	// PrepareWriteWait
+	//
+	// Called by the producer before blocking; the ring must be checked again before waiting
+	void PrepareWriteWait(void) { m_ring->writewait.store(1); }
+
+	// Read
+	//
+	// Consumer: copies up to count bytes out of the ring, returns zero if the ring is empty
+	size_t Read(void* buffer, size_t count)
+	{
+		size_t read = Peek(buffer, count);
+		if(read == 0) return 0;
+
+		// Release the space back to the producer; sequentially consistent to order against ConsumeWriteWait
+		m_ring->tail.store(m_ring->tail.load(std::memory_order_relaxed) + static_cast<uint32_t>(read));
+		return read;
+	}
+
+	// RequiredLength (static)
+	//
+	// Gets the length of the memory block required to hold a ring of the specified capacity
+	static size_t RequiredLength(size_t capacity) { return sizeof(ring_t) + capacity; }
+
+	// ReleaseReader / ReleaseWriter
+	//
+	// Decrements the number of open read or write ends, returns the remaining count
+	uint32_t ReleaseReader(void) { return m_ring->readers.fetch_sub(1) - 1; }
+	uint32_t ReleaseWriter(void) { return m_ring->writers.fetch_sub(1) - 1; }
+
+	// Write
+	//
+	// Producer: copies up to count bytes into the ring; if whole is set either all of
+	// the data is written or none of it is.  Returns zero if there was not enough space
+	size_t Write(const void* buffer, size_t count, bool whole)
+	{
+		uint32_t head = m_ring->head.load(std::memory_order_relaxed);
+		uint32_t used = head - m_ring->tail.load(std::memory_order_acquire);
+
+		// The consumer position is written by another process; one that is behind the
+		// producer by more than the capacity is invalid and the ring is treated as full
+		if(used > m_mask + 1) return 0;
+
+		uint32_t free = (m_mask + 1) - used;
+
+		if(whole && (count > free)) return 0;
+
+		size_t written = (count < free) ? count : free;
+		if(written == 0) return 0;
+
+		// The space may wrap around the end of the ring, requiring two copies
+		size_t index = head & m_mask;
+		size_t first = ((m_mask + 1) - index < written) ? (m_mask + 1) - index : written;
+
+		memcpy(m_data + index, buffer, first);
+		if(written > first) memcpy(m_data, reinterpret_cast<const uint8_t*>(buffer) + first, written - first);
+
+		// Publish the data to the consumer; sequentially consistent to order against ConsumeReadWait
+		m_ring->head.store(head + static_cast<uint32_t>(written));
+		return written;
+	}
+
+	//-------------------------------------------------------------------------
+	// Fields
+
+	// MaximumCapacity (static)
+	//
+	// Maximum capacity of the ring data area; positions must not be able to lap each other
+	static const size_t MaximumCapacity = (1U << 30);
+
+	// MinimumCapacity (static)
+	//
+	// Minimum capacity of the ring data area
+	static const size_t MinimumCapacity = 4096;
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Available
+	//
+	// Gets the number of bytes that can currently be read from the ring
+	__declspec(property(get=getAvailable)) size_t Available;
+	size_t getAvailable(void) const { uint32_t used = m_ring->head.load() - m_ring->tail.load(); return (used > m_mask + 1) ? 0 : used; }
+
+	// Capacity
+	//
+	// Gets the capacity of the ring data area
+	__declspec(property(get=getCapacity)) size_t Capacity;
+	size_t getCapacity(void) const { return m_mask + 1; }
+
+	// Free
+	//
+	// Gets the number of bytes that can currently be written into the ring
+	__declspec(property(get=getFree)) size_t Free;
+	size_t getFree(void) const { uint32_t used = m_ring->head.load() - m_ring->tail.load(); return (used > m_mask + 1) ? 0 : (m_mask + 1) - used; }
+
+	// ReadPosition
+	//
+	// Gets the free-running consumer position, the total number of bytes read modulo 2^32
+	__declspec(property(get=getReadPosition)) uint32_t ReadPosition;
+	uint32_t getReadPosition(void) const { return m_ring->tail.load(); }
+
+	// Readers
+	//
+	// Gets the number of open read ends of the ring
+	__declspec(property(get=getReaders)) uint32_t Readers;
+	uint32_t getReaders(void) const { return m_ring->readers.load(); }
+
+	// WritePosition
+	//
+	// Gets the free-running producer position, the total number of bytes written modulo 2^32
+	__declspec(property(get=getWritePosition)) uint32_t WritePosition;
+	uint32_t getWritePosition(void) const { return m_ring->head.load(); }
+
+	// Writers
+	//
+	// Gets the number of open write ends of the ring
+	__declspec(property(get=getWriters)) uint32_t Writers;
+	uint32_t getWriters(void) const { return m_ring->writers.load(); }
+
+private:
+
+	PipeRing(const PipeRing&)=delete;
+	PipeRing& operator=(const PipeRing&)=delete;
+
+	// ring_t
+	//
+	// Control structure placed at the start of the shared memory block.  The producer
+	// and consumer positions are kept on separate cache lines to avoid false sharing;
+	// each wait flag is placed with the position of the side that consumes it
+	struct alignas(64) ring_t
+	{
+		uint32_t						capacity = 0;	// Capacity of the data area
+		std::atomic<uint32_t>			readers{ 0 };	// Number of open read ends
+		std::atomic<uint32_t>			writers{ 0 };	// Number of open write ends
+
+		alignas(64)
+		std::atomic<uint32_t>			head{ 0 };		// Producer position
+		std::atomic<uint32_t>			readwait{ 0 };	// Consumer is waiting for data
+
+		alignas(64)
+		std::atomic<uint32_t>			tail{ 0 };		// Consumer position
+		std::atomic<uint32_t>			writewait{ 0 };	// Producer is waiting for space
+	};
+
+	// The control structure is mapped into processes of both bitnesses
+	static_assert(ATOMIC_INT_LOCK_FREE == 2, "std::atomic<uint32_t> must be lock-free to be shared between processes");
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	ring_t* const					m_ring;			// Ring control structure
+	uint8_t* const					m_data;			// Ring data area
+	const uint32_t					m_mask;			// Capacity mask
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __PIPERING_H_
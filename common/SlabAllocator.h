@@ -0,0 +1,176 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __SLABALLOCATOR_H_
+#define __SLABALLOCATOR_H_
+#pragma once
+
+#include <new>
+#include <stdint.h>
+
+#pragma warning(push, 4)				
+
+//-----------------------------------------------------------------------------
+// SlabAllocator
+//
+// Implements a standard library compatible allocator that satisfies single
+// object allocations from a process-wide, lock-free free list of fixed size
+// blocks.  Blocks are carved out of slabs that are allocated on demand and are
+// never returned to the heap; once the pool has grown to accommodate the working
+// set, allocation and release do not touch the heap at all.
+//
+// Intended for use with std::allocate_shared<> for small, frequently created and
+// destroyed objects; the allocator is rebound to the control block type so the
+// object and its reference counts are placed into a single pooled block.  Array
+// allocations (count > 1) are passed through to the global operator new.
+
+template <typename _type, size_t _slabsize = 256>
+class SlabAllocator
+{
+	// Blocks from the free list must be able to satisfy the alignment of the type
+	static_assert(__alignof(_type) <= MEMORY_ALLOCATION_ALIGNMENT, "The alignment of the data type for SlabAllocator is too large");
+	static_assert(_slabsize > 0, "The slab size for SlabAllocator must be greater than zero");
+
+public:
+
+	// value_type
+	//
+	// Type of object being allocated
+	using value_type = _type;
+
+	// rebind
+	//
+	// Converts this allocator into an allocator for a different type
+	template <typename _other> struct rebind { using other = SlabAllocator<_other, _slabsize>; };
+
+	// Constructors
+	//
+	SlabAllocator()=default;
+	template <typename _other> SlabAllocator(const SlabAllocator<_other, _slabsize>&) {}
+
+	// Destructor
+	//
+	~SlabAllocator()=default;
+
+	//-------------------------------------------------------------------------
+	// Overloaded Operators
+
+	template <typename _other> bool operator==(const SlabAllocator<_other, _slabsize>&) const { return true; }
+	template <typename _other> bool operator!=(const SlabAllocator<_other, _slabsize>&) const { return false; }
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// allocate
+	//
+	// Allocates storage for the specified number of objects
+	_type* allocate(size_t count)
+	{
+		if(count != 1) return static_cast<_type*>(::operator new(count * sizeof(_type)));
+		return static_cast<_type*>(s_pool.Allocate());
+	}
+
+	// deallocate
+	//
+	// Releases storage previously allocated by allocate()
+	void deallocate(_type* ptr, size_t count)
+	{
+		if(count != 1) ::operator delete(ptr);
+		else s_pool.Release(ptr);
+	}
+
+private:
+
+	// pool_t
+	//
+	// Lock-free free list of fixed length blocks backed by slabs
+	class pool_t
+	{
+	public:
+
+		// Instance Constructor
+		//
+		pool_t() { InitializeSListHead(&m_freelist); }
+
+		// Allocate
+		//
+		// Pops a block from the free list, growing the pool if it's empty
+		void* Allocate(void)
+		{
+			PSLIST_ENTRY entry = InterlockedPopEntrySList(&m_freelist);
+			return (entry) ? entry : Grow();
+		}
+
+		// Release
+		//
+		// Pushes a block back onto the free list
+		void Release(void* block)
+		{
+			InterlockedPushEntrySList(&m_freelist, reinterpret_cast<PSLIST_ENTRY>(block));
+		}
+
+	private:
+
+		pool_t(const pool_t&)=delete;
+		pool_t& operator=(const pool_t&)=delete;
+
+		// BlockSize
+		//
+		// Length of each block, must be able to hold an SLIST_ENTRY when free
+		static const size_t BlockSize = (((sizeof(_type) > sizeof(SLIST_ENTRY)) ? sizeof(_type) : sizeof(SLIST_ENTRY)) 
+			+ (MEMORY_ALLOCATION_ALIGNMENT - 1)) & ~static_cast<size_t>(MEMORY_ALLOCATION_ALIGNMENT - 1);
+
+		// Grow
+		//
+		// Allocates a new slab, returns the first block and frees the rest; if
+		// multiple threads grow the pool at the same time each gets a slab
+		void* Grow(void)
+		{
+			uint8_t* slab = static_cast<uint8_t*>(_aligned_malloc(BlockSize * _slabsize, MEMORY_ALLOCATION_ALIGNMENT));
+			if(slab == nullptr) throw std::bad_alloc();
+
+			for(size_t index = 1; index < _slabsize; index++) Release(slab + (index * BlockSize));
+			return slab;
+		}
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		SLIST_HEADER			m_freelist;			// Free block list
+	};
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	static pool_t				s_pool;				// Process-wide block pool
+};
+
+// SlabAllocator::s_pool
+//
+template <typename _type, size_t _slabsize>
+typename SlabAllocator<_type, _slabsize>::pool_t SlabAllocator<_type, _slabsize>::s_pool;
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __SLABALLOCATOR_H_
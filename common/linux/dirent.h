@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_DIRENT_H_
+#define __LINUX_DIRENT_H_
+#pragma once
+
+#include "types.h"
+
+//-----------------------------------------------------------------------------
+// include/linux/fs.h
+//-----------------------------------------------------------------------------
+
+#define LINUX_DT_UNKNOWN		0
+#define LINUX_DT_FIFO			1
+#define LINUX_DT_CHR			2
+#define LINUX_DT_DIR			4
+#define LINUX_DT_BLK			6
+#define LINUX_DT_REG			8
+#define LINUX_DT_LNK			10
+#define LINUX_DT_SOCK			12
+#define LINUX_DT_WHT			14
+
+//-----------------------------------------------------------------------------
+// include/linux/dirent.h
+//-----------------------------------------------------------------------------
+
+#pragma pack(push, 1)
+
+// Used with getdents64(); d_reclen is always a multiple of 8 bytes and the
+// variable length d_name member is null terminated
+typedef struct {
+
+	uint64_t			d_ino;
+	int64_t				d_off;
+	uint16_t			d_reclen;
+	uint8_t				d_type;
+	linux_char_t		d_name[1];
+
+} linux_dirent64;
+
+#pragma pack(pop)
+
+#if !defined(__midl) && defined(__cplusplus)
+namespace uapi {
+
+	typedef linux_dirent64			dirent64;
+
+}	// namespace uapi
+#endif	// !defined(__midl) && defined(__cplusplus)
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_DIRENT_H_
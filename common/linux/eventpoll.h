@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_EVENTPOLL_H_
+#define __LINUX_EVENTPOLL_H_
+#pragma once
+
+#include "types.h"
+#include "fcntl.h"
+#include "poll.h"
+
+//-----------------------------------------------------------------------------
+// include/uapi/linux/eventpoll.h
+//-----------------------------------------------------------------------------
+
+/* Flags for epoll_create1.  */
+#define LINUX_EPOLL_CLOEXEC		LINUX_O_CLOEXEC
+
+/* Valid opcodes to issue to sys_epoll_ctl() */
+#define LINUX_EPOLL_CTL_ADD		1
+#define LINUX_EPOLL_CTL_DEL		2
+#define LINUX_EPOLL_CTL_MOD		3
+
+/* Epoll event masks */
+#define LINUX_EPOLLIN			LINUX_POLLIN
+#define LINUX_EPOLLPRI			LINUX_POLLPRI
+#define LINUX_EPOLLOUT			LINUX_POLLOUT
+#define LINUX_EPOLLERR			LINUX_POLLERR
+#define LINUX_EPOLLHUP			LINUX_POLLHUP
+#define LINUX_EPOLLRDNORM		LINUX_POLLRDNORM
+#define LINUX_EPOLLRDBAND		LINUX_POLLRDBAND
+#define LINUX_EPOLLWRNORM		LINUX_POLLWRNORM
+#define LINUX_EPOLLWRBAND		LINUX_POLLWRBAND
+#define LINUX_EPOLLMSG			LINUX_POLLMSG
+#define LINUX_EPOLLRDHUP		LINUX_POLLRDHUP
+
+/* Set exclusive wakeup mode for the target file descriptor */
+#define LINUX_EPOLLEXCLUSIVE	(1U << 28)
+
+/* Request the handling of system wakeup events so as to prevent system suspends */
+#define LINUX_EPOLLWAKEUP		(1U << 29)
+
+/* Set the One Shot behaviour for the target file descriptor */
+#define LINUX_EPOLLONESHOT		(1U << 30)
+
+/* Set the Edge Triggered behaviour for the target file descriptor */
+#define LINUX_EPOLLET			(1U << 31)
+
+/* Maximum number of events that can be returned from a single epoll_wait(), see fs/eventpoll.c */
+#define LINUX_EP_MAX_EVENTS		(0x7FFFFFFF / sizeof(linux_epoll_event))
+
+// On x86-64 the 64bit structure has the same alignment as the 32bit structure
+#pragma pack(push, 4)
+
+typedef struct {
+
+	uint32_t				events;
+	uint64_t				data;
+
+} linux_epoll_event;
+
+#pragma pack(pop)
+
+#if !defined(__midl) && defined(__cplusplus)
+namespace uapi {
+
+	typedef linux_epoll_event	epoll_event;
+
+}	// namespace uapi
+#endif	// !defined(__midl) && defined(__cplusplus)
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_EVENTPOLL_H_
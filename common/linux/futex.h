@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_FUTEX_H_
+#define __LINUX_FUTEX_H_
+#pragma once
+
+//-----------------------------------------------------------------------------
+// include/uapi/linux/futex.h
+//-----------------------------------------------------------------------------
+
+/* Second argument to futex syscall */
+#define LINUX_FUTEX_WAIT				0
+#define LINUX_FUTEX_WAKE				1
+#define LINUX_FUTEX_FD					2
+#define LINUX_FUTEX_REQUEUE				3
+#define LINUX_FUTEX_CMP_REQUEUE			4
+#define LINUX_FUTEX_WAKE_OP				5
+#define LINUX_FUTEX_LOCK_PI				6
+#define LINUX_FUTEX_UNLOCK_PI			7
+#define LINUX_FUTEX_TRYLOCK_PI			8
+#define LINUX_FUTEX_WAIT_BITSET			9
+#define LINUX_FUTEX_WAKE_BITSET			10
+#define LINUX_FUTEX_WAIT_REQUEUE_PI		11
+#define LINUX_FUTEX_CMP_REQUEUE_PI		12
+
+#define LINUX_FUTEX_PRIVATE_FLAG		128
+#define LINUX_FUTEX_CLOCK_REALTIME		256
+#define LINUX_FUTEX_CMD_MASK			~(LINUX_FUTEX_PRIVATE_FLAG | LINUX_FUTEX_CLOCK_REALTIME)
+
+#define LINUX_FUTEX_WAIT_PRIVATE			(LINUX_FUTEX_WAIT | LINUX_FUTEX_PRIVATE_FLAG)
+#define LINUX_FUTEX_WAKE_PRIVATE			(LINUX_FUTEX_WAKE | LINUX_FUTEX_PRIVATE_FLAG)
+#define LINUX_FUTEX_REQUEUE_PRIVATE			(LINUX_FUTEX_REQUEUE | LINUX_FUTEX_PRIVATE_FLAG)
+#define LINUX_FUTEX_CMP_REQUEUE_PRIVATE		(LINUX_FUTEX_CMP_REQUEUE | LINUX_FUTEX_PRIVATE_FLAG)
+#define LINUX_FUTEX_WAKE_OP_PRIVATE			(LINUX_FUTEX_WAKE_OP | LINUX_FUTEX_PRIVATE_FLAG)
+#define LINUX_FUTEX_WAIT_BITSET_PRIVATE		(LINUX_FUTEX_WAIT_BITSET | LINUX_FUTEX_PRIVATE_FLAG)
+#define LINUX_FUTEX_WAKE_BITSET_PRIVATE		(LINUX_FUTEX_WAKE_BITSET | LINUX_FUTEX_PRIVATE_FLAG)
+
+/*
+ * bitset with all bits set for the FUTEX_xxx_BITSET OPs to request a
+ * match of any bit.
+ */
+#define LINUX_FUTEX_BITSET_MATCH_ANY	0xffffffff
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_FUTEX_H_
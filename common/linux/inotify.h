@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_INOTIFY_H_
+#define __LINUX_INOTIFY_H_
+#pragma once
+
+#include "types.h"
+#include "fcntl.h"
+
+//-----------------------------------------------------------------------------
+// include/uapi/linux/inotify.h
+//-----------------------------------------------------------------------------
+
+/* the following are legal, implemented events that user-space can watch for */
+#define LINUX_IN_ACCESS				0x00000001	/* File was accessed */
+#define LINUX_IN_MODIFY				0x00000002	/* File was modified */
+#define LINUX_IN_ATTRIB				0x00000004	/* Metadata changed */
+#define LINUX_IN_CLOSE_WRITE		0x00000008	/* Writtable file was closed */
+#define LINUX_IN_CLOSE_NOWRITE		0x00000010	/* Unwrittable file closed */
+#define LINUX_IN_OPEN				0x00000020	/* File was opened */
+#define LINUX_IN_MOVED_FROM			0x00000040	/* File was moved from X */
+#define LINUX_IN_MOVED_TO			0x00000080	/* File was moved to Y */
+#define LINUX_IN_CREATE				0x00000100	/* Subfile was created */
+#define LINUX_IN_DELETE				0x00000200	/* Subfile was deleted */
+#define LINUX_IN_DELETE_SELF		0x00000400	/* Self was deleted */
+#define LINUX_IN_MOVE_SELF			0x00000800	/* Self was moved */
+
+/* the following are legal events.  they are sent as needed to any watch */
+#define LINUX_IN_UNMOUNT			0x00002000	/* Backing fs was unmounted */
+#define LINUX_IN_Q_OVERFLOW			0x00004000	/* Event queued overflowed */
+#define LINUX_IN_IGNORED			0x00008000	/* File was ignored */
+
+/* helper events */
+#define LINUX_IN_CLOSE				(LINUX_IN_CLOSE_WRITE | LINUX_IN_CLOSE_NOWRITE) /* close */
+#define LINUX_IN_MOVE				(LINUX_IN_MOVED_FROM | LINUX_IN_MOVED_TO) /* moves */
+
+/* special flags */
+#define LINUX_IN_ONLYDIR			0x01000000	/* only watch the path if it is a directory */
+#define LINUX_IN_DONT_FOLLOW		0x02000000	/* don't follow a sym link */
+#define LINUX_IN_EXCL_UNLINK		0x04000000	/* exclude events on unlinked objects */
+#define LINUX_IN_MASK_CREATE		0x10000000	/* only create watches */
+#define LINUX_IN_MASK_ADD			0x20000000	/* add to the mask of an already existing watch */
+#define LINUX_IN_ISDIR				0x40000000	/* event occurred against dir */
+#define LINUX_IN_ONESHOT			0x80000000	/* only send event once */
+
+/*
+ * All of the events - we build the list by hand so that we can add flags in
+ * the future and not break backward compatibility.  Apps will get only the
+ * events that they originally wanted.  Be sure to add new events here!
+ */
+#define LINUX_IN_ALL_EVENTS			(LINUX_IN_ACCESS | LINUX_IN_MODIFY | LINUX_IN_ATTRIB | LINUX_IN_CLOSE_WRITE | \
+									 LINUX_IN_CLOSE_NOWRITE | LINUX_IN_OPEN | LINUX_IN_MOVED_FROM | \
+									 LINUX_IN_MOVED_TO | LINUX_IN_DELETE | LINUX_IN_CREATE | LINUX_IN_DELETE_SELF | \
+									 LINUX_IN_MOVE_SELF)
+
+/* Flags for sys_inotify_init1.  */
+#define LINUX_IN_CLOEXEC			LINUX_O_CLOEXEC
+#define LINUX_IN_NONBLOCK			LINUX_O_NONBLOCK
+
+/* Default value of /proc/sys/fs/inotify/max_queued_events, see fs/notify/inotify/inotify_user.c */
+#define LINUX_INOTIFY_MAX_QUEUED_EVENTS		16384
+
+/* Default value of /proc/sys/fs/inotify/max_user_watches, see fs/notify/inotify/inotify_user.c */
+#define LINUX_INOTIFY_MAX_USER_WATCHES		8192
+
+/*
+ * struct inotify_event - structure read from the inotify device for each event
+ *
+ * When you are watching a directory, you will receive the filename for events
+ * such as IN_CREATE, IN_DELETE, IN_OPEN, IN_CLOSE, ..., relative to the wd.
+ */
+typedef struct {
+
+	int32_t					wd;			/* watch descriptor */
+	uint32_t				mask;		/* watch mask */
+	uint32_t				cookie;		/* cookie to synchronize two events */
+	uint32_t				len;		/* length (including nulls) of name */
+	// char_t				name[];		/* stub for possible name */
+
+} linux_inotify_event;
+
+#if !defined(__midl) && defined(__cplusplus)
+namespace uapi {
+
+	typedef linux_inotify_event	inotify_event;
+
+}	// namespace uapi
+#endif	// !defined(__midl) && defined(__cplusplus)
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_INOTIFY_H_
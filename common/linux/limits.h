@@ -0,0 +1,49 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_LIMITS_H_
+#define __LINUX_LIMITS_H_
+#pragma once
+
+//-----------------------------------------------------------------------------
+// include/uapi/linux/limits.h
+//-----------------------------------------------------------------------------
+
+#define LINUX_NR_OPEN				1024
+
+#define LINUX_NGROUPS_MAX			65536		/* supplemental group IDs are available */
+#define LINUX_ARG_MAX				131072		/* # bytes of args + environ for exec() */
+#define LINUX_LINK_MAX				127			/* # links a file may have */
+#define LINUX_MAX_CANON				255			/* size of the canonical input queue */
+#define LINUX_MAX_INPUT				255			/* size of the type-ahead buffer */
+#define LINUX_NAME_MAX				255			/* # chars in a file name */
+#define LINUX_PATH_MAX				4096		/* # chars in a path name including nul */
+#define LINUX_PIPE_BUF				4096		/* # bytes in atomic write to a pipe */
+#define LINUX_XATTR_NAME_MAX		255			/* # chars in an extended attribute name */
+#define LINUX_XATTR_SIZE_MAX		65536		/* size of an extended attribute value (64k) */
+#define LINUX_XATTR_LIST_MAX		65536		/* size of extended attribute namelist (64k) */
+
+#define LINUX_RTSIG_MAX				32
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_LIMITS_H_
@@ -67,6 +67,7 @@
 #define LINUX_NCP_SUPER_MAGIC					0x564c		/* Guess, what 0x564c is :-) */
 #define LINUX_NFS_SUPER_MAGIC					0x6969
 #define LINUX_OPENPROM_SUPER_MAGIC				0x9fa1
+#define LINUX_OVERLAYFS_SUPER_MAGIC				0x794c7630
 #define LINUX_QNX4_SUPER_MAGIC					0x002f		/* qnx4 fs detection */
 #define LINUX_QNX6_SUPER_MAGIC					0x68191122	/* qnx6 fs detection */
 #define LINUX_REISERFS_SUPER_MAGIC				0x52654973	/* used by gcc */
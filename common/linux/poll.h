@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_POLL_H_
+#define __LINUX_POLL_H_
+#pragma once
+
+#include "types.h"
+
+//-----------------------------------------------------------------------------
+// include/uapi/asm-generic/poll.h
+//-----------------------------------------------------------------------------
+
+/* These are specified by iBCS2 */
+#define LINUX_POLLIN			0x0001
+#define LINUX_POLLPRI			0x0002
+#define LINUX_POLLOUT			0x0004
+#define LINUX_POLLERR			0x0008
+#define LINUX_POLLHUP			0x0010
+#define LINUX_POLLNVAL			0x0020
+
+/* The rest seem to be more-or-less nonstandard. Check them! */
+#define LINUX_POLLRDNORM		0x0040
+#define LINUX_POLLRDBAND		0x0080
+#define LINUX_POLLWRNORM		0x0100
+#define LINUX_POLLWRBAND		0x0200
+#define LINUX_POLLMSG			0x0400
+#define LINUX_POLLREMOVE		0x1000
+#define LINUX_POLLRDHUP			0x2000
+
+typedef struct {
+
+	int						fd;
+	short					events;
+	short					revents;
+
+} linux_pollfd;
+
+//-----------------------------------------------------------------------------
+// include/linux/poll.h
+//-----------------------------------------------------------------------------
+
+#define LINUX_DEFAULT_POLLMASK	(LINUX_POLLIN | LINUX_POLLOUT | LINUX_POLLRDNORM | LINUX_POLLWRNORM)
+
+//-----------------------------------------------------------------------------
+// include/uapi/linux/posix_types.h
+//-----------------------------------------------------------------------------
+
+#define LINUX_FD_SETSIZE		1024
+
+typedef struct {
+
+	unsigned long			fds_bits[LINUX_FD_SETSIZE / (8 * sizeof(unsigned long))];
+
+} linux_fd_set;
+
+#if !defined(__midl) && defined(__cplusplus)
+namespace uapi {
+
+	typedef linux_pollfd		pollfd;
+	typedef linux_fd_set		fd_set;
+
+}	// namespace uapi
+#endif	// !defined(__midl) && defined(__cplusplus)
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_POLL_H_
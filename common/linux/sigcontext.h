@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_SIGCONTEXT_H_
+#define __LINUX_SIGCONTEXT_H_
+#pragma once
+
+#include "types.h"
+
+//-----------------------------------------------------------------------------
+// arch/x86/include/uapi/asm/sigcontext32.h
+//-----------------------------------------------------------------------------
+
+typedef struct {
+
+	uint16_t		gs, __gsh;
+	uint16_t		fs, __fsh;
+	uint16_t		es, __esh;
+	uint16_t		ds, __dsh;
+	uint32_t		edi;
+	uint32_t		esi;
+	uint32_t		ebp;
+	uint32_t		esp;
+	uint32_t		ebx;
+	uint32_t		edx;
+	uint32_t		ecx;
+	uint32_t		eax;
+	uint32_t		trapno;
+	uint32_t		err;
+	uint32_t		eip;
+	uint16_t		cs, __csh;
+	uint32_t		eflags;
+	uint32_t		esp_at_signal;
+	uint16_t		ss, __ssh;
+	uint32_t		fpstate;
+	uint32_t		oldmask;
+	uint32_t		cr2;
+
+} linux_sigcontext32;
+
+//-----------------------------------------------------------------------------
+// arch/x86/include/asm/ia32.h
+//-----------------------------------------------------------------------------
+
+typedef struct {
+
+	uint32_t		ss_sp;
+	int32_t			ss_flags;
+	uint32_t		ss_size;
+
+} linux_stack32_t;
+
+typedef struct {
+
+	uint32_t			uc_flags;
+	uint32_t			uc_link;
+	linux_stack32_t		uc_stack;
+	linux_sigcontext32	uc_mcontext;
+	uint64_t			uc_sigmask;
+
+} linux_ucontext32;
+
+#if !defined(__midl) && defined(__cplusplus)
+namespace uapi {
+
+	typedef linux_sigcontext32	sigcontext32;
+	typedef linux_stack32_t		stack32_t;
+	typedef linux_ucontext32	ucontext32;
+
+}	// namespace uapi
+#endif	// !defined(__midl) && defined(__cplusplus)
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_SIGCONTEXT_H_
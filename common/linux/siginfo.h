@@ -159,6 +159,9 @@ typedef struct {
 #define linux_si_band			_sifields._sigpoll._band
 #define linux_si_fd				_sifields._sigpoll._fd
 
+#define LINUX_SI_USER			0				/* sent by kill, sigsend, raise */
+#define LINUX_SI_TKILL			-6				/* sent by tkill system call */
+
 #define LINUX_CLD_EXITED		1				/* child has exited */
 #define LINUX_CLD_KILLED		2				/* child was killed */
 #define LINUX_CLD_DUMPED		3				/* child terminated abnormally */
@@ -0,0 +1,159 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_SOCKET_H_
+#define __LINUX_SOCKET_H_
+#pragma once
+
+#include "types.h"
+#include "fcntl.h"
+#include "uio.h"
+
+//-----------------------------------------------------------------------------
+// include/linux/socket.h
+//-----------------------------------------------------------------------------
+
+typedef unsigned short linux_sa_family_t;
+
+typedef struct {
+
+	linux_sa_family_t	sa_family;			/* address family, AF_xxx	*/
+	char				sa_data[14];		/* 14 bytes of protocol address	*/
+
+} linux_sockaddr;
+
+typedef struct {
+
+	linux_pid_t			pid;
+	linux_uid_t			uid;
+	linux_gid_t			gid;
+
+} linux_ucred;
+
+// TODO: THIS SHOULD HAVE 32 AND 64 BIT VERSIONS
+
+typedef struct {
+
+	void*				msg_name;			/* ptr to socket address structure */
+	int					msg_namelen;		/* size of socket address structure */
+	linux_iovec*		msg_iov;			/* scatter/gather array */
+	linux_size_t		msg_iovlen;			/* # elements in msg_iov */
+	void*				msg_control;		/* ancillary data */
+	linux_size_t		msg_controllen;		/* ancillary data buffer length */
+	unsigned int		msg_flags;			/* flags on received message */
+
+} linux_msghdr;
+
+typedef struct {
+
+	linux_size_t		cmsg_len;			/* data byte count, including hdr */
+	int					cmsg_level;			/* originating protocol */
+	int					cmsg_type;			/* protocol-specific type */
+
+} linux_cmsghdr;
+
+/* Supported address families. */
+#define LINUX_AF_UNSPEC			0
+#define LINUX_AF_UNIX			1	/* Unix domain sockets 		*/
+#define LINUX_AF_LOCAL			1	/* POSIX name for AF_UNIX	*/
+#define LINUX_AF_INET			2	/* Internet IP Protocol 	*/
+#define LINUX_AF_INET6			10	/* IP version 6			*/
+#define LINUX_AF_NETLINK		16
+
+/* Protocol families, same as address families. */
+#define LINUX_PF_UNSPEC			LINUX_AF_UNSPEC
+#define LINUX_PF_UNIX			LINUX_AF_UNIX
+#define LINUX_PF_LOCAL			LINUX_AF_LOCAL
+
+/* Maximum queue length specifiable by listen.  */
+#define LINUX_SOMAXCONN			128
+
+/* Flags we can use with send/ and recv. */
+#define LINUX_MSG_OOB			1
+#define LINUX_MSG_PEEK			2
+#define LINUX_MSG_DONTROUTE		4
+#define LINUX_MSG_CTRUNC		8
+#define LINUX_MSG_TRUNC			0x20
+#define LINUX_MSG_DONTWAIT		0x40	/* Nonblocking io		 */
+#define LINUX_MSG_EOR			0x80	/* End of record */
+#define LINUX_MSG_WAITALL		0x100	/* Wait for a full request */
+#define LINUX_MSG_NOSIGNAL		0x4000	/* Do not generate SIGPIPE */
+#define LINUX_MSG_CMSG_CLOEXEC	0x40000000	/* Set close_on_exec for file descriptor received through SCM_RIGHTS */
+
+/* Setsockoptions(2) level. */
+#define LINUX_SOL_SOCKET		1
+
+/* "Socket"-level control message types: */
+#define LINUX_SCM_RIGHTS		0x01		/* rw: access rights (array of int) */
+#define LINUX_SCM_CREDENTIALS	0x02		/* rw: struct ucred		*/
+
+//-----------------------------------------------------------------------------
+// include/linux/net.h
+//-----------------------------------------------------------------------------
+
+#define LINUX_SOCK_STREAM		1
+#define LINUX_SOCK_DGRAM		2
+#define LINUX_SOCK_RAW			3
+#define LINUX_SOCK_RDM			4
+#define LINUX_SOCK_SEQPACKET	5
+#define LINUX_SOCK_DCCP			6
+#define LINUX_SOCK_PACKET		10
+
+#define LINUX_SOCK_MAX			(LINUX_SOCK_PACKET + 1)
+#define LINUX_SOCK_TYPE_MASK	0xf
+
+/* Flags for socket, socketpair, accept4 */
+#define LINUX_SOCK_CLOEXEC		LINUX_O_CLOEXEC
+#define LINUX_SOCK_NONBLOCK		LINUX_O_NONBLOCK
+
+#define LINUX_SHUT_RD			0
+#define LINUX_SHUT_WR			1
+#define LINUX_SHUT_RDWR			2
+
+//-----------------------------------------------------------------------------
+// include/uapi/asm-generic/socket.h
+//-----------------------------------------------------------------------------
+
+#define LINUX_SO_TYPE			3
+#define LINUX_SO_ERROR			4
+#define LINUX_SO_SNDBUF			7
+#define LINUX_SO_RCVBUF			8
+#define LINUX_SO_PASSCRED		16
+#define LINUX_SO_PEERCRED		17
+#define LINUX_SO_ACCEPTCONN		30
+#define LINUX_SO_DOMAIN			39
+
+#if !defined(__midl) && defined(__cplusplus)
+namespace uapi {
+
+	typedef linux_sa_family_t	sa_family_t;
+	typedef linux_sockaddr		sockaddr;
+	typedef linux_msghdr		msghdr;
+	typedef linux_cmsghdr		cmsghdr;
+	typedef linux_ucred			ucred;
+
+}	// namespace uapi
+#endif	// !defined(__midl) && defined(__cplusplus)
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_SOCKET_H_
@@ -0,0 +1,40 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __LINUX_SPLICE_H_
+#define __LINUX_SPLICE_H_
+#pragma once
+
+//-----------------------------------------------------------------------------
+// include/linux/splice.h
+//-----------------------------------------------------------------------------
+
+#define LINUX_SPLICE_F_MOVE			(0x01)	/* move pages instead of copying */
+#define LINUX_SPLICE_F_NONBLOCK		(0x02)	/* don't block on the pipe splicing (but we may still block on the fd we splice from/to, of course */
+#define LINUX_SPLICE_F_MORE			(0x04)	/* expect more data */
+#define LINUX_SPLICE_F_GIFT			(0x08)	/* pages passed in are a gift */
+
+#define LINUX_SPLICE_F_ALL			(LINUX_SPLICE_F_MOVE|LINUX_SPLICE_F_NONBLOCK|LINUX_SPLICE_F_MORE|LINUX_SPLICE_F_GIFT)
+
+//-----------------------------------------------------------------------------
+
+#endif		// __LINUX_SPLICE_H_
@@ -27,25 +27,35 @@
 #include <linux/types.h>
 #include <linux/auxvec.h>
 #include <linux/capability.h>
+#include <linux/dirent.h>
 #include <linux/elf.h>
 #include <linux/elf-em.h>
 #include <linux/errno.h>
+#include <linux/eventpoll.h>
 #include <linux/fcntl.h>
 #include <linux/fs.h>
+#include <linux/futex.h>
+#include <linux/inotify.h>
 #include <linux/kern_levels.h>
 #include <linux/ldt.h>
+#include <linux/limits.h>
 #include <linux/magic.h>
 #include <linux/major.h>
 #include <linux/mman.h>
+#include <linux/poll.h>
 #include <linux/ptrace.h>
 #include <linux/resource.h>
 #include <linux/sched.h>
+#include <linux/sigcontext.h>
 #include <linux/siginfo.h>
 #include <linux/signal.h>
+#include <linux/socket.h>
+#include <linux/splice.h>
 #include <linux/stat.h>
 #include <linux/statfs.h>
 #include <linux/time.h>
 #include <linux/uio.h>
+#include <linux/un.h>
 #include <linux/utask.h>
 #include <linux/utsname.h>
 #include <linux/wait.h>
@@ -34,6 +34,11 @@ extern void* g_ldt;
 // Thread-local emulated GS segment register
 extern __declspec(thread) uint16_t t_gs;
 
+// t_sigstate (main.cpp)
+//
+// Thread-local signal state shared with the service
+extern __declspec(thread) sys32_sigstate_t* t_sigstate;
+
 // trace.cpp
 //
 void TraceMessage(const char_t* message, size_t length);
@@ -93,8 +98,20 @@ emulator::instruction INT_80(0xCD, 0x80, [](emulator::context_t* context) -> boo
 	_RPT2(_CRT_WARN, "0x%04X: System call %d\r\n", GetCurrentProcessId(), syscall);
 
 	// The system call number is stored in the EAX register on entry and
-	// the return value from the function is stored in EAX on exit
+	// the return value from the function is stored in EAX on exit; the service
+	// will not attempt to interrupt the thread while the flag is set
+	if(t_sigstate) t_sigstate->insyscall = 1;
 	context->Eax = InvokeSystemCall(syscall, context);
+	if(t_sigstate) InterlockedExchange(reinterpret_cast<LONG volatile*>(&t_sigstate->insyscall), 0);
+
+	// Deliver any signals that became pending and unblocked during the system call,
+	// sys_exit has already switched the context back to the host thread at this point
+	if(t_sigstate && (syscall != 1)) {
+
+		uapi::sigset_t pending = static_cast<uapi::sigset_t>(InterlockedCompareExchange64(reinterpret_cast<LONGLONG volatile*>(&t_sigstate->pending), 0, 0));
+		uapi::sigset_t blocked = static_cast<uapi::sigset_t>(InterlockedCompareExchange64(reinterpret_cast<LONGLONG volatile*>(&t_sigstate->blocked), 0, 0));
+		if(pending & ~blocked) DeliverSignals(context);
+	}
 
 	// TODO: remove this at some point, it's only going to be useful until
 	// the applications can just report it on their own
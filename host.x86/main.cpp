@@ -21,6 +21,7 @@
 //-----------------------------------------------------------------------------
 
 #include "stdafx.h"
+#include "syscalls.h"
 
 #pragma warning(push, 4)
 #pragma warning(disable:4731)	// frame pointer modified by inline assembly code
@@ -35,6 +36,11 @@ void* g_ldt = nullptr;
 // Global RPC binding handle to the system calls interface
 RPC_BINDING_HANDLE g_rpcbinding = nullptr;
 
+// t_cleartid
+//
+// Thread-local address to clear and wake when the thread exits (CLONE_CHILD_CLEARTID)
+__declspec(thread) uapi::pid_t* t_cleartid = nullptr;
+
 // t_exittask
 //
 // Thread-local task state information to restore host thread on exit
@@ -50,11 +56,42 @@ __declspec(thread) uint16_t t_gs;
 // Thread-local RPC context handle for the system calls interface
 __declspec(thread) sys32_context_t t_rpccontext;
 
+// t_sigstate
+//
+// Thread-local signal state shared with the service
+__declspec(thread) sys32_sigstate_t* t_sigstate = nullptr;
+
 // EmulationExceptionHandler (emulator.cpp)
 //
 // Vectored Exception handler used to provide emulation
 LONG CALLBACK EmulationExceptionHandler(PEXCEPTION_POINTERS exception);
 
+//-----------------------------------------------------------------------------
+// ClearThreadId
+//
+// Clears the thread id set by CLONE_CHILD_CLEARTID or set_tid_address(2) when the
+// thread exits and wakes a thread waiting on it, for example in pthread_join(3)
+//
+// Arguments:
+//
+//	NONE
+
+void ClearThreadId(void)
+{
+	if(t_cleartid == nullptr) return;
+
+	// The address belongs to the hosted task, it may no longer be valid
+	__try { *reinterpret_cast<volatile uapi::pid_t*>(t_cleartid) = 0; }
+	__except(EXCEPTION_EXECUTE_HANDLER) { t_cleartid = nullptr; return; }
+
+	// The thread id is woken as a shared futex, which the service tracks, but waiters that
+	// specified FUTEX_PRIVATE_FLAG are tracked in the host and need to be woken here as well
+	FutexWake(reinterpret_cast<uint32_t*>(t_cleartid), 1, LINUX_FUTEX_BITSET_MATCH_ANY);
+	sys32_futex(t_rpccontext, reinterpret_cast<sys32_addr_t>(t_cleartid), LINUX_FUTEX_WAKE, 1, 0, 0, 0);
+
+	t_cleartid = nullptr;
+}
+
 //-----------------------------------------------------------------------------
 // ExecuteTask
 //
@@ -136,34 +173,26 @@ threadexit:
 DWORD WINAPI ThreadMain(void*)
 {
 	zero_init<sys32_thread_t>	thread;			// Thread information from service
-	//sys32_addr_t				cleartid = 0;	// Address to clear/signal on exit
-	//DWORD						exitcode;		// Thread exit code
+	DWORD						exitcode;		// Thread exit code
 
 	// Attempt to acquire the task information and context handle from the server
 	HRESULT hresult = sys32_attach_thread(g_rpcbinding, GetCurrentThreadId(), &thread, &t_rpccontext);
 	if(FAILED(hresult)) return static_cast<DWORD>(hresult);
 
-	//
-	return sys32_exit(&t_rpccontext, ExecuteTask(&thread.task));
-
-	//// Execute the task provided in the thread startup information
-	//exitcode = ExecuteTask(&thread.task);
+	// Set the pointer to the signal state allocated by the service for this thread
+	t_sigstate = reinterpret_cast<sys32_sigstate_t*>(thread.sigstate);
 
-	//// Release the server context handle for this thread
-	//sys32_release_thread(&t_rpccontext, static_cast<int>(exitcode), &cleartid);
+	// Set the address to clear when the thread exits, if CLONE_CHILD_CLEARTID was specified
+	t_cleartid = reinterpret_cast<uapi::pid_t*>(thread.cleartid);
 
-	//// TODO: This is my best guess as to how I'm going to implement futex() - with
-	//// the new WaitOnAddress/WakeByAddress functions, which are in-process only from
-	//// what I can tell.  Therefore, the WakeBy() has to happen here in the host
-	//if(cleartid) {
+	// Execute the task provided in the thread startup information
+	exitcode = ExecuteTask(&thread.task);
 
-	//	// Zero the PID located at the provided address and signal the address
-	//	*reinterpret_cast<uapi::pid_t*>(cleartid) = 0;
-	//	WakeByAddressSingle(reinterpret_cast<void*>(cleartid));
-	//}
+	// Clear and wake the thread id before the service releases the thread
+	ClearThreadId();
 
 	// Individual threads can return normally, do not call ExitThread()
-	//return exitcode;
+	return sys32_exit(&t_rpccontext, exitcode);
 }
 
 //-----------------------------------------------------------------------------
@@ -182,8 +211,7 @@ int APIENTRY _tWinMain(HINSTANCE, HINSTANCE, LPTSTR, int)
 {
 	zero_init<sys32_process_t>		process;		// Process information from the service
 	RPC_STATUS						rpcresult;		// Result from RPC function call
-	//sys32_addr_t					cleartid = 0;	// Address to clear/signal on exit
-	//DWORD							exitcode;		// Exit code from the main thread
+	DWORD							exitcode;		// Exit code from the main thread
 	HRESULT							hresult;		// Result from system call API function
 
 	// EXPECTED ARGUMENTS:
@@ -197,37 +225,28 @@ int APIENTRY _tWinMain(HINSTANCE, HINSTANCE, LPTSTR, int)
 	if(rpcresult != RPC_S_OK) return static_cast<int>(rpcresult);
 
 	// Attempt to acquire the host process information and context from the server
-	hresult = sys32_attach_process(g_rpcbinding, GetCurrentThreadId(), reinterpret_cast<sys32_addr_t>(ThreadMain), &process, &t_rpccontext);
+	hresult = sys32_attach_process(g_rpcbinding, GetCurrentThreadId(), reinterpret_cast<sys32_addr_t>(ThreadMain),
+		reinterpret_cast<sys32_addr_t>(SignalEntry), &process, &t_rpccontext);
 	if(FAILED(hresult)) return static_cast<int>(hresult);
 
 	// Set the pointer to the process-wide local descriptor table
 	g_ldt = reinterpret_cast<void*>(process.ldt);
 
+	// Set the pointer to the signal state allocated by the service for the main thread
+	t_sigstate = reinterpret_cast<sys32_sigstate_t*>(process.sigstate);
+
 	// Install the emulator, which operates by intercepting low-level exceptions
 	AddVectoredExceptionHandler(1, EmulationExceptionHandler);
 
-	//
-	ExitThread(sys32_exit(&t_rpccontext, ExecuteTask(&process.task)));
-
-	//// Execute the task provided in the process startup information
-	//exitcode = ExecuteTask(&process.task);
-
-	//// Release the server context handle for this thread
-	//sys32_release_thread(&t_rpccontext, static_cast<int>(exitcode), &cleartid);
-
-	//// TODO: This is my best guess as to how I'm going to implement futex() - with
-	//// the new WaitOnAddress/WakeByAddress functions, which are in-process only from
-	//// what I can tell.  Therefore, the WakeBy() has to happen here in the host
-	//if(cleartid) {
+	// Execute the task provided in the process startup information
+	exitcode = ExecuteTask(&process.task);
 
-	//	// Zero the PID located at the provided address and signal the address
-	//	*reinterpret_cast<uapi::pid_t*>(cleartid) = 0;
-	//	WakeByAddressSingle(reinterpret_cast<void*>(cleartid));
-	//}
+	// Clear and wake the thread id if one was set with set_tid_address(2)
+	ClearThreadId();
 
-	//// Call ExitThread rather than returning from WinMain, that would invoke ExitProcess()
-	//// and kill any other threads that have been created inside this host process
-	//ExitThread(exitcode);
+	// Call ExitThread rather than returning from WinMain, that would invoke ExitProcess()
+	// and kill any other threads that have been created inside this host process
+	ExitThread(sys32_exit(&t_rpccontext, exitcode));
 }
 
 //-----------------------------------------------------------------------------
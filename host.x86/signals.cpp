@@ -0,0 +1,390 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "syscalls.h"
+
+#pragma warning(push, 4)
+
+// t_gs (main.cpp)
+//
+// Thread-local emulated GS segment register
+extern __declspec(thread) uint16_t t_gs;
+
+// t_rpccontext (main.cpp)
+//
+// RPC context handle for the current thread
+extern __declspec(thread) sys32_context_t t_rpccontext;
+
+// t_sigstate (main.cpp)
+//
+// Thread-local signal state shared with the service
+extern __declspec(thread) sys32_sigstate_t* t_sigstate;
+
+// SIGNAL_UNBLOCKABLE (local)
+//
+// Signals that cannot be blocked by the application
+static const uapi::sigset_t SIGNAL_UNBLOCKABLE = uapi::sigmask(LINUX_SIGKILL) | uapi::sigmask(LINUX_SIGSTOP);
+
+// rt_sigframe (local)
+//
+// Signal frame pushed onto the application stack for a signal handler, this
+// must match the i386 layout since the application can examine it directly
+struct rt_sigframe {
+
+	uint32_t				pretcode;			// Handler return address
+	int32_t					sig;				// Signal number
+	uint32_t				pinfo;				// Pointer to info
+	uint32_t				puc;				// Pointer to uc
+	uapi::siginfo			info;				// Signal information
+	uapi::ucontext32		uc;					// Interrupted user context
+	uint8_t					retcode[8];			// rt_sigreturn code, never executed
+};
+
+//-----------------------------------------------------------------------------
+// GetBlockedSignals (local)
+//
+// Atomically reads the blocked signal mask for the calling thread
+//
+// Arguments:
+//
+//	NONE
+
+inline static uapi::sigset_t GetBlockedSignals(void)
+{
+	return static_cast<uapi::sigset_t>(InterlockedCompareExchange64(reinterpret_cast<LONGLONG volatile*>(&t_sigstate->blocked), 0, 0));
+}
+
+//-----------------------------------------------------------------------------
+// SetBlockedSignals (local)
+//
+// Atomically replaces the blocked signal mask for the calling thread
+//
+// Arguments:
+//
+//	mask		- New blocked signal mask
+
+inline static void SetBlockedSignals(uapi::sigset_t mask)
+{
+	InterlockedExchange64(reinterpret_cast<LONGLONG volatile*>(&t_sigstate->blocked), static_cast<LONGLONG>(mask & ~SIGNAL_UNBLOCKABLE));
+}
+
+//-----------------------------------------------------------------------------
+// DefaultSignalAction (local)
+//
+// Applies the default action for a signal; returns only if the default action
+// is to ignore the signal
+//
+// Arguments:
+//
+//	signal		- Signal number
+
+static void DefaultSignalAction(int signal)
+{
+	switch(signal) {
+
+		// Signals that are ignored by default
+		case LINUX_SIGCHLD:
+		case LINUX_SIGCONT:
+		case LINUX_SIGURG:
+		case LINUX_SIGWINCH:
+			return;
+
+		// Job control stop signals are ignored; a host process has no stopped
+		// state that could be resumed by SIGCONT or reported through wait4
+		case LINUX_SIGSTOP:
+		case LINUX_SIGTSTP:
+		case LINUX_SIGTTIN:
+		case LINUX_SIGTTOU:
+			return;
+	}
+
+	// Everything else terminates the process; the low byte of the exit code
+	// indicates the signal that killed it (see sys_exit)
+	ExitProcess(static_cast<UINT>(signal & 0x7F));
+}
+
+//-----------------------------------------------------------------------------
+// SignalReturn (local)
+//
+// Return address for a signal handler that was not registered with SA_RESTORER,
+// this lives in the host image rather than the application stack so that the
+// stack does not need to be executable
+//
+// Arguments:
+//
+//	NONE
+
+static __declspec(naked) void SignalReturn(void)
+{
+	__asm mov eax, 173;
+	__asm int 0x80;
+}
+
+//-----------------------------------------------------------------------------
+// DeliverSignals
+//
+// Delivers the next pending signal to the thread, invoked on the way out of
+// a system call once the return value has been set in the context
+//
+// Arguments:
+//
+//	context		- Pointer to the CONTEXT structure from the exception handler
+
+void DeliverSignals(PCONTEXT context)
+{
+	zero_init<sys32_siginfo_t>		siginfo;		// Dequeued signal information
+	zero_init<sys32_sigaction_t>	action;			// Action to take for the signal
+
+	if(t_sigstate == nullptr) return;
+
+	while(true) {
+
+		// Ask the service for the next signal that is not blocked by this thread
+		uapi::sigset_t blocked = GetBlockedSignals();
+		int signal = static_cast<int>(sys32_sigdequeue(t_rpccontext, blocked, &siginfo, &action));
+		if(signal == 0) return;
+
+		// If the service was unable to dequeue the signal, leave it pending so that delivery
+		// is attempted again on the way out of the next system call.  SIGKILL cannot be
+		// caught or ignored, so it terminates the process without the service
+		if(signal < 0) {
+
+			uapi::sigset_t pending = static_cast<uapi::sigset_t>(InterlockedCompareExchange64(reinterpret_cast<LONGLONG volatile*>(&t_sigstate->pending), 0, 0));
+			if(pending & uapi::sigmask(LINUX_SIGKILL)) DefaultSignalAction(LINUX_SIGKILL);
+			return;
+		}
+
+		// SIG_IGN / SIG_DFL do not require a signal frame to be constructed
+		if(action.sa_handler == reinterpret_cast<sys32_addr_t>(LINUX_SIG_IGN)) continue;
+		if(action.sa_handler == reinterpret_cast<sys32_addr_t>(LINUX_SIG_DFL)) { DefaultSignalAction(signal); continue; }
+
+		// Construct the signal frame below the current stack pointer, aligning it such that
+		// the stack is 16-byte aligned after the handler has pushed its frame pointer
+		uintptr_t sp = (((context->Esp - sizeof(rt_sigframe)) + 4) & ~uintptr_t(15)) - 4;
+		rt_sigframe* frame = reinterpret_cast<rt_sigframe*>(sp);
+
+		frame->sig = signal;
+		frame->pinfo = reinterpret_cast<uint32_t>(&frame->info);
+		frame->puc = reinterpret_cast<uint32_t>(&frame->uc);
+		memcpy(&frame->info, &siginfo, sizeof(uapi::siginfo));
+
+		// Save the interrupted context and the signal mask to restore in rt_sigreturn
+		memset(&frame->uc, 0, sizeof(uapi::ucontext32));
+		frame->uc.uc_mcontext.gs = t_gs;
+		frame->uc.uc_mcontext.fs = static_cast<uint16_t>(context->SegFs);
+		frame->uc.uc_mcontext.es = static_cast<uint16_t>(context->SegEs);
+		frame->uc.uc_mcontext.ds = static_cast<uint16_t>(context->SegDs);
+		frame->uc.uc_mcontext.edi = context->Edi;
+		frame->uc.uc_mcontext.esi = context->Esi;
+		frame->uc.uc_mcontext.ebp = context->Ebp;
+		frame->uc.uc_mcontext.esp = context->Esp;
+		frame->uc.uc_mcontext.ebx = context->Ebx;
+		frame->uc.uc_mcontext.edx = context->Edx;
+		frame->uc.uc_mcontext.ecx = context->Ecx;
+		frame->uc.uc_mcontext.eax = context->Eax;
+		frame->uc.uc_mcontext.eip = context->Eip;
+		frame->uc.uc_mcontext.cs = static_cast<uint16_t>(context->SegCs);
+		frame->uc.uc_mcontext.eflags = context->EFlags;
+		frame->uc.uc_mcontext.esp_at_signal = context->Esp;
+		frame->uc.uc_mcontext.ss = static_cast<uint16_t>(context->SegSs);
+		frame->uc.uc_mcontext.oldmask = static_cast<uint32_t>(blocked);
+		frame->uc.uc_sigmask = blocked;
+
+		// The handler returns into the application restorer or the host rt_sigreturn thunk;
+		// retcode is still written since debuggers use it to recognize a signal frame
+		// mov eax, 173 (rt_sigreturn); int 0x80
+		static const uint8_t retcode[] = { 0xB8, 0xAD, 0x00, 0x00, 0x00, 0xCD, 0x80, 0x00 };
+		memcpy(frame->retcode, retcode, sizeof(retcode));
+
+		frame->pretcode = (action.sa_flags & LINUX_SA_RESTORER) ? action.sa_restorer : reinterpret_cast<uint32_t>(SignalReturn);
+
+		// Block the signals specified by the action, including this one unless SA_NODEFER
+		uapi::sigset_t mask = blocked | action.sa_mask;
+		if((action.sa_flags & LINUX_SA_NODEFER) == 0) mask |= uapi::sigmask(signal);
+		SetBlockedSignals(mask);
+
+		// Redirect the thread into the signal handler; the regparm(3) arguments are
+		// provided in registers in addition to being on the stack
+		context->Esp = static_cast<DWORD>(sp);
+		context->Eip = action.sa_handler;
+		context->Eax = static_cast<DWORD>(signal);
+		context->Edx = frame->pinfo;
+		context->Ecx = frame->puc;
+
+		// Any remaining signals will be delivered on the way out of rt_sigreturn
+		return;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// SignalEntry
+//
+// Entry point used by the service to redirect a thread that was interrupted
+// while executing application code; the original context is restored by the
+// sys_sigentry pseudo system call
+//
+// Arguments:
+//
+//	NONE
+
+__declspec(naked) void SignalEntry(void)
+{
+	__asm mov eax, 511;
+	__asm int 0x80;
+}
+
+//-----------------------------------------------------------------------------
+// sys_rt_sigprocmask
+//
+// Examines and/or changes the blocked signal mask of the calling thread
+//
+// Arguments:
+//
+//	how			- Flag indicating how newmask should be interpreted
+//	newmask		- New signal mask to apply
+//	oldmask		- Receives the previous signal mask
+//	sigsetsize	- Size of the signal mask structures
+
+uapi::long_t sys_rt_sigprocmask(int how, const uapi::sigset_t* newmask, uapi::sigset_t* oldmask, size_t sigsetsize)
+{
+	if(sigsetsize != sizeof(uapi::sigset_t)) return -LINUX_EINVAL;
+
+	// Without a shared signal state the service maintains the blocked mask
+	if(t_sigstate == nullptr) return sys32_rt_sigprocmask(t_rpccontext, how, newmask, oldmask);
+
+	// Only the calling thread can change the blocked signal mask
+	uapi::sigset_t mask = GetBlockedSignals();
+	if(oldmask) *oldmask = mask;
+
+	if(newmask) {
+
+		switch(how) {
+
+			// SIG_BLOCK: Add the new mask bits to the existing mask
+			case LINUX_SIG_BLOCK: mask |= *newmask; break;
+
+			// SIG_UNBLOCK: Remove the mask bits from the existing mask
+			case LINUX_SIG_UNBLOCK: mask &= ~(*newmask); break;
+
+			// SIG_SETMASK: Replace the existing mask with the new mask
+			case LINUX_SIG_SETMASK: mask = *newmask; break;
+
+			default: return -LINUX_EINVAL;
+		}
+
+		// Signals that become unblocked are delivered on the way out of this call
+		SetBlockedSignals(mask);
+	}
+
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// sys_rt_sigreturn
+//
+// Returns from a signal handler, restoring the context saved in the frame
+//
+// Arguments:
+//
+//	context		- Pointer to the CONTEXT structure from the exception handler
+
+uapi::long_t sys_rt_sigreturn(PCONTEXT context)
+{
+	// The handler returned through pretcode, which popped it off of the stack
+	rt_sigframe* frame = reinterpret_cast<rt_sigframe*>(context->Esp - sizeof(uint32_t));
+
+	t_gs = frame->uc.uc_mcontext.gs;
+	context->Edi = frame->uc.uc_mcontext.edi;
+	context->Esi = frame->uc.uc_mcontext.esi;
+	context->Ebp = frame->uc.uc_mcontext.ebp;
+	context->Esp = frame->uc.uc_mcontext.esp;
+	context->Ebx = frame->uc.uc_mcontext.ebx;
+	context->Edx = frame->uc.uc_mcontext.edx;
+	context->Ecx = frame->uc.uc_mcontext.ecx;
+	context->Eip = frame->uc.uc_mcontext.eip;
+
+	// Only allow the application to restore the arithmetic and direction flags
+	const DWORD flagmask = 0x00000CD5;
+	context->EFlags = (context->EFlags & ~flagmask) | (frame->uc.uc_mcontext.eflags & flagmask);
+
+	if(t_sigstate) SetBlockedSignals(frame->uc.uc_sigmask);
+
+	// The return value becomes EAX, which needs to be the original value
+	return static_cast<uapi::long_t>(frame->uc.uc_mcontext.eax);
+}
+
+//-----------------------------------------------------------------------------
+// sys_sigentry
+//
+// Pseudo system call made by SignalEntry, restores the context that was saved
+// by the service when it interrupted the thread
+//
+// Arguments:
+//
+//	context		- Pointer to the CONTEXT structure from the exception handler
+
+uapi::long_t sys_sigentry(PCONTEXT context)
+{
+	static_assert(sizeof(sys32_task_t) == sizeof(CONTEXT), "sys32_task_t is not equivalent to CONTEXT");
+
+	if((t_sigstate == nullptr) || (t_sigstate->interrupted == 0)) return -LINUX_ENOSYS;
+
+	// Restore the original context, pending signals will be delivered on the way out
+	memcpy(context, &t_sigstate->task, sizeof(CONTEXT));
+	InterlockedExchange(reinterpret_cast<LONG volatile*>(&t_sigstate->interrupted), 0);
+
+	// The return value becomes EAX, which needs to be the original value
+	return static_cast<uapi::long_t>(context->Eax);
+}
+
+//-----------------------------------------------------------------------------
+// sys_sigprocmask
+//
+// Examines and/or changes the blocked signal mask of the calling thread
+//
+// Arguments:
+//
+//	how			- Flag indicating how newmask should be interpreted
+//	newmask		- New signal mask to apply
+//	oldmask		- Receives the previous signal mask
+
+uapi::long_t sys_sigprocmask(int how, const uapi::old_sigset_t* newmask, uapi::old_sigset_t* oldmask)
+{
+	uapi::sigset_t		oldset;			// Previous signal mask
+
+	// Without a shared signal state the service maintains the blocked mask
+	if(t_sigstate == nullptr) return sys32_sigprocmask(t_rpccontext, how, newmask, oldmask);
+
+	// The old signal mask only operates against the first 32 signals
+	uapi::sigset_t newset = (newmask) ? *newmask : 0;
+	if(newmask && (how == LINUX_SIG_SETMASK)) newset |= (GetBlockedSignals() & 0xFFFFFFFF00000000);
+
+	uapi::long_t result = sys_rt_sigprocmask(how, (newmask) ? &newset : nullptr, &oldset, sizeof(uapi::sigset_t));
+	if((result == 0) && oldmask) *oldmask = static_cast<uapi::old_sigset_t>(oldset);
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -26,9 +26,9 @@
 
 // Target Versions
 //
-#define NTDDI_VERSION			NTDDI_WIN7
-#define	_WIN32_WINNT			_WIN32_WINNT_WIN7
-#define WINVER					_WIN32_WINNT_WIN7
+#define NTDDI_VERSION			NTDDI_WIN8
+#define	_WIN32_WINNT			_WIN32_WINNT_WIN8
+#define WINVER					_WIN32_WINNT_WIN8
 #define	_WIN32_IE				_WIN32_IE_IE80
 
 // Windows / CRT
@@ -0,0 +1,464 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "syscalls.h"
+
+#include "MonotonicClock.h"
+
+#pragma warning(push, 4)
+
+// t_rpccontext (main.cpp)
+//
+// RPC context handle for the current thread
+extern __declspec(thread) sys32_context_t t_rpccontext;
+
+// t_sigstate (main.cpp)
+//
+// Thread-local signal state shared with the service
+extern __declspec(thread) sys32_sigstate_t* t_sigstate;
+
+// FUTEX_BUCKETS
+//
+// Number of hash buckets used to track process-private futex waiters
+#define FUTEX_BUCKETS		256
+
+// FUTEX_SIGNAL_INTERVAL
+//
+// Maximum time, in milliseconds, that a futex wait goes without checking for
+// signals; the service does not interrupt a thread that is in a system call
+#define FUTEX_SIGNAL_INTERVAL	10
+
+// futexwaiter_t
+//
+// Thread waiting on a process-private futex; a waiter lives on the stack of
+// the waiting thread and is only accessed by other threads under the bucket lock
+struct futexwaiter_t
+{
+	futexwaiter_t*		next;			// Next waiter in the bucket
+	futexwaiter_t*		prev;			// Previous waiter in the bucket
+	uint32_t*			address;		// Address of the futex word
+	uint32_t			bitset;			// FUTEX_WAIT_BITSET mask
+	volatile LONG		signaled;		// Set when the waiter has been woken
+};
+
+// futexbucket_t
+//
+// Hash bucket of process-private futex waiters, in the order they started waiting
+struct futexbucket_t
+{
+	SRWLOCK				lock;			// Synchronization object
+	futexwaiter_t*		head;			// First waiter in the bucket
+	futexwaiter_t*		tail;			// Last waiter in the bucket
+};
+
+// g_futexbuckets
+//
+// Process-private futex waiters; zero-initialization is SRWLOCK_INIT
+static futexbucket_t g_futexbuckets[FUTEX_BUCKETS];
+
+//-----------------------------------------------------------------------------
+// FutexBucket (static)
+//
+// Gets the hash bucket that tracks the waiters for a futex address
+//
+// Arguments:
+//
+//	address		- Address of the futex word
+
+static futexbucket_t* FutexBucket(const uint32_t* address)
+{
+	// Futex words are 32-bit aligned, discard the low bits before hashing the address
+	uint32_t hash = (static_cast<uint32_t>(reinterpret_cast<uintptr_t>(address)) >> 2) * 2654435761U;
+	return &g_futexbuckets[(hash >> 24) % FUTEX_BUCKETS];
+}
+
+//-----------------------------------------------------------------------------
+// FutexDeadline (static)
+//
+// Converts a futex timeout into a MonotonicClock deadline, zero indicates no timeout
+//
+// Arguments:
+//
+//	timeout		- Timeout specified by the caller, can be NULL
+//	absolute	- Flag indicating that the timeout is an absolute time
+//	realtime	- Flag indicating that an absolute timeout is measured against CLOCK_REALTIME
+//	deadline	- Receives the deadline
+
+static uapi::long_t FutexDeadline(const linux_timespec32* timeout, bool absolute, bool realtime, uint64_t* deadline)
+{
+	*deadline = 0;
+	if(timeout == nullptr) return 0;
+
+	if((timeout->tv_sec < 0) || (timeout->tv_nsec < 0) || (timeout->tv_nsec >= 1000000000)) return -LINUX_EINVAL;
+
+	uint64_t now = MonotonicClock::Now();
+	uint64_t nanoseconds = (static_cast<uint64_t>(timeout->tv_sec) * 1000000000ULL) + static_cast<uint64_t>(timeout->tv_nsec);
+
+	if(!absolute) *deadline = now + nanoseconds;
+
+	// CLOCK_REALTIME deadlines are converted from the UNIX epoch into a relative interval
+	else if(realtime) {
+
+		ULARGE_INTEGER filetime;
+		GetSystemTimeAsFileTime(reinterpret_cast<FILETIME*>(&filetime));
+		uint64_t epoch = (filetime.QuadPart - 116444736000000000ULL) * 100;
+
+		*deadline = now + ((nanoseconds > epoch) ? (nanoseconds - epoch) : 0);
+	}
+
+	// CLOCK_MONOTONIC deadlines are already measured against MonotonicClock
+	else *deadline = nanoseconds;
+
+	// A deadline of zero indicates no timeout, an expired deadline must remain non-zero
+	if(*deadline == 0) *deadline = 1;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// FutexDequeue (static)
+//
+// Removes a waiter from a bucket; the bucket lock must be held
+//
+// Arguments:
+//
+//	bucket		- Bucket that contains the waiter
+//	waiter		- Waiter to be removed
+
+static void FutexDequeue(futexbucket_t* bucket, futexwaiter_t* waiter)
+{
+	if(waiter->prev) waiter->prev->next = waiter->next;
+	else bucket->head = waiter->next;
+
+	if(waiter->next) waiter->next->prev = waiter->prev;
+	else bucket->tail = waiter->prev;
+
+	waiter->next = waiter->prev = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// FutexEnqueue (static)
+//
+// Appends a waiter to a bucket; the bucket lock must be held
+//
+// Arguments:
+//
+//	bucket		- Bucket to append the waiter to
+//	waiter		- Waiter to be appended
+
+static void FutexEnqueue(futexbucket_t* bucket, futexwaiter_t* waiter)
+{
+	waiter->next = nullptr;
+	waiter->prev = bucket->tail;
+
+	if(bucket->tail) bucket->tail->next = waiter;
+	else bucket->head = waiter;
+
+	bucket->tail = waiter;
+}
+
+//-----------------------------------------------------------------------------
+// FutexLoad (static)
+//
+// Reads the current value of a futex word, returns false if the address is invalid
+//
+// Arguments:
+//
+//	address		- Address of the futex word
+//	value		- Receives the current value
+
+static bool FutexLoad(const uint32_t* address, uint32_t* value)
+{
+	// This is invoked with a bucket lock held, an invalid address cannot be allowed
+	// to unwind into the system call dispatcher and leave the lock acquired
+	__try { *value = *reinterpret_cast<const volatile uint32_t*>(address); return true; }
+	__except(EXCEPTION_EXECUTE_HANDLER) { return false; }
+}
+
+//-----------------------------------------------------------------------------
+// FutexSignal (static)
+//
+// Removes a waiter from a bucket and wakes it; the bucket lock must be held
+//
+// Arguments:
+//
+//	bucket		- Bucket that contains the waiter
+//	waiter		- Waiter to be woken
+
+static void FutexSignal(futexbucket_t* bucket, futexwaiter_t* waiter)
+{
+	FutexDequeue(bucket, waiter);
+
+	// The waiting thread can release the waiter as soon as it observes the signal outside
+	// of the bucket lock; waking a stale address only results in a spurious WaitOnAddress return
+	void* signaled = const_cast<LONG*>(&waiter->signaled);
+	InterlockedExchange(&waiter->signaled, 1);
+	WakeByAddressSingle(signaled);
+}
+
+//-----------------------------------------------------------------------------
+// FutexRequeue (static)
+//
+// Wakes waiters on a futex and moves the remaining waiters to another futex
+//
+// Arguments:
+//
+//	address		- Address of the source futex word
+//	address2	- Address of the target futex word
+//	wake		- Maximum number of waiters to wake
+//	requeue		- Maximum number of waiters to requeue
+//	compare		- Optional value that the source futex word must contain (FUTEX_CMP_REQUEUE)
+
+static uapi::long_t FutexRequeue(uint32_t* address, uint32_t* address2, uint32_t wake, uint32_t requeue, const uint32_t* compare)
+{
+	uint32_t				woken = 0;				// Number of waiters woken
+	uint32_t				moved = 0;				// Number of waiters requeued
+
+	futexbucket_t* source = FutexBucket(address);
+	futexbucket_t* target = FutexBucket(address2);
+
+	// Acquire both bucket locks in a consistent order to prevent a deadlock
+	if(source == target) AcquireSRWLockExclusive(&source->lock);
+	else {
+
+		AcquireSRWLockExclusive((source < target) ? &source->lock : &target->lock);
+		AcquireSRWLockExclusive((source < target) ? &target->lock : &source->lock);
+	}
+
+	uapi::long_t result = 0;
+	uint32_t value = 0;
+
+	if(compare && !FutexLoad(address, &value)) result = -LINUX_EFAULT;
+	else if(compare && (value != *compare)) result = -LINUX_EAGAIN;
+
+	else {
+
+		futexwaiter_t* waiter = source->head;
+		while(waiter && ((woken < wake) || (moved < requeue))) {
+
+			futexwaiter_t* next = waiter->next;
+			if(waiter->address == address) {
+
+				if(woken < wake) { FutexSignal(source, waiter); woken++; }
+				else {
+
+					// The waiter continues to wait, but on the target futex
+					FutexDequeue(source, waiter);
+					waiter->address = address2;
+					FutexEnqueue(target, waiter);
+					moved++;
+				}
+			}
+
+			waiter = next;
+		}
+
+		result = static_cast<uapi::long_t>(woken + moved);
+	}
+
+	if(source != target) ReleaseSRWLockExclusive(&target->lock);
+	ReleaseSRWLockExclusive(&source->lock);
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// FutexWait (static)
+//
+// Waits for a process-private futex to be woken
+//
+// Arguments:
+//
+//	address		- Address of the futex word
+//	value		- Expected value of the futex word
+//	bitset		- Bitmask of FUTEX_WAKE_BITSET operations that can wake the waiter
+//	deadline	- MonotonicClock deadline for the wait, or zero to wait indefinitely
+
+static uapi::long_t FutexWait(uint32_t* address, uint32_t value, uint32_t bitset, uint64_t deadline)
+{
+	uapi::long_t			result = 0;				// Result from the wait
+	futexwaiter_t			waiter = { nullptr, nullptr, address, bitset, 0 };
+	LONG					unsignaled = 0;			// Comparison value for WaitOnAddress
+	uint32_t				current;				// Current value of the futex word
+
+	futexbucket_t* bucket = FutexBucket(address);
+	AcquireSRWLockExclusive(&bucket->lock);
+
+	// The value has to be compared with the bucket locked; a thread that changes the value
+	// and then wakes the futex cannot acquire the bucket lock until the waiter is queued
+	if(!FutexLoad(address, &current)) { ReleaseSRWLockExclusive(&bucket->lock); return -LINUX_EFAULT; }
+	if(current != value) { ReleaseSRWLockExclusive(&bucket->lock); return -LINUX_EAGAIN; }
+
+	FutexEnqueue(bucket, &waiter);
+	ReleaseSRWLockExclusive(&bucket->lock);
+
+	// The service won't interrupt a thread that is in a system call to deliver a signal,
+	// so the wait is broken into intervals that check for a deliverable signal (EINTR)
+	while(waiter.signaled == 0) {
+
+		if(t_sigstate) {
+
+			uapi::sigset_t pending = static_cast<uapi::sigset_t>(InterlockedCompareExchange64(reinterpret_cast<LONGLONG volatile*>(&t_sigstate->pending), 0, 0));
+			uapi::sigset_t blocked = static_cast<uapi::sigset_t>(InterlockedCompareExchange64(reinterpret_cast<LONGLONG volatile*>(&t_sigstate->blocked), 0, 0));
+			if(pending & ~blocked) { result = -LINUX_EINTR; break; }
+		}
+
+		DWORD timeout = FUTEX_SIGNAL_INTERVAL;
+		if(deadline) {
+
+			// Round the remaining time up to the next millisecond, a wait must never end early
+			uint64_t now = MonotonicClock::Now();
+			if(now >= deadline) { result = -LINUX_ETIMEDOUT; break; }
+			timeout = static_cast<DWORD>(min((deadline - now + 999999) / 1000000, static_cast<uint64_t>(FUTEX_SIGNAL_INTERVAL)));
+		}
+
+		// WaitOnAddress can return spuriously, only the signaled flag indicates a wake
+		WaitOnAddress(&waiter.signaled, &unsignaled, sizeof(LONG), timeout);
+	}
+
+	if(waiter.signaled) return 0;
+
+	// The wait timed out or was interrupted, but the waiter may have been woken or requeued
+	// to another bucket before it could be removed; the bucket can only change under its lock
+	while(true) {
+
+		bucket = FutexBucket(waiter.address);
+		AcquireSRWLockExclusive(&bucket->lock);
+		if(bucket == FutexBucket(waiter.address)) break;
+		ReleaseSRWLockExclusive(&bucket->lock);
+	}
+
+	if(waiter.signaled) result = 0;
+	else FutexDequeue(bucket, &waiter);
+
+	ReleaseSRWLockExclusive(&bucket->lock);
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// FutexWake
+//
+// Wakes threads waiting on a process-private futex, returns the number woken
+//
+// Arguments:
+//
+//	address		- Address of the futex word
+//	count		- Maximum number of waiters to wake
+//	bitset		- Bitmask of FUTEX_WAIT_BITSET waiters that can be woken
+
+uapi::long_t FutexWake(uint32_t* address, uint32_t count, uint32_t bitset)
+{
+	uint32_t				woken = 0;				// Number of waiters woken
+
+	futexbucket_t* bucket = FutexBucket(address);
+	AcquireSRWLockExclusive(&bucket->lock);
+
+	futexwaiter_t* waiter = bucket->head;
+	while(waiter && (woken < count)) {
+
+		futexwaiter_t* next = waiter->next;
+		if((waiter->address == address) && (waiter->bitset & bitset)) { FutexSignal(bucket, waiter); woken++; }
+		waiter = next;
+	}
+
+	ReleaseSRWLockExclusive(&bucket->lock);
+	return static_cast<uapi::long_t>(woken);
+}
+
+//-----------------------------------------------------------------------------
+// sys_futex
+//
+// Fast user-space locking.  Process-private futexes (FUTEX_PRIVATE_FLAG) are
+// implemented entirely within the host process, futexes that may be shared
+// with other processes are forwarded to the service
+//
+// Arguments:
+//
+//	context		- Pointer to the CONTEXT structure from the exception handler
+
+uapi::long_t sys_futex(PCONTEXT context)
+{
+	uint64_t				deadline;				// Wait deadline
+
+	// Cast out the arguments to sys_futex; the fourth argument is either a timeout or val2
+	uint32_t*					uaddr	= reinterpret_cast<uint32_t*>(context->Ebx);
+	int							op		= static_cast<int>(context->Ecx);
+	uint32_t					val		= static_cast<uint32_t>(context->Edx);
+	const linux_timespec32*		timeout	= reinterpret_cast<const linux_timespec32*>(context->Esi);
+	uint32_t					val2	= static_cast<uint32_t>(context->Esi);
+	uint32_t*					uaddr2	= reinterpret_cast<uint32_t*>(context->Edi);
+	uint32_t					val3	= static_cast<uint32_t>(context->Ebp);
+
+	// Futexes that can be shared with other processes are tracked by the service
+	if((op & LINUX_FUTEX_PRIVATE_FLAG) == 0) 
+		return sys32_futex(t_rpccontext, context->Ebx, static_cast<sys32_int_t>(context->Ecx), context->Edx, context->Esi, context->Edi, context->Ebp);
+
+	// Futex words must be naturally aligned
+	if(reinterpret_cast<uintptr_t>(uaddr) & (sizeof(uint32_t) - 1)) return -LINUX_EINVAL;
+
+	int command = op & LINUX_FUTEX_CMD_MASK;
+	bool realtime = ((op & LINUX_FUTEX_CLOCK_REALTIME) == LINUX_FUTEX_CLOCK_REALTIME);
+	if(realtime && (command != LINUX_FUTEX_WAIT) && (command != LINUX_FUTEX_WAIT_BITSET)) return -LINUX_ENOSYS;
+
+	switch(command) {
+
+		// FUTEX_WAIT
+		//
+		// The timeout is relative, regardless of FUTEX_CLOCK_REALTIME
+		case LINUX_FUTEX_WAIT: {
+
+			uapi::long_t result = FutexDeadline(timeout, false, realtime, &deadline);
+			return (result == 0) ? FutexWait(uaddr, val, LINUX_FUTEX_BITSET_MATCH_ANY, deadline) : result;
+		}
+
+		// FUTEX_WAIT_BITSET
+		//
+		// The timeout is absolute, measured against CLOCK_MONOTONIC unless FUTEX_CLOCK_REALTIME was set
+		case LINUX_FUTEX_WAIT_BITSET: {
+
+			if(val3 == 0) return -LINUX_EINVAL;
+			uapi::long_t result = FutexDeadline(timeout, true, realtime, &deadline);
+			return (result == 0) ? FutexWait(uaddr, val, val3, deadline) : result;
+		}
+
+		// FUTEX_WAKE / FUTEX_WAKE_BITSET
+		//
+		case LINUX_FUTEX_WAKE: return FutexWake(uaddr, val, LINUX_FUTEX_BITSET_MATCH_ANY);
+		case LINUX_FUTEX_WAKE_BITSET: return (val3) ? FutexWake(uaddr, val, val3) : -LINUX_EINVAL;
+
+		// FUTEX_REQUEUE / FUTEX_CMP_REQUEUE
+		//
+		case LINUX_FUTEX_REQUEUE:
+		case LINUX_FUTEX_CMP_REQUEUE:
+
+			if(reinterpret_cast<uintptr_t>(uaddr2) & (sizeof(uint32_t) - 1)) return -LINUX_EINVAL;
+			return FutexRequeue(uaddr, uaddr2, val, val2, (command == LINUX_FUTEX_CMP_REQUEUE) ? &val3 : nullptr);
+	}
+
+	// todo: FUTEX_WAKE_OP and the priority-inheritance operations
+	return -LINUX_ENOSYS;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
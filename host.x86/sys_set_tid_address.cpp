@@ -0,0 +1,57 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "syscalls.h"
+
+#pragma warning(push, 4)
+
+// t_cleartid (main.cpp)
+//
+// Thread-local address to clear and wake when the thread exits
+extern __declspec(thread) uapi::pid_t* t_cleartid;
+
+// t_rpccontext (main.cpp)
+//
+// RPC context handle for the current thread
+extern __declspec(thread) sys32_context_t t_rpccontext;
+
+//-----------------------------------------------------------------------------
+// sys_set_tid_address
+//
+// Sets a pointer to the thread id.  See set_tid_address(2) for more details.
+//
+// Arguments:
+//
+//	tidptr		- Address to clear and wake when the thread exits
+
+uapi::long_t sys_set_tid_address(uapi::pid_t* tidptr)
+{
+	// The thread id is cleared and woken by the host when the thread exits, the
+	// service still needs to be informed to track the address and get the thread id
+	t_cleartid = tidptr;
+	return sys32_set_tid_address(t_rpccontext, reinterpret_cast<sys32_addr_t>(tidptr));
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -141,12 +141,12 @@ syscall_t g_syscalls[512] = {
 /* 034 */	sys_noentry,
 /* 035 */	sys_noentry,
 /* 036 */	sys_noentry,
-/* 037 */	sys_noentry,
+/* 037 */	REMOTE_SYSCALL_2(sys32_kill, sys32_pid_t, sys32_int_t),
 /* 038 */	sys_noentry,
 /* 039 */	REMOTE_SYSCALL_2(sys32_mkdir, const sys32_char_t*, sys32_mode_t),
 /* 040 */	sys_noentry,
 /* 041 */	sys_noentry,
-/* 042 */	sys_noentry,
+/* 042 */	REMOTE_SYSCALL_1(sys32_pipe, sys32_int_t*),
 /* 043 */	sys_noentry,
 /* 044 */	sys_noentry,
 /* 045 */	REMOTE_SYSCALL_1(sys32_brk, sys32_addr_t),
@@ -230,13 +230,13 @@ syscall_t g_syscalls[512] = {
 /* 123 */	sys_noentry,
 /* 124 */	sys_noentry,
 /* 125 */	REMOTE_SYSCALL_3(sys32_mprotect, sys32_addr_t, sys32_size_t, sys32_int_t),
-/* 126 */	REMOTE_SYSCALL_3(sys32_sigprocmask, sys32_int_t, const sys32_old_sigset_t*, sys32_old_sigset_t*),
+/* 126 */	LOCAL_SYSCALL_3(sys_sigprocmask, int, const uapi::old_sigset_t*, uapi::old_sigset_t*),
 /* 127 */	sys_noentry,
 /* 128 */	sys_noentry,
 /* 129 */	sys_noentry,
 /* 130 */	sys_noentry,
 /* 131 */	sys_noentry,
-/* 132 */	sys_noentry,
+/* 132 */	REMOTE_SYSCALL_1(sys32_getpgid, sys32_pid_t),
 /* 133 */	sys_noentry,
 /* 134 */	sys_noentry,
 /* 135 */	sys_noentry,
@@ -251,7 +251,7 @@ syscall_t g_syscalls[512] = {
 /* 144 */	sys_noentry,
 /* 145 */	sys_noentry,
 /* 146 */	REMOTE_SYSCALL_3(sys32_writev, sys32_int_t, sys32_iovec_t*, sys32_int_t),
-/* 147 */	sys_noentry,
+/* 147 */	REMOTE_SYSCALL_1(sys32_getsid, sys32_pid_t),
 /* 148 */	sys_noentry,
 /* 149 */	sys_noentry,
 /* 150 */	sys_noentry,
@@ -277,9 +277,9 @@ syscall_t g_syscalls[512] = {
 /* 170 */	sys_noentry,
 /* 171 */	sys_noentry,
 /* 172 */	REMOTE_SYSCALL_5(sys32_prctl, sys32_int_t, sys32_ulong_t, sys32_ulong_t, sys32_ulong_t, sys32_ulong_t),
-/* 173 */	REMOTE_SYSCALL_0(sys32_rt_sigreturn),
+/* 173 */	CONTEXT_SYSCALL(sys_rt_sigreturn),
 /* 174 */	REMOTE_SYSCALL_4(sys32_rt_sigaction, sys32_int_t, sys32_sigaction_t*, sys32_sigaction_t*, sys32_size_t),
-/* 175 */	REMOTE_SYSCALL_3(sys32_rt_sigprocmask, sys32_int_t, const sys32_sigset_t*, sys32_sigset_t*),
+/* 175 */	LOCAL_SYSCALL_4(sys_rt_sigprocmask, int, const uapi::sigset_t*, uapi::sigset_t*, size_t),
 /* 176 */	sys_noentry,
 /* 177 */	sys_noentry,
 /* 178 */	sys_noentry,
@@ -291,7 +291,7 @@ syscall_t g_syscalls[512] = {
 /* 184 */	sys_noentry,
 /* 185 */	sys_noentry,
 /* 186 */	REMOTE_SYSCALL_2(sys32_sigaltstack, const sys32_stack_t*, sys32_stack_t*),
-/* 187 */	sys_noentry,
+/* 187 */	REMOTE_SYSCALL_4(sys32_sendfile, sys32_int_t, sys32_int_t, sys32_off_t*, sys32_size_t),
 /* 188 */	sys_noentry,
 /* 189 */	sys_noentry,
 /* 190 */	CONTEXT_SYSCALL(sys_vfork),
@@ -324,7 +324,7 @@ syscall_t g_syscalls[512] = {
 /* 217 */	sys_noentry,
 /* 218 */	sys_noentry,
 /* 219 */	REMOTE_SYSCALL_3(sys32_madvise, sys32_addr_t, sys32_size_t, sys32_int_t),
-/* 220 */	sys_noentry,
+/* 220 */	REMOTE_SYSCALL_3(sys32_getdents64, sys32_int_t, sys32_uchar_t*, sys32_uint_t),
 /* 221 */	REMOTE_SYSCALL_3(sys32_fcntl64, sys32_int_t, sys32_int_t, sys32_addr_t),
 /* 222 */	sys_noentry,
 /* 223 */	sys_noentry,
@@ -343,8 +343,8 @@ syscall_t g_syscalls[512] = {
 /* 236 */	sys_noentry,
 /* 237 */	sys_noentry,
 /* 238 */	sys_noentry,
-/* 239 */	sys_noentry,
-/* 240 */	sys_noentry,
+/* 239 */	REMOTE_SYSCALL_4(sys32_sendfile64, sys32_int_t, sys32_int_t, sys32_loff_t*, sys32_size_t),
+/* 240 */	CONTEXT_SYSCALL(sys_futex),
 /* 241 */	sys_noentry,
 /* 242 */	sys_noentry,
 /* 243 */	REMOTE_SYSCALL_1(sys32_set_thread_area, linux_user_desc32*),
@@ -362,7 +362,7 @@ syscall_t g_syscalls[512] = {
 /* 255 */	sys_noentry,
 /* 256 */	sys_noentry,
 /* 257 */	sys_noentry,
-/* 258 */	REMOTE_SYSCALL_1(sys32_set_tid_address, sys32_addr_t),
+/* 258 */	LOCAL_SYSCALL_1(sys_set_tid_address, uapi::pid_t*),
 /* 259 */	sys_noentry,
 /* 260 */	sys_noentry,
 /* 261 */	sys_noentry,
@@ -395,9 +395,9 @@ syscall_t g_syscalls[512] = {
 /* 288 */	sys_noentry,
 /* 289 */	sys_noentry,
 /* 290 */	sys_noentry,
-/* 291 */	sys_noentry,
-/* 292 */	sys_noentry,
-/* 293 */	sys_noentry,
+/* 291 */	REMOTE_SYSCALL_0(sys32_inotify_init),
+/* 292 */	REMOTE_SYSCALL_3(sys32_inotify_add_watch, sys32_int_t, const sys32_char_t*, sys32_uint_t),
+/* 293 */	REMOTE_SYSCALL_2(sys32_inotify_rm_watch, sys32_int_t, sys32_int_t),
 /* 294 */	sys_noentry,
 /* 295 */	REMOTE_SYSCALL_4(sys32_openat, sys32_int_t, const sys32_char_t*, sys32_int_t, sys32_mode_t),
 /* 296 */	REMOTE_SYSCALL_3(sys32_mkdirat, sys32_int_t, const sys32_char_t*, sys32_mode_t),
@@ -417,9 +417,9 @@ syscall_t g_syscalls[512] = {
 /* 310 */	sys_noentry,
 /* 311 */	sys_noentry,
 /* 312 */	sys_noentry,
-/* 313 */	sys_noentry,
+/* 313 */	REMOTE_SYSCALL_6(sys32_splice, sys32_int_t, sys32_loff_t*, sys32_int_t, sys32_loff_t*, sys32_size_t, sys32_uint_t),
 /* 314 */	sys_noentry,
-/* 315 */	sys_noentry,
+/* 315 */	REMOTE_SYSCALL_4(sys32_tee, sys32_int_t, sys32_int_t, sys32_size_t, sys32_uint_t),
 /* 316 */	sys_noentry,
 /* 317 */	sys_noentry,
 /* 318 */	sys_noentry,
@@ -435,8 +435,8 @@ syscall_t g_syscalls[512] = {
 /* 328 */	sys_noentry,
 /* 329 */	sys_noentry,
 /* 330 */	sys_noentry,
-/* 331 */	sys_noentry,
-/* 332 */	sys_noentry,
+/* 331 */	REMOTE_SYSCALL_2(sys32_pipe2, sys32_int_t*, sys32_int_t),
+/* 332 */	REMOTE_SYSCALL_1(sys32_inotify_init1, sys32_int_t),
 /* 333 */	sys_noentry,
 /* 334 */	sys_noentry,
 /* 335 */	sys_noentry,
@@ -463,25 +463,25 @@ syscall_t g_syscalls[512] = {
 /* 356 */	sys_noentry,
 /* 357 */	sys_noentry,
 /* 358 */	sys_noentry,
-/* 359 */	sys_noentry,
-/* 360 */	sys_noentry,
-/* 361 */	sys_noentry,
-/* 362 */	sys_noentry,
-/* 363 */	sys_noentry,
-/* 364 */	sys_noentry,
+/* 359 */	REMOTE_SYSCALL_3(sys32_socket, sys32_int_t, sys32_int_t, sys32_int_t),
+/* 360 */	REMOTE_SYSCALL_4(sys32_socketpair, sys32_int_t, sys32_int_t, sys32_int_t, sys32_int_t*),
+/* 361 */	REMOTE_SYSCALL_3(sys32_bind, sys32_int_t, const sys32_uchar_t*, sys32_uint_t),
+/* 362 */	REMOTE_SYSCALL_3(sys32_connect, sys32_int_t, const sys32_uchar_t*, sys32_uint_t),
+/* 363 */	REMOTE_SYSCALL_2(sys32_listen, sys32_int_t, sys32_int_t),
+/* 364 */	REMOTE_SYSCALL_4(sys32_accept4, sys32_int_t, sys32_addr_t, sys32_addr_t, sys32_int_t),
 /* 365 */	sys_noentry,
 /* 366 */	sys_noentry,
-/* 367 */	sys_noentry,
-/* 368 */	sys_noentry,
-/* 369 */	sys_noentry,
-/* 370 */	sys_noentry,
-/* 371 */	sys_noentry,
-/* 372 */	sys_noentry,
-/* 373 */	sys_noentry,
+/* 367 */	REMOTE_SYSCALL_3(sys32_getsockname, sys32_int_t, sys32_addr_t, sys32_addr_t),
+/* 368 */	REMOTE_SYSCALL_3(sys32_getpeername, sys32_int_t, sys32_addr_t, sys32_addr_t),
+/* 369 */	REMOTE_SYSCALL_6(sys32_sendto, sys32_int_t, const sys32_uchar_t*, sys32_size_t, sys32_uint_t, const sys32_uchar_t*, sys32_uint_t),
+/* 370 */	REMOTE_SYSCALL_3(sys32_sendmsg, sys32_int_t, const sys32_msghdr_t*, sys32_uint_t),
+/* 371 */	REMOTE_SYSCALL_6(sys32_recvfrom, sys32_int_t, sys32_uchar_t*, sys32_size_t, sys32_uint_t, sys32_addr_t, sys32_addr_t),
+/* 372 */	REMOTE_SYSCALL_3(sys32_recvmsg, sys32_int_t, sys32_msghdr_t*, sys32_uint_t),
+/* 373 */	REMOTE_SYSCALL_2(sys32_shutdown, sys32_int_t, sys32_int_t),
 /* 374 */	sys_noentry,
 /* 375 */	sys_noentry,
 /* 376 */	sys_noentry,
-/* 377 */	sys_noentry,
+/* 377 */	REMOTE_SYSCALL_6(sys32_copy_file_range, sys32_int_t, sys32_loff_t*, sys32_int_t, sys32_loff_t*, sys32_size_t, sys32_uint_t),
 /* 378 */	sys_noentry,
 /* 379 */	sys_noentry,
 /* 380 */	sys_noentry,
@@ -615,7 +615,7 @@ syscall_t g_syscalls[512] = {
 /* 508 */	sys_noentry,
 /* 509 */	sys_noentry,
 /* 510 */	sys_noentry,
-/* 511 */	sys_noentry
+/* 511 */	CONTEXT_SYSCALL(sys_sigentry)
 };
 
 //-----------------------------------------------------------------------------
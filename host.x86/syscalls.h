@@ -39,12 +39,33 @@ extern syscall_t g_syscalls[512];
 // TODO: PUT FUNCTION PROTOTYPES FOR EACH ONE HERE
 extern uapi::long_t sys_noentry(PCONTEXT);
 
+// DeliverSignals (signals.cpp)
+//
+// Delivers the next pending signal on the way out of a system call
+extern void DeliverSignals(PCONTEXT);
+
+// FutexWake (sys_futex.cpp)
+//
+// Wakes threads waiting on a process-private futex
+extern uapi::long_t FutexWake(uint32_t* address, uint32_t count, uint32_t bitset);
+
+// SignalEntry (signals.cpp)
+//
+// Entry point used by the service to interrupt a thread for signal delivery
+extern void SignalEntry(void);
+
 /* 001 */ extern uapi::long_t sys_exit(PCONTEXT);
 /* 002 */ extern uapi::long_t sys_fork(PCONTEXT);
 /* 011 */ extern uapi::long_t sys_execve(const uapi::char_t*, const uapi::char_t* argv[], const uapi::char_t* envp[]);
 /* 120 */ extern uapi::long_t sys_clone(PCONTEXT);
+/* 126 */ extern uapi::long_t sys_sigprocmask(int, const uapi::old_sigset_t*, uapi::old_sigset_t*);
+/* 173 */ extern uapi::long_t sys_rt_sigreturn(PCONTEXT);
+/* 175 */ extern uapi::long_t sys_rt_sigprocmask(int, const uapi::sigset_t*, uapi::sigset_t*, size_t);
 /* 190 */ extern uapi::long_t sys_vfork(PCONTEXT);
+/* 240 */ extern uapi::long_t sys_futex(PCONTEXT);
 /* 252 */ extern uapi::long_t sys_exit_group(int status);
+/* 258 */ extern uapi::long_t sys_set_tid_address(uapi::pid_t* tidptr);
+/* 511 */ extern uapi::long_t sys_sigentry(PCONTEXT);
 
 //-----------------------------------------------------------------------------
 
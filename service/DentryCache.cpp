@@ -0,0 +1,516 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "DentryCache.h"
+
+#include "LinuxException.h"
+
+#pragma warning(push, 4)
+
+// INVALIDATE_EVENTS
+//
+// IN_xxx events reported by a parent node that invalidate the entry for a child name
+static const uint32_t INVALIDATE_EVENTS = LINUX_IN_CREATE | LINUX_IN_DELETE | LINUX_IN_MOVED_FROM | LINUX_IN_MOVED_TO;
+
+//-----------------------------------------------------------------------------
+// DentryCache Constructor (private)
+//
+// Arguments:
+//
+//	capacity	- Maximum number of entries to retain in the cache
+
+DentryCache::DentryCache(size_t capacity) : m_capacity(capacity), m_shardcapacity((capacity + ShardCount - 1) / ShardCount), 
+	m_hits(0), m_misses(0)
+{
+	_ASSERTE(capacity > 0);
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::getCapacity
+//
+// Gets the maximum number of entries retained in the cache
+
+size_t DentryCache::getCapacity(void) const
+{
+	return m_capacity;
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::Clear
+//
+// Removes all entries from the cache
+//
+// Arguments:
+//
+//	NONE
+
+void DentryCache::Clear(void)
+{
+	release_list_t released;			// Released parent trackers
+
+	for(auto& shard : m_shards) {
+
+		sync::critical_section::scoped_lock cs{ shard.cs };
+		while(!shard.lru.empty()) RemoveEntry(shard, std::prev(shard.lru.end()), released);
+	}
+
+	ReleaseParents(released);
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::getCount
+//
+// Gets the number of entries currently in the cache
+
+size_t DentryCache::getCount(void) const
+{
+	size_t count = 0;
+
+	for(auto const& shard : m_shards) {
+
+		sync::critical_section::scoped_lock cs{ shard.cs };
+		count += shard.entries.size();
+	}
+
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::Create (static)
+//
+// Creates a new DentryCache instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<DentryCache> DentryCache::Create(void)
+{
+	return Create(DefaultCapacity);
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::Create (static)
+//
+// Creates a new DentryCache instance
+//
+// Arguments:
+//
+//	capacity	- Maximum number of entries to retain in the cache
+
+std::shared_ptr<DentryCache> DentryCache::Create(size_t capacity)
+{
+	if(capacity == 0) throw LinuxException{ LINUX_EINVAL };
+	return std::make_shared<DentryCache>(capacity);
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::CreateParent (private)
+//
+// Creates the tracker for a parent alias and registers a watcher with the parent
+// node if it implements FileSystem::Watchable.  Must not be called with a shard
+// lock held, since a notification acquires the shard lock
+//
+// Arguments:
+//
+//	parent		- Parent alias instance
+
+std::shared_ptr<DentryCache::parent_t> DentryCache::CreateParent(std::shared_ptr<FileSystem::Alias> const& parent)
+{
+	auto tracker = std::make_shared<parent_t>();
+	tracker->key = parent.get();
+	tracker->alias = parent;
+	tracker->entries = 0;
+
+	auto node = parent->Node;
+	auto watchable = std::dynamic_pointer_cast<FileSystem::Watchable>(node);
+	if(watchable) {
+
+		tracker->node = node;
+		tracker->watch = std::make_shared<watch_t>(shared_from_this(), parent.get());
+		watchable->Watch(tracker->watch);
+	}
+
+	return tracker;
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::GetShard (private)
+//
+// Gets the shard that holds the entries for a parent alias
+//
+// Arguments:
+//
+//	parent		- Parent alias instance
+
+DentryCache::shard_t& DentryCache::GetShard(FileSystem::Alias const* parent)
+{
+	return m_shards[std::hash<FileSystem::Alias const*>()(parent) % ShardCount];
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::getHits
+//
+// Gets the number of lookups that were satisfied by the cache
+
+uint64_t DentryCache::getHits(void) const
+{
+	return m_hits;
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::Insert
+//
+// Inserts or replaces a lookup result; a negative result is discarded if the
+// parent node does not implement FileSystem::Watchable
+//
+// Arguments:
+//
+//	parent		- Parent alias instance
+//	name		- Child component name
+//	alias		- Child alias instance, or null for a negative entry
+
+void DentryCache::Insert(std::shared_ptr<FileSystem::Alias> const& parent, char_t const* name, std::shared_ptr<FileSystem::Alias> const& alias)
+{
+	std::shared_ptr<parent_t>	prepared;		// Tracker created outside the lock
+	release_list_t				released;		// Released parent trackers
+
+	if((parent == nullptr) || (name == nullptr)) return;
+
+	// Nothing would report the creation of the name if the parent can't be watched
+	if(!alias && !std::dynamic_pointer_cast<FileSystem::Watchable>(parent->Node)) return;
+
+	shard_t& shard = GetShard(parent.get());
+	key_t key{ parent.get(), name, strlen(name) };
+
+	// The watcher for a new parent tracker can't be registered with the shard lock
+	// held; if one is needed it's created after the lock is released and this retries
+	while(!TryInsert(shard, key, parent, alias, prepared, released)) prepared = CreateParent(parent);
+
+	// A tracker that was prepared but not used still has a registered watcher
+	if(prepared) released.push_back(std::move(prepared));
+	ReleaseParents(released);
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::Invalidate
+//
+// Removes all child entries of a parent alias
+//
+// Arguments:
+//
+//	parent		- Parent alias instance
+
+void DentryCache::Invalidate(FileSystem::Alias const* parent)
+{
+	release_list_t released;			// Released parent trackers
+
+	shard_t& shard = GetShard(parent);
+
+	// This requires a walk of the entire shard, it should only be necessary when
+	// a directory is removed or renamed, or when change notifications were lost
+	{
+		sync::critical_section::scoped_lock cs{ shard.cs };
+
+		for(auto iterator = shard.lru.begin(); iterator != shard.lru.end();) {
+
+			auto next = std::next(iterator);
+			if(iterator->key.parent == parent) RemoveEntry(shard, iterator, released);
+			iterator = next;
+		}
+	}
+
+	ReleaseParents(released);
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::Invalidate
+//
+// Removes a specific child entry of a parent alias
+//
+// Arguments:
+//
+//	parent		- Parent alias instance
+//	name		- Child component name
+
+void DentryCache::Invalidate(FileSystem::Alias const* parent, char_t const* name)
+{
+	release_list_t released;			// Released parent trackers
+
+	if((parent == nullptr) || (name == nullptr)) return;
+
+	shard_t& shard = GetShard(parent);
+	key_t key{ parent, name, strlen(name) };
+
+	{
+		sync::critical_section::scoped_lock cs{ shard.cs };
+
+		auto found = shard.entries.find(key);
+		if(found != shard.entries.end()) RemoveEntry(shard, found->second, released);
+	}
+
+	ReleaseParents(released);
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::IsCurrent (private, static)
+//
+// Determines if an entry belongs to a specific parent alias instance
+//
+// Arguments:
+//
+//	entry		- Cache entry to check
+//	parent		- Parent alias instance
+
+bool DentryCache::IsCurrent(entry_t const& entry, std::shared_ptr<FileSystem::Alias> const& parent)
+{
+	return entry.parent->alias.lock() == parent;
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::Lookup
+//
+// Retrieves a cached lookup result
+//
+// Arguments:
+//
+//	parent		- Parent alias instance
+//	name		- Child component name
+//	alias		- Receives the child alias, or null for a negative entry
+
+bool DentryCache::Lookup(std::shared_ptr<FileSystem::Alias> const& parent, char_t const* name, std::shared_ptr<FileSystem::Alias>& alias)
+{
+	std::shared_ptr<FileSystem::Alias>	child;			// Cached child alias
+	release_list_t						released;		// Released parent trackers
+
+	if((parent == nullptr) || (name == nullptr)) return false;
+
+	shard_t& shard = GetShard(parent.get());
+	key_t key{ parent.get(), name, strlen(name) };
+
+	// The child alias is declared outside of the lock so that if this holds the last
+	// reference to it, it is not released while the lock is held
+	{
+		sync::critical_section::scoped_lock cs{ shard.cs };
+
+		auto found = shard.entries.find(key);
+		if(found == shard.entries.end()) { ++m_misses; return false; }
+
+		// The entry is stale if it belongs to a released parent at the same address or
+		// if the child alias it refers to has been released since it was cached
+		child = found->second->alias.lock();
+		if(IsCurrent(*found->second, parent) && (child || found->second->negative)) {
+
+			// Move the entry to the front of the LRU list and return the cached result
+			shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+			alias = std::move(child);
+
+			++m_hits;
+			return true;
+		}
+
+		RemoveEntry(shard, found->second, released);
+	}
+
+	ReleaseParents(released);
+
+	++m_misses;
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::getMisses
+//
+// Gets the number of lookups that were not satisfied by the cache
+
+uint64_t DentryCache::getMisses(void) const
+{
+	return m_misses;
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::ReleaseParents (private, static)
+//
+// Unregisters the watchers of parent trackers that were released by RemoveEntry.
+// Must not be called with a shard lock held
+//
+// Arguments:
+//
+//	released	- Released parent trackers
+
+void DentryCache::ReleaseParents(release_list_t const& released)
+{
+	// Watchers can be removed from within a notification, see NotifyQueue
+	for(auto const& tracker : released) {
+
+		auto watchable = std::dynamic_pointer_cast<FileSystem::Watchable>(tracker->node.lock());
+		if(watchable) watchable->Unwatch(tracker->watch.get());
+	}
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::RemoveEntry (private, static)
+//
+// Removes an entry from a shard; the parent tracker is collected for release
+// along with the last entry for the parent.  Must be called with the shard lock
+// held, the collected trackers must be released after the lock is released
+//
+// Arguments:
+//
+//	shard		- Shard that contains the entry
+//	entry		- Entry to be removed
+//	released	- Collects released parent trackers
+
+void DentryCache::RemoveEntry(shard_t& shard, lru_list_t::iterator entry, release_list_t& released)
+{
+	auto tracker = std::move(entry->parent);
+
+	// The key refers to the name owned by the entry, remove it from the index first
+	shard.entries.erase(entry->key);
+	shard.lru.erase(entry);
+
+	if(--tracker->entries > 0) return;
+
+	// Only remove the tracker from the index if it hasn't been replaced already
+	auto found = shard.parents.find(tracker->key);
+	if((found != shard.parents.end()) && (found->second == tracker)) shard.parents.erase(found);
+
+	if(tracker->watch) released.push_back(std::move(tracker));
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::TryInsert (private)
+//
+// Inserts or replaces a lookup result in a shard.  Fails if the parent requires a
+// new tracker and one has not been prepared by the caller
+//
+// Arguments:
+//
+//	shard		- Shard that holds the entries for the parent
+//	key			- Key of the entry, referring to the caller's name buffer
+//	parent		- Parent alias instance
+//	alias		- Child alias instance, or null for a negative entry
+//	prepared	- Tracker prepared by the caller; consumed if used
+//	released	- Collects released parent trackers
+
+bool DentryCache::TryInsert(shard_t& shard, key_t const& key, std::shared_ptr<FileSystem::Alias> const& parent, 
+	std::shared_ptr<FileSystem::Alias> const& alias, std::shared_ptr<parent_t>& prepared, release_list_t& released)
+{
+	sync::critical_section::scoped_lock cs{ shard.cs };
+
+	// If the entry already exists for this parent replace the result and move it to the front,
+	// an entry left behind by a released parent at the same address is discarded instead
+	auto found = shard.entries.find(key);
+	if(found != shard.entries.end()) {
+
+		if(IsCurrent(*found->second, parent)) {
+
+			found->second->alias = alias;
+			found->second->negative = (alias == nullptr);
+			shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+			return true;
+		}
+
+		RemoveEntry(shard, found->second, released);
+	}
+
+	// Evict the least recently used entry if the shard is full; this is done before the
+	// tracker is acquired since it may release the tracker for this same parent
+	if(shard.entries.size() >= m_shardcapacity) RemoveEntry(shard, std::prev(shard.lru.end()), released);
+
+	// Use the existing tracker unless it belongs to a released alias at the same address,
+	// the entries that refer to an old tracker are discarded as they are encountered
+	std::shared_ptr<parent_t> tracker;
+	auto existing = shard.parents.find(parent.get());
+	if((existing != shard.parents.end()) && (existing->second->alias.lock() == parent)) tracker = existing->second;
+
+	if(!tracker) {
+
+		if(!prepared) return false;
+
+		tracker = std::move(prepared);
+		shard.parents[parent.get()] = tracker;
+	}
+
+	// The entry owns a copy of the name and the indexed key refers to that copy
+	shard.lru.emplace_front();
+	entry_t& entry = shard.lru.front();
+	try {
+
+		entry.name.assign(key.name, key.length);
+		entry.key = key_t{ key.parent, entry.name.c_str(), entry.name.length() };
+		entry.parent = tracker;
+		entry.alias = alias;
+		entry.negative = (alias == nullptr);
+
+		shard.entries.emplace(entry.key, shard.lru.begin());
+	}
+
+	catch(...) { shard.lru.pop_front(); throw; }
+
+	++tracker->entries;
+	return true;
+}
+
+//
+// DENTRYCACHE::WATCH_T
+//
+
+//-----------------------------------------------------------------------------
+// DentryCache::watch_t Constructor
+//
+// Arguments:
+//
+//	owner		- Owning DentryCache instance
+//	parent		- Parent alias used as the entry key
+
+DentryCache::watch_t::watch_t(std::weak_ptr<DentryCache> owner, FileSystem::Alias const* parent) : owner(std::move(owner)), parent(parent)
+{
+}
+
+//-----------------------------------------------------------------------------
+// DentryCache::watch_t::Notify
+//
+// Indicates that the watched node or a child of the watched node has changed
+//
+// Arguments:
+//
+//	mask		- IN_xxx events that occurred
+//	cookie		- Cookie that relates IN_MOVED_FROM and IN_MOVED_TO events
+//	name		- Name of the child that changed, or nullptr for the node itself
+
+void DentryCache::watch_t::Notify(uint32_t mask, uint32_t cookie, const char_t* name)
+{
+	UNREFERENCED_PARAMETER(cookie);
+
+	auto instance = owner.lock();
+	if(!instance) return;
+
+	// Lost events invalidate every entry for the parent, otherwise only the named child
+	if(mask & LINUX_IN_Q_OVERFLOW) instance->Invalidate(parent);
+	else if((mask & INVALIDATE_EVENTS) && name) instance->Invalidate(parent, name);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,322 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __DENTRYCACHE_H_
+#define __DENTRYCACHE_H_
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FileSystem.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// DentryCache
+//
+// Caches the results of directory lookups keyed by the parent alias and the
+// name of the child component.  Both positive (alias found) and negative (name
+// does not exist) results are cached, and the number of entries is bounded by
+// evicting the least recently used entry.
+//
+// A single instance is shared by a root namespace and every namespace cloned
+// from it, which makes the cache virtual machine wide.  Mount points are not
+// part of the cached result, they are resolved against the namespace after the
+// alias has been retrieved from the cache, so mount and unmount operations do
+// not require any invalidation.
+//
+// The cache holds only weak references to the parent and child aliases; it does
+// not keep nodes (and any host resources they own) alive, and an entry whose
+// alias has been released is discarded the next time it's looked up.
+//
+// Entries are invalidated through FileSystem::Watchable: the cache registers a
+// single watcher with each parent node that implements it and discards the entry
+// for any name that is reported as created, deleted or moved.  This covers the
+// changes made by the file systems themselves, including overlay copy-up into
+// a watched layer, as well as changes made on the host to a HostFileSystem
+// mount.  Negative results are not cached for a parent that isn't Watchable,
+// since nothing would report the creation of the name.  Operations at the
+// FileSystem level that create a child must still call Invalidate() once they
+// have completed, since the host reports changes asynchronously.
+//
+// The entries are divided among a fixed number of shards by parent alias, each
+// with its own lock and LRU list, so lookups of different directories do not
+// contend with each other.  Watchers are registered and unregistered outside
+// of the shard locks, since a notification acquires the shard lock to invalidate.
+//
+// The cache does not demand search permission on the parent for a cached
+// result, FileSystem::LookupPath does that before using the result.
+
+class DentryCache : public std::enable_shared_from_this<DentryCache>
+{
+public:
+
+	// Destructor
+	//
+	~DentryCache()=default;
+
+	//-------------------------------------------------------------------------
+	// Fields
+
+	// DefaultCapacity (static)
+	//
+	// Default maximum number of entries to retain in the cache
+	static const size_t DefaultCapacity = 16384;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Clear
+	//
+	// Removes all entries from the cache
+	void Clear(void);
+
+	// Create (static)
+	//
+	// Creates a new DentryCache instance
+	static std::shared_ptr<DentryCache> Create(void);
+	static std::shared_ptr<DentryCache> Create(size_t capacity);
+
+	// Insert
+	//
+	// Inserts or replaces a lookup result, a null alias indicates a negative entry
+	void Insert(std::shared_ptr<FileSystem::Alias> const& parent, char_t const* name, std::shared_ptr<FileSystem::Alias> const& alias);
+
+	// Invalidate
+	//
+	// Removes a specific child entry or all child entries of a parent alias
+	void Invalidate(FileSystem::Alias const* parent);
+	void Invalidate(FileSystem::Alias const* parent, char_t const* name);
+
+	// Lookup
+	//
+	// Retrieves a cached lookup result, the alias is set to null for a negative entry
+	bool Lookup(std::shared_ptr<FileSystem::Alias> const& parent, char_t const* name, std::shared_ptr<FileSystem::Alias>& alias);
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Capacity
+	//
+	// Gets the maximum number of entries retained in the cache
+	__declspec(property(get=getCapacity)) size_t Capacity;
+	size_t getCapacity(void) const;
+
+	// Count
+	//
+	// Gets the number of entries currently in the cache
+	__declspec(property(get=getCount)) size_t Count;
+	size_t getCount(void) const;
+
+	// Hits
+	//
+	// Gets the number of lookups that were satisfied by the cache
+	__declspec(property(get=getHits)) uint64_t Hits;
+	uint64_t getHits(void) const;
+
+	// Misses
+	//
+	// Gets the number of lookups that were not satisfied by the cache
+	__declspec(property(get=getMisses)) uint64_t Misses;
+	uint64_t getMisses(void) const;
+
+private:
+
+	DentryCache(DentryCache const&)=delete;
+	DentryCache& operator=(DentryCache const&)=delete;
+
+	// alias_t
+	//
+	// FileSystem::Alias weak pointer
+	using alias_t = std::weak_ptr<FileSystem::Alias>;
+
+	// ShardCount
+	//
+	// Number of independently locked cache shards
+	static const size_t ShardCount = 16;
+
+	// key_t
+	//
+	// Cache entry key (parent alias, component name); the name is not owned by the
+	// key so that a lookup does not have to allocate a string
+	struct key_t
+	{
+		FileSystem::Alias const*	parent;		// Parent alias instance
+		char_t const*				name;		// Child component name
+		size_t						length;		// Child component name length
+
+		bool operator==(key_t const& rhs) const 
+		{ 
+			return (parent == rhs.parent) && (length == rhs.length) && (memcmp(name, rhs.name, length * sizeof(char_t)) == 0); 
+		}
+	};
+
+	// key_hash_t
+	//
+	// Hash function for key_t (FNV-1a over the component name)
+	struct key_hash_t
+	{
+		size_t operator()(key_t const& key) const
+		{
+			const size_t prime = (sizeof(size_t) == 8) ? static_cast<size_t>(1099511628211ULL) : static_cast<size_t>(16777619UL);
+
+			size_t hash = std::hash<FileSystem::Alias const*>()(key.parent);
+			for(size_t index = 0; index < key.length; index++) hash = (hash ^ static_cast<uint8_t>(key.name[index])) * prime;
+
+			return hash;
+		}
+	};
+
+	// watch_t
+	//
+	// Watcher registered with a Watchable parent node
+	struct watch_t : public FileSystem::NotifyWatcher
+	{
+		// Instance Constructor
+		//
+		watch_t(std::weak_ptr<DentryCache> owner, FileSystem::Alias const* parent);
+
+		// Notify
+		//
+		// Indicates that the watched node or a child of the watched node has changed
+		virtual void Notify(uint32_t mask, uint32_t cookie, const char_t* name) override;
+
+		const std::weak_ptr<DentryCache>			owner;		// Owning cache instance
+		FileSystem::Alias const* const				parent;		// Parent alias key
+	};
+
+	// parent_t
+	//
+	// Tracks the entries cached for a parent alias and the watcher registered with its
+	// node; entries refer to this rather than the key so that they can be told apart
+	// from the entries of a different alias that has reused the same address
+	struct parent_t
+	{
+		FileSystem::Alias const*					key;		// Parent alias key
+		alias_t										alias;		// Parent alias instance
+		std::weak_ptr<FileSystem::Node>				node;		// Watched parent node
+		std::shared_ptr<watch_t>					watch;		// Registered watcher or null
+		size_t										entries;	// Number of cached entries
+	};
+
+	// parent_map_t
+	//
+	// Collection of parent trackers indexed by parent alias
+	using parent_map_t = std::unordered_map<FileSystem::Alias const*, std::shared_ptr<parent_t>>;
+
+	// release_list_t
+	//
+	// Parent trackers released under a shard lock that need to be unwatched
+	using release_list_t = std::vector<std::shared_ptr<parent_t>>;
+
+	// entry_t
+	//
+	// Cache entry; the key refers to the name owned by the entry
+	struct entry_t
+	{
+		key_t						key;		// Entry key
+		std::string					name;		// Child component name
+		std::shared_ptr<parent_t>	parent;		// Parent alias tracker
+		alias_t						alias;		// Child alias instance
+		bool						negative;	// Flag if this is a negative entry
+	};
+
+	// lru_list_t
+	//
+	// Collection of entries ordered by most recent use
+	using lru_list_t = std::list<entry_t>;
+
+	// entry_map_t
+	//
+	// Collection of entries indexed by key
+	using entry_map_t = std::unordered_map<key_t, lru_list_t::iterator, key_hash_t>;
+
+	// shard_t
+	//
+	// Independently locked subset of the cache entries
+	struct shard_t
+	{
+		lru_list_t							lru;		// Entries in LRU order
+		entry_map_t							entries;	// Entries indexed by key
+		parent_map_t						parents;	// Parent alias trackers
+		mutable sync::critical_section		cs;			// Synchronization object
+	};
+
+	// Instance Constructor
+	//
+	DentryCache(size_t capacity);
+	friend class std::_Ref_count_obj<DentryCache>;
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// CreateParent
+	//
+	// Creates the tracker for a parent alias, registering a watcher with its node
+	std::shared_ptr<parent_t> CreateParent(std::shared_ptr<FileSystem::Alias> const& parent);
+
+	// GetShard
+	//
+	// Gets the shard that holds the entries for a parent alias
+	shard_t& GetShard(FileSystem::Alias const* parent);
+
+	// IsCurrent (static)
+	//
+	// Determines if an entry belongs to a specific parent alias instance
+	static bool IsCurrent(entry_t const& entry, std::shared_ptr<FileSystem::Alias> const& parent);
+
+	// ReleaseParents (static)
+	//
+	// Unregisters the watchers of parent trackers that no longer have any entries
+	static void ReleaseParents(release_list_t const& released);
+
+	// RemoveEntry (static)
+	//
+	// Removes an entry from a shard, collecting the parent tracker if unused
+	static void RemoveEntry(shard_t& shard, lru_list_t::iterator entry, release_list_t& released);
+
+	// TryInsert
+	//
+	// Inserts or replaces an entry in a shard, fails if a parent tracker is required
+	bool TryInsert(shard_t& shard, key_t const& key, std::shared_ptr<FileSystem::Alias> const& parent,
+		std::shared_ptr<FileSystem::Alias> const& alias, std::shared_ptr<parent_t>& prepared, release_list_t& released);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	size_t const						m_capacity;		// Maximum number of entries
+	size_t const						m_shardcapacity;	// Maximum entries per shard
+	std::array<shard_t, ShardCount>		m_shards;		// Cache shards
+	std::atomic<uint64_t>				m_hits;			// Number of cache hits
+	std::atomic<uint64_t>				m_misses;		// Number of cache misses
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __DENTRYCACHE_H_
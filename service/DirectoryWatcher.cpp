@@ -0,0 +1,177 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "DirectoryWatcher.h"
+
+#include "Win32Exception.h"
+
+#pragma warning(push, 4)
+
+// NOTIFICATION_BUFFER_SIZE
+//
+// Size of the change notification buffer; cannot exceed 64KiB for network paths
+static const DWORD NOTIFICATION_BUFFER_SIZE = (64 << 10);
+
+//-----------------------------------------------------------------------------
+// DirectoryWatcher Constructor
+//
+// Arguments:
+//
+//	path		- Path to the host directory to be monitored
+//	subtree		- Flag to monitor the entire subtree of the directory
+//	filter		- FILE_NOTIFY_CHANGE_XXX notification filter flags
+//	callback	- Function to invoke for each reported change
+
+DirectoryWatcher::DirectoryWatcher(const wchar_t* path, bool subtree, DWORD filter, callback_t callback) : m_directory(INVALID_HANDLE_VALUE), 
+	m_io(nullptr), m_subtree(subtree), m_filter(filter), m_callback(std::move(callback)), m_active(false), m_stopping(false)
+{
+	if(path == nullptr) throw Win32Exception(ERROR_INVALID_PARAMETER);
+
+	memset(&m_overlapped, 0, sizeof(OVERLAPPED));
+	m_buffer = std::make_unique<uint8_t[]>(NOTIFICATION_BUFFER_SIZE);
+
+	// Open the directory for overlapped I/O, allowing other handles full sharing access
+	m_directory = CreateFileW(path, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if(m_directory == INVALID_HANDLE_VALUE) throw Win32Exception();
+
+	// Bind the directory handle to the process thread pool
+	m_io = CreateThreadpoolIo(m_directory, IoCompletion, this, nullptr);
+	if(m_io == nullptr) { Win32Exception exception; CloseHandle(m_directory); throw exception; }
+
+	// Issue the first change notification request
+	if(!BeginRead()) { Win32Exception exception; CloseThreadpoolIo(m_io); CloseHandle(m_directory); throw exception; }
+}
+
+//-----------------------------------------------------------------------------
+// DirectoryWatcher Destructor
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+	m_stopping = true;
+
+	// A completion callback that was running when the request was cancelled may have already
+	// issued another request; the second cancellation will catch that one
+	for(int index = 0; index < 2; index++) {
+
+		CancelIoEx(m_directory, &m_overlapped);
+		WaitForThreadpoolIoCallbacks(m_io, FALSE);
+	}
+
+	CloseThreadpoolIo(m_io);
+	CloseHandle(m_directory);
+}
+
+//-----------------------------------------------------------------------------
+// DirectoryWatcher::getActive
+//
+// Indicates if changes are still being monitored
+
+bool DirectoryWatcher::getActive(void) const
+{
+	return m_active;
+}
+
+//-----------------------------------------------------------------------------
+// DirectoryWatcher::BeginRead (private)
+//
+// Issues the next asynchronous change notification request
+//
+// Arguments:
+//
+//	NONE
+
+bool DirectoryWatcher::BeginRead(void)
+{
+	// StartThreadpoolIo must be called prior to every asynchronous operation
+	StartThreadpoolIo(m_io);
+
+	if(!ReadDirectoryChangesW(m_directory, m_buffer.get(), NOTIFICATION_BUFFER_SIZE, (m_subtree) ? TRUE : FALSE, m_filter, nullptr, &m_overlapped, nullptr)) {
+
+		CancelThreadpoolIo(m_io);
+		m_active = false;
+		return false;
+	}
+
+	m_active = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// DirectoryWatcher::IoCompletion (private, static)
+//
+// Thread pool I/O completion callback
+//
+// Arguments:
+//
+//	instance	- Callback instance
+//	context		- DirectoryWatcher instance pointer
+//	overlapped	- Overlapped I/O structure
+//	result		- Result code from the I/O operation
+//	transferred	- Number of bytes written into the notification buffer
+//	io			- Thread pool I/O object
+
+void CALLBACK DirectoryWatcher::IoCompletion(PTP_CALLBACK_INSTANCE instance, PVOID context, PVOID overlapped, ULONG result, ULONG_PTR transferred, PTP_IO io)
+{
+	UNREFERENCED_PARAMETER(instance);
+	UNREFERENCED_PARAMETER(overlapped);
+	UNREFERENCED_PARAMETER(io);
+
+	DirectoryWatcher* watcher = reinterpret_cast<DirectoryWatcher*>(context);
+	_ASSERTE(watcher);
+
+	// ERROR_OPERATION_ABORTED is reported when the request has been cancelled by the destructor
+	if((result == ERROR_OPERATION_ABORTED) || watcher->m_stopping) { watcher->m_active = false; return; }
+
+	// Exceptions cannot be allowed to propagate into the thread pool
+	try {
+
+		// A zero length result or ERROR_NOTIFY_ENUM_DIR indicates that the buffer overflowed
+		if((result != ERROR_SUCCESS) || (transferred == 0)) watcher->m_callback(0, nullptr, 0);
+
+		else {
+
+			// Walk the FILE_NOTIFY_INFORMATION structures and invoke the callback for each
+			uint8_t* next = watcher->m_buffer.get();
+			while(next) {
+
+				auto info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(next);
+				watcher->m_callback(info->Action, info->FileName, info->FileNameLength / sizeof(wchar_t));
+				next = (info->NextEntryOffset) ? next + info->NextEntryOffset : nullptr;
+			}
+		}
+	}
+
+	catch(...) { /* DISCARD */ }
+
+	// Issue the next request; if that fails any subsequent changes will be lost
+	if(!watcher->BeginRead()) {
+
+		try { watcher->m_callback(0, nullptr, 0); }
+		catch(...) { /* DISCARD */ }
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
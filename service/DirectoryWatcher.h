@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __DIRECTORYWATCHER_H_
+#define __DIRECTORYWATCHER_H_
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// DirectoryWatcher
+//
+// Monitors a host directory for changes with ReadDirectoryChangesW, invoking a
+// callback from the process thread pool for each change that is reported.  When
+// changes may have been lost the callback is invoked with a null name
+
+class DirectoryWatcher
+{
+public:
+
+	// callback_t
+	//
+	// Function invoked for each reported change; name is not null terminated
+	using callback_t = std::function<void(DWORD action, const wchar_t* name, size_t length)>;
+
+	// Instance Constructor
+	//
+	DirectoryWatcher(const wchar_t* path, bool subtree, DWORD filter, callback_t callback);
+
+	// Destructor
+	//
+	~DirectoryWatcher();
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Active
+	//
+	// Indicates if changes are still being monitored
+	__declspec(property(get=getActive)) bool Active;
+	bool getActive(void) const;
+
+private:
+
+	DirectoryWatcher(DirectoryWatcher const&)=delete;
+	DirectoryWatcher& operator=(DirectoryWatcher const&)=delete;
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// BeginRead
+	//
+	// Issues the next asynchronous change notification request
+	bool BeginRead(void);
+
+	// IoCompletion (static)
+	//
+	// Thread pool I/O completion callback
+	static void CALLBACK IoCompletion(PTP_CALLBACK_INSTANCE instance, PVOID context, PVOID overlapped, ULONG result, ULONG_PTR transferred, PTP_IO io);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	HANDLE							m_directory;	// Monitored directory handle
+	PTP_IO							m_io;			// Thread pool I/O object
+	OVERLAPPED						m_overlapped;	// Overlapped I/O structure
+	std::unique_ptr<uint8_t[]>		m_buffer;		// Notification buffer
+	bool const						m_subtree;		// Flag to monitor the subtree
+	DWORD const						m_filter;		// Notification filter flags
+	callback_t const				m_callback;		// Change notification callback
+	std::atomic<bool>				m_active;		// Flag indicating monitoring is active
+	std::atomic<bool>				m_stopping;		// Flag indicating shutdown
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __DIRECTORYWATCHER_H_
@@ -0,0 +1,723 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "EventPoll.h"
+
+#include <algorithm>
+#include <chrono>
+#include "LinuxException.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// EventPoll Constructor
+//
+// Arguments:
+//
+//	flags		- Handle flags
+
+EventPoll::EventPoll(FileSystem::HandleFlags flags) : m_flags(flags)
+{
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll Destructor
+
+EventPoll::~EventPoll()
+{
+	// Detach the registrations from any handles that are still alive
+	for(const auto& iterator : m_entries) {
+
+		auto pollable = std::dynamic_pointer_cast<FileSystem::Pollable>(iterator.second->handle.lock());
+		if(pollable) pollable->Unsubscribe(iterator.second.get());
+	}
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess EventPoll::getAccess(void) const
+{
+	return FileSystem::HandleAccess::ReadWrite;
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Add
+//
+// Registers a handle with the event poll instance (EPOLL_CTL_ADD)
+//
+// Arguments:
+//
+//	fd			- File descriptor of the handle being registered
+//	handle		- Handle being registered
+//	event		- Requested events and user data
+
+void EventPoll::Add(int fd, std::shared_ptr<FileSystem::Handle> handle, const uapi::epoll_event& event)
+{
+	// An event poll instance cannot be registered with itself
+	if(handle.get() == this) throw LinuxException(LINUX_EINVAL);
+
+	// Only handles that publish their readiness changes can be registered
+	auto pollable = std::dynamic_pointer_cast<FileSystem::Pollable>(handle);
+	if(!pollable) throw LinuxException(LINUX_EPERM);
+
+	// EPOLLEXCLUSIVE can only be combined with a subset of the events
+	const uint32_t exclusive = LINUX_EPOLLEXCLUSIVE | LINUX_EPOLLIN | LINUX_EPOLLOUT | LINUX_EPOLLERR | LINUX_EPOLLHUP | LINUX_EPOLLWAKEUP | LINUX_EPOLLET;
+	if((event.events & LINUX_EPOLLEXCLUSIVE) && (event.events & ~exclusive)) throw LinuxException(LINUX_EINVAL);
+
+	// Nested event poll instances cannot form a cycle
+	auto nested = std::dynamic_pointer_cast<EventPoll>(handle);
+	if(nested && nested->Reaches(this)) throw LinuxException(LINUX_ELOOP);
+
+	key_t key{ fd, handle.get() };
+	auto entry = std::make_shared<entry_t>(shared_from_this(), key, handle, event);
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		// The key can only be reused if the previously registered handle has been closed
+		auto found = m_entries.find(key);
+		if(found != m_entries.end()) {
+
+			if(!found->second->handle.expired()) throw LinuxException(LINUX_EEXIST);
+
+			found->second->removed = true;
+			Unlink(found->second.get());
+			m_entries.erase(found);
+		}
+
+		m_entries.emplace(key, entry);
+	}
+
+	// Subscribe before checking the current readiness so that no change can be missed
+	pollable->Subscribe(entry);
+	Ready(entry.get(), pollable->Poll());
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Create (static)
+//
+// Creates a new event poll instance
+//
+// Arguments:
+//
+//	flags		- Handle flags
+
+std::shared_ptr<EventPoll> EventPoll::Create(FileSystem::HandleFlags flags)
+{
+	return std::make_shared<EventPoll>(flags);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> EventPoll::Duplicate(void) const
+{
+	// Duplicated descriptors refer to the same event poll instance
+	return std::const_pointer_cast<EventPoll>(shared_from_this());
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::entry_t Constructor
+//
+// Arguments:
+//
+//	owner		- Owning event poll instance
+//	key			- Registration key
+//	handle		- Registered handle
+//	event		- Requested events and user data
+
+EventPoll::entry_t::entry_t(std::weak_ptr<EventPoll> owner, const key_t& key, std::shared_ptr<FileSystem::Handle> handle, const uapi::epoll_event& event) :
+	owner(std::move(owner)), key(key), handle(handle), events(event.events), data(event.data), disabled(false), removed(false), ready(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::entry_t::Signal
+//
+// Indicates that the readiness of the registered handle has changed
+//
+// Arguments:
+//
+//	events		- POLLxxx events that may have changed
+
+void EventPoll::entry_t::Signal(uint32_t events)
+{
+	auto instance = owner.lock();
+	if(instance) instance->Ready(this, events);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::getFlags
+//
+// Gets the flags specified on the handle
+
+FileSystem::HandleFlags EventPoll::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Interest (private, static)
+//
+// Converts the events requested by a registration into the POLLxxx events it reports
+//
+// Arguments:
+//
+//	events		- Requested EPOLLxxx events and flags
+
+uint32_t EventPoll::Interest(uint32_t events)
+{
+	// EPOLLERR and EPOLLHUP are always reported, whether requested or not
+	return (events & ~(LINUX_EPOLLET | LINUX_EPOLLONESHOT | LINUX_EPOLLWAKEUP | LINUX_EPOLLEXCLUSIVE)) | LINUX_EPOLLERR | LINUX_EPOLLHUP;
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Modify
+//
+// Changes the events associated with a registered handle (EPOLL_CTL_MOD)
+//
+// Arguments:
+//
+//	fd			- File descriptor of the registered handle
+//	handle		- Registered handle
+//	event		- Requested events and user data
+
+void EventPoll::Modify(int fd, const std::shared_ptr<FileSystem::Handle>& handle, const uapi::epoll_event& event)
+{
+	std::shared_ptr<entry_t>	entry;			// Registration being modified
+
+	// EPOLLEXCLUSIVE can only be specified when the handle is registered
+	if(event.events & LINUX_EPOLLEXCLUSIVE) throw LinuxException(LINUX_EINVAL);
+
+	auto pollable = std::dynamic_pointer_cast<FileSystem::Pollable>(handle);
+	if(!pollable) throw LinuxException(LINUX_ENOENT);
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		auto found = m_entries.find(key_t{ fd, handle.get() });
+		if(found == m_entries.end()) throw LinuxException(LINUX_ENOENT);
+
+		entry = found->second;
+		if(entry->events & LINUX_EPOLLEXCLUSIVE) throw LinuxException(LINUX_EINVAL);
+
+		// Modifying the registration rearms an EPOLLONESHOT registration
+		entry->events = event.events;
+		entry->data = event.data;
+		entry->disabled = false;
+	}
+
+	Ready(entry.get(), pollable->Poll());
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Poll
+//
+// Gets the current POLLxxx readiness of the handle
+//
+// Arguments:
+//
+//	NONE
+
+uint32_t EventPoll::Poll(void) const
+{
+	std::vector<std::pair<std::shared_ptr<FileSystem::Handle>, uint32_t>>	signaled;
+
+	// Take references to the signaled handles; they cannot be polled while the lock is held
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		signaled.reserve(m_ready.size());
+		for(const auto& entry : m_ready) signaled.emplace_back(entry->handle.lock(), Interest(entry->events));
+	}
+
+	// The instance is readable if any of the signaled handles is still ready
+	for(const auto& iterator : signaled) {
+
+		if(iterator.first && (FileSystem::PollHandle(iterator.first) & iterator.second)) return LINUX_POLLIN | LINUX_POLLRDNORM;
+	}
+
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Reaches (private)
+//
+// Determines if an event poll instance is registered here, directly or through nested instances
+//
+// Arguments:
+//
+//	target		- Event poll instance to look for
+
+bool EventPoll::Reaches(const EventPoll* target) const
+{
+	std::vector<std::shared_ptr<EventPoll>>		nested;		// Registered event poll instances
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		for(const auto& iterator : m_entries) {
+
+			auto instance = std::dynamic_pointer_cast<EventPoll>(iterator.second->handle.lock());
+			if(instance) nested.push_back(std::move(instance));
+		}
+	}
+
+	// Registrations that would form a cycle are never accepted, so this terminates
+	for(const auto& instance : nested) if((instance.get() == target) || instance->Reaches(target)) return true;
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t EventPoll::Read(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t EventPoll::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t EventPoll::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ENOTDIR);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Ready (private)
+//
+// Places a signaled registration on the ready list
+//
+// Arguments:
+//
+//	entry		- Registration that has been signaled
+//	events		- POLLxxx events that may have changed
+
+void EventPoll::Ready(entry_t* entry, uint32_t events)
+{
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		// Registrations that are already queued or cannot report an event are ignored
+		if(entry->removed || entry->disabled || entry->ready) return;
+		if((events & Interest(entry->events)) == 0) return;
+
+		entry->position = m_ready.insert(m_ready.end(), entry);
+		entry->ready = true;
+
+		m_signal.notify_all();
+	}
+
+	// Event poll instances are pollable themselves; waiters are signaled without the lock held
+	m_pollqueue.Notify(LINUX_POLLIN | LINUX_POLLRDNORM);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Remove
+//
+// Removes a registered handle from the event poll instance (EPOLL_CTL_DEL)
+//
+// Arguments:
+//
+//	fd			- File descriptor of the registered handle
+//	handle		- Registered handle
+
+void EventPoll::Remove(int fd, const std::shared_ptr<FileSystem::Handle>& handle)
+{
+	std::shared_ptr<entry_t>	entry;			// Registration being removed
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		auto found = m_entries.find(key_t{ fd, handle.get() });
+		if(found == m_entries.end()) throw LinuxException(LINUX_ENOENT);
+
+		entry = found->second;
+		entry->removed = true;
+
+		Unlink(entry.get());
+		m_entries.erase(found);
+	}
+
+	auto pollable = std::dynamic_pointer_cast<FileSystem::Pollable>(handle);
+	if(pollable) pollable->Unsubscribe(entry.get());
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset into the node data to seek, relative to whence
+//	whence		- Position in the node data that offset is relative to
+
+uapi::loff_t EventPoll::Seek(uapi::loff_t offset, int whence)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(whence);
+
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Subscribe
+//
+// Registers a waiter to be signaled when the readiness of the handle changes
+//
+// Arguments:
+//
+//	waiter		- Waiter to be registered
+
+void EventPoll::Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter)
+{
+	m_pollqueue.Subscribe(std::move(waiter));
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void EventPoll::Sync(void) const
+{
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void EventPoll::SyncData(void) const
+{
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Unlink (private)
+//
+// Removes a registration from the ready list; the lock must be held
+//
+// Arguments:
+//
+//	entry		- Registration to be removed from the ready list
+
+void EventPoll::Unlink(entry_t* entry)
+{
+	if(!entry->ready) return;
+
+	m_ready.erase(entry->position);
+	entry->ready = false;
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Unsubscribe
+//
+// Removes a previously registered waiter
+//
+// Arguments:
+//
+//	waiter		- Waiter to be removed
+
+void EventPoll::Unsubscribe(const FileSystem::PollWaiter* waiter)
+{
+	m_pollqueue.Unsubscribe(waiter);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Wait
+//
+// Waits for registered handles to become ready, returns the number of events
+//
+// Arguments:
+//
+//	events		- Receives the ready events
+//	maxevents	- Maximum number of events to return
+//	timeout		- Timeout in milliseconds; negative to wait indefinitely
+
+size_t EventPoll::Wait(uapi::epoll_event* events, size_t maxevents, int timeout)
+{
+	std::vector<std::shared_ptr<entry_t>>	signaled;		// Registrations taken from the ready list
+	std::vector<uint32_t>					masks;			// Current readiness of the handles
+
+	if((events == nullptr) || (maxevents == 0)) throw LinuxException(LINUX_EINVAL);
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout, 0));
+
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	while(true) {
+
+		// Wait for at least one registration to be signaled
+		while(m_ready.empty()) {
+
+			if(timeout == 0) return 0;
+
+			// todo: this needs to be interrupted by pending signals (EINTR)
+			if(timeout < 0) m_signal.wait(critsec);
+			else if((m_signal.wait_until(critsec, deadline) == std::cv_status::timeout) && m_ready.empty()) return 0;
+		}
+
+		// Detach up to maxevents registrations from the front of the ready list, the cost
+		// of the wait depends on the number of signaled handles, not registered handles
+		signaled.clear();
+		while(!m_ready.empty() && (signaled.size() < maxevents)) {
+
+			entry_t* entry = m_ready.front();
+			Unlink(entry);
+			signaled.push_back(entry->shared_from_this());
+		}
+
+		// Poll the handles without holding the lock, a handle that has been closed
+		// everywhere reports POLLNVAL and its registration is discarded below
+		masks.resize(signaled.size());
+		critsec.unlock();
+		for(size_t index = 0; index < signaled.size(); index++) masks[index] = FileSystem::PollHandle(signaled[index]->handle.lock());
+		critsec.lock();
+
+		size_t count = 0;
+		for(size_t index = 0; index < signaled.size(); index++) {
+
+			entry_t* entry = signaled[index].get();
+
+			// The registration may have been changed while the lock was released
+			if(entry->removed || entry->disabled) continue;
+
+			if(masks[index] == LINUX_POLLNVAL) {
+
+				entry->removed = true;
+				Unlink(entry);
+				m_entries.erase(entry->key);
+				continue;
+			}
+
+			// Registrations that are no longer ready remain off the ready list until signaled
+			uint32_t mask = masks[index] & Interest(entry->events);
+			if(mask == 0) continue;
+
+			events[count].events = mask;
+			events[count].data = entry->data;
+			count++;
+
+			// EPOLLONESHOT disables the registration until it is modified, level-triggered
+			// registrations go back on the ready list to be polled again by the next wait
+			if(entry->events & LINUX_EPOLLONESHOT) entry->disabled = true;
+			else if(((entry->events & LINUX_EPOLLET) == 0) && !entry->ready) {
+
+				entry->position = m_ready.insert(m_ready.end(), entry);
+				entry->ready = true;
+			}
+		}
+
+		if(count > 0) {
+
+			// Other waiters can consume any registrations that remain on the ready list
+			if(!m_ready.empty()) m_signal.notify_all();
+			return count;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::waiter_t::Signal
+//
+// Indicates that the readiness of one of the handles has changed
+//
+// Arguments:
+//
+//	events		- POLLxxx events that may have changed
+
+void EventPoll::waiter_t::Signal(uint32_t events)
+{
+	UNREFERENCED_PARAMETER(events);
+
+	std::unique_lock<std::mutex> critsec{ lock };
+
+	signaled = true;
+	signal.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::WaitHandles (static)
+//
+// Waits for any of a set of handles to become ready, returns the number of ready handles
+//
+// Arguments:
+//
+//	items		- Handles and requested events; receives the returned events
+//	timeout		- Timeout in milliseconds; negative to wait indefinitely
+
+size_t EventPoll::WaitHandles(std::vector<pollitem_t>& items, int timeout)
+{
+	size_t ready = 0;						// Number of ready handles
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout, 0));
+	auto waiter = std::make_shared<waiter_t>();
+
+	// Detaches the waiter from every pollable handle
+	auto unsubscribe = [&]() -> void {
+
+		for(const auto& item : items) {
+
+			auto pollable = std::dynamic_pointer_cast<FileSystem::Pollable>(item.handle);
+			if(pollable) pollable->Unsubscribe(waiter.get());
+		}
+	};
+
+	// Subscribe to every pollable handle before the first poll so that no change can be missed
+	for(const auto& item : items) {
+
+		auto pollable = std::dynamic_pointer_cast<FileSystem::Pollable>(item.handle);
+		if(pollable) pollable->Subscribe(waiter);
+	}
+
+	try {
+
+		while(true) {
+
+			// Reset the signal before polling, any change after this point wakes the wait below
+			{ std::unique_lock<std::mutex> critsec{ waiter->lock }; waiter->signaled = false; }
+
+			for(auto& item : items) {
+
+				item.revents = FileSystem::PollHandle(item.handle) & (item.events | LINUX_POLLERR | LINUX_POLLHUP | LINUX_POLLNVAL);
+				if(item.revents) ready++;
+			}
+
+			if((ready > 0) || (timeout == 0)) break;
+
+			// todo: this needs to be interrupted by pending signals (EINTR)
+			std::unique_lock<std::mutex> critsec{ waiter->lock };
+			if(timeout < 0) waiter->signal.wait(critsec, [&]() -> bool { return waiter->signaled; });
+			else if(!waiter->signal.wait_until(critsec, deadline, [&]() -> bool { return waiter->signaled; })) break;
+		}
+	}
+
+	catch(...) { unsubscribe(); throw; }
+
+	unsubscribe();
+	return ready;
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	count		- Number of bytes to write
+
+uapi::size_t EventPoll::Write(const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// EventPoll::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source buffer
+//	count		- Number of bytes to write
+
+uapi::size_t EventPoll::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,294 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __EVENTPOLL_H_
+#define __EVENTPOLL_H_
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "FileSystem.h"
+#include "PollQueue.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// EventPoll
+//
+// EventPoll implements epoll instances and the readiness waits required by poll()
+// and select().  An EventPoll is itself a Handle so that it can be placed into a
+// descriptor table and registered with another instance.  The system calls are not
+// provided until Process has a descriptor table to resolve file descriptors from.
+//
+// Each registered handle has an entry that is subscribed to the handle as a
+// FileSystem::PollWaiter.  When the handle publishes a readiness change the entry
+// is appended to the ready list, so Wait() only visits handles that have been
+// signaled rather than every registered handle.  Level-triggered entries are
+// returned to the ready list after they have been reported, edge-triggered
+// entries are not reported again until the handle is signaled again.
+//
+// Handles are never polled while the EventPoll lock is held; publishers signal
+// their waiters while holding their own locks and would otherwise deadlock
+// against a concurrent Wait().
+//
+// Notes:
+//
+//	- Only handles that implement FileSystem::Pollable can be registered, others
+//	  fail with EPERM the same as regular files on Linux.
+//
+//	- Registrations do not keep the handle alive; a registration is discarded
+//	  once the handle has been closed in every process that referenced it.
+
+class EventPoll : public FileSystem::Handle, public FileSystem::Pollable, public std::enable_shared_from_this<EventPoll>
+{
+public:
+
+	// pollitem_t
+	//
+	// Handle and requested events for WaitHandles(), the wait required by poll() and select()
+	struct pollitem_t
+	{
+		std::shared_ptr<FileSystem::Handle>	handle;		// Handle to be polled; NULL reports POLLNVAL
+		uint32_t							events;		// Requested POLLxxx events
+		uint32_t							revents;	// Returned POLLxxx events
+	};
+
+	// Instance Constructor
+	//
+	explicit EventPoll(FileSystem::HandleFlags flags);
+
+	// Destructor
+	//
+	~EventPoll();
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Add
+	//
+	// Registers a handle with the event poll instance (EPOLL_CTL_ADD)
+	void Add(int fd, std::shared_ptr<FileSystem::Handle> handle, const uapi::epoll_event& event);
+
+	// Create (static)
+	//
+	// Creates a new event poll instance
+	static std::shared_ptr<EventPoll> Create(FileSystem::HandleFlags flags);
+
+	// Modify
+	//
+	// Changes the events associated with a registered handle (EPOLL_CTL_MOD)
+	void Modify(int fd, const std::shared_ptr<FileSystem::Handle>& handle, const uapi::epoll_event& event);
+
+	// Remove
+	//
+	// Removes a registered handle from the event poll instance (EPOLL_CTL_DEL)
+	void Remove(int fd, const std::shared_ptr<FileSystem::Handle>& handle);
+
+	// Wait
+	//
+	// Waits for registered handles to become ready, returns the number of events
+	size_t Wait(uapi::epoll_event* events, size_t maxevents, int timeout);
+
+	// WaitHandles (static)
+	//
+	// Waits for any of a set of handles to become ready, returns the number of ready handles
+	static size_t WaitHandles(std::vector<pollitem_t>& items, int timeout);
+
+	//-------------------------------------------------------------------------
+	// FileSystem::Handle Implementation
+
+	// Duplicate
+	//
+	// Creates a duplicate Handle instance
+	virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+	// Read
+	//
+	// Synchronously reads data from the underlying node into a buffer
+	virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+	// ReadAt
+	//
+	// Synchronously reads data from the underlying node into a buffer
+	virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+	// ReadDirectory
+	//
+	// Reads entries from the underlying directory node as packed linux_dirent64 structures
+	virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+	// Seek
+	//
+	// Changes the file position
+	virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+	// Sync
+	//
+	// Synchronizes all metadata and data associated with the file to storage
+	virtual void Sync(void) const override;
+
+	// SyncData
+	//
+	// Synchronizes all data associated with the file to storage, not metadata
+	virtual void SyncData(void) const override;
+
+	// Write
+	//
+	// Synchronously writes data from a buffer to the underlying node
+	virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+	// WriteAt
+	//
+	// Synchronously writes data from a buffer to the underlying node
+	virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+	// Access
+	//
+	// Gets the access mode used when the handle was created
+	virtual FileSystem::HandleAccess getAccess(void) const override;
+
+	// Flags
+	//
+	// Gets the flags used when the handle was created
+	virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	//-------------------------------------------------------------------------
+	// FileSystem::Pollable Implementation
+
+	// Poll
+	//
+	// Gets the current POLLxxx readiness of the handle
+	virtual uint32_t Poll(void) const override;
+
+	// Subscribe
+	//
+	// Registers a waiter to be signaled when the readiness of the handle changes
+	virtual void Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter) override;
+
+	// Unsubscribe
+	//
+	// Removes a previously registered waiter
+	virtual void Unsubscribe(const FileSystem::PollWaiter* waiter) override;
+
+private:
+
+	EventPoll(const EventPoll&)=delete;
+	EventPoll& operator=(const EventPoll&)=delete;
+
+	// Forward Declarations
+	//
+	struct entry_t;
+
+	// key_t
+	//
+	// Registrations are identified by both the file descriptor and the handle
+	using key_t = std::pair<int, const FileSystem::Handle*>;
+
+	// readylist_t
+	//
+	// List of registrations that have been signaled
+	using readylist_t = std::list<entry_t*>;
+
+	// entry_t
+	//
+	// Registration of a handle with the event poll instance
+	struct entry_t : public FileSystem::PollWaiter, public std::enable_shared_from_this<entry_t>
+	{
+		// Instance Constructor
+		//
+		entry_t(std::weak_ptr<EventPoll> owner, const key_t& key, std::shared_ptr<FileSystem::Handle> handle, const uapi::epoll_event& event);
+
+		// Signal
+		//
+		// Indicates that the readiness of the registered handle has changed
+		virtual void Signal(uint32_t events) override;
+
+		const std::weak_ptr<EventPoll>				owner;		// Owning event poll instance
+		const key_t									key;		// Registration key
+		const std::weak_ptr<FileSystem::Handle>		handle;		// Registered handle
+		uint32_t									events;		// Requested EPOLLxxx events and flags
+		uint64_t									data;		// User data
+		bool										disabled;	// EPOLLONESHOT event has been reported
+		bool										removed;	// Registration has been removed
+		bool										ready;		// Entry is on the ready list
+		readylist_t::iterator						position;	// Position on the ready list
+	};
+
+	// waiter_t
+	//
+	// Transient waiter used by WaitHandles()
+	struct waiter_t : public FileSystem::PollWaiter
+	{
+		// Signal
+		//
+		// Indicates that the readiness of one of the handles has changed
+		virtual void Signal(uint32_t events) override;
+
+		std::mutex									lock;		// Synchronization object
+		std::condition_variable						signal;		// Signaled condition
+		bool										signaled = false;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// Interest (static)
+	//
+	// Converts the events requested by a registration into the POLLxxx events it reports
+	static uint32_t Interest(uint32_t events);
+
+	// Reaches
+	//
+	// Determines if an event poll instance is registered here, directly or through nested instances
+	bool Reaches(const EventPoll* target) const;
+
+	// Ready
+	//
+	// Places a signaled registration on the ready list
+	void Ready(entry_t* entry, uint32_t events);
+
+	// Unlink
+	//
+	// Removes a registration from the ready list; the lock must be held
+	void Unlink(entry_t* entry);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	const FileSystem::HandleFlags						m_flags;		// Handle flags
+	std::map<key_t, std::shared_ptr<entry_t>>			m_entries;		// Registrations
+	readylist_t											m_ready;		// Signaled registrations
+	mutable std::mutex									m_lock;			// Synchronization object
+	std::condition_variable								m_signal;		// Ready list signal
+	PollQueue											m_pollqueue;	// Readiness waiters
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __EVENTPOLL_H_
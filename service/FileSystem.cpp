@@ -22,12 +22,79 @@
 
 #include "stdafx.h"
 #include "FileSystem.h"
+
+#include "FilePermission.h"
+#include "HeapBuffer.h"
 #include "LinuxException.h"
 #include "Namespace.h"
 #include "Random.h"
 
 #pragma warning(push, 4)
 
+// COPY_BUFFER_SIZE
+//
+// Size of the intermediate buffer used by CopyHandleData
+static const uapi::size_t COPY_BUFFER_SIZE = (256 KiB);
+
+//-----------------------------------------------------------------------------
+// IoVectorLength (local)
+//
+// Validates an array of iovec structures and calculates the total number of bytes
+// that it describes; the total length cannot exceed the range of a ssize_t
+//
+// Arguments:
+//
+//	iov			- Array of iovec structures
+//	iovcnt		- Number of iovec structures in the array
+
+static uapi::size_t IoVectorLength(const uapi::iovec* iov, int iovcnt)
+{
+	uapi::size_t			total = 0;				// Total length of the buffers
+
+	if((iovcnt < 0) || (iovcnt > LINUX_UIO_MAXIOV)) throw LinuxException(LINUX_EINVAL);
+	if((iov == nullptr) && (iovcnt > 0)) throw LinuxException(LINUX_EFAULT);
+
+	for(int index = 0; index < iovcnt; index++) {
+
+		if(iov[index].iov_len > static_cast<uapi::size_t>(MAXSSIZE_T) - total) throw LinuxException(LINUX_EINVAL);
+		total += iov[index].iov_len;
+	}
+
+	return total;
+}
+
+//-----------------------------------------------------------------------------
+// NextPathComponent (local)
+//
+// Extracts the next component of a path string into a fixed-length buffer without
+// allocating any memory and advances the path string past it.  Returns the length
+// of the extracted component, zero if there are no more components to be extracted,
+// or -LINUX_ENAMETOOLONG if the component does not fit into the buffer
+//
+// Arguments:
+//
+//	path		- Current position within the path string
+//	component	- Buffer to receive the null-terminated path component
+
+static int NextPathComponent(const char_t*& path, char_t (&component)[LINUX_NAME_MAX + 1])
+{
+	// Skip over any leading and/or repeated path separators
+	while(*path == '/') ++path;
+	if(*path == 0) return 0;
+
+	// Find the end of this component and verify that it fits into the buffer
+	const char_t* end = path;
+	while((*end != 0) && (*end != '/')) ++end;
+	if((end - path) > LINUX_NAME_MAX) return -LINUX_ENAMETOOLONG;
+
+	int length = static_cast<int>(end - path);
+	memcpy(component, path, length * sizeof(char_t));
+	component[length] = 0;
+
+	path = end;
+	return length;
+}
+
 //
 // FILESYSTEM::HANDLEACCESS
 //
@@ -64,6 +131,10 @@ const FileSystem::HandleFlags FileSystem::HandleFlags::Direct{ LINUX_O_DIRECT };
 //
 const FileSystem::HandleFlags FileSystem::HandleFlags::NoAccessTime{ LINUX_O_NOATIME };
 
+// FileSystem::HandleFlags::NonBlocking (static)
+//
+const FileSystem::HandleFlags FileSystem::HandleFlags::NonBlocking{ LINUX_O_NONBLOCK };
+
 // FileSystem::HandleFlags::None (static)
 //
 const FileSystem::HandleFlags FileSystem::HandleFlags::None{ 0 };
@@ -256,6 +327,125 @@ const FileSystem::LookupFlags FileSystem::LookupFlags::None{ 0 };
 //	directory->CreateSymbolicLink(branch, splitter.Leaf, target);
 //}
 
+//-----------------------------------------------------------------------------
+// FileSystem::CopyHandleData (static)
+//
+// Copies data from one handle to another without passing it through the caller.  A
+// destination that implements CopyTarget is first given the opportunity to copy the
+// data directly, anything that remains is moved through an intermediate buffer
+//
+// Arguments:
+//
+//	in			- Source handle
+//	inoffset	- Optional source offset, if NULL the source file position is used [in/out]
+//	out			- Destination handle
+//	outoffset	- Optional destination offset, if NULL the destination file position is used [in/out]
+//	count		- Maximum number of bytes to copy
+
+uapi::size_t FileSystem::CopyHandleData(std::shared_ptr<FileSystem::Handle> in, uapi::loff_t* inoffset, std::shared_ptr<FileSystem::Handle> out, 
+	uapi::loff_t* outoffset, uapi::size_t count)
+{
+	uapi::size_t				total = 0;				// Total number of bytes copied
+
+	if((in == nullptr) || (out == nullptr)) throw LinuxException(LINUX_EBADF);
+
+	// The source handle must be readable and the destination handle must be writable
+	if(in->Access == FileSystem::HandleAccess::WriteOnly) throw LinuxException(LINUX_EBADF);
+	if(out->Access == FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EBADF);
+
+	if(((inoffset) && (*inoffset < 0)) || ((outoffset) && (*outoffset < 0))) throw LinuxException(LINUX_EINVAL);
+	if(count == 0) return 0;
+
+	// DIRECT COPY
+	//
+	// A direct copy requires absolute positions for both handles, these are taken from the current
+	// file positions when explicit offsets have not been provided.  Handles that cannot report a
+	// position (pipes, sockets) are always copied through the intermediate buffer
+	auto target = std::dynamic_pointer_cast<FileSystem::CopyTarget>(out);
+	if(target) {
+
+		uapi::loff_t inposition = -1, outposition = -1;
+
+		try {
+
+			inposition = (inoffset) ? *inoffset : in->Seek(0, LINUX_SEEK_CUR);
+			outposition = (outoffset) ? *outoffset : out->Seek(0, LINUX_SEEK_CUR);
+		}
+
+		catch(LinuxException&) { /* DISCARD */ }
+
+		if((inposition >= 0) && (outposition >= 0)) {
+
+			auto result = target->CopyFrom(in, inposition, outposition, count);
+			if(result) {
+
+				total = result.Value;
+
+				// Advance the offsets or the file positions to reflect the copied data
+				if(inoffset) *inoffset += static_cast<uapi::loff_t>(total); else in->Seek(inposition + static_cast<uapi::loff_t>(total), LINUX_SEEK_SET);
+				if(outoffset) *outoffset += static_cast<uapi::loff_t>(total); else out->Seek(outposition + static_cast<uapi::loff_t>(total), LINUX_SEEK_SET);
+			}
+
+			// EXDEV indicates that the data cannot be copied directly, fall back to the buffer
+			else if(result.Code != LINUX_EXDEV) throw LinuxException(result.Code);
+		}
+	}
+
+	if(total == count) return total;
+
+	// BUFFERED COPY
+	//
+	// Move the remaining data through a single intermediate buffer in the largest chunks possible;
+	// once any data has been copied, a subsequent failure returns the number of bytes copied
+	HeapBuffer<uint8_t> buffer(std::min(count - total, COPY_BUFFER_SIZE));
+
+	try {
+
+		while(total < count) {
+
+			uapi::size_t chunk = std::min(count - total, buffer.Size);
+
+			uapi::size_t read = (inoffset) ? in->ReadAt(*inoffset, buffer, chunk) : in->Read(buffer, chunk);
+			if(read == 0) break;
+
+			uapi::size_t written = 0;
+			std::exception_ptr exception;
+
+			try {
+
+				while(written < read) {
+
+					uint8_t* source = static_cast<uint8_t*>(buffer) + written;
+					uapi::size_t result = (outoffset) ? out->WriteAt(*outoffset, source, read - written) : out->Write(source, read - written);
+					if(result == 0) break;
+
+					if(outoffset) *outoffset += static_cast<uapi::loff_t>(result);
+					written += result;
+				}
+			}
+
+			catch(...) { exception = std::current_exception(); }
+
+			// Data that was read but could not be written is given back to the source
+			if(inoffset) *inoffset += static_cast<uapi::loff_t>(written);
+			else if(written < read) {
+
+				try { in->Seek(-static_cast<uapi::loff_t>(read - written), LINUX_SEEK_CUR); }
+				catch(...) { /* DISCARD */ }
+			}
+
+			total += written;
+
+			if((exception) && (total == 0)) std::rethrow_exception(exception);
+			if(written < read) break;
+		}
+	}
+
+	catch(...) { if(total == 0) throw; }
+
+	return total;
+}
+
 //-----------------------------------------------------------------------------
 // FileSystem::GenerateFileSystemId (static)
 //
@@ -344,12 +534,8 @@ uapi::fsid_t FileSystem::GenerateFileSystemId(void)
 std::shared_ptr<FileSystem::Path> FileSystem::LookupPath(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root,
 	std::shared_ptr<FileSystem::Path> current, const char_t* path, int flags)
 {
-	// per path_resolution(7), empty paths are not allowed
-	if(path == nullptr) throw LinuxException{ LINUX_EFAULT };
-	if(*path == 0) throw LinuxException{ LINUX_ENOENT };
-
-	// Use the private version of this function that accepts the recursion depth
-	return LookupPath(ns, root, current, path, FileSystem::LookupFlags(flags), 0);
+	// Use the non-throwing version of this function and throw any error code
+	return TryLookupPath(std::move(ns), std::move(root), std::move(current), path, flags).Value;
 }
 
 //-----------------------------------------------------------------------------
@@ -366,54 +552,89 @@ std::shared_ptr<FileSystem::Path> FileSystem::LookupPath(std::shared_ptr<Namespa
 //	flags		- Path resolution flags
 //	depth		- Current lookup recursion depth (symbolic links)
 
-std::shared_ptr<FileSystem::Path> FileSystem::LookupPath(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
+FileSystem::Result<std::shared_ptr<FileSystem::Path>> FileSystem::LookupPath(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
 	std::shared_ptr<FileSystem::Path> current, const char_t* path, FileSystem::LookupFlags flags, int depth)
 {
+	char_t component[LINUX_NAME_MAX + 1];		// Current path component
+	int length;									// Current path component length
+
+	if(path == nullptr) return FileSystem::Error{ LINUX_EFAULT };
+
 	// Increment and verify the recursion depth of the current lookup
-	if(++depth >= FileSystem::MaxSymbolicLinks) throw LinuxException{ LINUX_ELOOP };
+	if(++depth >= FileSystem::MaxSymbolicLinks) return FileSystem::Error{ LINUX_ELOOP };
 
-	// Convert the path string into a posix_path instance and iterate over it
-	auto lookuppath = posix_path(path);
-	for(const auto& iterator : lookuppath) {
+	// Lookups are satisfied from the dentry cache whenever possible
+	auto dentries = ns->Dentries;
 
-		// Get the parent of the current component, this can be null which indicates that the
-		// component is a self-referential root path (".." leads to itself)
-		auto parent = (current->m_parent) ? current->m_parent : current;
-		auto node = current->m_alias->Node;
+	// ROOT [/]: an absolute path begins resolution at the root alias and mount
+	if(*path == '/') current = root;
+
+	// Iterate over each component of the path string in place
+	while((length = NextPathComponent(path, component)) != 0) {
 
-		// ROOT [/]: switch current to the root alias and mount
-		if(strcmp(iterator, "/") == 0) { current = root; continue; }
+		// A component that is too long to be extracted fails the lookup
+		if(length < 0) return FileSystem::Error{ -length };
 
 		// SELF [.]: skip to the next path component
-		if(strcmp(iterator, ".") == 0) continue;
+		if(strcmp(component, ".") == 0) continue;
 
-		// PARENT [..] move to the current component's parent path instance
-		if(strcmp(iterator, "..") == 0) { current = parent; continue; }
+		// PARENT [..] move to the current component's parent path instance, this can be null which
+		// indicates that the component is a self-referential root path (".." leads to itself)
+		if(strcmp(component, "..") == 0) { if(current->m_parent) current = current->m_parent; continue; }
 
 		// If the current path component is a symbolic link, follow it (must result in a directory)
+		auto node = current->m_alias->Node;
 		if(node->Type == FileSystem::NodeType::SymbolicLink) {
 
 			auto symlink = std::dynamic_pointer_cast<FileSystem::SymbolicLink>(node);
-			if(!symlink) throw LinuxException{ LINUX_ENOENT };
+			if(!symlink) return FileSystem::Error{ LINUX_ENOENT };
 
-			current = LookupPath(ns, root, parent, symlink->Target.c_str(), FileSystem::LookupFlags::Directory, depth);
+			auto target = LookupPath(ns, root, (current->m_parent) ? current->m_parent : current, symlink->Target.c_str(), FileSystem::LookupFlags::Directory, depth);
+			if(!target) return target;
+
+			current = std::move(target.Value);
+			node = current->m_alias->Node;
 		}
 
-		// If the current path component is a directory, look up the child path component
-		else if(node->Type == FileSystem::NodeType::Directory) {
+		// The current path component must be a directory to look up the child path component
+		if(node->Type != FileSystem::NodeType::Directory) return FileSystem::Error{ LINUX_ENOTDIR };
+
+		auto directory = std::dynamic_pointer_cast<FileSystem::Directory>(node);
+		if(!directory) return FileSystem::Error{ LINUX_ENOTDIR };
 
-			auto directory = std::dynamic_pointer_cast<FileSystem::Directory>(node);
-			if(!directory) throw LinuxException{ LINUX_ENOTDIR };
+		// Retrieve the alias for the child object from the dentry cache, or from the directory
+		// node on a miss; a null alias from the cache indicates a negative entry
+		std::shared_ptr<FileSystem::Alias> newalias;
+		if(!dentries->Lookup(current->m_alias, component, newalias)) {
+
+			auto result = directory->Lookup(current->m_mount, component);
+			if(!result) {
+
+				if(result.Code == LINUX_ENOENT) dentries->Insert(current->m_alias, component, nullptr);
+				return FileSystem::Error{ result.Code };
+			}
+
+			newalias = std::move(result.Value);
+			dentries->Insert(current->m_alias, component, newalias);
+		}
 
-			// Retrieve the alias for the child object and check if it is a mount point
-			auto newalias = directory->Lookup(current->m_mount, iterator);
-			auto newmount = ns->Mounts->Find(newalias);
+		else {
 
-			// Create the updated Path based on the new alias and optionally the new mount point
-			current = std::make_shared<FileSystem::Path>(current, newalias, (newmount) ? newmount : current->m_mount);
+			// The directory node demands search permission when it performs the lookup, a
+			// cached result (including a negative one) requires the same check here
+			uapi::stat stats;
+			directory->Stat(&stats);
+			if(!FilePermission::Check(FilePermission::Execute, stats.st_uid, stats.st_gid, stats.st_mode)) return FileSystem::Error{ LINUX_EACCES };
 		}
 
-		else throw LinuxException{ LINUX_ENOTDIR };
+		if(!newalias) return FileSystem::Error{ LINUX_ENOENT };
+
+		// Check if the child alias is a mount point in this namespace, otherwise it inherits the current mount
+		auto newmount = ns->Mounts->Find(newalias);
+		if(!newmount) newmount = current->m_mount;
+
+		// Create the updated Path based on the new alias and mount point
+		current = FileSystem::Path::Create(std::move(current), std::move(newalias), std::move(newmount));
 	}
 
 	// If the final path component is a symbolic link, the O_NOFOLLOW flag must be checked
@@ -424,14 +645,17 @@ std::shared_ptr<FileSystem::Path> FileSystem::LookupPath(std::shared_ptr<Namespa
 
 		// Not O_FOLLOW - read the symbolic link target and follow it (relative to parent)
 		auto symlink = std::dynamic_pointer_cast<FileSystem::SymbolicLink>(current->m_alias->Node);
-		if(!symlink) throw LinuxException{ LINUX_ENOENT };
+		if(!symlink) return FileSystem::Error{ LINUX_ENOENT };
+
+		auto target = LookupPath(ns, root, current->m_parent, symlink->Target.c_str(), FileSystem::LookupFlags::None, depth);
+		if(!target) return target;
 
-		current = LookupPath(ns, root, current->m_parent, symlink->Target.c_str(), FileSystem::LookupFlags::None, depth);
+		current = std::move(target.Value);
 	}
 
 	// O_DIRECTORY indicates that the resolved path must indicate a directory object
 	if((flags & FileSystem::LookupFlags::Directory) && (current->m_alias->Node->Type != FileSystem::NodeType::Directory))
-		throw LinuxException{ LINUX_ENOTDIR };
+		return FileSystem::Error{ LINUX_ENOTDIR };
 	
 	return current;
 }
@@ -450,25 +674,194 @@ std::shared_ptr<FileSystem::Path> FileSystem::LookupPath(std::shared_ptr<Namespa
 
 std::shared_ptr<FileSystem::Handle> FileSystem::OpenExecutable(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root,
 	std::shared_ptr<FileSystem::Path> current, const char_t* path)
+{
+	// Use the non-throwing version of this function and throw any error code
+	return TryOpenExecutable(std::move(ns), std::move(root), std::move(current), path).Value;
+}
+
+//-----------------------------------------------------------------------------
+// FileSystem::OpenFile (static)
+//
+// Opens a file system object and returns a Handle instance
+//
+// Arguments:
+//
+//	ns			- Namespace in which to perform name resolution
+//	root		- Path to the contextual root node for the resolution
+//	current		- Path to the file system node from which to begin resolution
+//	path		- Path to the object to be opened or created
+//	flags		- Handle access mode and flags (LINUX_O_XXXXX)
+//	mode		- Permissions to assign if a new object is created
+
+std::shared_ptr<FileSystem::Handle> FileSystem::OpenFile(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
+	std::shared_ptr<FileSystem::Path> current, const char_t* path, int flags, uapi::mode_t mode)
+{
+	// Use the non-throwing version of this function and throw any error code
+	return TryOpenFile(std::move(ns), std::move(root), std::move(current), path, flags, mode).Value;
+}
+
+//-----------------------------------------------------------------------------
+// FileSystem::PollHandle (static)
+//
+// Gets the current POLLxxx readiness of a handle.  A handle that does not implement
+// Pollable is always ready for I/O, the same as a Linux file without a poll operation
+//
+// Arguments:
+//
+//	handle		- Handle to be polled
+
+uint32_t FileSystem::PollHandle(const std::shared_ptr<FileSystem::Handle>& handle)
+{
+	if(handle == nullptr) return LINUX_POLLNVAL;
+
+	auto pollable = std::dynamic_pointer_cast<FileSystem::Pollable>(handle);
+	return (pollable) ? pollable->Poll() : LINUX_DEFAULT_POLLMASK;
+}
+
+//-----------------------------------------------------------------------------
+// FileSystem::ReadHandleV (static)
+//
+// Reads data from a handle into an array of buffers.  A handle that implements
+// ScatterGather is given the entire array, otherwise each buffer is read in turn
+// until a read does not fill the buffer it was given
+//
+// Arguments:
+//
+//	handle		- Source handle
+//	offset		- Optional offset, if NULL the file position is used
+//	iov			- Array of destination buffers
+//	iovcnt		- Number of destination buffers in the array
+
+uapi::size_t FileSystem::ReadHandleV(const std::shared_ptr<FileSystem::Handle>& handle, const uapi::loff_t* offset, const uapi::iovec* iov, int iovcnt)
+{
+	uapi::size_t				total = 0;				// Total number of bytes read
+
+	if(handle == nullptr) throw LinuxException(LINUX_EBADF);
+	if(handle->Access == FileSystem::HandleAccess::WriteOnly) throw LinuxException(LINUX_EBADF);
+
+	if((offset) && (*offset < 0)) throw LinuxException(LINUX_EINVAL);
+	if(IoVectorLength(iov, iovcnt) == 0) return 0;
+
+	auto scattergather = std::dynamic_pointer_cast<FileSystem::ScatterGather>(handle);
+	if(scattergather) return (offset) ? scattergather->ReadAtV(*offset, iov, iovcnt) : scattergather->ReadV(iov, iovcnt);
+
+	// Once any data has been read, a subsequent failure returns the number of bytes read
+	try {
+
+		for(int index = 0; index < iovcnt; index++) {
+
+			if(iov[index].iov_len == 0) continue;
+
+			uapi::size_t read = (offset) ? handle->ReadAt(*offset + static_cast<uapi::loff_t>(total), iov[index].iov_base, iov[index].iov_len) :
+				handle->Read(iov[index].iov_base, iov[index].iov_len);
+
+			total += read;
+			if(read < iov[index].iov_len) break;
+		}
+	}
+
+	catch(...) { if(total == 0) throw; }
+
+	return total;
+}
+
+//-----------------------------------------------------------------------------
+// FileSystem::ReadSymbolicLink (static)
+//
+// Reads the target string from a file system symbolic link
+//
+// Arguments:
+//
+//	ns			- Namespace in which to perform name resolution
+//	root		- Path to the contextual root node for the resolution
+//	current		- Path to the file system node from which to begin resolution
+//	path		- Path to the symbolic link object
+//	buffer		- Target string output buffer
+//	length		- Length of the target string output buffer
+
+size_t FileSystem::ReadSymbolicLink(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
+		std::shared_ptr<FileSystem::Path> current, const char_t* path, char_t* buffer, size_t length)
 {
 	// per path_resolution(7), empty paths are not allowed
 	if(path == nullptr) throw LinuxException{ LINUX_EFAULT };
 	if(*path == 0) throw LinuxException{ LINUX_ENOENT };
 
+	// Ensure that the buffer pointer is not null and is at least one byte in length
+	if(buffer == nullptr) throw LinuxException{ LINUX_EFAULT };
+	if(length == 0) throw LinuxException{ LINUX_EINVAL };
+
+	// Attempt to resolve the file system object, do not follow a trailing symbolic link
+	current = LookupPath(ns, root, current, path, LookupFlags::NoFollow, 0).Value;
+
+	// The provided path must have led to a symbolic link file system object
+	auto symlink = std::dynamic_pointer_cast<FileSystem::SymbolicLink>(current->m_alias->Node);
+	if(!symlink) throw LinuxException{ LINUX_EINVAL };
+
+	// Read the target information from the symbolic link
+	return symlink->GetTarget(buffer, length);
+}
+
+//-----------------------------------------------------------------------------
+// FileSystem::TryLookupPath (static)
+//
+// Resolves a path to a file system object; failure to resolve the path is
+// reported as a linux error code in the result rather than thrown
+//
+// Arguments:
+//
+//	ns			- Namespace associated with the calling process
+//	root		- Path to the contextual root node for the resolution
+//	current		- Path to the file system node from which to begin resolution
+//	path		- Path string to be resolved
+//	flags		- Path resolution flags (LINUX_O_XXXXX)
+
+FileSystem::Result<std::shared_ptr<FileSystem::Path>> FileSystem::TryLookupPath(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root,
+	std::shared_ptr<FileSystem::Path> current, const char_t* path, int flags)
+{
+	// per path_resolution(7), empty paths are not allowed
+	if(path == nullptr) return FileSystem::Error{ LINUX_EFAULT };
+	if(*path == 0) return FileSystem::Error{ LINUX_ENOENT };
+
+	// Use the private version of this function that accepts the recursion depth
+	return LookupPath(ns, root, current, path, FileSystem::LookupFlags(flags), 0);
+}
+
+//-----------------------------------------------------------------------------
+// FileSystem::TryOpenExecutable (static)
+//
+// Opens an executable file system object and returns a Handle instance; failure
+// to resolve the path is reported as a linux error code in the result
+//
+// Arguments:
+//
+//	ns			- Namespace in which to perform name resolution
+//	root		- Path to the contextual root node for the resolution
+//	current		- Path to the file system node from which to begin resolution
+//	path		- Path to the object to be opened
+
+FileSystem::Result<std::shared_ptr<FileSystem::Handle>> FileSystem::TryOpenExecutable(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root,
+	std::shared_ptr<FileSystem::Path> current, const char_t* path)
+{
+	// per path_resolution(7), empty paths are not allowed
+	if(path == nullptr) return FileSystem::Error{ LINUX_EFAULT };
+	if(*path == 0) return FileSystem::Error{ LINUX_ENOENT };
+
 	// Attempt to resolve the file system object, it must be a regular file
 	auto exepath = LookupPath(ns, root, current, path, LookupFlags::None, 0);
+	if(!exepath) return FileSystem::Error{ exepath.Code };
 	
 	// Create and return an executable handle for the file system object
-	auto file = std::dynamic_pointer_cast<FileSystem::File>(exepath->m_alias->Node);
-	if(!file) throw LinuxException{ LINUX_ENOEXEC };
+	auto file = std::dynamic_pointer_cast<FileSystem::File>(exepath.Value->m_alias->Node);
+	if(!file) return FileSystem::Error{ LINUX_ENOEXEC };
 
-	return file->OpenExec(exepath->m_mount);
+	return file->OpenExec(exepath.Value->m_mount);
 }
 
 //-----------------------------------------------------------------------------
-// FileSystem::OpenFile (static)
+// FileSystem::TryOpenFile (static)
 //
-// Opens a file system object and returns a Handle instance
+// Opens a file system object and returns a Handle instance; failure to resolve
+// the path is reported as a linux error code in the result
 //
 // Arguments:
 //
@@ -479,30 +872,48 @@ std::shared_ptr<FileSystem::Handle> FileSystem::OpenExecutable(std::shared_ptr<N
 //	flags		- Handle access mode and flags (LINUX_O_XXXXX)
 //	mode		- Permissions to assign if a new object is created
 
-std::shared_ptr<FileSystem::Handle> FileSystem::OpenFile(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
+FileSystem::Result<std::shared_ptr<FileSystem::Handle>> FileSystem::TryOpenFile(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
 	std::shared_ptr<FileSystem::Path> current, const char_t* path, int flags, uapi::mode_t mode)
 {
+	char_t branch[LINUX_PATH_MAX];				// Branch path string
+	char_t component[LINUX_NAME_MAX + 1];		// Leaf path component
+	const char_t* leaf = nullptr;				// Leaf path component, if present
+
 	// per path_resolution(7), empty paths are not allowed
-	if(path == nullptr) throw LinuxException{ LINUX_EFAULT };
-	if(*path == 0) throw LinuxException{ LINUX_ENOENT };
+	if(path == nullptr) return FileSystem::Error{ LINUX_EFAULT };
+	if(*path == 0) return FileSystem::Error{ LINUX_ENOENT };
+
+	// Break the requested path up into branch and leaf components in place; there is no
+	// leaf component if the path ends with a separator, the branch is then the entire path
+	const char_t* end = path + strlen(path);
+	const char_t* leafstart = end;
+	if(end[-1] != '/') { while((leafstart > path) && (leafstart[-1] != '/')) --leafstart; }
+
+	if(leafstart != end) {
 
-	// Break the requested path up into branch and leaf components
-	posix_path filepath(path);
-	auto branch = filepath.branch();
-	auto leaf = filepath.leaf();
+		const char_t* next = leafstart;
+		int length = NextPathComponent(next, component);
+		if(length < 0) return FileSystem::Error{ -length };
+		leaf = component;
+	}
+
+	if((leafstart - path) >= LINUX_PATH_MAX) return FileSystem::Error{ LINUX_ENAMETOOLONG };
+	memcpy(branch, path, (leafstart - path) * sizeof(char_t));
+	branch[leafstart - path] = 0;
 
 	// Change to the branch path, which must resolve to a directory instance
-	current = LookupPath(ns, root, current, branch, FileSystem::LookupFlags::Directory, 0);
+	auto branchpath = LookupPath(ns, root, current, branch, FileSystem::LookupFlags::Directory, 0);
+	if(!branchpath) return FileSystem::Error{ branchpath.Code };
 
 	// Cast the branch directory into a FileSystem::Directory node instance
-	auto directory = std::dynamic_pointer_cast<FileSystem::Directory>(current->m_alias->Node);
-	if(!directory) throw LinuxException{ LINUX_ENOTDIR };
+	auto directory = std::dynamic_pointer_cast<FileSystem::Directory>(branchpath.Value->m_alias->Node);
+	if(!directory) return FileSystem::Error{ LINUX_ENOTDIR };
 
 	// O_CREAT - Handle special rules regarding optional creation of a new regular file
 	if(flags & LINUX_O_CREAT) {
 
 		// If there is no leaf component, the operation is referring to a directory
-		if(!leaf) throw LinuxException{ LINUX_EISDIR };
+		if(!leaf) return FileSystem::Error{ LINUX_EISDIR };
 
 		// todo
 		(mode);
@@ -515,48 +926,62 @@ std::shared_ptr<FileSystem::Handle> FileSystem::OpenFile(std::shared_ptr<Namespa
 	// O_TMPFILE (| O_EXCL)
 	// todo -- see open(2) for documentation, will need support in FileSystem::Directory
 
-	// Lookup the final path component
-	current = LookupPath(ns, root, current, leaf, FileSystem::LookupFlags(flags), 0);
+	// Lookup the final path component, without one this resolves to the branch directory
+	auto leafpath = LookupPath(ns, root, branchpath.Value, (leaf) ? leaf : "", FileSystem::LookupFlags(flags), 0);
+	if(!leafpath) return FileSystem::Error{ leafpath.Code };
+
+	current = leafpath.Value;
 
 	// O_PATH is handled by a special PathHandle object, otherwise request the handle from the located node instance
-	if(flags & LINUX_O_PATH) return std::make_shared<PathHandle>(current->m_alias->Node, FileSystem::HandleAccess(flags));
+	if(flags & LINUX_O_PATH) return std::static_pointer_cast<FileSystem::Handle>(std::make_shared<PathHandle>(current->m_alias->Node, FileSystem::HandleAccess(flags)));
 	else return current->m_alias->Node->Open(current->m_mount, FileSystem::HandleAccess(flags), FileSystem::HandleFlags(flags));
 }
 
 //-----------------------------------------------------------------------------
-// FileSystem::ReadSymbolicLink (static)
+// FileSystem::WriteHandleV (static)
 //
-// Reads the target string from a file system symbolic link
+// Writes data from an array of buffers to a handle.  A handle that implements
+// ScatterGather is given the entire array, otherwise each buffer is written in
+// turn until a write does not consume the buffer it was given
 //
 // Arguments:
 //
-//	ns			- Namespace in which to perform name resolution
-//	root		- Path to the contextual root node for the resolution
-//	current		- Path to the file system node from which to begin resolution
-//	path		- Path to the symbolic link object
-//	buffer		- Target string output buffer
-//	length		- Length of the target string output buffer
+//	handle		- Destination handle
+//	offset		- Optional offset, if NULL the file position is used
+//	iov			- Array of source buffers
+//	iovcnt		- Number of source buffers in the array
 
-size_t FileSystem::ReadSymbolicLink(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
-		std::shared_ptr<FileSystem::Path> current, const char_t* path, char_t* buffer, size_t length)
+uapi::size_t FileSystem::WriteHandleV(const std::shared_ptr<FileSystem::Handle>& handle, const uapi::loff_t* offset, const uapi::iovec* iov, int iovcnt)
 {
-	// per path_resolution(7), empty paths are not allowed
-	if(path == nullptr) throw LinuxException{ LINUX_EFAULT };
-	if(*path == 0) throw LinuxException{ LINUX_ENOENT };
+	uapi::size_t				total = 0;				// Total number of bytes written
 
-	// Ensure that the buffer pointer is not null and is at least one byte in length
-	if(buffer == nullptr) throw LinuxException{ LINUX_EFAULT };
-	if(length == 0) throw LinuxException{ LINUX_EINVAL };
+	if(handle == nullptr) throw LinuxException(LINUX_EBADF);
+	if(handle->Access == FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EBADF);
 
-	// Attempt to resolve the file system object, do not follow a trailing symbolic link
-	current = LookupPath(ns, root, current, path, LookupFlags::NoFollow, 0);
+	if((offset) && (*offset < 0)) throw LinuxException(LINUX_EINVAL);
+	if(IoVectorLength(iov, iovcnt) == 0) return 0;
 
-	// The provided path must have led to a symbolic link file system object
-	auto symlink = std::dynamic_pointer_cast<FileSystem::SymbolicLink>(current->m_alias->Node);
-	if(!symlink) throw LinuxException{ LINUX_EINVAL };
+	auto scattergather = std::dynamic_pointer_cast<FileSystem::ScatterGather>(handle);
+	if(scattergather) return (offset) ? scattergather->WriteAtV(*offset, iov, iovcnt) : scattergather->WriteV(iov, iovcnt);
 
-	// Read the target information from the symbolic link
-	return symlink->GetTarget(buffer, length);
+	// Once any data has been written, a subsequent failure returns the number of bytes written
+	try {
+
+		for(int index = 0; index < iovcnt; index++) {
+
+			if(iov[index].iov_len == 0) continue;
+
+			uapi::size_t written = (offset) ? handle->WriteAt(*offset + static_cast<uapi::loff_t>(total), iov[index].iov_base, iov[index].iov_len) :
+				handle->Write(iov[index].iov_base, iov[index].iov_len);
+
+			total += written;
+			if(written < iov[index].iov_len) break;
+		}
+	}
+
+	catch(...) { if(total == 0) throw; }
+
+	return total;
 }
 
 //
@@ -606,9 +1031,47 @@ FileSystem::Path::Path(std::shared_ptr<FileSystem::Path> parent, std::shared_ptr
 //{
 //}
 
+//-----------------------------------------------------------------------------
+// FileSystem::Path::getAlias
+//
+// Gets the alias to which this path has been resolved
+
+std::shared_ptr<FileSystem::Alias> FileSystem::Path::getAlias(void) const
+{
+	return m_alias;
+}
+
+//-----------------------------------------------------------------------------
+// FileSystem::Path::Create (static)
+//
+// Creates a new root Path instance from component parts
+//
+// Arguments:
+//
+//	alias		- Alias object reference
+//	mount		- Mount object reference
+
 std::shared_ptr<FileSystem::Path> FileSystem::Path::Create(std::shared_ptr<FileSystem::Alias> alias, std::shared_ptr<FileSystem::Mount> mount)
 {
-	return std::make_shared<Path>(std::move(alias), std::move(mount));
+	return std::allocate_shared<Path>(SlabAllocator<Path>(), std::move(alias), std::move(mount));
+}
+
+//-----------------------------------------------------------------------------
+// FileSystem::Path::Create (static)
+//
+// Creates a new child Path instance from component parts
+//
+// Arguments:
+//
+//	parent		- Parent path instance
+//	alias		- Alias object reference
+//	mount		- Mount object reference
+
+std::shared_ptr<FileSystem::Path> FileSystem::Path::Create(std::shared_ptr<FileSystem::Path> parent, std::shared_ptr<FileSystem::Alias> alias, 
+	std::shared_ptr<FileSystem::Mount> mount)
+{
+	// The object and the reference counts are allocated as a single block from the slab pool
+	return std::allocate_shared<Path>(SlabAllocator<Path>(), std::move(parent), std::move(alias), std::move(mount));
 }
 
 //
@@ -701,6 +1164,24 @@ uapi::size_t FileSystem::PathHandle::ReadAt(uapi::loff_t offset, void* buffer, u
 	throw LinuxException{ LINUX_EBADF };
 }
 
+//-----------------------------------------------------------------------------
+// FileSystem::PathHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t FileSystem::PathHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException{ LINUX_EBADF };
+}
+
 //-----------------------------------------------------------------------------
 // FileSystem::PathHandle::Seek
 //
@@ -25,6 +25,8 @@
 #pragma once
 
 #include <memory>
+#include "LinuxException.h"
+#include "SlabAllocator.h"
 
 #pragma warning(push, 4)
 
@@ -50,14 +52,20 @@ public:
 	struct __declspec(novtable) Alias;
 	struct __declspec(novtable) BlockDevice;
 	struct __declspec(novtable) CharacterDevice;
+	struct __declspec(novtable) CopyTarget;
 	struct __declspec(novtable) Directory;
 	struct __declspec(novtable) File;
 	struct __declspec(novtable) Handle;
 	struct __declspec(novtable) Mount;
 	struct __declspec(novtable) Node;
+	struct __declspec(novtable) NotifyWatcher;
 	struct __declspec(novtable) Pipe;
+	struct __declspec(novtable) Pollable;
+	struct __declspec(novtable) PollWaiter;
+	struct __declspec(novtable) ScatterGather;
 	struct __declspec(novtable) Socket;
 	struct __declspec(novtable) SymbolicLink;
+	struct __declspec(novtable) Watchable;
 
 	// Forward Class Declarations
 	//
@@ -119,7 +127,7 @@ public:
 	// FileSystem::HandleFlags
 	//
 	// Flags used with handle operations
-	class HandleFlags final : public bitmask<HandleFlags, uint32_t, LINUX_O_APPEND | LINUX_O_DIRECT | LINUX_O_DSYNC | LINUX_O_NOATIME | LINUX_O_SYNC | LINUX_O_TRUNC>
+	class HandleFlags final : public bitmask<HandleFlags, uint32_t, LINUX_O_APPEND | LINUX_O_DIRECT | LINUX_O_DSYNC | LINUX_O_NOATIME | LINUX_O_NONBLOCK | LINUX_O_SYNC | LINUX_O_TRUNC>
 	{
 	public:
 
@@ -148,6 +156,11 @@ public:
 		// Indicates that the handle should not update atime after a read operation
 		static const HandleFlags NoAccessTime;
 
+		// NonBlocking (static)
+		//
+		// Indicates that operations on the handle should fail with EAGAIN rather than block
+		static const HandleFlags NonBlocking;
+
 		// None (static)
 		//
 		// Indicates that no special handle flags are present
@@ -192,6 +205,65 @@ public:
 		static const LookupFlags None;
 	};
 
+	// FileSystem::Error
+	//
+	// Linux error code (errno) used to construct a failed Result<> instance
+	struct Error
+	{
+		int		code;		// Linux error code
+	};
+
+	// FileSystem::Result<>
+	//
+	// Expected-style result of an operation that commonly fails, for example a path lookup.
+	// Contains either the resultant value or the linux error code; this allows negative
+	// results to be propagated to a system call without throwing and unwinding an exception
+	template <typename _type>
+	class Result final
+	{
+	public:
+
+		// Instance Constructors
+		//
+		Result(_type value) : m_value{ std::move(value) }, m_code{ 0 } {}
+		Result(Error error) : m_code{ error.code } { _ASSERTE(error.code != 0); }
+
+		// Destructor
+		//
+		~Result()=default;
+
+		//---------------------------------------------------------------------
+		// Overloaded Operators
+
+		// bool
+		//
+		// Determines if the result represents success
+		explicit operator bool() const { return (m_code == 0); }
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Code
+		//
+		// Gets the linux error code, or zero if the result represents success
+		__declspec(property(get=getCode)) int Code;
+		int getCode(void) const { return m_code; }
+
+		// Value
+		//
+		// Gets the resultant value, throws the linux error code if the result represents failure
+		__declspec(property(get=getValue)) _type& Value;
+		_type& getValue(void) { if(m_code) throw LinuxException{ m_code }; return m_value; }
+
+	private:
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		_type			m_value;		// Resultant value
+		int				m_code;			// Linux error code
+	};
+
 	//
 	// FILE SYSTEM INTERFACES
 	//
@@ -241,6 +313,11 @@ public:
 		// Synchronously reads data from the underlying node into a buffer
 		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) = 0;
 
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) = 0;
+
 		// Seek
 		//
 		// Changes the file position
@@ -279,6 +356,110 @@ public:
 		virtual FileSystem::HandleFlags getFlags(void) const = 0;
 	};
 
+	// FileSystem::CopyTarget
+	//
+	// Optional interface that can be implemented by a Handle that is able to receive data
+	// directly from another Handle without the use of an intermediate buffer
+	struct __declspec(novtable) CopyTarget
+	{
+		// CopyFrom
+		//
+		// Copies data from another handle; the result is EXDEV if a direct copy is not possible
+		virtual FileSystem::Result<uapi::size_t> CopyFrom(std::shared_ptr<FileSystem::Handle> source, uapi::loff_t sourceoffset, 
+			uapi::loff_t offset, uapi::size_t count) = 0;
+	};
+
+	// FileSystem::ScatterGather
+	//
+	// Optional interface that can be implemented by a Handle that is able to transfer an
+	// array of buffers with fewer operations than one Read or Write per buffer
+	struct __declspec(novtable) ScatterGather
+	{
+		// ReadAtV
+		//
+		// Synchronously reads data from the underlying node into an array of buffers
+		virtual uapi::size_t ReadAtV(uapi::loff_t offset, const uapi::iovec* iov, int iovcnt) = 0;
+
+		// ReadV
+		//
+		// Synchronously reads data from the underlying node into an array of buffers
+		virtual uapi::size_t ReadV(const uapi::iovec* iov, int iovcnt) = 0;
+
+		// WriteAtV
+		//
+		// Synchronously writes data from an array of buffers to the underlying node
+		virtual uapi::size_t WriteAtV(uapi::loff_t offset, const uapi::iovec* iov, int iovcnt) = 0;
+
+		// WriteV
+		//
+		// Synchronously writes data from an array of buffers to the underlying node
+		virtual uapi::size_t WriteV(const uapi::iovec* iov, int iovcnt) = 0;
+	};
+
+	// FileSystem::PollWaiter
+	//
+	// Interface implemented by an object that is signaled when the readiness of a Pollable
+	// handle changes.  Signal() is invoked without any locks held by the publisher
+	struct __declspec(novtable) PollWaiter
+	{
+		// Signal
+		//
+		// Indicates that the readiness of a handle has changed; events is a POLLxxx hint
+		virtual void Signal(uint32_t events) = 0;
+	};
+
+	// FileSystem::Pollable
+	//
+	// Optional interface that can be implemented by a Handle that publishes readiness
+	// changes; a Handle that does not implement Pollable is always ready for I/O
+	struct __declspec(novtable) Pollable
+	{
+		// Poll
+		//
+		// Gets the current POLLxxx readiness of the handle
+		virtual uint32_t Poll(void) const = 0;
+
+		// Subscribe
+		//
+		// Registers a waiter to be signaled when the readiness of the handle changes
+		virtual void Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter) = 0;
+
+		// Unsubscribe
+		//
+		// Removes a previously registered waiter
+		virtual void Unsubscribe(const FileSystem::PollWaiter* waiter) = 0;
+	};
+
+	// FileSystem::NotifyWatcher
+	//
+	// Interface implemented by an object that is notified of changes made to a Watchable
+	// node.  Notify() is invoked without any locks held by the publisher
+	struct __declspec(novtable) NotifyWatcher
+	{
+		// Notify
+		//
+		// Indicates that the node or a child of the node has changed; mask is a set of IN_xxx
+		// events, cookie relates IN_MOVED_FROM/IN_MOVED_TO pairs and name is the child name
+		virtual void Notify(uint32_t mask, uint32_t cookie, const char_t* name) = 0;
+	};
+
+	// FileSystem::Watchable
+	//
+	// Optional interface that can be implemented by a Node that publishes changes made to
+	// it or to its children; changes to a Node that does not implement Watchable are not reported
+	struct __declspec(novtable) Watchable
+	{
+		// Unwatch
+		//
+		// Removes a previously registered watcher
+		virtual void Unwatch(const FileSystem::NotifyWatcher* watcher) = 0;
+
+		// Watch
+		//
+		// Registers a watcher to be notified when the node or a child of the node changes
+		virtual void Watch(std::shared_ptr<FileSystem::NotifyWatcher> watcher) = 0;
+	};
+
 	// FileSystem::Mount
 	//
 	// Interface that must be implemented by a file system mount.  A mount is a view
@@ -398,8 +579,9 @@ public:
 
 		// Lookup
 		//
-		// Looks up the alias associated with a child of this directory
-		virtual std::shared_ptr<FileSystem::Alias> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const = 0;
+		// Looks up the alias associated with a child of this directory; a child that does not
+		// exist should be reported as LINUX_ENOENT in the result rather than by throwing
+		virtual FileSystem::Result<std::shared_ptr<FileSystem::Alias>> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const = 0;
 	};
 
 	// FileSystem::File
@@ -450,7 +632,8 @@ public:
 
 	// FileSystem::Path
 	//
-	// Path represents a fully resolved file system object
+	// Path represents a fully resolved file system object.  Path instances are created
+	// for every component resolved by LookupPath() and are allocated from a slab pool
 	class Path final
 	{
 	friend class FileSystem;
@@ -475,6 +658,16 @@ public:
 		//
 		// Creates a new Path instance from component parts
 		static std::shared_ptr<Path> Create(std::shared_ptr<FileSystem::Alias> alias, std::shared_ptr<FileSystem::Mount> mount);
+		static std::shared_ptr<Path> Create(std::shared_ptr<FileSystem::Path> parent, std::shared_ptr<FileSystem::Alias> alias, std::shared_ptr<FileSystem::Mount> mount);
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Alias
+		//
+		// Gets the alias to which this path has been resolved
+		__declspec(property(get=getAlias)) std::shared_ptr<FileSystem::Alias> Alias;
+		std::shared_ptr<FileSystem::Alias> getAlias(void) const;
 
 	private:
 
@@ -486,7 +679,7 @@ public:
 		//
 		Path(std::shared_ptr<FileSystem::Alias> alias, std::shared_ptr<FileSystem::Mount> mount);
 		Path(std::shared_ptr<FileSystem::Path> parent, std::shared_ptr<FileSystem::Alias> alias, std::shared_ptr<FileSystem::Mount> mount);
-		friend class std::_Ref_count_obj<Path>;
+		friend class std::_Ref_count_obj_alloc<Path, SlabAllocator<Path>>;
 
 		//---------------------------------------------------------------------
 		// Member Variables
@@ -532,6 +725,11 @@ public:
 		// Synchronously reads data from the underlying node into a buffer
 		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
 
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
 		// Seek
 		//
 		// Changes the file position
@@ -602,6 +800,12 @@ public:
 
 	//static void CreateSymbolicLink(const std::shared_ptr<Alias>& root, const std::shared_ptr<Alias>& base, const char_t* path, const char_t* target);
 
+	// CopyHandleData
+	//
+	// Copies data from one handle to another without passing it through the caller
+	static uapi::size_t CopyHandleData(std::shared_ptr<FileSystem::Handle> in, uapi::loff_t* inoffset, std::shared_ptr<FileSystem::Handle> out, 
+		uapi::loff_t* outoffset, uapi::size_t count);
+
 	// GenerateFileSystemId
 	//
 	// Generates a unique file system identifier (fsid)
@@ -630,6 +834,39 @@ public:
 	static std::shared_ptr<FileSystem::Handle> OpenFile(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
 		std::shared_ptr<FileSystem::Path> current, const char_t* path, int flags, uapi::mode_t mode);
 
+	// PollHandle
+	//
+	// Gets the current POLLxxx readiness of a handle
+	static uint32_t PollHandle(const std::shared_ptr<FileSystem::Handle>& handle);
+
+	// ReadHandleV
+	//
+	// Reads data from a handle into an array of buffers
+	static uapi::size_t ReadHandleV(const std::shared_ptr<FileSystem::Handle>& handle, const uapi::loff_t* offset, const uapi::iovec* iov, int iovcnt);
+
+	// WriteHandleV
+	//
+	// Writes data from an array of buffers to a handle
+	static uapi::size_t WriteHandleV(const std::shared_ptr<FileSystem::Handle>& handle, const uapi::loff_t* offset, const uapi::iovec* iov, int iovcnt);
+
+	// TryLookupPath
+	//
+	// Resolves a file system object as a FileSystem::Path instance without throwing on lookup failure
+	static FileSystem::Result<std::shared_ptr<FileSystem::Path>> TryLookupPath(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
+		std::shared_ptr<FileSystem::Path> current, const char_t* path, int flags);
+
+	// TryOpenExecutable
+	//
+	// Opens an existing file system object as an executable without throwing on lookup failure
+	static FileSystem::Result<std::shared_ptr<FileSystem::Handle>> TryOpenExecutable(std::shared_ptr<Namespace> ns, std::shared_ptr<Path> root, 
+		std::shared_ptr<Path> current, const char_t* path);
+
+	// TryOpenFile
+	//
+	// Opens or creates a file without throwing on lookup failure
+	static FileSystem::Result<std::shared_ptr<FileSystem::Handle>> TryOpenFile(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
+		std::shared_ptr<FileSystem::Path> current, const char_t* path, int flags, uapi::mode_t mode);
+
 	// ReadSymbolicLink
 	//
 	// Reads the target path associated with a symbolic link
@@ -648,7 +885,7 @@ private:
 	// LookupPath
 	//
 	// Resolves a file system object as a FileSystem::Path instance
-	static std::shared_ptr<FileSystem::Path> LookupPath(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
+	static FileSystem::Result<std::shared_ptr<FileSystem::Path>> LookupPath(std::shared_ptr<Namespace> ns, std::shared_ptr<FileSystem::Path> root, 
 		std::shared_ptr<FileSystem::Path> current, const char_t* path, FileSystem::LookupFlags flags, int depth);
 };
 
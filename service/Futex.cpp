@@ -0,0 +1,215 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Futex.h"
+
+#include "LinuxException.h"
+
+#pragma warning(push, 4)
+
+// Futex::s_buckets (static)
+//
+// Waiter hash buckets
+std::array<Futex::bucket_t, 256> Futex::s_buckets;
+
+//-----------------------------------------------------------------------------
+// Futex::GetBucket (private, static)
+//
+// Gets the bucket that tracks the waiters for a futex
+//
+// Arguments:
+//
+//	key			- Futex key
+
+Futex::bucket_t& Futex::GetBucket(const key_t& key)
+{
+	// Futex words are 32-bit aligned, discard the low bits of the offset before hashing it
+	size_t hash = std::hash<uintptr_t>()(reinterpret_cast<uintptr_t>(key.first)) ^ (std::hash<uintptr_t>()(key.second >> 2) * 31);
+	return s_buckets[hash % s_buckets.size()];
+}
+
+//-----------------------------------------------------------------------------
+// Futex::Requeue (static)
+//
+// Wakes waiters on a futex and moves the remaining waiters to another futex,
+// returns the total number of waiters that were woken or requeued
+//
+// Arguments:
+//
+//	key			- Futex key
+//	target		- Futex to move the remaining waiters to
+//	wake		- Maximum number of waiters to wake
+//	requeue		- Maximum number of waiters to requeue
+//	compare		- Optional futex word comparison (FUTEX_CMP_REQUEUE)
+
+size_t Futex::Requeue(const key_t& key, const key_t& target, size_t wake, size_t requeue, const compare_t& compare)
+{
+	size_t				woken = 0;				// Number of waiters woken
+	size_t				moved = 0;				// Number of waiters requeued
+
+	bucket_t& source = GetBucket(key);
+	bucket_t& destination = GetBucket(target);
+
+	// Both buckets have to be locked to move waiters from one to the other
+	std::unique_lock<std::mutex> sourcelock{ source.lock, std::defer_lock };
+	std::unique_lock<std::mutex> destinationlock{ destination.lock, std::defer_lock };
+	if(&source == &destination) sourcelock.lock();
+	else std::lock(sourcelock, destinationlock);
+
+	if(compare && !compare()) throw LinuxException(LINUX_EAGAIN);
+
+	for(auto iterator = source.waiters.begin(); (iterator != source.waiters.end()) && ((woken < wake) || (moved < requeue));) {
+
+		waiter_t* waiter = *iterator;
+		if(waiter->key != key) { ++iterator; continue; }
+
+		iterator = source.waiters.erase(iterator);
+
+		if(woken < wake) { Signal(waiter); woken++; }
+		else {
+
+			// The waiter continues to wait, but on the target futex
+			waiter->key = target;
+			waiter->bucket = &destination;
+			destination.waiters.push_back(waiter);
+			moved++;
+		}
+	}
+
+	return woken + moved;
+}
+
+//-----------------------------------------------------------------------------
+// Futex::Signal (private, static)
+//
+// Wakes a waiter that has been removed from its bucket; the bucket lock must be held
+//
+// Arguments:
+//
+//	waiter		- Waiter to be woken
+
+void Futex::Signal(waiter_t* waiter)
+{
+	waiter->queued = false;
+
+	// The waiter is notified with its lock held, it cannot return and release
+	// itself until the notification is complete
+	std::unique_lock<std::mutex> critsec{ waiter->lock };
+	waiter->signaled = true;
+	waiter->signal.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+// Futex::Wait (static)
+//
+// Waits for a futex to be woken
+//
+// Arguments:
+//
+//	key			- Futex key
+//	bitset		- Bitmask of FUTEX_WAKE_BITSET operations that can wake the waiter
+//	compare		- Futex word comparison
+//	deadline	- Time at which the wait expires, or deadline_t::max()
+
+void Futex::Wait(const key_t& key, uint32_t bitset, const compare_t& compare, const deadline_t& deadline)
+{
+	waiter_t			waiter;					// Waiter for this thread
+
+	waiter.key = key;
+	waiter.bitset = bitset;
+	waiter.bucket = &GetBucket(key);
+	waiter.queued = false;
+	waiter.signaled = false;
+
+	// The futex word has to be compared with the bucket locked; a thread that changes
+	// the word and then wakes the futex cannot acquire the lock until the waiter is queued
+	{
+		bucket_t* bucket = waiter.bucket;
+		std::unique_lock<std::mutex> critsec{ bucket->lock };
+
+		if(!compare()) throw LinuxException(LINUX_EAGAIN);
+
+		bucket->waiters.push_back(&waiter);
+		waiter.queued = true;
+	}
+
+	// todo: this needs to be interrupted by pending signals (EINTR)
+	{
+		std::unique_lock<std::mutex> critsec{ waiter.lock };
+
+		if(deadline == deadline_t::max()) waiter.signal.wait(critsec, [&]() -> bool { return waiter.signaled; });
+		else waiter.signal.wait_until(critsec, deadline, [&]() -> bool { return waiter.signaled; });
+
+		if(waiter.signaled) return;
+	}
+
+	// The wait timed out, but the waiter may have been woken or requeued to another
+	// bucket before it could be removed; the bucket only changes under its lock
+	while(true) {
+
+		bucket_t* bucket = waiter.bucket;
+		std::unique_lock<std::mutex> critsec{ bucket->lock };
+		if(bucket != waiter.bucket) continue;
+
+		// A waiter that was woken concurrently with the timeout reports the wake
+		if(!waiter.queued) return;
+
+		bucket->waiters.remove(&waiter);
+		throw LinuxException(LINUX_ETIMEDOUT);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Futex::Wake (static)
+//
+// Wakes waiters on a futex, returns the number of waiters that were woken
+//
+// Arguments:
+//
+//	key			- Futex key
+//	count		- Maximum number of waiters to wake
+//	bitset		- Bitmask of FUTEX_WAIT_BITSET waiters that can be woken
+
+size_t Futex::Wake(const key_t& key, size_t count, uint32_t bitset)
+{
+	size_t				woken = 0;				// Number of waiters woken
+
+	bucket_t& bucket = GetBucket(key);
+	std::unique_lock<std::mutex> critsec{ bucket.lock };
+
+	for(auto iterator = bucket.waiters.begin(); (iterator != bucket.waiters.end()) && (woken < count);) {
+
+		waiter_t* waiter = *iterator;
+		if((waiter->key != key) || ((waiter->bitset & bitset) == 0)) { ++iterator; continue; }
+
+		iterator = bucket.waiters.erase(iterator);
+		Signal(waiter);
+		woken++;
+	}
+
+	return woken;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
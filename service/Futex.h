@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __FUTEX_H_
+#define __FUTEX_H_
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <utility>
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// Futex
+//
+// Futex implements the wait queues for futexes that can be shared between
+// processes.  Process-private futexes (FUTEX_PRIVATE_FLAG) never reach the
+// service, they are implemented in the host process with WaitOnAddress().
+//
+// A shared futex is identified by the memory section that contains the futex
+// word and the offset of the word within that section, so processes that map
+// the same section at different addresses operate on the same futex.  Waiters
+// are kept in a fixed number of hash buckets; operations on different futexes
+// only contend if they hash to the same bucket.
+//
+// The futex word itself is accessed through a callback that is invoked with
+// the bucket locked, which is what makes a wait atomic with respect to a wake
+// that follows a change to the futex word.
+
+class Futex
+{
+public:
+
+	// compare_t
+	//
+	// Determines if the futex word contains the expected value; invoked with the bucket locked
+	using compare_t = std::function<bool(void)>;
+
+	// deadline_t
+	//
+	// Time at which a wait operation expires
+	using deadline_t = std::chrono::steady_clock::time_point;
+
+	// key_t
+	//
+	// Identifies a futex by the section that contains it and the offset into the section
+	using key_t = std::pair<HANDLE, uintptr_t>;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Requeue (static)
+	//
+	// Wakes waiters on a futex and moves the remaining waiters to another futex
+	static size_t Requeue(const key_t& key, const key_t& target, size_t wake, size_t requeue, const compare_t& compare);
+
+	// Wait (static)
+	//
+	// Waits for a futex to be woken
+	static void Wait(const key_t& key, uint32_t bitset, const compare_t& compare, const deadline_t& deadline);
+
+	// Wake (static)
+	//
+	// Wakes waiters on a futex, returns the number of waiters that were woken
+	static size_t Wake(const key_t& key, size_t count, uint32_t bitset);
+
+private:
+
+	Futex()=delete;
+	Futex(const Futex&)=delete;
+	Futex& operator=(const Futex&)=delete;
+
+	// Forward Declarations
+	//
+	struct bucket_t;
+
+	// waiter_t
+	//
+	// Thread waiting on a futex; lives on the stack of the waiting thread
+	struct waiter_t
+	{
+		key_t						key;			// Futex being waited on
+		uint32_t					bitset;			// FUTEX_WAIT_BITSET mask
+		std::atomic<bucket_t*>		bucket;			// Bucket that contains the waiter
+		bool						queued;			// Waiter is in the bucket
+		std::mutex					lock;			// Synchronization object
+		std::condition_variable		signal;			// Signaled when woken
+		bool						signaled;		// Waiter has been woken
+	};
+
+	// bucket_t
+	//
+	// Hash bucket of waiters, in the order that they started waiting
+	struct bucket_t
+	{
+		std::mutex					lock;			// Synchronization object
+		std::list<waiter_t*>		waiters;		// Waiting threads
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// GetBucket (static)
+	//
+	// Gets the bucket that tracks the waiters for a futex
+	static bucket_t& GetBucket(const key_t& key);
+
+	// Signal (static)
+	//
+	// Wakes a waiter; the bucket lock must be held
+	static void Signal(waiter_t* waiter);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	static std::array<bucket_t, 256>	s_buckets;		// Waiter hash buckets
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __FUTEX_H_
@@ -23,30 +23,135 @@
 #include "stdafx.h"
 #include "HostFileSystem.h"
 
+#include <algorithm>
+#include <vector>
 #include <Shlwapi.h>
 #include "Capability.h"
+#include "HeapBuffer.h"
 #include "MountOptions.h"
 #include "LinuxException.h"
+#include "NtApi.h"
 #include "SystemInformation.h"
 #include "Win32Exception.h"
 
 #include "Exception.h"
 
+#pragma comment(lib, "ntdll.lib")
 #pragma comment(lib, "shlwapi.lib")
 
+// FSCTL_DUPLICATE_EXTENTS_TO_FILE
+//
+// Block cloning was introduced with Windows Server 2016 (ReFS v2) and is not
+// declared by the Windows 8 headers that this project targets
+#ifndef FSCTL_DUPLICATE_EXTENTS_TO_FILE
+#define FSCTL_DUPLICATE_EXTENTS_TO_FILE		CTL_CODE(FILE_DEVICE_FILE_SYSTEM, 209, METHOD_BUFFERED, FILE_WRITE_ACCESS)
+
+typedef struct _DUPLICATE_EXTENTS_DATA {
+
+	HANDLE				FileHandle;
+	LARGE_INTEGER		SourceFileOffset;
+	LARGE_INTEGER		TargetFileOffset;
+	LARGE_INTEGER		ByteCount;
+
+} DUPLICATE_EXTENTS_DATA, *PDUPLICATE_EXTENTS_DATA;
+#endif
+
 #pragma warning(push, 4)
 
-// Invariants
+// DIRECTORY_BUFFER_SIZE
+//
+// Size of the buffer used to enumerate host directory entries
+static const ULONG DIRECTORY_BUFFER_SIZE = (64 << 10);
+
+// READAHEAD_MAXIMUM
+//
+// Maximum size of the read-ahead window for sequential access
+static const size_t READAHEAD_MAXIMUM = (512 << 10);
+
+// READAHEAD_MINIMUM
 //
-static_assert(FILE_BEGIN == LINUX_SEEK_SET,		"HostFileSystem: FILE_BEGIN must be the same value as LINUX_SEEK_SET");
-static_assert(FILE_CURRENT == LINUX_SEEK_CUR,	"HostFileSystem: FILE_CURRENT must be the same value as LINUX_SEEK_CUR");
-static_assert(FILE_END == LINUX_SEEK_END,		"HostFileSystem: FILE_END must be the same value as LINUX_SEEK_END");
+// Initial size of the read-ahead window for sequential access
+static const size_t READAHEAD_MINIMUM = (32 << 10);
+
+// STAT_CACHE_LIMIT
+//
+// Maximum number of cached node statistics to retain
+static const size_t STAT_CACHE_LIMIT = 16384;
 
 // Local Function Prototypes
 //
 static windows_path		HandleToPathW(HANDLE handle);
 static LinuxException	MapHostException(DWORD code);
 
+//-----------------------------------------------------------------------------
+// DirectoryEntryType (local)
+//
+// Determines the linux_dirent64 type code for a host directory entry
+//
+// Arguments:
+//
+//	attributes	- Host file attributes of the directory entry
+
+inline static uint8_t DirectoryEntryType(ULONG attributes)
+{
+	// Reparse points are always followed to their target, the type of which is not known here
+	if(attributes & FILE_ATTRIBUTE_REPARSE_POINT) return LINUX_DT_UNKNOWN;
+	return (attributes & FILE_ATTRIBUTE_DIRECTORY) ? LINUX_DT_DIR : LINUX_DT_REG;
+}
+
+//-----------------------------------------------------------------------------
+// EntryTimeToTimespec (local)
+//
+// Converts a host directory entry timestamp into a uapi::timespec
+//
+// Arguments:
+//
+//	time		- Host directory entry timestamp
+
+inline static uapi::timespec EntryTimeToTimespec(LARGE_INTEGER const& time)
+{
+	return convert<uapi::timespec>(FILETIME{ time.LowPart, static_cast<DWORD>(time.HighPart) });
+}
+
+//-----------------------------------------------------------------------------
+// FoldPath (local)
+//
+// Case-folds a host path so that it can be used as a lookup key
+//
+// Arguments:
+//
+//	path		- Host path to be case-folded in place
+
+inline static std::wstring& FoldPath(std::wstring& path)
+{
+	if(!path.empty()) CharLowerBuffW(&path[0], static_cast<DWORD>(path.length()));
+	return path;
+}
+
+//-----------------------------------------------------------------------------
+// GatherIoVector (local)
+//
+// Copies the contents of an array of buffers into a single contiguous buffer
+//
+// Arguments:
+//
+//	iov			- Array of source buffers
+//	iovcnt		- Number of source buffers in the array
+//	buffer		- Destination buffer, must be large enough for all source buffers
+
+static void GatherIoVector(const uapi::iovec* iov, int iovcnt, void* buffer)
+{
+	uint8_t* dest = reinterpret_cast<uint8_t*>(buffer);
+
+	for(int index = 0; index < iovcnt; index++) {
+
+		if(iov[index].iov_len == 0) continue;
+
+		memcpy(dest, iov[index].iov_base, iov[index].iov_len);
+		dest += iov[index].iov_len;
+	}
+}
+
 //-----------------------------------------------------------------------------
 // HandleAccessToHostAccess (local)
 //
@@ -106,6 +211,46 @@ static windows_path HandleToPathW(HANDLE handle)
 	return windows_path{ std::move(path), cch + 1 };
 }
 
+//-----------------------------------------------------------------------------
+// IoVectorLength (local)
+//
+// Calculates the total length of an array of buffers and determines if the buffers
+// are adjacent to each other in memory, in which case they can be treated as one
+//
+// Arguments:
+//
+//	iov			- Array of buffers
+//	iovcnt		- Number of buffers in the array
+//	contiguous	- Receives the address of the first buffer if all buffers are adjacent
+
+static uapi::size_t IoVectorLength(const uapi::iovec* iov, int iovcnt, void** contiguous)
+{
+	uapi::size_t		total = 0;				// Total length of the buffers
+	uint8_t*			next = nullptr;			// Expected address of the next buffer
+
+	if((iovcnt < 0) || (iovcnt > LINUX_UIO_MAXIOV)) throw LinuxException(LINUX_EINVAL);
+	if((iov == nullptr) && (iovcnt > 0)) throw LinuxException(LINUX_EFAULT);
+
+	*contiguous = nullptr;
+
+	for(int index = 0; index < iovcnt; index++) {
+
+		if(iov[index].iov_len == 0) continue;
+		if(iov[index].iov_base == nullptr) throw LinuxException(LINUX_EFAULT);
+		if(iov[index].iov_len > static_cast<uapi::size_t>(MAXSSIZE_T) - total) throw LinuxException(LINUX_EINVAL);
+
+		// The first non-empty buffer sets the base address, every other buffer must follow on from the previous one
+		uint8_t* base = reinterpret_cast<uint8_t*>(iov[index].iov_base);
+		if(total == 0) *contiguous = base;
+		else if(base != next) *contiguous = nullptr;
+
+		next = base + iov[index].iov_len;
+		total += iov[index].iov_len;
+	}
+
+	return total;
+}
+
 //-----------------------------------------------------------------------------
 // MapHostException (local)
 //
@@ -136,20 +281,150 @@ static LinuxException MapHostException(DWORD code)
 	return LinuxException(linuxcode, Win32Exception(code));
 }
 
+//-----------------------------------------------------------------------------
+// ReadHostFile (local)
+//
+// Reads data from a specific position of a host file
+//
+// Arguments:
+//
+//	channel		- Host file I/O channel
+//	offset		- Offset from the start of the file to begin reading
+//	buffer		- Destination memory buffer
+//	count		- Number of bytes to read from the file
+
+static DWORD ReadHostFile(IoEngine::Channel& channel, uapi::loff_t offset, void* buffer, DWORD count)
+{
+	// Reads that start at or beyond the end of the file are reported as zero bytes by the channel
+	try { return channel.Read(offset, buffer, count); }
+	catch(Win32Exception& ex) { throw MapHostException(ex.Code); }
+}
+
+//-----------------------------------------------------------------------------
+// ScatterIoVector (local)
+//
+// Copies the contents of a single contiguous buffer into an array of buffers
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	length		- Number of bytes to copy from the source buffer
+//	iov			- Array of destination buffers
+//	iovcnt		- Number of destination buffers in the array
+
+static void ScatterIoVector(const void* buffer, uapi::size_t length, const uapi::iovec* iov, int iovcnt)
+{
+	const uint8_t* source = reinterpret_cast<const uint8_t*>(buffer);
+
+	for(int index = 0; (index < iovcnt) && (length > 0); index++) {
+
+		uapi::size_t copy = std::min(iov[index].iov_len, length);
+		if(copy == 0) continue;
+
+		memcpy(iov[index].iov_base, source, copy);
+		source += copy;
+		length -= copy;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// WriteHostFile (local)
+//
+// Writes data to a specific position of a host file
+//
+// Arguments:
+//
+//	channel		- Host file I/O channel
+//	offset		- Offset from the start of the file to begin writing, or EndOfFile
+//	buffer		- Source memory buffer
+//	count		- Number of bytes to write into the file
+
+static DWORD WriteHostFile(IoEngine::Channel& channel, uapi::loff_t offset, const void* buffer, DWORD count)
+{
+	try { return channel.Write(offset, buffer, count); }
+	catch(Win32Exception& ex) { throw MapHostException(ex.Code); }
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem Constructor (private)
 //
 // Arguments:
 //
+//	ioengine	- Host I/O completion engine
 //	source		- Source string provided to mount function
 //	flags		- File system specific mounting flags
 
-HostFileSystem::HostFileSystem(const char_t* source, uint32_t flags) : m_source(source), m_flags(flags), m_fsid(FileSystem::GenerateFileSystemId())
+HostFileSystem::HostFileSystem(std::shared_ptr<IoEngine> ioengine, const char_t* source, uint32_t flags) : m_ioengine(std::move(ioengine)), m_source(source), m_flags(flags), m_fsid(FileSystem::GenerateFileSystemId()), 
+	m_movecookie(0), m_attrcache(false), m_statttl(0), m_stathits(0), m_statmisses(0)
 {
 	// No mount-specific flags should be specified for the file system instance
 	_ASSERTE((flags & LINUX_MS_PERMOUNT_MASK) == 0);
 }
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::AttachNode (private, static)
+//
+// Places a new node into the tracking collection, or returns the node that is
+// already active for the same host object
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	node		- Newly constructed node instance
+
+std::shared_ptr<HostFileSystem::NodeBase> HostFileSystem::AttachNode(std::shared_ptr<HostFileSystem> const& fs, std::shared_ptr<NodeBase> const& node)
+{
+	sync::critical_section::scoped_lock critsec{ fs->m_cs };
+
+	auto result = fs->m_nodes.emplace(node->Id, nodeentry_t{ node.get(), node });
+	if(!result.second) {
+
+		// An entry for this host object exists; if that node is still alive it wins
+		auto existing = result.first->second.weak.lock();
+		if(existing) return existing;
+
+		// The existing node has expired but has not yet been destroyed, take over the entry.  The
+		// expired node will not remove the entry on destruction since it no longer owns it
+		result.first->second = nodeentry_t{ node.get(), node };
+	}
+
+	// Index the node by its normalized path so that subsequent lookups can find it without
+	// accessing the host; the node removes this entry again when it is destroyed
+	std::wstring path{ node->NormalizedPath };
+	fs->m_nodepaths[std::move(FoldPath(path))] = node->Id;
+
+	return node;
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::CacheStat (private, static)
+//
+// Stores node statistics in the attribute cache
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	id			- Host object identifier
+//	path		- Normalized host path to the node
+//	stats		- Node statistics to be stored
+//	once		- Flag to discard the statistics after they are used once
+
+void HostFileSystem::CacheStat(std::shared_ptr<HostFileSystem> const& fs, nodeid_t const& id, std::wstring&& path, uapi::stat const& stats, bool once)
+{
+	if(!fs->StatCacheEnabled()) return;
+
+	ULONGLONG expires = (fs->m_statttl) ? GetTickCount64() + fs->m_statttl : 0;
+
+	sync::critical_section::scoped_lock critsec{ fs->m_cs };
+
+	// Discard everything if the collection grows too large rather than tracking usage
+	if(fs->m_stats.size() >= STAT_CACHE_LIMIT) { fs->m_stats.clear(); fs->m_statpaths.clear(); }
+
+	// The path index allows host change notifications, which only provide names, to locate the entry
+	fs->m_stats[id] = statentry_t{ stats, expires, once };
+	fs->m_statpaths[std::move(FoldPath(path))] = id;
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::CreateDirectoryNode (private, static)
 //
@@ -165,6 +440,10 @@ std::shared_ptr<HostFileSystem::DirectoryNode> HostFileSystem::CreateDirectoryNo
 	std::shared_ptr<DirectoryNode>			node;				// The new node instance
 	FILE_BASIC_INFO							info;				// Basic file information
 
+	// Check for an active node at this path before accessing the host at all
+	auto active = std::dynamic_pointer_cast<DirectoryNode>(FindNode(fs, path));
+	if(active) return active;
+
 	// Attempt to open a query-only handle against the file system object (don't use FILE_GENERIC_EXECUTE for directories)
 	HANDLE handle = ::CreateFileW(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_POSIX_SEMANTICS | FILE_FLAG_BACKUP_SEMANTICS, nullptr);
 	if(handle == INVALID_HANDLE_VALUE) throw MapHostException(GetLastError());
@@ -175,8 +454,14 @@ std::shared_ptr<HostFileSystem::DirectoryNode> HostFileSystem::CreateDirectoryNo
 		if(!GetFileInformationByHandleEx(handle, FileBasicInfo, &info, sizeof(FILE_BASIC_INFO))) throw MapHostException(GetLastError());
 		if((info.FileAttributes & FILE_ATTRIBUTE_DIRECTORY) != FILE_ATTRIBUTE_DIRECTORY) throw LinuxException(LINUX_ENOTDIR);
 
+		// If there is already an active node for this host object, release the new handle and use that
+		// instead; this avoids retaining multiple native handles against the same host object
+		auto id = GetNodeId(handle);
+		auto existing = std::dynamic_pointer_cast<DirectoryNode>(FindNode(fs, id));
+		if(existing) { CloseHandle(handle); return existing; }
+
 		// Construct the node instance; this will take ownership of the operating system handle
-		node = std::make_shared<DirectoryNode>(fs, handle);
+		node = std::make_shared<DirectoryNode>(fs, handle, id);
 	}
 
 	catch(...) { CloseHandle(handle); throw; }
@@ -184,9 +469,10 @@ std::shared_ptr<HostFileSystem::DirectoryNode> HostFileSystem::CreateDirectoryNo
 	// Ensure that the final normalized path to the node is within the virtual file system [sandbox]
 	if(wcsncmp(fs->m_sandbox.c_str(), node->NormalizedPath, fs->m_sandbox.length()) != 0) throw LinuxException(LINUX_EXDEV);
 
-	// Place a weak reference to the node into the tracking collection before returning it
-	sync::critical_section::scoped_lock critsec{ fs->m_cs };
-	if(!fs->m_nodes.emplace(node.get(), node).second) throw LinuxException(LINUX_ENOMEM);
+	// Place a weak reference to the node into the tracking collection; if another thread attached
+	// a node for the same host object in the meantime, that node is returned and this one discarded
+	auto attached = std::dynamic_pointer_cast<DirectoryNode>(AttachNode(fs, node));
+	if(attached) return attached;
 	
 	return node;
 }
@@ -207,6 +493,14 @@ std::shared_ptr<HostFileSystem::FileNode> HostFileSystem::CreateFileNode(std::sh
 	std::shared_ptr<FileNode>				node;				// The new node instance
 	FILE_BASIC_INFO							info;				// Basic file information
 
+	// Check for an active node at this path before accessing the host at all; this only applies
+	// when opening an existing object, other dispositions have to reach the host to take effect
+	if(disposition == OPEN_EXISTING) {
+
+		auto active = std::dynamic_pointer_cast<FileNode>(FindNode(fs, path));
+		if(active) return active;
+	}
+
 	// Attempt to open a query-only handle against the file system object
 	HANDLE handle = ::CreateFileW(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, disposition, FILE_FLAG_POSIX_SEMANTICS, nullptr);
 	if(handle == INVALID_HANDLE_VALUE) throw MapHostException(GetLastError());
@@ -217,8 +511,14 @@ std::shared_ptr<HostFileSystem::FileNode> HostFileSystem::CreateFileNode(std::sh
 		if(!GetFileInformationByHandleEx(handle, FileBasicInfo, &info, sizeof(FILE_BASIC_INFO))) throw MapHostException(GetLastError());
 		if((info.FileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY) throw LinuxException(LINUX_EISDIR);
 
+		// If there is already an active node for this host object, release the new handle and use that
+		// instead; this avoids retaining multiple native handles against the same host object
+		auto id = GetNodeId(handle);
+		auto existing = std::dynamic_pointer_cast<FileNode>(FindNode(fs, id));
+		if(existing) { CloseHandle(handle); return existing; }
+
 		// Construct the node instance; this will take ownership of the operating system handle
-		node = std::make_shared<FileNode>(fs, handle);
+		node = std::make_shared<FileNode>(fs, handle, id);
 	}
 
 	catch(...) { CloseHandle(handle); throw; }
@@ -226,13 +526,338 @@ std::shared_ptr<HostFileSystem::FileNode> HostFileSystem::CreateFileNode(std::sh
 	// Ensure that the final normalized path to the node is within the virtual file system [sandbox]
 	if(wcsncmp(fs->m_sandbox.c_str(), node->NormalizedPath, fs->m_sandbox.length()) != 0) throw LinuxException(LINUX_EXDEV);
 
-	// Place a weak reference to the node into the tracking collection before returning it
-	sync::critical_section::scoped_lock critsec{ fs->m_cs };
-	if(!fs->m_nodes.emplace(node.get(), node).second) throw LinuxException(LINUX_ENOMEM);
+	// Place a weak reference to the node into the tracking collection; if another thread attached
+	// a node for the same host object in the meantime, that node is returned and this one discarded
+	auto attached = std::dynamic_pointer_cast<FileNode>(AttachNode(fs, node));
+	if(attached) return attached;
 
 	return node;
 }
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::FindNode (private, static)
+//
+// Locates an active node instance by host object identifier
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	id			- Host object identifier
+
+std::shared_ptr<HostFileSystem::NodeBase> HostFileSystem::FindNode(std::shared_ptr<HostFileSystem> const& fs, nodeid_t const& id)
+{
+	sync::critical_section::scoped_lock critsec{ fs->m_cs };
+
+	// The weak reference may have expired even if the node has not yet been destroyed
+	auto found = fs->m_nodes.find(id);
+	return (found == fs->m_nodes.end()) ? nullptr : found->second.weak.lock();
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::FindNode (private, static)
+//
+// Locates an active node instance by host path without accessing the host
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	path		- Normalized host path to the node
+
+std::shared_ptr<HostFileSystem::NodeBase> HostFileSystem::FindNode(std::shared_ptr<HostFileSystem> const& fs, const wchar_t* path)
+{
+	// The path index can only be trusted while changes to the host are being monitored,
+	// otherwise an object could have been replaced or renamed without this instance knowing
+	if(!fs->m_watcher || !fs->m_watcher->Active) return nullptr;
+
+	std::wstring key{ path };
+	FoldPath(key);
+
+	sync::critical_section::scoped_lock critsec{ fs->m_cs };
+
+	auto found = fs->m_nodepaths.find(key);
+	if(found == fs->m_nodepaths.end()) return nullptr;
+
+	// The weak reference may have expired even if the node has not yet been destroyed
+	auto node = fs->m_nodes.find(found->second);
+	return (node == fs->m_nodes.end()) ? nullptr : node->second.weak.lock();
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::GetNodeId (private, static)
+//
+// Retrieves the host object identifier for a native handle
+//
+// Arguments:
+//
+//	handle		- Native operating system handle
+
+HostFileSystem::nodeid_t HostFileSystem::GetNodeId(HANDLE handle)
+{
+	FILE_ID_INFO				info;			// Host file identifier information
+
+	// FILE_ID_INFO provides both the volume serial number and the 128-bit file identifier
+	if(!GetFileInformationByHandleEx(handle, FileIdInfo, &info, sizeof(FILE_ID_INFO))) throw MapHostException(GetLastError());
+
+	return nodeid_t{ info.VolumeSerialNumber, info.FileId };
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::getStatCacheHits
+//
+// Gets the number of node attribute requests satisfied by the cache
+
+uint64_t HostFileSystem::getStatCacheHits(void) const
+{
+	return m_stathits;
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::getStatCacheMisses
+//
+// Gets the number of node attribute requests that required a host query
+
+uint64_t HostFileSystem::getStatCacheMisses(void) const
+{
+	return m_statmisses;
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::InvalidateStat (private, static)
+//
+// Removes node statistics from the attribute cache
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	id			- Host object identifier
+
+void HostFileSystem::InvalidateStat(std::shared_ptr<HostFileSystem> const& fs, nodeid_t const& id)
+{
+	sync::critical_section::scoped_lock critsec{ fs->m_cs };
+
+	// The path index entry is left behind; it will be replaced or ignored if the node is cached again
+	fs->m_stats.erase(id);
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::LookupStat (private, static)
+//
+// Retrieves node statistics from the attribute cache
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	id			- Host object identifier
+//	stats		- Buffer to receive the node statistics
+
+bool HostFileSystem::LookupStat(std::shared_ptr<HostFileSystem> const& fs, nodeid_t const& id, uapi::stat* stats)
+{
+	if(!fs->StatCacheEnabled()) return false;
+
+	sync::critical_section::scoped_lock critsec{ fs->m_cs };
+
+	auto found = fs->m_stats.find(id);
+	if((found != fs->m_stats.end()) && (found->second.expires != 0) && (GetTickCount64() >= found->second.expires)) {
+
+		// The entry has outlived the configured attribute cache timeout
+		fs->m_stats.erase(found);
+		found = fs->m_stats.end();
+	}
+
+	if(found == fs->m_stats.end()) { ++fs->m_statmisses; return false; }
+
+	*stats = found->second.stats;
+	++fs->m_stathits;
+
+	// Statistics primed from a directory enumeration are incomplete and are only used once
+	if(found->second.once) fs->m_stats.erase(found);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::OnHostChange (private)
+//
+// Invalidates cached node statistics and notifies watched nodes in response to a
+// host change notification
+//
+// Arguments:
+//
+//	root		- Normalized path to the monitored directory
+//	action		- FILE_ACTION_XXX change notification action
+//	name		- Path of the changed object relative to the monitored directory
+//	length		- Length of the relative path, in characters
+
+void HostFileSystem::OnHostChange(std::wstring const& root, DWORD action, const wchar_t* name, size_t length)
+{
+	std::vector<std::shared_ptr<NodeBase>>	watched;		// Watched nodes affected by the change
+	std::vector<std::shared_ptr<NodeBase>>	modified;		// Nodes with stale buffered data
+	std::shared_ptr<NodeBase>				self;			// Watched node that changed
+	std::shared_ptr<NodeBase>				parent;			// Watched parent of the node that changed
+	uint32_t								cookie = 0;		// IN_MOVED_FROM/IN_MOVED_TO cookie
+
+	// Generate the path to the changed object
+	std::wstring hostpath{ root };
+	if(hostpath.empty() || (hostpath.back() != L'\\')) hostpath.push_back(L'\\');
+	if(name) hostpath.append(name, length);
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		// Locates the live node registered in the watch index for a path, if any
+		auto findwatched = [&](std::wstring const& key) -> std::shared_ptr<NodeBase> {
+
+			auto found = m_watchpaths.find(key);
+			if(found == m_watchpaths.end()) return nullptr;
+
+			auto node = m_nodes.find(found->second);
+			return (node == m_nodes.end()) ? nullptr : node->second.weak.lock();
+		};
+
+		// A null name indicates that changes have been lost, the entire cache must be discarded
+		// and every watched node is told that events have been dropped
+		if(name == nullptr) { 
+			
+			m_stats.clear(); 
+			m_statpaths.clear(); 
+			m_nodepaths.clear();
+			
+			for(auto const& iterator : m_watchpaths) {
+
+				auto node = findwatched(iterator.first);
+				if(node) watched.push_back(std::move(node));
+			}
+
+			// Any file may have been written, all buffered file data is suspect.  References are held
+			// until the lock is released so that no node can be destroyed during the iteration
+			for(auto const& iterator : m_nodes) {
+
+				auto node = iterator.second.weak.lock();
+				if(node) modified.push_back(std::move(node));
+			}
+		}
+
+		else {
+
+			// Generate the case-folded path to the changed object
+			std::wstring path{ hostpath };
+			FoldPath(path);
+
+			auto invalidate = [&](std::wstring const& key) {
+
+				auto found = m_statpaths.find(key);
+				if(found == m_statpaths.end()) return;
+
+				m_stats.erase(found->second);
+				m_statpaths.erase(found);
+			};
+
+			invalidate(path);
+			self = findwatched(path);
+
+			// A host modification to a live file node makes its buffered data stale
+			if(action == FILE_ACTION_MODIFIED) {
+
+				auto indexed = m_nodepaths.find(path);
+				auto node = (indexed == m_nodepaths.end()) ? m_nodes.end() : m_nodes.find(indexed->second);
+				if(node != m_nodes.end()) {
+
+					auto live = node->second.weak.lock();
+					if(live) modified.push_back(std::move(live));
+				}
+			}
+
+			// Any change other than a modification means that the path may no longer refer to the
+			// same host object; removing or renaming a directory also invalidates everything below it
+			if(action != FILE_ACTION_MODIFIED) m_nodepaths.erase(path);
+			if((action == FILE_ACTION_REMOVED) || (action == FILE_ACTION_RENAMED_OLD_NAME)) {
+
+				std::wstring prefix{ path };
+				prefix.push_back(L'\\');
+
+				for(auto iterator = m_nodepaths.begin(); iterator != m_nodepaths.end();) {
+
+					if(iterator->first.compare(0, prefix.length(), prefix) == 0) iterator = m_nodepaths.erase(iterator);
+					else ++iterator;
+				}
+			}
+
+			// Adding, removing or renaming an object also modifies the parent directory
+			auto separator = path.find_last_of(L'\\');
+			std::wstring parentpath{ path.substr(0, (separator < root.length()) ? root.length() : separator) };
+			if(action != FILE_ACTION_MODIFIED) invalidate(parentpath);
+			parent = findwatched(parentpath);
+
+			// Renames are reported as adjacent old name/new name pairs that share a cookie
+			if(action == FILE_ACTION_RENAMED_OLD_NAME) cookie = ++m_movecookie;
+			else if(action == FILE_ACTION_RENAMED_NEW_NAME) cookie = m_movecookie;
+		}
+	}
+
+	// Buffered data is discarded and watchers are notified without the file system lock held
+	for(auto const& node : modified) {
+
+		auto file = std::dynamic_pointer_cast<FileNode>(node);
+		if(file) file->InvalidateCache();
+	}
+
+	for(auto const& node : watched) node->Notify(LINUX_IN_Q_OVERFLOW, 0, nullptr);
+	if(!self && !parent) return;
+
+	// Directories report IN_ISDIR; the object type is only queried from the host when it isn't
+	// already known and there is a watched parent to report it to
+	bool isdir = false;
+	if(self) isdir = (std::dynamic_pointer_cast<DirectoryNode>(self) != nullptr);
+	else if(action != FILE_ACTION_REMOVED) {
+
+		DWORD attributes = GetFileAttributesW(hostpath.c_str());
+		isdir = (attributes != INVALID_FILE_ATTRIBUTES) && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+	}
+
+	uint32_t selfmask = 0;						// Events reported against the node itself
+	uint32_t parentmask = 0;					// Events reported against the parent directory
+
+	switch(action) {
+
+		case FILE_ACTION_ADDED: parentmask = LINUX_IN_CREATE; break;
+		case FILE_ACTION_REMOVED: selfmask = LINUX_IN_DELETE_SELF; parentmask = LINUX_IN_DELETE; break;
+		case FILE_ACTION_RENAMED_OLD_NAME: selfmask = LINUX_IN_MOVE_SELF; parentmask = LINUX_IN_MOVED_FROM; break;
+		case FILE_ACTION_RENAMED_NEW_NAME: parentmask = LINUX_IN_MOVED_TO; break;
+
+		// The host reports a directory as modified when its children change, Linux does not
+		case FILE_ACTION_MODIFIED: if(!isdir) selfmask = parentmask = LINUX_IN_MODIFY; break;
+	}
+
+	if(self && selfmask) self->Notify(selfmask, 0, nullptr);
+
+	if(parent && parentmask) {
+
+		// The child name is the final component of the relative path
+		size_t offset = length;
+		while((offset > 0) && (name[offset - 1] != L'\\')) --offset;
+
+		std::string child = std::to_string(name + offset, static_cast<int>(length - offset));
+		parent->Notify(parentmask | ((isdir) ? LINUX_IN_ISDIR : 0), cookie, child.c_str());
+	}
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::StatCacheEnabled (private)
+//
+// Determines if node statistics can currently be cached
+//
+// Arguments:
+//
+//	NONE
+
+bool HostFileSystem::StatCacheEnabled(void) const
+{
+	if(!m_attrcache) return false;
+
+	// Statistics can be cached if they expire or if changes to the host are being monitored
+	return (m_statttl != 0) || (m_watcher && m_watcher->Active);
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::Mount (static)
 //
@@ -240,14 +865,17 @@ std::shared_ptr<HostFileSystem::FileNode> HostFileSystem::CreateFileNode(std::sh
 //
 // Arguments:
 //
+//	ioengine	- Host I/O completion engine
 //	source		- Source device path
 //	flags		- Standard mount options bitmask
 //	data		- Extended mount options data
 //	datalength	- Length of the extended mount options data in bytes
 
-std::shared_ptr<FileSystem::Mount> HostFileSystem::Mount(const char_t* source, uint32_t flags, const void* data, size_t datalength)
+std::shared_ptr<FileSystem::Mount> HostFileSystem::Mount(std::shared_ptr<IoEngine> ioengine, const char_t* source, uint32_t flags, const void* data, size_t datalength)
 {
 	bool sandbox = true;						// Flag to sandbox the virtual file system
+	bool attrcache = true;						// Flag to cache node attributes
+	ULONGLONG actimeo = 0;						// Node attribute cache timeout
 
 	if(source == nullptr) throw LinuxException(LINUX_EFAULT, Exception(E_POINTER));
 
@@ -271,18 +899,46 @@ std::shared_ptr<FileSystem::Mount> HostFileSystem::Mount(const char_t* source, u
 		//
 		// Clears the option to check all nodes are within the base mounting path
 		if(options.Arguments.Contains("nosandbox")) sandbox = false;
+
+		// actimeo=n
+		//
+		// Sets the number of seconds after which cached node attributes expire
+		if(options.Arguments.Contains("actimeo")) actimeo = std::stoul(options.Arguments["actimeo"], 0, 0) * 1000ULL;
+
+		// noac
+		//
+		// Disables caching of node attributes
+		if(options.Arguments.Contains("noac")) attrcache = false;
 	}
 
 	catch(...) { throw LinuxException(LINUX_EINVAL); }
 
 	// Construct the file system instance and the root directory node instance.  If the target
 	// object is not a directory, CreateDirectoryNode() will throw ENOTDIR
-	auto fs = std::make_shared<HostFileSystem>(source, fsflags);
+	auto fs = std::make_shared<HostFileSystem>(std::move(ioengine), source, fsflags);
 	auto rootdir = CreateDirectoryNode(fs, windows_path(std::to_wstring(source).c_str()));
 	
 	// Assign the base path string from the normalized root node path to create the sandbox
 	if(sandbox) fs->m_sandbox = rootdir->NormalizedPath;
 
+	fs->m_attrcache = attrcache;
+	if(attrcache) fs->m_statttl = actimeo;
+
+	// Monitor the mounted directory tree for changes that invalidate cached node attributes and are
+	// reported to inotify watches.  If the watcher cannot be started, attributes will only be cached
+	// when they are set to expire and inotify watches will not receive any events
+	try {
+
+		std::wstring root{ rootdir->NormalizedPath };
+		auto fsptr = fs.get();
+
+		fs->m_watcher = std::make_unique<DirectoryWatcher>(root.c_str(), true, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | 
+			FILE_NOTIFY_CHANGE_ATTRIBUTES | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION, 
+			[=](DWORD action, const wchar_t* name, size_t length) { fsptr->OnHostChange(root, action, name, length); });
+	}
+
+	catch(...) { /* DISCARD */ }
+
 	// Construct and return the mount instance, using the mount-specific flags
 	return std::make_shared<class Mount>(fs, rootdir, mountflags);
 }
@@ -350,6 +1006,22 @@ std::shared_ptr<FileSystem::Node> HostFileSystem::Alias::getNode(void) const
 // HOSTFILESYSTEM::DIRECTORYHANDLE
 //
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::DirectoryHandle Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	handle		- Native operating system handle
+//	id			- Host object identifier
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+HostFileSystem::DirectoryHandle::DirectoryHandle(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+	: HandleBase(std::move(fs), handle, id, access, flags), m_bufferlength(0), m_bufferoffset(0), m_position(0), m_restart(true), m_blksize(0)
+{
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::DirectoryHandle::getAccess
 //
@@ -371,17 +1043,22 @@ FileSystem::HandleAccess HostFileSystem::DirectoryHandle::getAccess(void) const
 
 std::shared_ptr<FileSystem::Handle> HostFileSystem::DirectoryHandle::Duplicate(void) const
 {
-	HANDLE								duplicate;		// Duplicated operating system handle
 	std::shared_ptr<DirectoryHandle>	handle;			// New DirectoryHandle object instance
 
-	// Duplicate the existing operating system handle with the same flags and access as the contained one
-	if(!DuplicateHandle(GetCurrentProcess(), m_handle, GetCurrentProcess(), &duplicate, 0, FALSE, DUPLICATE_SAME_ACCESS))
-		throw MapHostException(GetLastError());
+	// The host enumeration cursor belongs to the native file object, so the duplicate must be 
+	// a new file object rather than a duplicated handle to maintain an independent cursor
+	HANDLE duplicate = ReOpenFile(m_handle, FILE_LIST_DIRECTORY | FILE_READ_ATTRIBUTES | SYNCHRONIZE, FILE_SHARE_READ | FILE_SHARE_WRITE, 
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_POSIX_SEMANTICS);
+	if(duplicate == INVALID_HANDLE_VALUE) throw MapHostException(GetLastError());
 
 	// Create the DirectoryHandle that will own the native operating system handle
-	try { handle = std::make_shared<DirectoryHandle>(m_fs, duplicate, m_access, m_flags); }
+	try { handle = std::make_shared<DirectoryHandle>(m_fs, duplicate, m_id, m_access, m_flags); }
 	catch(...) { CloseHandle(duplicate); throw; }
 
+	// Move the duplicate handle to the same directory position as this handle
+	sync::critical_section::scoped_lock cursor{ m_cs };
+	if(m_position > 0) handle->Seek(m_position, LINUX_SEEK_SET);
+
 	// Place a weak reference to the handle into the tracking collection before returning it
 	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
 	if(!m_fs->m_handles.emplace(handle.get(), handle).second) throw LinuxException(LINUX_ENOMEM);
@@ -389,6 +1066,47 @@ std::shared_ptr<FileSystem::Handle> HostFileSystem::DirectoryHandle::Duplicate(v
 	return handle;
 }
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::DirectoryHandle::FillBuffer (private)
+//
+// Retrieves the next batch of directory entries from the host
+//
+// Arguments:
+//
+//	NONE
+
+bool HostFileSystem::DirectoryHandle::FillBuffer(void)
+{
+	IO_STATUS_BLOCK				iosb;			// Host I/O status block
+	FILE_STORAGE_INFO			storage;		// Storage information
+
+	// The enumeration buffer is not allocated until the directory is actually read
+	if(!m_buffer) m_buffer = std::make_unique<uint8_t[]>(DIRECTORY_BUFFER_SIZE);
+
+	// The directory path and block size are needed to generate node statistics
+	if(m_blksize == 0) {
+
+		if(!GetFileInformationByHandleEx(m_handle, FileStorageInfo, &storage, sizeof(FILE_STORAGE_INFO))) throw MapHostException(GetLastError());
+
+		m_path = static_cast<const wchar_t*>(HandleToPathW(m_handle));
+		if(m_path.empty() || (m_path.back() != L'\\')) m_path.push_back(L'\\');
+		m_blksize = storage.PhysicalBytesPerSectorForPerformance;
+	}
+
+	m_bufferlength = m_bufferoffset = 0;
+
+	// Retrieve as many entries as will fit into the buffer; the host maintains the cursor position
+	NTSTATUS result = NtApi::NtQueryDirectoryFile(m_handle, nullptr, nullptr, nullptr, &iosb, m_buffer.get(), DIRECTORY_BUFFER_SIZE, 
+		NtApi::FileIdBothDirectoryInformation, FALSE, nullptr, (m_restart) ? TRUE : FALSE);
+	m_restart = false;
+
+	if(result == NtApi::STATUS_NO_MORE_FILES) return false;
+	if(result != NtApi::STATUS_SUCCESS) throw MapHostException(RtlNtStatusToDosError(result));
+
+	m_bufferlength = static_cast<ULONG>(iosb.Information);
+	return (m_bufferlength > 0);
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::DirectoryHandle::getFlags
 //
@@ -437,6 +1155,90 @@ uapi::size_t HostFileSystem::DirectoryHandle::ReadAt(uapi::loff_t offset, void*
 	throw LinuxException(LINUX_EISDIR);
 }
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::DirectoryHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t HostFileSystem::DirectoryHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	char_t					name[(LINUX_NAME_MAX * 3) + 1];		// Converted entry name
+	uapi::size_t			written = 0;						// Bytes written to the buffer
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	while(true) {
+
+		// Retrieve the next batch of entries from the host once the buffered entries have been consumed
+		if((m_bufferoffset >= m_bufferlength) && !FillBuffer()) break;
+
+		auto entry = reinterpret_cast<NtApi::FILE_ID_BOTH_DIR_INFORMATION*>(&m_buffer[m_bufferoffset]);
+
+		// Convert the entry name into UTF-8 and determine the aligned length of the output record
+		int namelength = WideCharToMultiByte(CP_UTF8, 0, entry->FileName, entry->FileNameLength / sizeof(WCHAR), name, (sizeof(name) - 1), nullptr, nullptr);
+		if(namelength == 0) throw MapHostException(GetLastError());
+		name[namelength] = 0;
+
+		uapi::size_t reclen = align::up(offsetof(uapi::dirent64, d_name) + namelength + 1, 8);
+
+		// If the record doesn't fit, leave it buffered for the next call; EINVAL if nothing fit at all
+		if((written + reclen) > count) {
+
+			if(written == 0) throw LinuxException(LINUX_EINVAL);
+			break;
+		}
+
+		// Pack the entry directly into the caller's buffer
+		auto dirent = reinterpret_cast<uapi::dirent64*>(reinterpret_cast<uint8_t*>(buffer) + written);
+		memset(dirent, 0, reclen);
+		dirent->d_ino = static_cast<uint64_t>(entry->FileId.QuadPart);
+		dirent->d_off = ++m_position;
+		dirent->d_reclen = static_cast<uint16_t>(reclen);
+		dirent->d_type = DirectoryEntryType(entry->FileAttributes);
+		memcpy(dirent->d_name, name, namelength + 1);
+		written += reclen;
+
+		// Prime the statistics for the entry so that a subsequent stat() does not need to query the
+		// host; the hard link count is not available from the enumeration and will be reported as 1
+		if((entry->FileId.QuadPart != 0) && (dirent->d_type != LINUX_DT_UNKNOWN) && (strcmp(name, ".") != 0) && (strcmp(name, "..") != 0)) {
+
+			uapi::stat stats;
+			memset(&stats, 0, sizeof(uapi::stat));
+
+			bool directory = (dirent->d_type == LINUX_DT_DIR);
+
+			stats.st_ino		= static_cast<uint64_t>(entry->FileId.QuadPart);
+			stats.st_nlink		= (directory) ? 2 : 1;
+			stats.st_size		= (directory) ? 0 : entry->EndOfFile.QuadPart;
+			stats.st_blksize	= m_blksize;
+			stats.st_blocks		= (stats.st_size + 511) / 512;
+			stats.st_atime		= EntryTimeToTimespec(entry->LastAccessTime);
+			stats.st_mtime		= EntryTimeToTimespec(entry->LastWriteTime);
+			stats.st_ctime		= EntryTimeToTimespec(entry->CreationTime);
+
+			// Enumerated file identifiers are the 64-bit form of the 128-bit FILE_ID_INFO identifiers
+			nodeid_t id{ m_id.volume, FILE_ID_128{} };
+			memcpy(&id.fileid, &entry->FileId, sizeof(LARGE_INTEGER));
+
+			std::wstring path{ m_path };
+			path.append(entry->FileName, entry->FileNameLength / sizeof(WCHAR));
+
+			CacheStat(m_fs, id, std::move(path), stats, true);
+		}
+
+		m_bufferoffset = (entry->NextEntryOffset) ? m_bufferoffset + entry->NextEntryOffset : m_bufferlength;
+	}
+
+	return written;
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::DirectoryHandle::Seek
 //
@@ -449,10 +1251,33 @@ uapi::size_t HostFileSystem::DirectoryHandle::ReadAt(uapi::loff_t offset, void*
 
 uapi::loff_t HostFileSystem::DirectoryHandle::Seek(uapi::loff_t offset, int whence)
 {
-	UNREFERENCED_PARAMETER(offset);
-	UNREFERENCED_PARAMETER(whence);
+	sync::critical_section::scoped_lock critsec{ m_cs };
 
-	throw LinuxException(LINUX_EISDIR);
+	// SEEK_CUR can only be used to retrieve the current position
+	if(whence == LINUX_SEEK_CUR) {
+
+		if(offset != 0) throw LinuxException(LINUX_EINVAL);
+		return m_position;
+	}
+
+	if((whence != LINUX_SEEK_SET) || (offset < 0)) throw LinuxException(LINUX_EINVAL);
+
+	// Directory positions are entry ordinals; restart the host enumeration and skip
+	// over entries until the requested position has been reached
+	m_restart = true;
+	m_bufferlength = m_bufferoffset = 0;
+	m_position = 0;
+
+	while(m_position < offset) {
+
+		if((m_bufferoffset >= m_bufferlength) && !FillBuffer()) break;
+
+		auto entry = reinterpret_cast<NtApi::FILE_ID_BOTH_DIR_INFORMATION*>(&m_buffer[m_bufferoffset]);
+		m_bufferoffset = (entry->NextEntryOffset) ? m_bufferoffset + entry->NextEntryOffset : m_bufferlength;
+		++m_position;
+	}
+
+	return m_position;
 }
 
 //-----------------------------------------------------------------------------
@@ -550,6 +1375,9 @@ std::shared_ptr<FileSystem::Alias> HostFileSystem::DirectoryNode::CreateDirector
 	auto path = m_path.append(name);
 	if(!::CreateDirectoryW(path, nullptr)) throw MapHostException(GetLastError());
 
+	// Adding a child changes the modification time of this directory
+	InvalidateStat(m_fs, m_id);
+
 	// There is a possibility that the directory could be modified or deleted between
 	// the call to CreateDirectory() and opening the handle, remove it on exception
 	try { return std::make_shared<Alias>(m_fs, name, CreateDirectoryNode(m_fs, path)); }
@@ -579,7 +1407,12 @@ std::shared_ptr<FileSystem::Alias> HostFileSystem::DirectoryNode::CreateFile(std
 	(mode);
 
 	// Wrap a new FileNode instance into an Alias to return to the caller
-	return std::make_shared<Alias>(m_fs, name, CreateFileNode(m_fs, CREATE_NEW, m_path.append(name)));
+	auto alias = std::make_shared<Alias>(m_fs, name, CreateFileNode(m_fs, CREATE_NEW, m_path.append(name)));
+
+	// Adding a child changes the modification time of this directory
+	InvalidateStat(m_fs, m_id);
+
+	return alias;
 }
 
 //-----------------------------------------------------------------------------
@@ -592,7 +1425,7 @@ std::shared_ptr<FileSystem::Alias> HostFileSystem::DirectoryNode::CreateFile(std
 //	mount		- Mount on which this directory was reached
 //	name		- Name of the child alias to look up
 
-std::shared_ptr<FileSystem::Alias> HostFileSystem::DirectoryNode::Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const
+FileSystem::Result<std::shared_ptr<FileSystem::Alias>> HostFileSystem::DirectoryNode::Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const
 {
 	UNREFERENCED_PARAMETER(mount);
 
@@ -601,17 +1434,21 @@ std::shared_ptr<FileSystem::Alias> HostFileSystem::DirectoryNode::Lookup(std::sh
 	// Append the requested file system object name to the normalized directory path
 	auto path = m_path.append(name);
 	
+	// An active node at this path can be used without accessing the host
+	auto active = std::dynamic_pointer_cast<FileSystem::Node>(FindNode(m_fs, path));
+	if(active) return std::static_pointer_cast<FileSystem::Alias>(std::make_shared<Alias>(m_fs, name, active));
+
 	// Determine if the object exists and what kind of node needs to be created
 	DWORD attributes = GetFileAttributes(path);
-	if(attributes == INVALID_FILE_ATTRIBUTES) throw LinuxException(LINUX_ENOENT);
+	if(attributes == INVALID_FILE_ATTRIBUTES) return FileSystem::Error{ LINUX_ENOENT };
 
-	// Currently this will create a new node for every lookup and not use any cached node
-	// that may already represent the host file system object; this should be optimized
+	// Create or reuse the node that represents the host file system object; if the object is
+	// already active, the existing node (and native handle) will be returned
 	std::shared_ptr<FileSystem::Node> node;
 	if((attributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY) node = CreateDirectoryNode(m_fs, path);
 	else node = CreateFileNode(m_fs, OPEN_EXISTING, path);
 
-	return std::make_shared<Alias>(m_fs, name, node);
+	return std::static_pointer_cast<FileSystem::Alias>(std::make_shared<Alias>(m_fs, name, node));
 }
 
 //-----------------------------------------------------------------------------
@@ -627,7 +1464,6 @@ std::shared_ptr<FileSystem::Alias> HostFileSystem::DirectoryNode::Lookup(std::sh
 
 std::shared_ptr<FileSystem::Handle> HostFileSystem::DirectoryNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
 {
-	HANDLE								duplicate;		// Duplicated operating system handle
 	std::shared_ptr<DirectoryHandle>	handle;			// New DirectoryHandle object instance
 
 	UNREFERENCED_PARAMETER(mount);
@@ -639,12 +1475,14 @@ std::shared_ptr<FileSystem::Handle> HostFileSystem::DirectoryNode::Open(std::sha
 	// Check for flags that are incompatible with opening a directory file system object
 	if(flags & (FileSystem::HandleFlags::Append | FileSystem::HandleFlags::Direct)) throw LinuxException(LINUX_EINVAL);
 
-	// Duplicate the original query-only file system object handle (don't ask for FILE_GENERIC_READ on directories)
-	if(!DuplicateHandle(GetCurrentProcess(), m_handle, GetCurrentProcess(), &duplicate, 0, FALSE, DUPLICATE_SAME_ACCESS)) 
-		throw MapHostException(GetLastError());
+	// Reopen the query-only file system object handle with the access required to enumerate the directory contents; 
+	// this also provides the handle with its own file object and therefore its own host enumeration cursor
+	HANDLE duplicate = ReOpenFile(m_handle, FILE_LIST_DIRECTORY | FILE_READ_ATTRIBUTES | SYNCHRONIZE, FILE_SHARE_READ | FILE_SHARE_WRITE, 
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_POSIX_SEMANTICS);
+	if(duplicate == INVALID_HANDLE_VALUE) throw MapHostException(GetLastError());
 
 	// Create the DirectoryHandle that will own the native operating system handle
-	try { handle = std::make_shared<DirectoryHandle>(m_fs, duplicate, access, flags); }
+	try { handle = std::make_shared<DirectoryHandle>(m_fs, duplicate, m_id, access, flags); }
 	catch(...) { CloseHandle(duplicate); throw; }
 
 	// Place a weak reference to the handle into the tracking collection before returning it
@@ -706,6 +1544,9 @@ void HostFileSystem::DirectoryNode::Stat(uapi::stat* stats) const
 
 	if(stats == nullptr) throw LinuxException(LINUX_EFAULT, Exception(E_POINTER));
 
+	// Use the cached statistics for this node if they are available
+	if(LookupStat(m_fs, m_id, stats)) return;
+
 	// The bulk of the information needed is provided in BY_HANDLE_FILE_INFORMATION
 	if(!GetFileInformationByHandle(m_handle, &info)) throw MapHostException(GetLastError());
 	
@@ -726,6 +1567,8 @@ void HostFileSystem::DirectoryNode::Stat(uapi::stat* stats) const
 	stats->st_atime		= convert<uapi::timespec>(info.ftLastAccessTime);
 	stats->st_mtime		= convert<uapi::timespec>(info.ftLastWriteTime);
 	stats->st_ctime		= convert<uapi::timespec>(info.ftCreationTime);
+
+	CacheStat(m_fs, m_id, std::wstring{ NormalizedPath }, *stats, false);
 }
 
 //-----------------------------------------------------------------------------
@@ -742,6 +1585,25 @@ FileSystem::NodeType HostFileSystem::DirectoryNode::getType(void) const
 // HOSTFILESYSTEM::FILEHANDLE
 //
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileHandle Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	handle		- Native operating system handle
+//	id			- Host object identifier
+//	access		- Handle access mode
+//	flags		- Handle flags
+//	readcache	- Read-ahead buffer for the file node
+//	channel		- Overlapped I/O channel bound to the handle
+
+HostFileSystem::FileHandle::FileHandle(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id, FileSystem::HandleAccess access, 
+	FileSystem::HandleFlags flags, std::shared_ptr<ReadCache> readcache, std::unique_ptr<IoEngine::Channel> channel) : HandleBase(std::move(fs), 
+	handle, id, access, flags), m_readcache(std::move(readcache)), m_position(std::make_shared<filepos_t>()), m_channel(std::move(channel))
+{
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::FileHandle::getAccess
 //
@@ -752,6 +1614,100 @@ FileSystem::HandleAccess HostFileSystem::FileHandle::getAccess(void) const
 	return m_access;
 }
 		
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileHandle::CopyFrom
+//
+// Copies data from another handle by sharing the underlying host storage.  This is
+// only possible between two host files on the same ReFS volume and only for whole
+// clusters; EXDEV is returned in all other cases so that the caller can fall back
+// to copying the data through a buffer
+//
+// Arguments:
+//
+//	source			- Source handle
+//	sourceoffset	- Offset within the source file to begin copying
+//	offset			- Offset within this file to begin writing
+//	count			- Maximum number of bytes to copy
+
+FileSystem::Result<uapi::size_t> HostFileSystem::FileHandle::CopyFrom(std::shared_ptr<FileSystem::Handle> source, uapi::loff_t sourceoffset, 
+	uapi::loff_t offset, uapi::size_t count)
+{
+	FSCTL_GET_INTEGRITY_INFORMATION_BUFFER	integrity;			// Integrity information (cluster size)
+	LARGE_INTEGER							sourcesize;			// Length of the source file
+	LARGE_INTEGER							size;				// Length of this file
+
+	// Attempting to write to a read-only handle yields EINVAL, not EACCES
+	if(m_access == FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EINVAL);
+
+	// Attempting to write to a read-only file system yields EROFS, not EACCES
+	if(m_fs->m_flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	if((sourceoffset < 0) || (offset < 0)) throw LinuxException(LINUX_EINVAL);
+
+	// O_APPEND handles do not have FILE_WRITE_DATA access, which is required to clone into the file
+	if(m_flags & FileSystem::HandleFlags::Append) return FileSystem::Error{ LINUX_EXDEV };
+
+	// The source must be another host file on the same volume, and cannot be this file
+	auto hostsource = std::dynamic_pointer_cast<FileHandle>(source);
+	if((!hostsource) || (hostsource->m_id.volume != m_id.volume) || (hostsource->m_id == m_id)) return FileSystem::Error{ LINUX_EXDEV };
+
+	// Only ReFS supports block cloning and it is also the only file system that reports integrity 
+	// information, which provides the cluster size that the cloned ranges must be aligned to
+	try { m_channel->Control(FSCTL_GET_INTEGRITY_INFORMATION, nullptr, 0, &integrity, sizeof(FSCTL_GET_INTEGRITY_INFORMATION_BUFFER)); }
+	catch(Win32Exception&) { return FileSystem::Error{ LINUX_EXDEV }; }
+
+	uapi::loff_t cluster = static_cast<uapi::loff_t>(integrity.ClusterSizeInBytes);
+	if((cluster == 0) || (sourceoffset % cluster) || (offset % cluster)) return FileSystem::Error{ LINUX_EXDEV };
+
+	if(!GetFileSizeEx(hostsource->m_handle, &sourcesize)) throw MapHostException(GetLastError());
+	if(sourceoffset >= sourcesize.QuadPart) return static_cast<uapi::size_t>(0);
+
+	// Only whole clusters can be cloned, any remaining partial cluster is left for the caller to copy
+	uapi::loff_t length = std::min(static_cast<uapi::loff_t>(count), sourcesize.QuadPart - sourceoffset);
+	length -= (length % cluster);
+	if(length == 0) return FileSystem::Error{ LINUX_EXDEV };
+
+	// The target range has to be within the bounds of this file before extents can be cloned into it
+	if(!GetFileSizeEx(m_handle, &size)) throw MapHostException(GetLastError());
+
+	bool extended = (offset + length > size.QuadPart);
+	if(extended) {
+
+		FILE_END_OF_FILE_INFO eof;
+		eof.EndOfFile.QuadPart = offset + length;
+		if(!SetFileInformationByHandle(m_handle, FileEndOfFileInfo, &eof, sizeof(FILE_END_OF_FILE_INFO))) throw MapHostException(GetLastError());
+	}
+
+	DUPLICATE_EXTENTS_DATA extents;
+	extents.FileHandle = hostsource->m_handle;
+	extents.SourceFileOffset.QuadPart = sourceoffset;
+	extents.TargetFileOffset.QuadPart = offset;
+	extents.ByteCount.QuadPart = length;
+
+	try { m_channel->Control(FSCTL_DUPLICATE_EXTENTS_TO_FILE, &extents, sizeof(DUPLICATE_EXTENTS_DATA), nullptr, 0); }
+	catch(Win32Exception&) {
+
+		// Restore the original length of this file and let the caller copy the data instead
+		if(extended) {
+
+			FILE_END_OF_FILE_INFO eof;
+			eof.EndOfFile.QuadPart = size.QuadPart;
+			SetFileInformationByHandle(m_handle, FileEndOfFileInfo, &eof, sizeof(FILE_END_OF_FILE_INFO));
+		}
+
+		return FileSystem::Error{ LINUX_EXDEV };
+	}
+
+	// Writing to the file changes its contents, size and modification time
+	m_readcache->Invalidate();
+	InvalidateStat(m_fs, m_id);
+
+	// MS_SYNCHRONOUS can be set on the mount to imply O_SYNC for all handles
+	if((m_fs->m_flags & LINUX_MS_SYNCHRONOUS) || (m_flags & FileSystem::HandleFlags::Sync)) FlushFileBuffers(m_handle);
+
+	return static_cast<uapi::size_t>(length);
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::FileHandle::Duplicate
 //
@@ -766,14 +1722,25 @@ std::shared_ptr<FileSystem::Handle> HostFileSystem::FileHandle::Duplicate(void)
 	HANDLE								duplicate;		// Duplicated operating system handle
 	std::shared_ptr<FileHandle>			handle;			// New FileHandle object instance
 
-	// Duplicate the existing operating system handle with the same access
-	if(!DuplicateHandle(GetCurrentProcess(), m_handle, GetCurrentProcess(), &duplicate, 0, FALSE, DUPLICATE_SAME_ACCESS))
-		throw MapHostException(GetLastError());
+	// O_APPEND handles do not have FILE_WRITE_DATA access, the host will always write to the end of the file
+	DWORD hostaccess = HandleAccessToHostAccess(m_access);
+	if(m_flags & FileSystem::HandleFlags::Append) hostaccess &= ~FILE_WRITE_DATA;
+
+	DWORD attributes = FILE_FLAG_POSIX_SEMANTICS | FILE_FLAG_OVERLAPPED;
+	if(m_flags & FileSystem::HandleFlags::Sync) attributes |= FILE_FLAG_WRITE_THROUGH;
+
+	// A file object can only be bound to a single completion port, so rather than duplicating the
+	// operating system handle a new file object has to be opened with the same access and attributes
+	duplicate = ReOpenFile(m_handle, hostaccess, FILE_SHARE_READ | FILE_SHARE_WRITE, attributes);
+	if(duplicate == INVALID_HANDLE_VALUE) throw MapHostException(GetLastError());
 
 	// Create the FileHandle that will own the native operating system handle
-	try { handle = std::make_shared<FileHandle>(m_fs, duplicate, m_access, m_flags); }
+	try { handle = std::make_shared<FileHandle>(m_fs, duplicate, m_id, m_access, m_flags, m_readcache, IoEngine::Bind(m_fs->m_ioengine, duplicate)); }
 	catch(...) { CloseHandle(duplicate); throw; }
 
+	// The duplicate handle shares the file position with this handle
+	handle->m_position = m_position;
+
 	// Place a weak reference to the handle into the tracking collection before returning it
 	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
 	if(!m_fs->m_handles.emplace(handle.get(), handle).second) throw LinuxException(LINUX_ENOMEM);
@@ -808,11 +1775,14 @@ uapi::size_t HostFileSystem::FileHandle::Read(void* buffer, uapi::size_t count)
 	// ReadFile() can only read up to MAXDWORD bytes from the underlying file
 	if(count >= MAXDWORD) throw LinuxException(LINUX_EINVAL);
 
-	// Attempt to read the specified number of bytes from the file into the buffer
-	DWORD read = static_cast<DWORD>(count);
-	if(!ReadFile(m_handle, buffer, read, &read, nullptr)) throw MapHostException(GetLastError());
+	// The file position is maintained here rather than by the host so that the read can be
+	// satisfied from the node read-ahead buffer without querying or adjusting the host position
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
 
-	return static_cast<uapi::size_t>(read);
+	uapi::size_t read = m_readcache->Read(*m_channel, m_position->readahead, m_position->offset, buffer, count);
+	m_position->offset += read;
+
+	return read;
 }
 
 //-----------------------------------------------------------------------------
@@ -833,16 +1803,88 @@ uapi::size_t HostFileSystem::FileHandle::ReadAt(uapi::loff_t offset, void* buffe
 	// ReadFile() can only read up to MAXDWORD bytes from the underlying file
 	if(count >= MAXDWORD) throw LinuxException(LINUX_EINVAL);
 
-	// OVERLAPPED structure can be used to read from a specific position
-	OVERLAPPED overlapped = { 0 };
-	overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
-	overlapped.OffsetHigh = (offset >> 32);
+	if(offset < 0) throw LinuxException(LINUX_EINVAL);
+
+	return m_readcache->Read(*m_channel, m_position->readahead, offset, buffer, count);
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileHandle::ReadAtV
+//
+// Synchronously reads data from the underlying node into an array of buffers.  The
+// entire array is satisfied with a single read so that only one host call is made
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	iov			- Array of destination buffers
+//	iovcnt		- Number of destination buffers in the array
+
+uapi::size_t HostFileSystem::FileHandle::ReadAtV(uapi::loff_t offset, const uapi::iovec* iov, int iovcnt)
+{
+	void*				contiguous;			// Address of adjacent buffers
+
+	uapi::size_t count = IoVectorLength(iov, iovcnt, &contiguous);
+	if(count == 0) return 0;
+
+	// Buffers that are adjacent in memory can be read into directly
+	if(contiguous) return ReadAt(offset, contiguous, count);
+
+	// ReadFileScatter() requires unbuffered I/O and page-sized buffers, use an intermediate buffer instead
+	HeapBuffer<uint8_t> buffer(count);
+
+	uapi::size_t read = ReadAt(offset, buffer, count);
+	ScatterIoVector(buffer, read, iov, iovcnt);
+
+	return read;
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t HostFileSystem::FileHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ENOTDIR);
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileHandle::ReadV
+//
+// Synchronously reads data from the underlying node into an array of buffers.  The
+// entire array is satisfied with a single read so that only one host call is made
+//
+// Arguments:
+//
+//	iov			- Array of destination buffers
+//	iovcnt		- Number of destination buffers in the array
+
+uapi::size_t HostFileSystem::FileHandle::ReadV(const uapi::iovec* iov, int iovcnt)
+{
+	void*				contiguous;			// Address of adjacent buffers
+
+	uapi::size_t count = IoVectorLength(iov, iovcnt, &contiguous);
+	if(count == 0) return 0;
+
+	// Buffers that are adjacent in memory can be read into directly
+	if(contiguous) return Read(contiguous, count);
 
-	// Attempt to read the specified number of bytes from the file into the buffer
-	DWORD read = static_cast<DWORD>(count);
-	if(!ReadFile(m_handle, buffer, read, &read, &overlapped)) throw MapHostException(GetLastError());
+	// ReadFileScatter() requires unbuffered I/O and page-sized buffers, use an intermediate buffer instead
+	HeapBuffer<uint8_t> buffer(count);
 
-	return static_cast<uapi::size_t>(read);
+	uapi::size_t read = Read(buffer, count);
+	ScatterIoVector(buffer, read, iov, iovcnt);
+
+	return read;
 }
 
 //-----------------------------------------------------------------------------
@@ -857,14 +1899,27 @@ uapi::size_t HostFileSystem::FileHandle::ReadAt(uapi::loff_t offset, void* buffe
 
 uapi::loff_t HostFileSystem::FileHandle::Seek(uapi::loff_t offset, int whence)
 {
-	LARGE_INTEGER			position;			// Distance to be moved
+	LARGE_INTEGER			size;				// Host file size
+	uapi::loff_t			position;			// New file position
+
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
 
-	// This is a straightforward operation provided the values for whence mean the same
-	// things, which is checked as an invariant at the top of this file
-	position.QuadPart = offset;
-	if(!SetFilePointerEx(m_handle, position, &position, whence)) throw MapHostException(GetLastError());
+	switch(whence) {
 
-	return position.QuadPart;
+		case LINUX_SEEK_SET: position = offset; break;
+		case LINUX_SEEK_CUR: position = m_position->offset + offset; break;
+
+		case LINUX_SEEK_END:
+			if(!GetFileSizeEx(m_handle, &size)) throw MapHostException(GetLastError());
+			position = size.QuadPart + offset;
+			break;
+
+		default: throw LinuxException(LINUX_EINVAL);
+	}
+
+	if(position < 0) throw LinuxException(LINUX_EINVAL);
+
+	return (m_position->offset = position);
 }
 
 //-----------------------------------------------------------------------------
@@ -922,9 +1977,29 @@ uapi::size_t HostFileSystem::FileHandle::Write(const void* buffer, uapi::size_t
 	// WriteFile() can only write up to MAXDWORD bytes into the target file
 	if(count >= MAXDWORD) throw LinuxException(LINUX_EINVAL);
 
-	// Attempt to write the specified number of bytes from the buffer into the file
-	DWORD written = static_cast<DWORD>(count);
-	if(!WriteFile(m_handle, buffer, written, &written, nullptr)) throw MapHostException(GetLastError());
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	DWORD written = 0;
+
+	// O_APPEND handles do not have FILE_WRITE_DATA access, the host will always write to the end of the file
+	if(m_flags & FileSystem::HandleFlags::Append) {
+
+		LARGE_INTEGER size;
+		written = WriteHostFile(*m_channel, IoEngine::Channel::EndOfFile, buffer, static_cast<DWORD>(count));
+		if(!GetFileSizeEx(m_handle, &size)) throw MapHostException(GetLastError());
+
+		m_position->offset = size.QuadPart;
+	}
+
+	else {
+
+		written = WriteHostFile(*m_channel, m_position->offset, buffer, static_cast<DWORD>(count));
+		m_position->offset += written;
+	}
+
+	// Writing to the file changes its contents, size and modification time
+	m_readcache->Invalidate();
+	InvalidateStat(m_fs, m_id);
 
 	// MS_SYNCHRONOUS can be set on the mount to imply O_SYNC for all handles
 	if((m_fs->m_flags & LINUX_MS_SYNCHRONOUS) || (m_flags & FileSystem::HandleFlags::Sync)) FlushFileBuffers(m_handle);
@@ -959,14 +2034,14 @@ uapi::size_t HostFileSystem::FileHandle::WriteAt(uapi::loff_t offset, const void
 	// WriteFile() can only write up to MAXDWORD bytes to the underlying file
 	if(count >= MAXDWORD) throw LinuxException(LINUX_EINVAL);
 
-	// OVERLAPPED structure can be used to write to a specific position
-	OVERLAPPED overlapped = { 0 };
-	overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
-	overlapped.OffsetHigh = (offset >> 32);
+	if(offset < 0) throw LinuxException(LINUX_EINVAL);
 
 	// Attempt to write the specified number of bytes from the buffer into the file
-	DWORD written = static_cast<DWORD>(count);
-	if(!WriteFile(m_handle, buffer, written, &written, &overlapped)) throw MapHostException(GetLastError());
+	DWORD written = WriteHostFile(*m_channel, offset, buffer, static_cast<DWORD>(count));
+
+	// Writing to the file changes its contents, size and modification time
+	m_readcache->Invalidate();
+	InvalidateStat(m_fs, m_id);
 
 	// MS_SYNCHRONOUS can be set on the mount to imply O_SYNC for all handles.
 	if((m_fs->m_flags & LINUX_MS_SYNCHRONOUS) || (m_flags & FileSystem::HandleFlags::Sync)) FlushFileBuffers(m_handle);
@@ -974,10 +2049,96 @@ uapi::size_t HostFileSystem::FileHandle::WriteAt(uapi::loff_t offset, const void
 	return static_cast<uapi::size_t>(written);
 }
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileHandle::WriteAtV
+//
+// Synchronously writes data from an array of buffers to the underlying node.  The
+// entire array is written with a single write so that only one host call is made
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	iov			- Array of source buffers
+//	iovcnt		- Number of source buffers in the array
+
+uapi::size_t HostFileSystem::FileHandle::WriteAtV(uapi::loff_t offset, const uapi::iovec* iov, int iovcnt)
+{
+	void*				contiguous;			// Address of adjacent buffers
+
+	uapi::size_t count = IoVectorLength(iov, iovcnt, &contiguous);
+	if(count == 0) return 0;
+
+	// Buffers that are adjacent in memory can be written directly
+	if(contiguous) return WriteAt(offset, contiguous, count);
+
+	// WriteFileGather() requires unbuffered I/O and page-sized buffers, use an intermediate buffer instead
+	HeapBuffer<uint8_t> buffer(count);
+	GatherIoVector(iov, iovcnt, buffer);
+
+	return WriteAt(offset, buffer, count);
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileHandle::WriteV
+//
+// Synchronously writes data from an array of buffers to the underlying node.  The
+// entire array is written with a single write so that only one host call is made and
+// the data cannot be interleaved with that of another O_APPEND writer
+//
+// Arguments:
+//
+//	iov			- Array of source buffers
+//	iovcnt		- Number of source buffers in the array
+
+uapi::size_t HostFileSystem::FileHandle::WriteV(const uapi::iovec* iov, int iovcnt)
+{
+	void*				contiguous;			// Address of adjacent buffers
+
+	uapi::size_t count = IoVectorLength(iov, iovcnt, &contiguous);
+	if(count == 0) return 0;
+
+	// Buffers that are adjacent in memory can be written directly
+	if(contiguous) return Write(contiguous, count);
+
+	// WriteFileGather() requires unbuffered I/O and page-sized buffers, use an intermediate buffer instead
+	HeapBuffer<uint8_t> buffer(count);
+	GatherIoVector(iov, iovcnt, buffer);
+
+	return Write(buffer, count);
+}
+
 //
 // HOSTFILESYSTEM::FILENODE
 //
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileNode Constructor
+//
+// Arguments:
+//
+//	fs				- Parent file system instance
+//	handle			- Native operating system handle
+//	id				- Host object identifier
+
+HostFileSystem::FileNode::FileNode(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id) 
+	: NodeBase(std::move(fs), handle, id), m_readcache(std::make_shared<ReadCache>())
+{
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::FileNode::InvalidateCache
+//
+// Discards any file data buffered for this node
+//
+// Arguments:
+//
+//	NONE
+
+void HostFileSystem::FileNode::InvalidateCache(void)
+{
+	m_readcache->Invalidate();
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::FileNode::Open
 //
@@ -1006,7 +2167,7 @@ std::shared_ptr<FileSystem::Handle> HostFileSystem::FileNode::Open(std::shared_p
 	DWORD hostaccess = HandleAccessToHostAccess(access);
 
 	// Generate the native attributes for the operation based on the provided flags
-	DWORD attributes = FILE_FLAG_POSIX_SEMANTICS;
+	DWORD attributes = FILE_FLAG_POSIX_SEMANTICS | FILE_FLAG_OVERLAPPED;
 	if(flags & FileSystem::HandleFlags::Sync) attributes |= FILE_FLAG_WRITE_THROUGH;
 
 	// Reopen the native file handle with the requested attributes
@@ -1014,7 +2175,12 @@ std::shared_ptr<FileSystem::Handle> HostFileSystem::FileNode::Open(std::shared_p
 	if(duplicate == INVALID_HANDLE_VALUE) throw MapHostException(GetLastError());
 
 	// It's not possible to handle O_TRUNC as part of the ReOpenFile request, do it afterwards (should be fine)
-	if((flags & FileSystem::HandleFlags::Truncate) && (access != FileSystem::HandleAccess::ReadOnly)) SetEndOfFile(duplicate);
+	if((flags & FileSystem::HandleFlags::Truncate) && (access != FileSystem::HandleAccess::ReadOnly)) {
+
+		SetEndOfFile(duplicate);
+		m_readcache->Invalidate();
+		InvalidateStat(m_fs, m_id);
+	}
 
 	// O_APPEND requires that FILE_WRITE_DATA be removed from the access mask; this can't be done in the access mask
 	// provided to ReOpenFile() above since FILE_WRITE_DATA might have been needed for handling O_TRUNC
@@ -1027,7 +2193,7 @@ std::shared_ptr<FileSystem::Handle> HostFileSystem::FileNode::Open(std::shared_p
 	}
 
 	// Create the FileHandle that will own the native operating system handle
-	try { handle = std::make_shared<FileHandle>(m_fs, duplicate, access, flags); }
+	try { handle = std::make_shared<FileHandle>(m_fs, duplicate, m_id, access, flags, m_readcache, IoEngine::Bind(m_fs->m_ioengine, duplicate)); }
 	catch(...) { CloseHandle(duplicate); throw; }
 
 	// Place a weak reference to the handle into the tracking collection before returning it
@@ -1057,11 +2223,13 @@ std::shared_ptr<FileSystem::Handle> HostFileSystem::FileNode::OpenExec(std::shar
 	if(mount->Flags & LINUX_MS_NOEXEC) throw LinuxException(LINUX_ENOEXEC);
 
 	// Reopen the native file handle with EXECUTE and READ access to the file
-	HANDLE duplicate = ReOpenFile(m_handle, FILE_GENERIC_EXECUTE | FILE_GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, FILE_FLAG_POSIX_SEMANTICS);
+	HANDLE duplicate = ReOpenFile(m_handle, FILE_GENERIC_EXECUTE | FILE_GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 
+		FILE_FLAG_POSIX_SEMANTICS | FILE_FLAG_OVERLAPPED);
 	if(duplicate == INVALID_HANDLE_VALUE) throw MapHostException(GetLastError());
 
 	// Create the FileHandle that will own the native operating system handle
-	try { handle = std::make_shared<FileHandle>(m_fs, duplicate, FileSystem::HandleAccess::ReadOnly, FileSystem::HandleFlags::None); }
+	try { handle = std::make_shared<FileHandle>(m_fs, duplicate, m_id, FileSystem::HandleAccess::ReadOnly, FileSystem::HandleFlags::None, m_readcache, 
+		IoEngine::Bind(m_fs->m_ioengine, duplicate)); }
 	catch(...) { CloseHandle(duplicate); throw; }
 
 	// Place a weak reference to the handle into the tracking collection before returning it
@@ -1123,6 +2291,9 @@ void HostFileSystem::FileNode::Stat(uapi::stat* stats) const
 
 	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
 
+	// Use the cached statistics for this node if they are available
+	if(LookupStat(m_fs, m_id, stats)) return;
+
 	// The bulk of the information needed is provided in BY_HANDLE_FILE_INFORMATION
 	if(!GetFileInformationByHandle(m_handle, &info)) throw MapHostException(GetLastError());
 
@@ -1145,6 +2316,8 @@ void HostFileSystem::FileNode::Stat(uapi::stat* stats) const
 	stats->st_atime		= convert<uapi::timespec>(info.ftLastAccessTime);
 	stats->st_mtime		= convert<uapi::timespec>(info.ftLastWriteTime);
 	stats->st_ctime		= convert<uapi::timespec>(info.ftCreationTime);
+
+	CacheStat(m_fs, m_id, std::wstring{ NormalizedPath }, *stats, false);
 }
 
 //-----------------------------------------------------------------------------
@@ -1168,11 +2341,12 @@ FileSystem::NodeType HostFileSystem::FileNode::getType(void) const
 //
 //	fs			- Parent file system instance
 //	handle		- Native operating system handle
+//	id			- Host object identifier
 //	access		- Handle access mode
 //	flags		- Handle flags
 
-HostFileSystem::HandleBase::HandleBase(std::shared_ptr<HostFileSystem> fs, HANDLE handle, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) 
-	: m_fs(std::move(fs)), m_handle(handle), m_access(access), m_flags(flags)
+HostFileSystem::HandleBase::HandleBase(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) 
+	: m_fs(std::move(fs)), m_handle(handle), m_id(id), m_access(access), m_flags(flags)
 {
 	if((handle == nullptr) || (handle == INVALID_HANDLE_VALUE)) throw Win32Exception(ERROR_INVALID_HANDLE);
 }
@@ -1385,9 +2559,10 @@ void HostFileSystem::Mount::Unmount(void)
 //
 //	fs				- Parent file system instance
 //	handle			- Native operating system handle
+//	id				- Host object identifier
 
-HostFileSystem::NodeBase::NodeBase(std::shared_ptr<HostFileSystem> fs, HANDLE handle) 
-	: m_fs(std::move(fs)), m_handle(handle), m_path(HandleToPathW(handle))
+HostFileSystem::NodeBase::NodeBase(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id) 
+	: m_fs(std::move(fs)), m_handle(handle), m_id(id), m_path(HandleToPathW(handle)), m_watched(false)
 {
 }
 
@@ -1396,9 +2571,27 @@ HostFileSystem::NodeBase::NodeBase(std::shared_ptr<HostFileSystem> fs, HANDLE ha
 
 HostFileSystem::NodeBase::~NodeBase() 
 {
-	// Remove this node instance from the file system's tracking collection
+	// Remove this node instance from the file system's tracking collection, provided
+	// that the entry hasn't been taken over by a newer node for the same object
 	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
-	m_fs->m_nodes.erase(this);
+	auto found = m_fs->m_nodes.find(m_id);
+	if((found != m_fs->m_nodes.end()) && (found->second.node == this)) m_fs->m_nodes.erase(found);
+
+	std::wstring path{ static_cast<const wchar_t*>(m_path) };
+	FoldPath(path);
+
+	// Remove the path from the node index if it still refers to this host object and there
+	// is no longer an active node for it (a newer node may have taken over the entry)
+	auto indexed = m_fs->m_nodepaths.find(path);
+	if((indexed != m_fs->m_nodepaths.end()) && (indexed->second == m_id) && (m_fs->m_nodes.find(m_id) == m_fs->m_nodes.end())) 
+		m_fs->m_nodepaths.erase(indexed);
+
+	// Remove the path from the watch index if it still refers to this host object
+	if(m_watched) {
+
+		auto watched = m_fs->m_watchpaths.find(path);
+		if((watched != m_fs->m_watchpaths.end()) && (watched->second == m_id)) m_fs->m_watchpaths.erase(watched);
+	}
 
 	// Close the operating system handle
 	CloseHandle(m_handle);
@@ -1414,6 +2607,16 @@ HANDLE HostFileSystem::NodeBase::getHandle(void) const
 	return m_handle;
 }
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::NodeBase::getId
+//
+// Gets the host file system object identifier
+
+HostFileSystem::nodeid_t const& HostFileSystem::NodeBase::getId(void) const
+{
+	return m_id;
+}
+
 //-----------------------------------------------------------------------------
 // HostFileSystem::NodeBase::getNormalizedPath
 //
@@ -1424,6 +2627,192 @@ const wchar_t* HostFileSystem::NodeBase::getNormalizedPath(void) const
 	return m_path;
 }
 
+//-----------------------------------------------------------------------------
+// HostFileSystem::NodeBase::Notify
+//
+// Notifies the registered watchers that this node or a child has changed
+//
+// Arguments:
+//
+//	mask		- IN_xxx events that occurred
+//	cookie		- Cookie that relates IN_MOVED_FROM and IN_MOVED_TO events
+//	name		- Name of the child that changed, or nullptr for the node itself
+
+void HostFileSystem::NodeBase::Notify(uint32_t mask, uint32_t cookie, const char_t* name)
+{
+	m_notify.Notify(mask, cookie, name);
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::NodeBase::Unwatch
+//
+// Removes a previously registered watcher
+//
+// Arguments:
+//
+//	watcher		- Watcher to be removed
+
+void HostFileSystem::NodeBase::Unwatch(const FileSystem::NotifyWatcher* watcher)
+{
+	// The path is left in the watch index until the node is destroyed
+	m_notify.Unwatch(watcher);
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::NodeBase::Watch
+//
+// Registers a watcher to be notified when the node or a child of the node changes
+//
+// Arguments:
+//
+//	watcher		- Watcher to be registered
+
+void HostFileSystem::NodeBase::Watch(std::shared_ptr<FileSystem::NotifyWatcher> watcher)
+{
+	m_notify.Watch(std::move(watcher));
+
+	// Host change notifications only provide paths; index this node so that they can find it
+	std::wstring path{ static_cast<const wchar_t*>(m_path) };
+	FoldPath(path);
+
+	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
+	m_fs->m_watchpaths[std::move(path)] = m_id;
+	m_watched = true;
+}
+
+//
+// HOSTFILESYSTEM::READCACHE
+//
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::ReadCache Constructor
+
+HostFileSystem::ReadCache::ReadCache() : m_capacity(0), m_base(0), m_length(0), m_generation(0), m_sparecapacity(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::ReadCache::Invalidate
+//
+// Discards any buffered data
+//
+// Arguments:
+//
+//	NONE
+
+void HostFileSystem::ReadCache::Invalidate(void)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// The buffer itself is retained for reuse by the next read-ahead operation, any
+	// fill that is in progress will see the new generation and discard its data
+	++m_generation;
+	m_length = 0;
+}
+
+//-----------------------------------------------------------------------------
+// HostFileSystem::ReadCache::Read
+//
+// Reads data from the node, serving it from the read-ahead buffer when possible
+//
+// Arguments:
+//
+//	channel		- Host file I/O channel to read from
+//	readahead	- Read-ahead state of the file description
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t HostFileSystem::ReadCache::Read(IoEngine::Channel& channel, readahead_t& readahead, uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	uint8_t*					dest = reinterpret_cast<uint8_t*>(buffer);		// Destination pointer
+	uapi::size_t				total = 0;										// Total bytes read
+	std::unique_ptr<uint8_t[]>	fill;											// Buffer to be filled
+	size_t						fillcapacity = 0;								// Fill buffer capacity
+	size_t						window;											// Read-ahead window size
+	uint64_t					generation;										// Generation before the fill
+
+	_ASSERTE(count < MAXDWORD);
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		// A read that begins where the previous one ended or within the buffered data is sequential and 
+		// grows the read-ahead window; anything else collapses the window and bypasses the buffer
+		bool sequential = (offset == readahead.next) || ((offset >= m_base) && (offset < static_cast<uapi::loff_t>(m_base + m_length)));
+		readahead.window = (sequential) ? std::min(std::max(readahead.window * 2, READAHEAD_MINIMUM), READAHEAD_MAXIMUM) : 0;
+		readahead.next = offset + count;
+
+		window = readahead.window;
+		generation = m_generation;
+
+		// Copy whatever portion of the request is present in the buffer
+		if((offset >= m_base) && (offset < static_cast<uapi::loff_t>(m_base + m_length))) {
+
+			size_t copy = std::min(static_cast<size_t>((m_base + m_length) - offset), count);
+			memcpy(dest, &m_buffer[static_cast<size_t>(offset - m_base)], copy);
+
+			dest += copy;
+			offset += copy;
+			count -= copy;
+			total += copy;
+		}
+
+		if(count == 0) return total;
+
+		// Requests that are not sequential or are at least as large as the window are not buffered
+		if((window == 0) || (count >= window)) window = 0;
+
+		// Take the spare buffer for the fill if it is large enough
+		else if(m_sparecapacity >= window) {
+
+			fill = std::move(m_spare);
+			fillcapacity = m_sparecapacity;
+			m_sparecapacity = 0;
+		}
+	}
+
+	// Read an unbuffered request directly into the destination buffer
+	if(window == 0) return total + ReadHostFile(channel, offset, dest, static_cast<DWORD>(count));
+
+	// Fill a buffer with the next window of data from the node without the lock held, the
+	// request is smaller than the window so it's satisfied by this one read unless at the end
+	if(!fill) {
+
+		fill = std::make_unique<uint8_t[]>(window);
+		fillcapacity = window;
+	}
+
+	size_t length = ReadHostFile(channel, offset, fill.get(), static_cast<DWORD>(window));
+
+	size_t copy = std::min(length, count);
+	memcpy(dest, fill.get(), copy);
+	total += copy;
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		// Data read before an Invalidate may predate a write and is not retained
+		if((length > 0) && (m_generation == generation)) {
+
+			std::swap(m_buffer, fill);
+			std::swap(m_capacity, fillcapacity);
+			m_base = offset;
+			m_length = length;
+		}
+
+		// Keep the larger of the replaced buffer and the current spare for the next fill
+		if(fillcapacity > m_sparecapacity) {
+
+			std::swap(m_spare, fill);
+			std::swap(m_sparecapacity, fillcapacity);
+		}
+	}
+
+	// Any buffer left in fill is released here, outside of the lock
+	return total;
+}
+
 //-----------------------------------------------------------------------------
 
 #pragma warning(pop)
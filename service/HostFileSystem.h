@@ -27,7 +27,10 @@
 #include <atomic>
 #include <memory>
 #include <unordered_map>
+#include "DirectoryWatcher.h"
 #include "FileSystem.h"
+#include "IoEngine.h"
+#include "NotifyQueue.h"
 
 #pragma warning(push, 4)
 
@@ -48,6 +51,8 @@
 //	MS_SYNCHRONOUS
 //
 //	[no]sandbox		- Controls sandboxing of the virtual file system (see below)
+//	actimeo=n		- Expires cached node attributes after n seconds (see below)
+//	noac			- Disables caching of node attributes
 //	
 // Supported remount options:
 //
@@ -61,6 +66,16 @@
 //	of the specified mount point.  Consider the ramifications of a symbolic link or junction point
 //	that redirects into a place that the user didn't expect it to, like C:\Windows\System32.
 //
+//	- Node attributes are cached and invalidated by writes made through the virtual machine
+//	and by a ReadDirectoryChangesW watcher on the mounted directory tree.  If the watcher cannot
+//	be started (some network redirectors) attributes are not cached unless 'actimeo' is set, in
+//	which case they are also expired after the specified number of seconds.  Use 'actimeo' for
+//	trees that are modified outside of the virtual machine in ways the watcher will not see.
+//
+//	- File handles are opened for overlapped I/O and bound to the virtual machine IoEngine, which
+//	dispatches completions from the thread pool.  Read and write operations made through the
+//	FileSystem::Handle interface still block the calling thread until the host has completed them.
+//
 //	- O_DIRECT: Windows provides the ability to bypass caching like this (FILE_FLAG_NO_BUFFERING), 
 //	but all I/O is done in the address space of the RPC server not the address space of the client 
 //	application.  Any memory alignment requirements would apply to the RPC server and become 
@@ -93,7 +108,7 @@ public:
 
 	// Instance Constructor
 	//
-	HostFileSystem(const char_t* source, uint32_t flags);
+	HostFileSystem(std::shared_ptr<IoEngine> ioengine, const char_t* source, uint32_t flags);
 
 	// Destructor
 	//
@@ -105,7 +120,22 @@ public:
 	// Mount (static)
 	//
 	// Creates an instance of the file system
-	static std::shared_ptr<FileSystem::Mount> Mount(const char_t* source, uint32_t flags, const void* data, size_t datalength);
+	static std::shared_ptr<FileSystem::Mount> Mount(std::shared_ptr<IoEngine> ioengine, const char_t* source, uint32_t flags, const void* data, size_t datalength);
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// StatCacheHits
+	//
+	// Gets the number of node attribute requests satisfied by the cache
+	__declspec(property(get=getStatCacheHits)) uint64_t StatCacheHits;
+	uint64_t getStatCacheHits(void) const;
+
+	// StatCacheMisses
+	//
+	// Gets the number of node attribute requests that required a host query
+	__declspec(property(get=getStatCacheMisses)) uint64_t StatCacheMisses;
+	uint64_t getStatCacheMisses(void) const;
 
 private:
 
@@ -116,17 +146,93 @@ private:
 	//
 	class HandleBase;
 	class NodeBase;
+	class ReadCache;
+
+	// readahead_t
+	//
+	// Sequential access detection state for a file description, this is
+	// accessed only with the lock of the node ReadCache held
+	struct readahead_t
+	{
+		uapi::loff_t				next = 0;		// Offset of the next sequential read
+		size_t						window = 0;		// Current read-ahead window size
+	};
+
+	// filepos_t
+	//
+	// File position shared among duplicated FileHandle instances
+	struct filepos_t
+	{
+		uapi::loff_t				offset = 0;		// Current file position
+		readahead_t					readahead;		// Read-ahead state
+		sync::critical_section		cs;				// Synchronization object
+	};
+
+	// nodeid_t
+	//
+	// Identifies a host file system object by volume serial number and file id
+	struct nodeid_t
+	{
+		uint64_t		volume;			// Host volume serial number
+		FILE_ID_128		fileid;			// Host file identifier
+
+		bool operator==(nodeid_t const& rhs) const 
+		{ 
+			return (volume == rhs.volume) && (memcmp(&fileid, &rhs.fileid, sizeof(FILE_ID_128)) == 0); 
+		}
+	};
+
+	// nodeid_hash_t
+	//
+	// Hash function for nodeid_t
+	struct nodeid_hash_t
+	{
+		size_t operator()(nodeid_t const& id) const
+		{
+			uint64_t const* fileid = reinterpret_cast<uint64_t const*>(&id.fileid);
+			return std::hash<uint64_t>()(id.volume) ^ (std::hash<uint64_t>()(fileid[0]) << 1) ^ (std::hash<uint64_t>()(fileid[1]) << 2);
+		}
+	};
+
+	// nodeentry_t
+	//
+	// Active NodeBase instance; the raw pointer identifies which node owns the entry
+	struct nodeentry_t
+	{
+		NodeBase*					node;		// Owning node instance
+		std::weak_ptr<NodeBase>		weak;		// Weak reference to the node
+	};
 
 	// nodemap_t
 	//
-	// Collection of active NodeBase instances
-	using nodemap_t = std::unordered_map<NodeBase*, std::weak_ptr<NodeBase>>;
+	// Collection of active NodeBase instances, keyed by host object identifier
+	using nodemap_t = std::unordered_map<nodeid_t, nodeentry_t, nodeid_hash_t>;
 
 	// handlemap_t
 	//
 	// Collection of active HandleBase instances
 	using handlemap_t = std::unordered_map<HandleBase*, std::weak_ptr<HandleBase>>;
 
+	// statentry_t
+	//
+	// Cached node statistics
+	struct statentry_t
+	{
+		uapi::stat		stats;			// Node statistics
+		ULONGLONG		expires;		// Expiration tick count (or zero)
+		bool			once;			// Entry is discarded after first use
+	};
+
+	// statmap_t
+	//
+	// Collection of cached node statistics, keyed by host object identifier
+	using statmap_t = std::unordered_map<nodeid_t, statentry_t, nodeid_hash_t>;
+
+	// statpathmap_t
+	//
+	// Collection of cached node identifiers, keyed by case-folded host path
+	using statpathmap_t = std::unordered_map<std::wstring, nodeid_t>;
+
 	// HostFileSystem::Alias
 	//
 	class Alias : public FileSystem::Alias
@@ -180,7 +286,7 @@ private:
 
 		// Instance Constructor
 		//
-		HandleBase(std::shared_ptr<HostFileSystem> fs, HANDLE handle, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+		HandleBase(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
 
 		// Destructor
 		//
@@ -193,6 +299,7 @@ private:
 
 		const std::shared_ptr<HostFileSystem>	m_fs;		// Parent file system instance
 		HANDLE const							m_handle;	// Native operating system handle
+		nodeid_t const							m_id;		// Host object identifier
 		const FileSystem::HandleAccess			m_access;	// Handle access mode
 		const FileSystem::HandleFlags			m_flags;	// Handle flags
 
@@ -204,18 +311,39 @@ private:
 
 	// HostFileSystem::NodeBase
 	//
-	class NodeBase
+	class NodeBase : public FileSystem::Watchable
 	{
 	public:
 
 		// Instance Constructor
 		//
-		NodeBase(std::shared_ptr<HostFileSystem> fs, HANDLE handle);
+		NodeBase(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id);
 
 		// Destructor
 		//
 		virtual ~NodeBase();
 
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// Notify
+		//
+		// Notifies the registered watchers that this node or a child has changed
+		void Notify(uint32_t mask, uint32_t cookie, const char_t* name);
+
+		//---------------------------------------------------------------------
+		// FileSystem::Watchable Implementation
+
+		// Unwatch
+		//
+		// Removes a previously registered watcher
+		virtual void Unwatch(const FileSystem::NotifyWatcher* watcher) override;
+
+		// Watch
+		//
+		// Registers a watcher to be notified when the node or a child of the node changes
+		virtual void Watch(std::shared_ptr<FileSystem::NotifyWatcher> watcher) override;
+
 		//---------------------------------------------------------------------
 		// Properties
 
@@ -226,6 +354,12 @@ private:
 		__declspec(property(get=getHandle)) HANDLE Handle;
 		HANDLE getHandle(void) const;
 
+		// Id
+		//
+		// Gets the host file system object identifier
+		__declspec(property(get=getId)) nodeid_t const& Id;
+		nodeid_t const& getId(void) const;
+
 		// NormalizedPath
 		//
 		// Gets a pointer to the normalized path to this node on the host
@@ -239,7 +373,10 @@ private:
 
 		const std::shared_ptr<HostFileSystem>	m_fs;		// Parent file system instance
 		HANDLE const							m_handle;	// Native operating system handle
+		nodeid_t const							m_id;		// Host object identifier
 		windows_path							m_path;		// Normalized path to this node
+		NotifyQueue								m_notify;	// Registered change watchers
+		bool									m_watched;	// Flag if path is in the watch index
 
 	private:
 
@@ -255,7 +392,7 @@ private:
 
 		// Instance Constructor
 		//
-		using HandleBase::HandleBase;
+		DirectoryHandle(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
 
 		// Destructor
 		//
@@ -279,6 +416,11 @@ private:
 		// Synchronously reads data from the underlying node into a buffer
 		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
 
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
 		// Seek
 		//
 		// Changes the file position
@@ -318,6 +460,26 @@ private:
 
 		DirectoryHandle(const DirectoryHandle&)=delete;
 		DirectoryHandle& operator=(const DirectoryHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Private Member Functions
+
+		// FillBuffer
+		//
+		// Retrieves the next batch of directory entries from the host
+		bool FillBuffer(void);
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		std::unique_ptr<uint8_t[]>		m_buffer;			// Host enumeration buffer
+		ULONG							m_bufferlength;		// Length of valid buffer data
+		ULONG							m_bufferoffset;		// Offset of the next buffered entry
+		uapi::loff_t					m_position;			// Current directory position
+		bool							m_restart;			// Flag to restart the enumeration
+		std::wstring					m_path;				// Normalized directory path
+		ULONG							m_blksize;			// Host performance block size
+		mutable sync::critical_section	m_cs;				// Synchronization object
 	};
 
 	// HostFileSystem::DirectoryNode
@@ -378,7 +540,7 @@ private:
 		// Lookup
 		//
 		// Looks up the alias associated with a child of this node
-		virtual std::shared_ptr<FileSystem::Alias> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const override;
+		virtual FileSystem::Result<std::shared_ptr<FileSystem::Alias>> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const override;
 
 	private:
 
@@ -388,13 +550,14 @@ private:
 	
 	// HostFileSystem::FileHandle
 	//
-	class FileHandle : public HandleBase, public FileSystem::Handle
+	class FileHandle : public HandleBase, public FileSystem::Handle, public FileSystem::CopyTarget, public FileSystem::ScatterGather
 	{
 	public:
 
 		// Instance Constructor
 		//
-		using HandleBase::HandleBase;
+		FileHandle(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id, FileSystem::HandleAccess access, FileSystem::HandleFlags flags, std::shared_ptr<ReadCache> readcache, 
+			std::unique_ptr<IoEngine::Channel> channel);
 
 		// Destructor
 		//
@@ -418,6 +581,11 @@ private:
 		// Synchronously reads data from the underlying node into a buffer
 		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
 
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
 		// Seek
 		//
 		// Changes the file position
@@ -453,10 +621,49 @@ private:
 		// Gets the handle flags
 		virtual FileSystem::HandleFlags getFlags(void) const override;
 
+		//---------------------------------------------------------------------
+		// FileSystem::CopyTarget Implementation
+
+		// CopyFrom
+		//
+		// Copies data from another handle; the result is EXDEV if a direct copy is not possible
+		virtual FileSystem::Result<uapi::size_t> CopyFrom(std::shared_ptr<FileSystem::Handle> source, uapi::loff_t sourceoffset, 
+			uapi::loff_t offset, uapi::size_t count) override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::ScatterGather Implementation
+
+		// ReadAtV
+		//
+		// Synchronously reads data from the underlying node into an array of buffers
+		virtual uapi::size_t ReadAtV(uapi::loff_t offset, const uapi::iovec* iov, int iovcnt) override;
+
+		// ReadV
+		//
+		// Synchronously reads data from the underlying node into an array of buffers
+		virtual uapi::size_t ReadV(const uapi::iovec* iov, int iovcnt) override;
+
+		// WriteAtV
+		//
+		// Synchronously writes data from an array of buffers to the underlying node
+		virtual uapi::size_t WriteAtV(uapi::loff_t offset, const uapi::iovec* iov, int iovcnt) override;
+
+		// WriteV
+		//
+		// Synchronously writes data from an array of buffers to the underlying node
+		virtual uapi::size_t WriteV(const uapi::iovec* iov, int iovcnt) override;
+
 	private:
 
 		FileHandle(const FileHandle&)=delete;
 		FileHandle& operator=(const FileHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<ReadCache>	m_readcache;	// Node read-ahead buffer
+		std::shared_ptr<filepos_t>			m_position;		// File position
+		const std::unique_ptr<IoEngine::Channel>	m_channel;	// Overlapped I/O channel
 	};
 
 	// HostFileSystem::FileNode
@@ -467,7 +674,7 @@ private:
 
 		// Instance Constructor
 		//
-		using NodeBase::NodeBase;
+		FileNode(std::shared_ptr<HostFileSystem> fs, HANDLE handle, nodeid_t const& id);
 
 		// Destructor
 		//
@@ -509,10 +716,72 @@ private:
 		// Creates an execute-only handle against this node; used only by the virtual machine
 		virtual std::shared_ptr<FileSystem::Handle> OpenExec(std::shared_ptr<FileSystem::Mount> mount) const override;
 
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// InvalidateCache
+		//
+		// Discards any file data buffered for this node
+		void InvalidateCache(void);
+
 	private:
 
 		FileNode(const FileNode&)=delete;
 		FileNode& operator=(const FileNode&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<ReadCache>	m_readcache;	// Read-ahead buffer shared by all handles
+	};
+
+	// HostFileSystem::ReadCache
+	//
+	// Read-ahead buffer shared among all of the handles against a file node; detects
+	// sequential access per file description and adapts the size of the read-ahead
+	// window accordingly.  The buffer is filled without the lock held, a fill that
+	// raced with Invalidate is returned to the caller but is not retained
+	class ReadCache
+	{
+	public:
+
+		// Instance Constructor
+		//
+		ReadCache();
+
+		// Destructor
+		//
+		~ReadCache()=default;
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// Invalidate
+		//
+		// Discards any buffered data
+		void Invalidate(void);
+
+		// Read
+		//
+		// Reads data from the node, serving it from the read-ahead buffer when possible
+		uapi::size_t Read(IoEngine::Channel& channel, readahead_t& readahead, uapi::loff_t offset, void* buffer, uapi::size_t count);
+
+	private:
+
+		ReadCache(const ReadCache&)=delete;
+		ReadCache& operator=(const ReadCache&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		std::unique_ptr<uint8_t[]>		m_buffer;		// Read-ahead buffer
+		size_t							m_capacity;		// Allocated buffer capacity
+		uapi::loff_t					m_base;			// Node offset of the buffered data
+		size_t							m_length;		// Length of the buffered data
+		uint64_t						m_generation;	// Incremented by Invalidate
+		std::unique_ptr<uint8_t[]>		m_spare;		// Buffer retained for the next fill
+		size_t							m_sparecapacity;	// Spare buffer capacity
+		sync::critical_section			m_cs;			// Synchronization object
 	};
 
 	// HostFileSystem::Mount
@@ -583,6 +852,16 @@ private:
 	//-------------------------------------------------------------------------
 	// Private Member Functions
 
+	// AttachNode (static)
+	//
+	// Places a new node into the tracking collection or returns the active node
+	static std::shared_ptr<NodeBase> AttachNode(std::shared_ptr<HostFileSystem> const& fs, std::shared_ptr<NodeBase> const& node);
+
+	// CacheStat (static)
+	//
+	// Stores node statistics in the attribute cache
+	static void CacheStat(std::shared_ptr<HostFileSystem> const& fs, nodeid_t const& id, std::wstring&& path, uapi::stat const& stats, bool once);
+
 	// CreateDirectoryNode (static)
 	//
 	// Creates a new DirectoryNode instance
@@ -593,16 +872,64 @@ private:
 	// Creates a new FileNode instance
 	static std::shared_ptr<FileNode> CreateFileNode(std::shared_ptr<HostFileSystem> fs, DWORD disposition, const windows_path& path);
 
+	// FindNode (static)
+	//
+	// Locates an active node instance by host object identifier
+	static std::shared_ptr<NodeBase> FindNode(std::shared_ptr<HostFileSystem> const& fs, nodeid_t const& id);
+
+	// FindNode (static)
+	//
+	// Locates an active node instance by host path without accessing the host
+	static std::shared_ptr<NodeBase> FindNode(std::shared_ptr<HostFileSystem> const& fs, const wchar_t* path);
+
+	// GetNodeId (static)
+	//
+	// Retrieves the host object identifier for a native handle
+	static nodeid_t GetNodeId(HANDLE handle);
+
+	// InvalidateStat (static)
+	//
+	// Removes node statistics from the attribute cache
+	static void InvalidateStat(std::shared_ptr<HostFileSystem> const& fs, nodeid_t const& id);
+
+	// LookupStat (static)
+	//
+	// Retrieves node statistics from the attribute cache
+	static bool LookupStat(std::shared_ptr<HostFileSystem> const& fs, nodeid_t const& id, uapi::stat* stats);
+
+	// OnHostChange
+	//
+	// Invalidates cached node statistics and notifies watched nodes in response to a host change
+	void OnHostChange(std::wstring const& root, DWORD action, const wchar_t* name, size_t length);
+
+	// StatCacheEnabled
+	//
+	// Determines if node statistics can currently be cached
+	bool StatCacheEnabled(void) const;
+
 	//-------------------------------------------------------------------------
 	// Member Variables
 
+	const std::shared_ptr<IoEngine>	m_ioengine;		// Host I/O completion engine
 	const std::string				m_source;		// File system source string
 	std::wstring					m_sandbox;		// Normalized base path string
 	std::atomic<uint32_t>			m_flags;		// File system specific flags
 	const uapi::fsid_t				m_fsid;			// File system unique identifier
-	nodemap_t						m_nodes;		// Active node instances
+	nodemap_t						m_nodes;		// Active node instances (by id)
+	statpathmap_t					m_nodepaths;	// Active node identifiers, by path
 	handlemap_t						m_handles;		// Active handle instances
+	statmap_t						m_stats;		// Cached node statistics
+	statpathmap_t					m_statpaths;	// Cached node statistics paths
+	statpathmap_t					m_watchpaths;	// Watched node identifiers, by path
+	uint32_t						m_movecookie;	// Last IN_MOVED_FROM/IN_MOVED_TO cookie
+	bool							m_attrcache;	// Flag to cache node attributes
+	ULONGLONG						m_statttl;		// Cached statistics lifetime (ms)
+	std::atomic<uint64_t>			m_stathits;		// Statistics cache hits
+	std::atomic<uint64_t>			m_statmisses;	// Statistics cache misses
 	mutable sync::critical_section	m_cs;			// Synchronization object
+
+	// The watcher invokes callbacks against the members above; it must be destroyed first
+	std::unique_ptr<DirectoryWatcher>	m_watcher;	// Host change notification watcher
 };
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,1404 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "ImageFileSystem.h"
+
+#include <algorithm>
+#include "Capability.h"
+#include "File.h"
+#include "FilePermission.h"
+#include "LinuxException.h"
+#include "MappedFile.h"
+#include "MountOptions.h"
+#include "Win32Exception.h"
+
+#pragma warning(push, 4)
+
+// DEFAULT_CACHE_BLOCKS
+//
+// Default maximum number of decompressed data blocks to cache
+static const size_t DEFAULT_CACHE_BLOCKS = 256;
+
+// FIRST_COOKIE
+//
+// First enumeration cookie assigned to a child entry; 0 and 1 are "." and ".."
+static const uapi::loff_t FIRST_COOKIE = 2;
+
+// IMAGEFS_MAGIC
+//
+// File system type reported by statfs(2); there is no Linux equivalent
+static const uint32_t IMAGEFS_MAGIC = IMAGE_MAGIC;
+
+//-----------------------------------------------------------------------------
+// DirectoryEntryType (local)
+//
+// Converts a node mode into a linux_dirent64 d_type value
+//
+// Arguments:
+//
+//	mode		- Node mode to be converted
+
+static uint8_t DirectoryEntryType(uint32_t mode)
+{
+	switch(mode & LINUX_S_IFMT) {
+
+		case LINUX_S_IFBLK: return LINUX_DT_BLK;
+		case LINUX_S_IFCHR: return LINUX_DT_CHR;
+		case LINUX_S_IFDIR: return LINUX_DT_DIR;
+		case LINUX_S_IFREG: return LINUX_DT_REG;
+		case LINUX_S_IFIFO: return LINUX_DT_FIFO;
+		case LINUX_S_IFSOCK: return LINUX_DT_SOCK;
+		case LINUX_S_IFLNK: return LINUX_DT_LNK;
+	}
+
+	return LINUX_DT_UNKNOWN;
+}
+
+//-----------------------------------------------------------------------------
+// PackDirectoryEntry (local)
+//
+// Packs a single linux_dirent64 structure into an output buffer, returns zero
+// if the structure will not fit into the remaining buffer space
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Remaining length of the destination buffer, in bytes
+//	ino			- Node index number
+//	offset		- Position of the next entry in the directory
+//	type		- Entry type (DT_xxx)
+//	name		- Entry name
+//	namelength	- Length of the entry name, in bytes
+
+static uapi::size_t PackDirectoryEntry(void* buffer, uapi::size_t count, uint64_t ino, uapi::loff_t offset, uint8_t type, 
+	const char_t* name, size_t namelength)
+{
+	uapi::size_t reclen = align::up(offsetof(uapi::dirent64, d_name) + namelength + 1, 8);
+	if(reclen > count) return 0;
+
+	auto dirent = reinterpret_cast<uapi::dirent64*>(buffer);
+	memset(dirent, 0, reclen);
+	dirent->d_ino = ino;
+	dirent->d_off = offset;
+	dirent->d_reclen = static_cast<uint16_t>(reclen);
+	dirent->d_type = type;
+	memcpy(dirent->d_name, name, namelength);
+
+	return reclen;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem Constructor
+//
+// Arguments:
+//
+//	source		- Source device name, as provided to Mount()
+//	flags		- File system flags and options
+//	view		- Mapped view of the image file
+//	cacheblocks	- Maximum number of decompressed blocks to cache
+
+ImageFileSystem::ImageFileSystem(const char_t* source, uint32_t flags, std::unique_ptr<MappedFileView>&& view, size_t cacheblocks) 
+	: m_source(source), m_flags(flags), m_fsid(FileSystem::GenerateFileSystemId()), m_view(std::move(view)), 
+	m_image(m_view->Pointer, m_view->Length, cacheblocks)
+{
+	// No mount-specific flags should be specified for the file system instance
+	_ASSERTE((flags & LINUX_MS_PERMOUNT_MASK) == 0);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::CreateNode (private, static)
+//
+// Creates the node instance for a node table entry
+//
+// Arguments:
+//
+//	fs			- File system instance
+//	index		- Node table index
+//	parent		- Parent directory node table index
+
+std::shared_ptr<FileSystem::Node> ImageFileSystem::CreateNode(std::shared_ptr<ImageFileSystem> fs, uint32_t index, uint32_t parent)
+{
+	switch(fs->m_image.GetNode(index).mode & LINUX_S_IFMT) {
+
+		case LINUX_S_IFDIR: return std::make_shared<DirectoryNode>(std::move(fs), index, parent);
+		case LINUX_S_IFREG: return std::make_shared<FileNode>(std::move(fs), index);
+		case LINUX_S_IFLNK: return std::make_shared<SymbolicLinkNode>(std::move(fs), index);
+	}
+
+	// todo: device, pipe and socket nodes
+	return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount (static)
+//
+// Mounts the file system
+//
+// Arguments:
+//
+//	source		- Source device string
+//	flags		- Standard mounting flags and attributes
+//	data		- Additional file-system specific mounting options
+//	datalength	- Length of the extended mounting options data
+
+std::shared_ptr<FileSystem::Mount> ImageFileSystem::Mount(const char_t* source, uint32_t flags, const void* data, size_t datalength)
+{
+	size_t						cacheblocks = DEFAULT_CACHE_BLOCKS;		// Maximum cached blocks
+	std::shared_ptr<ImageFileSystem>	fs;								// File system instance
+
+	if(source == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	Capability::Demand(Capability::SystemAdmin);
+
+	// Parse the provided mounting options
+	MountOptions options(flags, data, datalength);
+
+	// Break up the standard mounting options bitmask into file system and mount specific masks; the
+	// file system is always read-only regardless of the provided flags
+	auto fsflags = (options.Flags & LINUX_MS_KERNMOUNT) | LINUX_MS_RDONLY;
+	auto mountflags = options.Flags & LINUX_MS_PERMOUNT_MASK;
+
+	try {
+
+		// cache=
+		//
+		// Sets the maximum number of decompressed data blocks to cache
+		if(options.Arguments.Contains("cache")) cacheblocks = std::stoul(options.Arguments["cache"], 0, 0);
+	}
+
+	catch(...) { throw LinuxException(LINUX_EINVAL); }
+
+	if(cacheblocks == 0) throw LinuxException(LINUX_EINVAL);
+
+	try {
+
+		// Map a read-only view of the entire image file, the pages are only brought into memory when
+		// they are accessed so the cost of mounting the file system does not depend on the image size
+		auto file = File::OpenExisting(std::to_tstring(source).c_str(), GENERIC_READ, FILE_SHARE_READ, FILE_FLAG_RANDOM_ACCESS);
+		fs = std::make_shared<ImageFileSystem>(source, fsflags, MappedFileView::Create(MappedFile::CreateFromFile(file)), cacheblocks);
+	}
+
+	catch(Win32Exception& ex) { throw LinuxException((ex.Code == ERROR_ACCESS_DENIED) ? LINUX_EACCES : LINUX_ENOENT, ex); }
+	catch(Exception& ex) { throw LinuxException(LINUX_EINVAL, ex); }
+
+	// The root node must be a directory, it's its own parent
+	uint32_t rootindex = fs->m_image.RootNode;
+	if((fs->m_image.GetNode(rootindex).mode & LINUX_S_IFMT) != LINUX_S_IFDIR) throw LinuxException(LINUX_EINVAL);
+
+	auto rootdir = std::make_shared<DirectoryNode>(fs, rootindex, rootindex);
+
+	// Construct and return the mount instance
+	return std::make_shared<class Mount>(fs, rootdir, mountflags);
+}
+
+//
+// IMAGEFILESYSTEM::ALIAS
+//
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Alias Constructor
+//
+// Arguments:
+//
+//	name			- Name to assign to this alias
+//	node			- Node to attach to this alias
+
+ImageFileSystem::Alias::Alias(std::string&& name, std::shared_ptr<FileSystem::Node> node) : m_node(std::move(node)), m_name(std::move(name))
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Alias::GetName
+//
+// Reads the name assigned to this alias
+//
+// Arguments:
+//
+//	buffer			- Output buffer
+//	count			- Size of the output buffer, in bytes
+
+uapi::size_t ImageFileSystem::Alias::GetName(char_t* buffer, size_t count) const
+{
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Copy the minimum of the name length or the output buffer size
+	count = std::min(m_name.size(), count);
+	memcpy(buffer, m_name.data(), count * sizeof(char_t));
+	
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Alias::getName
+//
+// Gets the name assigned to this alias
+
+std::string ImageFileSystem::Alias::getName(void) const
+{
+	return std::string(m_name);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Alias::getNode
+//
+// Gets the node to which this alias refers
+
+std::shared_ptr<FileSystem::Node> ImageFileSystem::Alias::getNode(void) const
+{
+	return m_node;
+}
+
+//
+// IMAGEFILESYSTEM::DIRECTORYHANDLE
+//
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle Constructor
+//
+// Arguments:
+//
+//	node		- Directory node instance
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+ImageFileSystem::DirectoryHandle::DirectoryHandle(std::shared_ptr<DirectoryNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+	: m_node(std::move(node)), m_access(access), m_flags(flags), m_position(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess ImageFileSystem::DirectoryHandle::getAccess(void) const
+{
+	return m_access;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> ImageFileSystem::DirectoryHandle::Duplicate(void) const
+{
+	auto handle = std::make_shared<DirectoryHandle>(m_node, m_access, m_flags);
+
+	// The duplicate handle starts enumerating from the current position of this handle
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	handle->m_position = m_position;
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::getFlags
+//
+// Gets the flags specified on the handle
+
+FileSystem::HandleFlags ImageFileSystem::DirectoryHandle::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t ImageFileSystem::DirectoryHandle::Read(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t ImageFileSystem::DirectoryHandle::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t ImageFileSystem::DirectoryHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	return m_node->ReadDirectory(m_position, buffer, count);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset (relative to whence) to position the file pointer
+//	whence		- Flag indicating the file position from which offset applies
+
+uapi::loff_t ImageFileSystem::DirectoryHandle::Seek(uapi::loff_t offset, int whence)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// Directory positions are enumeration cookies; SEEK_SET can be used to rewind the
+	// directory or to return to a d_off value, SEEK_CUR can only report the position
+	if((whence == LINUX_SEEK_SET) && (offset >= 0)) return (m_position = offset);
+	if((whence == LINUX_SEEK_CUR) && (offset == 0)) return m_position;
+
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void ImageFileSystem::DirectoryHandle::Sync(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void ImageFileSystem::DirectoryHandle::SyncData(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	count		- Maximum number of bytes to write
+
+uapi::size_t ImageFileSystem::DirectoryHandle::Write(const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryHandle::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source buffer
+//	count		- Maximum number of bytes to write
+
+uapi::size_t ImageFileSystem::DirectoryHandle::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
+}
+
+//
+// IMAGEFILESYSTEM::DIRECTORYNODE
+//
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	index		- Node table index
+//	parent		- Parent directory node table index
+
+ImageFileSystem::DirectoryNode::DirectoryNode(std::shared_ptr<ImageFileSystem> fs, uint32_t index, uint32_t parent) 
+	: NodeBase(std::move(fs), index), m_parent(parent)
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::CreateDirectory
+//
+// Creates a new directory node as a child of this directory
+//
+// Arguments:
+//
+//	mount		- Mount point on which to perform this operation
+//	name		- Name to assign to the new node
+//	mode		- Mode bitmask to assign to the new node
+
+std::shared_ptr<FileSystem::Alias> ImageFileSystem::DirectoryNode::CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode)
+{
+	UNREFERENCED_PARAMETER(mount);
+	UNREFERENCED_PARAMETER(name);
+	UNREFERENCED_PARAMETER(mode);
+
+	throw LinuxException(LINUX_EROFS);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::CreateFile
+//
+// Creates a new regular file node as a child of this directory
+//
+// Arguments:
+//
+//	mount		- Mount point on which to perform this operation
+//	name		- Name to assign to the new node
+//	mode		- Mode bitmask to assign to the new node
+
+std::shared_ptr<FileSystem::Alias> ImageFileSystem::DirectoryNode::CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode)
+{
+	UNREFERENCED_PARAMETER(mount);
+	UNREFERENCED_PARAMETER(name);
+	UNREFERENCED_PARAMETER(mode);
+
+	throw LinuxException(LINUX_EROFS);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::Lookup
+//
+// Looks up the alias associated with a child of this node
+//
+// Arguments:
+//
+//	mount		- Mount point on which to perform this operation
+//	name		- Name of the child to look up
+
+FileSystem::Result<std::shared_ptr<FileSystem::Alias>> ImageFileSystem::DirectoryNode::Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const
+{
+	uint32_t				index;			// Child node table index
+
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+	UNREFERENCED_PARAMETER(mount);
+
+	if(name == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Search permission on the directory is required to look up a child
+	FilePermission::Demand(FilePermission::Execute, m_node.uid, m_node.gid, m_node.mode);
+
+	try {
+
+		size_t namelength = strlen(name);
+		if(!m_fs->m_image.Lookup(m_node, name, namelength, &index)) return FileSystem::Error{ LINUX_ENOENT };
+
+		auto node = CreateNode(m_fs, index, m_index);
+		if(!node) return FileSystem::Error{ LINUX_ENXIO };
+
+		return std::make_shared<Alias>(std::string(name, namelength), std::move(node));
+	}
+
+	// Exceptions raised by the image reader indicate that the image is corrupt
+	catch(Exception& ex) { throw LinuxException(LINUX_EIO, ex); }
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::Open
+//
+// Creates a Handle instance against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this directory was reached
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+std::shared_ptr<FileSystem::Handle> ImageFileSystem::DirectoryNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+{
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+	UNREFERENCED_PARAMETER(mount);
+
+	// Directory node handles must always be opened in read-only mode
+	if(access != FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EISDIR);
+
+	// Check for flags that are incompatible with opening a directory file system object
+	if(flags & (FileSystem::HandleFlags::Append | FileSystem::HandleFlags::Direct)) throw LinuxException(LINUX_EINVAL);
+
+	// Read access to the directory node is required to open a handle against it
+	FilePermission::Demand(FilePermission::Read, m_node.uid, m_node.gid, m_node.mode);
+
+	return std::make_shared<DirectoryHandle>(shared_from_this(), access, flags);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::ReadDirectory
+//
+// Reads entries from the directory as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	position	- Enumeration cookie of the next entry to return [in/out]
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t ImageFileSystem::DirectoryNode::ReadDirectory(uapi::loff_t& position, void* buffer, uapi::size_t count) const
+{
+	uint8_t*				dest = reinterpret_cast<uint8_t*>(buffer);		// Destination pointer
+	uapi::size_t			written = 0;									// Bytes written to the buffer
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// The special "." and ".." entries occupy the positions before the first child entry
+	while(position < FIRST_COOKIE) {
+
+		const char_t* name = (position == 0) ? "." : "..";
+		uapi::size_t reclen = PackDirectoryEntry(dest + written, count - written, static_cast<uint64_t>((position == 0) ? m_index : m_parent) + 1, 
+			position + 1, LINUX_DT_DIR, name, strlen(name));
+
+		if(reclen == 0) { if(written == 0) throw LinuxException(LINUX_EINVAL); return written; }
+
+		written += reclen;
+		++position;
+	}
+
+	try {
+
+		// The child entries are stored in the directory table in name order; the position is the
+		// index of the next entry to return offset by the special entries
+		while(static_cast<uint64_t>(position - FIRST_COOKIE) < m_node.size) {
+
+			auto const& entry = m_fs->m_image.GetDirectoryEntry(m_node, static_cast<uint64_t>(position - FIRST_COOKIE));
+
+			uapi::size_t reclen = PackDirectoryEntry(dest + written, count - written, static_cast<uint64_t>(entry.node) + 1, position + 1, 
+				DirectoryEntryType(m_fs->m_image.GetNode(entry.node).mode), m_fs->m_image.GetName(entry.name, entry.namelength), entry.namelength);
+
+			if(reclen == 0) { if(written == 0) throw LinuxException(LINUX_EINVAL); break; }
+
+			written += reclen;
+			++position;
+		}
+	}
+
+	// Exceptions raised by the image reader indicate that the image is corrupt
+	catch(Exception& ex) { throw LinuxException(LINUX_EIO, ex); }
+
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void ImageFileSystem::DirectoryNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	UNREFERENCED_PARAMETER(uid);
+	UNREFERENCED_PARAMETER(gid);
+
+	throw LinuxException(LINUX_EROFS);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void ImageFileSystem::DirectoryNode::SetPermissions(uapi::mode_t permissions)
+{
+	UNREFERENCED_PARAMETER(permissions);
+
+	throw LinuxException(LINUX_EROFS);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::Stat
+//
+// Provides statistical information about this node
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void ImageFileSystem::DirectoryNode::Stat(uapi::stat* stats) const
+{
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	StatNode(stats);
+	stats->st_size = static_cast<decltype(stats->st_size)>(m_node.size);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::DirectoryNode::getType
+//
+// Gets the type of node represented by this object
+
+FileSystem::NodeType ImageFileSystem::DirectoryNode::getType(void) const
+{
+	return FileSystem::NodeType::Directory;
+}
+
+//
+// IMAGEFILESYSTEM::FILEHANDLE
+//
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle Constructor
+//
+// Arguments:
+//
+//	node		- File node instance
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+ImageFileSystem::FileHandle::FileHandle(std::shared_ptr<const FileNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+	: m_node(std::move(node)), m_access(access), m_flags(flags), m_position(std::make_shared<filepos_t>())
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess ImageFileSystem::FileHandle::getAccess(void) const
+{
+	return m_access;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> ImageFileSystem::FileHandle::Duplicate(void) const
+{
+	auto handle = std::make_shared<FileHandle>(m_node, m_access, m_flags);
+
+	// Duplicated handles share the same file position
+	handle->m_position = m_position;
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::getFlags
+//
+// Gets the flags specified on the handle
+
+FileSystem::HandleFlags ImageFileSystem::FileHandle::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t ImageFileSystem::FileHandle::Read(void* buffer, uapi::size_t count)
+{
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	uapi::size_t read = m_node->Read(m_position->offset, buffer, count);
+	m_position->offset += read;
+
+	return read;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t ImageFileSystem::FileHandle::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	return m_node->Read(offset, buffer, count);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t ImageFileSystem::FileHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ENOTDIR);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset into the node data to seek, relative to whence
+//	whence		- Position in the node data that offset is relative to
+
+uapi::loff_t ImageFileSystem::FileHandle::Seek(uapi::loff_t offset, int whence)
+{
+	uapi::loff_t			position;			// New file position
+
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	switch(whence) {
+
+		case LINUX_SEEK_SET: position = offset; break;
+		case LINUX_SEEK_CUR: position = m_position->offset + offset; break;
+		case LINUX_SEEK_END: position = m_node->Length + offset; break;
+		default: throw LinuxException(LINUX_EINVAL);
+	}
+
+	if(position < 0) throw LinuxException(LINUX_EINVAL);
+
+	return (m_position->offset = position);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void ImageFileSystem::FileHandle::Sync(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void ImageFileSystem::FileHandle::SyncData(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t ImageFileSystem::FileHandle::Write(const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	// Handles can only be opened in read-only mode, which yields EINVAL rather than EROFS
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileHandle::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t ImageFileSystem::FileHandle::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	// Handles can only be opened in read-only mode, which yields EINVAL rather than EROFS
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//
+// IMAGEFILESYSTEM::FILENODE
+//
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	index		- Node table index
+
+ImageFileSystem::FileNode::FileNode(std::shared_ptr<ImageFileSystem> fs, uint32_t index) : NodeBase(std::move(fs), index)
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode::getLength
+//
+// Gets the length of the file data
+
+uapi::loff_t ImageFileSystem::FileNode::getLength(void) const
+{
+	return static_cast<uapi::loff_t>(m_node.size);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode::Open
+//
+// Creates a Handle instance against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this file was reached
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+std::shared_ptr<FileSystem::Handle> ImageFileSystem::FileNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+{
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+	UNREFERENCED_PARAMETER(mount);
+
+	// The file system is read-only, handles cannot be opened for write access or truncation
+	if((access != FileSystem::HandleAccess::ReadOnly) || (flags & FileSystem::HandleFlags::Truncate)) throw LinuxException(LINUX_EROFS);
+
+	FilePermission::Demand(FilePermission::Read, m_node.uid, m_node.gid, m_node.mode);
+
+	return std::make_shared<FileHandle>(shared_from_this(), access, flags);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode::OpenExec
+//
+// Creates an execute-only handle against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this node was resolved
+
+std::shared_ptr<FileSystem::Handle> ImageFileSystem::FileNode::OpenExec(std::shared_ptr<FileSystem::Mount> mount) const
+{
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	// Verify that the mount point allows for execution of binary files
+	if(mount->Flags & LINUX_MS_NOEXEC) throw LinuxException(LINUX_ENOEXEC);
+
+	FilePermission::Demand(FilePermission::Execute, m_node.uid, m_node.gid, m_node.mode);
+
+	return std::make_shared<FileHandle>(shared_from_this(), FileSystem::HandleAccess::ReadOnly, FileSystem::HandleFlags::None);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode::Read
+//
+// Reads data from the file
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the file to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t ImageFileSystem::FileNode::Read(uapi::loff_t offset, void* buffer, uapi::size_t count) const
+{
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+	if(offset < 0) throw LinuxException(LINUX_EINVAL);
+
+	// Data blocks are decompressed on demand by the image reader
+	try { return static_cast<uapi::size_t>(m_fs->m_image.Read(m_node, static_cast<uint64_t>(offset), buffer, count)); }
+
+	// Exceptions raised by the image reader indicate that the image is corrupt
+	catch(Exception& ex) { throw LinuxException(LINUX_EIO, ex); }
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void ImageFileSystem::FileNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	UNREFERENCED_PARAMETER(uid);
+	UNREFERENCED_PARAMETER(gid);
+
+	throw LinuxException(LINUX_EROFS);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void ImageFileSystem::FileNode::SetPermissions(uapi::mode_t permissions)
+{
+	UNREFERENCED_PARAMETER(permissions);
+
+	throw LinuxException(LINUX_EROFS);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode::Stat
+//
+// Provides statistical information about this node
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void ImageFileSystem::FileNode::Stat(uapi::stat* stats) const
+{
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	StatNode(stats);
+	stats->st_size		= static_cast<decltype(stats->st_size)>(m_node.size);
+	stats->st_blocks	= static_cast<decltype(stats->st_blocks)>(align::up(m_node.size, static_cast<uint64_t>(m_fs->m_image.BlockSize)) / 512);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::FileNode::getType
+//
+// Gets the type of node represented by this object
+
+FileSystem::NodeType ImageFileSystem::FileNode::getType(void) const
+{
+	return FileSystem::NodeType::File;
+}
+
+//
+// IMAGEFILESYSTEM::MOUNT
+//
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount Constructor
+//
+// Arguments:
+//
+//	fs		- Reference to the ImageFileSystem instance
+//	root	- Root directory node instance
+//	flags	- Per-mount flags and options to set on this mount instance
+
+ImageFileSystem::Mount::Mount(std::shared_ptr<ImageFileSystem> fs, std::shared_ptr<DirectoryNode> root, uint32_t flags) 
+	: m_fs(std::move(fs)), m_flags(flags), m_root(std::move(root))
+{
+	// The flags should only contain bits from MS_PERMOUNT_MASK
+	_ASSERTE((m_flags & ~LINUX_MS_PERMOUNT_MASK) == 0);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount::Duplicate
+//
+// Duplicates this mount instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Mount> ImageFileSystem::Mount::Duplicate(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	// Clone the underlying file system reference and flags into a new mount
+	return std::make_shared<Mount>(m_fs, root, m_flags);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount::getFlags
+//
+// Gets the flags set on this mount, includes file system flags
+
+uint32_t ImageFileSystem::Mount::getFlags(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return m_flags | m_fs->m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount::Remount
+//
+// Remounts the file system with different options
+//
+// Arguments:
+//
+//	flags		- Standard mounting option flags
+//	data		- Extended/custom mounting options
+//	datalength	- Length of the extended mounting options data
+
+void ImageFileSystem::Mount::Remount(uint32_t flags, const void* data, size_t datalen)
+{
+	UNREFERENCED_PARAMETER(data);
+	UNREFERENCED_PARAMETER(datalen);
+
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	Capability::Demand(Capability::SystemAdmin);
+
+	// MS_REMOUNT must be specified in the flags when calling this function
+	if((flags & LINUX_MS_REMOUNT) != LINUX_MS_REMOUNT) throw LinuxException(LINUX_EINVAL);
+
+	// The file system is always read-only, there are no options that can be changed
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount::getRoot
+//
+// Gets a reference to the root directory of the mount point
+
+std::shared_ptr<FileSystem::Directory> ImageFileSystem::Mount::getRoot(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return root;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount::getSource
+//
+// Gets the device/name used as the source of the file system
+
+std::string ImageFileSystem::Mount::getSource(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return std::string(m_fs->m_source);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount::Stat
+//
+// Provides statistical information about the mounted file system
+//
+// Arguments:
+//
+//	stats		- Structure to receieve the file system statistics
+
+void ImageFileSystem::Mount::Stat(uapi::statfs* stats) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	memset(stats, 0, sizeof(uapi::statfs));
+
+	stats->f_type		= static_cast<decltype(stats->f_type)>(IMAGEFS_MAGIC);
+	stats->f_bsize		= m_fs->m_image.BlockSize;
+	stats->f_blocks		= align::up(m_fs->m_image.Length, m_fs->m_image.BlockSize) / m_fs->m_image.BlockSize;
+	stats->f_bfree		= 0;
+	stats->f_bavail		= 0;
+	stats->f_files		= m_fs->m_image.NodeCount;
+	stats->f_ffree		= 0;
+	stats->f_fsid		= m_fs->m_fsid;
+	stats->f_namelen	= LINUX_NAME_MAX;
+	stats->f_frsize		= m_fs->m_image.BlockSize;
+	stats->f_flags		= m_flags | m_fs->m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::Mount::Unmount
+//
+// Unmounts the file system
+//
+// Arguments:
+//
+//	NONE
+
+void ImageFileSystem::Mount::Unmount(void)
+{
+	// Ensure that the root directory node is not still shared out; handles opened against
+	// any node in the file system hold a reference to the file system, not the mount
+	if(m_root.use_count() > 1) throw LinuxException(LINUX_EBUSY);
+
+	m_root.reset();			// Release the root directory node
+}
+
+//
+// IMAGEFILESYSTEM::NODEBASE
+//
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::NodeBase Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	index		- Node table index
+
+ImageFileSystem::NodeBase::NodeBase(std::shared_ptr<ImageFileSystem> fs, uint32_t index) : m_fs(std::move(fs)), m_index(index), 
+	m_node(m_fs->m_image.GetNode(index))
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::NodeBase::StatNode (protected)
+//
+// Provides the statistical information common to all node types
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void ImageFileSystem::NodeBase::StatNode(uapi::stat* stats) const
+{
+	_ASSERTE(stats);
+
+	memset(stats, 0, sizeof(uapi::stat));
+
+	stats->st_dev		= (0 << 16) | 0;	// TODO: DEVICE ID; MAJOR WILL BE ZERO MINOR SHOULD AUTO-INCREMENT
+	stats->st_ino		= static_cast<uint64_t>(m_index) + 1;
+	stats->st_nlink		= m_node.nlink;
+	stats->st_mode		= m_node.mode;
+	stats->st_uid		= m_node.uid;
+	stats->st_gid		= m_node.gid;
+	stats->st_rdev		= m_node.rdev;
+	stats->st_blksize	= static_cast<decltype(stats->st_blksize)>(m_fs->m_image.BlockSize);
+
+	// The image only records the modification time of each node
+	stats->st_mtime.tv_sec = static_cast<decltype(stats->st_mtime.tv_sec)>(m_node.mtime);
+	stats->st_atime = stats->st_mtime;
+	stats->st_ctime = stats->st_mtime;
+}
+
+//
+// IMAGEFILESYSTEM::SYMBOLICLINKNODE
+//
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::SymbolicLinkNode Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	index		- Node table index
+
+ImageFileSystem::SymbolicLinkNode::SymbolicLinkNode(std::shared_ptr<ImageFileSystem> fs, uint32_t index) : NodeBase(std::move(fs), index)
+{
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::SymbolicLinkNode::GetTarget
+//
+// Reads the target of the symbolic link
+//
+// Arguments:
+//
+//	buffer		- Output buffer
+//	count		- Size of the output buffer, in bytes
+
+uapi::size_t ImageFileSystem::SymbolicLinkNode::GetTarget(char_t* buffer, size_t count) const
+{
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Copy the minimum of the target length or the output buffer size
+	count = static_cast<size_t>(std::min(m_node.size, static_cast<uint64_t>(count)));
+
+	try { memcpy(buffer, m_fs->m_image.GetName(m_node.start, m_node.size), count * sizeof(char_t)); }
+	catch(Exception& ex) { throw LinuxException(LINUX_EIO, ex); }
+
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::SymbolicLinkNode::getTarget
+//
+// Gets the target of the symbolic link
+
+std::string ImageFileSystem::SymbolicLinkNode::getTarget(void) const
+{
+	try { return std::string(m_fs->m_image.GetName(m_node.start, m_node.size), static_cast<size_t>(m_node.size)); }
+	catch(Exception& ex) { throw LinuxException(LINUX_EIO, ex); }
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::SymbolicLinkNode::Open
+//
+// Creates a Handle instance against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this node was reached
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+std::shared_ptr<FileSystem::Handle> ImageFileSystem::SymbolicLinkNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+{
+	UNREFERENCED_PARAMETER(mount);
+	UNREFERENCED_PARAMETER(access);
+	UNREFERENCED_PARAMETER(flags);
+
+	// Symbolic links are followed during path resolution, they cannot be opened directly
+	throw LinuxException(LINUX_ELOOP);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::SymbolicLinkNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void ImageFileSystem::SymbolicLinkNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	UNREFERENCED_PARAMETER(uid);
+	UNREFERENCED_PARAMETER(gid);
+
+	throw LinuxException(LINUX_EROFS);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::SymbolicLinkNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void ImageFileSystem::SymbolicLinkNode::SetPermissions(uapi::mode_t permissions)
+{
+	UNREFERENCED_PARAMETER(permissions);
+
+	throw LinuxException(LINUX_EROFS);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::SymbolicLinkNode::Stat
+//
+// Provides statistical information about this node
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void ImageFileSystem::SymbolicLinkNode::Stat(uapi::stat* stats) const
+{
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	StatNode(stats);
+	stats->st_size = static_cast<decltype(stats->st_size)>(m_node.size);
+}
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem::SymbolicLinkNode::getType
+//
+// Gets the type of node represented by this object
+
+FileSystem::NodeType ImageFileSystem::SymbolicLinkNode::getType(void) const
+{
+	return FileSystem::NodeType::SymbolicLink;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
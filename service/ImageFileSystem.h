@@ -0,0 +1,653 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __IMAGEFILESYSTEM_H_
+#define __IMAGEFILESYSTEM_H_
+#pragma once
+
+#include <memory>
+#include "CompressedImage.h"
+#include "FileSystem.h"
+#include "MappedFileView.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// ImageFileSystem
+//
+// ImageFileSystem implements a read-only file system backed by a block-compressed
+// image file (see CompressedImage), similar in purpose to squashfs on Linux.
+//
+// The image file is memory-mapped rather than unpacked, only the metadata tables
+// that are actually touched are paged in and file data blocks are decompressed on
+// demand into a bounded cache.  Mounting an image does not depend on its size
+//
+// Supported mount options:
+//
+//	MS_KERNMOUNT
+//	MS_NODEV
+//	MS_NOEXEC
+//	MS_NOSUID
+//	MS_RDONLY (always set)
+//
+//	cache=nnn			- Sets the maximum number of decompressed blocks to cache
+//
+// Notes:
+//
+//	- The mount source is the host path to the image file.
+//
+//	- Device, pipe and socket nodes are enumerated but cannot be looked up.
+
+class ImageFileSystem
+{
+public:
+
+	// Instance Constructor
+	//
+	ImageFileSystem(const char_t* source, uint32_t flags, std::unique_ptr<MappedFileView>&& view, size_t cacheblocks);
+
+	// Destructor
+	//
+	~ImageFileSystem()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Mount (static)
+	//
+	// Creates an instance of the file system
+	static std::shared_ptr<FileSystem::Mount> Mount(const char_t* source, uint32_t flags, const void* data, size_t datalength);
+
+private:
+
+	ImageFileSystem(const ImageFileSystem&)=delete;
+	ImageFileSystem& operator=(const ImageFileSystem&)=delete;
+
+	// Forward Declarations
+	//
+	class DirectoryNode;
+	class FileNode;
+
+	// filepos_t
+	//
+	// File position shared among duplicated FileHandle instances
+	struct filepos_t
+	{
+		uapi::loff_t				offset = 0;		// Current file position
+		sync::critical_section		cs;				// Synchronization object
+	};
+
+	// ImageFileSystem::Alias
+	//
+	class Alias : public FileSystem::Alias
+	{
+	public:
+
+		// Instance Constructor
+		//
+		Alias(std::string&& name, std::shared_ptr<FileSystem::Node> node);
+
+		// Destructor
+		//
+		~Alias()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Alias Implementation
+
+		// GetName
+		//
+		// Reads the name assigned to this alias
+		virtual uapi::size_t GetName(char_t* buffer, size_t count) const override;
+
+		// Name
+		//
+		// Gets the name assigned to this alias
+		virtual std::string getName(void) const override;
+
+		// Node
+		//
+		// Gets the node to which this alias refers
+		virtual std::shared_ptr<FileSystem::Node> getNode(void) const override;
+
+	private:
+
+		Alias(const Alias&)=delete;
+		Alias& operator=(const Alias&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<FileSystem::Node>	m_node;		// Node instance
+		const std::string						m_name;		// Alias name to report
+	};
+
+	// ImageFileSystem::NodeBase
+	//
+	class NodeBase
+	{
+	public:
+
+		// Instance Constructor
+		//
+		NodeBase(std::shared_ptr<ImageFileSystem> fs, uint32_t index);
+
+		// Destructor
+		//
+		virtual ~NodeBase()=default;
+
+	protected:
+
+		//---------------------------------------------------------------------
+		// Protected Member Functions
+
+		// StatNode
+		//
+		// Provides the statistical information common to all node types
+		void StatNode(uapi::stat* stats) const;
+
+		//---------------------------------------------------------------------
+		// Protected Member Variables
+
+		const std::shared_ptr<ImageFileSystem>	m_fs;		// Parent file system instance
+		const uint32_t							m_index;	// Node table index
+		const image_node_t&						m_node;		// Node table entry
+
+	private:
+
+		NodeBase(const NodeBase&)=delete;
+		NodeBase& operator=(const NodeBase&)=delete;
+	};
+
+	// ImageFileSystem::DirectoryHandle
+	//
+	class DirectoryHandle : public FileSystem::Handle
+	{
+	public:
+
+		// Instance Constructor
+		//
+		DirectoryHandle(std::shared_ptr<DirectoryNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+
+		// Destructor
+		//
+		~DirectoryHandle()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Handle Implementation
+
+		// Duplicate
+		//
+		// Creates a duplicate Handle instance
+		virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+		// Read
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+		// ReadAt
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+		// Seek
+		//
+		// Changes the file position
+		virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+		// Sync
+		//
+		// Synchronizes all metadata and data associated with the file to storage
+		virtual void Sync(void) const override;
+
+		// SyncData
+		//
+		// Synchronizes all data associated with the file to storage, not metadata
+		virtual void SyncData(void) const override;
+
+		// Write
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+		// WriteAt
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+		// getAccess
+		//
+		// Gets the handle access mode
+		virtual FileSystem::HandleAccess getAccess(void) const override;
+
+		// getFlags
+		//
+		// Gets the handle flags
+		virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	private:
+
+		DirectoryHandle(const DirectoryHandle&)=delete;
+		DirectoryHandle& operator=(const DirectoryHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<DirectoryNode>	m_node;			// Directory node instance
+		const FileSystem::HandleAccess			m_access;		// Handle access mode
+		const FileSystem::HandleFlags			m_flags;		// Handle flags
+		uapi::loff_t							m_position;		// Current directory position
+		mutable sync::critical_section			m_cs;			// Synchronization object
+	};
+
+	// ImageFileSystem::DirectoryNode
+	//
+	class DirectoryNode : public NodeBase, public FileSystem::Directory, public std::enable_shared_from_this<DirectoryNode>
+	{
+	public:
+
+		// Instance Constructor
+		//
+		DirectoryNode(std::shared_ptr<ImageFileSystem> fs, uint32_t index, uint32_t parent);
+
+		// Destructor
+		//
+		virtual ~DirectoryNode()=default;
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// ReadDirectory
+		//
+		// Reads entries from the directory as packed linux_dirent64 structures
+		uapi::size_t ReadDirectory(uapi::loff_t& position, void* buffer, uapi::size_t count) const;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a Handle instance against this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about the node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// getType
+		//
+		// Gets the type of node being represented in the derived object instance
+		virtual FileSystem::NodeType getType(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Directory Implementation
+
+		// CreateDirectory
+		//
+		// Creates a new directory node as a child of this directory
+		virtual std::shared_ptr<FileSystem::Alias> CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+
+		// CreateFile
+		//
+		// Creates a new regular file node as a child of this directory
+		virtual std::shared_ptr<FileSystem::Alias> CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+
+		// Lookup
+		//
+		// Looks up the alias associated with a child of this node
+		virtual FileSystem::Result<std::shared_ptr<FileSystem::Alias>> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const override;
+
+	private:
+
+		DirectoryNode(const DirectoryNode&)=delete;
+		DirectoryNode& operator=(const DirectoryNode&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const uint32_t				m_parent;		// Parent directory node index
+	};
+
+	// ImageFileSystem::FileHandle
+	//
+	class FileHandle : public FileSystem::Handle
+	{
+	public:
+
+		// Instance Constructor
+		//
+		FileHandle(std::shared_ptr<const FileNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+
+		// Destructor
+		//
+		~FileHandle()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Handle Implementation
+
+		// Duplicate
+		//
+		// Creates a duplicate Handle instance
+		virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+		// Read
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+		// ReadAt
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+		// Seek
+		//
+		// Changes the file position
+		virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+		// Sync
+		//
+		// Synchronizes all metadata and data associated with the file to storage
+		virtual void Sync(void) const override;
+
+		// SyncData
+		//
+		// Synchronizes all data associated with the file to storage, not metadata
+		virtual void SyncData(void) const override;
+
+		// Write
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+		// WriteAt
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+		// getAccess
+		//
+		// Gets the handle access mode
+		virtual FileSystem::HandleAccess getAccess(void) const override;
+
+		// getFlags
+		//
+		// Gets the handle flags
+		virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	private:
+
+		FileHandle(const FileHandle&)=delete;
+		FileHandle& operator=(const FileHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<const FileNode>	m_node;			// File node instance
+		const FileSystem::HandleAccess			m_access;		// Handle access mode
+		const FileSystem::HandleFlags			m_flags;		// Handle flags
+		std::shared_ptr<filepos_t>				m_position;		// File position
+	};
+
+	// ImageFileSystem::FileNode
+	//
+	class FileNode : public NodeBase, public FileSystem::File, public std::enable_shared_from_this<FileNode>
+	{
+	public:
+
+		// Instance Constructor
+		//
+		FileNode(std::shared_ptr<ImageFileSystem> fs, uint32_t index);
+
+		// Destructor
+		//
+		virtual ~FileNode()=default;
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// Read
+		//
+		// Reads data from the file
+		uapi::size_t Read(uapi::loff_t offset, void* buffer, uapi::size_t count) const;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a Handle instance against this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about the node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// getType
+		//
+		// Gets the type of node being represented in the derived object instance
+		virtual FileSystem::NodeType getType(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::File Implementation
+
+		// OpenExec
+		//
+		// Creates an execute-only handle against this node
+		virtual std::shared_ptr<FileSystem::Handle> OpenExec(std::shared_ptr<FileSystem::Mount> mount) const override;
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Length
+		//
+		// Gets the length of the file data
+		__declspec(property(get=getLength)) uapi::loff_t Length;
+		uapi::loff_t getLength(void) const;
+
+	private:
+
+		FileNode(const FileNode&)=delete;
+		FileNode& operator=(const FileNode&)=delete;
+	};
+
+	// ImageFileSystem::SymbolicLinkNode
+	//
+	class SymbolicLinkNode : public NodeBase, public FileSystem::SymbolicLink
+	{
+	public:
+
+		// Instance Constructor
+		//
+		SymbolicLinkNode(std::shared_ptr<ImageFileSystem> fs, uint32_t index);
+
+		// Destructor
+		//
+		virtual ~SymbolicLinkNode()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a Handle instance against this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about the node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// getType
+		//
+		// Gets the type of node being represented in the derived object instance
+		virtual FileSystem::NodeType getType(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::SymbolicLink Implementation
+
+		// GetTarget
+		//
+		// Reads the target of the symbolic link
+		virtual uapi::size_t GetTarget(char_t* buffer, size_t count) const override;
+
+		// Target
+		//
+		// Gets the target of the symbolic link
+		virtual std::string getTarget(void) const override;
+
+	private:
+
+		SymbolicLinkNode(const SymbolicLinkNode&)=delete;
+		SymbolicLinkNode& operator=(const SymbolicLinkNode&)=delete;
+	};
+
+	// ImageFileSystem::Mount
+	//
+	class Mount : public FileSystem::Mount
+	{
+	public:
+
+		// Instance Constructor
+		//
+		Mount(std::shared_ptr<ImageFileSystem> fs, std::shared_ptr<DirectoryNode> root, uint32_t flags);
+
+		// Destructor
+		//
+		~Mount()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Mount Implementation
+
+		// Duplicate
+		//
+		// Duplicates this mount instance
+		virtual std::shared_ptr<FileSystem::Mount> Duplicate(void) const override;
+
+		// Remount
+		//
+		// Remounts this mount point with different flags and arguments
+		virtual void Remount(uint32_t flags, const void* data, size_t datalen) override;
+
+		// Stat
+		//
+		// Provides statistical information about the mounted file system
+		virtual void Stat(uapi::statfs* stats) const override;
+
+		// Unmount
+		//
+		// Unmounts the file system
+		virtual void Unmount(void) override;
+
+		// getFlags
+		//
+		// Gets the flags set on this mount, includes file system flags
+		virtual uint32_t getFlags(void) const override;
+
+		// getRoot
+		//
+		// Gets a reference to the root directory of the mount point
+		virtual std::shared_ptr<FileSystem::Directory> getRoot(void) const override;
+
+		// getSource
+		//
+		// Gets the device/name used as the source of the mount point
+		virtual std::string getSource(void) const override;
+
+	private:
+
+		Mount(const Mount&)=delete;
+		Mount& operator=(const Mount&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<ImageFileSystem>	m_fs;		// File system instance
+		const uint32_t							m_flags;	// Mounting flags
+		std::shared_ptr<DirectoryNode>			m_root;		// The root directory node
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// CreateNode (static)
+	//
+	// Creates the node instance for a node table entry
+	static std::shared_ptr<FileSystem::Node> CreateNode(std::shared_ptr<ImageFileSystem> fs, uint32_t index, uint32_t parent);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	const std::string						m_source;		// Source device string
+	const uint32_t							m_flags;		// File system flags
+	const uapi::fsid_t						m_fsid;			// File system unique identifier
+	const std::unique_ptr<MappedFileView>	m_view;			// Mapped image file view
+	CompressedImage							m_image;		// Image reader
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __IMAGEFILESYSTEM_H_
@@ -0,0 +1,563 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Inotify.h"
+
+#include "LinuxException.h"
+
+#pragma warning(push, 4)
+
+// INOTIFY_REMOVE_FLAGS
+//
+// IN_xxx flags that remove the watch after the event has been queued
+static const uint32_t INOTIFY_REMOVE_FLAGS = LINUX_IN_DELETE_SELF | LINUX_IN_UNMOUNT;
+
+// INOTIFY_UNMASKED_EVENTS
+//
+// IN_xxx events that are reported whether or not they have been requested
+static const uint32_t INOTIFY_UNMASKED_EVENTS = LINUX_IN_UNMOUNT | LINUX_IN_Q_OVERFLOW | LINUX_IN_IGNORED;
+
+//-----------------------------------------------------------------------------
+// Inotify Constructor
+//
+// Arguments:
+//
+//	flags		- Handle flags
+
+Inotify::Inotify(FileSystem::HandleFlags flags) : m_flags(flags), m_nextwd(1)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Inotify Destructor
+
+Inotify::~Inotify()
+{
+	// Detach the watches from the watched nodes
+	for(const auto& iterator : m_watches) Unwatch(iterator.second);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess Inotify::getAccess(void) const
+{
+	return FileSystem::HandleAccess::ReadOnly;
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::AddWatch
+//
+// Adds a watch for a node or modifies an existing watch, returns the watch descriptor
+//
+// Arguments:
+//
+//	node		- Node to be watched
+//	mask		- Requested IN_xxx events and flags
+
+int Inotify::AddWatch(std::shared_ptr<FileSystem::Node> node, uint32_t mask)
+{
+	if(!node) throw LinuxException(LINUX_EINVAL);
+
+	// At least one event must be requested, and IN_MASK_ADD cannot be combined with IN_MASK_CREATE
+	if((mask & LINUX_IN_ALL_EVENTS) == 0) throw LinuxException(LINUX_EINVAL);
+	if((mask & LINUX_IN_MASK_ADD) && (mask & LINUX_IN_MASK_CREATE)) throw LinuxException(LINUX_EINVAL);
+
+	if((mask & LINUX_IN_ONLYDIR) && (node->Type != FileSystem::NodeType::Directory)) throw LinuxException(LINUX_ENOTDIR);
+
+	// Only the events and IN_ONESHOT are retained by the watch
+	uint32_t watchmask = mask & (LINUX_IN_ALL_EVENTS | LINUX_IN_ONESHOT);
+
+	std::shared_ptr<watch_t> watch;
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		// A node can only be watched once per instance; an existing watch is modified in place
+		auto found = m_nodes.find(node.get());
+		if(found != m_nodes.end()) {
+
+			if(mask & LINUX_IN_MASK_CREATE) throw LinuxException(LINUX_EEXIST);
+
+			auto& existing = m_watches[found->second];
+			existing->mask = (mask & LINUX_IN_MASK_ADD) ? (existing->mask | watchmask) : watchmask;
+
+			return found->second;
+		}
+
+		if(m_watches.size() >= LINUX_INOTIFY_MAX_USER_WATCHES) throw LinuxException(LINUX_ENOSPC);
+
+		// Watch descriptors are not reused until the counter wraps around
+		while(m_watches.count(m_nextwd)) m_nextwd = (m_nextwd == INT_MAX) ? 1 : m_nextwd + 1;
+		int wd = m_nextwd;
+		m_nextwd = (m_nextwd == INT_MAX) ? 1 : m_nextwd + 1;
+
+		watch = std::make_shared<watch_t>(shared_from_this(), wd, node, watchmask);
+		m_watches.emplace(wd, watch);
+		m_nodes.emplace(node.get(), wd);
+	}
+
+	// Register with the node outside of the lock; nodes notify their watchers while holding
+	// their own locks and would otherwise deadlock against a concurrent Read()
+	auto watchable = std::dynamic_pointer_cast<FileSystem::Watchable>(node);
+	if(watchable) watchable->Watch(watch);
+
+	return watch->wd;
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Create (static)
+//
+// Creates a new inotify instance
+//
+// Arguments:
+//
+//	flags		- Handle flags
+
+std::shared_ptr<Inotify> Inotify::Create(FileSystem::HandleFlags flags)
+{
+	return std::make_shared<Inotify>(flags);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> Inotify::Duplicate(void) const
+{
+	// Duplicated descriptors refer to the same inotify instance
+	return std::const_pointer_cast<Inotify>(shared_from_this());
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Enqueue (private)
+//
+// Queues an event for a watch and removes the watch if it has ended
+//
+// Arguments:
+//
+//	watch		- Watch that has been notified
+//	mask		- IN_xxx events that occurred
+//	cookie		- Cookie that relates IN_MOVED_FROM and IN_MOVED_TO events
+//	name		- Name of the child that changed, or nullptr for the node itself
+
+void Inotify::Enqueue(watch_t* watch, uint32_t mask, uint32_t cookie, const char_t* name)
+{
+	std::shared_ptr<watch_t>	ended;				// Watch that has been removed
+	bool						queued = false;		// Flag if an event was queued
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		if(watch->removed) return;
+
+		// An overflow reported by the node means that changes were lost; it is not specific
+		// to this watch and is reported to the reader with a watch descriptor of -1
+		if(mask & LINUX_IN_Q_OVERFLOW) queued = Push(-1, LINUX_IN_Q_OVERFLOW, 0, nullptr);
+
+		uint32_t events = mask & (watch->mask | INOTIFY_UNMASKED_EVENTS) & ~LINUX_IN_Q_OVERFLOW;
+		if(events) queued |= Push(watch->wd, events | (mask & LINUX_IN_ISDIR), cookie, name);
+
+		// The watch ends when the node goes away or after the first event if IN_ONESHOT was set
+		if((mask & INOTIFY_REMOVE_FLAGS) || (events && (watch->mask & LINUX_IN_ONESHOT))) {
+
+			auto found = m_watches.find(watch->wd);
+			if(found != m_watches.end()) {
+
+				ended = found->second;
+				ended->removed = true;
+
+				m_nodes.erase(ended->node.get());
+				m_watches.erase(found);
+
+				queued |= Push(ended->wd, LINUX_IN_IGNORED, 0, nullptr);
+			}
+		}
+
+		if(queued) m_signal.notify_all();
+	}
+
+	// Inotify instances are pollable; waiters are signaled without the lock held
+	if(queued) m_pollqueue.Notify(LINUX_POLLIN | LINUX_POLLRDNORM);
+
+	// The node notifies watchers after releasing its own lock, so this cannot deadlock
+	if(ended) Unwatch(ended);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::getFlags
+//
+// Gets the flags specified on the handle
+
+FileSystem::HandleFlags Inotify::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Poll
+//
+// Gets the current POLLxxx readiness of the handle
+//
+// Arguments:
+//
+//	NONE
+
+uint32_t Inotify::Poll(void) const
+{
+	std::unique_lock<std::mutex> critsec{ m_lock };
+	return (m_events.empty()) ? 0 : LINUX_POLLIN | LINUX_POLLRDNORM;
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Push (private)
+//
+// Appends an event to the queue; the lock must be held
+//
+// Arguments:
+//
+//	wd			- Watch descriptor
+//	mask		- IN_xxx event mask
+//	cookie		- Cookie that relates IN_MOVED_FROM and IN_MOVED_TO events
+//	name		- Name of the child that changed, or nullptr
+
+bool Inotify::Push(int wd, uint32_t mask, uint32_t cookie, const char_t* name)
+{
+	event_t event{ wd, mask, cookie, (name) ? name : "" };
+
+	// An event identical to the last unread event is coalesced into it
+	if(!m_events.empty() && (m_events.back() == event)) return false;
+
+	// Once the queue is full a single overflow event takes the place of everything else
+	if(m_events.size() >= LINUX_INOTIFY_MAX_QUEUED_EVENTS) {
+
+		if(m_events.back().mask == LINUX_IN_Q_OVERFLOW) return false;
+		event = event_t{ -1, LINUX_IN_Q_OVERFLOW, 0, std::string() };
+	}
+
+	m_events.push_back(std::move(event));
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t Inotify::Read(void* buffer, uapi::size_t count)
+{
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	while(m_events.empty()) {
+
+		if(m_flags & FileSystem::HandleFlags::NonBlocking) throw LinuxException(LINUX_EAGAIN);
+
+		// todo: this needs to be interrupted by pending signals (EINTR)
+		m_signal.wait(critsec);
+	}
+
+	uint8_t* next = reinterpret_cast<uint8_t*>(buffer);
+	uapi::size_t written = 0;
+
+	// Copy as many complete events as will fit into the buffer
+	while(!m_events.empty()) {
+
+		const event_t& event = m_events.front();
+
+		// The name is null terminated and padded to keep the next event aligned
+		size_t namelength = (event.name.empty()) ? 0 : align::up(event.name.size() + 1, sizeof(uapi::inotify_event));
+		size_t length = sizeof(uapi::inotify_event) + namelength;
+		if(written + length > count) break;
+
+		auto header = reinterpret_cast<uapi::inotify_event*>(next);
+		header->wd = event.wd;
+		header->mask = event.mask;
+		header->cookie = event.cookie;
+		header->len = static_cast<uint32_t>(namelength);
+
+		if(namelength) {
+
+			memcpy(next + sizeof(uapi::inotify_event), event.name.data(), event.name.size());
+			memset(next + sizeof(uapi::inotify_event) + event.name.size(), 0, namelength - event.name.size());
+		}
+
+		next += length;
+		written += length;
+		m_events.pop_front();
+	}
+
+	// The buffer must be large enough to hold at least the next event
+	if(written == 0) throw LinuxException(LINUX_EINVAL);
+
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t Inotify::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t Inotify::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ENOTDIR);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::RemoveWatch
+//
+// Removes a watch from the inotify instance
+//
+// Arguments:
+//
+//	wd			- Watch descriptor
+
+void Inotify::RemoveWatch(int wd)
+{
+	std::shared_ptr<watch_t>	watch;			// Watch being removed
+	bool						queued;			// Flag if IN_IGNORED was queued
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		auto found = m_watches.find(wd);
+		if(found == m_watches.end()) throw LinuxException(LINUX_EINVAL);
+
+		watch = found->second;
+		watch->removed = true;
+
+		m_nodes.erase(watch->node.get());
+		m_watches.erase(found);
+
+		// Removing a watch generates IN_IGNORED the same as a watch that ended on its own
+		queued = Push(wd, LINUX_IN_IGNORED, 0, nullptr);
+		if(queued) m_signal.notify_all();
+	}
+
+	if(queued) m_pollqueue.Notify(LINUX_POLLIN | LINUX_POLLRDNORM);
+	Unwatch(watch);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset into the node data to seek, relative to whence
+//	whence		- Position in the node data that offset is relative to
+
+uapi::loff_t Inotify::Seek(uapi::loff_t offset, int whence)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(whence);
+
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Subscribe
+//
+// Registers a waiter to be signaled when the readiness of the handle changes
+//
+// Arguments:
+//
+//	waiter		- Waiter to be registered
+
+void Inotify::Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter)
+{
+	m_pollqueue.Subscribe(std::move(waiter));
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void Inotify::Sync(void) const
+{
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void Inotify::SyncData(void) const
+{
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Unsubscribe
+//
+// Removes a previously registered waiter
+//
+// Arguments:
+//
+//	waiter		- Waiter to be removed
+
+void Inotify::Unsubscribe(const FileSystem::PollWaiter* waiter)
+{
+	m_pollqueue.Unsubscribe(waiter);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Unwatch (private, static)
+//
+// Unregisters a removed watch from the watched node
+//
+// Arguments:
+//
+//	watch		- Watch that has been removed
+
+void Inotify::Unwatch(const std::shared_ptr<watch_t>& watch)
+{
+	auto watchable = std::dynamic_pointer_cast<FileSystem::Watchable>(watch->node);
+	if(watchable) watchable->Unwatch(watch.get());
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::watch_t Constructor
+//
+// Arguments:
+//
+//	owner		- Owning inotify instance
+//	wd			- Watch descriptor
+//	node		- Watched node
+//	mask		- Requested IN_xxx events and flags
+
+Inotify::watch_t::watch_t(std::weak_ptr<Inotify> owner, int wd, std::shared_ptr<FileSystem::Node> node, uint32_t mask) :
+	owner(std::move(owner)), wd(wd), node(std::move(node)), mask(mask), removed(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::watch_t::Notify
+//
+// Indicates that the watched node or a child of the watched node has changed
+//
+// Arguments:
+//
+//	mask		- IN_xxx events that occurred
+//	cookie		- Cookie that relates IN_MOVED_FROM and IN_MOVED_TO events
+//	name		- Name of the child that changed, or nullptr for the node itself
+
+void Inotify::watch_t::Notify(uint32_t mask, uint32_t cookie, const char_t* name)
+{
+	auto instance = owner.lock();
+	if(instance) instance->Enqueue(this, mask, cookie, name);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	count		- Number of bytes to write
+
+uapi::size_t Inotify::Write(const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// Inotify::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source buffer
+//	count		- Number of bytes to write
+
+uapi::size_t Inotify::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
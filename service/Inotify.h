@@ -0,0 +1,246 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __INOTIFY_H_
+#define __INOTIFY_H_
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "FileSystem.h"
+#include "PollQueue.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// Inotify
+//
+// Inotify implements inotify instances.  An Inotify is itself the Handle that is
+// placed into the descriptor table for inotify_init1(), the inotify system calls
+// access it through a dynamic_pointer_cast<>.
+//
+// Each watch holds a reference to the watched node and is registered with it as
+// a FileSystem::NotifyWatcher if the node implements FileSystem::Watchable.  The
+// in-memory file systems generate events for changes made from within the virtual
+// machine; HostFileSystem reports the changes made to its backing directory on the
+// host, which includes the changes made from within the virtual machine.  An event
+// that is identical to the most recent unread event is coalesced into it, the same
+// as Linux, which absorbs the bursts of duplicate notifications the host generates
+// for a single write.
+//
+// Notes:
+//
+//	- Watches can be placed on any node, but only nodes that implement Watchable
+//	  generate events; this matches Linux for pseudo file systems like procfs.
+//
+//	- The queue is limited to INOTIFY_MAX_QUEUED_EVENTS; further events are dropped
+//	  and a single IN_Q_OVERFLOW event is queued in their place.
+
+class Inotify : public FileSystem::Handle, public FileSystem::Pollable, public std::enable_shared_from_this<Inotify>
+{
+public:
+
+	// Instance Constructor
+	//
+	explicit Inotify(FileSystem::HandleFlags flags);
+
+	// Destructor
+	//
+	~Inotify();
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// AddWatch
+	//
+	// Adds a watch for a node or modifies an existing watch, returns the watch descriptor
+	int AddWatch(std::shared_ptr<FileSystem::Node> node, uint32_t mask);
+
+	// Create (static)
+	//
+	// Creates a new inotify instance
+	static std::shared_ptr<Inotify> Create(FileSystem::HandleFlags flags);
+
+	// RemoveWatch
+	//
+	// Removes a watch from the inotify instance
+	void RemoveWatch(int wd);
+
+	//-------------------------------------------------------------------------
+	// FileSystem::Handle Implementation
+
+	// Duplicate
+	//
+	// Creates a duplicate Handle instance
+	virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+	// Read
+	//
+	// Synchronously reads data from the underlying node into a buffer
+	virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+	// ReadAt
+	//
+	// Synchronously reads data from the underlying node into a buffer
+	virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+	// ReadDirectory
+	//
+	// Reads entries from the underlying directory node as packed linux_dirent64 structures
+	virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+	// Seek
+	//
+	// Changes the file position
+	virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+	// Sync
+	//
+	// Synchronizes all metadata and data associated with the file to storage
+	virtual void Sync(void) const override;
+
+	// SyncData
+	//
+	// Synchronizes all data associated with the file to storage, not metadata
+	virtual void SyncData(void) const override;
+
+	// Write
+	//
+	// Synchronously writes data from a buffer to the underlying node
+	virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+	// WriteAt
+	//
+	// Synchronously writes data from a buffer to the underlying node
+	virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+	// Access
+	//
+	// Gets the access mode used when the handle was created
+	virtual FileSystem::HandleAccess getAccess(void) const override;
+
+	// Flags
+	//
+	// Gets the flags used when the handle was created
+	virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	//-------------------------------------------------------------------------
+	// FileSystem::Pollable Implementation
+
+	// Poll
+	//
+	// Gets the current POLLxxx readiness of the handle
+	virtual uint32_t Poll(void) const override;
+
+	// Subscribe
+	//
+	// Registers a waiter to be signaled when the readiness of the handle changes
+	virtual void Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter) override;
+
+	// Unsubscribe
+	//
+	// Removes a previously registered waiter
+	virtual void Unsubscribe(const FileSystem::PollWaiter* waiter) override;
+
+private:
+
+	Inotify(const Inotify&)=delete;
+	Inotify& operator=(const Inotify&)=delete;
+
+	// event_t
+	//
+	// Queued event
+	struct event_t
+	{
+		int									wd;			// Watch descriptor
+		uint32_t							mask;		// IN_xxx event mask
+		uint32_t							cookie;		// IN_MOVED_FROM/IN_MOVED_TO cookie
+		std::string							name;		// Child name, if any
+
+		bool operator==(const event_t& rhs) const
+		{
+			return (wd == rhs.wd) && (mask == rhs.mask) && (cookie == rhs.cookie) && (name == rhs.name);
+		}
+	};
+
+	// watch_t
+	//
+	// Watch placed on a node
+	struct watch_t : public FileSystem::NotifyWatcher
+	{
+		// Instance Constructor
+		//
+		watch_t(std::weak_ptr<Inotify> owner, int wd, std::shared_ptr<FileSystem::Node> node, uint32_t mask);
+
+		// Notify
+		//
+		// Indicates that the watched node or a child of the watched node has changed
+		virtual void Notify(uint32_t mask, uint32_t cookie, const char_t* name) override;
+
+		const std::weak_ptr<Inotify>				owner;		// Owning inotify instance
+		const int									wd;			// Watch descriptor
+		const std::shared_ptr<FileSystem::Node>		node;		// Watched node
+		uint32_t									mask;		// Requested IN_xxx events and flags
+		bool										removed;	// Watch has been removed
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// Enqueue
+	//
+	// Queues an event for a watch and removes the watch if it has ended
+	void Enqueue(watch_t* watch, uint32_t mask, uint32_t cookie, const char_t* name);
+
+	// Push
+	//
+	// Appends an event to the queue; the lock must be held
+	bool Push(int wd, uint32_t mask, uint32_t cookie, const char_t* name);
+
+	// Unwatch (static)
+	//
+	// Unregisters a removed watch from the watched node
+	static void Unwatch(const std::shared_ptr<watch_t>& watch);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	const FileSystem::HandleFlags						m_flags;		// Handle flags
+	std::map<int, std::shared_ptr<watch_t>>				m_watches;		// Watches, by descriptor
+	std::unordered_map<const FileSystem::Node*, int>	m_nodes;		// Watch descriptors, by node
+	std::deque<event_t>									m_events;		// Queued events
+	int													m_nextwd;		// Next watch descriptor
+	mutable std::mutex									m_lock;			// Synchronization object
+	std::condition_variable								m_signal;		// Queued event signal
+	PollQueue											m_pollqueue;	// Readiness waiters
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __INOTIFY_H_
@@ -0,0 +1,395 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "IoEngine.h"
+
+#include "Win32Exception.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// IoEngine Constructor (private)
+//
+// Arguments:
+//
+//	NONE
+
+IoEngine::IoEngine() : m_completed(0), m_outstanding(0), m_peak(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Bind (static)
+//
+// Associates a host handle opened for overlapped I/O with an engine instance
+//
+// Arguments:
+//
+//	engine		- IoEngine instance to bind the handle to
+//	handle		- Host handle opened with FILE_FLAG_OVERLAPPED
+
+std::unique_ptr<IoEngine::Channel> IoEngine::Bind(std::shared_ptr<IoEngine> const& engine, HANDLE handle)
+{
+	if(!engine) throw Win32Exception(ERROR_INVALID_PARAMETER);
+	return std::make_unique<Channel>(engine, handle);
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::getCompleted
+//
+// Gets the total number of operations that have completed
+
+uint64_t IoEngine::getCompleted(void) const
+{
+	return m_completed;
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Create (static)
+//
+// Creates a new IoEngine instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<IoEngine> IoEngine::Create(void)
+{
+	return std::make_shared<IoEngine>();
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::OnComplete (private)
+//
+// Updates the counters when an operation has completed
+//
+// Arguments:
+//
+//	NONE
+
+void IoEngine::OnComplete(void)
+{
+	--m_outstanding;
+	++m_completed;
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::OnIssue (private)
+//
+// Updates the counters when an operation has been issued
+//
+// Arguments:
+//
+//	NONE
+
+void IoEngine::OnIssue(void)
+{
+	uint32_t outstanding = ++m_outstanding;
+	uint32_t peak = m_peak;
+
+	// Replace the peak value unless another thread has already set a higher one
+	while((outstanding > peak) && !m_peak.compare_exchange_weak(peak, outstanding));
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::getOutstanding
+//
+// Gets the number of operations that have been issued but not completed
+
+uint32_t IoEngine::getOutstanding(void) const
+{
+	return m_outstanding;
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::getPeakOutstanding
+//
+// Gets the highest number of operations that have been outstanding at once
+
+uint32_t IoEngine::getPeakOutstanding(void) const
+{
+	return m_peak;
+}
+
+//
+// IOENGINE::CHANNEL
+//
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel Constructor
+//
+// Arguments:
+//
+//	engine		- Parent IoEngine instance
+//	handle		- Host handle opened with FILE_FLAG_OVERLAPPED
+
+IoEngine::Channel::Channel(std::shared_ptr<IoEngine> engine, HANDLE handle) : m_engine(std::move(engine)), m_handle(handle)
+{
+	if((handle == nullptr) || (handle == INVALID_HANDLE_VALUE)) throw Win32Exception(ERROR_INVALID_HANDLE);
+
+	// Every operation is tracked through the completion port, there is no need to signal the handle
+	if(!SetFileCompletionNotificationModes(handle, FILE_SKIP_SET_EVENT_ON_HANDLE)) throw Win32Exception();
+
+	// Associate the handle with the completion port serviced by the process thread pool
+	m_io = CreateThreadpoolIo(handle, IoCompletion, this, nullptr);
+	if(m_io == nullptr) throw Win32Exception();
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel Destructor
+
+IoEngine::Channel::~Channel()
+{
+	// Cancel anything still outstanding against the handle and wait for the callbacks to finish
+	CancelIoEx(m_handle, nullptr);
+	WaitForThreadpoolIoCallbacks(m_io, FALSE);
+	CloseThreadpoolIo(m_io);
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel::Begin (private)
+//
+// Issues an asynchronous read or write operation
+//
+// Arguments:
+//
+//	write		- Flag indicating a write rather than a read operation
+//	offset		- Offset into the file, or EndOfFile to append a write
+//	buffer		- Source or destination buffer
+//	count		- Number of bytes to read or write
+//	completion	- Function to invoke when the operation has completed
+
+void IoEngine::Channel::Begin(bool write, uapi::loff_t offset, void* buffer, DWORD count, completion_t completion)
+{
+	auto operation = std::make_unique<operation_t>();
+	memset(&operation->overlapped, 0, sizeof(OVERLAPPED));
+
+	// EndOfFile (-1) sets both offset fields to 0xFFFFFFFF, which the host interprets as an append
+	operation->overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+	operation->overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+	operation->completion = std::move(completion);
+
+	// StartThreadpoolIo must be called prior to every operation issued against the handle
+	StartThreadpoolIo(m_io);
+	m_engine->OnIssue();
+
+	BOOL result = (write) ? WriteFile(m_handle, buffer, count, nullptr, &operation->overlapped) : ReadFile(m_handle, buffer, count, nullptr, &operation->overlapped);
+
+	// Both immediate success and ERROR_IO_PENDING will queue a completion to the thread pool, which
+	// takes over ownership of the operation state
+	DWORD error = (result) ? ERROR_SUCCESS : GetLastError();
+	if((error == ERROR_SUCCESS) || (error == ERROR_IO_PENDING)) { operation.release(); return; }
+
+	// The operation failed immediately and no completion will be queued, invoke it from here
+	CancelThreadpoolIo(m_io);
+	m_engine->OnComplete();
+	operation->completion(error, 0);
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel::BeginRead
+//
+// Issues an asynchronous read operation
+//
+// Arguments:
+//
+//	offset		- Offset into the file to begin reading
+//	buffer		- Destination buffer, must remain valid until completion
+//	count		- Number of bytes to read
+//	completion	- Function to invoke when the operation has completed
+
+void IoEngine::Channel::BeginRead(uapi::loff_t offset, void* buffer, DWORD count, completion_t completion)
+{
+	Begin(false, offset, buffer, count, std::move(completion));
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel::BeginWrite
+//
+// Issues an asynchronous write operation
+//
+// Arguments:
+//
+//	offset		- Offset into the file to begin writing, or EndOfFile
+//	buffer		- Source buffer, must remain valid until completion
+//	count		- Number of bytes to write
+//	completion	- Function to invoke when the operation has completed
+
+void IoEngine::Channel::BeginWrite(uapi::loff_t offset, const void* buffer, DWORD count, completion_t completion)
+{
+	Begin(true, offset, const_cast<void*>(buffer), count, std::move(completion));
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel::Control
+//
+// Issues a device control operation and waits for it to complete
+//
+// Arguments:
+//
+//	code		- Device control code
+//	in			- Optional input buffer
+//	inlength	- Length of the input buffer, in bytes
+//	out			- Optional output buffer
+//	outlength	- Length of the output buffer, in bytes
+
+DWORD IoEngine::Channel::Control(DWORD code, const void* in, DWORD inlength, void* out, DWORD outlength)
+{
+	DWORD				result = ERROR_SUCCESS;		// Operation result code
+	uapi::size_t		transferred = 0;			// Number of bytes transferred
+
+	HANDLE event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if(event == nullptr) throw Win32Exception();
+
+	try {
+
+		auto operation = std::make_unique<operation_t>();
+		memset(&operation->overlapped, 0, sizeof(OVERLAPPED));
+		operation->completion = [&](DWORD error, uapi::size_t bytes) { result = error; transferred = bytes; SetEvent(event); };
+
+		// Device control operations are tracked through the completion port the same as reads and writes
+		StartThreadpoolIo(m_io);
+		m_engine->OnIssue();
+
+		BOOL succeeded = DeviceIoControl(m_handle, code, const_cast<void*>(in), inlength, out, outlength, nullptr, &operation->overlapped);
+
+		DWORD error = (succeeded) ? ERROR_SUCCESS : GetLastError();
+		if((error == ERROR_SUCCESS) || (error == ERROR_IO_PENDING)) operation.release();
+		else {
+
+			// The operation failed immediately and no completion will be queued
+			CancelThreadpoolIo(m_io);
+			m_engine->OnComplete();
+			operation->completion(error, 0);
+		}
+	}
+
+	catch(...) { CloseHandle(event); throw; }
+
+	WaitForSingleObject(event, INFINITE);
+	CloseHandle(event);
+
+	if(result != ERROR_SUCCESS) throw Win32Exception(result);
+
+	return static_cast<DWORD>(transferred);
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel::IoCompletion (private, static)
+//
+// Thread pool I/O completion callback
+//
+// Arguments:
+//
+//	instance	- Callback instance
+//	context		- Channel instance pointer
+//	overlapped	- OVERLAPPED structure of the completed operation
+//	result		- Win32 result code of the operation
+//	transferred	- Number of bytes transferred by the operation
+//	io			- Thread pool I/O object
+
+void CALLBACK IoEngine::Channel::IoCompletion(PTP_CALLBACK_INSTANCE instance, PVOID context, PVOID overlapped, ULONG result, ULONG_PTR transferred, PTP_IO io)
+{
+	UNREFERENCED_PARAMETER(instance);
+	UNREFERENCED_PARAMETER(io);
+
+	Channel* channel = reinterpret_cast<Channel*>(context);
+	_ASSERTE(channel);
+
+	// Take back ownership of the operation state that was released when it was issued
+	std::unique_ptr<operation_t> operation(CONTAINING_RECORD(reinterpret_cast<OVERLAPPED*>(overlapped), operation_t, overlapped));
+	channel->m_engine->OnComplete();
+
+	// Exceptions cannot be allowed to propagate into the thread pool
+	try { operation->completion(result, static_cast<uapi::size_t>(transferred)); }
+	catch(...) { /* DISCARD */ }
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel::Read
+//
+// Issues a read operation and waits for it to complete
+//
+// Arguments:
+//
+//	offset		- Offset into the file to begin reading
+//	buffer		- Destination buffer
+//	count		- Number of bytes to read
+
+DWORD IoEngine::Channel::Read(uapi::loff_t offset, void* buffer, DWORD count)
+{
+	return Wait(false, offset, buffer, count);
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel::Wait (private)
+//
+// Issues an operation and waits for it to complete
+//
+// Arguments:
+//
+//	write		- Flag indicating a write rather than a read operation
+//	offset		- Offset into the file, or EndOfFile to append a write
+//	buffer		- Source or destination buffer
+//	count		- Number of bytes to read or write
+
+DWORD IoEngine::Channel::Wait(bool write, uapi::loff_t offset, void* buffer, DWORD count)
+{
+	DWORD				result = ERROR_SUCCESS;		// Operation result code
+	uapi::size_t		transferred = 0;			// Number of bytes transferred
+
+	HANDLE event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if(event == nullptr) throw Win32Exception();
+
+	try { Begin(write, offset, buffer, count, [&](DWORD code, uapi::size_t bytes) { result = code; transferred = bytes; SetEvent(event); }); }
+	catch(...) { CloseHandle(event); throw; }
+
+	WaitForSingleObject(event, INFINITE);
+	CloseHandle(event);
+
+	// Reads that begin at or beyond the end of the file complete with ERROR_HANDLE_EOF
+	if((result == ERROR_HANDLE_EOF) && (!write)) return 0;
+	if(result != ERROR_SUCCESS) throw Win32Exception(result);
+
+	return static_cast<DWORD>(transferred);
+}
+
+//-----------------------------------------------------------------------------
+// IoEngine::Channel::Write
+//
+// Issues a write operation and waits for it to complete
+//
+// Arguments:
+//
+//	offset		- Offset into the file to begin writing, or EndOfFile
+//	buffer		- Source buffer
+//	count		- Number of bytes to write
+
+DWORD IoEngine::Channel::Write(uapi::loff_t offset, const void* buffer, DWORD count)
+{
+	return Wait(true, offset, const_cast<void*>(buffer), count);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
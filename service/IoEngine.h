@@ -0,0 +1,223 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __IOENGINE_H_
+#define __IOENGINE_H_
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// IoEngine
+//
+// Issues overlapped host I/O and dispatches the completions from the process
+// thread pool, which services an I/O completion port on behalf of the engine.
+// A single instance is owned by each virtual machine so that the number of
+// outstanding operations can be tracked per virtual machine.
+//
+// Host handles must be opened with FILE_FLAG_OVERLAPPED and bound to the engine
+// through a Channel before any operations can be issued against them.  Each file
+// object can only be associated with a single completion port, so duplicated
+// handles must be reopened rather than bound a second time.
+
+class IoEngine
+{
+public:
+
+	// Forward Declarations
+	//
+	class Channel;
+
+	// completion_t
+	//
+	// Function invoked when an asynchronous operation has completed
+	using completion_t = std::function<void(DWORD result, uapi::size_t transferred)>;
+
+	// Destructor
+	//
+	~IoEngine()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Bind (static)
+	//
+	// Associates a host handle opened for overlapped I/O with an engine instance
+	static std::unique_ptr<Channel> Bind(std::shared_ptr<IoEngine> const& engine, HANDLE handle);
+
+	// Create (static)
+	//
+	// Creates a new IoEngine instance
+	static std::shared_ptr<IoEngine> Create(void);
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Completed
+	//
+	// Gets the total number of operations that have completed
+	__declspec(property(get=getCompleted)) uint64_t Completed;
+	uint64_t getCompleted(void) const;
+
+	// Outstanding
+	//
+	// Gets the number of operations that have been issued but not completed
+	__declspec(property(get=getOutstanding)) uint32_t Outstanding;
+	uint32_t getOutstanding(void) const;
+
+	// PeakOutstanding
+	//
+	// Gets the highest number of operations that have been outstanding at once
+	__declspec(property(get=getPeakOutstanding)) uint32_t PeakOutstanding;
+	uint32_t getPeakOutstanding(void) const;
+
+	// IoEngine::Channel
+	//
+	// Issues overlapped operations against a single bound host handle
+	class Channel
+	{
+	public:
+
+		// Instance Constructor
+		//
+		Channel(std::shared_ptr<IoEngine> engine, HANDLE handle);
+
+		// Destructor
+		//
+		~Channel();
+
+		//---------------------------------------------------------------------
+		// Fields
+
+		// EndOfFile (static)
+		//
+		// Offset value that causes a write operation to append to the file
+		static const uapi::loff_t EndOfFile = -1;
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// BeginRead
+		//
+		// Issues an asynchronous read operation
+		void BeginRead(uapi::loff_t offset, void* buffer, DWORD count, completion_t completion);
+
+		// BeginWrite
+		//
+		// Issues an asynchronous write operation
+		void BeginWrite(uapi::loff_t offset, const void* buffer, DWORD count, completion_t completion);
+
+		// Control
+		//
+		// Issues a device control operation and waits for it to complete
+		DWORD Control(DWORD code, const void* in, DWORD inlength, void* out, DWORD outlength);
+
+		// Read
+		//
+		// Issues a read operation and waits for it to complete
+		DWORD Read(uapi::loff_t offset, void* buffer, DWORD count);
+
+		// Write
+		//
+		// Issues a write operation and waits for it to complete
+		DWORD Write(uapi::loff_t offset, const void* buffer, DWORD count);
+
+	private:
+
+		Channel(Channel const&)=delete;
+		Channel& operator=(Channel const&)=delete;
+
+		//---------------------------------------------------------------------
+		// Private Member Functions
+
+		// Begin
+		//
+		// Issues an asynchronous read or write operation
+		void Begin(bool write, uapi::loff_t offset, void* buffer, DWORD count, completion_t completion);
+
+		// IoCompletion (static)
+		//
+		// Thread pool I/O completion callback
+		static void CALLBACK IoCompletion(PTP_CALLBACK_INSTANCE instance, PVOID context, PVOID overlapped, ULONG result, ULONG_PTR transferred, PTP_IO io);
+
+		// Wait
+		//
+		// Issues an operation and waits for it to complete
+		DWORD Wait(bool write, uapi::loff_t offset, void* buffer, DWORD count);
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		std::shared_ptr<IoEngine> const		m_engine;		// Parent engine instance
+		HANDLE const						m_handle;		// Bound host handle
+		PTP_IO								m_io;			// Thread pool I/O object
+	};
+
+private:
+
+	IoEngine(IoEngine const&)=delete;
+	IoEngine& operator=(IoEngine const&)=delete;
+
+	// operation_t
+	//
+	// State for a single outstanding operation
+	struct operation_t
+	{
+		OVERLAPPED					overlapped;		// Overlapped I/O structure
+		completion_t				completion;		// Completion callback
+	};
+
+	// Instance Constructor
+	//
+	IoEngine();
+	friend class std::_Ref_count_obj<IoEngine>;
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// OnComplete
+	//
+	// Updates the counters when an operation has completed
+	void OnComplete(void);
+
+	// OnIssue
+	//
+	// Updates the counters when an operation has been issued
+	void OnIssue(void);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	std::atomic<uint64_t>			m_completed;		// Completed operations
+	std::atomic<uint32_t>			m_outstanding;		// Outstanding operations
+	std::atomic<uint32_t>			m_peak;				// Peak outstanding operations
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __IOENGINE_H_
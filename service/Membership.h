@@ -0,0 +1,196 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __MEMBERSHIP_H_
+#define __MEMBERSHIP_H_
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// Membership
+//
+// Implements a collection of weak references to member objects, keyed by the
+// address of the member so that it can be removed after the member expires
+//
+// Adding and removing a member is O(1) under the lock.  Readers walk a snapshot
+// vector that is built on demand from the members; writers only discard the
+// snapshot, so a fork()/exit() storm never copies the collection and the cost
+// of building a new snapshot is paid once by the next broadcast
+
+template <typename _type>
+class Membership
+{
+public:
+
+	// snapshot_t
+	//
+	// Immutable snapshot of the collection members
+	using snapshot_t = std::shared_ptr<std::vector<std::weak_ptr<_type>> const>;
+
+	// Instance Constructor
+	//
+	Membership()=default;
+
+	// Destructor
+	//
+	~Membership()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Add
+	//
+	// Adds a member to the collection; adding an existing member has no effect
+	void Add(std::shared_ptr<_type> const& member)
+	{
+		sync::critical_section::scoped_lock cs{ m_cs };
+		if(m_members.emplace(member.get(), member).second) std::atomic_store(&m_snapshot, snapshot_t());
+	}
+
+	// Move (static)
+	//
+	// Moves a member from one collection into another; returns false if the
+	// member does not exist in the source collection
+	static bool Move(Membership& source, Membership& dest, _type const* member)
+	{
+		if(&source == &dest) return source.Contains(member);
+
+		// Acquire the locks in a consistent order to prevent a deadlock with a concurrent
+		// move operation going in the opposite direction
+		Membership* first = (&source < &dest) ? &source : &dest;
+		Membership* second = (&source < &dest) ? &dest : &source;
+
+		sync::critical_section::scoped_lock csfirst{ first->m_cs };
+		sync::critical_section::scoped_lock cssecond{ second->m_cs };
+
+		auto found = source.m_members.find(member);
+		if(found == source.m_members.end()) return false;
+
+		dest.m_members.emplace(member, std::move(found->second));
+		source.m_members.erase(found);
+
+		// Both snapshots are discarded under both locks, so a snapshot built after the move
+		// never contains the member in both collections
+		std::atomic_store(&source.m_snapshot, snapshot_t());
+		std::atomic_store(&dest.m_snapshot, snapshot_t());
+
+		return true;
+	}
+
+	// Remove
+	//
+	// Removes a member from the collection
+	void Remove(_type const* member)
+	{
+		sync::critical_section::scoped_lock cs{ m_cs };
+		if(m_members.erase(member)) std::atomic_store(&m_snapshot, snapshot_t());
+	}
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Members
+	//
+	// Gets the live members of the collection
+	__declspec(property(get=getMembers)) std::vector<std::shared_ptr<_type>> Members;
+	std::vector<std::shared_ptr<_type>> getMembers(void) const
+	{
+		std::vector<std::shared_ptr<_type>>	members;		// Live member instances
+
+		auto snapshot = getSnapshot();
+		members.reserve(snapshot->size());
+
+		for(auto const& weak : *snapshot) {
+
+			auto member = weak.lock();
+			if(member) members.push_back(std::move(member));
+		}
+
+		return members;
+	}
+
+	// Snapshot
+	//
+	// Gets the current snapshot of the collection, building it if necessary
+	__declspec(property(get=getSnapshot)) snapshot_t Snapshot;
+	snapshot_t getSnapshot(void) const
+	{
+		auto snapshot = std::atomic_load(&m_snapshot);
+		if(snapshot) return snapshot;
+
+		sync::critical_section::scoped_lock cs{ m_cs };
+
+		// Another reader may have built the snapshot while waiting for the lock
+		snapshot = std::atomic_load(&m_snapshot);
+		if(snapshot) return snapshot;
+
+		auto members = std::make_shared<std::vector<std::weak_ptr<_type>>>();
+		members->reserve(m_members.size());
+		for(auto const& iterator : m_members) members->push_back(iterator.second);
+
+		snapshot = std::move(members);
+		std::atomic_store(&m_snapshot, snapshot);
+
+		return snapshot;
+	}
+
+private:
+
+	Membership(Membership const&)=delete;
+	Membership& operator=(Membership const&)=delete;
+
+	// member_map_t
+	//
+	// Collection of members, keyed by the member instance address
+	using member_map_t = std::unordered_map<_type const*, std::weak_ptr<_type>>;
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// Contains
+	//
+	// Determines if a member exists in the collection
+	bool Contains(_type const* member) const
+	{
+		sync::critical_section::scoped_lock cs{ m_cs };
+		return m_members.find(member) != m_members.end();
+	}
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	member_map_t					m_members;		// Collection of members
+	mutable snapshot_t				m_snapshot;		// Cached member snapshot
+	mutable sync::critical_section	m_cs;			// Synchronization object
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __MEMBERSHIP_H_
@@ -35,6 +35,8 @@
 
 MountNamespace::MountNamespace(mount_map_t&& mounts) : m_mounts(std::move(mounts)) 
 {
+	// Generate the mount point filter from the initial collection of mounts
+	RebuildFilter();
 }
 
 //-----------------------------------------------------------------------------
@@ -54,6 +56,10 @@ void MountNamespace::Add(std::shared_ptr<FileSystem::Alias> alias, std::shared_p
 	// Push the mount to the top of the stack associated with this alias
 	try { m_mounts[alias].emplace(std::move(mount)); }
 	catch(...) { throw LinuxException(LINUX_ENOMEM); }
+
+	// Set the filter bit for the alias so that Find() will check the collection
+	auto index = FilterIndex(alias.get());
+	m_filter[index / 64].fetch_or(1ui64 << (index % 64));
 }
 
 //-----------------------------------------------------------------------------
@@ -69,7 +75,8 @@ std::shared_ptr<MountNamespace> MountNamespace::Clone(void)
 {
 	mount_map_lock_t::scoped_lock_write writer(m_mountslock);
 
-	// Create a copy of the contained mounts collection for the new namespace
+	// Create a copy of the contained mounts collection for the new namespace, the
+	// mount point filter is regenerated from the copy during construction
 	return std::make_shared<MountNamespace>(mount_map_t(m_mounts));
 }
 
@@ -99,6 +106,10 @@ std::shared_ptr<MountNamespace> MountNamespace::Create(void)
 
 std::shared_ptr<FileSystem::Mount> MountNamespace::Find(std::shared_ptr<const FileSystem::Alias> alias)
 {
+	// If the filter bit for the alias is clear, it cannot be a mount point
+	auto index = FilterIndex(alias.get());
+	if((m_filter[index / 64].load() & (1ui64 << (index % 64))) == 0) return nullptr;
+
 	mount_map_lock_t::scoped_lock_read reader(m_mountslock);
 
 	// Check if this alias is a mount point, and if so return the topmost mount
@@ -130,10 +141,50 @@ void MountNamespace::Remove(std::shared_ptr<const FileSystem::Alias> alias)
 		// Remove the topmost mount instance from the stack, if that reduces
 		// the size of the stack to zero, remove the entire entry
 		iterator->second.pop();
-		if(iterator->second.empty()) m_mounts.erase(iterator);
+		if(iterator->second.empty()) { m_mounts.erase(iterator); RebuildFilter(); }
 	}
 }
 
+//-----------------------------------------------------------------------------
+// MountNamespace::FilterIndex (private, static)
+//
+// Gets the mount point filter bit index for an alias
+//
+// Arguments:
+//
+//	alias		- Alias instance to get the filter bit index for
+
+size_t MountNamespace::FilterIndex(const FileSystem::Alias* alias)
+{
+	// Alias instances are at least pointer aligned, discard the low bits before hashing
+	return std::hash<uintptr_t>()(reinterpret_cast<uintptr_t>(alias) >> 4) % FilterBits;
+}
+
+//-----------------------------------------------------------------------------
+// MountNamespace::RebuildFilter (private)
+//
+// Regenerates the mount point filter from the mounts collection; must be called
+// with the mounts collection lock held for write or during construction
+//
+// Arguments:
+//
+//	NONE
+
+void MountNamespace::RebuildFilter(void)
+{
+	std::array<uint64_t, FilterBits / 64> filter{};		// New filter bitmap
+
+	for(const auto& iterator : m_mounts) {
+
+		auto index = FilterIndex(iterator.first.get());
+		filter[index / 64] |= (1ui64 << (index % 64));
+	}
+
+	// The regenerated filter is always a subset of the existing filter, so Find() will
+	// never miss a remaining mount point regardless of the order the words are stored in
+	for(size_t index = 0; index < filter.size(); index++) m_filter[index].store(filter[index]);
+}
+
 //-----------------------------------------------------------------------------
 
 #pragma warning(pop)
@@ -24,6 +24,8 @@
 #define __MOUNTNAMESPACE_H_
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <stack>
 #include <unordered_map>
@@ -36,6 +38,11 @@
 // MountNamespace
 //
 // Provides an isolated view of file system mounts
+//
+// Almost none of the aliases passed into Find() during path resolution are mount
+// points, so each namespace maintains a small bitmap filter of alias hashes that
+// may be mount points.  A clear bit in the filter allows Find() to return without
+// acquiring the lock or hashing into the mounts collection
 
 class MountNamespace
 {
@@ -88,15 +95,39 @@ private:
 	// Synchronization object used with mount_map_t collection
 	using mount_map_lock_t = sync::reader_writer_lock;
 
+	// FilterBits
+	//
+	// Number of bits in the mount point filter
+	static const size_t FilterBits = 4096;
+
+	// filter_t
+	//
+	// Bitmap filter of alias hashes that may be mount points
+	using filter_t = std::array<std::atomic<uint64_t>, FilterBits / 64>;
+
 	// Instance Constructor
 	//
 	MountNamespace(mount_map_t&& mounts);
 	friend class std::_Ref_count_obj<MountNamespace>;
 
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// FilterIndex (static)
+	//
+	// Gets the mount point filter bit index for an alias
+	static size_t FilterIndex(const FileSystem::Alias* alias);
+
+	// RebuildFilter
+	//
+	// Regenerates the mount point filter from the mounts collection
+	void RebuildFilter(void);
+
 	//-------------------------------------------------------------------------
 	// Member Variables
 
 	mount_map_t					m_mounts;			// Collection of mounts
+	filter_t					m_filter;			// Mount point filter
 	mount_map_lock_t			m_mountslock;		// Synchronization object
 };
 
@@ -30,12 +30,13 @@
 //
 // Arguments:
 //
+//	dentries	- DentryCache instance to contain
 //	mountns		- MountNamespace instance to contain
 //	pidns		- PidNamespace instance to contain
 //	utsns		- UtsNamespace instance to contain
 
-Namespace::Namespace(const std::shared_ptr<MountNamespace>& mountns, const std::shared_ptr<PidNamespace>& pidns, 
-	const std::shared_ptr<UtsNamespace>& utsns) : m_mountns(mountns), m_pidns(pidns), m_utsns(utsns)
+Namespace::Namespace(const std::shared_ptr<DentryCache>& dentries, const std::shared_ptr<MountNamespace>& mountns, const std::shared_ptr<PidNamespace>& pidns, 
+	const std::shared_ptr<UtsNamespace>& utsns) : m_dentries(dentries), m_mountns(mountns), m_pidns(pidns), m_utsns(utsns)
 {
 }
 
@@ -74,8 +75,9 @@ std::shared_ptr<Namespace> Namespace::Clone(int flags)
 	// UTSNAMESPACE
 	auto utsns = (flags & LINUX_CLONE_NEWUTS) ? UtsNamespace::Create(m_utsns) : m_utsns;
 
-	// Construct the new Namespace with the selected individual components
-	return std::make_shared<Namespace>(mountns, pidns, utsns);
+	// Construct the new Namespace with the selected individual components, the dentry
+	// cache is not namespace specific and is always shared with the new namespace
+	return std::make_shared<Namespace>(m_dentries, mountns, pidns, utsns);
 }
 
 //-----------------------------------------------------------------------------
@@ -89,7 +91,17 @@ std::shared_ptr<Namespace> Namespace::Clone(int flags)
 
 std::shared_ptr<Namespace> Namespace::Create(void)
 {
-	return std::make_shared<Namespace>(MountNamespace::Create(), PidNamespace::Create(), UtsNamespace::Create());
+	return std::make_shared<Namespace>(DentryCache::Create(), MountNamespace::Create(), PidNamespace::Create(), UtsNamespace::Create());
+}
+
+//-----------------------------------------------------------------------------
+// Namespace::getDentries
+//
+// Accesses the contained DentryCache instance
+
+std::shared_ptr<DentryCache> Namespace::getDentries(void) const
+{
+	return m_dentries;
 }
 
 //-----------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <memory>
+#include "DentryCache.h"
 #include "MountNamespace.h"
 #include "PidNamespace.h"
 #include "UtsNamespace.h"
@@ -69,6 +70,12 @@ public:
 	//-------------------------------------------------------------------------
 	// Properties
 
+	// Dentries
+	//
+	// Accesses the contained DentryCache instance, this is shared by all namespaces
+	__declspec(property(get=getDentries)) std::shared_ptr<DentryCache> Dentries;
+	std::shared_ptr<DentryCache> getDentries(void) const;
+
 	// Mounts
 	//
 	// Accesses the contained MountNamespace instance
@@ -99,12 +106,14 @@ private:
 
 	// Instance Constructor
 	//
-	Namespace(const std::shared_ptr<MountNamespace>& mountns, const std::shared_ptr<PidNamespace>& pidns, const std::shared_ptr<UtsNamespace>& utsns);
+	Namespace(const std::shared_ptr<DentryCache>& dentries, const std::shared_ptr<MountNamespace>& mountns, const std::shared_ptr<PidNamespace>& pidns, 
+		const std::shared_ptr<UtsNamespace>& utsns);
 	friend class std::_Ref_count_obj<Namespace>;
 
 	//-------------------------------------------------------------------------
 	// Member Variables
 
+	const std::shared_ptr<DentryCache>		m_dentries;		// DentryCache
 	const std::shared_ptr<MountNamespace>	m_mountns;		// MountNamespace
 	const std::shared_ptr<PidNamespace>		m_pidns;		// PidNamespace
 	const std::shared_ptr<UtsNamespace>		m_utsns;		// UtsNamespace
@@ -290,6 +290,30 @@ DWORD NativeProcess::getExitCode(void) const
 	else return result;
 }
 
+//-----------------------------------------------------------------------------
+// NativeProcess::GetSectionOffset
+//
+// Gets the section object that contains an address and the offset of the address into it;
+// processes that share a section can use this to identify the same memory (shared futexes)
+//
+// Arguments:
+//
+//	address		- Address within the native process
+
+std::pair<HANDLE, uintptr_t> NativeProcess::GetSectionOffset(uintptr_t address) const
+{
+	sync::reader_writer_lock::scoped_lock_read reader(m_sectionslock);
+
+	for(auto const& section : m_sections) {
+
+		if((address >= section.m_baseaddress) && (address < (section.m_baseaddress + section.m_length))) 
+			return std::make_pair(section.m_section, address - section.m_baseaddress);
+	}
+
+	// The address has not been reserved in the process
+	throw LinuxException{ LINUX_EFAULT };
+}
+
 //-----------------------------------------------------------------------------
 // NativeProcess::IterateRange (private)
 //
@@ -26,6 +26,7 @@
 
 #include <set>
 #include <unordered_map>
+#include <utility>
 #include "Architecture.h"
 #include "Bitmap.h"
 #include "ProcessMemory.h"
@@ -68,6 +69,11 @@ public:
 	//-------------------------------------------------------------------------
 	// Member Functions
 
+	// GetSectionOffset
+	//
+	// Gets the section object that contains an address and the offset of the address into it
+	std::pair<HANDLE, uintptr_t> GetSectionOffset(uintptr_t address) const;
+
 	// Resume
 	//
 	// Resumes the process
@@ -23,6 +23,9 @@
 #include "stdafx.h"
 #include "NativeThread.h"
 
+#include "LinuxException.h"
+#include "Win32Exception.h"
+
 #pragma warning(push, 4)
 
 //-----------------------------------------------------------------------------
@@ -57,6 +60,61 @@ enum class Architecture NativeThread::getArchitecture(void) const
 	return m_architecture;
 }
 
+//-----------------------------------------------------------------------------
+// NativeThread::getThreadHandle
+//
+// Gets the native thread handle
+
+HANDLE NativeThread::getThreadHandle(void) const
+{
+	return m_thread;
+}
+
+//-----------------------------------------------------------------------------
+// NativeThread::getThreadId
+//
+// Gets the native thread identifier
+
+DWORD NativeThread::getThreadId(void) const
+{
+	return m_threadid;
+}
+
+//-----------------------------------------------------------------------------
+// NativeThread::Resume
+//
+// Resumes the thread
+//
+// Arguments:
+//
+//	NONE
+
+void NativeThread::Resume(void) const
+{
+	if(ResumeThread(m_thread) == static_cast<DWORD>(-1)) throw LinuxException{ LINUX_ESRCH, Win32Exception{} };
+}
+
+//-----------------------------------------------------------------------------
+// NativeThread::Suspend
+//
+// Suspends the thread
+//
+// Arguments:
+//
+//	NONE
+
+void NativeThread::Suspend(void) const
+{
+	// Wow64SuspendThread must be used for a 32-bit thread when running as 64-bit
+#ifdef _M_X64
+	DWORD result = (m_architecture == Architecture::x86) ? Wow64SuspendThread(m_thread) : SuspendThread(m_thread);
+#else
+	DWORD result = SuspendThread(m_thread);
+#endif
+
+	if(result == static_cast<DWORD>(-1)) throw LinuxException{ LINUX_ESRCH, Win32Exception{} };
+}
+
 //-----------------------------------------------------------------------------
 
 #pragma warning(pop)
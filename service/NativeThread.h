@@ -49,6 +49,16 @@ public:
 	//-------------------------------------------------------------------------
 	// Member Functions
 
+	// Resume
+	//
+	// Resumes the thread
+	void Resume(void) const;
+
+	// Suspend
+	//
+	// Suspends the thread
+	void Suspend(void) const;
+
 	//-------------------------------------------------------------------------
 	// Properties
 
@@ -58,6 +68,18 @@ public:
 	__declspec(property(get=getArchitecture)) enum class Architecture Architecture;
 	enum class Architecture getArchitecture(void) const;
 
+	// ThreadHandle
+	//
+	// Gets the native thread handle
+	__declspec(property(get=getThreadHandle)) HANDLE ThreadHandle;
+	HANDLE getThreadHandle(void) const;
+
+	// ThreadId
+	//
+	// Gets the native thread identifier
+	__declspec(property(get=getThreadId)) DWORD ThreadId;
+	DWORD getThreadId(void) const;
+
 private:
 
 	NativeThread(NativeThread const&)=delete;
@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "NotifyQueue.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// NotifyQueue Constructor
+//
+// Arguments:
+//
+//	NONE
+
+NotifyQueue::NotifyQueue() : m_count(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// NotifyQueue::getEmpty
+//
+// Indicates if there are no registered watchers
+
+bool NotifyQueue::getEmpty(void) const
+{
+	return m_count.load(std::memory_order_relaxed) == 0;
+}
+
+//-----------------------------------------------------------------------------
+// NotifyQueue::Notify
+//
+// Notifies all registered watchers that the node has changed
+//
+// Arguments:
+//
+//	mask		- IN_xxx events that occurred
+//	cookie		- Cookie that relates IN_MOVED_FROM and IN_MOVED_TO events
+//	name		- Name of the child that changed, or nullptr for the node itself
+
+void NotifyQueue::Notify(uint32_t mask, uint32_t cookie, const char_t* name)
+{
+	std::vector<std::shared_ptr<FileSystem::NotifyWatcher>>	watchers;	// Watchers to be notified
+
+	// Nodes are rarely watched; avoid the lock entirely when there is nobody to notify
+	if(m_count.load(std::memory_order_relaxed) == 0) return;
+
+	// Take strong references to the live watchers and discard any that have expired
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		watchers.reserve(m_watchers.size());
+		for(auto iterator = m_watchers.begin(); iterator != m_watchers.end();) {
+
+			auto watcher = iterator->second.lock();
+			if(watcher) { watchers.push_back(std::move(watcher)); ++iterator; }
+			else iterator = m_watchers.erase(iterator);
+		}
+
+		m_count = m_watchers.size();
+	}
+
+	// Notify the watchers without holding the queue lock
+	for(const auto& watcher : watchers) watcher->Notify(mask, cookie, name);
+}
+
+//-----------------------------------------------------------------------------
+// NotifyQueue::Unwatch
+//
+// Removes a previously registered watcher
+//
+// Arguments:
+//
+//	watcher		- Watcher to be removed
+
+void NotifyQueue::Unwatch(const FileSystem::NotifyWatcher* watcher)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	for(auto iterator = m_watchers.begin(); iterator != m_watchers.end(); ++iterator) {
+
+		if(iterator->first == watcher) { m_watchers.erase(iterator); break; }
+	}
+
+	m_count = m_watchers.size();
+}
+
+//-----------------------------------------------------------------------------
+// NotifyQueue::Watch
+//
+// Registers a watcher to be notified when the node changes
+//
+// Arguments:
+//
+//	watcher		- Watcher to be registered
+
+void NotifyQueue::Watch(std::shared_ptr<FileSystem::NotifyWatcher> watcher)
+{
+	if(!watcher) return;
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	m_watchers.emplace_back(watcher.get(), watcher);
+	m_count = m_watchers.size();
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
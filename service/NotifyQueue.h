@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __NOTIFYQUEUE_H_
+#define __NOTIFYQUEUE_H_
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "FileSystem.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// NotifyQueue
+//
+// Collection of FileSystem::NotifyWatcher instances that are notified when a node
+// changes.  A node that implements FileSystem::Watchable owns a NotifyQueue and
+// calls Notify() after each change that it makes.
+//
+// Notify() is called from hot paths such as file writes, so the common case of a
+// node without any watchers is checked without acquiring the queue lock.  Watchers
+// are held weakly and are notified after the queue lock has been released, so a
+// watcher may register or unregister from within Notify() without deadlocking.
+
+class NotifyQueue
+{
+public:
+
+	// Instance Constructor
+	//
+	NotifyQueue();
+
+	// Destructor
+	//
+	~NotifyQueue()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Notify
+	//
+	// Notifies all registered watchers that the node has changed
+	void Notify(uint32_t mask, uint32_t cookie = 0, const char_t* name = nullptr);
+
+	// Unwatch
+	//
+	// Removes a previously registered watcher
+	void Unwatch(const FileSystem::NotifyWatcher* watcher);
+
+	// Watch
+	//
+	// Registers a watcher to be notified when the node changes
+	void Watch(std::shared_ptr<FileSystem::NotifyWatcher> watcher);
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Empty
+	//
+	// Indicates if there are no registered watchers
+	__declspec(property(get=getEmpty)) bool Empty;
+	bool getEmpty(void) const;
+
+private:
+
+	NotifyQueue(const NotifyQueue&)=delete;
+	NotifyQueue& operator=(const NotifyQueue&)=delete;
+
+	// watcher_t
+	//
+	// Registered watcher and the address used to identify it
+	using watcher_t = std::pair<const FileSystem::NotifyWatcher*, std::weak_ptr<FileSystem::NotifyWatcher>>;
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	std::vector<watcher_t>				m_watchers;		// Registered watchers
+	std::atomic<size_t>					m_count;		// Number of registered watchers
+	sync::critical_section				m_cs;			// Synchronization object
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __NOTIFYQUEUE_H_
@@ -0,0 +1,1291 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "OverlayFileSystem.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include "Capability.h"
+#include "FilePermission.h"
+#include "LinuxException.h"
+#include "MountOptions.h"
+#include "TempFileSystem.h"
+
+#pragma warning(push, 4)
+
+// COPY_BUFFER_SIZE
+//
+// Size of the buffer used to copy file data from a lower layer into the upper layer
+static const size_t COPY_BUFFER_SIZE = (64 KiB);
+
+// DIRECTORY_BUFFER_SIZE
+//
+// Size of the buffer used to enumerate the entries of a layer directory
+static const size_t DIRECTORY_BUFFER_SIZE = (16 KiB);
+
+// OPAQUE_MARKER
+//
+// Name of the file that marks a directory as opaque
+static const char_t OPAQUE_MARKER[] = ".wh..wh..opq";
+
+// WHITEOUT_PREFIX
+//
+// Prefix applied to the name of a file that hides a name in the lower layers
+static const char_t WHITEOUT_PREFIX[] = ".wh.";
+
+// WHITEOUT_PREFIX_LENGTH
+//
+// Length of the whiteout prefix string, in characters
+static const size_t WHITEOUT_PREFIX_LENGTH = sizeof(WHITEOUT_PREFIX) / sizeof(char_t) - 1;
+
+//-----------------------------------------------------------------------------
+// PackDirectoryEntry (local)
+//
+// Packs a single linux_dirent64 structure into an output buffer, returns zero
+// if the structure will not fit into the remaining buffer space
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Remaining length of the destination buffer, in bytes
+//	ino			- Node index number
+//	offset		- Position of the next entry in the directory
+//	type		- Entry type (DT_xxx)
+//	name		- Entry name
+//	namelength	- Length of the entry name, in bytes
+
+static uapi::size_t PackDirectoryEntry(void* buffer, uapi::size_t count, uint64_t ino, uapi::loff_t offset, uint8_t type, 
+	const char_t* name, size_t namelength)
+{
+	uapi::size_t reclen = align::up(offsetof(uapi::dirent64, d_name) + namelength + 1, 8);
+	if(reclen > count) return 0;
+
+	auto dirent = reinterpret_cast<uapi::dirent64*>(buffer);
+	memset(dirent, 0, reclen);
+	dirent->d_ino = ino;
+	dirent->d_off = offset;
+	dirent->d_reclen = static_cast<uint16_t>(reclen);
+	dirent->d_type = type;
+	memcpy(dirent->d_name, name, namelength);
+
+	return reclen;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem Constructor
+//
+// Arguments:
+//
+//	source		- Source device name, as provided to Mount()
+//	flags		- File system flags and options
+//	upper		- Upper (writable) layer mount
+//	lowers		- Lower (read-only) layer mounts, topmost first
+
+OverlayFileSystem::OverlayFileSystem(const char_t* source, uint32_t flags, std::shared_ptr<FileSystem::Mount> upper, 
+	std::vector<std::shared_ptr<FileSystem::Mount>>&& lowers) : m_source(source), m_flags(flags), m_fsid(FileSystem::GenerateFileSystemId()), 
+	m_upper(std::move(upper)), m_lowers(std::move(lowers))
+{
+	// No mount-specific flags should be specified for the file system instance
+	_ASSERTE((flags & LINUX_MS_PERMOUNT_MASK) == 0);
+	_ASSERTE(m_upper);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::IsWhiteout (private, static)
+//
+// Determines if a name is reserved for a whiteout or opaque directory marker
+//
+// Arguments:
+//
+//	name		- Name to be checked
+
+bool OverlayFileSystem::IsWhiteout(const char_t* name)
+{
+	_ASSERTE(name);
+	return (strncmp(name, WHITEOUT_PREFIX, WHITEOUT_PREFIX_LENGTH) == 0);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount (static)
+//
+// Mounts the file system
+//
+// Arguments:
+//
+//	layerfs		- Mount function used to access the layer directories
+//	source		- Source device string
+//	flags		- Standard mounting flags and attributes
+//	data		- Additional file-system specific mounting options
+//	datalength	- Length of the extended mounting options data
+
+std::shared_ptr<FileSystem::Mount> OverlayFileSystem::Mount(FileSystem::MountFunction layerfs, const char_t* source, uint32_t flags, const void* data, size_t datalength)
+{
+	std::vector<std::string>	lowerdirs;			// Lower layer paths
+	std::string					upperdir;			// Upper layer path
+
+	if(source == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	Capability::Demand(Capability::SystemAdmin);
+
+	// Parse the provided mounting options
+	MountOptions options(flags, data, datalength);
+
+	// Break up the standard mounting options bitmask into file system and mount specific masks
+	auto fsflags = options.Flags & (LINUX_MS_RDONLY | LINUX_MS_KERNMOUNT);
+	auto mountflags = options.Flags & LINUX_MS_PERMOUNT_MASK;
+
+	// lowerdir=
+	//
+	// Sets the lower layer paths, separated by semicolons with the topmost layer first
+	for(auto const& value : options.Arguments.GetValues("lowerdir")) {
+
+		for(size_t start = 0; start <= value.length();) {
+
+			size_t end = value.find(';', start);
+			if(end == std::string::npos) end = value.length();
+
+			if(end > start) lowerdirs.emplace_back(value.substr(start, end - start));
+			start = end + 1;
+		}
+	}
+
+	// upperdir=
+	//
+	// Sets the upper layer path
+	if(options.Arguments.Contains("upperdir")) upperdir = options.Arguments["upperdir"];
+
+	// At least one lower layer must be specified
+	if(lowerdirs.empty()) throw LinuxException(LINUX_EINVAL);
+
+	// Mount each of the lower layers as read-only instances of the layer file system
+	std::vector<std::shared_ptr<FileSystem::Mount>> lowers;
+	for(auto const& lowerdir : lowerdirs) lowers.emplace_back(layerfs(lowerdir.c_str(), LINUX_MS_RDONLY | LINUX_MS_KERNMOUNT, nullptr, 0));
+
+	// The upper layer is either a writable instance of the layer file system or an anonymous tmpfs
+	auto upper = (upperdir.empty()) ? TempFileSystem::Mount(source, LINUX_MS_KERNMOUNT, nullptr, 0) : 
+		layerfs(upperdir.c_str(), LINUX_MS_KERNMOUNT, nullptr, 0);
+
+	// A read-only upper layer can only be used to construct a read-only overlay
+	if((upper->Flags & LINUX_MS_RDONLY) && ((fsflags & LINUX_MS_RDONLY) == 0)) throw LinuxException(LINUX_EROFS);
+
+	// The root directory is the merge of the root directories of each layer
+	auto upperroot = upper->Root;
+	layerdirs_t lowerroots;
+	for(auto const& lower : lowers) lowerroots.emplace_back(lower->Root);
+
+	// Construct the file system instance and the root directory node instance
+	auto fs = std::make_shared<OverlayFileSystem>(source, fsflags, std::move(upper), std::move(lowers));
+	auto rootdir = std::make_shared<DirectoryNode>(fs, nullptr, "", std::move(upperroot), std::move(lowerroots));
+
+	// Construct and return the mount instance
+	return std::make_shared<class Mount>(fs, rootdir, mountflags);
+}
+
+//
+// OVERLAYFILESYSTEM::ALIAS
+//
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Alias Constructor
+//
+// Arguments:
+//
+//	name			- Name to assign to this alias
+//	node			- Node to attach to this alias
+
+OverlayFileSystem::Alias::Alias(const char_t* name, std::shared_ptr<FileSystem::Node> node) : m_node(std::move(node)), m_name(name)
+{
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Alias::GetName
+//
+// Reads the name assigned to this alias
+//
+// Arguments:
+//
+//	buffer			- Output buffer
+//	count			- Size of the output buffer, in bytes
+
+uapi::size_t OverlayFileSystem::Alias::GetName(char_t* buffer, size_t count) const
+{
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Copy the minimum of the name length or the output buffer size
+	count = std::min(m_name.size(), count);
+	memcpy(buffer, m_name.data(), count * sizeof(char_t));
+	
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Alias::getName
+//
+// Gets the name assigned to this alias
+
+std::string OverlayFileSystem::Alias::getName(void) const
+{
+	return std::string(m_name);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Alias::getNode
+//
+// Gets the node to which this alias refers
+
+std::shared_ptr<FileSystem::Node> OverlayFileSystem::Alias::getNode(void) const
+{
+	return m_node;
+}
+
+//
+// OVERLAYFILESYSTEM::DIRECTORYHANDLE
+//
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle Constructor
+//
+// Arguments:
+//
+//	node		- Directory node instance
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+OverlayFileSystem::DirectoryHandle::DirectoryHandle(std::shared_ptr<DirectoryNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+	: m_node(std::move(node)), m_access(access), m_flags(flags), m_position(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess OverlayFileSystem::DirectoryHandle::getAccess(void) const
+{
+	return m_access;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> OverlayFileSystem::DirectoryHandle::Duplicate(void) const
+{
+	auto handle = std::make_shared<DirectoryHandle>(m_node, m_access, m_flags);
+
+	// The duplicate handle continues enumerating the same set of entries from the current position
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	handle->m_entries = m_entries;
+	handle->m_position = m_position;
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::getFlags
+//
+// Gets the flags specified on the handle
+
+FileSystem::HandleFlags OverlayFileSystem::DirectoryHandle::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t OverlayFileSystem::DirectoryHandle::Read(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t OverlayFileSystem::DirectoryHandle::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t OverlayFileSystem::DirectoryHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	uint8_t*				dest = reinterpret_cast<uint8_t*>(buffer);		// Destination pointer
+	uapi::size_t			written = 0;									// Bytes written to the buffer
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// The merged entries are generated when the directory is first read and whenever it has
+	// been rewound, the position is the index of the next merged entry to be returned
+	if((m_position == 0) || (m_entries.empty())) m_entries = m_node->Enumerate();
+
+	while(static_cast<size_t>(m_position) < m_entries.size()) {
+
+		auto const& entry = m_entries[static_cast<size_t>(m_position)];
+
+		uapi::size_t reclen = PackDirectoryEntry(dest + written, count - written, entry.ino, m_position + 1, entry.type, 
+			entry.name.c_str(), entry.name.length());
+
+		if(reclen == 0) { if(written == 0) throw LinuxException(LINUX_EINVAL); break; }
+
+		written += reclen;
+		++m_position;
+	}
+
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset (relative to whence) to position the file pointer
+//	whence		- Flag indicating the file position from which offset applies
+
+uapi::loff_t OverlayFileSystem::DirectoryHandle::Seek(uapi::loff_t offset, int whence)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// Directory positions are merged entry indexes; SEEK_SET can be used to rewind the
+	// directory or to return to a d_off value, SEEK_CUR can only report the position
+	if((whence == LINUX_SEEK_SET) && (offset >= 0)) return (m_position = offset);
+	if((whence == LINUX_SEEK_CUR) && (offset == 0)) return m_position;
+
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void OverlayFileSystem::DirectoryHandle::Sync(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void OverlayFileSystem::DirectoryHandle::SyncData(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	count		- Maximum number of bytes to write
+
+uapi::size_t OverlayFileSystem::DirectoryHandle::Write(const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryHandle::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source buffer
+//	count		- Maximum number of bytes to write
+
+uapi::size_t OverlayFileSystem::DirectoryHandle::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
+}
+
+//
+// OVERLAYFILESYSTEM::DIRECTORYNODE
+//
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	parent		- Parent directory node, or null for the root directory
+//	name		- Name of the directory within the parent directory
+//	upper		- Upper layer directory, or null if not present
+//	lowers		- Lower layer directories, indexed by layer
+
+OverlayFileSystem::DirectoryNode::DirectoryNode(std::shared_ptr<OverlayFileSystem> fs, std::shared_ptr<DirectoryNode> parent, const char_t* name, 
+	std::shared_ptr<FileSystem::Directory> upper, layerdirs_t&& lowers) : m_fs(std::move(fs)), m_parent(std::move(parent)), m_name(name), 
+	m_upper(std::move(upper)), m_lowers(std::move(lowers))
+{
+	_ASSERTE(m_lowers.size() == m_fs->m_lowers.size());
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::CopyUp
+//
+// Ensures that this directory exists in the upper layer
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Directory> OverlayFileSystem::DirectoryNode::CopyUp(void)
+{
+	uapi::stat				stats;			// Lower layer directory attributes
+
+	// Copy-up operations are serialized, this also protects the parent chain
+	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
+
+	if(m_fs->m_flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	auto upper = Upper;
+	if(upper) return upper;
+
+	// The root directory always exists in the upper layer
+	_ASSERTE(m_parent);
+
+	// The attributes of the directory are taken from the topmost lower layer that contains it
+	auto lower = std::find_if(m_lowers.begin(), m_lowers.end(), [](const std::shared_ptr<FileSystem::Directory>& dir) -> bool { return static_cast<bool>(dir); });
+	_ASSERTE(lower != m_lowers.end());
+	(*lower)->Stat(&stats);
+
+	// Create the directory in the upper layer, the parent directory has to be copied up first
+	auto alias = m_parent->CopyUp()->CreateDirectory(m_fs->m_upper, m_name.c_str(), stats.st_mode & LINUX_S_IALLUGO);
+	upper = std::dynamic_pointer_cast<FileSystem::Directory>(alias->Node);
+	if(!upper) throw LinuxException(LINUX_EIO);
+
+	// The upper layer may not be able to represent the original ownership, this is not fatal
+	try { upper->SetOwnership(stats.st_uid, stats.st_gid); }
+	catch(...) { /* DISCARD */ }
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+	return (m_upper = upper);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::CreateDirectory
+//
+// Creates a new directory node as a child of this directory
+//
+// Arguments:
+//
+//	mount		- Mount point on which to perform this operation
+//	name		- Name to assign to the new node
+//	mode		- Mode bitmask to assign to the new node
+
+std::shared_ptr<FileSystem::Alias> OverlayFileSystem::DirectoryNode::CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode)
+{
+	return CreateNode(std::move(mount), name, FileSystem::NodeType::Directory, mode);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::CreateFile
+//
+// Creates a new regular file node as a child of this directory
+//
+// Arguments:
+//
+//	mount		- Mount point on which to perform this operation
+//	name		- Name to assign to the new node
+//	mode		- Mode bitmask to assign to the new node
+
+std::shared_ptr<FileSystem::Alias> OverlayFileSystem::DirectoryNode::CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode)
+{
+	return CreateNode(std::move(mount), name, FileSystem::NodeType::File, mode);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::CreateNode (private)
+//
+// Creates a new child node in the upper layer
+//
+// Arguments:
+//
+//	mount		- Mount point on which to perform this operation
+//	name		- Name to assign to the new node
+//	type		- Type of node to be created
+//	mode		- Mode bitmask to assign to the new node
+
+std::shared_ptr<FileSystem::Alias> OverlayFileSystem::DirectoryNode::CreateNode(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, 
+	FileSystem::NodeType type, uapi::mode_t mode)
+{
+	std::shared_ptr<FileSystem::Node>		node;			// Newly constructed child node
+
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	if(name == nullptr) throw LinuxException(LINUX_EFAULT);
+	if(mount->Flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	// Names reserved for whiteouts cannot be created through the overlay
+	if(IsWhiteout(name)) throw LinuxException(LINUX_EPERM);
+
+	// The file system copy-up lock must be acquired before the node lock
+	sync::critical_section::scoped_lock copyup{ m_fs->m_cs };
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// The name cannot already be visible through the overlay
+	auto existing = Lookup(mount, name);
+	if(existing) throw LinuxException(LINUX_EEXIST);
+	if(existing.Code != LINUX_ENOENT) throw LinuxException(existing.Code);
+
+	auto upper = CopyUp();
+
+	// A whiteout for the name in the upper layer hides any matching entries in the lower layers
+	bool whiteout = static_cast<bool>(upper->Lookup(m_fs->m_upper, (std::string(WHITEOUT_PREFIX) + name).c_str()));
+
+	if(type == FileSystem::NodeType::Directory) {
+
+		auto directory = std::dynamic_pointer_cast<FileSystem::Directory>(upper->CreateDirectory(m_fs->m_upper, name, mode)->Node);
+		if(!directory) throw LinuxException(LINUX_EIO);
+
+		// A directory created over a whiteout must not be merged with the directories it replaced
+		if(whiteout) directory->CreateFile(m_fs->m_upper, OPAQUE_MARKER, 0);
+
+		node = std::make_shared<DirectoryNode>(m_fs, shared_from_this(), name, std::move(directory), layerdirs_t(m_lowers.size()));
+	}
+
+	else {
+
+		auto file = std::dynamic_pointer_cast<FileSystem::File>(upper->CreateFile(m_fs->m_upper, name, mode)->Node);
+		if(!file) throw LinuxException(LINUX_EIO);
+
+		node = std::make_shared<FileNode>(m_fs, shared_from_this(), name, std::move(file), nullptr, 0);
+	}
+
+	m_children[name] = node;
+	return std::make_shared<Alias>(name, std::move(node));
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::Enumerate
+//
+// Generates the merged list of entries contained in this directory
+//
+// Arguments:
+//
+//	NONE
+
+std::vector<OverlayFileSystem::direntry_t> OverlayFileSystem::DirectoryNode::Enumerate(void) const
+{
+	std::vector<direntry_t>				entries;		// Merged directory entries
+	std::unordered_set<std::string>		names;			// Names that have been enumerated
+	std::unordered_set<std::string>		whiteouts;		// Names that have been hidden
+
+	std::vector<uint8_t> buffer(DIRECTORY_BUFFER_SIZE);
+	auto upper = Upper;
+
+	// Walk the layers from the top down; layer zero is the upper layer
+	for(size_t layer = 0; layer <= m_lowers.size(); layer++) {
+
+		auto const& directory = (layer == 0) ? upper : m_lowers[layer - 1];
+		if(!directory) continue;
+
+		auto const& mount = (layer == 0) ? m_fs->m_upper : m_fs->m_lowers[layer - 1];
+
+		// Whiteouts only hide names in the layers below the one they were found in
+		std::vector<std::string> layerwhiteouts;
+
+		auto handle = directory->Open(mount, FileSystem::HandleAccess::ReadOnly, FileSystem::HandleFlags::None);
+		for(uapi::size_t read = handle->ReadDirectory(buffer.data(), buffer.size()); read; read = handle->ReadDirectory(buffer.data(), buffer.size())) {
+
+			for(uapi::size_t offset = 0; offset < read;) {
+
+				auto dirent = reinterpret_cast<const uapi::dirent64*>(&buffer[offset]);
+				offset += dirent->d_reclen;
+
+				std::string name(dirent->d_name);
+
+				// Whiteouts and opaque directory markers are never returned
+				if(IsWhiteout(name.c_str())) {
+
+					if(name != OPAQUE_MARKER) layerwhiteouts.emplace_back(name.substr(WHITEOUT_PREFIX_LENGTH));
+					continue;
+				}
+
+				// Names in the lower layers are only returned if they haven't been seen or hidden yet
+				if(whiteouts.count(name) || !names.insert(name).second) continue;
+				entries.push_back({ std::move(name), dirent->d_ino, dirent->d_type });
+			}
+		}
+
+		whiteouts.insert(layerwhiteouts.begin(), layerwhiteouts.end());
+	}
+
+	return entries;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::Lookup
+//
+// Looks up the alias associated with a child of this node
+//
+// Arguments:
+//
+//	mount		- Mount point on which to perform this operation
+//	name		- Name of the child to look up
+
+FileSystem::Result<std::shared_ptr<FileSystem::Alias>> OverlayFileSystem::DirectoryNode::Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const
+{
+	std::shared_ptr<FileSystem::Directory>	upperdir;				// Merged directory, upper layer
+	layerdirs_t								lowerdirs(m_lowers.size());	// Merged directory, lower layers
+	std::shared_ptr<FileSystem::File>		upperfile;				// File, upper layer
+	std::shared_ptr<FileSystem::File>		lowerfile;				// File, lower layer
+	size_t									lowerlayer = 0;			// File, lower layer index
+	bool									found = false;			// Flag if name was found
+
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+	UNREFERENCED_PARAMETER(mount);
+
+	if(name == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Names reserved for whiteouts are never visible through the overlay
+	if(IsWhiteout(name)) return FileSystem::Error{ LINUX_ENOENT };
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// Reuse the existing node for this name if it's still alive; this ensures that a copy-up
+	// performed through one reference to the node is visible through all of them
+	auto cached = m_children.find(name);
+	if(cached != m_children.end()) {
+
+		auto node = cached->second.lock();
+		if(node) return std::make_shared<Alias>(name, std::move(node));
+
+		m_children.erase(cached);
+	}
+
+	std::string whiteout = std::string(WHITEOUT_PREFIX) + name;
+
+	// Walk the layers from the top down; layer zero is the upper layer
+	for(size_t layer = 0; layer <= m_lowers.size(); layer++) {
+
+		auto const& directory = (layer == 0) ? m_upper : m_lowers[layer - 1];
+		if(!directory) continue;
+
+		auto const& layermount = (layer == 0) ? m_fs->m_upper : m_fs->m_lowers[layer - 1];
+
+		auto result = directory->Lookup(layermount, name);
+		if(!result) {
+
+			// ENOENT moves on to the next layer unless there is a whiteout for the name in this one
+			if(result.Code != LINUX_ENOENT) return FileSystem::Error{ result.Code };
+			if(directory->Lookup(layermount, whiteout.c_str())) break;
+
+			continue;
+		}
+
+		auto node = result.Value->Node;
+
+		// Directories are merged with the same directory in the lower layers
+		if(node->Type == FileSystem::NodeType::Directory) {
+
+			auto childdir = std::dynamic_pointer_cast<FileSystem::Directory>(node);
+			if(layer == 0) upperdir = childdir; else lowerdirs[layer - 1] = childdir;
+			found = true;
+
+			// An opaque directory is not merged with the layers below it
+			if(childdir->Lookup(layermount, OPAQUE_MARKER)) break;
+
+			continue;
+		}
+
+		// Any other type of node ends the merge, it's only visible from the topmost layer
+		if(found) break;
+
+		if(node->Type == FileSystem::NodeType::File) {
+
+			auto file = std::dynamic_pointer_cast<FileSystem::File>(node);
+			if(layer == 0) upperfile = file; else { lowerfile = file; lowerlayer = layer - 1; }
+			found = true;
+
+			break;
+		}
+
+		// todo: symbolic links and device nodes are not copied up, they are returned from
+		// their layer as-is and cannot be modified through the overlay
+		return std::make_shared<Alias>(name, std::move(node));
+	}
+
+	if(!found) return FileSystem::Error{ LINUX_ENOENT };
+
+	// Construct the overlay node and cache it for subsequent lookups of the same name
+	std::shared_ptr<FileSystem::Node> child;
+	auto self = std::const_pointer_cast<DirectoryNode>(shared_from_this());
+
+	if(upperfile || lowerfile) child = std::make_shared<FileNode>(m_fs, std::move(self), name, std::move(upperfile), std::move(lowerfile), lowerlayer);
+	else child = std::make_shared<DirectoryNode>(m_fs, std::move(self), name, std::move(upperdir), std::move(lowerdirs));
+
+	m_children[name] = child;
+	return std::make_shared<Alias>(name, std::move(child));
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::Open
+//
+// Creates a Handle instance against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this directory was reached
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+std::shared_ptr<FileSystem::Handle> OverlayFileSystem::DirectoryNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+{
+	uapi::stat				stats;			// Directory attributes
+
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+	UNREFERENCED_PARAMETER(mount);
+
+	// Directory node handles must always be opened in read-only mode
+	if(access != FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EISDIR);
+
+	// Check for flags that are incompatible with opening a directory file system object
+	if(flags & (FileSystem::HandleFlags::Append | FileSystem::HandleFlags::Direct)) throw LinuxException(LINUX_EINVAL);
+
+	// Read access to the topmost directory is required to open a handle against it, the
+	// layer directories are opened and merged when the handle is first read from
+	Stat(&stats);
+	FilePermission::Demand(FilePermission::Read, stats.st_uid, stats.st_gid, stats.st_mode);
+
+	return std::make_shared<DirectoryHandle>(shared_from_this(), access, flags);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void OverlayFileSystem::DirectoryNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	CopyUp()->SetOwnership(uid, gid);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void OverlayFileSystem::DirectoryNode::SetPermissions(uapi::mode_t permissions)
+{
+	CopyUp()->SetPermissions(permissions);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::Stat
+//
+// Provides statistical information about the node
+//
+// Arguments:
+//
+//	stats		- Buffer to receive the node statistics
+
+void OverlayFileSystem::DirectoryNode::Stat(uapi::stat* stats) const
+{
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// The attributes of a merged directory are those of the topmost layer
+	auto upper = Upper;
+	if(upper) return upper->Stat(stats);
+
+	for(auto const& lower : m_lowers) if(lower) return lower->Stat(stats);
+
+	throw LinuxException(LINUX_ENOENT);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::getType
+//
+// Gets the type of node represented by this object
+
+FileSystem::NodeType OverlayFileSystem::DirectoryNode::getType(void) const
+{
+	return FileSystem::NodeType::Directory;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::DirectoryNode::getUpper
+//
+// Gets the upper layer directory, or null if it has not been copied up
+
+std::shared_ptr<FileSystem::Directory> OverlayFileSystem::DirectoryNode::getUpper(void) const
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	return m_upper;
+}
+
+//
+// OVERLAYFILESYSTEM::FILENODE
+//
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	parent		- Parent directory node
+//	name		- Name of the file within the parent directory
+//	upper		- Upper layer file, or null if not present
+//	lower		- Lower layer file, or null if not present
+//	layer		- Index of the lower layer that contains the file
+
+OverlayFileSystem::FileNode::FileNode(std::shared_ptr<OverlayFileSystem> fs, std::shared_ptr<DirectoryNode> parent, const char_t* name, 
+	std::shared_ptr<FileSystem::File> upper, std::shared_ptr<FileSystem::File> lower, size_t layer) : m_fs(std::move(fs)), 
+	m_parent(std::move(parent)), m_name(name), m_upper(std::move(upper)), m_lower(std::move(lower)), m_layer(layer)
+{
+	_ASSERTE(m_parent);
+	_ASSERTE(m_upper || m_lower);
+	_ASSERTE(m_layer < m_fs->m_lowers.size());
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode::CopyUp (private)
+//
+// Ensures that this file exists in the upper layer
+//
+// Arguments:
+//
+//	truncate	- Flag to skip copying the file data
+
+std::shared_ptr<FileSystem::File> OverlayFileSystem::FileNode::CopyUp(bool truncate)
+{
+	uapi::stat				stats;			// Lower layer file attributes
+
+	// Copy-up operations are serialized, this also protects the parent chain
+	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
+
+	if(m_fs->m_flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	{
+		sync::critical_section::scoped_lock cs{ m_cs };
+		if(m_upper) return m_upper;
+	}
+
+	m_lower->Stat(&stats);
+
+	// Create the file in the upper layer with owner read/write access so that the data can be
+	// copied into it, the original permissions are applied once that has been completed
+	auto alias = m_parent->CopyUp()->CreateFile(m_fs->m_upper, m_name.c_str(), (stats.st_mode & LINUX_S_IALLUGO) | LINUX_S_IRUSR | LINUX_S_IWUSR);
+	auto upper = std::dynamic_pointer_cast<FileSystem::File>(alias->Node);
+	if(!upper) throw LinuxException(LINUX_EIO);
+
+	if(!truncate) {
+
+		auto source = m_lower->Open(m_fs->m_lowers[m_layer], FileSystem::HandleAccess::ReadOnly, FileSystem::HandleFlags::None);
+		auto dest = upper->Open(m_fs->m_upper, FileSystem::HandleAccess::WriteOnly, FileSystem::HandleFlags::None);
+
+		std::vector<uint8_t> buffer(COPY_BUFFER_SIZE);
+		for(uapi::size_t read = source->Read(buffer.data(), buffer.size()); read; read = source->Read(buffer.data(), buffer.size())) {
+
+			for(uapi::size_t written = 0; written < read;) {
+
+				uapi::size_t result = dest->Write(buffer.data() + written, read - written);
+				if(result == 0) throw LinuxException(LINUX_ENOSPC);
+
+				written += result;
+			}
+		}
+	}
+
+	// The upper layer may not be able to represent the original ownership, this is not fatal
+	try { upper->SetOwnership(stats.st_uid, stats.st_gid); }
+	catch(...) { /* DISCARD */ }
+
+	upper->SetPermissions(stats.st_mode & LINUX_S_IALLUGO);
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+	return (m_upper = upper);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode::GetLayer (private)
+//
+// Gets the topmost layer node and the mount it belongs to
+//
+// Arguments:
+//
+//	mount		- Receives the layer mount instance
+
+std::shared_ptr<FileSystem::File> OverlayFileSystem::FileNode::GetLayer(std::shared_ptr<FileSystem::Mount>& mount) const
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	if(m_upper) { mount = m_fs->m_upper; return m_upper; }
+
+	mount = m_fs->m_lowers[m_layer];
+	return m_lower;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode::Open
+//
+// Creates a Handle instance against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this file was reached
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+std::shared_ptr<FileSystem::Handle> OverlayFileSystem::FileNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+{
+	std::shared_ptr<FileSystem::Mount>		layermount;		// Layer mount instance
+
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	// Opening the file for write access or truncating it requires it to be in the upper layer
+	if((access != FileSystem::HandleAccess::ReadOnly) || (flags & FileSystem::HandleFlags::Truncate)) {
+
+		uapi::stat stats;
+
+		if(mount->Flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+		// Permission must be checked before the copy-up, otherwise a denied truncation would
+		// still replace the lower layer file with an empty one
+		Stat(&stats);
+		FilePermission::Demand(FilePermission::Write, stats.st_uid, stats.st_gid, stats.st_mode);
+
+		// The file data does not need to be copied if it's just going to be truncated
+		bool truncate = (flags & FileSystem::HandleFlags::Truncate) ? true : false;
+		return CopyUp(truncate)->Open(m_fs->m_upper, access, flags);
+	}
+
+	// Read-only handles are opened directly against the topmost layer
+	auto layer = GetLayer(layermount);
+	return layer->Open(layermount, access, flags);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode::OpenExec
+//
+// Creates an execute-only handle against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this node was resolved
+
+std::shared_ptr<FileSystem::Handle> OverlayFileSystem::FileNode::OpenExec(std::shared_ptr<FileSystem::Mount> mount) const
+{
+	std::shared_ptr<FileSystem::Mount>		layermount;		// Layer mount instance
+
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	// Verify that the mount point allows for execution of binary files
+	if(mount->Flags & LINUX_MS_NOEXEC) throw LinuxException(LINUX_ENOEXEC);
+
+	auto layer = GetLayer(layermount);
+	return layer->OpenExec(layermount);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void OverlayFileSystem::FileNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	CopyUp(false)->SetOwnership(uid, gid);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void OverlayFileSystem::FileNode::SetPermissions(uapi::mode_t permissions)
+{
+	CopyUp(false)->SetPermissions(permissions);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode::Stat
+//
+// Provides statistical information about the node
+//
+// Arguments:
+//
+//	stats		- Buffer to receive the node statistics
+
+void OverlayFileSystem::FileNode::Stat(uapi::stat* stats) const
+{
+	std::shared_ptr<FileSystem::Mount>		layermount;		// Layer mount instance
+
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	GetLayer(layermount)->Stat(stats);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::FileNode::getType
+//
+// Gets the type of node represented by this object
+
+FileSystem::NodeType OverlayFileSystem::FileNode::getType(void) const
+{
+	return FileSystem::NodeType::File;
+}
+
+//
+// OVERLAYFILESYSTEM::MOUNT
+//
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount Constructor
+//
+// Arguments:
+//
+//	fs		- Reference to the OverlayFileSystem instance
+//	root	- Root directory node instance
+//	flags	- Per-mount flags and options to set on this mount instance
+
+OverlayFileSystem::Mount::Mount(std::shared_ptr<OverlayFileSystem> fs, std::shared_ptr<DirectoryNode> root, uint32_t flags) 
+	: m_fs(std::move(fs)), m_flags(flags), m_root(std::move(root))
+{
+	// The flags should only contain bits from MS_PERMOUNT_MASK
+	_ASSERTE((m_flags & ~LINUX_MS_PERMOUNT_MASK) == 0);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount::Duplicate
+//
+// Duplicates this mount instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Mount> OverlayFileSystem::Mount::Duplicate(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	// Clone the underlying file system reference and flags into a new mount
+	return std::make_shared<Mount>(m_fs, root, m_flags);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount::getFlags
+//
+// Gets the flags set on this mount, includes file system flags
+
+uint32_t OverlayFileSystem::Mount::getFlags(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return m_flags | m_fs->m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount::Remount
+//
+// Remounts the file system with different options
+//
+// Arguments:
+//
+//	flags		- Standard mounting option flags
+//	data		- Extended/custom mounting options
+//	datalength	- Length of the extended mounting options data
+
+void OverlayFileSystem::Mount::Remount(uint32_t flags, const void* data, size_t datalen)
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	Capability::Demand(Capability::SystemAdmin);
+
+	// MS_REMOUNT must be specified in the flags when calling this function
+	if((flags & LINUX_MS_REMOUNT) != LINUX_MS_REMOUNT) throw LinuxException(LINUX_EINVAL);
+
+	// Parse the provided mounting options into remount flags and key/value pairs
+	MountOptions options(flags & LINUX_MS_RMT_MASK, data, datalen);
+
+	// Filter the flags to only those options which have changed from the current ones
+	uint32_t changedflags = (m_fs->m_flags & LINUX_MS_RMT_MASK) ^ options.Flags;
+
+	// Changing the flags cannot be done while a copy-up operation is in progress
+	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
+
+	// MS_RDONLY
+	//
+	if(changedflags & LINUX_MS_RDONLY) {
+
+		// The overlay cannot be made writable if the upper layer is read-only
+		if((options[LINUX_MS_RDONLY] == 0) && (m_fs->m_upper->Flags & LINUX_MS_RDONLY)) throw LinuxException(LINUX_EROFS);
+
+		m_fs->m_flags = (m_fs->m_flags & ~LINUX_MS_RDONLY) | options[LINUX_MS_RDONLY];
+	}
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount::getRoot
+//
+// Gets a reference to the root directory of the mount point
+
+std::shared_ptr<FileSystem::Directory> OverlayFileSystem::Mount::getRoot(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return root;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount::getSource
+//
+// Gets the device/name used as the source of the file system
+
+std::string OverlayFileSystem::Mount::getSource(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return std::string(m_fs->m_source);
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount::Stat
+//
+// Provides statistical information about the mounted file system
+//
+// Arguments:
+//
+//	stats		- Structure to receieve the file system statistics
+
+void OverlayFileSystem::Mount::Stat(uapi::statfs* stats) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// The capacity of the overlay is the capacity of the upper layer
+	m_fs->m_upper->Stat(stats);
+
+	stats->f_type		= LINUX_OVERLAYFS_SUPER_MAGIC;
+	stats->f_fsid		= m_fs->m_fsid;
+	stats->f_flags		= m_flags | m_fs->m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem::Mount::Unmount
+//
+// Unmounts the file system
+//
+// Arguments:
+//
+//	NONE
+
+void OverlayFileSystem::Mount::Unmount(void)
+{
+	// Ensure that the root directory node is not still shared out; handles opened against
+	// any node in the file system hold a reference to the file system, not the mount
+	if(m_root.use_count() > 1) throw LinuxException(LINUX_EBUSY);
+
+	m_root.reset();			// Release the root directory node
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
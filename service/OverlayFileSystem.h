@@ -0,0 +1,526 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __OVERLAYFILESYSTEM_H_
+#define __OVERLAYFILESYSTEM_H_
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FileSystem.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// OverlayFileSystem
+//
+// OverlayFileSystem implements a union file system, similar to overlayfs on Linux.
+//
+// A single writable upper layer is stacked over one or more read-only lower layers.
+// Directories that exist in more than one layer are merged, all other nodes are
+// taken from the topmost layer in which they exist.  Modifying a node that exists
+// only in a lower layer first copies it (and its parent directories) up into the
+// upper layer, the lower layers are never written to.  This allows a virtual machine
+// to be started against a shared root image without making a copy of it first
+//
+// Supported mount options:
+//
+//	MS_KERNMOUNT
+//	MS_NODEV
+//	MS_NOEXEC
+//	MS_NOSUID
+//	MS_RDONLY
+//
+//	lowerdir=path[;path...]		- Read-only lower layer(s), topmost first (required)
+//	upperdir=path				- Writable upper layer, defaults to an anonymous tmpfs
+//
+// Supported remount options:
+//
+//	MS_RDONLY
+//
+// Notes:
+//
+//	- Layer paths are host paths, they are mounted through the MountFunction provided
+//	to Mount().  Host paths contain colons, so lower layers are separated with semicolons.
+//
+//	- Whiteouts use the AUFS on-disk format, which does not require character device
+//	nodes.  A file named ".wh.<name>" hides <name> in all layers below the one it is
+//	found in, and a file named ".wh..wh..opq" marks a directory as opaque; the
+//	contents of the same directory in lower layers are not merged into it.  Whiteout
+//	names are never visible through the overlay.
+
+class OverlayFileSystem
+{
+public:
+
+	// Instance Constructor
+	//
+	OverlayFileSystem(const char_t* source, uint32_t flags, std::shared_ptr<FileSystem::Mount> upper, std::vector<std::shared_ptr<FileSystem::Mount>>&& lowers);
+
+	// Destructor
+	//
+	~OverlayFileSystem()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Mount (static)
+	//
+	// Creates an instance of the file system
+	static std::shared_ptr<FileSystem::Mount> Mount(FileSystem::MountFunction layerfs, const char_t* source, uint32_t flags, const void* data, size_t datalength);
+
+private:
+
+	OverlayFileSystem(const OverlayFileSystem&)=delete;
+	OverlayFileSystem& operator=(const OverlayFileSystem&)=delete;
+
+	// Forward Declarations
+	//
+	class DirectoryNode;
+
+	// direntry_t
+	//
+	// Merged directory entry, as enumerated from the underlying layers
+	struct direntry_t
+	{
+		std::string					name;			// Entry name
+		uint64_t					ino;			// Entry node number
+		uint8_t						type;			// Entry type (DT_xxx)
+	};
+
+	// layerdirs_t
+	//
+	// Collection of lower layer directories, indexed by layer; null if not present
+	using layerdirs_t = std::vector<std::shared_ptr<FileSystem::Directory>>;
+
+	// OverlayFileSystem::Alias
+	//
+	class Alias : public FileSystem::Alias
+	{
+	public:
+
+		// Instance Constructor
+		//
+		Alias(const char_t* name, std::shared_ptr<FileSystem::Node> node);
+
+		// Destructor
+		//
+		~Alias()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Alias Implementation
+
+		// GetName
+		//
+		// Reads the name assigned to this alias
+		virtual uapi::size_t GetName(char_t* buffer, size_t count) const override;
+
+		// Name
+		//
+		// Gets the name assigned to this alias
+		virtual std::string getName(void) const override;
+
+		// Node
+		//
+		// Gets the node to which this alias refers
+		virtual std::shared_ptr<FileSystem::Node> getNode(void) const override;
+
+	private:
+
+		Alias(const Alias&)=delete;
+		Alias& operator=(const Alias&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<FileSystem::Node>	m_node;		// Node instance
+		const std::string						m_name;		// Alias name to report
+	};
+
+	// OverlayFileSystem::DirectoryHandle
+	//
+	class DirectoryHandle : public FileSystem::Handle
+	{
+	public:
+
+		// Instance Constructor
+		//
+		DirectoryHandle(std::shared_ptr<DirectoryNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+
+		// Destructor
+		//
+		~DirectoryHandle()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Handle Implementation
+
+		// Duplicate
+		//
+		// Creates a duplicate Handle instance
+		virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+		// Read
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+		// ReadAt
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+		// Seek
+		//
+		// Changes the file position
+		virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+		// Sync
+		//
+		// Synchronizes all metadata and data associated with the file to storage
+		virtual void Sync(void) const override;
+
+		// SyncData
+		//
+		// Synchronizes all data associated with the file to storage, not metadata
+		virtual void SyncData(void) const override;
+
+		// Write
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+		// WriteAt
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+		// getAccess
+		//
+		// Gets the handle access mode
+		virtual FileSystem::HandleAccess getAccess(void) const override;
+
+		// getFlags
+		//
+		// Gets the handle flags
+		virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	private:
+
+		DirectoryHandle(const DirectoryHandle&)=delete;
+		DirectoryHandle& operator=(const DirectoryHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<DirectoryNode>	m_node;			// Directory node instance
+		const FileSystem::HandleAccess			m_access;		// Handle access mode
+		const FileSystem::HandleFlags			m_flags;		// Handle flags
+		std::vector<direntry_t>					m_entries;		// Merged directory entries
+		uapi::loff_t							m_position;		// Current directory position
+		mutable sync::critical_section			m_cs;			// Synchronization object
+	};
+
+	// OverlayFileSystem::DirectoryNode
+	//
+	class DirectoryNode : public FileSystem::Directory, public std::enable_shared_from_this<DirectoryNode>
+	{
+	public:
+
+		// Instance Constructor
+		//
+		DirectoryNode(std::shared_ptr<OverlayFileSystem> fs, std::shared_ptr<DirectoryNode> parent, const char_t* name, 
+			std::shared_ptr<FileSystem::Directory> upper, layerdirs_t&& lowers);
+
+		// Destructor
+		//
+		~DirectoryNode()=default;
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// CopyUp
+		//
+		// Ensures that this directory exists in the upper layer
+		std::shared_ptr<FileSystem::Directory> CopyUp(void);
+
+		// Enumerate
+		//
+		// Generates the merged list of entries contained in this directory
+		std::vector<direntry_t> Enumerate(void) const;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a Handle instance against this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about the node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// getType
+		//
+		// Gets the type of node being represented in the derived object instance
+		virtual FileSystem::NodeType getType(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Directory Implementation
+
+		// CreateDirectory
+		//
+		// Creates a new directory node as a child of this directory
+		virtual std::shared_ptr<FileSystem::Alias> CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+
+		// CreateFile
+		//
+		// Creates a new regular file node as a child of this directory
+		virtual std::shared_ptr<FileSystem::Alias> CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+
+		// Lookup
+		//
+		// Looks up the alias associated with a child of this node
+		virtual FileSystem::Result<std::shared_ptr<FileSystem::Alias>> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const override;
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Upper
+		//
+		// Gets the upper layer directory, or null if it has not been copied up
+		__declspec(property(get=getUpper)) std::shared_ptr<FileSystem::Directory> Upper;
+		std::shared_ptr<FileSystem::Directory> getUpper(void) const;
+
+	private:
+
+		DirectoryNode(const DirectoryNode&)=delete;
+		DirectoryNode& operator=(const DirectoryNode&)=delete;
+
+		//---------------------------------------------------------------------
+		// Private Member Functions
+
+		// CreateNode
+		//
+		// Creates a new child node in the upper layer
+		std::shared_ptr<FileSystem::Alias> CreateNode(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, FileSystem::NodeType type, uapi::mode_t mode);
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<OverlayFileSystem>	m_fs;			// File system instance
+		const std::shared_ptr<DirectoryNode>		m_parent;		// Parent directory node
+		const std::string							m_name;			// Name within the parent
+		std::shared_ptr<FileSystem::Directory>		m_upper;		// Upper layer directory
+		const layerdirs_t							m_lowers;		// Lower layer directories
+		mutable std::unordered_map<std::string, std::weak_ptr<FileSystem::Node>> m_children;	// Cached child nodes
+		mutable sync::critical_section				m_cs;			// Synchronization object
+	};
+
+	// OverlayFileSystem::FileNode
+	//
+	class FileNode : public FileSystem::File, public std::enable_shared_from_this<FileNode>
+	{
+	public:
+
+		// Instance Constructor
+		//
+		FileNode(std::shared_ptr<OverlayFileSystem> fs, std::shared_ptr<DirectoryNode> parent, const char_t* name, 
+			std::shared_ptr<FileSystem::File> upper, std::shared_ptr<FileSystem::File> lower, size_t layer);
+
+		// Destructor
+		//
+		~FileNode()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a Handle instance against this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about the node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// getType
+		//
+		// Gets the type of node being represented in the derived object instance
+		virtual FileSystem::NodeType getType(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::File Implementation
+
+		// OpenExec
+		//
+		// Creates an execute-only handle against this node
+		virtual std::shared_ptr<FileSystem::Handle> OpenExec(std::shared_ptr<FileSystem::Mount> mount) const override;
+
+	private:
+
+		FileNode(const FileNode&)=delete;
+		FileNode& operator=(const FileNode&)=delete;
+
+		//---------------------------------------------------------------------
+		// Private Member Functions
+
+		// CopyUp
+		//
+		// Ensures that this file exists in the upper layer
+		std::shared_ptr<FileSystem::File> CopyUp(bool truncate);
+
+		// GetLayer
+		//
+		// Gets the topmost layer node and the mount it belongs to
+		std::shared_ptr<FileSystem::File> GetLayer(std::shared_ptr<FileSystem::Mount>& mount) const;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<OverlayFileSystem>	m_fs;			// File system instance
+		const std::shared_ptr<DirectoryNode>		m_parent;		// Parent directory node
+		const std::string							m_name;			// Name within the parent
+		std::shared_ptr<FileSystem::File>			m_upper;		// Upper layer file
+		const std::shared_ptr<FileSystem::File>		m_lower;		// Lower layer file
+		const size_t								m_layer;		// Lower layer index
+		mutable sync::critical_section				m_cs;			// Synchronization object
+	};
+
+	// OverlayFileSystem::Mount
+	//
+	class Mount : public FileSystem::Mount
+	{
+	public:
+
+		// Instance Constructor
+		//
+		Mount(std::shared_ptr<OverlayFileSystem> fs, std::shared_ptr<DirectoryNode> root, uint32_t flags);
+
+		// Destructor
+		//
+		~Mount()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Mount Implementation
+
+		// Duplicate
+		//
+		// Duplicates this mount instance
+		virtual std::shared_ptr<FileSystem::Mount> Duplicate(void) const override;
+
+		// Remount
+		//
+		// Remounts this mount point with different flags and arguments
+		virtual void Remount(uint32_t flags, const void* data, size_t datalen) override;
+
+		// Stat
+		//
+		// Provides statistical information about the mounted file system
+		virtual void Stat(uapi::statfs* stats) const override;
+
+		// Unmount
+		//
+		// Unmounts the file system
+		virtual void Unmount(void) override;
+
+		// getFlags
+		//
+		// Gets the flags set on this mount, includes file system flags
+		virtual uint32_t getFlags(void) const override;
+
+		// getRoot
+		//
+		// Gets a reference to the root directory of the mount point
+		virtual std::shared_ptr<FileSystem::Directory> getRoot(void) const override;
+
+		// getSource
+		//
+		// Gets the device/name used as the source of the mount point
+		virtual std::string getSource(void) const override;
+
+	private:
+
+		Mount(const Mount&)=delete;
+		Mount& operator=(const Mount&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<OverlayFileSystem>	m_fs;		// File system instance
+		const uint32_t								m_flags;	// Mounting flags
+		std::shared_ptr<DirectoryNode>				m_root;		// The root directory node
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// IsWhiteout (static)
+	//
+	// Determines if a name is reserved for a whiteout or opaque directory marker
+	static bool IsWhiteout(const char_t* name);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	const std::string								m_source;		// Source device string
+	uint32_t										m_flags;		// File system flags
+	const uapi::fsid_t								m_fsid;			// File system unique identifier
+	const std::shared_ptr<FileSystem::Mount>		m_upper;		// Upper layer mount
+	const std::vector<std::shared_ptr<FileSystem::Mount>> m_lowers;	// Lower layer mounts
+	sync::critical_section							m_cs;			// Copy-up serialization
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __OVERLAYFILESYSTEM_H_
@@ -23,6 +23,8 @@
 #include "stdafx.h"
 #include "Pid.h"
 
+#include "LinuxException.h"
+
 // Forward Declarations
 //
 #include "Namespace.h"
@@ -30,13 +32,88 @@
 
 #pragma warning(push, 4)
 
+//-----------------------------------------------------------------------------
+// Pid Constructor (private)
+//
+// Arguments:
+//
+//	ns		- Leaf namespace that is allocating the Pid instance
+
+Pid::Pid(const std::shared_ptr<PidNamespace>& ns) : m_ns(ns), m_level(ns->m_level)
+{
+	// pid_t zero is never allocated, it indicates an unassigned level
+	for(auto& value : m_values) value = 0;
+}
+
 //-----------------------------------------------------------------------------
 // Pid Destructor
 
 Pid::~Pid()
 {
-	// Iterate over all allocated pid_ts for this Pid instance and release them
-	for(const auto& iterator : m_pids) iterator.first->ReleasePid(iterator.second);
+	// Walk from the leaf namespace up through the ancestors and release any
+	// pid_ts that were allocated; a partially constructed Pid can have zeros
+	for(PidNamespace* ns = m_ns.get(); ns; ns = ns->m_ancestor.get()) 
+		if(m_values[ns->m_level] != 0) ns->ReleasePid(m_values[ns->m_level]);
+}
+
+//-----------------------------------------------------------------------------
+// Pid::AttachProcess
+//
+// Associates a Process instance with this pid in all namespaces
+//
+// Arguments:
+//
+//	process		- Process instance to be associated with the pid
+
+void Pid::AttachProcess(const std::shared_ptr<Process>& process) const
+{
+	for(PidNamespace* ns = m_ns.get(); ns; ns = ns->m_ancestor.get()) 
+		ns->AttachProcess(m_values[ns->m_level], process);
+}
+
+//-----------------------------------------------------------------------------
+// Pid::AttachProcessGroup
+//
+// Associates a ProcessGroup instance with this pid in all namespaces
+//
+// Arguments:
+//
+//	pgroup		- ProcessGroup instance to be associated with the pid
+
+void Pid::AttachProcessGroup(const std::shared_ptr<ProcessGroup>& pgroup) const
+{
+	for(PidNamespace* ns = m_ns.get(); ns; ns = ns->m_ancestor.get()) 
+		ns->AttachProcessGroup(m_values[ns->m_level], pgroup);
+}
+
+//-----------------------------------------------------------------------------
+// Pid::AttachSession
+//
+// Associates a Session instance with this pid in all namespaces
+//
+// Arguments:
+//
+//	session		- Session instance to be associated with the pid
+
+void Pid::AttachSession(const std::shared_ptr<Session>& session) const
+{
+	for(PidNamespace* ns = m_ns.get(); ns; ns = ns->m_ancestor.get()) 
+		ns->AttachSession(m_values[ns->m_level], session);
+}
+
+//-----------------------------------------------------------------------------
+// Pid::AttachThread
+//
+// Associates a Thread instance with this pid in all namespaces
+//
+// Arguments:
+//
+//	thread		- Thread instance to be associated with the pid
+
+void Pid::AttachThread(const std::shared_ptr<Thread>& thread) const
+{
+	for(PidNamespace* ns = m_ns.get(); ns; ns = ns->m_ancestor.get()) 
+		ns->AttachThread(m_values[ns->m_level], thread);
 }
 
 //-----------------------------------------------------------------------------
@@ -56,8 +133,17 @@ uapi::pid_t Pid::getValue(const std::shared_ptr<Namespace>& ns) const
 
 uapi::pid_t Pid::getValue(const std::shared_ptr<PidNamespace>& ns) const
 {
-	try { return m_pids.at(ns); }
-	catch(...) { throw std::exception("todo"); } // todo: exception
+	// A pid is only visible in the namespace that allocated it and that
+	// namespace's ancestors; anything at a deeper level cannot match
+	if(ns->m_level > m_level) throw LinuxException{ LINUX_ESRCH };
+
+	// Walk up from the leaf namespace to the level of the requested namespace
+	// and verify that it is actually an ancestor rather than a sibling
+	PidNamespace* leaf = m_ns.get();
+	while(leaf->m_level > ns->m_level) leaf = leaf->m_ancestor.get();
+	if(leaf != ns.get()) throw LinuxException{ LINUX_ESRCH };
+
+	return m_values[ns->m_level];
 }
 
 //-----------------------------------------------------------------------------
@@ -24,7 +24,6 @@
 #define __PID_H_
 #pragma once
 
-#include <map>
 #include <memory>
 
 #pragma warning(push, 4)
@@ -33,6 +32,10 @@
 //
 class Namespace;
 class PidNamespace;
+class Process;
+class ProcessGroup;
+class Session;
+class Thread;
 
 //-----------------------------------------------------------------------------
 // Pid
@@ -41,6 +44,10 @@ class PidNamespace;
 // associated with one or more namespaces and can be different within each of
 // those namespaces.  When accessing the underlying pid_t value, the specific
 // namespace must be provided in order to acquire the correct one
+//
+// The pid_t values are stored inline, indexed by the level of the namespace
+// that issued them (0 being the root namespace).  Only the leaf namespace is
+// referenced directly, the ancestors are kept alive through that instance
 
 class Pid
 {
@@ -51,6 +58,37 @@ public:
 	//
 	~Pid();
 
+	//-------------------------------------------------------------------------
+	// Fields
+
+	// MaxLevels
+	//
+	// Maximum nesting level of pid namespaces, see pid_namespaces(7)
+	static const int MaxLevels = 32;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// AttachProcess
+	//
+	// Associates a Process instance with this pid in all namespaces
+	void AttachProcess(const std::shared_ptr<Process>& process) const;
+
+	// AttachProcessGroup
+	//
+	// Associates a ProcessGroup instance with this pid in all namespaces
+	void AttachProcessGroup(const std::shared_ptr<ProcessGroup>& pgroup) const;
+
+	// AttachSession
+	//
+	// Associates a Session instance with this pid in all namespaces
+	void AttachSession(const std::shared_ptr<Session>& session) const;
+
+	// AttachThread
+	//
+	// Associates a Thread instance with this pid in all namespaces
+	void AttachThread(const std::shared_ptr<Thread>& thread) const;
+
 	//-------------------------------------------------------------------------
 	// Properties
 
@@ -66,20 +104,17 @@ private:
 	Pid(const Pid&)=delete;
 	Pid& operator=(const Pid&)=delete;
 
-	// pidmap_t
-	//
-	// Collection that holds all of the namespace->pid_t mappings
-	using pidmap_t = std::map<std::shared_ptr<PidNamespace>, uapi::pid_t>;
-
 	// Instance Constructor
 	//
-	Pid()=default;
+	Pid(const std::shared_ptr<PidNamespace>& ns);
 	friend class std::_Ref_count_obj<Pid>;
 
 	//-------------------------------------------------------------------------
 	// Member Variables
 
-	pidmap_t				m_pids;			// Namespace-specific pid_t values
+	const std::shared_ptr<PidNamespace>	m_ns;					// Leaf (allocating) namespace
+	const int							m_level;				// Level of the leaf namespace
+	uapi::pid_t							m_values[MaxLevels];	// Per-level pid_t values
 };
 
 //-----------------------------------------------------------------------------
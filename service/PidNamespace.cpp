@@ -23,6 +23,12 @@
 #include "stdafx.h"
 #include "PidNamespace.h"
 
+#include "LinuxException.h"
+#include "Process.h"
+#include "ProcessGroup.h"
+#include "Session.h"
+#include "Thread.h"
+
 #pragma warning(push, 4)
 
 //-----------------------------------------------------------------------------
@@ -32,8 +38,10 @@
 //
 //	ancestor	- Ancestor PidNamespace instance
 
-PidNamespace::PidNamespace(const std::shared_ptr<PidNamespace>& ancestor) : m_ancestor(ancestor)
+PidNamespace::PidNamespace(const std::shared_ptr<PidNamespace>& ancestor) : m_ancestor(ancestor), 
+	m_level((ancestor) ? ancestor->m_level + 1 : 0), m_pidmap(static_cast<uint32_t>(PidMax))
 {
+	m_pidmap.Set(0);			// pid_t zero is never allocated
 }
 
 //-----------------------------------------------------------------------------
@@ -48,18 +56,13 @@ PidNamespace::PidNamespace(const std::shared_ptr<PidNamespace>& ancestor) : m_an
 
 std::shared_ptr<Pid> PidNamespace::Allocate(void)
 {
-	// Construct a new Pid instance and assign a pid_t from this namespace
-	auto pid = std::make_shared<Pid>();
-	pid->m_pids.emplace(shared_from_this(), AllocatePid());
-
-	// Iterate over all ancestors to this namespace and assign pid_ts
-	// from each of them to the Pid instance as well
-	auto ancestor = m_ancestor.lock();
-	while(ancestor) {
+	// Construct a new Pid instance and assign a pid_t from this namespace; if an
+	// ancestor allocation fails, the Pid destructor will release the others
+	auto pid = std::make_shared<Pid>(shared_from_this());
 
-		pid->m_pids.emplace(ancestor, ancestor->AllocatePid());
-		ancestor = ancestor->m_ancestor.lock();
-	}
+	// Iterate over this namespace and all ancestors to assign the pid_ts
+	for(PidNamespace* ns = this; ns; ns = ns->m_ancestor.get()) 
+		pid->m_values[ns->m_level] = ns->AllocatePid();
 
 	return pid;
 }
@@ -75,14 +78,88 @@ std::shared_ptr<Pid> PidNamespace::Allocate(void)
 
 uapi::pid_t PidNamespace::AllocatePid(void)
 {
-	uapi::pid_t pid;				// Allocated pid_t value
+	sync::reader_writer_lock::scoped_lock_write writer(m_lock);
 
-	// Try to use a spent pid_t first before grabbing a new one; if the
-	// return value overflows, there are no more pid_ts left to use
-	if(!m_spent.try_pop(pid)) pid = m_next++;
-	if(pid < 0) throw std::exception("todo");		// todo: exception
+	// Search for the next clear bit after the last allocated pid_t; the search
+	// wraps around to the start of the bitmap if the end has been reached, which
+	// prevents a released pid_t from being reused immediately
+	uint32_t pid = m_pidmap.FindClearAndSet(1, static_cast<uint32_t>(m_last + 1) % PidMax);
+	if(pid == Bitmap::NotFound) throw LinuxException{ LINUX_EAGAIN };
 
-	return pid;
+	m_last = static_cast<uapi::pid_t>(pid);
+	return m_last;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::AttachProcess (private)
+//
+// Associates a Process instance with an allocated pid_t
+//
+// Arguments:
+//
+//	pid			- pid_t previously allocated by this instance
+//	process		- Process instance to associate with the pid_t
+
+void PidNamespace::AttachProcess(uapi::pid_t pid, const std::shared_ptr<Process>& process)
+{
+	_ASSERTE((pid > 0) && (pid < PidMax));
+	sync::reader_writer_lock::scoped_lock_write writer(m_lock);
+
+	GetEntry(pid).process = process;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::AttachProcessGroup (private)
+//
+// Associates a ProcessGroup instance with an allocated pid_t
+//
+// Arguments:
+//
+//	pid			- pid_t previously allocated by this instance
+//	pgroup		- ProcessGroup instance to associate with the pid_t
+
+void PidNamespace::AttachProcessGroup(uapi::pid_t pid, const std::shared_ptr<ProcessGroup>& pgroup)
+{
+	_ASSERTE((pid > 0) && (pid < PidMax));
+	sync::reader_writer_lock::scoped_lock_write writer(m_lock);
+
+	GetEntry(pid).pgroup = pgroup;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::AttachSession (private)
+//
+// Associates a Session instance with an allocated pid_t
+//
+// Arguments:
+//
+//	pid			- pid_t previously allocated by this instance
+//	session		- Session instance to associate with the pid_t
+
+void PidNamespace::AttachSession(uapi::pid_t pid, const std::shared_ptr<Session>& session)
+{
+	_ASSERTE((pid > 0) && (pid < PidMax));
+	sync::reader_writer_lock::scoped_lock_write writer(m_lock);
+
+	GetEntry(pid).session = session;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::AttachThread (private)
+//
+// Associates a Thread instance with an allocated pid_t
+//
+// Arguments:
+//
+//	pid			- pid_t previously allocated by this instance
+//	thread		- Thread instance to associate with the pid_t
+
+void PidNamespace::AttachThread(uapi::pid_t pid, const std::shared_ptr<Thread>& thread)
+{
+	_ASSERTE((pid > 0) && (pid < PidMax));
+	sync::reader_writer_lock::scoped_lock_write writer(m_lock);
+
+	GetEntry(pid).thread = thread;
 }
 
 //-----------------------------------------------------------------------------
@@ -110,9 +187,141 @@ std::shared_ptr<PidNamespace> PidNamespace::Create(void)
 
 std::shared_ptr<PidNamespace> PidNamespace::Create(const std::shared_ptr<PidNamespace>& ancestor)
 {
+	// Pid instances store the per-level pid_t values inline, enforce the limit
+	if((ancestor) && (ancestor->m_level + 1 >= Pid::MaxLevels)) throw LinuxException{ LINUX_EUSERS };
+
 	return std::make_shared<PidNamespace>(ancestor);
 }
 
+//-----------------------------------------------------------------------------
+// PidNamespace::FindProcess
+//
+// Locates the Process associated with a pid_t in this namespace
+//
+// Arguments:
+//
+//	pid			- pid_t of the process to locate
+
+std::shared_ptr<Process> PidNamespace::FindProcess(uapi::pid_t pid) const
+{
+	if((pid <= 0) || (pid >= PidMax)) return nullptr;
+
+	sync::reader_writer_lock::scoped_lock_read reader(m_lock);
+
+	const auto& page = m_table[pid / TablePageSize];
+	return (page) ? (*page)[pid % TablePageSize].process.lock() : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::FindProcessGroup
+//
+// Locates the ProcessGroup associated with a pid_t in this namespace
+//
+// Arguments:
+//
+//	pid			- pid_t of the process group to locate
+
+std::shared_ptr<ProcessGroup> PidNamespace::FindProcessGroup(uapi::pid_t pid) const
+{
+	if((pid <= 0) || (pid >= PidMax)) return nullptr;
+
+	sync::reader_writer_lock::scoped_lock_read reader(m_lock);
+
+	const auto& page = m_table[pid / TablePageSize];
+	return (page) ? (*page)[pid % TablePageSize].pgroup.lock() : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::FindSession
+//
+// Locates the Session associated with a pid_t in this namespace
+//
+// Arguments:
+//
+//	pid			- pid_t of the session to locate
+
+std::shared_ptr<Session> PidNamespace::FindSession(uapi::pid_t pid) const
+{
+	if((pid <= 0) || (pid >= PidMax)) return nullptr;
+
+	sync::reader_writer_lock::scoped_lock_read reader(m_lock);
+
+	const auto& page = m_table[pid / TablePageSize];
+	return (page) ? (*page)[pid % TablePageSize].session.lock() : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::FindThread
+//
+// Locates the Thread associated with a pid_t in this namespace
+//
+// Arguments:
+//
+//	pid			- pid_t of the thread to locate
+
+std::shared_ptr<Thread> PidNamespace::FindThread(uapi::pid_t pid) const
+{
+	if((pid <= 0) || (pid >= PidMax)) return nullptr;
+
+	sync::reader_writer_lock::scoped_lock_read reader(m_lock);
+
+	const auto& page = m_table[pid / TablePageSize];
+	return (page) ? (*page)[pid % TablePageSize].thread.lock() : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::GetEntry (private)
+//
+// Gets a reference to the table entry for a pid_t; the page that contains the
+// entry is allocated if it doesn't exist yet.  The caller must hold the writer lock
+//
+// Arguments:
+//
+//	pid			- pid_t of the entry to retrieve
+
+PidNamespace::entry_t& PidNamespace::GetEntry(uapi::pid_t pid)
+{
+	auto& page = m_table[pid / TablePageSize];
+	if(!page) page = std::make_unique<page_t>();
+
+	return (*page)[pid % TablePageSize];
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::getLevel
+//
+// Gets the nesting level of this namespace, the root namespace is zero
+
+int PidNamespace::getLevel(void) const
+{
+	return m_level;
+}
+
+//-----------------------------------------------------------------------------
+// PidNamespace::getProcesses
+//
+// Gets a snapshot of the processes that are visible in this namespace
+
+std::vector<std::shared_ptr<Process>> PidNamespace::getProcesses(void) const
+{
+	std::vector<std::shared_ptr<Process>>	processes;		// Live process instances
+
+	sync::reader_writer_lock::scoped_lock_read reader(m_lock);
+
+	// Only the pages that have been allocated need to be walked
+	for(const auto& page : m_table) {
+
+		if(!page) continue;
+		for(const auto& entry : *page) {
+
+			auto process = entry.process.lock();
+			if(process) processes.push_back(std::move(process));
+		}
+	}
+
+	return processes;
+}
+
 //-----------------------------------------------------------------------------
 // PidNamespace::ReleasePid (private)
 //
@@ -124,9 +333,15 @@ std::shared_ptr<PidNamespace> PidNamespace::Create(const std::shared_ptr<PidName
 
 void PidNamespace::ReleasePid(uapi::pid_t pid)
 {
-	// This class reuses pid_ts aggressively, push it into the spent queue
-	// so that it will be grabbed before allocating a new one
-	m_spent.push(pid);
+	_ASSERTE((pid > 0) && (pid < PidMax));
+	sync::reader_writer_lock::scoped_lock_write writer(m_lock);
+
+	// Reset any table entry associated with the pid_t before releasing it, the
+	// rolling cursor in AllocatePid will not hand it out again right away
+	auto& page = m_table[pid / TablePageSize];
+	if(page) (*page)[pid % TablePageSize] = entry_t();
+
+	m_pidmap.Clear(static_cast<uint32_t>(pid));
 }
 
 //-----------------------------------------------------------------------------
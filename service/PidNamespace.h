@@ -24,17 +24,30 @@
 #define __PIDNAMESPACE_H_
 #pragma once
 
-#include <atomic>
-#include <concurrent_queue.h>
+#include <array>
 #include <memory>
+#include <vector>
+#include "Bitmap.h"
 #include "Pid.h"
 
 #pragma warning(push, 4)				
 
+// Forward Declarations
+//
+class Process;
+class ProcessGroup;
+class Session;
+class Thread;
+
 //-----------------------------------------------------------------------------
 // PidNamespace
 //
 // Provides an isolated process id number space. See pid_namespace(7).
+//
+// pid_ts are allocated from a bitmap using a rolling cursor, in the same manner
+// as Linux, so that a released pid_t is not reused until the remainder of the
+// pid space has been cycled through.  Each namespace also maintains a table of
+// weak references indexed by pid_t to allow for direct Process/Thread lookups
 
 class PidNamespace : public std::enable_shared_from_this<PidNamespace>
 {
@@ -45,6 +58,14 @@ public:
 	//
 	~PidNamespace()=default;
 
+	//-------------------------------------------------------------------------
+	// Fields
+
+	// PidMax
+	//
+	// Upper limit (exclusive) of the pid_ts allocated by a namespace
+	static const uapi::pid_t PidMax = 32768;
+
 	//-------------------------------------------------------------------------
 	// Member Functions
 
@@ -59,15 +80,71 @@ public:
 	static std::shared_ptr<PidNamespace> Create(void);
 	static std::shared_ptr<PidNamespace> Create(const std::shared_ptr<PidNamespace>& ancestor);
 
+	// FindProcess
+	//
+	// Locates the Process associated with a pid_t in this namespace
+	std::shared_ptr<Process> FindProcess(uapi::pid_t pid) const;
+
+	// FindProcessGroup
+	//
+	// Locates the ProcessGroup associated with a pid_t in this namespace
+	std::shared_ptr<ProcessGroup> FindProcessGroup(uapi::pid_t pid) const;
+
+	// FindSession
+	//
+	// Locates the Session associated with a pid_t in this namespace
+	std::shared_ptr<Session> FindSession(uapi::pid_t pid) const;
+
+	// FindThread
+	//
+	// Locates the Thread associated with a pid_t in this namespace
+	std::shared_ptr<Thread> FindThread(uapi::pid_t pid) const;
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Level
+	//
+	// Gets the nesting level of this namespace, the root namespace is zero
+	__declspec(property(get=getLevel)) int Level;
+	int getLevel(void) const;
+
+	// Processes
+	//
+	// Gets a snapshot of the processes that are visible in this namespace
+	__declspec(property(get=getProcesses)) std::vector<std::shared_ptr<Process>> Processes;
+	std::vector<std::shared_ptr<Process>> getProcesses(void) const;
+
 private:
 
 	PidNamespace(const PidNamespace&)=delete;
 	PidNamespace& operator=(const PidNamespace&)=delete;
 
-	// spentqueue_t
+	// entry_t
 	//
-	// Concurrency-safe queue of spent pid_ts for reuse
-	using spentqueue_t = Concurrency::concurrent_queue<uapi::pid_t>;
+	// Weak references to the objects associated with a single pid_t
+	struct entry_t
+	{
+		std::weak_ptr<Process>		process;		// Associated Process instance
+		std::weak_ptr<ProcessGroup>	pgroup;			// Associated ProcessGroup instance
+		std::weak_ptr<Session>		session;		// Associated Session instance
+		std::weak_ptr<Thread>		thread;			// Associated Thread instance
+	};
+
+	// TablePageSize
+	//
+	// Number of entries in each lazily allocated page of the pid_t table
+	static const uapi::pid_t TablePageSize = 1024;
+
+	// page_t
+	//
+	// Single page of pid_t table entries
+	using page_t = std::array<entry_t, TablePageSize>;
+
+	// table_t
+	//
+	// Two-level table of pid_t entries, pages are allocated on demand
+	using table_t = std::array<std::unique_ptr<page_t>, PidMax / TablePageSize>;
 
 	// Instance Constructor
 	//
@@ -82,6 +159,31 @@ private:
 	// Allocates a raw pid_t from this namespace pid_t pool
 	uapi::pid_t AllocatePid(void);
 
+	// AttachProcess
+	//
+	// Associates a Process instance with an allocated pid_t
+	void AttachProcess(uapi::pid_t pid, const std::shared_ptr<Process>& process);
+
+	// AttachProcessGroup
+	//
+	// Associates a ProcessGroup instance with an allocated pid_t
+	void AttachProcessGroup(uapi::pid_t pid, const std::shared_ptr<ProcessGroup>& pgroup);
+
+	// AttachSession
+	//
+	// Associates a Session instance with an allocated pid_t
+	void AttachSession(uapi::pid_t pid, const std::shared_ptr<Session>& session);
+
+	// AttachThread
+	//
+	// Associates a Thread instance with an allocated pid_t
+	void AttachThread(uapi::pid_t pid, const std::shared_ptr<Thread>& thread);
+
+	// GetEntry
+	//
+	// Gets a reference to the table entry for a pid_t, allocating the page
+	entry_t& GetEntry(uapi::pid_t pid);
+
 	// ReleasePid
 	//
 	// Releases a pid_t that has been allocated in this namespace
@@ -90,9 +192,12 @@ private:
 	//-------------------------------------------------------------------------
 	// Member Variables
 
-	std::atomic<uapi::pid_t>		m_next = 1;		// Next unused sequential pid_t
-	spentqueue_t					m_spent;		// Queue of spent pid_ts for reuse
-	std::weak_ptr<PidNamespace>		m_ancestor;		// PidNamespace ancestor
+	const std::shared_ptr<PidNamespace>	m_ancestor;			// PidNamespace ancestor
+	const int							m_level;			// Nesting level
+	Bitmap								m_pidmap;			// Allocated pid_t bitmap
+	uapi::pid_t							m_last = 0;			// Last allocated pid_t
+	table_t								m_table;			// pid_t lookup table
+	mutable sync::reader_writer_lock	m_lock;				// Synchronization object
 };
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,432 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "PipeBuffer.h"
+
+#include "LinuxException.h"
+#include "SystemInformation.h"
+#include "Win32Exception.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// PipeBuffer Constructor
+//
+// Arguments:
+//
+//	capacity	- Requested capacity of the data ring
+
+PipeBuffer::PipeBuffer(size_t capacity) : m_section(CreateRingSection(capacity)), 
+	m_view(MappedFileView::Create(m_section, FILE_MAP_READ | FILE_MAP_WRITE)), m_ring(InitializeRing(m_view)), m_readable(nullptr), m_writable(nullptr)
+{
+	// The events are auto-reset; each end of the buffer has at most one waiter at a time
+	m_readable = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+	m_writable = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+
+	if((m_readable == nullptr) || (m_writable == nullptr)) {
+
+		DWORD result = GetLastError();
+
+		if(m_readable) CloseHandle(m_readable);
+		if(m_writable) CloseHandle(m_writable);
+
+		throw Win32Exception(result);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer Destructor
+
+PipeBuffer::~PipeBuffer()
+{
+	CloseHandle(m_writable);
+	CloseHandle(m_readable);
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::AddReader
+//
+// Registers a reader against the buffer
+//
+// Arguments:
+//
+//	NONE
+
+void PipeBuffer::AddReader(void)
+{
+	m_ring.AddReader();
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::AddWriter
+//
+// Registers a writer against the buffer
+//
+// Arguments:
+//
+//	NONE
+
+void PipeBuffer::AddWriter(void)
+{
+	m_ring.AddWriter();
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::getAvailable
+//
+// Gets the number of bytes that can currently be read from the buffer
+
+uapi::size_t PipeBuffer::getAvailable(void) const
+{
+	return m_ring.Available;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::CreateRingSection (private, static)
+//
+// Creates the section that will contain the ring
+//
+// Arguments:
+//
+//	capacity	- Requested capacity of the data ring
+
+std::unique_ptr<MappedFile> PipeBuffer::CreateRingSection(size_t capacity)
+{
+	// The ring capacity must be a power of two no smaller than the minimum
+	size_t length = PipeRing::MinimumCapacity;
+	while((length < capacity) && (length < PipeRing::MaximumCapacity)) length <<= 1;
+
+	// The section is allocated in whole pages, the ring control structure is placed in front of the data
+	return MappedFile::CreateNew(PAGE_READWRITE, align::up(PipeRing::RequiredLength(length), SystemInformation::PageSize));
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::InitializeRing (private, static)
+//
+// Initializes the ring in a mapped view of the section
+//
+// Arguments:
+//
+//	view		- Mapped view of the ring section
+
+void* PipeBuffer::InitializeRing(const std::unique_ptr<MappedFileView>& view)
+{
+	if(PipeRing::Initialize(view->Pointer, view->Length) == 0) throw LinuxException(LINUX_ENOMEM);
+	return view->Pointer;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::Peek
+//
+// Reads data from the buffer without consuming it, blocking until data is available unless nonblock is set
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+//	nonblock	- Flag to fail with EAGAIN rather than block on an empty buffer
+
+uapi::size_t PipeBuffer::Peek(void* buffer, uapi::size_t count, bool nonblock)
+{
+	return ReadRing(buffer, count, nonblock, true);
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::PollReader
+//
+// Gets the POLLxxx readiness of the read end of the buffer
+//
+// Arguments:
+//
+//	NONE
+
+uint32_t PipeBuffer::PollReader(void) const
+{
+	uint32_t events = 0;
+
+	if(m_ring.Available > 0) events |= (LINUX_POLLIN | LINUX_POLLRDNORM);
+	if(m_ring.Writers == 0) events |= LINUX_POLLHUP;
+
+	return events;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::PollWriter
+//
+// Gets the POLLxxx readiness of the write end of the buffer
+//
+// Arguments:
+//
+//	NONE
+
+uint32_t PipeBuffer::PollWriter(void) const
+{
+	uint32_t events = 0;
+
+	// The write end is reported as writable when a write of LINUX_PIPE_BUF bytes would not block
+	if(m_ring.Free >= LINUX_PIPE_BUF) events |= (LINUX_POLLOUT | LINUX_POLLWRNORM);
+	if(m_ring.Readers == 0) events |= LINUX_POLLERR;
+
+	return events;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::Read
+//
+// Reads data from the buffer, blocking until data is available unless nonblock is set
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+//	nonblock	- Flag to fail with EAGAIN rather than block on an empty buffer
+
+uapi::size_t PipeBuffer::Read(void* buffer, uapi::size_t count, bool nonblock)
+{
+	return ReadRing(buffer, count, nonblock, false);
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::getReadableEvent
+//
+// Gets the event that is signaled when data has been written into the ring
+
+HANDLE PipeBuffer::getReadableEvent(void) const
+{
+	return m_readable;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::getReadPosition
+//
+// Gets the free-running read position of the ring
+
+uint32_t PipeBuffer::getReadPosition(void) const
+{
+	return m_ring.ReadPosition;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::ReadRing (private)
+//
+// Implements Read() and Peek()
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+//	nonblock	- Flag to fail with EAGAIN rather than block on an empty buffer
+//	peek		- Flag to leave the data in the ring
+
+uapi::size_t PipeBuffer::ReadRing(void* buffer, uapi::size_t count, bool nonblock, bool peek)
+{
+	if(count == 0) return 0;
+
+	// Only one reader may act as the ring consumer at a time
+	sync::critical_section::scoped_lock critsec{ m_readcs };
+
+	while(true) {
+
+		uapi::size_t read = (peek) ? m_ring.Peek(buffer, count) : m_ring.Read(buffer, count);
+		if(read > 0) {
+
+			// Wake the producer if it was waiting for space in the ring
+			if(!peek) {
+
+				if(m_ring.ConsumeWriteWait()) SetEvent(m_writable);
+				m_pollqueue.Notify(LINUX_POLLOUT | LINUX_POLLWRNORM);
+			}
+
+			return read;
+		}
+
+		// An empty ring without any remaining writers indicates end-of-file
+		if(m_ring.Writers == 0) return 0;
+		if(nonblock) throw LinuxException(LINUX_EAGAIN);
+
+		// Announce the wait and check the ring again before blocking, otherwise a
+		// write that occurred after the ring was found to be empty could be missed
+		// todo: the wait needs to be interruptible by signals (EINTR)
+		m_ring.PrepareReadWait();
+		if((m_ring.Available == 0) && (m_ring.Writers != 0)) WaitForSingleObject(m_readable, INFINITE);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::ReleaseReader
+//
+// Releases a reader from the buffer
+//
+// Arguments:
+//
+//	NONE
+
+void PipeBuffer::ReleaseReader(void)
+{
+	// When the last reader is released, wake a blocked writer so that it will fail with EPIPE
+	if(m_ring.ReleaseReader() == 0) {
+
+		SetEvent(m_writable);
+		m_pollqueue.Notify(LINUX_POLLERR);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::ReleaseWriter
+//
+// Releases a writer from the buffer
+//
+// Arguments:
+//
+//	NONE
+
+void PipeBuffer::ReleaseWriter(void)
+{
+	// When the last writer is released, wake a blocked reader so that it will see end-of-file
+	if(m_ring.ReleaseWriter() == 0) {
+
+		SetEvent(m_readable);
+		m_pollqueue.Notify(LINUX_POLLHUP);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::getSection
+//
+// Gets the section that contains the ring
+
+HANDLE PipeBuffer::getSection(void) const
+{
+	return m_section->Handle;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::Subscribe
+//
+// Registers a waiter to be signaled when the readiness of either end changes
+//
+// Arguments:
+//
+//	waiter		- Waiter to be registered
+
+void PipeBuffer::Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter)
+{
+	m_pollqueue.Subscribe(std::move(waiter));
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::Unsubscribe
+//
+// Removes a previously registered waiter
+//
+// Arguments:
+//
+//	waiter		- Waiter to be removed
+
+void PipeBuffer::Unsubscribe(const FileSystem::PollWaiter* waiter)
+{
+	m_pollqueue.Unsubscribe(waiter);
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::getWritableEvent
+//
+// Gets the event that is signaled when space has been released in the ring
+
+HANDLE PipeBuffer::getWritableEvent(void) const
+{
+	return m_writable;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::getWritePosition
+//
+// Gets the free-running write position of the ring
+
+uint32_t PipeBuffer::getWritePosition(void) const
+{
+	return m_ring.WritePosition;
+}
+
+//-----------------------------------------------------------------------------
+// PipeBuffer::Write
+//
+// Writes data into the buffer, blocking until all data is written unless nonblock is set
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+//	nonblock	- Flag to fail with EAGAIN rather than block on a full buffer
+
+uapi::size_t PipeBuffer::Write(const void* buffer, uapi::size_t count, bool nonblock)
+{
+	uapi::size_t			written = 0;			// Number of bytes written
+
+	if(count == 0) return 0;
+
+	// Writes of LINUX_PIPE_BUF bytes or less must not be interleaved with other writes
+	bool whole = (count <= LINUX_PIPE_BUF);
+
+	// Only one writer may act as the ring producer at a time
+	sync::critical_section::scoped_lock critsec{ m_writecs };
+
+	while(written < count) {
+
+		// Writing without any readers yields EPIPE, the caller is responsible for raising SIGPIPE
+		if(m_ring.Readers == 0) {
+
+			if(written > 0) return written;
+			throw LinuxException(LINUX_EPIPE);
+		}
+
+		uapi::size_t result = m_ring.Write(reinterpret_cast<const uint8_t*>(buffer) + written, count - written, whole);
+		if(result > 0) {
+
+			// Wake the consumer if it was waiting for data in the ring
+			if(m_ring.ConsumeReadWait()) SetEvent(m_readable);
+			m_pollqueue.Notify(LINUX_POLLIN | LINUX_POLLRDNORM);
+
+			written += result;
+			continue;
+		}
+
+		if(nonblock) {
+
+			if(written > 0) return written;
+			throw LinuxException(LINUX_EAGAIN);
+		}
+
+		// Announce the wait and check the ring again before blocking, otherwise a
+		// read that occurred after the ring was found to be full could be missed
+		// todo: the wait needs to be interruptible by signals (EINTR)
+		m_ring.PrepareWriteWait();
+		if((m_ring.Free < (whole ? count : 1)) && (m_ring.Readers != 0)) WaitForSingleObject(m_writable, INFINITE);
+	}
+
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,208 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __PIPEBUFFER_H_
+#define __PIPEBUFFER_H_
+#pragma once
+
+#include <memory>
+#include "MappedFile.h"
+#include "MappedFileView.h"
+#include "PipeRing.h"
+#include "PollQueue.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// PipeBuffer
+//
+// Implements blocking read and write operations against a PipeRing that has been
+// allocated in a page file backed section.  All transfers are currently performed
+// by the service; the section and the readable/writable events are plain kernel
+// objects so a host could map the ring and memcpy into or out of it directly, but
+// nothing duplicates them into host processes yet.
+//
+// A reader blocks when the ring is empty and sees end-of-file once all writers
+// have been released; a writer blocks when the ring is full and fails with EPIPE
+// once all readers have been released.
+//
+// Readiness changes caused by operations performed through the service are
+// published to subscribed FileSystem::PollWaiter instances, see PollReader()
+// and PollWriter() for the POLLxxx state of each end of the buffer.
+//
+// Notes:
+//
+//	- The ring is single-producer/single-consumer; concurrent readers and
+//	  concurrent writers within the service are serialized against each other.
+//
+//	- Writes of LINUX_PIPE_BUF bytes or less are atomic.
+
+class PipeBuffer
+{
+public:
+
+	// Instance Constructor
+	//
+	explicit PipeBuffer(size_t capacity);
+
+	// Destructor
+	//
+	~PipeBuffer();
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// AddReader
+	//
+	// Registers a reader against the buffer
+	void AddReader(void);
+
+	// AddWriter
+	//
+	// Registers a writer against the buffer
+	void AddWriter(void);
+
+	// Peek
+	//
+	// Reads data from the buffer without consuming it, blocking until data is available unless nonblock is set
+	uapi::size_t Peek(void* buffer, uapi::size_t count, bool nonblock);
+
+	// PollReader
+	//
+	// Gets the POLLxxx readiness of the read end of the buffer
+	uint32_t PollReader(void) const;
+
+	// PollWriter
+	//
+	// Gets the POLLxxx readiness of the write end of the buffer
+	uint32_t PollWriter(void) const;
+
+	// Read
+	//
+	// Reads data from the buffer, blocking until data is available unless nonblock is set
+	uapi::size_t Read(void* buffer, uapi::size_t count, bool nonblock);
+
+	// ReleaseReader
+	//
+	// Releases a reader from the buffer
+	void ReleaseReader(void);
+
+	// ReleaseWriter
+	//
+	// Releases a writer from the buffer
+	void ReleaseWriter(void);
+
+	// Subscribe
+	//
+	// Registers a waiter to be signaled when the readiness of either end changes
+	void Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter);
+
+	// Unsubscribe
+	//
+	// Removes a previously registered waiter
+	void Unsubscribe(const FileSystem::PollWaiter* waiter);
+
+	// Write
+	//
+	// Writes data into the buffer, blocking until all data is written unless nonblock is set
+	uapi::size_t Write(const void* buffer, uapi::size_t count, bool nonblock);
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Available
+	//
+	// Gets the number of bytes that can currently be read from the buffer
+	__declspec(property(get=getAvailable)) uapi::size_t Available;
+	uapi::size_t getAvailable(void) const;
+
+	// ReadableEvent
+	//
+	// Gets the event that is signaled when data has been written into the ring
+	__declspec(property(get=getReadableEvent)) HANDLE ReadableEvent;
+	HANDLE getReadableEvent(void) const;
+
+	// ReadPosition
+	//
+	// Gets the free-running read position of the ring
+	__declspec(property(get=getReadPosition)) uint32_t ReadPosition;
+	uint32_t getReadPosition(void) const;
+
+	// Section
+	//
+	// Gets the section that contains the ring
+	__declspec(property(get=getSection)) HANDLE Section;
+	HANDLE getSection(void) const;
+
+	// WritableEvent
+	//
+	// Gets the event that is signaled when space has been released in the ring
+	__declspec(property(get=getWritableEvent)) HANDLE WritableEvent;
+	HANDLE getWritableEvent(void) const;
+
+	// WritePosition
+	//
+	// Gets the free-running write position of the ring
+	__declspec(property(get=getWritePosition)) uint32_t WritePosition;
+	uint32_t getWritePosition(void) const;
+
+private:
+
+	PipeBuffer(const PipeBuffer&)=delete;
+	PipeBuffer& operator=(const PipeBuffer&)=delete;
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// CreateRingSection (static)
+	//
+	// Creates the section that will contain the ring
+	static std::unique_ptr<MappedFile> CreateRingSection(size_t capacity);
+
+	// InitializeRing (static)
+	//
+	// Initializes the ring in a mapped view of the section
+	static void* InitializeRing(const std::unique_ptr<MappedFileView>& view);
+
+	// ReadRing
+	//
+	// Implements Read() and Peek()
+	uapi::size_t ReadRing(void* buffer, uapi::size_t count, bool nonblock, bool peek);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	const std::unique_ptr<MappedFile>		m_section;		// Ring section
+	const std::unique_ptr<MappedFileView>	m_view;			// Ring section view
+	PipeRing								m_ring;			// Data ring
+	HANDLE									m_readable;		// Data available event
+	HANDLE									m_writable;		// Space available event
+	sync::critical_section					m_readcs;		// Reader serialization
+	sync::critical_section					m_writecs;		// Writer serialization
+	PollQueue								m_pollqueue;	// Readiness waiters
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __PIPEBUFFER_H_
@@ -0,0 +1,547 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "PipeFileSystem.h"
+
+#include "FilePermission.h"
+#include "LinuxException.h"
+#include "SystemInformation.h"
+
+#pragma warning(push, 4)
+
+// PipeFileSystem::DefaultCapacity (static)
+//
+// Default capacity of a pipe data ring, matches the default pipe size on Linux
+const size_t PipeFileSystem::DefaultCapacity = (64 KiB);
+
+// PipeFileSystem::PipeNode::s_nextindex (static)
+//
+// Next index number to assign to a pipe node
+std::atomic<uint64_t> PipeFileSystem::PipeNode::s_nextindex{ 1 };
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::CreatePipe (static)
+//
+// Creates an anonymous pipe and returns the read and write end handles
+//
+// Arguments:
+//
+//	flags		- Handle flags to apply to both ends of the pipe
+//	uid			- User ID of the pipe owner
+//	gid			- Group ID of the pipe owner
+
+std::pair<std::shared_ptr<FileSystem::Handle>, std::shared_ptr<FileSystem::Handle>> PipeFileSystem::CreatePipe(FileSystem::HandleFlags flags, 
+	uapi::uid_t uid, uapi::gid_t gid)
+{
+	// Anonymous pipes are always created with read/write permissions for the owner only
+	auto node = std::make_shared<PipeNode>(DefaultCapacity, LINUX_S_IRUSR | LINUX_S_IWUSR, uid, gid);
+
+	return std::make_pair(std::make_shared<PipeHandle>(node, FileSystem::HandleAccess::ReadOnly, flags),
+		std::make_shared<PipeHandle>(node, FileSystem::HandleAccess::WriteOnly, flags));
+}
+
+//
+// PIPEFILESYSTEM::PIPEHANDLE
+//
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle Constructor
+//
+// Arguments:
+//
+//	node		- Pipe node instance
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+PipeFileSystem::PipeHandle::PipeHandle(std::shared_ptr<PipeNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+	: m_node(std::move(node)), m_access(access), m_flags(flags)
+{
+	m_node->AddHandle(m_access);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle Destructor
+
+PipeFileSystem::PipeHandle::~PipeHandle()
+{
+	m_node->ReleaseHandle(m_access);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess PipeFileSystem::PipeHandle::getAccess(void) const
+{
+	return m_access;
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> PipeFileSystem::PipeHandle::Duplicate(void) const
+{
+	return std::make_shared<PipeHandle>(m_node, m_access, m_flags);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::getFlags
+//
+// Gets the flags specified on the handle
+
+FileSystem::HandleFlags PipeFileSystem::PipeHandle::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::Poll
+//
+// Gets the current POLLxxx readiness of the handle
+//
+// Arguments:
+//
+//	NONE
+
+uint32_t PipeFileSystem::PipeHandle::Poll(void) const
+{
+	return m_node->Poll(m_access);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t PipeFileSystem::PipeHandle::Read(void* buffer, uapi::size_t count)
+{
+	// Attempting to read from a write-only handle yields EBADF
+	if(m_access == FileSystem::HandleAccess::WriteOnly) throw LinuxException(LINUX_EBADF);
+
+	return m_node->Read(buffer, count, ((m_flags & FileSystem::HandleFlags::NonBlocking) ? true : false));
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t PipeFileSystem::PipeHandle::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	// Pipes do not support positional reads
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t PipeFileSystem::PipeHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ENOTDIR);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset into the node data to seek, relative to whence
+//	whence		- Position in the node data that offset is relative to
+
+uapi::loff_t PipeFileSystem::PipeHandle::Seek(uapi::loff_t offset, int whence)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(whence);
+
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void PipeFileSystem::PipeHandle::Sync(void) const
+{
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void PipeFileSystem::PipeHandle::SyncData(void) const
+{
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::Subscribe
+//
+// Registers a waiter to be signaled when the readiness of the handle changes
+//
+// Arguments:
+//
+//	waiter		- Waiter to be registered
+
+void PipeFileSystem::PipeHandle::Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter)
+{
+	m_node->Subscribe(std::move(waiter));
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::Unsubscribe
+//
+// Removes a previously registered waiter
+//
+// Arguments:
+//
+//	waiter		- Waiter to be removed
+
+void PipeFileSystem::PipeHandle::Unsubscribe(const FileSystem::PollWaiter* waiter)
+{
+	m_node->Unsubscribe(waiter);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t PipeFileSystem::PipeHandle::Write(const void* buffer, uapi::size_t count)
+{
+	// Attempting to write to a read-only handle yields EBADF
+	if(m_access == FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EBADF);
+
+	return m_node->Write(buffer, count, ((m_flags & FileSystem::HandleFlags::NonBlocking) ? true : false));
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeHandle::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t PipeFileSystem::PipeHandle::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	// Pipes do not support positional writes
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//
+// PIPEFILESYSTEM::PIPENODE
+//
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode Constructor
+//
+// Arguments:
+//
+//	capacity	- Requested capacity of the pipe data ring
+//	mode		- Initial permissions to assign to the node
+//	uid			- Initial owner user id to assign to the node
+//	gid			- Initial owner group id to assign to the node
+
+PipeFileSystem::PipeNode::PipeNode(size_t capacity, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid) : m_buffer(capacity), 
+	m_index(s_nextindex++), m_ctime(datetime::now()), m_mode((mode & ~LINUX_S_IFMT) | LINUX_S_IFIFO), m_uid(uid), m_gid(gid)
+{
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::AddHandle
+//
+// Registers a handle against the read and/or write end of the pipe
+//
+// Arguments:
+//
+//	access		- Access mode of the handle being registered
+
+void PipeFileSystem::PipeNode::AddHandle(FileSystem::HandleAccess access)
+{
+	if(access != FileSystem::HandleAccess::WriteOnly) m_buffer.AddReader();
+	if(access != FileSystem::HandleAccess::ReadOnly) m_buffer.AddWriter();
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::Open
+//
+// Creates a Handle instance against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this node was resolved
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+std::shared_ptr<FileSystem::Handle> PipeFileSystem::PipeNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+{
+	UNREFERENCED_PARAMETER(mount);
+
+	// Demand the permissions required for the requested access mode
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		if(access != FileSystem::HandleAccess::WriteOnly) FilePermission::Demand(FilePermission::Read, m_uid, m_gid, m_mode);
+		if(access != FileSystem::HandleAccess::ReadOnly) FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+	}
+
+	// todo: opening a FIFO without O_NONBLOCK should block until the opposite end has been opened
+	return std::make_shared<PipeHandle>(shared_from_this(), access, flags);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::Poll
+//
+// Gets the POLLxxx readiness of the read and/or write end of the pipe
+//
+// Arguments:
+//
+//	access		- Access mode of the handle being polled
+
+uint32_t PipeFileSystem::PipeNode::Poll(FileSystem::HandleAccess access) const
+{
+	uint32_t events = 0;
+
+	if(access != FileSystem::HandleAccess::WriteOnly) events |= m_buffer.PollReader();
+	if(access != FileSystem::HandleAccess::ReadOnly) events |= m_buffer.PollWriter();
+
+	return events;
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::Read
+//
+// Reads data from the pipe, blocking until data is available unless nonblock is set
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+//	nonblock	- Flag to fail with EAGAIN rather than block on an empty pipe
+
+uapi::size_t PipeFileSystem::PipeNode::Read(void* buffer, uapi::size_t count, bool nonblock)
+{
+	return m_buffer.Read(buffer, count, nonblock);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::ReleaseHandle
+//
+// Releases a handle from the read and/or write end of the pipe
+//
+// Arguments:
+//
+//	access		- Access mode of the handle being released
+
+void PipeFileSystem::PipeNode::ReleaseHandle(FileSystem::HandleAccess access)
+{
+	if(access != FileSystem::HandleAccess::WriteOnly) m_buffer.ReleaseReader();
+	if(access != FileSystem::HandleAccess::ReadOnly) m_buffer.ReleaseWriter();
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void PipeFileSystem::PipeNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	// todo: CAP_CHOWN - see chown(2), there is more to this
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+
+	m_uid = uid;
+	m_gid = gid;
+	m_ctime = datetime::now();
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void PipeFileSystem::PipeNode::SetPermissions(uapi::mode_t permissions)
+{
+	permissions &= ~LINUX_S_IFMT;		// Strip off non-permissions
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+
+	m_mode = ((m_mode & LINUX_S_IFMT) | permissions);
+	m_ctime = datetime::now();
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::Stat
+//
+// Provides statistical information about this node
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void PipeFileSystem::PipeNode::Stat(uapi::stat* stats) const
+{
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	memset(stats, 0, sizeof(uapi::stat));
+
+	stats->st_dev		= (0 << 16) | 0;	// TODO: DEVICE ID; MAJOR WILL BE ZERO MINOR SHOULD AUTO-INCREMENT
+	stats->st_ino		= m_index;
+	stats->st_nlink		= 1;
+	stats->st_mode		= m_mode;
+	stats->st_uid		= m_uid;
+	stats->st_gid		= m_gid;
+	stats->st_blksize	= SystemInformation::PageSize;
+	stats->st_size		= static_cast<decltype(stats->st_size)>(m_buffer.Available);
+	stats->st_atime		= convert<uapi::timespec>(m_ctime);
+	stats->st_mtime		= convert<uapi::timespec>(m_ctime);
+	stats->st_ctime		= convert<uapi::timespec>(m_ctime);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::Subscribe
+//
+// Registers a waiter to be signaled when the readiness of the pipe changes
+//
+// Arguments:
+//
+//	waiter		- Waiter to be registered
+
+void PipeFileSystem::PipeNode::Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter)
+{
+	m_buffer.Subscribe(std::move(waiter));
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::getType
+//
+// Gets the type of node being represented in the file system
+
+FileSystem::NodeType PipeFileSystem::PipeNode::getType(void) const
+{
+	return FileSystem::NodeType::Pipe;
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::Unsubscribe
+//
+// Removes a previously registered waiter
+//
+// Arguments:
+//
+//	waiter		- Waiter to be removed
+
+void PipeFileSystem::PipeNode::Unsubscribe(const FileSystem::PollWaiter* waiter)
+{
+	m_buffer.Unsubscribe(waiter);
+}
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem::PipeNode::Write
+//
+// Writes data into the pipe, blocking until all data is written unless nonblock is set
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+//	nonblock	- Flag to fail with EAGAIN rather than block on a full pipe
+
+uapi::size_t PipeFileSystem::PipeNode::Write(const void* buffer, uapi::size_t count, bool nonblock)
+{
+	return m_buffer.Write(buffer, count, nonblock);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,286 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __PIPEFILESYSTEM_H_
+#define __PIPEFILESYSTEM_H_
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include "FileSystem.h"
+#include "PipeBuffer.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// PipeFileSystem
+//
+// PipeFileSystem implements anonymous pipes, similar in purpose to pipefs on Linux.
+// It cannot be mounted; pipe nodes are only reachable through the handles that
+// are returned from CreatePipe() or by opening a FIFO that refers to the node.
+//
+// Pipe data is kept in a single-producer/single-consumer ring that is allocated in
+// a page file backed section rather than in the service heap (see PipeBuffer).  Reads
+// and writes are serviced entirely within the service; the service waits when the
+// ring is full or empty and reports EPIPE (SIGPIPE) when the read end has been closed.
+
+class PipeFileSystem
+{
+public:
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// CreatePipe (static)
+	//
+	// Creates an anonymous pipe and returns the read and write end handles
+	static std::pair<std::shared_ptr<FileSystem::Handle>, std::shared_ptr<FileSystem::Handle>> CreatePipe(FileSystem::HandleFlags flags, 
+		uapi::uid_t uid, uapi::gid_t gid);
+
+	//-------------------------------------------------------------------------
+	// Fields
+
+	// DefaultCapacity (static)
+	//
+	// Default capacity of a pipe data ring, in bytes
+	static const size_t DefaultCapacity;
+
+private:
+
+	PipeFileSystem()=delete;
+	~PipeFileSystem()=delete;
+	PipeFileSystem(const PipeFileSystem&)=delete;
+	PipeFileSystem& operator=(const PipeFileSystem&)=delete;
+
+	// Forward Declarations
+	//
+	class PipeNode;
+
+	// PipeFileSystem::PipeHandle
+	//
+	class PipeHandle : public FileSystem::Handle, public FileSystem::Pollable
+	{
+	public:
+
+		// Instance Constructor
+		//
+		PipeHandle(std::shared_ptr<PipeNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+
+		// Destructor
+		//
+		~PipeHandle();
+
+		//---------------------------------------------------------------------
+		// FileSystem::Handle Implementation
+
+		// Duplicate
+		//
+		// Creates a duplicate Handle instance
+		virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+		// Read
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+		// ReadAt
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+		// Seek
+		//
+		// Changes the file position
+		virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+		// Sync
+		//
+		// Synchronizes all metadata and data associated with the file to storage
+		virtual void Sync(void) const override;
+
+		// SyncData
+		//
+		// Synchronizes all data associated with the file to storage, not metadata
+		virtual void SyncData(void) const override;
+
+		// Write
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+		// WriteAt
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+		// Access
+		//
+		// Gets the access mode used when the handle was created
+		virtual FileSystem::HandleAccess getAccess(void) const override;
+
+		// Flags
+		//
+		// Gets the flags used when the handle was created
+		virtual FileSystem::HandleFlags getFlags(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Pollable Implementation
+
+		// Poll
+		//
+		// Gets the current POLLxxx readiness of the handle
+		virtual uint32_t Poll(void) const override;
+
+		// Subscribe
+		//
+		// Registers a waiter to be signaled when the readiness of the handle changes
+		virtual void Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter) override;
+
+		// Unsubscribe
+		//
+		// Removes a previously registered waiter
+		virtual void Unsubscribe(const FileSystem::PollWaiter* waiter) override;
+
+	private:
+
+		PipeHandle(const PipeHandle&)=delete;
+		PipeHandle& operator=(const PipeHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<PipeNode>		m_node;			// Pipe node instance
+		const FileSystem::HandleAccess		m_access;		// Handle access mode
+		const FileSystem::HandleFlags		m_flags;		// Handle flags
+	};
+
+	// PipeFileSystem::PipeNode
+	//
+	class PipeNode : public FileSystem::Pipe, public std::enable_shared_from_this<PipeNode>
+	{
+	public:
+
+		// Instance Constructor
+		//
+		PipeNode(size_t capacity, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid);
+
+		// Destructor
+		//
+		~PipeNode()=default;
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// AddHandle
+		//
+		// Registers a handle against the read and/or write end of the pipe
+		void AddHandle(FileSystem::HandleAccess access);
+
+		// Read
+		//
+		// Reads data from the pipe, blocking until data is available unless nonblock is set
+		uapi::size_t Read(void* buffer, uapi::size_t count, bool nonblock);
+
+		// Poll
+		//
+		// Gets the POLLxxx readiness of the read and/or write end of the pipe
+		uint32_t Poll(FileSystem::HandleAccess access) const;
+
+		// ReleaseHandle
+		//
+		// Releases a handle from the read and/or write end of the pipe
+		void ReleaseHandle(FileSystem::HandleAccess access);
+
+		// Subscribe
+		//
+		// Registers a waiter to be signaled when the readiness of the pipe changes
+		void Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter);
+
+		// Unsubscribe
+		//
+		// Removes a previously registered waiter
+		void Unsubscribe(const FileSystem::PollWaiter* waiter);
+
+		// Write
+		//
+		// Writes data into the pipe, blocking until all data is written unless nonblock is set
+		uapi::size_t Write(const void* buffer, uapi::size_t count, bool nonblock);
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a FileSystem::Handle instance for this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about this node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// Type
+		//
+		// Gets the type of file system node being represented
+		virtual FileSystem::NodeType getType(void) const override;
+
+	private:
+
+		PipeNode(const PipeNode&)=delete;
+		PipeNode& operator=(const PipeNode&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		static std::atomic<uint64_t>			s_nextindex;	// Next node index number
+
+		PipeBuffer								m_buffer;		// Pipe data buffer
+		mutable sync::critical_section			m_cs;			// Metadata serialization
+		const uint64_t							m_index;		// Node index number
+		datetime								m_ctime;		// Change timestamp
+		uapi::mode_t							m_mode;			// Type and permissions
+		uapi::uid_t								m_uid;			// Owner user id
+		uapi::gid_t								m_gid;			// Owner group id
+	};
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __PIPEFILESYSTEM_H_
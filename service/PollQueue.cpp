@@ -0,0 +1,97 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "PollQueue.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// PollQueue::Notify
+//
+// Signals all subscribed waiters that the readiness of the object has changed
+//
+// Arguments:
+//
+//	events		- POLLxxx events that may have changed
+
+void PollQueue::Notify(uint32_t events)
+{
+	std::vector<std::shared_ptr<FileSystem::PollWaiter>>	waiters;		// Waiters to be signaled
+
+	// Take strong references to the live waiters and discard any that have expired
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+		if(m_waiters.empty()) return;
+
+		waiters.reserve(m_waiters.size());
+		for(auto iterator = m_waiters.begin(); iterator != m_waiters.end();) {
+
+			auto waiter = iterator->second.lock();
+			if(waiter) { waiters.push_back(std::move(waiter)); ++iterator; }
+			else iterator = m_waiters.erase(iterator);
+		}
+	}
+
+	// Signal the waiters without holding the queue lock
+	for(const auto& waiter : waiters) waiter->Signal(events);
+}
+
+//-----------------------------------------------------------------------------
+// PollQueue::Subscribe
+//
+// Registers a waiter to be signaled when the readiness of the object changes
+//
+// Arguments:
+//
+//	waiter		- Waiter to be registered
+
+void PollQueue::Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter)
+{
+	if(!waiter) return;
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	m_waiters.emplace_back(waiter.get(), waiter);
+}
+
+//-----------------------------------------------------------------------------
+// PollQueue::Unsubscribe
+//
+// Removes a previously registered waiter
+//
+// Arguments:
+//
+//	waiter		- Waiter to be removed
+
+void PollQueue::Unsubscribe(const FileSystem::PollWaiter* waiter)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	for(auto iterator = m_waiters.begin(); iterator != m_waiters.end(); ++iterator) {
+
+		if(iterator->first == waiter) { m_waiters.erase(iterator); return; }
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
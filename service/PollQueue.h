@@ -0,0 +1,97 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __POLLQUEUE_H_
+#define __POLLQUEUE_H_
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include "FileSystem.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// PollQueue
+//
+// Collection of FileSystem::PollWaiter instances that are signaled when the
+// readiness of an object changes.  An object that implements FileSystem::Pollable
+// owns a PollQueue and calls Notify() whenever its POLLxxx state may have changed.
+//
+// Waiters are held weakly; a waiter that has been destroyed without unsubscribing
+// is discarded the next time the queue is notified.  Waiters are signaled after
+// the queue lock has been released, so a waiter may subscribe or unsubscribe from
+// within Signal() without deadlocking against the publisher.
+
+class PollQueue
+{
+public:
+
+	// Instance Constructor
+	//
+	PollQueue()=default;
+
+	// Destructor
+	//
+	~PollQueue()=default;
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Notify
+	//
+	// Signals all subscribed waiters that the readiness of the object has changed
+	void Notify(uint32_t events);
+
+	// Subscribe
+	//
+	// Registers a waiter to be signaled when the readiness of the object changes
+	void Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter);
+
+	// Unsubscribe
+	//
+	// Removes a previously registered waiter
+	void Unsubscribe(const FileSystem::PollWaiter* waiter);
+
+private:
+
+	PollQueue(const PollQueue&)=delete;
+	PollQueue& operator=(const PollQueue&)=delete;
+
+	// waiter_t
+	//
+	// Subscribed waiter and the address used to identify it
+	using waiter_t = std::pair<const FileSystem::PollWaiter*, std::weak_ptr<FileSystem::PollWaiter>>;
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	std::vector<waiter_t>				m_waiters;		// Subscribed waiters
+	sync::critical_section				m_cs;			// Synchronization object
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __POLLQUEUE_H_
@@ -32,6 +32,7 @@
 #include "Pid.h"
 #include "ProcessGroup.h"
 #include "Session.h"
+#include "SignalActions.h"
 #include "Thread.h"
 #include "VirtualMachine.h"
 
@@ -169,7 +170,8 @@ void StartProcess(std::shared_ptr<Process> process, uint32_t timeoutms)
 
 Process::Process(nativeproc_t nativeproc, pid_t pid, session_t session, pgroup_t pgroup, namespace_t ns, uintptr_t ldtaddr, Bitmap&& ldtslots, fspath_t root, fspath_t working) : 
 	m_nativeproc(std::move(nativeproc)), m_pid(std::move(pid)), m_session(std::move(session)), m_pgroup(std::move(pgroup)), m_ns(std::move(ns)), 
-	m_ldtaddr(ldtaddr), m_ldtslots(std::move(ldtslots)), m_root(std::move(root)), m_working(std::move(working))
+	m_ldtaddr(ldtaddr), m_ldtslots(std::move(ldtslots)), m_root(std::move(root)), m_working(std::move(working)), m_sigactions(SignalActions::Create()),
+	m_sigentry(0)
 {
 	// Initialize the pending state change signal information
 	memset(&m_statepending, 0, sizeof(uapi::siginfo));
@@ -255,6 +257,7 @@ std::shared_ptr<Process> Process::Create(std::shared_ptr<Pid> pid, std::shared_p
 
 	AddProcessGroupProcess(pgroup, process);		// Link to the process group
 	AddSessionProcess(session, process);			// Link to the session
+	process->m_pid->AttachProcess(process);			// Link to the pid namespace(s)
 
 	// Indicate that the process is now running by simulating a SIGCONT
 	process->NotifyStateChange(statechange_t::continued, 0);
@@ -262,6 +265,36 @@ std::shared_ptr<Process> Process::Create(std::shared_ptr<Pid> pid, std::shared_p
 	return process;
 }
 
+//-----------------------------------------------------------------------------
+// Process::GetSectionOffset
+//
+// Gets the memory section that contains an address and the offset of the address into it
+//
+// Arguments:
+//
+//	address		- Address within the process
+
+std::pair<HANDLE, uintptr_t> Process::GetSectionOffset(uintptr_t address) const
+{
+	return m_nativeproc->GetSectionOffset(address);
+}
+
+//-----------------------------------------------------------------------------
+// Process::ReadMemory
+//
+// Reads data from the process address space
+//
+// Arguments:
+//
+//	address		- Starting address from which to read
+//	buffer		- Destination buffer
+//	length		- Number of bytes to read from the process
+
+size_t Process::ReadMemory(uintptr_t address, void* buffer, size_t length) const
+{
+	return m_nativeproc->ReadMemory(address, buffer, length);
+}
+
 //-----------------------------------------------------------------------------
 // Process::getLocalDescriptorTableAddress
 //
@@ -343,9 +376,8 @@ void Process::NotifyStateChange(statechange_t newstate, int32_t status)
 
 std::shared_ptr<class ProcessGroup> Process::getProcessGroup(void) const
 {
-	// The process group is non-const for a process and requires synchronization
-	sync::critical_section::scoped_lock cs{ m_cs };
-	return m_pgroup;
+	// The process group is swapped atomically and can be read without the lock
+	return std::atomic_load(&m_pgroup);
 }
 
 //-----------------------------------------------------------------------------
@@ -377,9 +409,8 @@ std::shared_ptr<FileSystem::Path> Process::getRootPath(void) const
 
 std::shared_ptr<class Session> Process::getSession(void) const
 {
-	// The session is non-const for a process and requires synchronization
-	sync::critical_section::scoped_lock cs{ m_cs };
-	return m_session;
+	// The session is swapped atomically and can be read without the lock
+	return std::atomic_load(&m_session);
 }
 
 //-----------------------------------------------------------------------------
@@ -394,7 +425,7 @@ std::shared_ptr<class Session> Process::getSession(void) const
 void Process::SetProcessGroup(std::shared_ptr<class ProcessGroup> pgroup)
 {
 	sync::critical_section::scoped_lock cs{ m_cs };
-	m_pgroup = SwapProcessGroupProcess(m_pgroup, pgroup, this);
+	std::atomic_store(&m_pgroup, SwapProcessGroupProcess(m_pgroup, pgroup, this));
 }
 
 //-----------------------------------------------------------------------------
@@ -410,8 +441,71 @@ void Process::SetProcessGroup(std::shared_ptr<class ProcessGroup> pgroup)
 void Process::SetSession(std::shared_ptr<class Session> session, std::shared_ptr<class ProcessGroup> pgroup)
 {
 	sync::critical_section::scoped_lock cs{ m_cs };
-	m_session = SwapSessionProcess(m_session, session, this);
-	m_pgroup = SwapProcessGroupProcess(m_pgroup, pgroup, this);
+	std::atomic_store(&m_session, SwapSessionProcess(m_session, session, this));
+	std::atomic_store(&m_pgroup, SwapProcessGroupProcess(m_pgroup, pgroup, this));
+}
+
+//-----------------------------------------------------------------------------
+// Process::Signal
+//
+// Sends a signal to this process
+//
+// Arguments:
+//
+//	siginfo		- Signal information
+
+void Process::Signal(uapi::siginfo const& siginfo)
+{
+	std::shared_ptr<Thread>		target;			// Thread to receive the signal
+
+	uapi::sigset_t mask = uapi::sigmask(siginfo.si_signo);
+
+	// Process-directed signals are delivered to the first thread that does not have
+	// the signal blocked; if they all do it's left pending on the first thread
+	{
+		sync::critical_section::scoped_lock cs{ m_cs };
+
+		for(auto const& iterator : m_threads) {
+
+			auto thread = iterator.second.lock();
+			if(thread == nullptr) continue;
+
+			if(target == nullptr) target = thread;
+			if((thread->BlockedSignals & mask) == 0) { target = std::move(thread); break; }
+		}
+	}
+
+	if(target) target->Signal(siginfo);
+}
+
+//-----------------------------------------------------------------------------
+// Process::getSignalActions
+//
+// Gets the signal actions collection for this process
+
+std::shared_ptr<class SignalActions> Process::getSignalActions(void) const
+{
+	return m_sigactions;
+}
+
+//-----------------------------------------------------------------------------
+// Process::getSignalEntryPoint
+//
+// Gets the host signal entry point address
+
+uintptr_t Process::getSignalEntryPoint(void) const
+{
+	return m_sigentry;
+}
+
+//-----------------------------------------------------------------------------
+// Process::putSignalEntryPoint
+//
+// Sets the host signal entry point address
+
+void Process::putSignalEntryPoint(uintptr_t value)
+{
+	m_sigentry = value;
 }
 
 //-----------------------------------------------------------------------------
@@ -24,11 +24,13 @@
 #define __PROCESS_H_
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <utility>
 #include "Architecture.h"
 #include "Bitmap.h"
 #include "FileSystem.h"
@@ -42,6 +44,7 @@ class NativeProcess;
 class Pid;
 class ProcessGroup;
 class Session;
+class SignalActions;
 class Thread;
 
 //-----------------------------------------------------------------------------
@@ -90,6 +93,16 @@ public:
 		std::shared_ptr<class Namespace> ns, std::shared_ptr<FileSystem::Path> root, std::shared_ptr<FileSystem::Path> working, char_t const* path,
 		char_t const* const* arguments, char_t const* const* environment);
 
+	// GetSectionOffset
+	//
+	// Gets the memory section that contains an address and the offset of the address into it
+	std::pair<HANDLE, uintptr_t> GetSectionOffset(uintptr_t address) const;
+
+	// ReadMemory
+	//
+	// Reads data from the process address space
+	size_t ReadMemory(uintptr_t address, void* buffer, size_t length) const;
+
 	// SetProcessGroup
 	//
 	// Changes the process group that this process is a member of
@@ -100,6 +113,11 @@ public:
 	// Changes the session that this process is a member of
 	void SetSession(std::shared_ptr<class Session> session, std::shared_ptr<class ProcessGroup> pgroup);
 
+	// Signal
+	//
+	// Sends a signal to this process
+	void Signal(uapi::siginfo const& siginfo);
+
 	//-------------------------------------------------------------------------
 	// Properties
 
@@ -145,6 +163,19 @@ public:
 	__declspec(property(get=getSession)) std::shared_ptr<class Session> Session;
 	std::shared_ptr<class Session> getSession(void) const;
 
+	// SignalActions
+	//
+	// Gets the signal actions collection for this process
+	__declspec(property(get=getSignalActions)) std::shared_ptr<class SignalActions> SignalActions;
+	std::shared_ptr<class SignalActions> getSignalActions(void) const;
+
+	// SignalEntryPoint
+	//
+	// Gets/sets the host signal entry point address
+	__declspec(property(get=getSignalEntryPoint, put=putSignalEntryPoint)) uintptr_t SignalEntryPoint;
+	uintptr_t getSignalEntryPoint(void) const;
+	void putSignalEntryPoint(uintptr_t value);
+
 	// WorkingPath
 	//
 	// Gets the process working path
@@ -186,6 +217,11 @@ private:
 	// Session shared pointer
 	using session_t = std::shared_ptr<class Session>;
 
+	// sigactions_t
+	//
+	// SignalActions shared pointer
+	using sigactions_t = std::shared_ptr<class SignalActions>;
+
 	// statechange_t
 	//
 	// Indicates the type of state change that has occurred
@@ -260,6 +296,11 @@ private:
 	fspath_t							m_root;				// Process root path
 	fspath_t							m_working;			// Process working path
 
+	// Signals
+	//
+	sigactions_t const					m_sigactions;		// Signal actions
+	std::atomic<uintptr_t>				m_sigentry;			// Host signal entry point
+
 	// Threads
 	//
 	thread_map_t						m_threads;			// Collection of threads
@@ -42,9 +42,8 @@
 
 std::shared_ptr<ProcessGroup> AddProcessGroupProcess(std::shared_ptr<ProcessGroup> pgroup, std::shared_ptr<Process> process)
 {
-	sync::critical_section::scoped_lock cs{ pgroup->m_cs };
-	if(!pgroup->m_processes.emplace(process.get(), process).second) throw LinuxException{ LINUX_ENOMEM };
-
+	// Adding a process that is already a member has no effect
+	pgroup->m_processes.Add(process);
 	return pgroup;
 }
 
@@ -60,8 +59,7 @@ std::shared_ptr<ProcessGroup> AddProcessGroupProcess(std::shared_ptr<ProcessGrou
 
 void RemoveProcessGroupProcess(std::shared_ptr<ProcessGroup> pgroup, Process const* process)
 {
-	sync::critical_section::scoped_lock cs{ pgroup->m_cs };
-	pgroup->m_processes.erase(process);
+	pgroup->m_processes.Remove(process);
 }
 
 //-----------------------------------------------------------------------------
@@ -77,17 +75,9 @@ void RemoveProcessGroupProcess(std::shared_ptr<ProcessGroup> pgroup, Process con
 
 std::shared_ptr<ProcessGroup> SwapProcessGroupProcess(std::shared_ptr<ProcessGroup> source, std::shared_ptr<ProcessGroup> dest, Process const* process)
 {
-	sync::critical_section::scoped_lock csfrom{ source->m_cs };
-	sync::critical_section::scoped_lock csto{ dest->m_cs };
-
-	// Move the weak_ptr to the process from the source process group into the destination process group,
-	// watch that unodered_map::at() will throw std::out_of_range exception if the key is not found
-	try {
+	if(source == dest) return dest;
 
-		if(!dest->m_processes.emplace(process, std::move(source->m_processes.at(process))).second) throw LinuxException{ LINUX_ENOMEM };
-		source->m_processes.erase(process);
-	}
-	catch(std::out_of_range&) { throw LinuxException{ LINUX_ESRCH }; }
+	if(!ProcessGroup::process_list_t::Move(source->m_processes, dest->m_processes, process)) throw LinuxException{ LINUX_ESRCH };
 
 	return dest;
 }
@@ -128,11 +118,22 @@ std::shared_ptr<ProcessGroup> ProcessGroup::Create(std::shared_ptr<Pid> pgid, st
 	auto pgroup = std::make_shared<ProcessGroup>(std::move(pgid), session);
 
 	// The parent container link has to be established after the shared_ptr has been constructed
-	AddSessionProcessGroup(session, pgroup);
+	AddSessionProcessGroup(session, pgroup);			// Link to the session
+	pgroup->m_pgid->AttachProcessGroup(pgroup);		// Link to the pid namespace(s)
 
 	return pgroup;
 }
 
+//-----------------------------------------------------------------------------
+// ProcessGroup::getProcesses
+//
+// Gets a snapshot of the processes in this process group
+
+std::vector<std::shared_ptr<Process>> ProcessGroup::getProcesses(void) const
+{
+	return m_processes.Members;
+}
+
 //-----------------------------------------------------------------------------
 // ProcessGroup::getProcessGroupId
 //
@@ -143,6 +144,27 @@ std::shared_ptr<Pid> ProcessGroup::getProcessGroupId(void) const
 	return m_pgid;
 }
 
+//-----------------------------------------------------------------------------
+// ProcessGroup::Signal
+//
+// Sends a signal to every process in the process group
+//
+// Arguments:
+//
+//	siginfo		- Signal information
+
+void ProcessGroup::Signal(uapi::siginfo const& siginfo) const
+{
+	// Walk the current snapshot without holding the lock; processes that join the
+	// group after the snapshot was taken do not receive the signal
+	auto snapshot = m_processes.Snapshot;
+	for(auto const& entry : *snapshot) {
+
+		auto process = entry.lock();
+		if(process) process->Signal(siginfo);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // ProcessGroup::getSession
 //
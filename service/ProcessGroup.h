@@ -25,7 +25,8 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
+#include <vector>
+#include "Membership.h"
 
 #pragma warning(push, 4)
 
@@ -40,6 +41,9 @@ class Session;
 //
 // Implements a process group, which is a collection of processes that can be 
 // managed as a single entity
+//
+// Readers walk a snapshot of the membership without acquiring the lock, see
+// the Membership class for details
 
 class ProcessGroup
 {
@@ -75,9 +79,20 @@ public:
 	// Creates a new process group instance
 	static std::shared_ptr<ProcessGroup> Create(std::shared_ptr<Pid> pgid, std::shared_ptr<class Session> session);
 
+	// Signal
+	//
+	// Sends a signal to every process in the process group
+	void Signal(uapi::siginfo const& siginfo) const;
+
 	//-------------------------------------------------------------------------
 	// Properties
 
+	// Processes
+	//
+	// Gets a snapshot of the processes in this process group
+	__declspec(property(get=getProcesses)) std::vector<std::shared_ptr<Process>> Processes;
+	std::vector<std::shared_ptr<Process>> getProcesses(void) const;
+
 	// ProcessGroupId
 	//
 	// Gets the process group identifier
@@ -100,10 +115,10 @@ private:
 	// Pid shared pointer
 	using pid_t = std::shared_ptr<Pid>;
 
-	// process_map_t
+	// process_list_t
 	//
-	// Collection of process instances
-	using process_map_t = std::unordered_map<Process const*, std::weak_ptr<Process>>;
+	// Collection of member processes
+	using process_list_t = Membership<Process>;
 
 	// session_t
 	//
@@ -120,8 +135,7 @@ private:
 
 	pid_t const						m_pgid;			// Process group identifier
 	session_t const					m_session;		// Parent session instance
-	process_map_t					m_processes;	// Collection of processes
-	mutable sync::critical_section	m_cs;			// Synchronization object
+	process_list_t					m_processes;	// Collection of processes
 };
 
 //-----------------------------------------------------------------------------
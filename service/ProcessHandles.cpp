@@ -23,6 +23,7 @@
 #include "stdafx.h"
 #include "ProcessHandles.h"
 
+#include <vector>
 #include "LinuxException.h"
 
 #pragma warning(push, 4)
@@ -34,7 +35,7 @@
 //
 //	NONE
 
-ProcessHandles::ProcessHandles() : m_fdpool{ MIN_FD_INDEX } 
+ProcessHandles::ProcessHandles() : ProcessHandles(new table_t(INITIAL_FD_COUNT))
 {
 }
 
@@ -43,11 +44,20 @@ ProcessHandles::ProcessHandles() : m_fdpool{ MIN_FD_INDEX }
 //
 // Arguments:
 //
-//	handles		- Existing collection of handles to use
-//	fdpool		- Existing pool of handle indices to use
+//	table		- Existing table to take ownership of
 
-ProcessHandles::ProcessHandles(handle_map_t&& handles, IndexPool<int>&& fdpool) : m_handles{ std::move(handles) }, m_fdpool{ std::move(fdpool) } 
+ProcessHandles::ProcessHandles(table_t* table) : m_table{ table }, m_epoch{ 0 }
 {
+	m_readers[0] = m_readers[1] = 0;
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles Destructor
+
+ProcessHandles::~ProcessHandles()
+{
+	// There can be no outstanding readers at this point, release the table
+	Release(m_table.load());
 }
 
 //-----------------------------------------------------------------------------
@@ -61,15 +71,35 @@ ProcessHandles::ProcessHandles(handle_map_t&& handles, IndexPool<int>&& fdpool)
 
 int ProcessHandles::Add(std::shared_ptr<FileSystem::Handle> handle)
 {
-	handle_lock_t::scoped_lock_write writer(m_handlelock);
+	return Add(std::move(handle), false);
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::Add
+//
+// Adds a file system handle to the collection
+//
+// Arguments:
+//
+//	handle			- Handle instance to be added to the process
+//	closeonexec		- Flag to close the file descriptor on execve()
+
+int ProcessHandles::Add(std::shared_ptr<FileSystem::Handle> handle, bool closeonexec)
+{
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	table_t* table = Unshare(m_table.load());
 
-	// Allocate a new file descriptor for the handle and insert it
-	int index = m_fdpool.Allocate();
-	if(m_handles.emplace(index, std::move(handle)).second) return index;
+	// Locate the lowest available file descriptor, growing the table if necessary
+	uint32_t fd = table->fdmap.FindClear();
+	if(fd == Bitmap::NotFound) {
 
-	// Insertion failed, release the index back to the pool and throw
-	m_fdpool.Release(index);
-	throw LinuxException{ LINUX_EBADF };
+		if(table->size >= MAX_FD_COUNT) throw LinuxException{ LINUX_EMFILE };
+		fd = table->size;
+		table = Grow(table, fd);
+	}
+
+	return Insert(table, fd, std::move(handle), closeonexec);
 }
 
 //-----------------------------------------------------------------------------
@@ -84,11 +114,34 @@ int ProcessHandles::Add(std::shared_ptr<FileSystem::Handle> handle)
 
 int ProcessHandles::Add(int fd, std::shared_ptr<FileSystem::Handle> handle)
 {
-	handle_lock_t::scoped_lock_write writer(m_handlelock);
+	return Add(fd, std::move(handle), false);
+}
 
-	// Attempt to insert the handle using the specified index
-	if(m_handles.emplace(fd, std::move(handle)).second) return fd;
-	throw LinuxException{ LINUX_EBADF };
+//-----------------------------------------------------------------------------
+// ProcessHandles::Add
+//
+// Adds a file system handle to the collection with a specific file descriptor
+//
+// Arguments:
+//
+//	fd				- Specific file descriptor index to use
+//	handle			- Handle instance to be added to the process
+//	closeonexec		- Flag to close the file descriptor on execve()
+
+int ProcessHandles::Add(int fd, std::shared_ptr<FileSystem::Handle> handle, bool closeonexec)
+{
+	if((fd < 0) || (static_cast<uint32_t>(fd) >= MAX_FD_COUNT)) throw LinuxException{ LINUX_EBADF };
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	// Grow the table if the specified file descriptor lies beyond the end of it
+	table_t* table = Unshare(m_table.load());
+	if(static_cast<uint32_t>(fd) >= table->size) table = Grow(table, fd);
+
+	// The specified file descriptor cannot already be in use
+	if(table->fdmap[fd]) throw LinuxException{ LINUX_EBADF };
+
+	return Insert(table, fd, std::move(handle), closeonexec);
 }
 
 //-----------------------------------------------------------------------------
@@ -117,18 +170,49 @@ std::shared_ptr<ProcessHandles> ProcessHandles::Create(void)
 
 std::shared_ptr<ProcessHandles> ProcessHandles::Duplicate(std::shared_ptr<ProcessHandles> existing)
 {
-	handle_map_t		handles;						// New collection for the duplicate handles
-	IndexPool<int>		fdpool(existing->m_fdpool);		// Index pool for the new collection
+	// The existing collection needs to be locked against writers during duplication
+	sync::critical_section::scoped_lock cs{ existing->m_cs };
+
+	// The new collection shares the existing table until either side modifies it;
+	// the handles are shared as well, as with the open file descriptions in fork(2)
+	table_t* table = existing->m_table.load();
+	table->owners++;
+
+	try { return std::make_shared<ProcessHandles>(table); }
+	catch(...) { Release(table); throw; }
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::EnterRead (private)
+//
+// Enters a lock-free read-side section, returns the entered epoch
+//
+// Arguments:
+//
+//	NONE
+
+uint32_t ProcessHandles::EnterRead(void) const
+{
+	// Register as a reader of the current epoch; any table or entry that
+	// is unpublished by a writer after this will not be released until exit
+	uint32_t epoch = m_epoch.load();
+	m_readers[epoch & 1].fetch_add(1);
 
-	// The existing collection needs to be locked for read access during duplication
-	handle_lock_t::scoped_lock_read reader(existing->m_handlelock);
+	return epoch;
+}
 
-	// Iterate over the existing collection and duplicate each handle with the same flags
-	for(const auto& iterator : existing->m_handles)
-		if(!handles.emplace(iterator.first, std::move(iterator.second->Duplicate())).second) throw LinuxException(LINUX_EBADF);
+//-----------------------------------------------------------------------------
+// ProcessHandles::ExitRead (private)
+//
+// Exits a lock-free read-side section
+//
+// Arguments:
+//
+//	epoch		- Epoch value returned from EnterRead
 
-	// Create the ProcessHandles instance with the duplicated collection
-	return std::make_shared<ProcessHandles>(std::move(handles), std::move(fdpool));
+void ProcessHandles::ExitRead(uint32_t epoch) const
+{
+	m_readers[epoch & 1].fetch_sub(1);
 }
 
 //-----------------------------------------------------------------------------
@@ -140,12 +224,124 @@ std::shared_ptr<ProcessHandles> ProcessHandles::Duplicate(std::shared_ptr<Proces
 //
 //	fd			- File descriptor of the target handle
 
-std::shared_ptr<FileSystem::Handle> ProcessHandles::Get(int fd)
+std::shared_ptr<FileSystem::Handle> ProcessHandles::Get(int fd) const
+{
+	std::shared_ptr<FileSystem::Handle>		handle;			// Handle to return
+
+	if(fd < 0) throw LinuxException{ LINUX_EBADF };
+
+	// Copy the handle from the table slot inside of a read-side section,
+	// the entry cannot be released by a writer until after exiting it
+	uint32_t epoch = EnterRead();
+	const table_t* table = m_table.load();
+	if(static_cast<uint32_t>(fd) < table->size) {
+
+		entry_t* entry = table->slots[fd].load();
+		if(entry) handle = *entry;
+	}
+	ExitRead(epoch);
+
+	if(!handle) throw LinuxException{ LINUX_EBADF };
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::getCloseOnExecute
+//
+// Gets the close-on-exec flag for a file descriptor
+
+bool ProcessHandles::getCloseOnExecute(int fd) const
+{
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	const table_t* table = m_table.load();
+	if((fd < 0) || (static_cast<uint32_t>(fd) >= table->size) || (!table->fdmap[fd])) throw LinuxException{ LINUX_EBADF };
+
+	return table->cloexec[fd];
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::putCloseOnExecute
+//
+// Sets the close-on-exec flag for a file descriptor
+
+void ProcessHandles::putCloseOnExecute(int fd, bool value)
+{
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	table_t* table = m_table.load();
+	if((fd < 0) || (static_cast<uint32_t>(fd) >= table->size) || (!table->fdmap[fd])) throw LinuxException{ LINUX_EBADF };
+
+	// Don't take a private copy of the table if the flag isn't changing
+	if(table->cloexec[fd] == value) return;
+	table = Unshare(table);
+
+	if(value) table->cloexec.Set(fd);
+	else table->cloexec.Clear(fd);
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::Grow (private)
+//
+// Replaces the table with a larger one that can hold a file descriptor.  The
+// caller must hold the critical section
+//
+// Arguments:
+//
+//	table		- Current table instance
+//	fd			- File descriptor that the new table must be able to hold
+
+ProcessHandles::table_t* ProcessHandles::Grow(table_t* table, uint32_t fd)
+{
+	// Double the size of the table until it can hold the file descriptor
+	uint32_t size = table->size;
+	while(size <= fd) size <<= 1;
+
+	return Replace(table, std::min(size, uint32_t{ MAX_FD_COUNT }), false);
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::Insert (private)
+//
+// Publishes a new handle entry into a specific unused table slot.  The caller
+// must hold the critical section
+//
+// Arguments:
+//
+//	table			- Current table instance
+//	fd				- File descriptor slot to publish the entry into
+//	handle			- Handle instance to be added to the process
+//	closeonexec		- Flag to close the file descriptor on execve()
+
+int ProcessHandles::Insert(table_t* table, uint32_t fd, std::shared_ptr<FileSystem::Handle>&& handle, bool closeonexec)
 {
-	handle_lock_t::scoped_lock_read reader(m_handlelock);
+	_ASSERTE(fd < table->size);
+	_ASSERTE(!table->fdmap[fd]);
+
+	// Allocate the entry before changing anything, this is the only thing that can fail
+	entry_t* entry = new(std::nothrow) entry_t(std::move(handle));
+	if(entry == nullptr) throw LinuxException{ LINUX_ENOMEM };
+
+	table->fdmap.Set(fd);
+	if(closeonexec) table->cloexec.Set(fd);
+
+	table->slots[fd] = entry;				// Publish the entry to the readers
+	return static_cast<int>(fd);
+}
 
-	try { return m_handles.at(fd); }
-	catch(...) { throw LinuxException{ LINUX_EBADF }; }
+//-----------------------------------------------------------------------------
+// ProcessHandles::Release (private, static)
+//
+// Releases an unpublished table instance; the table is only destroyed once
+// all of the collections that were sharing it have released it
+//
+// Arguments:
+//
+//	table		- Table instance to be released
+
+void ProcessHandles::Release(table_t* table)
+{
+	if(--table->owners == 0) delete table;
 }
 
 //-----------------------------------------------------------------------------
@@ -159,11 +355,26 @@ std::shared_ptr<FileSystem::Handle> ProcessHandles::Get(int fd)
 
 void ProcessHandles::Remove(int fd)
 {
-	handle_lock_t::scoped_lock_write writer(m_handlelock);
+	std::unique_ptr<entry_t>	entry;			// Unpublished handle entry
+
+	if(fd < 0) throw LinuxException{ LINUX_EBADF };
+
+	// The critical section does not need to be held while waiting for the readers
+	{
+		sync::critical_section::scoped_lock cs{ m_cs };
 
-	// Remove the index from the collection and return it to the pool
-	if(m_handles.erase(fd) == 0) throw LinuxException{ LINUX_EBADF };
-	m_fdpool.Release(fd);
+		table_t* table = m_table.load();
+		if((static_cast<uint32_t>(fd) >= table->size) || (!table->fdmap[fd])) throw LinuxException{ LINUX_EBADF };
+		table = Unshare(table);
+
+		// Unpublish the entry and release the file descriptor for reuse
+		entry.reset(table->slots[fd].exchange(nullptr));
+		table->fdmap.Clear(fd);
+		table->cloexec.Clear(fd);
+	}
+
+	// Wait for any readers that may have seen the entry before releasing it
+	Synchronize();
 }
 
 //-----------------------------------------------------------------------------
@@ -177,20 +388,152 @@ void ProcessHandles::Remove(int fd)
 
 void ProcessHandles::RemoveCloseOnExecute(void)
 {
-	handle_lock_t::scoped_lock_write writer(m_handlelock);
+	std::vector<std::unique_ptr<entry_t>>	entries;		// Unpublished handle entries
+
+	// The critical section does not need to be held while waiting for the readers
+	{
+		sync::critical_section::scoped_lock cs{ m_cs };
+
+		// A shared table is replaced with a private copy that omits the close-on-exec
+		// descriptors rather than being copied in its entirety first
+		table_t* table = m_table.load();
+		if(table->owners.load() > 1) { Replace(table, table->size, true); return; }
+
+		// Iterate over the close-on-exec bitmap and unpublish each of the entries
+		for(uint32_t fd = 0; fd < table->size; fd++) {
+
+			if(!table->cloexec[fd]) continue;
+
+			entries.emplace_back(table->slots[fd].exchange(nullptr));
+			table->fdmap.Clear(fd);
+			table->cloexec.Clear(fd);
+		}
+	}
+
+	// Wait for any readers that may have seen the entries before releasing them
+	if(!entries.empty()) Synchronize();
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::Replace (private)
+//
+// Publishes a replacement for the current table.  The caller must hold the
+// critical section
+//
+// Arguments:
+//
+//	table		- Current table instance
+//	size		- Size of the replacement table
+//	execute		- Flag to omit the close-on-exec descriptors from the replacement
+
+ProcessHandles::table_t* ProcessHandles::Replace(table_t* table, uint32_t size, bool execute)
+{
+	_ASSERTE(size >= table->size);
+
+	// Entries of a private table are moved into the replacement, entries of a
+	// shared table are copied since the other owner(s) will still reference them
+	bool shared = (table->owners.load() > 1);
+
+	// Construct the replacement table, the bitmaps are copied and extended with clear bits
+	std::unique_ptr<table_t> replacement = std::make_unique<table_t>(size);
+	replacement->fdmap = table->fdmap;
+	replacement->fdmap.Size = size;
+	replacement->cloexec = table->cloexec;
+	replacement->cloexec.Size = size;
+
+	for(uint32_t index = 0; index < table->size; index++) {
+
+		entry_t* entry = table->slots[index].load();
+		if(entry == nullptr) continue;
 
-	// Iterate over all the contained file system handles to look for CLOEXEC
-	auto iterator = m_handles.begin();
-	while(iterator != m_handles.end()) {
+		// Skip over and release close-on-exec descriptors when executing
+		if(execute && table->cloexec[index]) {
 
-		// If the file handle is set to be closed on execute, remove it
-		// from the member collection
-		// TODO TODO TODO PUT ME BACK
-		//if(iterator->second->CloseOnExec) iterator = m_handles.erase(iterator);
-		/*else*/ ++iterator;
+			replacement->fdmap.Clear(index);
+			replacement->cloexec.Clear(index);
+		}
+
+		else replacement->slots[index] = (shared) ? new entry_t(*entry) : entry;
+	}
+
+	// Publish the replacement table and wait for any readers of the outgoing one
+	m_table = replacement.get();
+	Synchronize();
+
+	// Detach any entries that were moved into the replacement before releasing
+	// the outgoing table, anything left behind in it will be released with it
+	if(!shared) {
+
+		for(uint32_t index = 0; index < table->size; index++)
+			if(table->slots[index].load() == replacement->slots[index].load()) table->slots[index] = nullptr;
+	}
+
+	Release(table);
+	return replacement.release();
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::Synchronize (private)
+//
+// Waits for all readers of previous epochs to exit
+//
+// Arguments:
+//
+//	NONE
+
+void ProcessHandles::Synchronize(void)
+{
+	// Advance the epoch twice, waiting for the readers registered against the
+	// outgoing epoch to drain each time.  A single advance is not sufficient since
+	// a reader can register against the new epoch's counter before it is advanced
+	for(int pass = 0; pass < 2; pass++) {
+
+		uint32_t epoch = m_epoch.fetch_add(1);
+		while(m_readers[epoch & 1].load() != 0) SwitchToThread();
 	}
 }
 
+//-----------------------------------------------------------------------------
+// ProcessHandles::Unshare (private)
+//
+// Ensures that the current table is not shared with another collection.  The
+// caller must hold the critical section
+//
+// Arguments:
+//
+//	table		- Current table instance
+
+ProcessHandles::table_t* ProcessHandles::Unshare(table_t* table)
+{
+	// Only this collection can add owners to the table while the critical section
+	// is held, if it's the only owner there is no need to make a private copy
+	return (table->owners.load() > 1) ? Replace(table, table->size, false) : table;
+}
+
+//
+// PROCESSHANDLES::TABLE_T
+//
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::table_t Constructor
+//
+// Arguments:
+//
+//	size		- Number of file descriptor slots in the table
+
+ProcessHandles::table_t::table_t(uint32_t size) : owners(1), size(size), slots(new std::atomic<entry_t*>[size]), fdmap(size), cloexec(size)
+{
+	for(uint32_t index = 0; index < size; index++) slots[index] = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// ProcessHandles::table_t Destructor
+
+ProcessHandles::table_t::~table_t()
+{
+	for(uint32_t index = 0; index < size; index++) delete slots[index].load();
+}
+
 //-----------------------------------------------------------------------------
 
 #pragma warning(pop)
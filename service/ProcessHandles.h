@@ -24,10 +24,10 @@
 #define __PROCESSHANDLES_H_
 #pragma once
 
+#include <atomic>
 #include <memory>
-#include <unordered_map>
+#include "Bitmap.h"
 #include "FileSystem.h"
-#include "IndexPool.h"
 
 #pragma warning(push, 4)
 
@@ -36,6 +36,17 @@
 //
 // Implements a collection of file system handles that can be duplicated or
 // shared among multiple process instances
+//
+// File descriptors are stored in a dense array indexed by the descriptor and
+// are allocated lowest-available from a bitmap.  Lookups do not acquire a lock;
+// a reader registers itself with the current epoch and writers wait for all
+// readers of the previous epochs to drain before releasing anything that was
+// unpublished from the table (handle entries or an outgrown table)
+//
+// Duplicated collections share the same table until one of them modifies it,
+// at which point that collection takes a private copy (copy-on-write).  This
+// keeps fork() from having to copy the table when the child is just going to
+// call execve(), which drops all close-on-exec descriptors during the copy
 
 class ProcessHandles
 {
@@ -43,11 +54,11 @@ public:
 
 	// Destructor
 	//
-	~ProcessHandles()=default;
+	~ProcessHandles();
 
 	// Array subscript operator
 	//
-	std::shared_ptr<FileSystem::Handle> operator[](int fd) { return Get(fd); }
+	std::shared_ptr<FileSystem::Handle> operator[](int fd) const { return Get(fd); }
 
 	//-------------------------------------------------------------------------
 	// Member Functions
@@ -56,7 +67,9 @@ public:
 	//
 	// Adds a file system handle to the collection
 	int Add(std::shared_ptr<FileSystem::Handle> handle);
+	int Add(std::shared_ptr<FileSystem::Handle> handle, bool closeonexec);
 	int Add(int fd, std::shared_ptr<FileSystem::Handle> handle);
+	int Add(int fd, std::shared_ptr<FileSystem::Handle> handle, bool closeonexec);
 
 	// Create (static)
 	//
@@ -71,7 +84,7 @@ public:
 	// Get
 	//
 	// Accesses a file system handle by the file descriptor
-	std::shared_ptr<FileSystem::Handle> Get(int fd);
+	std::shared_ptr<FileSystem::Handle> Get(int fd) const;
 
 	// Remove
 	//
@@ -83,6 +96,16 @@ public:
 	// Releases all file system handles set for close-on-exec
 	void RemoveCloseOnExecute(void);
 
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// CloseOnExecute
+	//
+	// Gets/sets the close-on-exec flag for a file descriptor
+	__declspec(property(get=getCloseOnExecute, put=putCloseOnExecute)) bool CloseOnExecute[];
+	bool getCloseOnExecute(int fd) const;
+	void putCloseOnExecute(int fd, bool value);
+
 private:
 
 	ProcessHandles(const ProcessHandles&)=delete;
@@ -91,34 +114,97 @@ private:
 	//-------------------------------------------------------------------------
 	// Private Type Declarations
 
-	// MIN_FD_INDEX
+	// INITIAL_FD_COUNT
+	//
+	// Initial number of file descriptor slots in a new table
+	static const uint32_t INITIAL_FD_COUNT = 64;
+
+	// MAX_FD_COUNT
 	//
-	// Minimum allowable file descriptor index
-	static const int MIN_FD_INDEX = 3;
+	// Maximum number of file descriptor slots in a table (see nr_open)
+	static const uint32_t MAX_FD_COUNT = 1048576;
 
-	// handle_lock_t
+	// entry_t
 	//
-	// File system handle collection synchronization object
-	using handle_lock_t = sync::reader_writer_lock;
-	
-	// handle_map_t
+	// Handle entry published into a table slot; never modified once published
+	using entry_t = std::shared_ptr<FileSystem::Handle>;
+
+	// table_t
 	//
-	// Collection of file system handles, keyed on the index (file descriptor)
-	using handle_map_t = std::unordered_map<int, std::shared_ptr<FileSystem::Handle>>;
+	// Dense file descriptor table.  The slots are read without a lock, the
+	// bitmaps are only accessed by writers holding the critical section.  A
+	// table with more than one owner is shared and must never be modified
+	struct table_t
+	{
+		// Instance Constructor / Destructor
+		//
+		table_t(uint32_t size);
+		~table_t();
+
+		std::atomic<long>							owners;		// Owning collections
+		const uint32_t								size;		// Number of slots
+		std::unique_ptr<std::atomic<entry_t*>[]>	slots;		// Published entries
+		Bitmap										fdmap;		// Allocated descriptors
+		Bitmap										cloexec;	// Close-on-exec descriptors
+	};
 
 	//-------------------------------------------------------------------------
 	// Instance Constructors
 	//
 	ProcessHandles();
-	ProcessHandles(handle_map_t&& handles, IndexPool<int>&& fdpool);
+	ProcessHandles(table_t* table);
 	friend class std::_Ref_count_obj<ProcessHandles>;
 
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// EnterRead
+	//
+	// Enters a lock-free read-side section, returns the entered epoch
+	uint32_t EnterRead(void) const;
+
+	// ExitRead
+	//
+	// Exits a lock-free read-side section
+	void ExitRead(uint32_t epoch) const;
+
+	// Grow
+	//
+	// Replaces the table with a larger one that can hold a file descriptor
+	table_t* Grow(table_t* table, uint32_t fd);
+
+	// Insert
+	//
+	// Publishes a new handle entry into a specific unused table slot
+	int Insert(table_t* table, uint32_t fd, std::shared_ptr<FileSystem::Handle>&& handle, bool closeonexec);
+
+	// Release
+	//
+	// Releases an unpublished table instance
+	static void Release(table_t* table);
+
+	// Replace
+	//
+	// Publishes a replacement for the current table
+	table_t* Replace(table_t* table, uint32_t size, bool execute);
+
+	// Unshare
+	//
+	// Ensures that the current table is not shared with another collection
+	table_t* Unshare(table_t* table);
+
+	// Synchronize
+	//
+	// Waits for all readers of previous epochs to exit
+	void Synchronize(void);
+
 	//-------------------------------------------------------------------------
 	// Member Variables
 
-	handle_lock_t			m_handlelock;		// Handle collection lock
-	handle_map_t			m_handles;			// Process file system handles
-	IndexPool<int>			m_fdpool;			// File descriptor index pool
+	mutable sync::critical_section	m_cs;			// Writer serialization
+	std::atomic<table_t*>			m_table;		// Current descriptor table
+	std::atomic<uint32_t>			m_epoch;		// Current reader epoch
+	mutable std::atomic<uint32_t>	m_readers[2];	// Active readers by epoch
 };
 
 //-----------------------------------------------------------------------------
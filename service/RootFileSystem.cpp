@@ -23,14 +23,123 @@
 #include "stdafx.h"
 #include "RootFileSystem.h"
 
+#include <algorithm>
 #include "Capability.h"
+#include "CpioArchive.h"
 #include "FilePermission.h"
 #include "MountOptions.h"
 #include "LinuxException.h"
 #include "SystemInformation.h"
+#include "Win32Exception.h"
 
 #pragma warning(push, 4)
 
+// DIRECTORY_ENTRY_SIZE
+//
+// Nominal size of a directory entry, used to report the size of a directory node
+static const uapi::loff_t DIRECTORY_ENTRY_SIZE = 20;
+
+// FIRST_COOKIE
+//
+// First enumeration cookie assigned to a child entry; 0 and 1 are "." and ".."
+static const uapi::loff_t FIRST_COOKIE = 2;
+
+// FIRST_INDEX
+//
+// First node index number; the root directory node is always assigned index 2
+static const intptr_t FIRST_INDEX = 2;
+
+// INITIAL_TABLE_CAPACITY
+//
+// Initial number of slots in a directory entry hash table; must be a power of two
+static const size_t INITIAL_TABLE_CAPACITY = 16;
+
+// MAXIMUM_FILE_LENGTH
+//
+// Maximum length of a file in the file system
+static const uapi::loff_t MAXIMUM_FILE_LENGTH = 0x7FFFFFFFFFFFFFFF;
+
+//-----------------------------------------------------------------------------
+// DirectoryEntryType (local)
+//
+// Converts a node type into a linux_dirent64 d_type value
+//
+// Arguments:
+//
+//	type		- Node type to be converted
+
+static uint8_t DirectoryEntryType(FileSystem::NodeType type)
+{
+	switch(type) {
+
+		case FileSystem::NodeType::BlockDevice: return LINUX_DT_BLK;
+		case FileSystem::NodeType::CharacterDevice: return LINUX_DT_CHR;
+		case FileSystem::NodeType::Directory: return LINUX_DT_DIR;
+		case FileSystem::NodeType::File: return LINUX_DT_REG;
+		case FileSystem::NodeType::Pipe: return LINUX_DT_FIFO;
+		case FileSystem::NodeType::Socket: return LINUX_DT_SOCK;
+		case FileSystem::NodeType::SymbolicLink: return LINUX_DT_LNK;
+	}
+
+	return LINUX_DT_UNKNOWN;
+}
+
+//-----------------------------------------------------------------------------
+// HashName (local)
+//
+// Generates the FNV-1a hash code of a directory entry name
+//
+// Arguments:
+//
+//	name		- Entry name
+//	length		- Length of the entry name, in bytes
+
+static uint32_t HashName(const char_t* name, size_t length)
+{
+	uint32_t hash = 2166136261U;
+
+	for(size_t index = 0; index < length; index++) {
+
+		hash ^= static_cast<uint8_t>(name[index]);
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+//-----------------------------------------------------------------------------
+// PackDirectoryEntry (local)
+//
+// Packs a single linux_dirent64 structure into an output buffer, returns zero
+// if the structure will not fit into the remaining buffer space
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Remaining length of the destination buffer, in bytes
+//	ino			- Node index number
+//	offset		- Position of the next entry in the directory
+//	type		- Entry type (DT_xxx)
+//	name		- Entry name
+//	namelength	- Length of the entry name, in bytes
+
+static uapi::size_t PackDirectoryEntry(void* buffer, uapi::size_t count, uint64_t ino, uapi::loff_t offset, uint8_t type, 
+	const char_t* name, size_t namelength)
+{
+	uapi::size_t reclen = align::up(offsetof(uapi::dirent64, d_name) + namelength + 1, 8);
+	if(reclen > count) return 0;
+
+	auto dirent = reinterpret_cast<uapi::dirent64*>(buffer);
+	memset(dirent, 0, reclen);
+	dirent->d_ino = ino;
+	dirent->d_off = offset;
+	dirent->d_reclen = static_cast<uint16_t>(reclen);
+	dirent->d_type = type;
+	memcpy(dirent->d_name, name, namelength);
+
+	return reclen;
+}
+
 //-----------------------------------------------------------------------------
 // RootFileSystem Constructor
 //
@@ -39,10 +148,55 @@
 //	source		- Source/device name to use for the file system
 //	flags		- File system flags and options
 
-RootFileSystem::RootFileSystem(const char_t* source, uint32_t flags) : m_source(source), m_flags(flags), m_fsid(FileSystem::GenerateFileSystemId())
+RootFileSystem::RootFileSystem(const char_t* source, uint32_t flags) : m_source(source), m_flags(flags), m_fsid(FileSystem::GenerateFileSystemId()),
+	m_indexpool(FIRST_INDEX)
 {
 	// No mount-specific flags should be specified for the file system instance
 	_ASSERTE((flags & LINUX_MS_PERMOUNT_MASK) == 0);
+
+	// Create a private heap to contain the file data pages
+	m_heap = HeapCreate(0, 0, 0);
+	if(m_heap == nullptr) throw LinuxException(LINUX_ENOMEM, Win32Exception());
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem Destructor
+
+RootFileSystem::~RootFileSystem()
+{
+	if(m_heap) HeapDestroy(m_heap);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::AddHandle (private)
+//
+// Adds a handle instance to the active handle collection
+//
+// Arguments:
+//
+//	handle		- Handle instance to be tracked
+
+void RootFileSystem::AddHandle(const std::shared_ptr<FileSystem::Handle>& handle)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	if(!m_handles.emplace(handle.get(), handle).second) throw LinuxException(LINUX_ENOMEM);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::AllocatePage (private)
+//
+// Allocates a file data page from the private heap
+//
+// Arguments:
+//
+//	zero		- Flag to zero the contents of the page
+
+uint8_t* RootFileSystem::AllocatePage(bool zero)
+{
+	void* page = HeapAlloc(m_heap, (zero) ? HEAP_ZERO_MEMORY : 0, SystemInformation::PageSize);
+	if(page == nullptr) throw LinuxException(LINUX_ENOSPC);
+
+	return reinterpret_cast<uint8_t*>(page);
 }
 
 //-----------------------------------------------------------------------------
@@ -73,7 +227,7 @@ std::shared_ptr<FileSystem::Mount> RootFileSystem::Mount(const char_t* source, u
 
 	// Break up the standard mounting options bitmask into file system and mount specific masks
 	auto fsflags = options.Flags & (LINUX_MS_RDONLY | LINUX_MS_KERNMOUNT | LINUX_MS_STRICTATIME);
-	auto mountflags = (options.Flags & LINUX_MS_PERMOUNT_MASK) | LINUX_MS_NOEXEC | LINUX_MS_NODEV | LINUX_MS_NOSUID;
+	auto mountflags = options.Flags & LINUX_MS_PERMOUNT_MASK;
 
 	try {
 
@@ -97,12 +251,150 @@ std::shared_ptr<FileSystem::Mount> RootFileSystem::Mount(const char_t* source, u
 
 	// Construct the file system instance and the root directory node instance
 	auto fs = std::make_shared<RootFileSystem>(source, fsflags);
-	auto rootdir = std::make_shared<DirectoryNode>(fs, mode, uid, gid);
+	auto rootdir = std::make_shared<DirectoryNode>(fs, 0, mode, uid, gid);
 
 	// Construct and return the mount instance
 	return std::make_shared<class Mount>(fs, rootdir, mountflags);
 }
 
+//-----------------------------------------------------------------------------
+// RootFileSystem::Populate (static)
+//
+// Bulk loads the contents of an initramfs CPIO archive into a mounted file system
+//
+// Arguments:
+//
+//	mount		- Root file system mount instance
+//	archive		- StreamReader positioned at the start of the CPIO archive
+
+void RootFileSystem::Populate(std::shared_ptr<FileSystem::Mount> mount, const std::unique_ptr<StreamReader>& archive)
+{
+	if(!mount || !archive) throw LinuxException(LINUX_EFAULT);
+
+	// The mount must have been created by this file system
+	auto root = std::dynamic_pointer_cast<DirectoryNode>(mount->Root);
+	if(!root) throw LinuxException(LINUX_EINVAL);
+
+	if(mount->Flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	root->Populate(archive);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::ReleasePage (private)
+//
+// Releases a file data page back to the private heap
+//
+// Arguments:
+//
+//	page		- Page to be released
+
+void RootFileSystem::ReleasePage(uint8_t* page)
+{
+	_ASSERTE(page);
+	HeapFree(m_heap, 0, page);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::RemoveHandle (private)
+//
+// Removes a handle instance from the active handle collection
+//
+// Arguments:
+//
+//	handle		- Handle instance to no longer be tracked
+
+void RootFileSystem::RemoveHandle(FileSystem::Handle* handle)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	m_handles.erase(handle);
+}
+
+//
+// ROOTFILESYSTEM::ALIAS
+//
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::Alias Constructor
+//
+// Arguments:
+//
+//	name			- Name to assign to this alias
+//	namelength		- Length of the name to assign to this alias
+//	node			- Node to attach to this alias
+//	index			- Index number of the node
+
+RootFileSystem::Alias::Alias(const char_t* name, size_t namelength, std::shared_ptr<FileSystem::Node> node, intptr_t index)
+	: m_node(std::move(node)), m_index(index), m_name(name, namelength)
+{
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::Alias::GetName
+//
+// Reads the name assigned to this alias
+//
+// Arguments:
+//
+//	buffer			- Output buffer
+//	count			- Size of the output buffer, in bytes
+
+uapi::size_t RootFileSystem::Alias::GetName(char_t* buffer, size_t count) const
+{
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Copy the minimum of the name length or the output buffer size
+	count = std::min(m_name.size(), count);
+	memcpy(buffer, m_name.data(), count * sizeof(char_t));
+	
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::Alias::getIndex
+//
+// Gets the index number of the node to which this alias refers
+
+intptr_t RootFileSystem::Alias::getIndex(void) const
+{
+	return m_index;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::Alias::Matches
+//
+// Determines if the name assigned to this alias matches a string
+//
+// Arguments:
+//
+//	name			- Name to compare against
+//	length			- Length of the name to compare against
+
+bool RootFileSystem::Alias::Matches(const char_t* name, size_t length) const
+{
+	return (m_name.length() == length) && (memcmp(m_name.data(), name, length * sizeof(char_t)) == 0);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::Alias::getName
+//
+// Gets the name assigned to this alias
+
+std::string RootFileSystem::Alias::getName(void) const
+{
+	return std::string(m_name);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::Alias::getNode
+//
+// Gets the node to which this alias refers
+
+std::shared_ptr<FileSystem::Node> RootFileSystem::Alias::getNode(void) const
+{
+	return m_node;
+}
+
 //
 // ROOTFILESYSTEM::DIRECTORYHANDLE
 //
@@ -113,11 +405,12 @@ std::shared_ptr<FileSystem::Mount> RootFileSystem::Mount(const char_t* source, u
 // Arguments:
 //
 //	fs			- Parent file system instance
+//	node		- Directory node instance
 //	access		- Handle access mode
 //	flags		- Handle flags
 
-RootFileSystem::DirectoryHandle::DirectoryHandle(std::shared_ptr<RootFileSystem> fs, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
-	: m_fs(std::move(fs)), m_access(access), m_flags(flags)
+RootFileSystem::DirectoryHandle::DirectoryHandle(std::shared_ptr<RootFileSystem> fs, std::shared_ptr<DirectoryNode> node, FileSystem::HandleAccess access, 
+	FileSystem::HandleFlags flags) : m_fs(std::move(fs)), m_node(std::move(node)), m_access(access), m_flags(flags), m_position(0), m_cursor(nullptr)
 {
 }
 
@@ -127,8 +420,7 @@ RootFileSystem::DirectoryHandle::DirectoryHandle(std::shared_ptr<RootFileSystem>
 RootFileSystem::DirectoryHandle::~DirectoryHandle()
 {
 	// Remove this handle instance from the file system's tracking collection
-	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
-	m_fs->m_handles.erase(this);
+	m_fs->RemoveHandle(this);
 }
 
 //-----------------------------------------------------------------------------
@@ -153,11 +445,17 @@ FileSystem::HandleAccess RootFileSystem::DirectoryHandle::getAccess(void) const
 std::shared_ptr<FileSystem::Handle> RootFileSystem::DirectoryHandle::Duplicate(void) const
 {
 	// Construct the new handle object with the same access and flags as this handle
-	auto handle = std::make_shared<DirectoryHandle>(m_fs, m_access, m_flags);
+	auto handle = std::make_shared<DirectoryHandle>(m_fs, m_node, m_access, m_flags);
+
+	// The duplicate handle starts enumerating from the current position of this handle
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+		handle->m_position = m_position;
+		handle->m_cursor = m_cursor;
+	}
 
 	// Place a weak reference to the handle into the tracking collection before returning it
-	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
-	if(!m_fs->m_handles.emplace(handle.get(), handle).second) throw LinuxException(LINUX_ENOMEM);
+	m_fs->AddHandle(handle);
 
 	return handle;
 }
@@ -210,6 +508,22 @@ uapi::size_t RootFileSystem::DirectoryHandle::ReadAt(uapi::loff_t offset, void*
 	throw LinuxException(LINUX_EISDIR);
 }
 
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t RootFileSystem::DirectoryHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	return m_node->ReadDirectory(m_position, m_cursor, buffer, count);
+}
+
 //-----------------------------------------------------------------------------
 // RootFileSystem::DirectoryHandle::Seek
 //
@@ -222,10 +536,14 @@ uapi::size_t RootFileSystem::DirectoryHandle::ReadAt(uapi::loff_t offset, void*
 
 uapi::loff_t RootFileSystem::DirectoryHandle::Seek(uapi::loff_t offset, int whence)
 {
-	UNREFERENCED_PARAMETER(offset);
-	UNREFERENCED_PARAMETER(whence);
+	sync::critical_section::scoped_lock critsec{ m_cs };
 
-	throw LinuxException(LINUX_EISDIR);
+	// Directory positions are enumeration cookies; SEEK_SET can be used to rewind the
+	// directory or to return to a d_off value, SEEK_CUR can only report the position
+	if((whence == LINUX_SEEK_SET) && (offset >= 0)) return (m_position = offset);
+	if((whence == LINUX_SEEK_CUR) && (offset == 0)) return m_position;
+
+	throw LinuxException(LINUX_EINVAL);
 }
 
 //-----------------------------------------------------------------------------
@@ -302,15 +620,33 @@ uapi::size_t RootFileSystem::DirectoryHandle::WriteAt(uapi::loff_t offset, const
 // Arguments:
 //
 //	fs			- Reference to the parent file system instance
+//	parent		- Index number of the parent directory, or zero for the root directory
 //	mode		- Permission flags to assign to the directory
 //	uid			- User ID of the directory owner
 //	gid			- Group ID of the directory owner
 
-RootFileSystem::DirectoryNode::DirectoryNode(std::shared_ptr<RootFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid) 
-	: m_fs(std::move(fs)), m_uid(uid), m_gid(gid), m_ctime(datetime::now()), m_mtime(m_ctime), m_atime(m_ctime)
+RootFileSystem::DirectoryNode::DirectoryNode(std::shared_ptr<RootFileSystem> fs, intptr_t parent, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid) 
+	: NodeBase(std::move(fs), (mode & ~LINUX_S_IFMT) | LINUX_S_IFDIR, uid, gid), m_parent((parent) ? parent : m_index), 
+	m_table(new table_t(INITIAL_TABLE_CAPACITY)), m_first(nullptr), m_last(nullptr), m_count(0), m_subdirs(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode Destructor
+
+RootFileSystem::DirectoryNode::~DirectoryNode()
 {
-	// Force the mode flags to indicate that this is a directory object
-	m_mode = (mode & ~LINUX_S_IFMT) | LINUX_S_IFDIR;
+	// Release all of the entries in enumeration order
+	const entry_t* entry = m_first.load();
+	while(entry) {
+
+		const entry_t* next = entry->next.load();
+		delete entry;
+		entry = next;
+	}
+
+	// Release the current entry table, which in turn releases any retired tables
+	delete m_table.load();
 }
 
 //-----------------------------------------------------------------------------
@@ -326,12 +662,7 @@ RootFileSystem::DirectoryNode::DirectoryNode(std::shared_ptr<RootFileSystem> fs,
 
 std::shared_ptr<FileSystem::Alias> RootFileSystem::DirectoryNode::CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode)
 {
-	UNREFERENCED_PARAMETER(mount);
-	UNREFERENCED_PARAMETER(name);
-	UNREFERENCED_PARAMETER(mode);
-
-	if(mount->Flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
-	else throw LinuxException(LINUX_EPERM);
+	return CreateNode(std::move(mount), name, FileSystem::NodeType::Directory, mode);
 }
 
 //-----------------------------------------------------------------------------
@@ -347,12 +678,141 @@ std::shared_ptr<FileSystem::Alias> RootFileSystem::DirectoryNode::CreateDirector
 
 std::shared_ptr<FileSystem::Alias> RootFileSystem::DirectoryNode::CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode)
 {
-	UNREFERENCED_PARAMETER(mount);
-	UNREFERENCED_PARAMETER(name);
-	UNREFERENCED_PARAMETER(mode);
+	return CreateNode(std::move(mount), name, FileSystem::NodeType::File, mode);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode::CreateNode (private)
+//
+// Creates a new child node of the specified type
+//
+// Arguments:
+//
+//	mount		- Mount on which this directory was reached
+//	name		- Name to assign to the new node
+//	type		- Type of node to be created
+//	mode		- Mode to assign to the new node
+
+std::shared_ptr<FileSystem::Alias> RootFileSystem::DirectoryNode::CreateNode(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, 
+	FileSystem::NodeType type, uapi::mode_t mode)
+{
+	std::shared_ptr<Alias>			alias;			// Alias for the new node
+
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
 
+	if(name == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Nodes cannot be created on read-only file systems
 	if(mount->Flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
-	else throw LinuxException(LINUX_EPERM);
+
+	// Verify the name is not empty, too long or one of the special directory entries
+	size_t length = strlen(name);
+	if(length == 0) throw LinuxException(LINUX_ENOENT);
+	if(length > LINUX_NAME_MAX) throw LinuxException(LINUX_ENAMETOOLONG);
+	if((strcmp(name, ".") == 0) || (strcmp(name, "..") == 0)) throw LinuxException(LINUX_EEXIST);
+
+	// Changes to the namespace are serialized by the file system, not the directory
+	sync::critical_section::scoped_lock critsec{ m_fs->m_namelock };
+	FilePermission::Demand(FilePermission::Write | FilePermission::Execute, m_uid, m_gid, m_mode);
+
+	if(Find(name, length)) throw LinuxException(LINUX_EEXIST);
+
+	// todo: the owner of the node should be the calling user
+	if(type == FileSystem::NodeType::Directory) {
+
+		auto node = std::make_shared<DirectoryNode>(m_fs, m_index, mode, 0, 0);
+		alias = std::make_shared<Alias>(name, length, node, node->Index);
+	}
+
+	else {
+
+		auto node = std::make_shared<FileNode>(m_fs, mode, 0, 0);
+		alias = std::make_shared<Alias>(name, length, node, node->Index);
+	}
+
+	Insert(alias);
+
+	// Adding a child changes the modification time of this directory
+	sync::critical_section::scoped_lock cs{ m_cs };
+	m_mtime = m_ctime = datetime::now();
+
+	return alias;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode::Find
+//
+// Locates a child entry by name without acquiring any locks
+//
+// Arguments:
+//
+//	name		- Name of the child entry to locate
+//	length		- Length of the child entry name
+
+const RootFileSystem::entry_t* RootFileSystem::DirectoryNode::Find(const char_t* name, size_t length) const
+{
+	uint32_t hash = HashName(name, length);
+
+	// A concurrent Insert() may replace the table; the table loaded here remains valid and
+	// contains every entry published before it was replaced
+	const table_t* table = m_table.load(std::memory_order_acquire);
+
+	for(size_t slot = (hash & table->mask); ; slot = ((slot + 1) & table->mask)) {
+
+		const entry_t* entry = table->slots[slot].load(std::memory_order_acquire);
+		if(entry == nullptr) return nullptr;
+
+		if((entry->hash == hash) && entry->alias->Matches(name, length)) return entry;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode::Insert
+//
+// Publishes a new child entry; the file system namespace lock must be held
+//
+// Arguments:
+//
+//	alias		- Alias of the new child entry
+
+void RootFileSystem::DirectoryNode::Insert(std::shared_ptr<Alias> alias)
+{
+	std::string name = alias->Name;
+	bool directory = (alias->Node->Type == FileSystem::NodeType::Directory);
+
+	size_t count = m_count.load(std::memory_order_relaxed);
+	std::unique_ptr<entry_t> entry = std::make_unique<entry_t>(HashName(name.data(), name.length()), FIRST_COOKIE + count, std::move(alias));
+
+	// Keep the load factor of the table at or below 3/4 by replacing it with one twice the size;
+	// the entries are copied into the new table before it's published to lock-free readers
+	table_t* table = m_table.load(std::memory_order_relaxed);
+	if(((count + 1) * 4) > ((table->mask + 1) * 3)) {
+
+		auto grown = std::make_unique<table_t>((table->mask + 1) * 2);
+		for(const entry_t* existing = m_first.load(std::memory_order_relaxed); existing; existing = existing->next.load(std::memory_order_relaxed)) {
+
+			size_t slot = (existing->hash & grown->mask);
+			while(grown->slots[slot].load(std::memory_order_relaxed)) slot = ((slot + 1) & grown->mask);
+			grown->slots[slot].store(existing, std::memory_order_relaxed);
+		}
+
+		grown->retired.reset(table);
+		table = grown.release();
+		m_table.store(table, std::memory_order_release);
+	}
+
+	// Publish the entry into the hash table and append it to the enumeration list
+	size_t slot = (entry->hash & table->mask);
+	while(table->slots[slot].load(std::memory_order_relaxed)) slot = ((slot + 1) & table->mask);
+	table->slots[slot].store(entry.get(), std::memory_order_release);
+
+	if(m_last) m_last->next.store(entry.get(), std::memory_order_release);
+	else m_first.store(entry.get(), std::memory_order_release);
+
+	m_last = entry.release();
+
+	m_count.store(count + 1, std::memory_order_release);
+	if(directory) ++m_subdirs;
 }
 
 //-----------------------------------------------------------------------------
@@ -365,15 +825,18 @@ std::shared_ptr<FileSystem::Alias> RootFileSystem::DirectoryNode::CreateFile(std
 //	mount		- Mount on which this directory was reached
 //	name		- Name of the child alias to look up
 
-std::shared_ptr<FileSystem::Alias> RootFileSystem::DirectoryNode::Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const
+FileSystem::Result<std::shared_ptr<FileSystem::Alias>> RootFileSystem::DirectoryNode::Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const
 {
 	UNREFERENCED_PARAMETER(mount);
-	UNREFERENCED_PARAMETER(name);
 
-	sync::critical_section::scoped_lock cs{ m_cs };
+	if(name == nullptr) throw LinuxException(LINUX_EFAULT);
+
 	FilePermission::Demand(FilePermission::Execute, m_uid, m_gid, m_mode);
 
-	throw LinuxException(LINUX_ENOENT);
+	const entry_t* entry = Find(name, strlen(name));
+	if(entry == nullptr) return FileSystem::Error{ LINUX_ENOENT };
+
+	return std::static_pointer_cast<FileSystem::Alias>(entry->alias);
 }
 
 //-----------------------------------------------------------------------------
@@ -398,15 +861,13 @@ std::shared_ptr<FileSystem::Handle> RootFileSystem::DirectoryNode::Open(std::sha
 	if(flags & (FileSystem::HandleFlags::Append | FileSystem::HandleFlags::Direct)) throw LinuxException(LINUX_EINVAL);
 
 	// Read access to the directory node is required to open a handle against it
-	sync::critical_section::scoped_lock cs{ m_cs };
 	FilePermission::Demand(FilePermission::Read, m_uid, m_gid, m_mode);
 
 	// Construct the DirectoryHandle instance that will be returned to the caller
-	auto handle = std::make_shared<DirectoryHandle>(m_fs, access, flags);
+	auto handle = std::make_shared<DirectoryHandle>(m_fs, shared_from_this(), access, flags);
 
 	// Place a weak reference to the handle into the tracking collection before returning it
-	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
-	if(!m_fs->m_handles.emplace(handle.get(), handle).second) throw LinuxException(LINUX_ENOMEM);
+	m_fs->AddHandle(handle);
 
 	UpdateAccessTime(mount);
 
@@ -414,52 +875,759 @@ std::shared_ptr<FileSystem::Handle> RootFileSystem::DirectoryNode::Open(std::sha
 }
 
 //-----------------------------------------------------------------------------
-// RootFileSystem::DirectoryNode::SetOwnership
+// RootFileSystem::DirectoryNode::Populate
 //
-// Changes the ownership of this node
+// Bulk loads the contents of a CPIO archive as descendants of this directory
 //
 // Arguments:
 //
-//	uid			- New ownership user identifier
-//	gid			- New ownership group identifier
+//	archive		- StreamReader positioned at the start of the CPIO archive
 
-void RootFileSystem::DirectoryNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+void RootFileSystem::DirectoryNode::Populate(const std::unique_ptr<StreamReader>& archive)
 {
-	// todo: CAP_CHOWN - see chown(2), there is more to this
+	// directories
+	//
+	// Cache of the directory nodes resolved while loading the archive, an archive lists
+	// the entries of each directory together so most parent lookups are satisfied here
+	std::unordered_map<std::string, std::shared_ptr<DirectoryNode>> directories;
+	directories.emplace(std::string(), shared_from_this());
 
-	sync::critical_section::scoped_lock cs{ m_cs };
-	FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+	// ResolveDirectory
+	//
+	// Resolves a directory path relative to this directory, nullptr if it doesn't exist
+	auto ResolveDirectory = [&](const std::string& path) -> std::shared_ptr<DirectoryNode> {
+
+		auto found = directories.find(path);
+		if(found != directories.end()) return found->second;
+
+		// Split the path into the parent and the final component and resolve the parent
+		size_t separator = path.rfind('/');
+		std::shared_ptr<DirectoryNode> parent = directories.at(std::string());
+		if(separator != std::string::npos) {
+
+			auto resolve = directories.find(path.substr(0, separator));
+			if(resolve == directories.end()) return nullptr;
+			parent = resolve->second;
+		}
+
+		const char_t* name = path.c_str() + ((separator == std::string::npos) ? 0 : separator + 1);
+		const entry_t* entry = parent->Find(name, strlen(name));
+		if(entry == nullptr) return nullptr;
+
+		auto directory = std::dynamic_pointer_cast<DirectoryNode>(entry->alias->Node);
+		if(directory) directories.emplace(path, directory);
+
+		return directory;
+	};
+
+	// The namespace lock is acquired once for the entire archive rather than for each entry; lookups
+	// against the directories being populated do not require the lock and can proceed concurrently
+	sync::critical_section::scoped_lock critsec{ m_fs->m_namelock };
+
+	CpioArchive::EnumerateFiles(archive, [&](const CpioFile& file) -> void {
+
+		// Remove any leading "/" and "./" components and any trailing "/" from the entry path
+		const char_t* pathstr = file.Path;
+		while((pathstr[0] == '/') || ((pathstr[0] == '.') && (pathstr[1] == '/'))) pathstr += (pathstr[0] == '/') ? 1 : 2;
+
+		std::string path(pathstr);
+		while((!path.empty()) && (path.back() == '/')) path.pop_back();
+		if(path.empty() || (path == ".")) return;
+
+		// Split the path into the parent directory and the name of the entry; the parent
+		// directory must already exist in the file system or have preceded it in the archive
+		size_t separator = path.rfind('/');
+		auto parent = ResolveDirectory((separator == std::string::npos) ? std::string() : path.substr(0, separator));
+		if(!parent) return;
+
+		const char_t* name = path.c_str() + ((separator == std::string::npos) ? 0 : separator + 1);
+		size_t namelength = strlen(name);
+		if((namelength > LINUX_NAME_MAX) || (strcmp(name, ".") == 0) || (strcmp(name, "..") == 0)) return;
+
+		const entry_t* existing = parent->Find(name, namelength);
+		uapi::mode_t mode = (file.Mode & LINUX_S_IALLUGO);
+
+		switch(file.Mode & LINUX_S_IFMT) {
+
+			// S_IFDIR - an existing directory takes on the attributes of the archive entry
+			case LINUX_S_IFDIR:
+			{
+				if(existing) {
+
+					auto directory = std::dynamic_pointer_cast<DirectoryNode>(existing->alias->Node);
+					if(!directory) return;
+
+					directory->m_mode = (LINUX_S_IFDIR | mode);
+					directory->m_uid = file.UserId;
+					directory->m_gid = file.GroupId;
+					directories.emplace(path, directory);
+				}
+
+				else {
+
+					auto directory = std::make_shared<DirectoryNode>(m_fs, parent->Index, mode, file.UserId, file.GroupId);
+					parent->Insert(std::make_shared<Alias>(name, namelength, directory, directory->Index));
+					directories.emplace(path, directory);
+				}
+			}
+				break;
+
+			// S_IFREG - the file data is loaded before the node is published into the parent;
+			// entries cannot be removed from a directory, an existing entry is not replaced
+			case LINUX_S_IFREG:
+			{
+				if(existing) return;
+
+				auto node = std::make_shared<FileNode>(m_fs, mode, file.UserId, file.GroupId);
+				node->Load(file.Data);
+				parent->Insert(std::make_shared<Alias>(name, namelength, node, node->Index));
+			}
+				break;
+
+			// todo: symbolic links and special files are not implemented by the file system
+			default: break;
+		}
+	});
+}
 
-	m_uid = uid;
-	m_gid = gid;
-	m_ctime = datetime::now();
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode::ReadDirectory
+//
+// Reads entries from the directory as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	position	- Enumeration position, updated to reflect the entries read
+//	cursor		- Last entry enumerated, updated to reflect the entries read
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t RootFileSystem::DirectoryNode::ReadDirectory(uapi::loff_t& position, const entry_t*& cursor, void* buffer, uapi::size_t count) const
+{
+	uint8_t*				dest = reinterpret_cast<uint8_t*>(buffer);		// Destination pointer
+	uapi::size_t			written = 0;									// Bytes written to the buffer
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// The special "." and ".." entries occupy the positions before the first child entry
+	while(position < FIRST_COOKIE) {
+
+		const char_t* name = (position == 0) ? "." : "..";
+		uapi::size_t reclen = PackDirectoryEntry(dest + written, count - written, (position == 0) ? m_index : m_parent, 
+			position + 1, LINUX_DT_DIR, name, strlen(name));
+
+		if(reclen == 0) { if(written == 0) throw LinuxException(LINUX_EINVAL); return written; }
+
+		written += reclen;
+		++position;
+	}
+
+	// Entries are never removed, so the entry that follows the cursor is the next one to return
+	// unless the position has been changed; otherwise walk the list to the requested position
+	const entry_t* entry = ((cursor) && ((cursor->cookie + 1) == position)) ? cursor->next.load(std::memory_order_acquire) : m_first.load(std::memory_order_acquire);
+	while((entry) && (entry->cookie < position)) entry = entry->next.load(std::memory_order_acquire);
+
+	while(entry) {
+
+		std::string name = entry->alias->Name;
+		uapi::size_t reclen = PackDirectoryEntry(dest + written, count - written, entry->alias->Index, entry->cookie + 1, 
+			DirectoryEntryType(entry->alias->Node->Type), name.data(), name.length());
+
+		if(reclen == 0) { if(written == 0) throw LinuxException(LINUX_EINVAL); break; }
+
+		written += reclen;
+		position = entry->cookie + 1;
+		cursor = entry;
+
+		entry = entry->next.load(std::memory_order_acquire);
+	}
+
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void RootFileSystem::DirectoryNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	ChangeOwnership(uid, gid);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void RootFileSystem::DirectoryNode::SetPermissions(uapi::mode_t permissions)
+{
+	ChangePermissions(permissions);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode::Stat
+//
+// Provides statistical information about this node
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void RootFileSystem::DirectoryNode::Stat(uapi::stat* stats) const
+{
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	StatNode(stats);
+	stats->st_nlink		= 2 + m_subdirs;			// "." and ".." plus each child ".."
+	stats->st_size		= (m_count + 2) * DIRECTORY_ENTRY_SIZE;
+	stats->st_blocks	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::DirectoryNode::getType
+//
+// Gets the type of node represented by this object
+
+FileSystem::NodeType RootFileSystem::DirectoryNode::getType(void) const
+{
+	return FileSystem::NodeType::Directory;
+}
+
+//
+// ROOTFILESYSTEM::FILEHANDLE
+//
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	node		- File node instance
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+RootFileSystem::FileHandle::FileHandle(std::shared_ptr<RootFileSystem> fs, std::shared_ptr<FileNode> node, FileSystem::HandleAccess access, 
+	FileSystem::HandleFlags flags) : m_fs(std::move(fs)), m_node(std::move(node)), m_access(access), m_flags(flags), m_position(std::make_shared<filepos_t>())
+{
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle Destructor
+
+RootFileSystem::FileHandle::~FileHandle()
+{
+	// Remove this handle instance from the file system's tracking collection
+	m_fs->RemoveHandle(this);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess RootFileSystem::FileHandle::getAccess(void) const
+{
+	return m_access;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> RootFileSystem::FileHandle::Duplicate(void) const
+{
+	auto handle = std::make_shared<FileHandle>(m_fs, m_node, m_access, m_flags);
+
+	// The duplicate handle shares the file position with this handle
+	handle->m_position = m_position;
+
+	// Place a weak reference to the handle into the tracking collection before returning it
+	m_fs->AddHandle(handle);
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::getFlags
+//
+// Gets the handle flags
+
+FileSystem::HandleFlags RootFileSystem::FileHandle::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t RootFileSystem::FileHandle::Read(void* buffer, uapi::size_t count)
+{
+	// Attempting to read from a write-only handle yields EBADF
+	if(m_access == FileSystem::HandleAccess::WriteOnly) throw LinuxException(LINUX_EBADF);
+
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	uapi::size_t read = m_node->Read(m_position->offset, buffer, count);
+	m_position->offset += read;
+
+	return read;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t RootFileSystem::FileHandle::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	// Attempting to read from a write-only handle yields EBADF
+	if(m_access == FileSystem::HandleAccess::WriteOnly) throw LinuxException(LINUX_EBADF);
+
+	return m_node->Read(offset, buffer, count);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t RootFileSystem::FileHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ENOTDIR);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset into the node data to seek, relative to whence
+//	whence		- Position in the node data that offset is relative to
+
+uapi::loff_t RootFileSystem::FileHandle::Seek(uapi::loff_t offset, int whence)
+{
+	uapi::loff_t			position;			// New file position
+
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	switch(whence) {
+
+		case LINUX_SEEK_SET: position = offset; break;
+		case LINUX_SEEK_CUR: position = m_position->offset + offset; break;
+		case LINUX_SEEK_END: position = m_node->Length + offset; break;
+		default: throw LinuxException(LINUX_EINVAL);
+	}
+
+	if(position < 0) throw LinuxException(LINUX_EINVAL);
+
+	return (m_position->offset = position);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void RootFileSystem::FileHandle::Sync(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void RootFileSystem::FileHandle::SyncData(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t RootFileSystem::FileHandle::Write(const void* buffer, uapi::size_t count)
+{
+	uapi::size_t			written;			// Number of bytes written
+
+	// Attempting to write to a read-only handle yields EINVAL, not EACCES
+	if(m_access == FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EINVAL);
+
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	// O_APPEND handles write to the end of the file under the node lock and move to the new end
+	if(m_flags & FileSystem::HandleFlags::Append) m_position->offset = m_node->Append(buffer, count, &written);
+
+	else {
+
+		written = m_node->Write(m_position->offset, buffer, count);
+		m_position->offset += written;
+	}
+
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileHandle::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t RootFileSystem::FileHandle::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	// Attempting to write to a read-only handle yields EINVAL, not EACCES
+	if(m_access == FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EINVAL);
+
+	// Data cannot be written to a specific location in O_APPEND mode
+	if(m_flags & FileSystem::HandleFlags::Append) throw LinuxException(LINUX_EINVAL);
+
+	return m_node->Write(offset, buffer, count);
+}
+
+//
+// ROOTFILESYSTEM::FILENODE
+//
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	mode		- Permission flags to assign to the file
+//	uid			- User ID of the file owner
+//	gid			- Group ID of the file owner
+
+RootFileSystem::FileNode::FileNode(std::shared_ptr<RootFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid)
+	: NodeBase(std::move(fs), (mode & ~LINUX_S_IFMT) | LINUX_S_IFREG, uid, gid), m_length(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode Destructor
+
+RootFileSystem::FileNode::~FileNode()
+{
+	// Return all of the data pages to the private heap
+	for(auto const& page : m_pages) if(page) m_fs->ReleasePage(page);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::Append
+//
+// Writes data to the end of the file, returns the new length of the file
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+//	written		- Receives the number of bytes written
+
+uapi::loff_t RootFileSystem::FileNode::Append(const void* buffer, uapi::size_t count, uapi::size_t* written)
+{
+	if(written == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// The length of the file is only known under the node lock, the checks for the offset
+	// and the data write must be performed as a single operation
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	*written = WriteData(m_length, buffer, count);
+	return m_length;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::getLength
+//
+// Gets the length of the file data
+
+uapi::loff_t RootFileSystem::FileNode::getLength(void) const
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	return m_length;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::Load
+//
+// Loads the file data from a stream; the node cannot have been published yet
+//
+// Arguments:
+//
+//	data		- StreamReader from which to read the file data
+
+void RootFileSystem::FileNode::Load(StreamReader& data)
+{
+	size_t const			pagesize = SystemInformation::PageSize;			// Size of each page
+
+	_ASSERTE(m_length == 0);
+
+	// The page list can be sized in advance when the length of the stream is known
+	if(data.Length != MAXSIZE_T) m_pages.reserve(align::up(data.Length, pagesize) / pagesize);
+
+	while(true) {
+
+		uint8_t* page = m_fs->AllocatePage(false);
+		size_t read = 0;
+
+		try {
+
+			// Fill the page from the stream, which may not return all of the data at once
+			while(read < pagesize) {
+
+				size_t result = data.Read(page + read, pagesize - read);
+				if(result == 0) break;
+				read += result;
+			}
+
+			if(read > 0) m_pages.push_back(page);
+		}
+
+		catch(...) { m_fs->ReleasePage(page); throw; }
+
+		if(read == 0) { m_fs->ReleasePage(page); break; }
+
+		m_length += read;
+
+		// A partial page is the end of the stream; zero the remainder of the page
+		if(read < pagesize) { memset(page + read, 0, pagesize - read); break; }
+	}
 }
 
 //-----------------------------------------------------------------------------
-// RootFileSystem::DirectoryNode::SetPermissions
+// RootFileSystem::FileNode::Open
 //
-// Changes the permission flags for this node
+// Creates a Handle instance against this node
 //
 // Arguments:
 //
-//	permissions		- New permission flags for the node
+//	mount		- Mount on which this node was resolved
+//	access		- Handle access mode
+//	flags		- Handle flags
 
-void RootFileSystem::DirectoryNode::SetPermissions(uapi::mode_t permissions)
+std::shared_ptr<FileSystem::Handle> RootFileSystem::FileNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
 {
-	permissions &= ~LINUX_S_IFMT;		// Strip off non-permissions
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
 
-	// todo: CAP_FSETID - see chmod(2), there is more to this
-	// todo: CAP_FOWNER - see chmod(2), there is more to this
+	// If the file system was mounted as read-only, write access cannot be granted
+	if((mount->Flags & LINUX_MS_RDONLY) && (access != FileSystem::HandleAccess::ReadOnly)) throw LinuxException(LINUX_EROFS);
 
-	sync::critical_section::scoped_lock cs{ m_cs };
-	FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+	// O_APPEND requires write access to the file object
+	if((flags & FileSystem::HandleFlags::Append) && (access == FileSystem::HandleAccess::ReadOnly)) throw LinuxException(LINUX_EINVAL);
 
-	m_mode = ((m_mode & LINUX_S_IFMT) | permissions);
-	m_ctime = datetime::now();
+	// Demand the permissions required for the requested access mode
+	if(access != FileSystem::HandleAccess::WriteOnly) FilePermission::Demand(FilePermission::Read, m_uid, m_gid, m_mode);
+	if(access != FileSystem::HandleAccess::ReadOnly) FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+
+	// O_TRUNC releases all of the data pages owned by the file
+	if((flags & FileSystem::HandleFlags::Truncate) && (access != FileSystem::HandleAccess::ReadOnly)) SetLength(0);
+
+	auto handle = std::make_shared<FileHandle>(m_fs, shared_from_this(), access, flags);
+
+	// Place a weak reference to the handle into the tracking collection before returning it
+	m_fs->AddHandle(handle);
+
+	UpdateAccessTime(mount);
+
+	return handle;
 }
 
 //-----------------------------------------------------------------------------
-// RootFileSystem::DirectoryNode::Stat
+// RootFileSystem::FileNode::OpenExec
+//
+// Creates an execute-only handle against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this node was resolved
+
+std::shared_ptr<FileSystem::Handle> RootFileSystem::FileNode::OpenExec(std::shared_ptr<FileSystem::Mount> mount) const
+{
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	// Verify that the mount point allows for execution of binary files
+	if(mount->Flags & LINUX_MS_NOEXEC) throw LinuxException(LINUX_ENOEXEC);
+
+	FilePermission::Demand(FilePermission::Execute, m_uid, m_gid, m_mode);
+
+	auto handle = std::make_shared<FileHandle>(m_fs, std::const_pointer_cast<FileNode>(shared_from_this()), FileSystem::HandleAccess::ReadOnly, 
+		FileSystem::HandleFlags::None);
+
+	// Place a weak reference to the handle into the tracking collection before returning it
+	m_fs->AddHandle(handle);
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::Read
+//
+// Reads data from the file
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the file to begin reading
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t RootFileSystem::FileNode::Read(uapi::loff_t offset, void* buffer, uapi::size_t count) const
+{
+	uint8_t*				dest = reinterpret_cast<uint8_t*>(buffer);		// Destination pointer
+	size_t const			pagesize = SystemInformation::PageSize;			// Size of each page
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+	if(offset < 0) throw LinuxException(LINUX_EINVAL);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// Reads that begin at or beyond the end of the file return zero bytes
+	if(offset >= m_length) return 0;
+	count = static_cast<uapi::size_t>(std::min(static_cast<uint64_t>(count), static_cast<uint64_t>(m_length - offset)));
+
+	uapi::size_t remaining = count;
+	while(remaining > 0) {
+
+		size_t pagenum = static_cast<size_t>(static_cast<uint64_t>(offset) / pagesize);
+		size_t pageoffset = static_cast<size_t>(static_cast<uint64_t>(offset) % pagesize);
+		size_t length = std::min(pagesize - pageoffset, remaining);
+
+		// Pages that have never been written to are holes in a sparse file and read as zeros
+		uint8_t* page = (pagenum < m_pages.size()) ? m_pages[pagenum] : nullptr;
+		if(page == nullptr) memset(dest, 0, length);
+		else memcpy(dest, page + pageoffset, length);
+
+		dest += length;
+		offset += length;
+		remaining -= length;
+	}
+
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::SetLength
+//
+// Sets the length of the file, releasing any pages beyond the new end
+//
+// Arguments:
+//
+//	length		- New length of the file
+
+void RootFileSystem::FileNode::SetLength(uapi::loff_t length)
+{
+	size_t const			pagesize = SystemInformation::PageSize;			// Size of each page
+
+	if((length < 0) || (length > MAXIMUM_FILE_LENGTH)) throw LinuxException(LINUX_EINVAL);
+	if(m_fs->m_flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	if(length < m_length) {
+
+		// Release every page that lies entirely beyond the new end of the file
+		size_t pagecount = static_cast<size_t>(align::up(static_cast<uint64_t>(length), pagesize) / pagesize);
+		for(size_t index = pagecount; index < m_pages.size(); index++) if(m_pages[index]) m_fs->ReleasePage(m_pages[index]);
+		if(pagecount < m_pages.size()) m_pages.resize(pagecount);
+
+		// Zero the remainder of a partial last page so that extending the file again reads zeros
+		size_t pageoffset = static_cast<size_t>(static_cast<uint64_t>(length) % pagesize);
+		if((pageoffset) && (pagecount <= m_pages.size()) && (m_pages[pagecount - 1])) memset(m_pages[pagecount - 1] + pageoffset, 0, pagesize - pageoffset);
+	}
+
+	// Extending the length of the file does not allocate anything, the new range is a hole
+	m_length = length;
+	m_mtime = m_ctime = datetime::now();
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void RootFileSystem::FileNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	ChangeOwnership(uid, gid);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void RootFileSystem::FileNode::SetPermissions(uapi::mode_t permissions)
+{
+	ChangePermissions(permissions);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::Stat
 //
 // Provides statistical information about this node
 //
@@ -467,64 +1635,106 @@ void RootFileSystem::DirectoryNode::SetPermissions(uapi::mode_t permissions)
 //
 //	stats		- Structure to receive the node statistics
 
-void RootFileSystem::DirectoryNode::Stat(uapi::stat* stats) const
+void RootFileSystem::FileNode::Stat(uapi::stat* stats) const
 {
 	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
 
-	sync::critical_section::scoped_lock cs{ m_cs };
-	
-	stats->st_dev		= (0 << 16) | 0;	// TODO: DEVICE ID; MAJOR WILL BE ZERO MINOR SHOULD AUTO-INCREMENT
-	stats->st_ino		= 2;				// Always inode index 2
-	stats->st_nlink		= 2;				// Always 2 subdirectories, "." and ".."
-	stats->st_mode		= m_mode;
-	stats->st_uid		= m_uid;
-	stats->st_gid		= m_gid;
-	stats->st_rdev		= (0 << 16) | 0;	// TODO
-	stats->st_size		= 0;
-	stats->st_blksize	= SystemInformation::PageSize;
-	stats->st_blocks	= 0;
-	stats->st_atime		= convert<uapi::timespec>(m_atime);
-	stats->st_mtime		= convert<uapi::timespec>(m_mtime);
-	stats->st_ctime		= convert<uapi::timespec>(m_ctime);
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	StatNode(stats);
+	stats->st_nlink		= 1;
+	stats->st_size		= m_length;
+	stats->st_blocks	= (std::count_if(m_pages.begin(), m_pages.end(), [](uint8_t* page) { return page != nullptr; }) * SystemInformation::PageSize) / 512;
 }
 
 //-----------------------------------------------------------------------------
-// RootFileSystem::DirectoryNode::getType
+// RootFileSystem::FileNode::getType
 //
 // Gets the type of node represented by this object
 
-FileSystem::NodeType RootFileSystem::DirectoryNode::getType(void) const
+FileSystem::NodeType RootFileSystem::FileNode::getType(void) const
 {
-	return FileSystem::NodeType::Directory;
+	return FileSystem::NodeType::File;
 }
 
 //-----------------------------------------------------------------------------
-// RootFileSystem::DirectoryNode::UpdateAccessTime (private)
+// RootFileSystem::FileNode::Write
 //
-// Updates the access time of the node
+// Writes data into the file
 //
 // Arguments:
 //
-//	mount		- Mount on which the directory node was reached
+//	offset		- Offset from the start of the file to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
 
-void RootFileSystem::DirectoryNode::UpdateAccessTime(std::shared_ptr<FileSystem::Mount> mount)
+uapi::size_t RootFileSystem::FileNode::Write(uapi::loff_t offset, const void* buffer, uapi::size_t count)
 {
-	// Read-only file systems should not update the access time
-	if(mount->Flags & LINUX_MS_RDONLY) return;
+	if(offset < 0) throw LinuxException(LINUX_EINVAL);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	return WriteData(offset, buffer, count);
+}
 
-	// If MS_STRICTATIME is set or MS_NOATIME/MS_NODIRATIME are not set, the access time gets updated
-	if((mount->Flags & LINUX_MS_STRICTATIME) || ((mount->Flags & (LINUX_MS_NOATIME | LINUX_MS_NODIRATIME)) == 0)) {
+//-----------------------------------------------------------------------------
+// RootFileSystem::FileNode::WriteData (private)
+//
+// Writes data into the file pages; the node lock must be held
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the file to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
 
-		datetime now = datetime::now();
-		sync::critical_section::scoped_lock critsec{ m_cs };
+uapi::size_t RootFileSystem::FileNode::WriteData(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	const uint8_t*			source = reinterpret_cast<const uint8_t*>(buffer);		// Source pointer
+	size_t const			pagesize = SystemInformation::PageSize;					// Size of each page
+	uapi::size_t			written = 0;											// Bytes written
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Attempting to write to a read-only file system yields EROFS, not EACCES
+	if(m_fs->m_flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	// The write cannot extend the file beyond the maximum length
+	if(static_cast<uint64_t>(count) > static_cast<uint64_t>(MAXIMUM_FILE_LENGTH - offset)) throw LinuxException(LINUX_EFBIG);
+	if(count == 0) return 0;
+
+	// Extend the page list to cover the entire range being written; any new slots are holes
+	uint64_t lastpage = (static_cast<uint64_t>(offset) + count - 1) / pagesize;
+	if(lastpage >= MAXSIZE_T) throw LinuxException(LINUX_EFBIG);
+
+	try { if(lastpage >= m_pages.size()) m_pages.resize(static_cast<size_t>(lastpage + 1), nullptr); }
+	catch(std::bad_alloc&) { throw LinuxException(LINUX_ENOSPC); }
+
+	while(written < count) {
+
+		size_t pagenum = static_cast<size_t>((static_cast<uint64_t>(offset) + written) / pagesize);
+		size_t pageoffset = static_cast<size_t>((static_cast<uint64_t>(offset) + written) % pagesize);
+		size_t length = std::min(pagesize - pageoffset, count - written);
+
+		// A new page is only zeroed if it won't be completely overwritten; if the heap is exhausted
+		// after some of the data has been written, report a short write instead
+		if(m_pages[pagenum] == nullptr) {
 
-		// If MS_STRICTATIME is set, always update the last access time
-		if(mount->Flags & LINUX_MS_STRICTATIME) m_atime = now;
+			try { m_pages[pagenum] = m_fs->AllocatePage(length < pagesize); }
+			catch(LinuxException&) { if(written == 0) throw; break; }
+		}
 
-		// MS_STRICTATIME is not set, only update if the previous atime is less than mtime, less than ctime,
-		// or indicates a value that is more than one day in the past
-		else if((m_atime < m_mtime) || (m_atime < m_ctime) || (m_atime < (now - timespan::days(1)))) m_atime = now;
+		memcpy(m_pages[pagenum] + pageoffset, source + written, length);
+		written += length;
 	}
+
+	// Extend the length of the file and update the modification time
+	if(written > 0) {
+
+		m_length = std::max(m_length, static_cast<uapi::loff_t>(offset + written));
+		m_mtime = m_ctime = datetime::now();
+	}
+
+	return written;
 }
 
 //
@@ -607,10 +1817,21 @@ void RootFileSystem::Mount::Remount(uint32_t flags, const void* data, size_t dat
 
 	// MS_RDONLY
 	//
-	// Note: all handles created by RootFileSystem are read-only by nature as they all
-	// reference directories; there is no need to check them before changing MS_RDONLY
-	if(changedflags & LINUX_MS_RDONLY)
+	if(changedflags & LINUX_MS_RDONLY) {
+
+		// The file system cannot be made read-only while any handles have write access
+		if(options[LINUX_MS_RDONLY]) {
+
+			sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
+			for(auto const& iterator : m_fs->m_handles) {
+
+				auto handle = iterator.second.lock();
+				if((handle) && (handle->Access != FileSystem::HandleAccess::ReadOnly)) throw LinuxException(LINUX_EBUSY);
+			}
+		}
+
 		m_fs->m_flags = (m_fs->m_flags & ~LINUX_MS_RDONLY) | options[LINUX_MS_RDONLY];
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -689,6 +1910,151 @@ void RootFileSystem::Mount::Unmount(void)
 	m_root.reset();			// Release the root directory node
 }
 
+//
+// ROOTFILESYSTEM::NODEBASE
+//
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::NodeBase Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	mode		- Type and permission flags to assign to the node
+//	uid			- User ID of the node owner
+//	gid			- Group ID of the node owner
+
+RootFileSystem::NodeBase::NodeBase(std::shared_ptr<RootFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid)
+	: m_fs(std::move(fs)), m_index(m_fs->m_indexpool.Allocate()), m_ctime(datetime::now()), m_mtime(m_ctime), m_atime(m_ctime), m_mode(mode), 
+	m_uid(uid), m_gid(gid)
+{
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::NodeBase Destructor
+
+RootFileSystem::NodeBase::~NodeBase()
+{
+	m_fs->m_indexpool.Release(m_index);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::NodeBase::ChangeOwnership (protected)
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void RootFileSystem::NodeBase::ChangeOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	// todo: CAP_CHOWN - see chown(2), there is more to this
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+	FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+
+	m_uid = uid;
+	m_gid = gid;
+	m_ctime = datetime::now();
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::NodeBase::ChangePermissions (protected)
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void RootFileSystem::NodeBase::ChangePermissions(uapi::mode_t permissions)
+{
+	permissions &= ~LINUX_S_IFMT;		// Strip off non-permissions
+
+	// todo: CAP_FSETID - see chmod(2), there is more to this
+	// todo: CAP_FOWNER - see chmod(2), there is more to this
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+	FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+
+	m_mode = ((m_mode & LINUX_S_IFMT) | permissions);
+	m_ctime = datetime::now();
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::NodeBase::getIndex
+//
+// Gets the index number assigned to this node
+
+intptr_t RootFileSystem::NodeBase::getIndex(void) const
+{
+	return m_index;
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::NodeBase::StatNode (protected)
+//
+// Provides the statistical information common to all node types; the node
+// lock must be held by the caller
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void RootFileSystem::NodeBase::StatNode(uapi::stat* stats) const
+{
+	_ASSERTE(stats);
+
+	memset(stats, 0, sizeof(uapi::stat));
+
+	stats->st_dev		= (0 << 16) | 0;	// TODO: DEVICE ID; MAJOR WILL BE ZERO MINOR SHOULD AUTO-INCREMENT
+	stats->st_ino		= m_index;
+	stats->st_mode		= m_mode;
+	stats->st_uid		= m_uid;
+	stats->st_gid		= m_gid;
+	stats->st_rdev		= (0 << 16) | 0;	// TODO
+	stats->st_blksize	= SystemInformation::PageSize;
+	stats->st_atime		= convert<uapi::timespec>(m_atime);
+	stats->st_mtime		= convert<uapi::timespec>(m_mtime);
+	stats->st_ctime		= convert<uapi::timespec>(m_ctime);
+}
+
+//-----------------------------------------------------------------------------
+// RootFileSystem::NodeBase::UpdateAccessTime (protected)
+//
+// Updates the access time of the node
+//
+// Arguments:
+//
+//	mount		- Mount on which the node was reached
+
+void RootFileSystem::NodeBase::UpdateAccessTime(std::shared_ptr<FileSystem::Mount> mount)
+{
+	uint32_t flags = mount->Flags;
+
+	// Read-only file systems should not update the access time
+	if(flags & LINUX_MS_RDONLY) return;
+
+	// MS_NOATIME and MS_NODIRATIME (for directories) are overridden by MS_STRICTATIME
+	if((flags & LINUX_MS_STRICTATIME) == 0) {
+
+		if(flags & LINUX_MS_NOATIME) return;
+		if((flags & LINUX_MS_NODIRATIME) && ((m_mode & LINUX_S_IFMT) == LINUX_S_IFDIR)) return;
+	}
+
+	datetime now = datetime::now();
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// If MS_STRICTATIME is set, always update the last access time
+	if(flags & LINUX_MS_STRICTATIME) m_atime = now;
+
+	// MS_STRICTATIME is not set, only update if the previous atime is less than mtime, less than ctime,
+	// or indicates a value that is more than one day in the past
+	else if((m_atime < m_mtime) || (m_atime < m_ctime) || (m_atime < (now - timespan::days(1)))) m_atime = now;
+}
+
 //-----------------------------------------------------------------------------
 
 #pragma warning(pop)
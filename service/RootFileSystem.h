@@ -27,30 +27,38 @@
 #include <atomic>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include "FileSystem.h"
+#include "IndexPool.h"
+#include "StreamReader.h"
 
 #pragma warning(push, 4)
 
 //-----------------------------------------------------------------------------
 // RootFileSystem
 //
-// RootFileSystem implements a virtual single directory node file system in which
-// no child nodes can be created
+// RootFileSystem implements the in-memory file system that serves as the initial
+// root of the virtual machine and receives the unpacked contents of an initramfs
+// archive.  Directories are open-addressed hash tables of child aliases that can be
+// searched without acquiring any locks; modifications to the namespace are serialized
+// by a single file system lock, which Populate() acquires once for an entire archive.
+// Regular file data is stored as a list of pages allocated from a private heap.
 //
 // Supported mount options:
 //
 //	MS_KERNMOUNT
 //	MS_NOATIME
+//	MS_NODEV
 //	MS_NODIRATIME
+//	MS_NOEXEC
+//	MS_NOSUID
 //	MS_RDONLY
 //	MS_RELATIME
 //	MS_STRICTATIME
 //
-//	mode=nnn	- Sets the permissions of the directory node
-//	uid=nnn		- Sets the owner user id of the directory node
-//	gid=nnn		- Sets the owner group id of the directory node
-//	
-//	(MS_NODEV, MS_NOEXEC and MS_NOSUID are always set)
+//	mode=nnn	- Sets the permissions of the root directory node
+//	uid=nnn		- Sets the owner user id of the root directory node
+//	gid=nnn		- Sets the owner group id of the root directory node
 //
 // Supported remount options:
 //
@@ -69,7 +77,7 @@ public:
 
 	// Destructor
 	//
-	~RootFileSystem()=default;
+	~RootFileSystem();
 
 	//-------------------------------------------------------------------------
 	// Member Functions
@@ -79,6 +87,11 @@ public:
 	// Creates an instance of the file system
 	static std::shared_ptr<FileSystem::Mount> Mount(const char_t* source, uint32_t flags, const void* data, size_t datalength);
 
+	// Populate (static)
+	//
+	// Bulk loads the contents of an initramfs CPIO archive into a mounted file system
+	static void Populate(std::shared_ptr<FileSystem::Mount> mount, const std::unique_ptr<StreamReader>& archive);
+
 private:
 
 	RootFileSystem(const RootFileSystem&)=delete;
@@ -86,44 +99,312 @@ private:
 
 	// Forward Declarations
 	//
-	class DirectoryHandle;
+	class DirectoryNode;
+	class FileNode;
+
+	// filepos_t
+	//
+	// File position shared among duplicated file handles
+	struct filepos_t
+	{
+		uapi::loff_t				offset = 0;		// Current file position
+		sync::critical_section		cs;				// Synchronization object
+	};
 
 	// handlemap_t
 	//
-	// Collection of active DirectoryHandle instances
-	using handlemap_t = std::unordered_map<DirectoryHandle*, std::weak_ptr<DirectoryHandle>>;
+	// Collection of active Handle instances
+	using handlemap_t = std::unordered_map<FileSystem::Handle*, std::weak_ptr<FileSystem::Handle>>;
+
+	// RootFileSystem::Alias
+	//
+	class Alias : public FileSystem::Alias
+	{
+	public:
+
+		// Instance Constructor
+		//
+		Alias(const char_t* name, size_t namelength, std::shared_ptr<FileSystem::Node> node, intptr_t index);
+
+		// Destructor
+		//
+		~Alias()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Alias Implementation
+
+		// GetName
+		//
+		// Reads the name assigned to this alias
+		virtual uapi::size_t GetName(char_t* buffer, size_t count) const override;
+
+		// getName
+		//
+		// Gets the name assigned to this alias
+		virtual std::string getName(void) const override;
+
+		// getNode
+		//
+		// Gets the node to which this alias refers
+		virtual std::shared_ptr<FileSystem::Node> getNode(void) const override;
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// Matches
+		//
+		// Determines if the name assigned to this alias matches a string
+		bool Matches(const char_t* name, size_t length) const;
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Index
+		//
+		// Gets the index number of the node to which this alias refers
+		__declspec(property(get=getIndex)) intptr_t Index;
+		intptr_t getIndex(void) const;
+
+	private:
+
+		Alias(const Alias&)=delete;
+		Alias& operator=(const Alias&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<FileSystem::Node>	m_node;		// Node instance
+		const intptr_t							m_index;	// Node index number
+		const std::string						m_name;		// Alias name to report
+	};
+
+	// entry_t
+	//
+	// Directory entry; entries are never removed from a directory and are
+	// immutable once they have been published into the entry table
+	struct entry_t
+	{
+		entry_t(uint32_t namehash, uapi::loff_t entrycookie, std::shared_ptr<Alias> entryalias) : hash(namehash), cookie(entrycookie), alias(std::move(entryalias)), next(nullptr) {}
+
+		const uint32_t					hash;		// Hash code of the entry name
+		const uapi::loff_t				cookie;		// Directory enumeration cookie
+		const std::shared_ptr<Alias>	alias;		// Child alias instance
+		std::atomic<const entry_t*>		next;		// Next entry in enumeration order
+	};
+
+	// table_t
+	//
+	// Open-addressed (linear probe) hash table of directory entries.  A table that
+	// has been replaced by a larger one is retained by its successor rather than
+	// released, lock-free lookups may still be probing it
+	struct table_t
+	{
+		explicit table_t(size_t capacity) : mask(capacity - 1), slots(new std::atomic<const entry_t*>[capacity])
+		{
+			for(size_t index = 0; index < capacity; index++) slots[index] = nullptr;
+		}
+
+		const size_t										mask;		// Table capacity mask
+		std::unique_ptr<std::atomic<const entry_t*>[]>		slots;		// Table entry slots
+		std::unique_ptr<table_t>							retired;	// Replaced entry table
+	};
+
+	// RootFileSystem::NodeBase
+	//
+	// Implements the functionality common to all node types
+	class NodeBase
+	{
+	public:
+
+		// Instance Constructor
+		//
+		NodeBase(std::shared_ptr<RootFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid);
+
+		// Destructor
+		//
+		virtual ~NodeBase();
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Index
+		//
+		// Gets the index number assigned to this node
+		__declspec(property(get=getIndex)) intptr_t Index;
+		intptr_t getIndex(void) const;
+
+	protected:
+
+		//---------------------------------------------------------------------
+		// Protected Member Functions
+
+		// ChangeOwnership
+		//
+		// Changes the ownership of this node
+		void ChangeOwnership(uapi::uid_t uid, uapi::gid_t gid);
+
+		// ChangePermissions
+		//
+		// Changes the permission flags for this node
+		void ChangePermissions(uapi::mode_t permissions);
+
+		// StatNode
+		//
+		// Provides the statistical information common to all node types
+		void StatNode(uapi::stat* stats) const;
+
+		// UpdateAccessTime
+		//
+		// Updates the access time value of the node
+		void UpdateAccessTime(std::shared_ptr<FileSystem::Mount> mount);
+
+		//---------------------------------------------------------------------
+		// Protected Member Variables
+
+		const std::shared_ptr<RootFileSystem>	m_fs;		// Parent file system instance
+		const intptr_t							m_index;	// Node index number
+		datetime								m_ctime;	// Change timestamp
+		datetime								m_mtime;	// Modification timestamp
+		datetime								m_atime;	// Access timestamp
+		std::atomic<uapi::mode_t>				m_mode;		// Permission/mode flags
+		std::atomic<uapi::uid_t>				m_uid;		// Node UID
+		std::atomic<uapi::gid_t>				m_gid;		// Node GID
+		mutable sync::critical_section			m_cs;		// Synchronization object
+
+	private:
+
+		NodeBase(const NodeBase&)=delete;
+		NodeBase& operator=(const NodeBase&)=delete;
+	};
+
+	// RootFileSystem::DirectoryHandle
+	//
+	class DirectoryHandle : public FileSystem::Handle
+	{
+	public:
+
+		// Instance Constructor
+		//
+		DirectoryHandle(std::shared_ptr<RootFileSystem> fs, std::shared_ptr<DirectoryNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+
+		// Destructor
+		//
+		~DirectoryHandle();
+
+		//---------------------------------------------------------------------
+		// FileSystem::Handle Implementation
+
+		// Duplicate
+		//
+		// Creates a duplicate Handle instance
+		virtual std::shared_ptr<Handle> Duplicate(void) const override;
+
+		// Read
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+		// ReadAt
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+		// Seek
+		//
+		// Changes the file position
+		virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+		// Sync
+		//
+		// Synchronizes all metadata and data associated with the file to storage
+		virtual void Sync(void) const override;
+
+		// SyncData
+		//
+		// Synchronizes all data associated with the file to storage, not metadata
+		virtual void SyncData(void) const override;
+
+		// Write
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+		// WriteAt
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+		// getAccess
+		//
+		// Gets the handle access mode
+		virtual FileSystem::HandleAccess getAccess(void) const override;
+
+		// getFlags
+		//
+		// Gets the handle flags
+		virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	private:
+
+		DirectoryHandle(const DirectoryHandle&)=delete;
+		DirectoryHandle& operator=(const DirectoryHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<RootFileSystem>	m_fs;			// Parent file system instance
+		const std::shared_ptr<DirectoryNode>	m_node;			// Directory node instance
+		const FileSystem::HandleAccess			m_access;		// Handle access mode
+		const FileSystem::HandleFlags			m_flags;		// Handle flags
+		uapi::loff_t							m_position;		// Current directory position
+		const entry_t*							m_cursor;		// Last entry enumerated
+		mutable sync::critical_section			m_cs;			// Synchronization object
+	};
 
 	// RootFileSystem::DirectoryNode
 	//
-	class DirectoryNode : public FileSystem::Directory
+	class DirectoryNode : public NodeBase, public FileSystem::Directory, public std::enable_shared_from_this<DirectoryNode>
 	{
 	public:
 
 		// Instance Constructor
 		//
-		DirectoryNode(std::shared_ptr<RootFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid);
+		DirectoryNode(std::shared_ptr<RootFileSystem> fs, intptr_t parent, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid);
 
 		// Destructor
 		//
-		~DirectoryNode()=default;
+		virtual ~DirectoryNode();
 
 		//---------------------------------------------------------------------
-		// FileSystem::Directory Implementation
+		// Member Functions
 
-		// CreateDirectory
+		// Find
 		//
-		// Creates a new directory node as a child of this directory
-		virtual std::shared_ptr<FileSystem::Alias> CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+		// Locates a child entry by name without acquiring any locks
+		const entry_t* Find(const char_t* name, size_t length) const;
 
-		// CreateFile
+		// Insert
 		//
-		// Creates a new regular file node as a child of this directory
-		virtual std::shared_ptr<FileSystem::Alias> CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+		// Publishes a new child entry; the file system namespace lock must be held
+		void Insert(std::shared_ptr<Alias> alias);
 
-		// Lookup
+		// Populate
 		//
-		// Looks up the alias associated with a child of this directory
-		virtual std::shared_ptr<FileSystem::Alias> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const override;
+		// Bulk loads the contents of a CPIO archive as descendants of this directory
+		void Populate(const std::unique_ptr<StreamReader>& archive);
+
+		// ReadDirectory
+		//
+		// Reads entries from the directory as packed linux_dirent64 structures
+		uapi::size_t ReadDirectory(uapi::loff_t& position, const entry_t*& cursor, void* buffer, uapi::size_t count) const;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
 
 		// Open
 		//
@@ -150,6 +431,24 @@ private:
 		// Gets the type of file system node being implemented
 		virtual FileSystem::NodeType getType(void) const override;
 
+		//---------------------------------------------------------------------
+		// FileSystem::Directory Implementation
+
+		// CreateDirectory
+		//
+		// Creates a new directory node as a child of this directory
+		virtual std::shared_ptr<FileSystem::Alias> CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+
+		// CreateFile
+		//
+		// Creates a new regular file node as a child of this directory
+		virtual std::shared_ptr<FileSystem::Alias> CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+
+		// Lookup
+		//
+		// Looks up the alias associated with a child of this directory
+		virtual FileSystem::Result<std::shared_ptr<FileSystem::Alias>> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const override;
+
 	private:
 
 		DirectoryNode(const DirectoryNode&)=delete;
@@ -158,37 +457,35 @@ private:
 		//---------------------------------------------------------------------
 		// Private Member Functions
 
-		// UpdateAccessTime
+		// CreateNode
 		//
-		// Updates the access time value of the node
-		void UpdateAccessTime(std::shared_ptr<FileSystem::Mount> mount);
+		// Creates a new child node of the specified type
+		std::shared_ptr<FileSystem::Alias> CreateNode(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, FileSystem::NodeType type, uapi::mode_t mode);
 
 		//---------------------------------------------------------------------
 		// Member Variables
 
-		const std::shared_ptr<RootFileSystem>	m_fs;		// Parent file system instance
-		datetime								m_ctime;	// Change timestamp
-		datetime								m_mtime;	// Modification timestamp
-		datetime								m_atime;	// Access timestamp
-		uapi::mode_t							m_mode;		// Permission/mode flags
-		uapi::uid_t								m_uid;		// Node UID
-		uapi::gid_t								m_gid;		// Node GID
-		mutable sync::critical_section			m_cs;		// Synchronization object
+		const intptr_t					m_parent;		// Parent directory index number
+		std::atomic<table_t*>			m_table;		// Current entry hash table
+		std::atomic<const entry_t*>		m_first;		// First entry in enumeration order
+		entry_t*						m_last;			// Last entry in enumeration order
+		std::atomic<size_t>				m_count;		// Number of child entries
+		std::atomic<size_t>				m_subdirs;		// Number of child directories
 	};
 
-	// RootFileSystem::DirectoryHandle
+	// RootFileSystem::FileHandle
 	//
-	class DirectoryHandle : public FileSystem::Handle
+	class FileHandle : public FileSystem::Handle
 	{
 	public:
 
 		// Instance Constructor
 		//
-		DirectoryHandle(std::shared_ptr<RootFileSystem> fs, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+		FileHandle(std::shared_ptr<RootFileSystem> fs, std::shared_ptr<FileNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
 
 		// Destructor
 		//
-		~DirectoryHandle();
+		~FileHandle();
 
 		//---------------------------------------------------------------------
 		// FileSystem::Handle Implementation
@@ -208,6 +505,11 @@ private:
 		// Synchronously reads data from the underlying node into a buffer
 		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
 
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
 		// Seek
 		//
 		// Changes the file position
@@ -245,15 +547,124 @@ private:
 
 	private:
 
-		DirectoryHandle(const DirectoryHandle&)=delete;
-		DirectoryHandle& operator=(const DirectoryHandle&)=delete;
+		FileHandle(const FileHandle&)=delete;
+		FileHandle& operator=(const FileHandle&)=delete;
 
 		//---------------------------------------------------------------------
 		// Member Variables
 
 		const std::shared_ptr<RootFileSystem>	m_fs;			// Parent file system instance
+		const std::shared_ptr<FileNode>			m_node;			// File node instance
 		const FileSystem::HandleAccess			m_access;		// Handle access mode
 		const FileSystem::HandleFlags			m_flags;		// Handle flags
+		std::shared_ptr<filepos_t>				m_position;		// File position
+	};
+
+	// RootFileSystem::FileNode
+	//
+	class FileNode : public NodeBase, public FileSystem::File, public std::enable_shared_from_this<FileNode>
+	{
+	public:
+
+		// Instance Constructor
+		//
+		FileNode(std::shared_ptr<RootFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid);
+
+		// Destructor
+		//
+		virtual ~FileNode();
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// Append
+		//
+		// Writes data to the end of the file, returns the new length
+		uapi::loff_t Append(const void* buffer, uapi::size_t count, uapi::size_t* written);
+
+		// Load
+		//
+		// Loads the file data from a stream; the node cannot have been published yet
+		void Load(StreamReader& data);
+
+		// Read
+		//
+		// Reads data from the file
+		uapi::size_t Read(uapi::loff_t offset, void* buffer, uapi::size_t count) const;
+
+		// SetLength
+		//
+		// Sets the length of the file, releasing any pages beyond the new end
+		void SetLength(uapi::loff_t length);
+
+		// Write
+		//
+		// Writes data into the file
+		uapi::size_t Write(uapi::loff_t offset, const void* buffer, uapi::size_t count);
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a Handle instance against this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about the node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// Type
+		//
+		// Gets the type of file system node being implemented
+		virtual FileSystem::NodeType getType(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::File Implementation
+
+		// OpenExec
+		//
+		// Creates an execute-only handle against this node
+		virtual std::shared_ptr<FileSystem::Handle> OpenExec(std::shared_ptr<FileSystem::Mount> mount) const override;
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Length
+		//
+		// Gets the length of the file data
+		__declspec(property(get=getLength)) uapi::loff_t Length;
+		uapi::loff_t getLength(void) const;
+
+	private:
+
+		FileNode(const FileNode&)=delete;
+		FileNode& operator=(const FileNode&)=delete;
+
+		//---------------------------------------------------------------------
+		// Private Member Functions
+
+		// WriteData
+		//
+		// Writes data into the file pages; the node lock must be held
+		uapi::size_t WriteData(uapi::loff_t offset, const void* buffer, uapi::size_t count);
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		std::vector<uint8_t*>		m_pages;		// File data pages (null = hole)
+		uapi::loff_t				m_length;		// Length of the file data
 	};
 
 	// RootFileSystem::Mount
@@ -321,18 +732,44 @@ private:
 		std::shared_ptr<DirectoryNode>			m_root;		// The root directory node
 	};
 
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// AddHandle
+	//
+	// Adds a handle instance to the active handle collection
+	void AddHandle(const std::shared_ptr<FileSystem::Handle>& handle);
+
+	// AllocatePage
+	//
+	// Allocates a file data page from the private heap
+	uint8_t* AllocatePage(bool zero);
+
+	// ReleasePage
+	//
+	// Releases a file data page back to the private heap
+	void ReleasePage(uint8_t* page);
+
+	// RemoveHandle
+	//
+	// Removes a handle instance from the active handle collection
+	void RemoveHandle(FileSystem::Handle* handle);
+
 	//-------------------------------------------------------------------------
 	// Member Variables
 
 	const std::string				m_source;		// Source device name
 	std::atomic<uint32_t>			m_flags;		// File system flags
 	const uapi::fsid_t				m_fsid;			// File system unique identifier
+	HANDLE							m_heap;			// Private file data heap
+	IndexPool<intptr_t>				m_indexpool;	// Node index number pool
 	handlemap_t						m_handles;		// Active handle instances
 	mutable sync::critical_section	m_cs;			// Synchronization object
+	sync::critical_section			m_namelock;		// Namespace modification lock
 };
 
 //-----------------------------------------------------------------------------
 
 #pragma warning(pop)
 
-#endif	// __ROOTFILESYSTEM_H_
\ No newline at end of file
+#endif	// __ROOTFILESYSTEM_H_
@@ -43,9 +43,8 @@
 
 std::shared_ptr<Session> AddSessionProcess(std::shared_ptr<Session> session, std::shared_ptr<Process> process)
 {
-	sync::critical_section::scoped_lock cs{ session->m_cs };
-	if(!session->m_processes.emplace(process.get(), process).second) throw LinuxException{ LINUX_ENOMEM };
-
+	// Adding a process that is already a member has no effect
+	session->m_processes.Add(process);
 	return session;
 }
 
@@ -61,9 +60,8 @@ std::shared_ptr<Session> AddSessionProcess(std::shared_ptr<Session> session, std
 
 std::shared_ptr<Session> AddSessionProcessGroup(std::shared_ptr<Session> session, std::shared_ptr<ProcessGroup> pgroup)
 {
-	sync::critical_section::scoped_lock cs{ session->m_cs };
-	if(!session->m_pgroups.emplace(pgroup.get(), pgroup).second) throw LinuxException{ LINUX_ENOMEM };
-
+	// Adding a process group that is already a member has no effect
+	session->m_pgroups.Add(pgroup);
 	return session;
 }
 
@@ -79,8 +77,7 @@ std::shared_ptr<Session> AddSessionProcessGroup(std::shared_ptr<Session> session
 
 void RemoveSessionProcess(std::shared_ptr<Session> session, Process const* process)
 {
-	sync::critical_section::scoped_lock cs{ session->m_cs };
-	session->m_processes.erase(process);
+	session->m_processes.Remove(process);
 }
 
 //-----------------------------------------------------------------------------
@@ -95,8 +92,7 @@ void RemoveSessionProcess(std::shared_ptr<Session> session, Process const* proce
 
 void RemoveSessionProcessGroup(std::shared_ptr<Session> session, ProcessGroup const* pgroup)
 {
-	sync::critical_section::scoped_lock cs{ session->m_cs };
-	session->m_pgroups.erase(pgroup);
+	session->m_pgroups.Remove(pgroup);
 }
 
 //-----------------------------------------------------------------------------
@@ -112,17 +108,9 @@ void RemoveSessionProcessGroup(std::shared_ptr<Session> session, ProcessGroup co
 
 std::shared_ptr<Session> SwapSessionProcess(std::shared_ptr<Session> source, std::shared_ptr<Session> dest, Process const* process)
 {
-	sync::critical_section::scoped_lock csfrom{ source->m_cs };
-	sync::critical_section::scoped_lock csto{ dest->m_cs };
+	if(source == dest) return dest;
 
-	// Move the weak_ptr to the process from the source session into the destination session, watch that
-	// unodered_map::at() will throw std::out_of_range exception if the key is not found, convert to ESRCH
-	try {
-
-		if(!dest->m_processes.emplace(process, std::move(source->m_processes.at(process))).second) throw LinuxException{ LINUX_ENOMEM };
-		source->m_processes.erase(process);
-	}
-	catch(std::out_of_range&) { throw LinuxException{ LINUX_ESRCH }; }
+	if(!Session::process_list_t::Move(source->m_processes, dest->m_processes, process)) throw LinuxException{ LINUX_ESRCH };
 
 	return dest;
 }
@@ -163,11 +151,32 @@ std::shared_ptr<Session> Session::Create(std::shared_ptr<Pid> sid, std::shared_p
 	auto session = std::make_shared<Session>(std::move(sid), vm);
 
 	// The parent container link has to be established after the shared_ptr has been constructed
-	AddVirtualMachineSession(vm, session);
+	AddVirtualMachineSession(vm, session);			// Link to the virtual machine
+	session->m_sid->AttachSession(session);			// Link to the pid namespace(s)
 
 	return session;
 }
 
+//-----------------------------------------------------------------------------
+// Session::getProcesses
+//
+// Gets a snapshot of the processes in this session
+
+std::vector<std::shared_ptr<Process>> Session::getProcesses(void) const
+{
+	return m_processes.Members;
+}
+
+//-----------------------------------------------------------------------------
+// Session::getProcessGroups
+//
+// Gets a snapshot of the process groups in this session
+
+std::vector<std::shared_ptr<ProcessGroup>> Session::getProcessGroups(void) const
+{
+	return m_pgroups.Members;
+}
+
 //-----------------------------------------------------------------------------
 // Session::getSessionId
 //
@@ -178,6 +187,27 @@ std::shared_ptr<Pid> Session::getSessionId(void) const
 	return m_sid;
 }
 
+//-----------------------------------------------------------------------------
+// Session::Signal
+//
+// Sends a signal to every process in the session
+//
+// Arguments:
+//
+//	siginfo		- Signal information
+
+void Session::Signal(uapi::siginfo const& siginfo) const
+{
+	// Walk the current snapshot without holding the lock; processes that join the
+	// session after the snapshot was taken do not receive the signal
+	auto snapshot = m_processes.Snapshot;
+	for(auto const& entry : *snapshot) {
+
+		auto process = entry.lock();
+		if(process) process->Signal(siginfo);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // Session::getVirtualMachine
 //
@@ -25,7 +25,8 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
+#include <vector>
+#include "Membership.h"
 
 #pragma warning(push, 4)
 
@@ -41,6 +42,9 @@ class VirtualMachine;
 //
 // Implements a session, which is a collection of process groups that are 
 // associated with a controlling terminal (stdin/stdout)
+//
+// Readers walk a snapshot of the memberships without acquiring the lock, see
+// the Membership class for details
 
 class Session
 {
@@ -86,9 +90,26 @@ public:
 	// Creates a new session instance
 	static std::shared_ptr<Session> Create(std::shared_ptr<Pid> sid, std::shared_ptr<VirtualMachine> vm);
 
+	// Signal
+	//
+	// Sends a signal to every process in the session
+	void Signal(uapi::siginfo const& siginfo) const;
+
 	//-------------------------------------------------------------------------
 	// Properties
 
+	// ProcessGroups
+	//
+	// Gets a snapshot of the process groups in this session
+	__declspec(property(get=getProcessGroups)) std::vector<std::shared_ptr<ProcessGroup>> ProcessGroups;
+	std::vector<std::shared_ptr<ProcessGroup>> getProcessGroups(void) const;
+
+	// Processes
+	//
+	// Gets a snapshot of the processes in this session
+	__declspec(property(get=getProcesses)) std::vector<std::shared_ptr<Process>> Processes;
+	std::vector<std::shared_ptr<Process>> getProcesses(void) const;
+
 	// SessionId
 	//
 	// Gets the session identifier
@@ -106,20 +127,20 @@ private:
 	Session(Session const&)=delete;
 	Session& operator=(Session const&)=delete;
 
-	// pgroup_map_t
+	// pgroup_list_t
 	//
-	// Collection of process group instances
-	using pgroup_map_t = std::unordered_map<ProcessGroup const*, std::weak_ptr<ProcessGroup>>;
+	// Collection of member process groups
+	using pgroup_list_t = Membership<ProcessGroup>;
 
 	// pid_t
 	//
 	// Pid shared pointer
 	using pid_t = std::shared_ptr<Pid>;
 
-	// process_map_t
+	// process_list_t
 	//
-	// Collection of process instances
-	using process_map_t = std::unordered_map<Process const*, std::weak_ptr<Process>>;
+	// Collection of member processes
+	using process_list_t = Membership<Process>;
 
 	// vm_t
 	//
@@ -136,9 +157,8 @@ private:
 
 	pid_t const						m_sid;			// Session identifier
 	vm_t const						m_vm;			// VirtualMachine instance
-	pgroup_map_t					m_pgroups;		// Collection of process groups
-	process_map_t					m_processes;	// Collection of processes
-	mutable sync::critical_section	m_cs;			// Synchronization object
+	pgroup_list_t					m_pgroups;		// Collection of process groups
+	process_list_t					m_processes;	// Collection of processes
 };
 
 //-----------------------------------------------------------------------------
@@ -23,6 +23,8 @@
 #include "stdafx.h"
 #include "SignalActions.h"
 
+#include "LinuxException.h"
+
 #pragma warning(push, 4)
 
 //-----------------------------------------------------------------------------
@@ -36,8 +38,8 @@
 
 std::shared_ptr<SignalActions> SignalActions::Create(void)
 {
-	// Create a new SignalActions instance with an empty collection
-	return std::make_shared<SignalActions>(std::move(action_map_t()));
+	// Create a new SignalActions instance with all default actions
+	return std::make_shared<SignalActions>(action_array_t());
 }
 
 //-----------------------------------------------------------------------------
@@ -51,8 +53,10 @@ std::shared_ptr<SignalActions> SignalActions::Create(void)
 
 std::shared_ptr<SignalActions> SignalActions::Duplicate(const std::shared_ptr<SignalActions>& existing)
 {
-	// Create a new SignalActions instance with a duplicate of the member collection
-	return std::make_shared<SignalActions>(std::move(action_map_t(existing->m_actions)));
+	sync::critical_section::scoped_lock cs{ existing->m_cs };
+
+	// Create a new SignalActions instance with a copy of the member collection
+	return std::make_shared<SignalActions>(existing->m_actions);
 }
 
 //-----------------------------------------------------------------------------
@@ -64,9 +68,36 @@ std::shared_ptr<SignalActions> SignalActions::Duplicate(const std::shared_ptr<Si
 //
 //	signal			- Signal for which to retrieve the action
 
-uapi::sigaction SignalActions::Get(int signal)
+uapi::sigaction SignalActions::Get(int signal) const
+{
+	int index = ValidateSignal(signal);
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+	return m_actions[index];
+}
+
+//-----------------------------------------------------------------------------
+// SignalActions::IsIgnored
+//
+// Determines if a signal would be discarded rather than delivered, which is the
+// case for SIG_IGN and for signals whose default action is to be ignored
+//
+// Arguments:
+//
+//	signal			- Signal to be checked
+
+bool SignalActions::IsIgnored(int signal) const
 {
-	return m_actions[signal];			// Return existing value or a default
+	int index = ValidateSignal(signal);
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	if(m_actions[index].sa_handler == LINUX_SIG_IGN) return true;
+	if(m_actions[index].sa_handler != LINUX_SIG_DFL) return false;
+
+	// SIGCHLD, SIGURG and SIGWINCH are ignored by default; SIGCONT will have resumed
+	// the process by the time it's been sent, which is all that its default action does
+	return ((signal == LINUX_SIGCHLD) || (signal == LINUX_SIGURG) || (signal == LINUX_SIGWINCH) || (signal == LINUX_SIGCONT));
 }
 
 //-----------------------------------------------------------------------------
@@ -80,10 +111,12 @@ uapi::sigaction SignalActions::Get(int signal)
 
 void SignalActions::Reset(void)
 {
+	sync::critical_section::scoped_lock cs{ m_cs };
+
 	// Iterate over all of the contained actions and set anything that isn't
 	// currently being ignored back to a default action
-	for(auto& iterator : m_actions)
-		if(iterator.second.sa_handler != LINUX_SIG_IGN) iterator.second = action_t();
+	for(auto& action : m_actions)
+		if(action.sa_handler != LINUX_SIG_IGN) action = action_t();
 }
 
 //-----------------------------------------------------------------------------
@@ -98,7 +131,7 @@ void SignalActions::Reset(void)
 
 void SignalActions::Set(int signal, uapi::sigaction action)
 {
-	m_actions[signal] = action;			// Add or update existing value
+	Set(signal, &action, nullptr);
 }
 
 //-----------------------------------------------------------------------------
@@ -115,22 +148,32 @@ void SignalActions::Set(int signal, uapi::sigaction action)
 
 void SignalActions::Set(int signal, const uapi::sigaction* action, uapi::sigaction* oldaction)
 {
-	// Locate the specified signal in the collection
-	auto iterator = m_actions.find(signal);
-	
-	if(iterator == m_actions.end()) {
-
-		// The signal does not already exist, return a default structure and insert it
-		if(oldaction) *oldaction = action_t();
-		if(action) m_actions.insert(std::make_pair(signal, *action));
-	}
-
-	else {
-
-		// The signal action has already been defined; return as previous and replace it
-		if(oldaction) *oldaction = iterator->second;
-		if(action) iterator->second = *action;
-	}
+	int index = ValidateSignal(signal);
+
+	// The actions for SIGKILL and SIGSTOP cannot be changed
+	if((action) && ((signal == LINUX_SIGKILL) || (signal == LINUX_SIGSTOP))) throw LinuxException{ LINUX_EINVAL };
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	// Return the previous action and replace it as requested
+	if(oldaction) *oldaction = m_actions[index];
+	if(action) m_actions[index] = *action;
+}
+
+//-----------------------------------------------------------------------------
+// SignalActions::ValidateSignal (private, static)
+//
+// Ensures that a signal number is within the range of the collection and
+// converts it into an array index
+//
+// Arguments:
+//
+//	signal			- Signal number to be validated
+
+int SignalActions::ValidateSignal(int signal)
+{
+	if((signal < 1) || (signal > LINUX__NSIG)) throw LinuxException{ LINUX_EINVAL };
+	return signal - 1;
 }
 
 //-----------------------------------------------------------------------------
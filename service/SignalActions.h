@@ -24,7 +24,7 @@
 #define __SIGNALACTIONS_H_
 #pragma once
 
-#include <concurrent_unordered_map.h>
+#include <array>
 #include <memory>
 
 #pragma warning(push, 4)
@@ -33,7 +33,8 @@
 // SignalActions
 //
 // Implements a collection of signal actions that can be duplicated or shared
-// among multiple process instances
+// among multiple process instances.  Signal numbers are fixed and small, so the
+// actions are stored in an array indexed by the signal number less one
 
 class SignalActions
 {
@@ -59,7 +60,12 @@ public:
 	// Get
 	//
 	// Retrieves the action structure defined for a signal
-	uapi::sigaction Get(int signal);
+	uapi::sigaction Get(int signal) const;
+
+	// IsIgnored
+	//
+	// Determines if a signal would be discarded rather than delivered
+	bool IsIgnored(int signal) const;
 
 	// Reset
 	//
@@ -103,21 +109,29 @@ private:
 		}
 	};
 
-	// action_map_t
+	// action_array_t
 	//
-	// Collection of signal actions, keyed on the signal code.  This implementation
-	// lends itself well to a lock-free map<> since values are never removed/erased
-	using action_map_t = Concurrency::concurrent_unordered_map<int, action_t>;
+	// Collection of signal actions, indexed by the signal number less one
+	using action_array_t = std::array<action_t, LINUX__NSIG>;
 
 	// Instance Constructors
 	//
-	explicit SignalActions(action_map_t&& actions) : m_actions(std::move(actions)) {}
+	explicit SignalActions(const action_array_t& actions) : m_actions(actions) {}
 	friend class std::_Ref_count_obj<SignalActions>;
 
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// ValidateSignal
+	//
+	// Ensures that a signal number is within the range of the collection
+	static int ValidateSignal(int signal);
+
 	//-------------------------------------------------------------------------
 	// Member Variables
 
-	action_map_t				m_actions;			// Contained collection
+	action_array_t					m_actions;		// Contained collection
+	mutable sync::critical_section	m_cs;			// Synchronization object
 };
 
 //-----------------------------------------------------------------------------
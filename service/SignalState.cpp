@@ -0,0 +1,256 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SignalState.h"
+
+#include <syscalls32.h>
+#include "LinuxException.h"
+#include "NativeProcess.h"
+#include "NativeThread.h"
+#include "TaskState.h"
+
+#pragma warning(push, 4)
+
+// ReadMask (local)
+//
+// Atomically reads a 64-bit signal mask from the shared signal state
+inline static uapi::sigset_t ReadMask(sys32_sigset_t const volatile& mask)
+{
+	return static_cast<uapi::sigset_t>(InterlockedCompareExchange64(reinterpret_cast<LONGLONG volatile*>(const_cast<sys32_sigset_t volatile*>(&mask)), 0, 0));
+}
+
+//-----------------------------------------------------------------------------
+// SignalState Constructor (private)
+//
+// Arguments:
+//
+//	nativeproc		- Native process in which the state was allocated
+//	address			- Address of the state in the native process
+//	mapping			- Local mapping of the state
+
+SignalState::SignalState(NativeProcess& nativeproc, uintptr_t address, void* mapping) : m_nativeproc(nativeproc), m_address(address), m_mapping(mapping)
+{
+	memset(m_siginfo, 0, sizeof(m_siginfo));
+}
+
+//-----------------------------------------------------------------------------
+// SignalState Destructor
+
+SignalState::~SignalState()
+{
+	m_nativeproc.UnmapMemory(m_mapping);
+	m_nativeproc.ReleaseMemory(m_address, sizeof(sys32_sigstate_t));
+}
+
+//-----------------------------------------------------------------------------
+// SignalState::Create (static)
+//
+// Creates a new SignalState instance in the specified native process
+//
+// Arguments:
+//
+//	nativeproc		- Native process in which to allocate the state
+
+std::unique_ptr<SignalState> SignalState::Create(NativeProcess& nativeproc)
+{
+	// Only the 32-bit host implements the shared signal state at this time
+	if(nativeproc.Architecture != Architecture::x86) throw LinuxException{ LINUX_ENOSYS };
+
+	// Allocate the signal state in the native process, the memory is initially zeroed
+	uintptr_t address = nativeproc.AllocateMemory(sizeof(sys32_sigstate_t), ProcessMemory::Protection::Read | ProcessMemory::Protection::Write);
+
+	try {
+
+		// Map the signal state into this process so that it can be accessed directly
+		void* mapping = nativeproc.MapMemory(address, sizeof(sys32_sigstate_t), ProcessMemory::Protection::Read | ProcessMemory::Protection::Write);
+		return std::make_unique<SignalState>(nativeproc, address, mapping);
+	}
+
+	catch(...) { nativeproc.ReleaseMemory(address, sizeof(sys32_sigstate_t)); throw; }
+}
+
+//-----------------------------------------------------------------------------
+// SignalState::Dequeue
+//
+// Dequeues the next signal that is not blocked by the specified mask
+//
+// Arguments:
+//
+//	blocked		- Blocked signal mask provided by the host
+//	siginfo		- Receives the queued signal information
+
+int SignalState::Dequeue(uapi::sigset_t blocked, uapi::siginfo* siginfo)
+{
+	unsigned long		bit;			// Lowest deliverable signal bit
+
+	sys32_sigstate_t volatile* state = reinterpret_cast<sys32_sigstate_t volatile*>(m_mapping);
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	// SIGKILL and SIGSTOP cannot be blocked regardless of what the host says
+	blocked &= ~(uapi::sigmask(LINUX_SIGKILL) | uapi::sigmask(LINUX_SIGSTOP));
+
+	// Locate the lowest numbered pending signal that is not blocked
+	uapi::sigset_t deliverable = ReadMask(state->pending) & ~blocked;
+	if(!BitScanForward64(&bit, deliverable)) return 0;
+
+	// Clear the pending bit and hand back the queued signal information
+	InterlockedAnd64(reinterpret_cast<LONGLONG volatile*>(&state->pending), ~static_cast<LONGLONG>(uapi::sigmask(bit + 1)));
+	if(siginfo) *siginfo = m_siginfo[bit];
+
+	return static_cast<int>(bit + 1);
+}
+
+//-----------------------------------------------------------------------------
+// SignalState::getAddress
+//
+// Gets the address of the signal state in the native process
+
+uintptr_t SignalState::getAddress(void) const
+{
+	return m_address;
+}
+
+//-----------------------------------------------------------------------------
+// SignalState::getBlocked
+//
+// Gets the current blocked signal mask
+
+uapi::sigset_t SignalState::getBlocked(void) const
+{
+	return ReadMask(reinterpret_cast<sys32_sigstate_t volatile*>(m_mapping)->blocked);
+}
+
+//-----------------------------------------------------------------------------
+// SignalState::getPending
+//
+// Gets the current pending signal mask
+
+uapi::sigset_t SignalState::getPending(void) const
+{
+	return ReadMask(reinterpret_cast<sys32_sigstate_t volatile*>(m_mapping)->pending);
+}
+
+//-----------------------------------------------------------------------------
+// SignalState::Interrupt
+//
+// Interrupts the native thread to deliver pending signals
+//
+// Arguments:
+//
+//	nativethread	- Native thread to be interrupted
+//	entrypoint		- Host signal entry point address
+
+void SignalState::Interrupt(NativeThread const& nativethread, uintptr_t entrypoint) const
+{
+	sys32_sigstate_t volatile* state = reinterpret_cast<sys32_sigstate_t volatile*>(m_mapping);
+
+	if(entrypoint == 0) return;			// Host has not provided an entry point
+
+	// The thread can only be redirected while it's executing application code, if it
+	// happens to be somewhere else, give it a chance to get back there and try again
+	for(int attempt = 0; attempt < INTERRUPT_ATTEMPTS; attempt++) {
+
+		// The host checks for deliverable signals when it exits a system call, and
+		// there is nothing to do if the signal(s) were dequeued in the meantime
+		if((state->insyscall) || (state->interrupted)) return;
+		if((ReadMask(state->pending) & ~ReadMask(state->blocked)) == 0) return;
+
+		nativethread.Suspend();
+
+		try { if(Redirect(nativethread, entrypoint)) { nativethread.Resume(); return; } }
+		catch(...) { nativethread.Resume(); throw; }
+
+		nativethread.Resume();
+		SwitchToThread();
+	}
+
+	// If the thread couldn't be redirected the signal(s) remain pending until the
+	// next time that the thread makes a system call
+}
+
+//-----------------------------------------------------------------------------
+// SignalState::Queue
+//
+// Queues a signal, returns a flag indicating if it can be delivered
+//
+// Arguments:
+//
+//	siginfo		- Signal information
+
+bool SignalState::Queue(uapi::siginfo const& siginfo)
+{
+	sys32_sigstate_t volatile* state = reinterpret_cast<sys32_sigstate_t volatile*>(m_mapping);
+
+	if((siginfo.si_signo < 1) || (siginfo.si_signo > LINUX__NSIG)) throw LinuxException{ LINUX_EINVAL };
+	uapi::sigset_t mask = uapi::sigmask(siginfo.si_signo);
+
+	sync::critical_section::scoped_lock cs{ m_cs };
+
+	// Signals are not queued, only the information from the first instance of a
+	// signal that is already pending is kept (this includes real-time signals)
+	LONGLONG previous = InterlockedOr64(reinterpret_cast<LONGLONG volatile*>(&state->pending), static_cast<LONGLONG>(mask));
+	if((previous & mask) == 0) m_siginfo[siginfo.si_signo - 1] = siginfo;
+
+	return (ReadMask(state->blocked) & mask) == 0;
+}
+
+//-----------------------------------------------------------------------------
+// SignalState::Redirect (private)
+//
+// Redirects a suspended native thread to the host signal entry point
+//
+// Arguments:
+//
+//	nativethread	- Suspended native thread to be redirected
+//	entrypoint		- Host signal entry point address
+
+bool SignalState::Redirect(NativeThread const& nativethread, uintptr_t entrypoint) const
+{
+	MEMORY_BASIC_INFORMATION		meminfo;		// Information about the instruction pointer
+
+	sys32_sigstate_t volatile* state = reinterpret_cast<sys32_sigstate_t volatile*>(m_mapping);
+
+	// Check the flags again now that the thread has been suspended
+	if((state->insyscall) || (state->interrupted)) return true;
+
+	// Capture the task state and ensure that it's executing application code, which will always
+	// be in a section mapped by the service; the host image, heaps and stacks are not
+	auto task = TaskState::Capture(nativethread.Architecture, nativethread.ThreadHandle);
+	if(VirtualQueryEx(m_nativeproc.ProcessHandle, task->InstructionPointer, &meminfo, sizeof(MEMORY_BASIC_INFORMATION)) == 0) return false;
+	if(meminfo.Type != MEM_MAPPED) return false;
+
+	// Save the original task state for the host to restore and redirect the thread
+	_ASSERTE(task->Length == sizeof(sys32_task_t));
+	memcpy(const_cast<sys32_task_t*>(&state->task), task->Data, sizeof(sys32_task_t));
+	state->interrupted = 1;
+
+	task->InstructionPointer = reinterpret_cast<void const*>(entrypoint);
+	task->Restore(nativethread.Architecture, nativethread.ThreadHandle);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __SIGNALSTATE_H_
+#define __SIGNALSTATE_H_
+#pragma once
+
+#include <memory>
+
+#pragma warning(push, 4)
+
+// Forward Declarations
+//
+class NativeProcess;
+class NativeThread;
+
+//-----------------------------------------------------------------------------
+// SignalState
+//
+// Implements the per-thread signal state.  The blocked and pending signal masks
+// are kept in memory allocated in the native process and mapped into the service
+// so that the host can examine and change them without making a system call.
+// The host owns the blocked mask, the service sets bits in the pending mask and
+// clears them when signals are dequeued for delivery
+//
+// When a signal becomes deliverable, the host will pick it up when it exits the
+// next system call.  If the thread is executing application code instead, it's
+// suspended and redirected to the host signal entry point with the original task
+// state saved into the shared memory for the host to restore
+
+class SignalState
+{
+public:
+
+	// Destructor
+	//
+	~SignalState();
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Create (static)
+	//
+	// Creates a new SignalState instance in the specified native process
+	static std::unique_ptr<SignalState> Create(NativeProcess& nativeproc);
+
+	// Dequeue
+	//
+	// Dequeues the next signal that is not blocked by the specified mask
+	int Dequeue(uapi::sigset_t blocked, uapi::siginfo* siginfo);
+
+	// Interrupt
+	//
+	// Interrupts the native thread to deliver pending signals
+	void Interrupt(NativeThread const& nativethread, uintptr_t entrypoint) const;
+
+	// Queue
+	//
+	// Queues a signal, returns a flag indicating if it can be delivered
+	bool Queue(uapi::siginfo const& siginfo);
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// Address
+	//
+	// Gets the address of the signal state in the native process
+	__declspec(property(get=getAddress)) uintptr_t Address;
+	uintptr_t getAddress(void) const;
+
+	// Blocked
+	//
+	// Gets the current blocked signal mask
+	__declspec(property(get=getBlocked)) uapi::sigset_t Blocked;
+	uapi::sigset_t getBlocked(void) const;
+
+	// Pending
+	//
+	// Gets the current pending signal mask
+	__declspec(property(get=getPending)) uapi::sigset_t Pending;
+	uapi::sigset_t getPending(void) const;
+
+private:
+
+	SignalState(SignalState const&)=delete;
+	SignalState& operator=(SignalState const&)=delete;
+
+	// INTERRUPT_ATTEMPTS
+	//
+	// Number of times to try and catch the thread executing application code
+	static const int INTERRUPT_ATTEMPTS = 100;
+
+	// Instance Constructor
+	//
+	SignalState(NativeProcess& nativeproc, uintptr_t address, void* mapping);
+	friend std::unique_ptr<SignalState> std::make_unique<SignalState, NativeProcess&, uintptr_t&, void*&>(NativeProcess&, uintptr_t&, void*&);
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// Redirect
+	//
+	// Redirects a suspended native thread to the host signal entry point
+	bool Redirect(NativeThread const& nativethread, uintptr_t entrypoint) const;
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	NativeProcess&					m_nativeproc;			// Owning native process
+	uintptr_t const					m_address;				// Address in the native process
+	void* const						m_mapping;				// Local mapping of the state
+	uapi::siginfo					m_siginfo[LINUX__NSIG];	// Queued signal information
+	mutable sync::critical_section	m_cs;					// Synchronization object
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __SIGNALSTATE_H_
@@ -23,163 +23,284 @@
 #include "stdafx.h"
 #include "TempFileSystem.h"
 
+#include <algorithm>
+#include "Capability.h"
+#include "FilePermission.h"
+#include "LinuxException.h"
+#include "MountOptions.h"
+#include "SystemInformation.h"
+#include "Win32Exception.h"
+
 #pragma warning(push, 4)
 
+// DIRECTORY_ENTRY_SIZE
+//
+// Nominal size of a directory entry, used to report the size of a directory node
+static const uapi::loff_t DIRECTORY_ENTRY_SIZE = 20;
+
+// FIRST_COOKIE
+//
+// First enumeration cookie assigned to a child entry; 0 and 1 are "." and ".."
+static const uapi::loff_t FIRST_COOKIE = 2;
+
+// FIRST_INDEX
+//
+// First node index number; the root directory node is always assigned index 2
+static const intptr_t FIRST_INDEX = 2;
+
+// MAXIMUM_FILE_LENGTH
+//
+// Maximum length of a file in the file system
+static const uapi::loff_t MAXIMUM_FILE_LENGTH = 0x7FFFFFFFFFFFFFFF;
+
+// SLAB_PAGES
+//
+// Number of pages allocated from the private heap at a time
+static const size_t SLAB_PAGES = 16;
+
 //-----------------------------------------------------------------------------
-// TempFileSystem Constructor (private)
+// DirectoryEntryType (local)
+//
+// Converts a node type into a linux_dirent64 d_type value
 //
 // Arguments:
 //
-//	source		- Source device name, as provided to Mount()
-//	maxsize		- Maximum size of the file system
-//	maxinodes	- Maximum number of nodes that can be created
+//	type		- Node type to be converted
 
-TempFileSystem::TempFileSystem(const char_t* source, size_t maxsize, size_t maxnodes) : m_source(source ? source : "")
+static uint8_t DirectoryEntryType(FileSystem::NodeType type)
 {
-	// Create a private heap to contain the file system data.  Do not specify a maximum
-	// size here, it limits what can be allocated and cannot be changed after the fact
-	m_heap = HeapCreate(0, 0, 0);
-	if(m_heap == nullptr) throw Win32Exception();
-
-	// Initialize size is zero, maximum is whatever was requested
-	m_size = 0;
-	m_maxsize = maxsize;
+	switch(type) {
+
+		case FileSystem::NodeType::BlockDevice: return LINUX_DT_BLK;
+		case FileSystem::NodeType::CharacterDevice: return LINUX_DT_CHR;
+		case FileSystem::NodeType::Directory: return LINUX_DT_DIR;
+		case FileSystem::NodeType::File: return LINUX_DT_REG;
+		case FileSystem::NodeType::Pipe: return LINUX_DT_FIFO;
+		case FileSystem::NodeType::Socket: return LINUX_DT_SOCK;
+		case FileSystem::NodeType::SymbolicLink: return LINUX_DT_LNK;
+	}
 
-	// Initialize node count is zero, maximum is whatever was requested
-	m_nodes = 0;
-	m_maxnodes = maxnodes;
+	return LINUX_DT_UNKNOWN;
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem Destructor
-
-TempFileSystem::~TempFileSystem()
+// PackDirectoryEntry (local)
+//
+// Packs a single linux_dirent64 structure into an output buffer, returns zero
+// if the structure will not fit into the remaining buffer space
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Remaining length of the destination buffer, in bytes
+//	ino			- Node index number
+//	offset		- Position of the next entry in the directory
+//	type		- Entry type (DT_xxx)
+//	name		- Entry name
+//	namelength	- Length of the entry name, in bytes
+
+static uapi::size_t PackDirectoryEntry(void* buffer, uapi::size_t count, uint64_t ino, uapi::loff_t offset, uint8_t type, 
+	const char_t* name, size_t namelength)
 {
-	if(m_heap) HeapDestroy(m_heap);
+	uapi::size_t reclen = align::up(offsetof(uapi::dirent64, d_name) + namelength + 1, 8);
+	if(reclen > count) return 0;
+
+	auto dirent = reinterpret_cast<uapi::dirent64*>(buffer);
+	memset(dirent, 0, reclen);
+	dirent->d_ino = ino;
+	dirent->d_off = offset;
+	dirent->d_reclen = static_cast<uint16_t>(reclen);
+	dirent->d_type = type;
+	memcpy(dirent->d_name, name, namelength);
+
+	return reclen;
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::getMaximumNodes
+// TempFileSystem Constructor
+//
+// Arguments:
 //
-// Gets the maximum number of nodes that can be created in the file system
+//	source		- Source device name, as provided to Mount()
+//	flags		- File system flags and options
+//	maxpages	- Maximum number of data pages that can be allocated
+//	maxnodes	- Maximum number of nodes that can be created
 
-size_t TempFileSystem::getMaximumNodes(void) const
+TempFileSystem::TempFileSystem(const char_t* source, uint32_t flags, size_t maxpages, size_t maxnodes) : m_source(source), m_flags(flags), 
+	m_fsid(FileSystem::GenerateFileSystemId()), m_freepages(nullptr), m_pages(0), m_maxpages(maxpages), m_nodes(0), m_maxnodes(maxnodes), 
+	m_indexpool(FIRST_INDEX)
 {
-	// todo: synchronization object
-	return m_maxnodes;
+	// No mount-specific flags should be specified for the file system instance
+	_ASSERTE((flags & LINUX_MS_PERMOUNT_MASK) == 0);
+
+	// Create a private heap to contain the file system data.  Do not specify a maximum
+	// size here, it limits what can be allocated and cannot be changed after the fact
+	m_heap = HeapCreate(0, 0, 0);
+	if(m_heap == nullptr) throw LinuxException(LINUX_ENOMEM, Win32Exception());
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::putMaximumNodes
-//
-// Sets the maximum number of nodes that can be created in the file system
+// TempFileSystem Destructor
 
-void TempFileSystem::putMaximumNodes(size_t value)
+TempFileSystem::~TempFileSystem()
 {
-	// todo: synchronization object
-	if(m_nodes > value) throw LinuxException(LINUX_EINVAL);
-	m_maxnodes = value;
+	// Destroying the private heap releases all of the slabs at once
+	if(m_heap) HeapDestroy(m_heap);
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::getMaximumSize
+// TempFileSystem::AllocateNode (private)
+//
+// Allocates a node index number, enforcing the maximum number of nodes
+//
+// Arguments:
 //
-// Gets the maximum size of the file system, in bytes
+//	NONE
 
-size_t TempFileSystem::getMaximumSize(void) const
+intptr_t TempFileSystem::AllocateNode(void)
 {
-	// todo: synchronization object
-	return m_maxsize;
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	if(m_nodes >= m_maxnodes) throw LinuxException(LINUX_ENOSPC);
+
+	intptr_t index = m_indexpool.Allocate();
+	++m_nodes;
+
+	return index;
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::putMaximumSize
+// TempFileSystem::AllocatePage (private)
 //
-// Sets the maximum size of the file system, in bytes
+// Allocates a file data page, enforcing the maximum size of the file system
+//
+// Arguments:
+//
+//	zero		- Flag to zero the contents of the page
 
-void TempFileSystem::putMaximumSize(size_t value)
+uint8_t* TempFileSystem::AllocatePage(bool zero)
 {
-	// todo: synchronization object
-	if(m_size > value) throw LinuxException(LINUX_EINVAL);
-	m_maxsize = value;
+	uint8_t*				page;			// Allocated page
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		if(m_pages >= m_maxpages) throw LinuxException(LINUX_ENOSPC);
+
+		// When the free list has been exhausted, allocate a new slab from the private 
+		// heap and carve it up into pages; slabs are only released with the heap
+		if(m_freepages == nullptr) {
+
+			uint8_t* slab = reinterpret_cast<uint8_t*>(HeapAlloc(m_heap, 0, SystemInformation::PageSize * SLAB_PAGES));
+			if(slab == nullptr) throw LinuxException(LINUX_ENOMEM);
+
+			for(size_t index = SLAB_PAGES; index > 0; index--) {
+
+				page = slab + ((index - 1) * SystemInformation::PageSize);
+				*reinterpret_cast<uint8_t**>(page) = m_freepages;
+				m_freepages = page;
+			}
+		}
+
+		// Pop the page from the head of the free list
+		page = m_freepages;
+		m_freepages = *reinterpret_cast<uint8_t**>(page);
+		++m_pages;
+	}
+
+	if(zero) memset(page, 0, SystemInformation::PageSize);
+	return page;
 }
 
 //-----------------------------------------------------------------------------
 // TempFileSystem::Mount (static)
 //
-// Creates a new temporary file system instance
+// Creates an instance of the file system
 //
 // Arguments:
 //
 //	source		- Source device string
-//	flags		- Standard mounting option flags
-//	data		- Extended/custom mounting options
-//	datalength	- Length of the extended mounting options data
+//	flags		- Standard mount options bitmask
+//	data		- Extended mount options data
+//	datalength	- Length of the extended mount options data in bytes
 
 std::shared_ptr<FileSystem::Mount> TempFileSystem::Mount(const char_t* source, uint32_t flags, const void* data, size_t datalength)
 {
 	if(source == nullptr) throw LinuxException(LINUX_EFAULT);
 
-	Capabilities::Demand(Capability::SystemAdmin);
+	Capability::Demand(Capability::SystemAdmin);
+
+	// Default mode, uid and gid for the root directory node
+	uapi::mode_t mode	= LINUX_S_ISVTX | LINUX_S_IRWXUGO;		// 01777
+	uapi::uid_t uid		= 0;
+	uapi::gid_t gid		= 0;
 
 	// Parse the provided mounting options
 	MountOptions options(flags, data, datalength);
 
+	// Break up the standard mounting options bitmask into file system and mount specific masks
+	auto fsflags = options.Flags & (LINUX_MS_RDONLY | LINUX_MS_KERNMOUNT | LINUX_MS_STRICTATIME);
+	auto mountflags = options.Flags & LINUX_MS_PERMOUNT_MASK;
+
 	// Determine the maximum size of the memory available, used when scaling size/nodes to a percentage
 	uint64_t maxaccessible = std::min(SystemInformation::TotalPhysicalMemory, SystemInformation::TotalVirtualMemory);
-	size_t memsize = static_cast<size_t>(std::min(maxaccessible, static_cast<uint64_t>(MAXSIZE_T)));
-
-	// The default file system and node maximums are half of the absolute maximums
-	size_t size = align::up((memsize >> 1), SystemInformation::PageSize);
-	size_t nodes = size / SystemInformation::PageSize;
-
-	// size=
-	//
-	// Sets the maximum size of the file system in bytes
-	if(options.Arguments.Contains("size"))
-		size = align::up(ParseScaledInteger(options.Arguments["size"], memsize), SystemInformation::PageSize);
+	size_t maxpages = static_cast<size_t>(std::min(maxaccessible, static_cast<uint64_t>(MAXSIZE_T))) / SystemInformation::PageSize;
 
-	// nr_blocks=
-	//
-	// Sets the maximum size of the file system in blocks (page size)
-	if(options.Arguments.Contains("nr_blocks")) 
-		size = ParseScaledInteger(options.Arguments["nr_blocks"], memsize / SystemInformation::PageSize) * SystemInformation::PageSize;
+	// The default file system size and node maximums are half of the available pages
+	size_t pages = (maxpages >> 1);
+	size_t nodes = (maxpages >> 1);
 
-	// nr_inodes=
-	//
-	// Sets the maximum number of nodes that can be created
-	if(options.Arguments.Contains("nr_inodes"))
-		nodes = ParseScaledInteger(options.Arguments["nr_inodes"], memsize / SystemInformation::PageSize);
+	try {
 
-	// mode=
-	//
-	// Sets the permission flags to apply to the root directory
-	if(options.Arguments.Contains("mode")) {
-		// todo
+		// size=
+		//
+		// Sets the maximum size of the file system in bytes
+		if(options.Arguments.Contains("size"))
+			pages = align::up(ParseScaledInteger(options.Arguments["size"], maxpages * SystemInformation::PageSize), SystemInformation::PageSize) / SystemInformation::PageSize;
+
+		// nr_blocks=
+		//
+		// Sets the maximum size of the file system in pages
+		if(options.Arguments.Contains("nr_blocks")) pages = ParseScaledInteger(options.Arguments["nr_blocks"], maxpages);
+
+		// nr_inodes=
+		//
+		// Sets the maximum number of nodes that can be created
+		if(options.Arguments.Contains("nr_inodes")) nodes = ParseScaledInteger(options.Arguments["nr_inodes"], maxpages);
+
+		// mode=
+		//
+		// Sets the permission flags to apply to the root directory
+		if(options.Arguments.Contains("mode")) mode = (std::stoul(options.Arguments["mode"], 0, 0) & LINUX_S_IALLUGO);
+
+		// uid=
+		//
+		// Sets the owner UID to apply to the root directory
+		if(options.Arguments.Contains("uid")) uid = std::stoul(options.Arguments["uid"], 0, 0);
+
+		// gid=
+		//
+		// Sets the owner GID to apply to the root directory
+		if(options.Arguments.Contains("gid")) gid = std::stoul(options.Arguments["gid"], 0, 0);
 	}
 
-	// uid=
-	//
-	// Sets the owner UID to apply to the root directory
-	if(options.Arguments.Contains("uid")) {
-		// todo
-	}
+	catch(...) { throw LinuxException(LINUX_EINVAL); }
 
-	// gid=
-	//
-	// Sets the owner GID to apply to the root directory
-	if(options.Arguments.Contains("gid")) {
-		// todo
-	}
+	// The root directory node counts against the maximum number of nodes
+	if(nodes == 0) throw LinuxException(LINUX_EINVAL);
 
-	// todo: need the root directory node
-	return Mount::Create(std::make_shared<TempFileSystem>(source, size, nodes), options.Flags);
+	// Construct the file system instance and the root directory node instance
+	auto fs = std::make_shared<TempFileSystem>(source, fsflags, pages, nodes);
+	auto rootdir = std::make_shared<DirectoryNode>(fs, 0, mode, uid, gid);
+
+	// Construct and return the mount instance
+	return std::make_shared<class Mount>(fs, rootdir, mountflags);
 }
 
 //-----------------------------------------------------------------------------
 // TempFileSystem::ParseScaledInteger (private, static)
 //
-// Parses the value of a scaled integer mountint option (size, nr_blocks, nr_inodes)
+// Parses the value of a scaled integer mounting option (size, nr_blocks, nr_inodes)
 //
 // Arguments:
 //
@@ -237,191 +358,1559 @@ size_t TempFileSystem::ParseScaledInteger(const std::string& value, size_t maxim
 	catch(...) { throw LinuxException(LINUX_EINVAL); }
 }
 
-void TempFileSystem::putReadOnly(bool value)
+//-----------------------------------------------------------------------------
+// TempFileSystem::ReleaseNode (private)
+//
+// Releases a node index number
+//
+// Arguments:
+//
+//	index		- Node index number to be released
+
+void TempFileSystem::ReleaseNode(intptr_t index)
 {
-	(value);
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	m_indexpool.Release(index);
+	--m_nodes;
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::Stat
+// TempFileSystem::ReleasePage (private)
 //
-// Provides statistical information about the file system
+// Releases a file data page
 //
 // Arguments:
 //
-//	stats		- Structure to receieve the file system statistics
+//	page		- Page to be returned to the free list
 
-void TempFileSystem::Stat(uapi::statfs* stats)
+void TempFileSystem::ReleasePage(uint8_t* page)
 {
-	if(stats = nullptr) throw LinuxException(LINUX_EFAULT);
+	_ASSERTE(page);
 
-	// Initialize the output statfs structure to all zeros
-	memset(stats, 0, sizeof(uapi::statfs));
+	sync::critical_section::scoped_lock critsec{ m_cs };
 
-	// todo: set these properly
-	stats->f_type = LINUX_TMPFS_MAGIC;
-	stats->f_bsize = SystemInformation::PageSize;
-	stats->f_blocks = m_maxsize / 512;
-	stats->f_bfree = (m_maxsize - m_size) / 512;
-	stats->f_bavail = stats->f_bfree;
-	stats->f_files = m_maxnodes;
-	stats->f_ffree = (m_maxnodes - m_nodes);
-	//stats->f_fsid = 0;
-	stats->f_namelen = 255;
-	stats->f_frsize = 0;
-	stats->f_flags = 0;		// this should exclude the per-mount flags
+	// Push the page onto the head of the free list
+	*reinterpret_cast<uint8_t**>(page) = m_freepages;
+	m_freepages = page;
+	--m_pages;
 }
 
 //
-// TEMPFILESYSTEM::MOUNT
+// TEMPFILESYSTEM::ALIAS
 //
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::Mount Constructor
+// TempFileSystem::Alias Constructor
 //
 // Arguments:
 //
-//	fs		- Reference to the TempFileSystem instance
-//	flags	- Standard mounting option flags
+//	name			- Name to assign to this alias
+//	node			- Node to attach to this alias
+//	index			- Index number of the node
 
-TempFileSystem::Mount::Mount(const std::shared_ptr<TempFileSystem>& fs, uint32_t flags) : m_fs(fs), m_flags(flags)
+TempFileSystem::Alias::Alias(const char_t* name, std::shared_ptr<FileSystem::Node> node, intptr_t index)
+	: m_node(std::move(node)), m_index(index), m_name(name)
 {
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::Mount::Create (static)
+// TempFileSystem::Alias::GetName
 //
-// Creates a new Mount instance
+// Reads the name assigned to this alias
 //
 // Arguments:
 //
-//	fs		- Reference to the TempFileSystem instance to mount
-//	flags	- Standard mounting flags and options
+//	buffer			- Output buffer
+//	count			- Size of the output buffer, in bytes
 
-std::shared_ptr<class TempFileSystem::Mount> TempFileSystem::Mount::Create(const std::shared_ptr<TempFileSystem>& fs, uint32_t flags)
+uapi::size_t TempFileSystem::Alias::GetName(char_t* buffer, size_t count) const
 {
-	return std::make_shared<class TempFileSystem::Mount>(fs, flags);
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Copy the minimum of the name length or the output buffer size
+	count = std::min(m_name.size(), count);
+	memcpy(buffer, m_name.data(), count * sizeof(char_t));
+	
+	return count;
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::Mount::Duplicate
+// TempFileSystem::Alias::getIndex
+//
+// Gets the index number of the node to which this alias refers
+
+intptr_t TempFileSystem::Alias::getIndex(void) const
+{
+	return m_index;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Alias::getName
+//
+// Gets the name assigned to this alias
+
+std::string TempFileSystem::Alias::getName(void) const
+{
+	return std::string(m_name);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Alias::getNode
+//
+// Gets the node to which this alias refers
+
+std::shared_ptr<FileSystem::Node> TempFileSystem::Alias::getNode(void) const
+{
+	return m_node;
+}
+
+//
+// TEMPFILESYSTEM::DIRECTORYHANDLE
+//
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle Constructor
+//
+// Arguments:
+//
+//	node		- Directory node instance
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+TempFileSystem::DirectoryHandle::DirectoryHandle(std::shared_ptr<DirectoryNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+	: m_node(std::move(node)), m_access(access), m_flags(flags), m_position(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess TempFileSystem::DirectoryHandle::getAccess(void) const
+{
+	return m_access;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::Duplicate
 //
-// Duplicates the mount instance
+// Creates a duplicate Handle instance
 //
 // Arguments:
 //
 //	NONE
 
-std::shared_ptr<FileSystem::Mount> TempFileSystem::Mount::Duplicate(void)
+std::shared_ptr<FileSystem::Handle> TempFileSystem::DirectoryHandle::Duplicate(void) const
+{
+	auto handle = std::make_shared<DirectoryHandle>(m_node, m_access, m_flags);
+
+	// The duplicate handle starts enumerating from the current position of this handle
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	handle->m_position = m_position;
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::getFlags
+//
+// Gets the flags specified on the handle
+
+FileSystem::HandleFlags TempFileSystem::DirectoryHandle::getFlags(void) const
 {
-	return std::make_shared<class TempFileSystem::Mount>(m_fs, m_flags);
+	return m_flags;
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::Mount::Remount
+// TempFileSystem::DirectoryHandle::Read
 //
-// Remounts the file system with different options
+// Synchronously reads data from the underlying node into a buffer
 //
 // Arguments:
 //
-//	flags		- Standard mounting option flags
-//	data		- Extended/custom mounting options
-//	datalength	- Length of the extended mounting options data
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
 
-void TempFileSystem::Mount::Remount(uint32_t flags, const void* data, size_t datalen)
+uapi::size_t TempFileSystem::DirectoryHandle::Read(void* buffer, uapi::size_t count)
 {
-	Capabilities::Demand(Capability::SystemAdmin);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
 
-	// MS_REMOUNT must be specified in the flags when calling this function
-	if((flags & LINUX_MS_REMOUNT) != LINUX_MS_REMOUNT) throw LinuxException(LINUX_EINVAL);
+	throw LinuxException(LINUX_EISDIR);
+}
 
-	// Parse the provided mounting options into remount flags and key/value pairs
-	MountOptions options(flags & LINUX_MS_RMT_MASK, data, datalen);
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Absolute file position to begin reading from
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
 
-	// Filter the flags to only those options which have changed from the current ones
-	uint32_t changedflags = m_flags ^ options.Flags;
+uapi::size_t TempFileSystem::DirectoryHandle::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
 
-	// Determine the maximum size of the memory available, used when scaling size/nodes to a percentage
-	uint64_t maxaccessible = std::min(SystemInformation::TotalPhysicalMemory, SystemInformation::TotalVirtualMemory);
-	size_t memsize = static_cast<size_t>(std::min(maxaccessible, static_cast<uint64_t>(MAXSIZE_T)));
+	throw LinuxException(LINUX_EISDIR);
+}
 
-	// size=
-	//
-	if(options.Arguments.Contains("size"))
-		m_fs->MaximumSize = ParseScaledInteger(options["size"], memsize);
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
 
-	// nr_blocks=
-	//
-	if(options.Arguments.Contains("nr_blocks"))
-		m_fs->MaximumSize = ParseScaledInteger(options["nr_blocks"], memsize / SystemInformation::PageSize) * SystemInformation::PageSize;
+uapi::size_t TempFileSystem::DirectoryHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	return m_node->ReadDirectory(m_position, buffer, count);
+}
 
-	// nr_inodes=
-	//
-	if(options.Arguments.Contains("nr_inodes"))
-		m_fs->MaximumNodes = ParseScaledInteger(options["nr_inodes"], memsize / SystemInformation::PageSize);
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset (relative to whence) to position the file pointer
+//	whence		- Flag indicating the file position from which offset applies
 
-	// MS_RDONLY
-	//
-	//TODO PUT ME BACK if(changedflags & LINUX_MS_RDONLY) m_fs->ReadOnly = (options[LINUX_MS_RDONLY]);
+uapi::loff_t TempFileSystem::DirectoryHandle::Seek(uapi::loff_t offset, int whence)
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
 
-	// MS_SYNCHRONOUS
-	//
-	if(changedflags & LINUX_MS_SYNCHRONOUS) {
+	// Directory positions are enumeration cookies; SEEK_SET can be used to rewind the
+	// directory or to return to a d_off value, SEEK_CUR can only report the position
+	if((whence == LINUX_SEEK_SET) && (offset >= 0)) return (m_position = offset);
+	if((whence == LINUX_SEEK_CUR) && (offset == 0)) return m_position;
 
-		// note: options[flag] = new value
-	}
+	throw LinuxException(LINUX_EINVAL);
+}
 
-	// MS_MANDLOCK
-	//
-	if(changedflags & LINUX_MS_SYNCHRONOUS) {
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
 
-		// note: options[flag] = new value
-	}
+void TempFileSystem::DirectoryHandle::Sync(void) const
+{
+}
 
-	// MS_I_VERSION
-	//
-	if(changedflags & LINUX_MS_I_VERSION) {
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
 
-		// note: options[flag] = new value
-	}
+void TempFileSystem::DirectoryHandle::SyncData(void) const
+{
+}
 
-	// MS_LAZYTIME
-	//
-	if(changedflags & LINUX_MS_LAZYTIME) {
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryHandle::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	count		- Maximum number of bytes to write
 
-		// note: options[flag] = new value
-	}
+uapi::size_t TempFileSystem::DirectoryHandle::Write(const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+	
+	throw LinuxException(LINUX_EISDIR);
 }
 
 //-----------------------------------------------------------------------------
-// TempFileSystem::Mount::getFlags
+// TempFileSystem::DirectoryHandle::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
 //
-// Gets the standard mount option flags
+// Arguments:
+//
+//	offset		- Absolute file position to begin writing from
+//	buffer		- Source buffer
+//	count		- Maximum number of bytes to write
 
-uint32_t TempFileSystem::Mount::getFlags(void)
+uapi::size_t TempFileSystem::DirectoryHandle::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
 {
-	return m_flags;
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_EISDIR);
 }
 
+//
+// TEMPFILESYSTEM::DIRECTORYNODE
+//
+
 //-----------------------------------------------------------------------------
-// TempFileSystem::Mount::Stat
+// TempFileSystem::DirectoryNode Constructor
 //
-// Provides statistical information about the mounted file system
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	parent		- Index number of the parent directory, or zero for the root directory
+//	mode		- Permission flags to assign to the directory
+//	uid			- User ID of the directory owner
+//	gid			- Group ID of the directory owner
+
+TempFileSystem::DirectoryNode::DirectoryNode(std::shared_ptr<TempFileSystem> fs, intptr_t parent, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid) 
+	: NodeBase(std::move(fs), (mode & ~LINUX_S_IFMT) | LINUX_S_IFDIR, uid, gid), m_parent((parent) ? parent : m_index), m_nextcookie(FIRST_COOKIE), m_subdirs(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::CreateDirectory
+//
+// Creates a new directory node as a child of this directory
 //
 // Arguments:
 //
-//	stats		- Structure to receieve the file system statistics
+//	mount		- Mount on which this directory was reached
+//	name		- Name to assign to the new node
+//	mode		- Mode to assign to the new node
+
+std::shared_ptr<FileSystem::Alias> TempFileSystem::DirectoryNode::CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode)
+{
+	return CreateNode(std::move(mount), name, FileSystem::NodeType::Directory, mode);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::CreateFile
+//
+// Creates a new regular file node as a child of this directory
+//
+// Arguments:
+//
+//	mount		- Mount on which this directory was reached
+//	name		- Name to assign to the new node
+//	mode		- Mode to assign to the new node
+
+std::shared_ptr<FileSystem::Alias> TempFileSystem::DirectoryNode::CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode)
+{
+	return CreateNode(std::move(mount), name, FileSystem::NodeType::File, mode);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::CreateNode (private)
+//
+// Creates a new child node and inserts it into the directory
+//
+// Arguments:
+//
+//	mount		- Mount on which this directory was reached
+//	name		- Name to assign to the new node
+//	type		- Type of node to be created
+//	mode		- Mode to assign to the new node
 
-void TempFileSystem::Mount::Stat(uapi::statfs* stats)
+std::shared_ptr<FileSystem::Alias> TempFileSystem::DirectoryNode::CreateNode(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, 
+	FileSystem::NodeType type, uapi::mode_t mode)
 {
-	if(!stats) throw LinuxException(LINUX_EFAULT);
+	std::shared_ptr<Alias>			alias;			// Alias for the new node
+
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	if(name == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Nodes cannot be created on read-only file systems
+	if(mount->Flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	// Verify the name is not empty, too long or one of the special directory entries
+	size_t length = strlen(name);
+	if(length == 0) throw LinuxException(LINUX_ENOENT);
+	if(length > LINUX_NAME_MAX) throw LinuxException(LINUX_ENAMETOOLONG);
+	if((strcmp(name, ".") == 0) || (strcmp(name, "..") == 0)) throw LinuxException(LINUX_EEXIST);
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+		FilePermission::Demand(FilePermission::Write | FilePermission::Execute, m_uid, m_gid, m_mode);
+
+		// Check for an existing entry before the new node is constructed and counted
+		if(m_names.find(name) != m_names.end()) throw LinuxException(LINUX_EEXIST);
+
+		// todo: the owner of the node should be the calling user
+		if(type == FileSystem::NodeType::Directory) {
+
+			auto node = std::make_shared<DirectoryNode>(m_fs, m_index, mode, 0, 0);
+			alias = std::make_shared<Alias>(name, node, node->Index);
+		}
 
-	// Call through to the underlying file system for general statistics
-	m_fs->Stat(stats);
+		else {
 
-	// Combine the per-mount flags defined on this mount with the flags
-	// provided by the underlying file system
-	stats->f_flags |= (m_flags & LINUX_MS_PERMOUNT_MASK);
+			auto node = std::make_shared<FileNode>(m_fs, mode, 0, 0);
+			alias = std::make_shared<Alias>(name, node, node->Index);
+		}
+
+		// Insert the alias into the name index and assign it the next enumeration cookie
+		auto inserted = m_names.emplace(name, alias);
+		try { m_entries.emplace(m_nextcookie, &(*inserted.first)); }
+		catch(...) { m_names.erase(inserted.first); throw; }
+
+		++m_nextcookie;
+		if(type == FileSystem::NodeType::Directory) ++m_subdirs;
+
+		// Adding a child changes the modification time of this directory
+		m_mtime = m_ctime = datetime::now();
+	}
+
+	// Watchers are notified after the directory lock has been released
+	m_notify.Notify(LINUX_IN_CREATE | ((type == FileSystem::NodeType::Directory) ? LINUX_IN_ISDIR : 0), 0, name);
+
+	return alias;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::Lookup
+//
+// Looks up the alias associated with a child of this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this directory was reached
+//	name		- Name of the child alias to look up
+
+FileSystem::Result<std::shared_ptr<FileSystem::Alias>> TempFileSystem::DirectoryNode::Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const
+{
+	UNREFERENCED_PARAMETER(mount);
+
+	if(name == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	FilePermission::Demand(FilePermission::Execute, m_uid, m_gid, m_mode);
+
+	auto found = m_names.find(name);
+	if(found == m_names.end()) return FileSystem::Error{ LINUX_ENOENT };
+
+	return std::static_pointer_cast<FileSystem::Alias>(found->second);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::Open
+//
+// Creates a Handle instance against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this directory was reached
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+std::shared_ptr<FileSystem::Handle> TempFileSystem::DirectoryNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+{
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	// Directory node handles must always be opened in read-only mode
+	if(access != FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EISDIR);
+
+	// Check for flags that are incompatible with opening a directory file system object
+	if(flags & (FileSystem::HandleFlags::Append | FileSystem::HandleFlags::Direct)) throw LinuxException(LINUX_EINVAL);
+
+	// Read access to the directory node is required to open a handle against it
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+		FilePermission::Demand(FilePermission::Read, m_uid, m_gid, m_mode);
+	}
+
+	auto handle = std::make_shared<DirectoryHandle>(shared_from_this(), access, flags);
+	UpdateAccessTime(mount);
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::ReadDirectory
+//
+// Reads entries from the directory as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	position	- Enumeration position, updated to reflect the entries read
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t TempFileSystem::DirectoryNode::ReadDirectory(uapi::loff_t& position, void* buffer, uapi::size_t count) const
+{
+	uint8_t*				dest = reinterpret_cast<uint8_t*>(buffer);		// Destination pointer
+	uapi::size_t			written = 0;									// Bytes written to the buffer
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// The special "." and ".." entries occupy the positions before the first child entry
+	while(position < FIRST_COOKIE) {
+
+		const char_t* name = (position == 0) ? "." : "..";
+		uapi::size_t reclen = PackDirectoryEntry(dest + written, count - written, (position == 0) ? m_index : m_parent, 
+			position + 1, LINUX_DT_DIR, name, strlen(name));
+
+		if(reclen == 0) { if(written == 0) throw LinuxException(LINUX_EINVAL); return written; }
+
+		written += reclen;
+		++position;
+	}
+
+	// The child entries are ordered by cookie; the position is the cookie of the next entry to return,
+	// which remains valid even if the entry it referred to has been removed from the directory
+	for(auto iterator = m_entries.lower_bound(position); iterator != m_entries.end(); iterator++) {
+
+		auto const& entry = *iterator->second;
+
+		uapi::size_t reclen = PackDirectoryEntry(dest + written, count - written, entry.second->Index, iterator->first + 1, 
+			DirectoryEntryType(entry.second->Node->Type), entry.first.c_str(), entry.first.length());
+
+		if(reclen == 0) { if(written == 0) throw LinuxException(LINUX_EINVAL); break; }
+
+		written += reclen;
+		position = iterator->first + 1;
+	}
+
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void TempFileSystem::DirectoryNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	ChangeOwnership(uid, gid);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void TempFileSystem::DirectoryNode::SetPermissions(uapi::mode_t permissions)
+{
+	ChangePermissions(permissions);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::Stat
+//
+// Provides statistical information about this node
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void TempFileSystem::DirectoryNode::Stat(uapi::stat* stats) const
+{
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	StatNode(stats);
+	stats->st_nlink		= 2 + m_subdirs;			// "." and ".." plus each child ".."
+	stats->st_size		= (m_names.size() + 2) * DIRECTORY_ENTRY_SIZE;
+	stats->st_blocks	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::DirectoryNode::getType
+//
+// Gets the type of node represented by this object
+
+FileSystem::NodeType TempFileSystem::DirectoryNode::getType(void) const
+{
+	return FileSystem::NodeType::Directory;
+}
+
+//
+// TEMPFILESYSTEM::FILEHANDLE
+//
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle Constructor
+//
+// Arguments:
+//
+//	node		- File node instance
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+TempFileSystem::FileHandle::FileHandle(std::shared_ptr<FileNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+	: m_node(std::move(node)), m_access(access), m_flags(flags), m_position(std::make_shared<filepos_t>())
+{
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess TempFileSystem::FileHandle::getAccess(void) const
+{
+	return m_access;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> TempFileSystem::FileHandle::Duplicate(void) const
+{
+	auto handle = std::make_shared<FileHandle>(m_node, m_access, m_flags);
+
+	// The duplicate handle shares the file position with this handle
+	handle->m_position = m_position;
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::getFlags
+//
+// Gets the handle flags
+
+FileSystem::HandleFlags TempFileSystem::FileHandle::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t TempFileSystem::FileHandle::Read(void* buffer, uapi::size_t count)
+{
+	// Attempting to read from a write-only handle yields EBADF
+	if(m_access == FileSystem::HandleAccess::WriteOnly) throw LinuxException(LINUX_EBADF);
+
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	uapi::size_t read = m_node->Read(m_position->offset, buffer, count);
+	m_position->offset += read;
+
+	return read;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t TempFileSystem::FileHandle::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	// Attempting to read from a write-only handle yields EBADF
+	if(m_access == FileSystem::HandleAccess::WriteOnly) throw LinuxException(LINUX_EBADF);
+
+	return m_node->Read(offset, buffer, count);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t TempFileSystem::FileHandle::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ENOTDIR);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset into the node data to seek, relative to whence
+//	whence		- Position in the node data that offset is relative to
+
+uapi::loff_t TempFileSystem::FileHandle::Seek(uapi::loff_t offset, int whence)
+{
+	uapi::loff_t			position;			// New file position
+
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	switch(whence) {
+
+		case LINUX_SEEK_SET: position = offset; break;
+		case LINUX_SEEK_CUR: position = m_position->offset + offset; break;
+		case LINUX_SEEK_END: position = m_node->Length + offset; break;
+		default: throw LinuxException(LINUX_EINVAL);
+	}
+
+	if(position < 0) throw LinuxException(LINUX_EINVAL);
+
+	return (m_position->offset = position);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void TempFileSystem::FileHandle::Sync(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void TempFileSystem::FileHandle::SyncData(void) const
+{
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t TempFileSystem::FileHandle::Write(const void* buffer, uapi::size_t count)
+{
+	uapi::size_t			written;			// Number of bytes written
+
+	// Attempting to write to a read-only handle yields EINVAL, not EACCES
+	if(m_access == FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EINVAL);
+
+	sync::critical_section::scoped_lock critsec{ m_position->cs };
+
+	// O_APPEND handles write to the end of the file under the node lock and move to the new end
+	if(m_flags & FileSystem::HandleFlags::Append) m_position->offset = m_node->Append(buffer, count, &written);
+
+	else {
+
+		written = m_node->Write(m_position->offset, buffer, count);
+		m_position->offset += written;
+	}
+
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileHandle::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t TempFileSystem::FileHandle::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	// Attempting to write to a read-only handle yields EINVAL, not EACCES
+	if(m_access == FileSystem::HandleAccess::ReadOnly) throw LinuxException(LINUX_EINVAL);
+
+	// Data cannot be written to a specific location in O_APPEND mode
+	if(m_flags & FileSystem::HandleFlags::Append) throw LinuxException(LINUX_EINVAL);
+
+	return m_node->Write(offset, buffer, count);
+}
+
+//
+// TEMPFILESYSTEM::FILENODE
+//
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	mode		- Permission flags to assign to the file
+//	uid			- User ID of the file owner
+//	gid			- Group ID of the file owner
+
+TempFileSystem::FileNode::FileNode(std::shared_ptr<TempFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid)
+	: NodeBase(std::move(fs), (mode & ~LINUX_S_IFMT) | LINUX_S_IFREG, uid, gid), m_length(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode Destructor
+
+TempFileSystem::FileNode::~FileNode()
+{
+	// Return all of the data pages to the file system
+	for(auto const& iterator : m_pages) m_fs->ReleasePage(iterator.second);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::Append
+//
+// Writes data to the end of the file, returns the new length of the file
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+//	written		- Receives the number of bytes written
+
+uapi::loff_t TempFileSystem::FileNode::Append(const void* buffer, uapi::size_t count, uapi::size_t* written)
+{
+	if(written == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	uapi::loff_t length;
+
+	// The length of the file is only known under the node lock, the checks for the offset
+	// and the data write must be performed as a single operation
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		*written = WriteData(m_length, buffer, count);
+		length = m_length;
+	}
+
+	if(*written) m_notify.Notify(LINUX_IN_MODIFY);
+	return length;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::getLength
+//
+// Gets the length of the file data
+
+uapi::loff_t TempFileSystem::FileNode::getLength(void) const
+{
+	sync::critical_section::scoped_lock critsec{ m_cs };
+	return m_length;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::Open
+//
+// Creates a Handle instance against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this node was resolved
+//	access		- Handle access mode
+//	flags		- Handle flags
+
+std::shared_ptr<FileSystem::Handle> TempFileSystem::FileNode::Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags)
+{
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	// If the file system was mounted as read-only, write access cannot be granted
+	if((mount->Flags & LINUX_MS_RDONLY) && (access != FileSystem::HandleAccess::ReadOnly)) throw LinuxException(LINUX_EROFS);
+
+	// O_APPEND requires write access to the file object
+	if((flags & FileSystem::HandleFlags::Append) && (access == FileSystem::HandleAccess::ReadOnly)) throw LinuxException(LINUX_EINVAL);
+
+	// Demand the permissions required for the requested access mode
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		if(access != FileSystem::HandleAccess::WriteOnly) FilePermission::Demand(FilePermission::Read, m_uid, m_gid, m_mode);
+		if(access != FileSystem::HandleAccess::ReadOnly) FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+	}
+
+	// O_TRUNC releases all of the data pages owned by the file
+	if((flags & FileSystem::HandleFlags::Truncate) && (access != FileSystem::HandleAccess::ReadOnly)) SetLength(0);
+
+	auto handle = std::make_shared<FileHandle>(shared_from_this(), access, flags);
+	UpdateAccessTime(mount);
+
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::OpenExec
+//
+// Creates an execute-only handle against this node
+//
+// Arguments:
+//
+//	mount		- Mount on which this node was resolved
+
+std::shared_ptr<FileSystem::Handle> TempFileSystem::FileNode::OpenExec(std::shared_ptr<FileSystem::Mount> mount) const
+{
+	_ASSERTE(std::dynamic_pointer_cast<class Mount>(mount));
+
+	// Verify that the mount point allows for execution of binary files
+	if(mount->Flags & LINUX_MS_NOEXEC) throw LinuxException(LINUX_ENOEXEC);
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+		FilePermission::Demand(FilePermission::Execute, m_uid, m_gid, m_mode);
+	}
+
+	return std::make_shared<FileHandle>(std::const_pointer_cast<FileNode>(shared_from_this()), FileSystem::HandleAccess::ReadOnly, FileSystem::HandleFlags::None);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::Read
+//
+// Reads data from the file
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the file to begin reading
+//	buffer		- Destination memory buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t TempFileSystem::FileNode::Read(uapi::loff_t offset, void* buffer, uapi::size_t count) const
+{
+	uint8_t*				dest = reinterpret_cast<uint8_t*>(buffer);		// Destination pointer
+	size_t const			pagesize = SystemInformation::PageSize;			// Size of each page
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+	if(offset < 0) throw LinuxException(LINUX_EINVAL);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// Reads that begin at or beyond the end of the file return zero bytes
+	if(offset >= m_length) return 0;
+	count = static_cast<uapi::size_t>(std::min(static_cast<uint64_t>(count), static_cast<uint64_t>(m_length - offset)));
+
+	uapi::size_t remaining = count;
+	while(remaining > 0) {
+
+		uint64_t page = static_cast<uint64_t>(offset) / pagesize;
+		size_t pageoffset = static_cast<size_t>(static_cast<uint64_t>(offset) % pagesize);
+		size_t length = std::min(pagesize - pageoffset, remaining);
+
+		// Pages that have never been written to are holes in a sparse file and read as zeros
+		auto found = m_pages.find(page);
+		if(found == m_pages.end()) memset(dest, 0, length);
+		else memcpy(dest, found->second + pageoffset, length);
+
+		dest += length;
+		offset += length;
+		remaining -= length;
+	}
+
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::SetLength
+//
+// Sets the length of the file, releasing any pages beyond the new end
+//
+// Arguments:
+//
+//	length		- New length of the file
+
+void TempFileSystem::FileNode::SetLength(uapi::loff_t length)
+{
+	size_t const			pagesize = SystemInformation::PageSize;			// Size of each page
+
+	if((length < 0) || (length > MAXIMUM_FILE_LENGTH)) throw LinuxException(LINUX_EINVAL);
+	if(m_fs->m_flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+
+		if(length < m_length) {
+
+			// Release every page that lies entirely beyond the new end of the file
+			uint64_t firstpage = align::up(static_cast<uint64_t>(length), pagesize) / pagesize;
+			for(auto iterator = m_pages.begin(); iterator != m_pages.end();) {
+
+				if(iterator->first >= firstpage) { m_fs->ReleasePage(iterator->second); iterator = m_pages.erase(iterator); }
+				else ++iterator;
+			}
+
+			// Zero the remainder of a partial last page so that extending the file again reads zeros
+			size_t pageoffset = static_cast<size_t>(static_cast<uint64_t>(length) % pagesize);
+			if(pageoffset) {
+
+				auto found = m_pages.find(static_cast<uint64_t>(length) / pagesize);
+				if(found != m_pages.end()) memset(found->second + pageoffset, 0, pagesize - pageoffset);
+			}
+		}
+
+		// Extending the length of the file does not allocate anything, the new range is a hole
+		m_length = length;
+		m_mtime = m_ctime = datetime::now();
+	}
+
+	m_notify.Notify(LINUX_IN_MODIFY);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::SetOwnership
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void TempFileSystem::FileNode::SetOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	ChangeOwnership(uid, gid);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::SetPermissions
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void TempFileSystem::FileNode::SetPermissions(uapi::mode_t permissions)
+{
+	ChangePermissions(permissions);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::Stat
+//
+// Provides statistical information about this node
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void TempFileSystem::FileNode::Stat(uapi::stat* stats) const
+{
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	StatNode(stats);
+	stats->st_nlink		= 1;
+	stats->st_size		= m_length;
+	stats->st_blocks	= (m_pages.size() * SystemInformation::PageSize) / 512;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::getType
+//
+// Gets the type of node represented by this object
+
+FileSystem::NodeType TempFileSystem::FileNode::getType(void) const
+{
+	return FileSystem::NodeType::File;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::Write
+//
+// Writes data into the file
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the file to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t TempFileSystem::FileNode::Write(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	uapi::size_t written;
+
+	if(offset < 0) throw LinuxException(LINUX_EINVAL);
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+		written = WriteData(offset, buffer, count);
+	}
+
+	if(written) m_notify.Notify(LINUX_IN_MODIFY);
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::FileNode::WriteData (private)
+//
+// Writes data into the file pages; the node lock must be held
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the file to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t TempFileSystem::FileNode::WriteData(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	const uint8_t*			source = reinterpret_cast<const uint8_t*>(buffer);		// Source pointer
+	size_t const			pagesize = SystemInformation::PageSize;					// Size of each page
+	uapi::size_t			written = 0;											// Bytes written
+
+	if(buffer == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	// Attempting to write to a read-only file system yields EROFS, not EACCES
+	if(m_fs->m_flags & LINUX_MS_RDONLY) throw LinuxException(LINUX_EROFS);
+
+	// The write cannot extend the file beyond the maximum length
+	if(static_cast<uint64_t>(count) > static_cast<uint64_t>(MAXIMUM_FILE_LENGTH - offset)) throw LinuxException(LINUX_EFBIG);
+
+	while(written < count) {
+
+		uint64_t pagenum = static_cast<uint64_t>(offset + written) / pagesize;
+		size_t pageoffset = static_cast<size_t>(static_cast<uint64_t>(offset + written) % pagesize);
+		size_t length = std::min(pagesize - pageoffset, count - written);
+
+		auto found = m_pages.find(pagenum);
+		uint8_t* page = (found != m_pages.end()) ? found->second : nullptr;
+
+		if(page == nullptr) {
+
+			// A new page is only zeroed if it won't be completely overwritten; if the file system is
+			// out of space after some of the data has been written, report a short write instead
+			try { page = m_fs->AllocatePage(length < pagesize); }
+			catch(LinuxException&) { if(written == 0) throw; break; }
+
+			try { m_pages.emplace(pagenum, page); }
+			catch(...) { m_fs->ReleasePage(page); throw; }
+		}
+
+		memcpy(page + pageoffset, source + written, length);
+		written += length;
+	}
+
+	// Extend the length of the file and update the modification time
+	if(written > 0) {
+
+		m_length = std::max(m_length, static_cast<uapi::loff_t>(offset + written));
+		m_mtime = m_ctime = datetime::now();
+	}
+
+	return written;
+}
+
+//
+// TEMPFILESYSTEM::MOUNT
+//
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Mount Constructor
+//
+// Arguments:
+//
+//	fs		- Reference to the TempFileSystem instance
+//	root	- Root directory node instance
+//	flags	- Per-mount flags and options to set on this mount instance
+
+TempFileSystem::Mount::Mount(std::shared_ptr<TempFileSystem> fs, std::shared_ptr<DirectoryNode> root, uint32_t flags) 
+	: m_fs(std::move(fs)), m_root(std::move(root)), m_flags(flags)
+{
+	// The flags should only contain bits from MS_PERMOUNT_MASK
+	_ASSERTE((m_flags & ~LINUX_MS_PERMOUNT_MASK) == 0);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Mount::Duplicate
+//
+// Duplicates this mount instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Mount> TempFileSystem::Mount::Duplicate(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	// Clone the underlying file system reference and flags into a new mount
+	return std::make_shared<Mount>(m_fs, root, m_flags);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Mount::getFlags
+//
+// Gets the flags set on this mount, includes file system flags
+
+uint32_t TempFileSystem::Mount::getFlags(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return m_flags | m_fs->m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Mount::Remount
+//
+// Remounts the file system with different options
+//
+// Arguments:
+//
+//	flags		- Standard mounting option flags
+//	data		- Extended/custom mounting options
+//	datalength	- Length of the extended mounting options data
+
+void TempFileSystem::Mount::Remount(uint32_t flags, const void* data, size_t datalen)
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	Capability::Demand(Capability::SystemAdmin);
+
+	// MS_REMOUNT must be specified in the flags when calling this function
+	if((flags & LINUX_MS_REMOUNT) != LINUX_MS_REMOUNT) throw LinuxException(LINUX_EINVAL);
+
+	// Parse the provided mounting options into remount flags and key/value pairs
+	MountOptions options(flags & LINUX_MS_RMT_MASK, data, datalen);
+
+	// Filter the flags to only those options which have changed from the current ones
+	uint32_t changedflags = (m_fs->m_flags & LINUX_MS_RMT_MASK) ^ options.Flags;
+
+	// Determine the maximum size of the memory available, used when scaling size/nodes to a percentage
+	uint64_t maxaccessible = std::min(SystemInformation::TotalPhysicalMemory, SystemInformation::TotalVirtualMemory);
+	size_t maxpages = static_cast<size_t>(std::min(maxaccessible, static_cast<uint64_t>(MAXSIZE_T))) / SystemInformation::PageSize;
+
+	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
+
+	// Start with the current limits, the new values are only applied if they are all valid
+	size_t pages = m_fs->m_maxpages;
+	size_t nodes = m_fs->m_maxnodes;
+
+	// size=
+	//
+	if(options.Arguments.Contains("size"))
+		pages = align::up(ParseScaledInteger(options.Arguments["size"], maxpages * SystemInformation::PageSize), SystemInformation::PageSize) / SystemInformation::PageSize;
+
+	// nr_blocks=
+	//
+	if(options.Arguments.Contains("nr_blocks")) pages = ParseScaledInteger(options.Arguments["nr_blocks"], maxpages);
+
+	// nr_inodes=
+	//
+	if(options.Arguments.Contains("nr_inodes")) nodes = ParseScaledInteger(options.Arguments["nr_inodes"], maxpages);
+
+	// The limits cannot be reduced below what is currently in use
+	if((pages < m_fs->m_pages) || (nodes < m_fs->m_nodes)) throw LinuxException(LINUX_EINVAL);
+
+	m_fs->m_maxpages = pages;
+	m_fs->m_maxnodes = nodes;
+
+	// MS_RDONLY
+	//
+	if(changedflags & LINUX_MS_RDONLY)
+		m_fs->m_flags = (m_fs->m_flags & ~LINUX_MS_RDONLY) | options[LINUX_MS_RDONLY];
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Mount::getRoot
+//
+// Gets a reference to the root directory of the mount point
+
+std::shared_ptr<FileSystem::Directory> TempFileSystem::Mount::getRoot(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return root;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Mount::getSource
+//
+// Gets the device/name used as the source of the file system
+
+std::string TempFileSystem::Mount::getSource(void) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	return std::string(m_fs->m_source);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Mount::Stat
+//
+// Provides statistical information about the mounted file system
+//
+// Arguments:
+//
+//	stats		- Structure to receieve the file system statistics
+
+void TempFileSystem::Mount::Stat(uapi::statfs* stats) const
+{
+	auto root = m_root;
+	if(!root) throw LinuxException(LINUX_ENODEV);
+
+	if(stats == nullptr) throw LinuxException(LINUX_EFAULT);
+
+	sync::critical_section::scoped_lock critsec{ m_fs->m_cs };
+
+	stats->f_type		= LINUX_TMPFS_MAGIC;
+	stats->f_bsize		= SystemInformation::PageSize;
+	stats->f_blocks		= m_fs->m_maxpages;
+	stats->f_bfree		= m_fs->m_maxpages - m_fs->m_pages;
+	stats->f_bavail		= m_fs->m_maxpages - m_fs->m_pages;
+	stats->f_files		= m_fs->m_maxnodes;
+	stats->f_ffree		= m_fs->m_maxnodes - m_fs->m_nodes;
+	stats->f_fsid		= m_fs->m_fsid;
+	stats->f_namelen	= LINUX_NAME_MAX;
+	stats->f_frsize		= SystemInformation::PageSize;
+	stats->f_flags		= m_flags | m_fs->m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::Mount::Unmount
+//
+// Unmounts the file system
+//
+// Arguments:
+//
+//	NONE
+
+void TempFileSystem::Mount::Unmount(void)
+{
+	// Ensure that the root directory node is not still shared out; handles opened against
+	// any node in the file system hold a reference to the file system, not the mount
+	if(m_root.use_count() > 1) throw LinuxException(LINUX_EBUSY);
+
+	m_root.reset();			// Release the root directory node
+}
+
+//
+// TEMPFILESYSTEM::NODEBASE
+//
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase Constructor
+//
+// Arguments:
+//
+//	fs			- Parent file system instance
+//	mode		- Type and permission flags to assign to the node
+//	uid			- User ID of the node owner
+//	gid			- Group ID of the node owner
+
+TempFileSystem::NodeBase::NodeBase(std::shared_ptr<TempFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid)
+	: m_fs(std::move(fs)), m_index(m_fs->AllocateNode()), m_ctime(datetime::now()), m_mtime(m_ctime), m_atime(m_ctime), m_mode(mode), 
+	m_uid(uid), m_gid(gid)
+{
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase Destructor
+
+TempFileSystem::NodeBase::~NodeBase()
+{
+	m_fs->ReleaseNode(m_index);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase::ChangeOwnership (protected)
+//
+// Changes the ownership of this node
+//
+// Arguments:
+//
+//	uid			- New ownership user identifier
+//	gid			- New ownership group identifier
+
+void TempFileSystem::NodeBase::ChangeOwnership(uapi::uid_t uid, uapi::gid_t gid)
+{
+	// todo: CAP_CHOWN - see chown(2), there is more to this
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+		FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+
+		m_uid = uid;
+		m_gid = gid;
+		m_ctime = datetime::now();
+	}
+
+	m_notify.Notify(LINUX_IN_ATTRIB);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase::ChangePermissions (protected)
+//
+// Changes the permission flags for this node
+//
+// Arguments:
+//
+//	permissions		- New permission flags for the node
+
+void TempFileSystem::NodeBase::ChangePermissions(uapi::mode_t permissions)
+{
+	permissions &= ~LINUX_S_IFMT;		// Strip off non-permissions
+
+	// todo: CAP_FSETID - see chmod(2), there is more to this
+	// todo: CAP_FOWNER - see chmod(2), there is more to this
+
+	{
+		sync::critical_section::scoped_lock critsec{ m_cs };
+		FilePermission::Demand(FilePermission::Write, m_uid, m_gid, m_mode);
+
+		m_mode = ((m_mode & LINUX_S_IFMT) | permissions);
+		m_ctime = datetime::now();
+	}
+
+	m_notify.Notify(LINUX_IN_ATTRIB);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase::getIndex
+//
+// Gets the index number assigned to this node
+
+intptr_t TempFileSystem::NodeBase::getIndex(void) const
+{
+	return m_index;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase::StatNode (protected)
+//
+// Provides the statistical information common to all node types; the node
+// lock must be held by the caller
+//
+// Arguments:
+//
+//	stats		- Structure to receive the node statistics
+
+void TempFileSystem::NodeBase::StatNode(uapi::stat* stats) const
+{
+	_ASSERTE(stats);
+
+	memset(stats, 0, sizeof(uapi::stat));
+
+	stats->st_dev		= (0 << 16) | 0;	// TODO: DEVICE ID; MAJOR WILL BE ZERO MINOR SHOULD AUTO-INCREMENT
+	stats->st_ino		= m_index;
+	stats->st_mode		= m_mode;
+	stats->st_uid		= m_uid;
+	stats->st_gid		= m_gid;
+	stats->st_rdev		= (0 << 16) | 0;
+	stats->st_blksize	= SystemInformation::PageSize;
+	stats->st_atime		= convert<uapi::timespec>(m_atime);
+	stats->st_mtime		= convert<uapi::timespec>(m_mtime);
+	stats->st_ctime		= convert<uapi::timespec>(m_ctime);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase::Unwatch
+//
+// Removes a previously registered watcher
+//
+// Arguments:
+//
+//	watcher		- Watcher to be removed
+
+void TempFileSystem::NodeBase::Unwatch(const FileSystem::NotifyWatcher* watcher)
+{
+	m_notify.Unwatch(watcher);
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase::UpdateAccessTime (protected)
+//
+// Updates the access time of the node
+//
+// Arguments:
+//
+//	mount		- Mount on which the node was reached
+
+void TempFileSystem::NodeBase::UpdateAccessTime(std::shared_ptr<FileSystem::Mount> mount)
+{
+	uint32_t flags = mount->Flags;
+
+	// Read-only file systems should not update the access time
+	if(flags & LINUX_MS_RDONLY) return;
+
+	datetime now = datetime::now();
+	sync::critical_section::scoped_lock critsec{ m_cs };
+
+	// MS_NOATIME and MS_NODIRATIME (for directories) are overridden by MS_STRICTATIME
+	if((flags & LINUX_MS_STRICTATIME) == 0) {
+
+		if(flags & LINUX_MS_NOATIME) return;
+		if((flags & LINUX_MS_NODIRATIME) && ((m_mode & LINUX_S_IFMT) == LINUX_S_IFDIR)) return;
+	}
+
+	// If MS_STRICTATIME is set, always update the last access time
+	if(flags & LINUX_MS_STRICTATIME) m_atime = now;
+
+	// MS_STRICTATIME is not set, only update if the previous atime is less than mtime, less than ctime,
+	// or indicates a value that is more than one day in the past
+	else if((m_atime < m_mtime) || (m_atime < m_ctime) || (m_atime < (now - timespan::days(1)))) m_atime = now;
+}
+
+//-----------------------------------------------------------------------------
+// TempFileSystem::NodeBase::Watch
+//
+// Registers a watcher to be notified when the node or a child of the node changes
+//
+// Arguments:
+//
+//	watcher		- Watcher to be registered
+
+void TempFileSystem::NodeBase::Watch(std::shared_ptr<FileSystem::NotifyWatcher> watcher)
+{
+	m_notify.Watch(std::move(watcher));
 }
 
 //-----------------------------------------------------------------------------
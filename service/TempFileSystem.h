@@ -24,87 +24,618 @@
 #define __TEMPFILESYSTEM_H_
 #pragma once
 
-#include <algorithm>
+#include <atomic>
+#include <map>
 #include <memory>
-#include "Capabilities.h"
+#include <unordered_map>
 #include "FileSystem.h"
 #include "IndexPool.h"
-#include "LinuxException.h"
-#include "MountOptions.h"
-#include "SystemInformation.h"
-#include "Win32Exception.h"
+#include "NotifyQueue.h"
 
 #pragma warning(push, 4)
 
 //-----------------------------------------------------------------------------
 // TempFileSystem
 //
-// words
+// TempFileSystem implements an in-memory file system, similar to tmpfs on Linux.
 //
 // Rather than using a virtual block device constructed on virtual memory, this
 // uses a private Windows heap to store the file system data.  There are a number
 // of challenges with the virtual block device method that can be easily overcome
 // by doing it this way; let the operating system do the heavy lifting
 //
-// Extended Mount Options (see mount(8) - "Mount options for tmpfs") 
+// Supported mount options:
 //
-//	size		=nnn[K|k|M|m|G|g|%] *
-//	nr_blocks	=nnn[K|k|M|m|G|g|%] *
-//	nr_inodes	=nnn[K|k|M|m|G|g|%] *
-//	mode		=nnn
-//	uid			=nnn
-//	gid			=nnn
+//	MS_KERNMOUNT
+//	MS_NOATIME
+//	MS_NODIRATIME
+//	MS_NODEV
+//	MS_NOEXEC
+//	MS_NOSUID
+//	MS_RDONLY
+//	MS_RELATIME
+//	MS_STRICTATIME
+//
+//	size=nnn[K|k|M|m|G|g|%]			- Sets the maximum size of the file system *
+//	nr_blocks=nnn[K|k|M|m|G|g|%]	- Sets the maximum size of the file system in pages *
+//	nr_inodes=nnn[K|k|M|m|G|g|%]	- Sets the maximum number of nodes *
+//	mode=nnn						- Sets the permissions of the root directory node
+//	uid=nnn							- Sets the owner user id of the root directory node
+//	gid=nnn							- Sets the owner group id of the root directory node
 //
 //  * - option may also be specified during a remount operation
+//
+// Supported remount options:
+//
+//	MS_RDONLY
+//
+// Notes:
+//
+//	- File data is stored in page-sized blocks that are carved out of larger slabs
+//	allocated from the private heap.  Blocks released by a file are kept on a free list
+//	and reused; the heap itself is only released when the file system is destroyed.
+//
+//	- Files are sparse, only the pages that have been written to are allocated.  Reading
+//	from a page that has never been written to yields zeros.
+//
+//	- The size limit applies to the number of allocated data pages, the node limit applies
+//	to the number of directory and file nodes.  Either limit being reached yields ENOSPC.
 
-class TempFileSystem //: public FileSystem
+class TempFileSystem
 {
 public:
 
+	// Instance Constructor
+	//
+	TempFileSystem(const char_t* source, uint32_t flags, size_t maxpages, size_t maxnodes);
+
 	// Destructor
 	//
 	~TempFileSystem();
 
+	//-------------------------------------------------------------------------
+	// Member Functions
+
 	// Mount (static)
 	//
 	// Creates an instance of the file system
 	static std::shared_ptr<FileSystem::Mount> Mount(const char_t* source, uint32_t flags, const void* data, size_t datalength);
 
-	// Stat
+private:
+
+	TempFileSystem(const TempFileSystem&)=delete;
+	TempFileSystem& operator=(const TempFileSystem&)=delete;
+
+	// Forward Declarations
 	//
-	// Provides statistical information about the file system
-	virtual void Stat(uapi::statfs* stats);
-		
-	//-------------------------------------------------------------------------
-	// Properties
+	class DirectoryNode;
+	class FileNode;
 
-	// MaximumNodes
+	// filepos_t
 	//
-	// Gets/sets the maximum number of nodes allowed in the file system
-	__declspec(property(get=getMaximumNodes, put=putMaximumNodes)) size_t MaximumNodes;
-	size_t getMaximumNodes(void) const;
-	void putMaximumNodes(size_t value);
+	// File position shared among duplicated FileHandle instances
+	struct filepos_t
+	{
+		uapi::loff_t				offset = 0;		// Current file position
+		sync::critical_section		cs;				// Synchronization object
+	};
 
-	// MaximumSize
+	// pagemap_t
 	//
-	// Gets/sets the maximum size of the file system
-	__declspec(property(get=getMaximumSize, put=putMaximumSize)) size_t MaximumSize;
-	size_t getMaximumSize(void) const;
-	void putMaximumSize(size_t value);
+	// Collection of allocated file data pages, keyed by page number
+	using pagemap_t = std::unordered_map<uint64_t, uint8_t*>;
 
-	// ReadOnly
-	// todo: this is dumb, make a SetFlags() or something instead otherwise
-	// you end up with 100 of these annoying things
+	// TempFileSystem::Alias
 	//
-	// Gets/sets the read-only attribute of the file system
-	__declspec(property(get=getReadOnly, put=putReadOnly)) bool ReadOnly;
-	bool getReadOnly(void) const;
-	void putReadOnly(bool value);
+	class Alias : public FileSystem::Alias
+	{
+	public:
 
-private:
+		// Instance Constructor
+		//
+		Alias(const char_t* name, std::shared_ptr<FileSystem::Node> node, intptr_t index);
 
-	TempFileSystem(const TempFileSystem&)=delete;
-	TempFileSystem& operator=(const TempFileSystem&)=delete;
+		// Destructor
+		//
+		~Alias()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Alias Implementation
+
+		// GetName
+		//
+		// Reads the name assigned to this alias
+		virtual uapi::size_t GetName(char_t* buffer, size_t count) const override;
+
+		// Name
+		//
+		// Gets the name assigned to this alias
+		virtual std::string getName(void) const override;
+
+		// Node
+		//
+		// Gets the node to which this alias refers
+		virtual std::shared_ptr<FileSystem::Node> getNode(void) const override;
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Index
+		//
+		// Gets the index number of the node to which this alias refers
+		__declspec(property(get=getIndex)) intptr_t Index;
+		intptr_t getIndex(void) const;
+
+	private:
+
+		Alias(const Alias&)=delete;
+		Alias& operator=(const Alias&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<FileSystem::Node>	m_node;		// Node instance
+		const intptr_t							m_index;	// Node index number
+		const std::string						m_name;		// Alias name to report
+	};
+
+	// namemap_t
+	//
+	// Collection of directory entries, keyed by name
+	using namemap_t = std::unordered_map<std::string, std::shared_ptr<Alias>>;
+
+	// entrymap_t
+	//
+	// Collection of directory entries, keyed by the enumeration cookie assigned when the
+	// entry was created.  Pointers to namemap_t elements remain valid across a rehash
+	using entrymap_t = std::map<uapi::loff_t, namemap_t::value_type const*>;
+
+	// TempFileSystem::NodeBase
+	//
+	class NodeBase : public FileSystem::Watchable
+	{
+	public:
+
+		// Instance Constructor
+		//
+		NodeBase(std::shared_ptr<TempFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid);
+
+		// Destructor
+		//
+		virtual ~NodeBase();
+
+		//---------------------------------------------------------------------
+		// FileSystem::Watchable Implementation
+
+		// Unwatch
+		//
+		// Removes a previously registered watcher
+		virtual void Unwatch(const FileSystem::NotifyWatcher* watcher) override;
+
+		// Watch
+		//
+		// Registers a watcher to be notified when the node or a child of the node changes
+		virtual void Watch(std::shared_ptr<FileSystem::NotifyWatcher> watcher) override;
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Index
+		//
+		// Gets the index number assigned to this node
+		__declspec(property(get=getIndex)) intptr_t Index;
+		intptr_t getIndex(void) const;
+
+	protected:
+
+		//---------------------------------------------------------------------
+		// Protected Member Functions
+
+		// ChangeOwnership
+		//
+		// Changes the ownership of this node
+		void ChangeOwnership(uapi::uid_t uid, uapi::gid_t gid);
+
+		// ChangePermissions
+		//
+		// Changes the permission flags for this node
+		void ChangePermissions(uapi::mode_t permissions);
+
+		// StatNode
+		//
+		// Provides the statistical information common to all node types
+		void StatNode(uapi::stat* stats) const;
+
+		// UpdateAccessTime
+		//
+		// Updates the access time value of the node
+		void UpdateAccessTime(std::shared_ptr<FileSystem::Mount> mount);
+
+		//---------------------------------------------------------------------
+		// Protected Member Variables
+
+		const std::shared_ptr<TempFileSystem>	m_fs;		// Parent file system instance
+		const intptr_t							m_index;	// Node index number
+		datetime								m_ctime;	// Change timestamp
+		datetime								m_mtime;	// Modification timestamp
+		datetime								m_atime;	// Access timestamp
+		uapi::mode_t							m_mode;		// Permission/mode flags
+		uapi::uid_t								m_uid;		// Node UID
+		uapi::gid_t								m_gid;		// Node GID
+		NotifyQueue								m_notify;	// Registered change watchers
+		mutable sync::critical_section			m_cs;		// Synchronization object
+
+	private:
+
+		NodeBase(const NodeBase&)=delete;
+		NodeBase& operator=(const NodeBase&)=delete;
+	};
+
+	// TempFileSystem::DirectoryHandle
+	//
+	class DirectoryHandle : public FileSystem::Handle
+	{
+	public:
+
+		// Instance Constructor
+		//
+		DirectoryHandle(std::shared_ptr<DirectoryNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+
+		// Destructor
+		//
+		~DirectoryHandle()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Handle Implementation
+
+		// Duplicate
+		//
+		// Creates a duplicate Handle instance
+		virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+		// Read
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+		// ReadAt
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+		// Seek
+		//
+		// Changes the file position
+		virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+		// Sync
+		//
+		// Synchronizes all metadata and data associated with the file to storage
+		virtual void Sync(void) const override;
+
+		// SyncData
+		//
+		// Synchronizes all data associated with the file to storage, not metadata
+		virtual void SyncData(void) const override;
+
+		// Write
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+		// WriteAt
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+		// getAccess
+		//
+		// Gets the handle access mode
+		virtual FileSystem::HandleAccess getAccess(void) const override;
+
+		// getFlags
+		//
+		// Gets the handle flags
+		virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	private:
+
+		DirectoryHandle(const DirectoryHandle&)=delete;
+		DirectoryHandle& operator=(const DirectoryHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<DirectoryNode>	m_node;			// Directory node instance
+		const FileSystem::HandleAccess			m_access;		// Handle access mode
+		const FileSystem::HandleFlags			m_flags;		// Handle flags
+		uapi::loff_t							m_position;		// Current directory position
+		mutable sync::critical_section			m_cs;			// Synchronization object
+	};
+
+	// TempFileSystem::DirectoryNode
+	//
+	class DirectoryNode : public NodeBase, public FileSystem::Directory, public std::enable_shared_from_this<DirectoryNode>
+	{
+	public:
+
+		// Instance Constructor
+		//
+		DirectoryNode(std::shared_ptr<TempFileSystem> fs, intptr_t parent, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid);
+
+		// Destructor
+		//
+		virtual ~DirectoryNode()=default;
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// ReadDirectory
+		//
+		// Reads entries from the directory as packed linux_dirent64 structures
+		uapi::size_t ReadDirectory(uapi::loff_t& position, void* buffer, uapi::size_t count) const;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a Handle instance against this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about the node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// getType
+		//
+		// Gets the type of node being represented in the derived object instance
+		virtual FileSystem::NodeType getType(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Directory Implementation
+
+		// CreateDirectory
+		//
+		// Creates a new directory node as a child of this directory
+		virtual std::shared_ptr<FileSystem::Alias> CreateDirectory(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+
+		// CreateFile
+		//
+		// Creates a new regular file node as a child of this directory
+		virtual std::shared_ptr<FileSystem::Alias> CreateFile(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, uapi::mode_t mode) override;
+
+		// Lookup
+		//
+		// Looks up the alias associated with a child of this node
+		virtual FileSystem::Result<std::shared_ptr<FileSystem::Alias>> Lookup(std::shared_ptr<FileSystem::Mount> mount, const char_t* name) const override;
+
+	private:
+
+		DirectoryNode(const DirectoryNode&)=delete;
+		DirectoryNode& operator=(const DirectoryNode&)=delete;
+
+		//---------------------------------------------------------------------
+		// Private Member Functions
+
+		// CreateNode
+		//
+		// Creates a new child node and inserts it into the directory
+		std::shared_ptr<FileSystem::Alias> CreateNode(std::shared_ptr<FileSystem::Mount> mount, const char_t* name, FileSystem::NodeType type, uapi::mode_t mode);
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const intptr_t				m_parent;		// Parent directory index number
+		namemap_t					m_names;		// Child entries, by name
+		entrymap_t					m_entries;		// Child entries, by cookie
+		uapi::loff_t				m_nextcookie;	// Next enumeration cookie
+		size_t						m_subdirs;		// Number of child directories
+	};
+
+	// TempFileSystem::FileHandle
+	//
+	class FileHandle : public FileSystem::Handle
+	{
+	public:
+
+		// Instance Constructor
+		//
+		FileHandle(std::shared_ptr<FileNode> node, FileSystem::HandleAccess access, FileSystem::HandleFlags flags);
+
+		// Destructor
+		//
+		~FileHandle()=default;
+
+		//---------------------------------------------------------------------
+		// FileSystem::Handle Implementation
+
+		// Duplicate
+		//
+		// Creates a duplicate Handle instance
+		virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+		// Read
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+		// ReadAt
+		//
+		// Synchronously reads data from the underlying node into a buffer
+		virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+		// ReadDirectory
+		//
+		// Reads entries from the underlying directory node as packed linux_dirent64 structures
+		virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+		// Seek
+		//
+		// Changes the file position
+		virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+		// Sync
+		//
+		// Synchronizes all metadata and data associated with the file to storage
+		virtual void Sync(void) const override;
+
+		// SyncData
+		//
+		// Synchronizes all data associated with the file to storage, not metadata
+		virtual void SyncData(void) const override;
+
+		// Write
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+		// WriteAt
+		//
+		// Synchronously writes data from a buffer to the underlying node
+		virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+		// getAccess
+		//
+		// Gets the handle access mode
+		virtual FileSystem::HandleAccess getAccess(void) const override;
+
+		// getFlags
+		//
+		// Gets the handle flags
+		virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	private:
+
+		FileHandle(const FileHandle&)=delete;
+		FileHandle& operator=(const FileHandle&)=delete;
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		const std::shared_ptr<FileNode>			m_node;			// File node instance
+		const FileSystem::HandleAccess			m_access;		// Handle access mode
+		const FileSystem::HandleFlags			m_flags;		// Handle flags
+		std::shared_ptr<filepos_t>				m_position;		// File position
+	};
+
+	// TempFileSystem::FileNode
+	//
+	class FileNode : public NodeBase, public FileSystem::File, public std::enable_shared_from_this<FileNode>
+	{
+	public:
+
+		// Instance Constructor
+		//
+		FileNode(std::shared_ptr<TempFileSystem> fs, uapi::mode_t mode, uapi::uid_t uid, uapi::gid_t gid);
+
+		// Destructor
+		//
+		virtual ~FileNode();
+
+		//---------------------------------------------------------------------
+		// Member Functions
+
+		// Append
+		//
+		// Writes data to the end of the file, returns the new length of the file
+		uapi::loff_t Append(const void* buffer, uapi::size_t count, uapi::size_t* written);
+
+		// Read
+		//
+		// Reads data from the file
+		uapi::size_t Read(uapi::loff_t offset, void* buffer, uapi::size_t count) const;
+
+		// SetLength
+		//
+		// Sets the length of the file, releasing any pages beyond the new end
+		void SetLength(uapi::loff_t length);
+
+		// Write
+		//
+		// Writes data into the file
+		uapi::size_t Write(uapi::loff_t offset, const void* buffer, uapi::size_t count);
+
+		//---------------------------------------------------------------------
+		// FileSystem::Node Implementation
+
+		// Open
+		//
+		// Creates a Handle instance against this node
+		virtual std::shared_ptr<FileSystem::Handle> Open(std::shared_ptr<FileSystem::Mount> mount, FileSystem::HandleAccess access, FileSystem::HandleFlags flags) override;
+
+		// SetOwnership
+		//
+		// Changes the ownership of this node
+		virtual void SetOwnership(uapi::uid_t uid, uapi::gid_t gid) override;
+
+		// SetPermissions
+		//
+		// Changes the permission flags for this node
+		virtual void SetPermissions(uapi::mode_t permissions) override;
+
+		// Stat
+		//
+		// Provides statistical information about the node
+		virtual void Stat(uapi::stat* stats) const override;
+
+		// getType
+		//
+		// Gets the type of node being represented in the derived object instance
+		virtual FileSystem::NodeType getType(void) const override;
+
+		//---------------------------------------------------------------------
+		// FileSystem::File Implementation
+
+		// OpenExec
+		//
+		// Creates an execute-only handle against this node
+		virtual std::shared_ptr<FileSystem::Handle> OpenExec(std::shared_ptr<FileSystem::Mount> mount) const override;
+
+		//---------------------------------------------------------------------
+		// Properties
+
+		// Length
+		//
+		// Gets the length of the file data
+		__declspec(property(get=getLength)) uapi::loff_t Length;
+		uapi::loff_t getLength(void) const;
+
+	private:
+
+		FileNode(const FileNode&)=delete;
+		FileNode& operator=(const FileNode&)=delete;
+
+		//---------------------------------------------------------------------
+		// Private Member Functions
+
+		// WriteData
+		//
+		// Writes data into the file pages; the node lock must be held
+		uapi::size_t WriteData(uapi::loff_t offset, const void* buffer, uapi::size_t count);
+
+		//---------------------------------------------------------------------
+		// Member Variables
+
+		pagemap_t					m_pages;		// Allocated data pages
+		uapi::loff_t				m_length;		// Length of the file data
+	};
 
 	// TempFileSystem::Mount
 	//
@@ -112,82 +643,111 @@ private:
 	{
 	public:
 
+		// Instance Constructor
+		//
+		Mount(std::shared_ptr<TempFileSystem> fs, std::shared_ptr<DirectoryNode> root, uint32_t flags);
+
 		// Destructor
 		//
 		~Mount()=default;
 
-		// Create (static)
-		//
-		// Creates a Mount instance
-		static std::shared_ptr<Mount> Create(const std::shared_ptr<TempFileSystem>& fs, uint32_t flags);
+		//---------------------------------------------------------------------
+		// FileSystem::Mount Implementation
 
-		// Duplicate (FileSystem::Mount)
+		// Duplicate
 		//
 		// Duplicates this mount instance
-		virtual std::shared_ptr<FileSystem::Mount> Duplicate(void);
+		virtual std::shared_ptr<FileSystem::Mount> Duplicate(void) const override;
 
-		// Remount (FileSystem::Mount)
+		// Remount
 		//
 		// Remounts this mount point with different flags and arguments
-		virtual void Remount(uint32_t flags, const void* data, size_t datalen);
+		virtual void Remount(uint32_t flags, const void* data, size_t datalen) override;
 
-		// Stat (FileSystem::Mount)
+		// Stat
 		//
 		// Provides statistical information about the mounted file system
-		virtual void Stat(uapi::statfs* stats);
+		virtual void Stat(uapi::statfs* stats) const override;
+
+		// Unmount
+		//
+		// Unmounts the file system
+		virtual void Unmount(void) override;
 
-		// getFlags (FileSystem::Mount)
+		// getFlags
 		//
-		// Gets the flags set on this mount
-		virtual uint32_t getFlags(void);
+		// Gets the flags set on this mount, includes file system flags
+		virtual uint32_t getFlags(void) const override;
 
-		virtual std::shared_ptr<FileSystem::Node> getRoot(void) { return nullptr; } // todo - move to CPP
+		// getRoot
+		//
+		// Gets a reference to the root directory of the mount point
+		virtual std::shared_ptr<FileSystem::Directory> getRoot(void) const override;
 
-		virtual const char_t* getSource(void) { return nullptr; }
+		// getSource
+		//
+		// Gets the device/name used as the source of the mount point
+		virtual std::string getSource(void) const override;
 
 	private:
 
 		Mount(const Mount&)=delete;
 		Mount& operator=(const Mount&)=delete;
 
-		// Instance Constructor
-		//
-		Mount(const std::shared_ptr<TempFileSystem>& fs, uint32_t flags);
-		friend class std::_Ref_count_obj<Mount>;
-
+		//---------------------------------------------------------------------
 		// Member Variables
-		//
+
 		const std::shared_ptr<TempFileSystem>	m_fs;		// File system instance
-		uint32_t								m_flags;	// Mounting flags
+		const uint32_t							m_flags;	// Mounting flags
+		std::shared_ptr<DirectoryNode>			m_root;		// The root directory node
 	};
 
-	// Instance Constructor
-	//
-	TempFileSystem(const char_t* source, size_t maxsize, size_t maxnodes);
-	friend class std::_Ref_count_obj<TempFileSystem>;
-
 	//-------------------------------------------------------------------------
 	// Private Member Functions
 
+	// AllocateNode
+	//
+	// Allocates a node index number, enforcing the maximum number of nodes
+	intptr_t AllocateNode(void);
+
+	// AllocatePage
+	//
+	// Allocates a file data page, enforcing the maximum size of the file system
+	uint8_t* AllocatePage(bool zero);
+
 	// ParseScaledInteger (static)
 	//
 	// Parses a scaled integer mounting option (size, nr_blocks, nr_inodes)
 	static size_t ParseScaledInteger(const std::string& value, size_t maximum);
 
+	// ReleaseNode
+	//
+	// Releases a node index number
+	void ReleaseNode(intptr_t index);
+
+	// ReleasePage
+	//
+	// Releases a file data page
+	void ReleasePage(uint8_t* page);
+
 	//-------------------------------------------------------------------------
 	// Member Variables
 
-	const std::string			m_source;			// Source device string
-	HANDLE						m_heap;				// Private heap handle
-	size_t						m_size;				// Current file system size
-	size_t						m_maxsize;			// Maximum file system size
-	size_t						m_nodes;			// Current number of nodes
-	size_t						m_maxnodes;			// Maximum number of nodes
-	IndexPool<intptr_t>			m_indexpool;		// Pool of node index numbers
+	const std::string				m_source;		// Source device string
+	std::atomic<uint32_t>			m_flags;		// File system flags
+	const uapi::fsid_t				m_fsid;			// File system unique identifier
+	HANDLE							m_heap;			// Private heap handle
+	uint8_t*						m_freepages;	// Released page list
+	size_t							m_pages;		// Allocated page count
+	size_t							m_maxpages;		// Maximum page count
+	size_t							m_nodes;		// Allocated node count
+	size_t							m_maxnodes;		// Maximum node count
+	IndexPool<intptr_t>				m_indexpool;	// Pool of node index numbers
+	mutable sync::critical_section	m_cs;			// Synchronization object
 };
 
 //-----------------------------------------------------------------------------
 
 #pragma warning(pop)
 
-#endif	// __TEMPFILESYSTEM_H_
\ No newline at end of file
+#endif	// __TEMPFILESYSTEM_H_
@@ -23,8 +23,11 @@
 #include "stdafx.h"
 #include "Thread.h"
 
+#include "NativeThread.h"
 #include "Pid.h"
 #include "Process.h"
+#include "SignalActions.h"
+#include "SignalState.h"
 
 #pragma warning(push, 4)
 
@@ -33,10 +36,13 @@
 //
 // Arguments:
 //
-//	tid		- Thread identifier to assign to the thread
-//	process	- Parent Process instance
+//	tid				- Thread identifier to assign to the thread
+//	process			- Parent Process instance
+//	nativethread	- NativeThread instance to take ownership of
+//	sigstate		- SignalState instance to take ownership of
 
-Thread::Thread(pid_t tid, process_t process) : m_tid(std::move(tid)), m_process(std::move(process))
+Thread::Thread(pid_t tid, process_t process, nativethread_t nativethread, sigstate_t sigstate) : m_tid(std::move(tid)), m_process(std::move(process)),
+	m_nativethread(std::move(nativethread)), m_sigstate(std::move(sigstate))
 {
 }
 
@@ -55,20 +61,68 @@ Thread::~Thread()
 //
 // Arguments:
 //
-//	tid			- Thread identifier to assign to the thread
-//	process		- Process that the thread will become a member of
+//	tid				- Thread identifier to assign to the thread
+//	process			- Process that the thread will become a member of
+//	nativethread	- NativeThread instance to take ownership of
+//	sigstate		- SignalState instance allocated in the native process
 
-std::shared_ptr<Thread> Thread::Create(std::shared_ptr<Pid> tid, std::shared_ptr<class Process> process)
+std::shared_ptr<Thread> Thread::Create(std::shared_ptr<Pid> tid, std::shared_ptr<class Process> process, std::unique_ptr<NativeThread> nativethread,
+	std::unique_ptr<SignalState> sigstate)
 {
 	// Create the Thread instance
-	auto thread = std::make_shared<Thread>(std::move(tid), process);
+	auto thread = std::make_shared<Thread>(std::move(tid), process, std::move(nativethread), std::move(sigstate));
 
 	// The parent container link has to be established after the shared_ptr has been constructed
 	AddProcessThread(process, thread);
+	thread->m_tid->AttachThread(thread);
 
 	return thread;
 }
 
+//-----------------------------------------------------------------------------
+// Thread::getBlockedSignals
+//
+// Gets the set of signals currently blocked by this thread
+
+uapi::sigset_t Thread::getBlockedSignals(void) const
+{
+	return (m_sigstate) ? m_sigstate->Blocked : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Thread::DequeueSignal
+//
+// Dequeues the next deliverable signal and the action to take for it
+//
+// Arguments:
+//
+//	blocked		- Blocked signal mask provided by the host
+//	siginfo		- Receives the dequeued signal information
+//	action		- Receives the action to take for the dequeued signal
+
+int Thread::DequeueSignal(uapi::sigset_t blocked, uapi::siginfo* siginfo, uapi::sigaction* action)
+{
+	uapi::sigaction			defaction;			// Default signal action
+
+	if(!m_sigstate) return 0;
+
+	int signal = m_sigstate->Dequeue(blocked, siginfo);
+	if(signal == 0) return 0;
+
+	auto actions = m_process->SignalActions;
+	*action = actions->Get(signal);
+
+	// SA_RESETHAND restores the default action once the handler has been invoked
+	if((action->sa_handler != LINUX_SIG_DFL) && (action->sa_handler != LINUX_SIG_IGN) && (action->sa_flags & LINUX_SA_RESETHAND)) {
+
+		memset(&defaction, 0, sizeof(uapi::sigaction));
+		defaction.sa_handler = LINUX_SIG_DFL;
+		actions->Set(signal, defaction);
+	}
+
+	return signal;
+}
+
 //-----------------------------------------------------------------------------
 // Thread::getProcess
 //
@@ -79,6 +133,28 @@ std::shared_ptr<class Process> Thread::getProcess(void) const
 	return m_process;
 }
 
+//-----------------------------------------------------------------------------
+// Thread::Signal
+//
+// Sends a signal to this thread
+//
+// Arguments:
+//
+//	siginfo		- Signal information
+
+void Thread::Signal(uapi::siginfo const& siginfo)
+{
+	// Threads without a shared signal state cannot receive signals
+	if(!m_sigstate) return;
+
+	// Signals that would be ignored are discarded as they're generated unless
+	// they are currently blocked, in which case the action may change first
+	if(((m_sigstate->Blocked & uapi::sigmask(siginfo.si_signo)) == 0) && m_process->SignalActions->IsIgnored(siginfo.si_signo)) return;
+
+	// Queue the signal and interrupt the native thread if it can be delivered now
+	if(m_sigstate->Queue(siginfo)) m_sigstate->Interrupt(*m_nativethread, m_process->SignalEntryPoint);
+}
+
 //-----------------------------------------------------------------------------
 // Thread::getThreadId
 //
@@ -30,8 +30,10 @@
 
 // Forward Declarations
 //
+class NativeThread;
 class Pid;
 class Process;
+class SignalState;
 
 //-----------------------------------------------------------------------------
 // Thread
@@ -52,11 +54,28 @@ public:
 	// Create (static)
 	//
 	// Creates a new Thread instance
-	static std::shared_ptr<Thread> Create(std::shared_ptr<Pid> tid, std::shared_ptr<class Process> process);
+	static std::shared_ptr<Thread> Create(std::shared_ptr<Pid> tid, std::shared_ptr<class Process> process, std::unique_ptr<NativeThread> nativethread,
+		std::unique_ptr<SignalState> sigstate);
+
+	// DequeueSignal
+	//
+	// Dequeues the next deliverable signal and the action to take for it
+	int DequeueSignal(uapi::sigset_t blocked, uapi::siginfo* siginfo, uapi::sigaction* action);
+
+	// Signal
+	//
+	// Sends a signal to this thread
+	void Signal(uapi::siginfo const& siginfo);
 
 	//-------------------------------------------------------------------------
 	// Properties
 
+	// BlockedSignals
+	//
+	// Gets the set of signals currently blocked by this thread
+	__declspec(property(get=getBlockedSignals)) uapi::sigset_t BlockedSignals;
+	uapi::sigset_t getBlockedSignals(void) const;
+
 	// Process
 	//
 	// Gets a reference to the parent process instance
@@ -74,6 +93,11 @@ private:
 	Thread(Thread const&)=delete;
 	Thread& operator=(Thread const&)=delete;
 
+	// nativethread_t
+	//
+	// NativeThread unique pointer
+	using nativethread_t = std::unique_ptr<NativeThread>;
+
 	// pid_t
 	//
 	// Pid shared pointer
@@ -84,9 +108,14 @@ private:
 	// Process shared pointer
 	using process_t = std::shared_ptr<class Process>;
 
+	// sigstate_t
+	//
+	// SignalState unique pointer
+	using sigstate_t = std::unique_ptr<SignalState>;
+
 	// Instance Constructor
 	//
-	Thread(pid_t tid, process_t process);
+	Thread(pid_t tid, process_t process, nativethread_t nativethread, sigstate_t sigstate);
 	friend class std::_Ref_count_obj<Thread>;
 
 	//-------------------------------------------------------------------------
@@ -94,6 +123,8 @@ private:
 
 	pid_t const					m_tid;			// Thread identifier
 	process_t const 			m_process;		// Parent process instance
+	nativethread_t const		m_nativethread;	// NativeThread instance
+	sigstate_t const			m_sigstate;		// Signal state
 };
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,1106 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "UnixSocket.h"
+
+#include "LinuxException.h"
+
+#pragma warning(push, 4)
+
+// UnixSocket::DatagramCapacity (static)
+//
+// Maximum number of datagram bytes that can be queued on a receiving socket
+const size_t UnixSocket::DatagramCapacity = (208 KiB);
+
+// UnixSocket::StreamCapacity (static)
+//
+// Capacity of each direction of a stream connection, in bytes
+const size_t UnixSocket::StreamCapacity = (256 KiB);
+
+// UnixSocket::s_autobind (static)
+//
+// Next autobind name to be assigned
+uint32_t UnixSocket::s_autobind = 0;
+
+// UnixSocket::s_names (static)
+//
+// Table of bound socket names
+std::unordered_map<std::string, std::weak_ptr<UnixSocket>> UnixSocket::s_names;
+
+// UnixSocket::s_namescs (static)
+//
+// Synchronizes access to the table of bound socket names
+sync::critical_section UnixSocket::s_namescs;
+
+// AUTOBIND_NAMES
+//
+// Number of unique names available for autobind, see unix_autobind()
+static const uint32_t AUTOBIND_NAMES = 0x100000;
+
+//-----------------------------------------------------------------------------
+// UnixSocket Constructor
+//
+// Arguments:
+//
+//	type		- Socket type (SOCK_STREAM or SOCK_DGRAM)
+//	flags		- Handle flags
+//	credentials	- Credentials of the creating process
+
+UnixSocket::UnixSocket(int type, FileSystem::HandleFlags flags, const uapi::ucred& credentials) : m_type(type), m_flags(flags), 
+	m_credentials(credentials), m_peercred{ 0, static_cast<uapi::uid_t>(-1), static_cast<uapi::gid_t>(-1) }, m_state(state_t::Unconnected), 
+	m_shutread(false), m_shutwrite(false), m_backlogmax(0), m_queued(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket Destructor
+
+UnixSocket::~UnixSocket()
+{
+	// Release the name assigned to this socket, unless it has already been taken over
+	if(!m_name.empty()) {
+
+		sync::critical_section::scoped_lock critsec{ s_namescs };
+
+		auto found = s_names.find(m_name);
+		if((found != s_names.end()) && (found->second.expired())) s_names.erase(found);
+	}
+
+	// Release this socket's ends of a stream connection, the peer will see end-of-file/EPIPE
+	if(m_inbound && !m_shutread) m_inbound->buffer.ReleaseReader();
+	if(m_outbound && !m_shutwrite) m_outbound->buffer.ReleaseWriter();
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Accept
+//
+// Accepts a pending connection from a listening socket
+//
+// Arguments:
+//
+//	flags		- Handle flags to assign to the accepted socket
+
+std::shared_ptr<UnixSocket> UnixSocket::Accept(FileSystem::HandleFlags flags)
+{
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	if(m_type != LINUX_SOCK_STREAM) throw LinuxException(LINUX_EOPNOTSUPP);
+	if(m_state != state_t::Listening) throw LinuxException(LINUX_EINVAL);
+
+	// Wait for a connection to be queued unless the socket is non-blocking
+	// todo: the wait needs to be interruptible by signals (EINTR)
+	while(m_backlog.empty()) {
+
+		if(m_flags & FileSystem::HandleFlags::NonBlocking) throw LinuxException(LINUX_EAGAIN);
+		m_signal.wait(critsec);
+
+		if(m_state != state_t::Listening) throw LinuxException(LINUX_EINVAL);
+	}
+
+	auto connection = std::move(m_backlog.front());
+	m_backlog.pop_front();
+
+	// Wake any connecting sockets that were waiting for space in the backlog
+	m_signal.notify_all();
+
+	// The accepted socket has not been exposed to anything yet, the flags can be set directly
+	connection->m_flags = flags;
+	return connection;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::getAccess
+//
+// Gets the handle access mode
+
+FileSystem::HandleAccess UnixSocket::getAccess(void) const
+{
+	return FileSystem::HandleAccess::ReadWrite;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::AttachChannels (private)
+//
+// Attaches a connected socket to the channels of a stream connection
+//
+// Arguments:
+//
+//	inbound		- Channel from which this socket receives data
+//	outbound	- Channel into which this socket sends data
+
+void UnixSocket::AttachChannels(std::shared_ptr<channel_t> inbound, std::shared_ptr<channel_t> outbound)
+{
+	_ASSERTE(inbound && outbound);
+
+	inbound->buffer.AddReader();
+	outbound->buffer.AddWriter();
+
+	// Readiness changes of either channel are relayed to this socket's waiters
+	inbound->buffer.Subscribe(shared_from_this());
+	outbound->buffer.Subscribe(shared_from_this());
+
+	m_inbound = std::move(inbound);
+	m_outbound = std::move(outbound);
+	m_state = state_t::Connected;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Bind
+//
+// Assigns a name to the socket; an empty address requests an autobind
+//
+// Arguments:
+//
+//	address		- Address to assign to the socket
+//	length		- Length of the address structure
+
+void UnixSocket::Bind(const uapi::sockaddr_un* address, size_t length)
+{
+	std::string name = ImportName(address, length);
+
+	std::unique_lock<std::mutex> critsec{ m_lock };
+	if(!m_name.empty()) throw LinuxException(LINUX_EINVAL);
+
+	sync::critical_section::scoped_lock namescs{ s_namescs };
+
+	// An empty name requests an autobind, which assigns an unused abstract name of five hex digits
+	if(name.empty()) {
+
+		for(uint32_t attempt = 0; name.empty(); attempt++) {
+
+			if(attempt == AUTOBIND_NAMES) throw LinuxException(LINUX_ENOSPC);
+
+			char autoname[8];
+			sprintf_s(autoname, std::extent<decltype(autoname)>::value, "%05x", (s_autobind++ % AUTOBIND_NAMES));
+
+			std::string candidate = std::string(1, '\0') + autoname;
+			auto found = s_names.find(candidate);
+			if((found == s_names.end()) || (found->second.expired())) name = std::move(candidate);
+		}
+	}
+
+	// The name cannot already be bound to a socket that still exists
+	auto found = s_names.find(name);
+	if((found != s_names.end()) && (!found->second.expired())) throw LinuxException(LINUX_EADDRINUSE);
+
+	s_names[name] = shared_from_this();
+	m_name = std::move(name);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Connect
+//
+// Connects the socket to a named socket
+//
+// Arguments:
+//
+//	address		- Address of the target socket
+//	length		- Length of the address structure
+
+void UnixSocket::Connect(const uapi::sockaddr_un* address, size_t length)
+{
+	std::string name = ImportName(address, length);
+	if(name.empty()) throw LinuxException(LINUX_EINVAL);
+
+	auto target = Lookup(name);
+	if(!target) throw LinuxException(LINUX_ECONNREFUSED);
+	if(target->m_type != m_type) throw LinuxException(LINUX_EPROTOTYPE);
+
+	// Datagram sockets only record the default destination of the peer
+	if(m_type == LINUX_SOCK_DGRAM) {
+
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		m_peer = target;
+		m_peername = std::move(name);
+		m_peercred = target->m_credentials;
+		return;
+	}
+
+	// A stream connection is a pair of channels, one for each direction
+	auto tx = std::make_shared<channel_t>();
+	auto rx = std::make_shared<channel_t>();
+
+	// The socket that will be returned from the target's Accept() is created now
+	auto connection = std::make_shared<UnixSocket>(m_type, FileSystem::HandleFlags::None, target->m_credentials);
+	connection->AttachChannels(tx, rx);
+	connection->m_name = target->m_name;
+	connection->m_peercred = m_credentials;
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		if(m_state == state_t::Connected) throw LinuxException(LINUX_EISCONN);
+		if(m_state == state_t::Listening) throw LinuxException(LINUX_EINVAL);
+
+		connection->m_peername = m_name;
+		AttachChannels(rx, tx);
+		m_peername = name;
+		m_peercred = target->m_credentials;
+	}
+
+	// Queue the connection on the target, if that fails this socket reverts to being unconnected
+	try { target->QueueConnection(std::move(connection), (m_flags & FileSystem::HandleFlags::NonBlocking) ? true : false); }
+
+	catch(...) {
+
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		m_inbound->buffer.Unsubscribe(this);
+		m_outbound->buffer.Unsubscribe(this);
+		m_inbound->buffer.ReleaseReader();
+		m_outbound->buffer.ReleaseWriter();
+		m_inbound.reset();
+		m_outbound.reset();
+		m_peername.clear();
+		m_state = state_t::Unconnected;
+		throw;
+	}
+
+	m_pollqueue.Notify(LINUX_POLLOUT | LINUX_POLLWRNORM);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Create (static)
+//
+// Creates a new unconnected socket
+//
+// Arguments:
+//
+//	type		- Socket type (SOCK_STREAM or SOCK_DGRAM)
+//	flags		- Handle flags
+//	credentials	- Credentials of the creating process
+
+std::shared_ptr<UnixSocket> UnixSocket::Create(int type, FileSystem::HandleFlags flags, const uapi::ucred& credentials)
+{
+	// SOCK_RAW is silently converted into SOCK_DGRAM, see unix_create()
+	if(type == LINUX_SOCK_RAW) type = LINUX_SOCK_DGRAM;
+
+	// todo: SOCK_SEQPACKET
+	if((type != LINUX_SOCK_STREAM) && (type != LINUX_SOCK_DGRAM)) throw LinuxException(LINUX_ESOCKTNOSUPPORT);
+
+	return std::make_shared<UnixSocket>(type, flags, credentials);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::CreatePair (static)
+//
+// Creates a pair of connected sockets
+//
+// Arguments:
+//
+//	type		- Socket type (SOCK_STREAM or SOCK_DGRAM)
+//	flags		- Handle flags to assign to both sockets
+//	credentials	- Credentials of the creating process
+
+std::pair<std::shared_ptr<UnixSocket>, std::shared_ptr<UnixSocket>> UnixSocket::CreatePair(int type, FileSystem::HandleFlags flags, 
+	const uapi::ucred& credentials)
+{
+	auto first = Create(type, flags, credentials);
+	auto second = Create(first->m_type, flags, credentials);
+
+	// Stream sockets are connected with a pair of channels, datagram sockets are each other's default destination
+	if(first->m_type == LINUX_SOCK_STREAM) {
+
+		auto tx = std::make_shared<channel_t>();
+		auto rx = std::make_shared<channel_t>();
+
+		first->AttachChannels(rx, tx);
+		second->AttachChannels(tx, rx);
+	}
+
+	else {
+
+		first->m_peer = second;
+		second->m_peer = first;
+	}
+
+	first->m_peercred = credentials;
+	second->m_peercred = credentials;
+
+	return std::make_pair(std::move(first), std::move(second));
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Deliver (private)
+//
+// Queues a datagram on this socket
+//
+// Arguments:
+//
+//	datagram	- Datagram to be queued
+//	nonblock	- Flag to fail with EAGAIN rather than block on a full queue
+
+void UnixSocket::Deliver(datagram_t&& datagram, bool nonblock)
+{
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	// Wait for space in the queue; a datagram is always accepted into an empty queue
+	// todo: the wait needs to be interruptible by signals (EINTR)
+	while((!m_datagrams.empty()) && (m_queued + datagram.data.size() > DatagramCapacity)) {
+
+		if(nonblock) throw LinuxException(LINUX_EAGAIN);
+		m_signal.wait(critsec);
+	}
+
+	m_queued += datagram.data.size();
+	m_datagrams.emplace_back(std::move(datagram));
+
+	m_signal.notify_all();
+	m_pollqueue.Notify(LINUX_POLLIN | LINUX_POLLRDNORM);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Duplicate
+//
+// Creates a duplicate Handle instance
+//
+// Arguments:
+//
+//	NONE
+
+std::shared_ptr<FileSystem::Handle> UnixSocket::Duplicate(void) const
+{
+	// Duplicated descriptors refer to the same socket
+	return std::const_pointer_cast<UnixSocket>(shared_from_this());
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::ExportName (private, static)
+//
+// Converts a socket name into a sockaddr_un structure
+//
+// Arguments:
+//
+//	name		- Socket name to be converted
+//	address		- Receives the address; can be NULL to only calculate the length
+
+size_t UnixSocket::ExportName(const std::string& name, uapi::sockaddr_un* address)
+{
+	// Pathname addresses include the terminating NUL, abstract names do not
+	size_t namelength = name.size();
+	if((namelength > 0) && (name[0] != '\0') && (namelength < LINUX_UNIX_PATH_MAX)) namelength++;
+
+	if(address) {
+
+		memset(address, 0, sizeof(uapi::sockaddr_un));
+		address->sun_family = LINUX_AF_UNIX;
+		memcpy(address->sun_path, name.data(), std::min(name.size(), static_cast<size_t>(LINUX_UNIX_PATH_MAX)));
+	}
+
+	return offsetof(uapi::sockaddr_un, sun_path) + std::min(namelength, static_cast<size_t>(LINUX_UNIX_PATH_MAX));
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::getFlags
+//
+// Gets the flags specified on the handle
+
+FileSystem::HandleFlags UnixSocket::getFlags(void) const
+{
+	return m_flags;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::GetName
+//
+// Gets the address assigned to the socket, returns the length of the address
+//
+// Arguments:
+//
+//	address		- Receives the address of the socket
+
+size_t UnixSocket::GetName(uapi::sockaddr_un* address) const
+{
+	std::unique_lock<std::mutex> critsec{ m_lock };
+	return ExportName(m_name, address);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::GetPeerName
+//
+// Gets the address of the connected peer socket, returns the length of the address
+//
+// Arguments:
+//
+//	address		- Receives the address of the peer socket
+
+size_t UnixSocket::GetPeerName(uapi::sockaddr_un* address) const
+{
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	if((m_state != state_t::Connected) && (m_peer.expired())) throw LinuxException(LINUX_ENOTCONN);
+	return ExportName(m_peername, address);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::ImportName (private, static)
+//
+// Converts a sockaddr_un structure into a socket name
+//
+// Arguments:
+//
+//	address		- Address to be converted
+//	length		- Length of the address structure
+
+std::string UnixSocket::ImportName(const uapi::sockaddr_un* address, size_t length)
+{
+	if(address == nullptr) throw LinuxException(LINUX_EFAULT);
+	if((length < offsetof(uapi::sockaddr_un, sun_path)) || (length > sizeof(uapi::sockaddr_un))) throw LinuxException(LINUX_EINVAL);
+	if(address->sun_family != LINUX_AF_UNIX) throw LinuxException(LINUX_EINVAL);
+
+	// An address that consists only of the family is unnamed
+	size_t pathlength = length - offsetof(uapi::sockaddr_un, sun_path);
+	if(pathlength == 0) return std::string();
+
+	// Abstract names start with a NUL and are defined by the address length, pathnames are NUL-terminated
+	if(address->sun_path[0] == '\0') return std::string(address->sun_path, pathlength);
+	return std::string(address->sun_path, strnlen(address->sun_path, pathlength));
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Listen
+//
+// Marks the socket as accepting connections
+//
+// Arguments:
+//
+//	backlog		- Maximum number of pending connections
+
+void UnixSocket::Listen(int backlog)
+{
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	if(m_type != LINUX_SOCK_STREAM) throw LinuxException(LINUX_EOPNOTSUPP);
+	if((m_state == state_t::Connected) || (m_name.empty())) throw LinuxException(LINUX_EINVAL);
+
+	// The backlog is silently limited to SOMAXCONN; a backlog of zero still allows a single connection
+	m_backlogmax = static_cast<size_t>(std::max(std::min(backlog, LINUX_SOMAXCONN), 1));
+	m_state = state_t::Listening;
+
+	m_signal.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Lookup (private, static)
+//
+// Locates a bound socket by name
+//
+// Arguments:
+//
+//	name		- Name of the socket to locate
+
+std::shared_ptr<UnixSocket> UnixSocket::Lookup(const std::string& name)
+{
+	sync::critical_section::scoped_lock critsec{ s_namescs };
+
+	auto found = s_names.find(name);
+	return (found != s_names.end()) ? found->second.lock() : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::getPeerCredentials
+//
+// Gets the credentials of the peer socket at the time the connection was established
+
+uapi::ucred UnixSocket::getPeerCredentials(void) const
+{
+	std::unique_lock<std::mutex> critsec{ m_lock };
+	return m_peercred;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Poll
+//
+// Gets the current POLLxxx readiness of the handle
+//
+// Arguments:
+//
+//	NONE
+
+uint32_t UnixSocket::Poll(void) const
+{
+	uint32_t events = 0;
+
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	// A listening socket is readable when a connection is pending
+	if(m_state == state_t::Listening) return (m_backlog.empty()) ? 0 : (LINUX_POLLIN | LINUX_POLLRDNORM);
+
+	if(m_type == LINUX_SOCK_STREAM) {
+
+		// An unconnected stream socket reports a hangup, see unix_poll()
+		if(m_state != state_t::Connected) return (LINUX_POLLOUT | LINUX_POLLWRNORM | LINUX_POLLHUP);
+
+		// The receive side is shut down locally or when the peer releases its send side, and
+		// the send side is shut down locally or when the peer releases its receive side
+		bool rdhup = m_shutread || ((m_inbound->buffer.PollReader() & LINUX_POLLHUP) == LINUX_POLLHUP);
+		bool wrhup = m_shutwrite || ((m_outbound->buffer.PollWriter() & LINUX_POLLERR) == LINUX_POLLERR);
+
+		if(rdhup || (m_inbound->buffer.Available > 0)) events |= (LINUX_POLLIN | LINUX_POLLRDNORM);
+		if(rdhup) events |= LINUX_POLLRDHUP;
+		if(rdhup && wrhup) events |= LINUX_POLLHUP;
+
+		// A send after the peer has gone fails immediately with EPIPE, so it is also writable
+		if((!m_shutwrite) && (m_outbound->buffer.PollWriter() & (LINUX_POLLOUT | LINUX_POLLERR))) events |= (LINUX_POLLOUT | LINUX_POLLWRNORM);
+	}
+
+	else {
+
+		if(m_shutread || (!m_datagrams.empty())) events |= (LINUX_POLLIN | LINUX_POLLRDNORM);
+		if(m_shutread) events |= LINUX_POLLRDHUP;
+		if(m_shutread && m_shutwrite) events |= LINUX_POLLHUP;
+
+		// todo: a datagram socket should not be writable while the queue of its peer is full
+		if(!m_shutwrite) events |= (LINUX_POLLOUT | LINUX_POLLWRNORM);
+	}
+
+	return events;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::QueueConnection (private)
+//
+// Queues a connection on a listening socket
+//
+// Arguments:
+//
+//	connection	- Server side of the new connection
+//	nonblock	- Flag to fail with EAGAIN rather than block on a full backlog
+
+void UnixSocket::QueueConnection(std::shared_ptr<UnixSocket> connection, bool nonblock)
+{
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	if(m_state != state_t::Listening) throw LinuxException(LINUX_ECONNREFUSED);
+
+	// Wait for space in the backlog unless the connecting socket is non-blocking
+	// todo: the wait needs to be interruptible by signals (EINTR)
+	while(m_backlog.size() >= m_backlogmax) {
+
+		if(nonblock) throw LinuxException(LINUX_EAGAIN);
+		m_signal.wait(critsec);
+
+		if(m_state != state_t::Listening) throw LinuxException(LINUX_ECONNREFUSED);
+	}
+
+	m_backlog.emplace_back(std::move(connection));
+
+	m_signal.notify_all();
+	m_pollqueue.Notify(LINUX_POLLIN | LINUX_POLLRDNORM);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Read
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t UnixSocket::Read(void* buffer, uapi::size_t count)
+{
+	return Receive(buffer, count, 0, nullptr, nullptr, nullptr);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::ReadAt
+//
+// Synchronously reads data from the underlying node into a buffer
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin reading
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to read
+
+uapi::size_t UnixSocket::ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	// Sockets do not support positional reads
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::ReadDirectory
+//
+// Reads entries from the underlying directory node as packed linux_dirent64 structures
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Size of the destination buffer, in bytes
+
+uapi::size_t UnixSocket::ReadDirectory(void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	throw LinuxException(LINUX_ENOTDIR);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Receive
+//
+// Receives data and any SCM_RIGHTS handles from the socket
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to receive
+//	flags		- MSG_xxx flags
+//	handles		- Optionally receives SCM_RIGHTS handles; discarded if NULL
+//	address		- Optionally receives the address of the sending socket
+//	length		- Optionally receives the length of the sending socket address
+
+uapi::size_t UnixSocket::Receive(void* buffer, uapi::size_t count, int flags, handlelist_t* handles, uapi::sockaddr_un* address, size_t* length)
+{
+	if(flags & LINUX_MSG_OOB) throw LinuxException(LINUX_EOPNOTSUPP);
+
+	if(m_type == LINUX_SOCK_DGRAM) return ReceiveDatagram(buffer, count, flags, handles, address, length);
+
+	// Stream sockets never report a source address
+	if(length) *length = 0;
+	return ReceiveStream(buffer, count, flags, handles);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::ReceiveDatagram (private)
+//
+// Implements Receive() for datagram sockets
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to receive
+//	flags		- MSG_xxx flags
+//	handles		- Optionally receives SCM_RIGHTS handles; discarded if NULL
+//	address		- Optionally receives the address of the sending socket
+//	length		- Optionally receives the length of the sending socket address
+
+uapi::size_t UnixSocket::ReceiveDatagram(void* buffer, uapi::size_t count, int flags, handlelist_t* handles, uapi::sockaddr_un* address, size_t* length)
+{
+	bool nonblock = (((m_flags & FileSystem::HandleFlags::NonBlocking) ? true : false) || ((flags & LINUX_MSG_DONTWAIT) == LINUX_MSG_DONTWAIT));
+
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	// Wait for a datagram to be queued
+	// todo: the wait needs to be interruptible by signals (EINTR)
+	while(m_datagrams.empty()) {
+
+		if(m_shutread) return 0;
+		if(nonblock) throw LinuxException(LINUX_EAGAIN);
+		m_signal.wait(critsec);
+	}
+
+	datagram_t& datagram = m_datagrams.front();
+
+	// Any part of the datagram that does not fit into the buffer is discarded
+	uapi::size_t size = datagram.data.size();
+	uapi::size_t copied = std::min(count, size);
+	if(copied) memcpy(buffer, datagram.data.data(), copied);
+
+	if(length) *length = ExportName(datagram.source, address);
+
+	if(flags & LINUX_MSG_PEEK) return (flags & LINUX_MSG_TRUNC) ? size : copied;
+
+	if(handles) *handles = std::move(datagram.handles);
+
+	m_queued -= size;
+	m_datagrams.pop_front();
+
+	// Wake any sockets that were waiting for space in the queue
+	m_signal.notify_all();
+
+	// MSG_TRUNC reports the real length of the datagram
+	return (flags & LINUX_MSG_TRUNC) ? size : copied;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::ReceiveStream (private)
+//
+// Implements Receive() for stream sockets
+//
+// Arguments:
+//
+//	buffer		- Destination buffer
+//	count		- Maximum number of bytes to receive
+//	flags		- MSG_xxx flags
+//	handles		- Optionally receives SCM_RIGHTS handles; discarded if NULL
+
+uapi::size_t UnixSocket::ReceiveStream(void* buffer, uapi::size_t count, int flags, handlelist_t* handles)
+{
+	std::shared_ptr<channel_t>		channel;			// Receive channel
+
+	bool nonblock = (((m_flags & FileSystem::HandleFlags::NonBlocking) ? true : false) || ((flags & LINUX_MSG_DONTWAIT) == LINUX_MSG_DONTWAIT));
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		if(m_state != state_t::Connected) throw LinuxException(LINUX_ENOTCONN);
+		if(m_shutread) return 0;
+
+		channel = m_inbound;
+	}
+
+	// Only one receive operation may consume from the channel at a time
+	sync::critical_section::scoped_lock recvcs{ m_recvcs };
+
+	if(flags & LINUX_MSG_PEEK) return channel->buffer.Peek(buffer, count, nonblock);
+
+	uint32_t position = channel->buffer.ReadPosition;
+	uapi::size_t read = channel->buffer.Read(buffer, count, nonblock);
+
+	// MSG_WAITALL continues to read until the request is satisfied or the stream ends
+	if((flags & LINUX_MSG_WAITALL) && (!nonblock)) {
+
+		while((read > 0) && (read < count)) {
+
+			uapi::size_t next = channel->buffer.Read(reinterpret_cast<uint8_t*>(buffer) + read, count - read, false);
+			if(next == 0) break;
+
+			read += next;
+		}
+	}
+
+	// Collect the SCM_RIGHTS handles attached to any of the consumed data; the handles were
+	// queued before the data was written, so any that apply are already present
+	sync::critical_section::scoped_lock critsec{ channel->cs };
+
+	uint32_t end = position + static_cast<uint32_t>(read);
+	while((!channel->rights.empty()) && (static_cast<int32_t>(channel->rights.front().first - end) < 0)) {
+
+		if(handles) handles->insert(handles->end(), channel->rights.front().second.begin(), channel->rights.front().second.end());
+		channel->rights.pop_front();
+	}
+
+	return read;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Seek
+//
+// Changes the file position
+//
+// Arguments:
+//
+//	offset		- Offset into the node data to seek, relative to whence
+//	whence		- Position in the node data that offset is relative to
+
+uapi::loff_t UnixSocket::Seek(uapi::loff_t offset, int whence)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(whence);
+
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Send
+//
+// Sends data and any SCM_RIGHTS handles through the socket
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	count		- Number of bytes to send
+//	flags		- MSG_xxx flags
+//	handles		- SCM_RIGHTS handles to send with the data
+//	address		- Optional address of the destination socket (datagram only)
+//	length		- Length of the destination socket address
+
+uapi::size_t UnixSocket::Send(const void* buffer, uapi::size_t count, int flags, handlelist_t&& handles, const uapi::sockaddr_un* address, size_t length)
+{
+	if(flags & LINUX_MSG_OOB) throw LinuxException(LINUX_EOPNOTSUPP);
+
+	if(m_type == LINUX_SOCK_DGRAM) return SendDatagram(buffer, count, flags, std::move(handles), address, length);
+
+	// A destination address cannot be specified for a stream socket
+	if(address) throw LinuxException(LINUX_EISCONN);
+	return SendStream(buffer, count, flags, std::move(handles));
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::SendDatagram (private)
+//
+// Implements Send() for datagram sockets
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	count		- Number of bytes to send
+//	flags		- MSG_xxx flags
+//	handles		- SCM_RIGHTS handles to send with the data
+//	address		- Optional address of the destination socket
+//	length		- Length of the destination socket address
+
+uapi::size_t UnixSocket::SendDatagram(const void* buffer, uapi::size_t count, int flags, handlelist_t&& handles, const uapi::sockaddr_un* address, size_t length)
+{
+	std::shared_ptr<UnixSocket>		target;				// Destination socket
+	datagram_t						datagram;			// Datagram to be sent
+
+	bool nonblock = (((m_flags & FileSystem::HandleFlags::NonBlocking) ? true : false) || ((flags & LINUX_MSG_DONTWAIT) == LINUX_MSG_DONTWAIT));
+
+	if(count > DatagramCapacity) throw LinuxException(LINUX_EMSGSIZE);
+
+	// Use the provided destination address or the default destination set by connect()
+	if(address) target = Lookup(ImportName(address, length));
+	else {
+
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		if(m_shutwrite) throw LinuxException(LINUX_EPIPE);
+		target = m_peer.lock();
+		if((!target) && (m_peername.empty()) && (m_state != state_t::Connected)) throw LinuxException(LINUX_ENOTCONN);
+	}
+
+	if(!target) throw LinuxException(LINUX_ECONNREFUSED);
+	if(target->m_type != LINUX_SOCK_DGRAM) throw LinuxException(LINUX_EPROTOTYPE);
+
+	// The datagram records the name of this socket as the source address
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+		datagram.source = m_name;
+	}
+
+	datagram.data.assign(reinterpret_cast<const uint8_t*>(buffer), reinterpret_cast<const uint8_t*>(buffer) + count);
+	datagram.handles = std::move(handles);
+
+	target->Deliver(std::move(datagram), nonblock);
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::SendStream (private)
+//
+// Implements Send() for stream sockets
+//
+// Arguments:
+//
+//	buffer		- Source buffer
+//	count		- Number of bytes to send
+//	flags		- MSG_xxx flags
+//	handles		- SCM_RIGHTS handles to send with the data
+
+uapi::size_t UnixSocket::SendStream(const void* buffer, uapi::size_t count, int flags, handlelist_t&& handles)
+{
+	std::shared_ptr<channel_t>		channel;			// Send channel
+
+	bool nonblock = (((m_flags & FileSystem::HandleFlags::NonBlocking) ? true : false) || ((flags & LINUX_MSG_DONTWAIT) == LINUX_MSG_DONTWAIT));
+
+	{
+		std::unique_lock<std::mutex> critsec{ m_lock };
+
+		if(m_state != state_t::Connected) throw LinuxException(LINUX_ENOTCONN);
+		if(m_shutwrite) throw LinuxException(LINUX_EPIPE);
+
+		channel = m_outbound;
+	}
+
+	// Only one send operation may produce into the channel at a time
+	sync::critical_section::scoped_lock sendcs{ m_sendcs };
+
+	// SCM_RIGHTS are queued before the data is written so that the receiver will always
+	// find them once it has consumed the first byte of the data they were sent with
+	bool hasrights = !handles.empty();
+	if(hasrights) {
+
+		sync::critical_section::scoped_lock critsec{ channel->cs };
+		channel->rights.emplace_back(channel->buffer.WritePosition, std::move(handles));
+	}
+
+	try { return channel->buffer.Write(buffer, count, nonblock); }
+
+	catch(...) {
+
+		// Nothing was written, the SCM_RIGHTS cannot be delivered
+		if(hasrights) {
+
+			sync::critical_section::scoped_lock critsec{ channel->cs };
+			channel->rights.pop_back();
+		}
+
+		throw;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Shutdown
+//
+// Shuts down the receive and/or send side of the socket
+//
+// Arguments:
+//
+//	how			- SHUT_RD, SHUT_WR or SHUT_RDWR
+
+void UnixSocket::Shutdown(int how)
+{
+	if((how != LINUX_SHUT_RD) && (how != LINUX_SHUT_WR) && (how != LINUX_SHUT_RDWR)) throw LinuxException(LINUX_EINVAL);
+
+	std::unique_lock<std::mutex> critsec{ m_lock };
+
+	if((m_type == LINUX_SOCK_STREAM) && (m_state != state_t::Connected)) throw LinuxException(LINUX_ENOTCONN);
+
+	// Shutting down the receive side of a stream causes the peer to see EPIPE
+	if((how != LINUX_SHUT_WR) && (!m_shutread)) {
+
+		m_shutread = true;
+		if(m_inbound) m_inbound->buffer.ReleaseReader();
+	}
+
+	// Shutting down the send side of a stream causes the peer to see end-of-file
+	if((how != LINUX_SHUT_RD) && (!m_shutwrite)) {
+
+		m_shutwrite = true;
+		if(m_outbound) m_outbound->buffer.ReleaseWriter();
+	}
+
+	// Wake any datagram receivers so that they will see the shutdown
+	m_signal.notify_all();
+	m_pollqueue.Notify(LINUX_POLLIN | LINUX_POLLOUT | LINUX_POLLRDHUP | LINUX_POLLHUP);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Signal
+//
+// Indicates that the readiness of one of the stream channels has changed
+//
+// Arguments:
+//
+//	events		- POLLxxx events that may have changed
+
+void UnixSocket::Signal(uint32_t events)
+{
+	m_pollqueue.Notify(events);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Subscribe
+//
+// Registers a waiter to be signaled when the readiness of the handle changes
+//
+// Arguments:
+//
+//	waiter		- Waiter to be registered
+
+void UnixSocket::Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter)
+{
+	m_pollqueue.Subscribe(std::move(waiter));
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Sync
+//
+// Synchronizes all metadata and data associated with the file to storage
+//
+// Arguments:
+//
+//	NONE
+
+void UnixSocket::Sync(void) const
+{
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::SyncData
+//
+// Synchronizes all data associated with the file to storage, not metadata
+//
+// Arguments:
+//
+//	NONE
+
+void UnixSocket::SyncData(void) const
+{
+	throw LinuxException(LINUX_EINVAL);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::getType
+//
+// Gets the socket type (SOCK_STREAM or SOCK_DGRAM)
+
+int UnixSocket::getType(void) const
+{
+	return m_type;
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Unsubscribe
+//
+// Removes a previously registered waiter
+//
+// Arguments:
+//
+//	waiter		- Waiter to be removed
+
+void UnixSocket::Unsubscribe(const FileSystem::PollWaiter* waiter)
+{
+	m_pollqueue.Unsubscribe(waiter);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::Write
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t UnixSocket::Write(const void* buffer, uapi::size_t count)
+{
+	return Send(buffer, count, 0, handlelist_t(), nullptr, 0);
+}
+
+//-----------------------------------------------------------------------------
+// UnixSocket::WriteAt
+//
+// Synchronously writes data from a buffer to the underlying node
+//
+// Arguments:
+//
+//	offset		- Offset from the start of the node data to begin writing
+//	buffer		- Source memory buffer
+//	count		- Size of the source buffer, in bytes
+
+uapi::size_t UnixSocket::WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count)
+{
+	UNREFERENCED_PARAMETER(offset);
+	UNREFERENCED_PARAMETER(buffer);
+	UNREFERENCED_PARAMETER(count);
+
+	// Sockets do not support positional writes
+	throw LinuxException(LINUX_ESPIPE);
+}
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,396 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef __UNIXSOCKET_H_
+#define __UNIXSOCKET_H_
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "FileSystem.h"
+#include "PipeBuffer.h"
+#include "PollQueue.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// UnixSocket
+//
+// UnixSocket implements AF_UNIX stream and datagram sockets within the virtual
+// machine.  A socket is itself the Handle that is placed into the descriptor
+// table, the socket system calls access it through a dynamic_pointer_cast<>.
+//
+// Each direction of a stream connection is a PipeBuffer, the same shareable ring
+// that is used for pipes, so connected stream sockets move data with a memcpy
+// into and out of the ring and the service is only involved to block and wake.
+// Handles passed with SCM_RIGHTS are queued next to the ring along with the
+// stream position of the data they were sent with, and are delivered by the
+// receive operation that consumes that position.
+//
+// Datagrams are queued on the receiving socket with their source address and
+// any SCM_RIGHTS handles; message boundaries are preserved.
+//
+// A connected stream socket subscribes to both of its channels and relays their
+// readiness changes to its own waiters, so an epoll or poll waiter registered
+// against the socket is signaled by the peer's operations.
+//
+// Notes:
+//
+//	- Both pathname and abstract (leading NUL) addresses are supported and share
+//	  a single name table; pathname addresses are not yet resolved against the
+//	  file system and do not create an S_IFSOCK node.
+//
+//	- SOCK_SEQPACKET is not supported.
+
+class UnixSocket : public FileSystem::Handle, public FileSystem::Pollable, public FileSystem::PollWaiter, public std::enable_shared_from_this<UnixSocket>
+{
+public:
+
+	// handlelist_t
+	//
+	// Collection of handles passed through a socket as SCM_RIGHTS
+	using handlelist_t = std::vector<std::shared_ptr<FileSystem::Handle>>;
+
+	// Instance Constructor
+	//
+	UnixSocket(int type, FileSystem::HandleFlags flags, const uapi::ucred& credentials);
+
+	// Destructor
+	//
+	~UnixSocket();
+
+	//-------------------------------------------------------------------------
+	// Member Functions
+
+	// Accept
+	//
+	// Accepts a pending connection from a listening socket
+	std::shared_ptr<UnixSocket> Accept(FileSystem::HandleFlags flags);
+
+	// Bind
+	//
+	// Assigns a name to the socket; an empty address requests an autobind
+	void Bind(const uapi::sockaddr_un* address, size_t length);
+
+	// Connect
+	//
+	// Connects the socket to a named socket
+	void Connect(const uapi::sockaddr_un* address, size_t length);
+
+	// Create (static)
+	//
+	// Creates a new unconnected socket
+	static std::shared_ptr<UnixSocket> Create(int type, FileSystem::HandleFlags flags, const uapi::ucred& credentials);
+
+	// CreatePair (static)
+	//
+	// Creates a pair of connected sockets
+	static std::pair<std::shared_ptr<UnixSocket>, std::shared_ptr<UnixSocket>> CreatePair(int type, FileSystem::HandleFlags flags, 
+		const uapi::ucred& credentials);
+
+	// GetName
+	//
+	// Gets the address assigned to the socket, returns the length of the address
+	size_t GetName(uapi::sockaddr_un* address) const;
+
+	// GetPeerName
+	//
+	// Gets the address of the connected peer socket, returns the length of the address
+	size_t GetPeerName(uapi::sockaddr_un* address) const;
+
+	// Listen
+	//
+	// Marks the socket as accepting connections
+	void Listen(int backlog);
+
+	// Receive
+	//
+	// Receives data and any SCM_RIGHTS handles from the socket
+	uapi::size_t Receive(void* buffer, uapi::size_t count, int flags, handlelist_t* handles, uapi::sockaddr_un* address, size_t* length);
+
+	// Send
+	//
+	// Sends data and any SCM_RIGHTS handles through the socket
+	uapi::size_t Send(const void* buffer, uapi::size_t count, int flags, handlelist_t&& handles, const uapi::sockaddr_un* address, size_t length);
+
+	// Shutdown
+	//
+	// Shuts down the receive and/or send side of the socket
+	void Shutdown(int how);
+
+	//-------------------------------------------------------------------------
+	// FileSystem::Handle Implementation
+
+	// Duplicate
+	//
+	// Creates a duplicate Handle instance
+	virtual std::shared_ptr<FileSystem::Handle> Duplicate(void) const override;
+
+	// Read
+	//
+	// Synchronously reads data from the underlying node into a buffer
+	virtual uapi::size_t Read(void* buffer, uapi::size_t count) override;
+
+	// ReadAt
+	//
+	// Synchronously reads data from the underlying node into a buffer
+	virtual uapi::size_t ReadAt(uapi::loff_t offset, void* buffer, uapi::size_t count) override;
+
+	// ReadDirectory
+	//
+	// Reads entries from the underlying directory node as packed linux_dirent64 structures
+	virtual uapi::size_t ReadDirectory(void* buffer, uapi::size_t count) override;
+
+	// Seek
+	//
+	// Changes the file position
+	virtual uapi::loff_t Seek(uapi::loff_t offset, int whence) override;
+
+	// Sync
+	//
+	// Synchronizes all metadata and data associated with the file to storage
+	virtual void Sync(void) const override;
+
+	// SyncData
+	//
+	// Synchronizes all data associated with the file to storage, not metadata
+	virtual void SyncData(void) const override;
+
+	// Write
+	//
+	// Synchronously writes data from a buffer to the underlying node
+	virtual uapi::size_t Write(const void* buffer, uapi::size_t count) override;
+
+	// WriteAt
+	//
+	// Synchronously writes data from a buffer to the underlying node
+	virtual uapi::size_t WriteAt(uapi::loff_t offset, const void* buffer, uapi::size_t count) override;
+
+	// Access
+	//
+	// Gets the access mode used when the handle was created
+	virtual FileSystem::HandleAccess getAccess(void) const override;
+
+	// Flags
+	//
+	// Gets the flags used when the handle was created
+	virtual FileSystem::HandleFlags getFlags(void) const override;
+
+	//-------------------------------------------------------------------------
+	// FileSystem::Pollable Implementation
+
+	// Poll
+	//
+	// Gets the current POLLxxx readiness of the handle
+	virtual uint32_t Poll(void) const override;
+
+	// Subscribe
+	//
+	// Registers a waiter to be signaled when the readiness of the handle changes
+	virtual void Subscribe(std::shared_ptr<FileSystem::PollWaiter> waiter) override;
+
+	// Unsubscribe
+	//
+	// Removes a previously registered waiter
+	virtual void Unsubscribe(const FileSystem::PollWaiter* waiter) override;
+
+	//-------------------------------------------------------------------------
+	// FileSystem::PollWaiter Implementation
+
+	// Signal
+	//
+	// Indicates that the readiness of one of the stream channels has changed
+	virtual void Signal(uint32_t events) override;
+
+	//-------------------------------------------------------------------------
+	// Fields
+
+	// DatagramCapacity (static)
+	//
+	// Maximum number of datagram bytes that can be queued on a receiving socket
+	static const size_t DatagramCapacity;
+
+	// StreamCapacity (static)
+	//
+	// Capacity of each direction of a stream connection, in bytes
+	static const size_t StreamCapacity;
+
+	//-------------------------------------------------------------------------
+	// Properties
+
+	// PeerCredentials
+	//
+	// Gets the credentials of the peer socket at the time the connection was established
+	__declspec(property(get=getPeerCredentials)) uapi::ucred PeerCredentials;
+	uapi::ucred getPeerCredentials(void) const;
+
+	// Type
+	//
+	// Gets the socket type (SOCK_STREAM or SOCK_DGRAM)
+	__declspec(property(get=getType)) int Type;
+	int getType(void) const;
+
+private:
+
+	UnixSocket(const UnixSocket&)=delete;
+	UnixSocket& operator=(const UnixSocket&)=delete;
+
+	// channel_t
+	//
+	// One direction of a stream connection
+	struct channel_t
+	{
+		// Instance Constructor
+		//
+		channel_t() : buffer(StreamCapacity) {}
+
+		PipeBuffer							buffer;		// Shareable data ring
+		std::deque<std::pair<uint32_t, handlelist_t>>	rights;		// SCM_RIGHTS and their stream positions
+		sync::critical_section				cs;			// Synchronization object
+	};
+
+	// datagram_t
+	//
+	// Datagram queued on a receiving socket
+	struct datagram_t
+	{
+		std::vector<uint8_t>				data;		// Datagram payload
+		std::string							source;		// Address of the sending socket
+		handlelist_t						handles;	// SCM_RIGHTS handles
+	};
+
+	// state_t
+	//
+	// Connection state of the socket
+	enum class state_t
+	{
+		Unconnected		= 0,
+		Listening,
+		Connected,
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Member Functions
+
+	// AttachChannels
+	//
+	// Attaches a connected socket to the channels of a stream connection
+	void AttachChannels(std::shared_ptr<channel_t> inbound, std::shared_ptr<channel_t> outbound);
+
+	// Deliver
+	//
+	// Queues a datagram on this socket
+	void Deliver(datagram_t&& datagram, bool nonblock);
+
+	// ExportName (static)
+	//
+	// Converts a socket name into a sockaddr_un structure
+	static size_t ExportName(const std::string& name, uapi::sockaddr_un* address);
+
+	// ImportName (static)
+	//
+	// Converts a sockaddr_un structure into a socket name
+	static std::string ImportName(const uapi::sockaddr_un* address, size_t length);
+
+	// Lookup (static)
+	//
+	// Locates a bound socket by name
+	static std::shared_ptr<UnixSocket> Lookup(const std::string& name);
+
+	// QueueConnection
+	//
+	// Queues a connection on a listening socket
+	void QueueConnection(std::shared_ptr<UnixSocket> connection, bool nonblock);
+
+	// ReceiveDatagram
+	//
+	// Implements Receive() for datagram sockets
+	uapi::size_t ReceiveDatagram(void* buffer, uapi::size_t count, int flags, handlelist_t* handles, uapi::sockaddr_un* address, size_t* length);
+
+	// ReceiveStream
+	//
+	// Implements Receive() for stream sockets
+	uapi::size_t ReceiveStream(void* buffer, uapi::size_t count, int flags, handlelist_t* handles);
+
+	// SendDatagram
+	//
+	// Implements Send() for datagram sockets
+	uapi::size_t SendDatagram(const void* buffer, uapi::size_t count, int flags, handlelist_t&& handles, const uapi::sockaddr_un* address, size_t length);
+
+	// SendStream
+	//
+	// Implements Send() for stream sockets
+	uapi::size_t SendStream(const void* buffer, uapi::size_t count, int flags, handlelist_t&& handles);
+
+	//-------------------------------------------------------------------------
+	// Member Variables
+
+	static std::unordered_map<std::string, std::weak_ptr<UnixSocket>>	s_names;		// Bound socket names
+	static sync::critical_section										s_namescs;		// Name table synchronization
+	static uint32_t														s_autobind;		// Next autobind name
+
+	const int							m_type;			// Socket type
+	FileSystem::HandleFlags				m_flags;		// Handle flags
+	const uapi::ucred					m_credentials;	// Credentials of the creator
+	uapi::ucred							m_peercred;		// Credentials of the peer
+	state_t								m_state;		// Connection state
+	std::string							m_name;			// Bound socket name
+	std::string							m_peername;		// Connected peer socket name
+	mutable std::mutex					m_lock;			// Synchronization object
+	std::condition_variable				m_signal;		// Backlog/datagram queue changed
+
+	// Stream
+	//
+	std::shared_ptr<channel_t>			m_inbound;		// Receive channel
+	std::shared_ptr<channel_t>			m_outbound;		// Send channel
+	bool								m_shutread;		// Receive side has been shut down
+	bool								m_shutwrite;	// Send side has been shut down
+	sync::critical_section				m_recvcs;		// Receive serialization
+	sync::critical_section				m_sendcs;		// Send serialization
+
+	// Listening
+	//
+	std::deque<std::shared_ptr<UnixSocket>>	m_backlog;	// Pending connections
+	size_t								m_backlogmax;	// Maximum pending connections
+
+	// Datagram
+	//
+	std::deque<datagram_t>				m_datagrams;	// Queued datagrams
+	size_t								m_queued;		// Number of queued datagram bytes
+	std::weak_ptr<UnixSocket>			m_peer;			// Default datagram destination
+
+	// Readiness
+	//
+	PollQueue							m_pollqueue;	// Readiness waiters
+};
+
+//-----------------------------------------------------------------------------
+
+#pragma warning(pop)
+
+#endif	// __UNIXSOCKET_H_
@@ -23,8 +23,11 @@
 #include "stdafx.h"
 #include "VirtualMachine.h"
 
+#include "CompressedStreamReader.h"
 #include "Context.h"
 #include "Exception.h"
+#include "File.h"
+#include "IoEngine.h"
 #include "LinuxException.h"
 #include "MountOptions.h"
 #include "Namespace.h"
@@ -48,8 +51,10 @@
 // File Systems
 //
 #include "HostFileSystem.h"
+#include "ImageFileSystem.h"
+#include "OverlayFileSystem.h"
 #include "RootFileSystem.h"
-//#include "TempFileSystem.h"
+#include "TempFileSystem.h"
 
 #pragma warning(push, 4)
 
@@ -222,13 +227,27 @@ void VirtualMachine::OnStart(int argc, LPTSTR* argv)
 		//
 		m_rootns = Namespace::Create();
 
+		// HOST I/O ENGINE
+		//
+		m_ioengine = IoEngine::Create();
+
 		// FILE SYSTEMS
 		//
-		m_filesystems.emplace("hostfs",	HostFileSystem::Mount);
+		// hostfs issues host I/O through the virtual machine IoEngine instance
+		auto ioengine = m_ioengine;
+		m_filesystems.emplace("hostfs", [=](const char_t* source, uint32_t flags, const void* data, size_t datalength) -> fsmount_t 
+			{ return HostFileSystem::Mount(ioengine, source, flags, data, datalength); });
+
+		// The overlay file system layers are host directories, mounted through hostfs
+		auto hostfs = m_filesystems.at("hostfs");
+		m_filesystems.emplace("overlay", [=](const char_t* source, uint32_t flags, const void* data, size_t datalength) -> fsmount_t 
+			{ return OverlayFileSystem::Mount(hostfs, source, flags, data, datalength); });
+
+		m_filesystems.emplace("imagefs", ImageFileSystem::Mount);
 		//m_filesystems.emplace("procfs", ProcFileSystem::Mount);
 		m_filesystems.emplace("rootfs",	RootFileSystem::Mount);
 		//m_filesystems.emplace("sysfs", SysFileSystem::Mount);
-		//m_filesystems.emplace("tmpfs", TempFileSystem::Mount);
+		m_filesystems.emplace("tmpfs", TempFileSystem::Mount);
 
 		// ROOT FILE SYSTEM
 		//
@@ -252,8 +271,13 @@ void VirtualMachine::OnStart(int argc, LPTSTR* argv)
 
 		// INITRAMFS
 		//
-		auto initrd = std::to_string(m_paraminitrd.Value);
-		// extract ramdisk here if there is one
+		// The initial ramdisk archive (optionally compressed) is unpacked into the root file system,
+		// which is only possible when the root file system is an instance of rootfs
+		if(m_paraminitrd.Value.length() > 0) {
+
+			auto initrd = File::OpenExisting(m_paraminitrd.Value.c_str(), GENERIC_READ, FILE_SHARE_READ, FILE_FLAG_SEQUENTIAL_SCAN);
+			RootFileSystem::Populate(m_rootmount, CompressedStreamReader::FromFile(initrd));
+		}
 
 		// SYSTEM CALL LISTENERS
 		//
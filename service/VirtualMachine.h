@@ -33,6 +33,7 @@
 
 // Forward Declarations
 //
+class IoEngine;
 class Namespace;
 class NativeProcess;
 class NativeThread;
@@ -255,6 +256,7 @@ private:
 	std::unique_ptr<RpcObject>		m_syscalls64;		// 64-bit system calls object
 
 	std::unique_ptr<SystemLog>		m_syslog;			// SystemLog instance
+	std::shared_ptr<IoEngine>		m_ioengine;			// Host I/O completion engine
 	std::shared_ptr<Namespace>		m_rootns;			// Root namespace instance
 
 	// Job
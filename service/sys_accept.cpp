@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#pragma warning(push, 4)
+
+// sys_accept4.cpp
+//
+uapi::long_t sys_accept4(const Context* context, int fd, void* addr, void* addrlen, int flags);
+
+//-----------------------------------------------------------------------------
+// sys_accept
+//
+// Accepts a connection on a socket
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Listening socket file descriptor
+//	addr		- Optionally receives the address of the peer socket
+//	addrlen		- Length of the addr buffer; receives the length of the address
+
+uapi::long_t sys_accept(const Context* context, int fd, void* addr, void* addrlen)
+{
+	return -LINUX_ENOSYS;
+
+	//// sys_accept() is equivalent to sys_accept4() without any flags
+	//return sys_accept4(context, fd, addr, addrlen, 0);
+}
+
+#ifdef _M_X64
+// sys64_accept
+//
+sys64_long_t sys64_accept(sys64_context_t context, sys64_int_t fd, sys64_addr_t addr, sys64_addr_t addrlen)
+{
+	return SystemCall::Invoke(sys_accept, context, fd, reinterpret_cast<void*>(addr), reinterpret_cast<void*>(addrlen));
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
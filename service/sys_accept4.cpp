@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "Process.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_accept4
+//
+// Accepts a connection on a socket
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Listening socket file descriptor
+//	addr		- Optionally receives the address of the peer socket
+//	addrlen		- Length of the addr buffer; receives the length of the address
+//	flags		- SOCK_CLOEXEC and/or SOCK_NONBLOCK
+
+uapi::long_t sys_accept4(const Context* context, int fd, void* addr, void* addrlen, int flags)
+{
+	return -LINUX_ENOSYS;
+
+	//if(flags & ~(LINUX_SOCK_CLOEXEC | LINUX_SOCK_NONBLOCK)) return -LINUX_EINVAL;
+
+	//auto socket = std::dynamic_pointer_cast<UnixSocket>(context->Process->Handle[fd]);
+	//if(!socket) return -LINUX_ENOTSOCK;
+
+	//auto connection = socket->Accept(FileSystem::HandleFlags(flags & LINUX_SOCK_NONBLOCK));
+
+	//// The peer address is only reported if the caller provided a buffer for it
+	//if(addr != nullptr) {
+
+	//	uapi::sockaddr_un peer;
+	//	uint32_t length = 0;
+
+	//	context->Process->ReadMemory(addrlen, &length, sizeof(uint32_t));
+	//	uint32_t required = static_cast<uint32_t>(connection->GetPeerName(&peer));
+
+	//	context->Process->WriteMemory(addr, &peer, std::min(length, required));
+	//	context->Process->WriteMemory(addrlen, &required, sizeof(uint32_t));
+	//}
+
+	//return context->Process->AddHandle(connection, (flags & LINUX_SOCK_CLOEXEC) == LINUX_SOCK_CLOEXEC);
+}
+
+// sys32_accept4
+//
+sys32_long_t sys32_accept4(sys32_context_t context, sys32_int_t fd, sys32_addr_t addr, sys32_addr_t addrlen, sys32_int_t flags)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_accept4, context, fd, reinterpret_cast<void*>(addr), reinterpret_cast<void*>(addrlen), flags));
+}
+
+#ifdef _M_X64
+// sys64_accept4
+//
+sys64_long_t sys64_accept4(sys64_context_t context, sys64_int_t fd, sys64_addr_t addr, sys64_addr_t addrlen, sys64_int_t flags)
+{
+	return SystemCall::Invoke(sys_accept4, context, fd, reinterpret_cast<void*>(addr), reinterpret_cast<void*>(addrlen), flags);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
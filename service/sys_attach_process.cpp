@@ -39,10 +39,11 @@
 //	rpchandle		- RPC binding handle
 //	tid				- [in] native thread identifier of the process main thread
 //	threadproc		- [in] address of the thread creation entry point
+//	sigproc			- [in] address of the signal delivery entry point
 //	process			- [out] set to the process startup information
 //	context			- [out] set to the newly allocated context handle
 
-HRESULT sys32_attach_process(handle_t rpchandle, sys32_uint_t tid, sys32_addr_t threadproc, sys32_process_t* process, sys32_context_exclusive_t* context)
+HRESULT sys32_attach_process(handle_t rpchandle, sys32_uint_t tid, sys32_addr_t threadproc, sys32_addr_t sigproc, sys32_process_t* process, sys32_context_exclusive_t* context)
 {
 	uuid_t						objectid;			// RPC object identifier
 	//Context*					handle = nullptr;	// System call context handle
@@ -64,10 +65,13 @@ HRESULT sys32_attach_process(handle_t rpchandle, sys32_uint_t tid, sys32_addr_t
 	// TESTING
 	//
 	auto vm = VirtualMachine::Find(objectid);
-	if(vm == nullptr) { /* TODO: THROW CUSTOM EXCEPTION */ }
+	if(vm == nullptr) return E_FAIL;	// TODO: CUSTOM HRESULT
 
 	auto proc = AttachProcess(reinterpret_cast<DWORD>(attributes.ClientPID));
-	if(proc == nullptr) { /* TODO: THROW CUSTOM EXCEPTION */ }
+	if(proc == nullptr) return E_FAIL;	// TODO: CUSTOM HRESULT
+
+	// Set the provided address as the signal delivery entry point for the process
+	proc->SignalEntryPoint = static_cast<uintptr_t>(sigproc);
 	//
 	////////
 
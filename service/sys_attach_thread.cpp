@@ -77,6 +77,9 @@ HRESULT sys32_attach_thread(handle_t rpchandle, sys32_uint_t tid, sys32_thread_t
 
 	//	// Acquire the initial task information for the thread
 	//	thd->PopInitialTask(&thread->task, sizeof(sys32_task_t));
+
+	//	// The host clears and wakes the CLONE_CHILD_CLEARTID address when the thread exits
+	//	thread->cleartid = reinterpret_cast<sys32_addr_t>(thd->ClearThreadIdOnExit);
 	//	
 	//	// Allocate the context handle by referencing the acquired objects
 	//	handle = Context::Allocate(vm, proc, thd);
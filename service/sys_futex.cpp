@@ -0,0 +1,158 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "Futex.h"
+#include "MonotonicClock.h"
+#include "Process.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_futex
+//
+// Fast user-space locking for futexes that can be shared between processes; process-private
+// futexes (FUTEX_PRIVATE_FLAG) are implemented by the host process without a system call
+//
+// Arguments:
+//
+//	context		- System call context object
+//	uaddr		- Address of the futex word
+//	op			- FUTEX_xxx operation and flags
+//	val			- Operation specific value
+//	timeout		- Wait timeout, or val2 for the requeue operations
+//	uaddr2		- Address of the target futex word for the requeue operations
+//	val3		- Operation specific value
+
+uapi::long_t sys_futex(const Context* context, void* uaddr, int op, uint32_t val, void* timeout, void* uaddr2, uint32_t val3)
+{
+	// The context handle is a SystemCallContext instance (see sys32_exit)
+	auto process = reinterpret_cast<const SystemCallContext*>(context)->Process;
+	if(process == nullptr) return -LINUX_ESRCH;
+
+	// Futex words must be naturally aligned
+	if(reinterpret_cast<uintptr_t>(uaddr) & (sizeof(uint32_t) - 1)) return -LINUX_EINVAL;
+
+	int command = op & LINUX_FUTEX_CMD_MASK;
+	bool realtime = ((op & LINUX_FUTEX_CLOCK_REALTIME) == LINUX_FUTEX_CLOCK_REALTIME);
+	if(realtime && (command != LINUX_FUTEX_WAIT) && (command != LINUX_FUTEX_WAIT_BITSET)) return -LINUX_ENOSYS;
+
+	// Shared futexes are identified by the section and offset rather than the address
+	Futex::key_t key = process->GetSectionOffset(reinterpret_cast<uintptr_t>(uaddr));
+
+	// Comparisons read the futex word from the process while the futex bucket is locked
+	auto compare = [=](uint32_t expected) -> Futex::compare_t {
+
+		return [=]() -> bool {
+
+			uint32_t current = 0;
+			process->ReadMemory(reinterpret_cast<uintptr_t>(uaddr), &current, sizeof(uint32_t));
+			return current == expected;
+		};
+	};
+
+	// Converts the timeout into a deadline; FUTEX_WAIT timeouts are relative and FUTEX_WAIT_BITSET
+	// timeouts are absolute against CLOCK_MONOTONIC, or CLOCK_REALTIME if requested
+	auto deadline = [&](bool absolute) -> Futex::deadline_t {
+
+		if(timeout == nullptr) return Futex::deadline_t::max();
+
+		uapi::timespec ts{};
+		if(process->Architecture == Architecture::x86) {
+
+			linux_timespec32 ts32;
+			process->ReadMemory(reinterpret_cast<uintptr_t>(timeout), &ts32, sizeof(linux_timespec32));
+			ts = { ts32.tv_sec, ts32.tv_nsec };
+		}
+		else process->ReadMemory(reinterpret_cast<uintptr_t>(timeout), &ts, sizeof(uapi::timespec));
+
+		if((ts.tv_sec < 0) || (ts.tv_nsec < 0) || (ts.tv_nsec >= 1000000000)) throw LinuxException(LINUX_EINVAL);
+		auto interval = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+		auto now = std::chrono::steady_clock::now();
+
+		if(!absolute) return now + interval;
+		if(realtime) return now + (std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(interval)) - std::chrono::system_clock::now());
+
+		// CLOCK_MONOTONIC deadlines are measured against MonotonicClock, the same clock the host uses
+		auto remaining = interval - std::chrono::nanoseconds(static_cast<int64_t>(MonotonicClock::Now()));
+		if(remaining < remaining.zero()) remaining = remaining.zero();
+
+		return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining);
+	};
+
+	switch(command) {
+
+		case LINUX_FUTEX_WAIT:
+			Futex::Wait(key, LINUX_FUTEX_BITSET_MATCH_ANY, compare(val), deadline(false));
+			return 0;
+
+		case LINUX_FUTEX_WAIT_BITSET:
+			if(val3 == 0) return -LINUX_EINVAL;
+			Futex::Wait(key, val3, compare(val), deadline(true));
+			return 0;
+
+		case LINUX_FUTEX_WAKE:
+			return static_cast<uapi::long_t>(Futex::Wake(key, val, LINUX_FUTEX_BITSET_MATCH_ANY));
+
+		case LINUX_FUTEX_WAKE_BITSET:
+			if(val3 == 0) return -LINUX_EINVAL;
+			return static_cast<uapi::long_t>(Futex::Wake(key, val, val3));
+
+		// The timeout argument is val2, the maximum number of waiters to requeue
+		case LINUX_FUTEX_REQUEUE:
+		case LINUX_FUTEX_CMP_REQUEUE: {
+
+			if(reinterpret_cast<uintptr_t>(uaddr2) & (sizeof(uint32_t) - 1)) return -LINUX_EINVAL;
+
+			Futex::key_t target = process->GetSectionOffset(reinterpret_cast<uintptr_t>(uaddr2));
+			size_t requeue = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(timeout));
+
+			return static_cast<uapi::long_t>(Futex::Requeue(key, target, val, requeue, (command == LINUX_FUTEX_CMP_REQUEUE) ? compare(val3) : nullptr));
+		}
+	}
+
+	// todo: FUTEX_WAKE_OP and the priority-inheritance operations
+	return -LINUX_ENOSYS;
+}
+
+// sys32_futex
+//
+sys32_long_t sys32_futex(sys32_context_t context, sys32_addr_t uaddr, sys32_int_t op, sys32_uint_t val, sys32_addr_t timeout, sys32_addr_t uaddr2, sys32_uint_t val3)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_futex, context, reinterpret_cast<void*>(uaddr), op, val, reinterpret_cast<void*>(timeout), reinterpret_cast<void*>(uaddr2), val3));
+}
+
+#ifdef _M_X64
+// sys64_futex
+//
+sys64_long_t sys64_futex(sys64_context_t context, sys64_addr_t uaddr, sys64_int_t op, sys64_uint_t val, sys64_addr_t timeout, sys64_addr_t uaddr2, sys64_uint_t val3)
+{
+	return SystemCall::Invoke(sys_futex, context, reinterpret_cast<void*>(uaddr), op, val, reinterpret_cast<void*>(timeout), reinterpret_cast<void*>(uaddr2), val3);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "Process.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_getdents64
+//
+// Reads linux_dirent64 structures from an open directory file system object
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- File descriptor
+//	dirp		- Output buffer to receive the directory entries
+//	count		- Size of the output buffer, in bytes
+
+uapi::long_t sys_getdents64(const Context* context, int fd, void* dirp, unsigned int count)
+{
+	return -LINUX_ENOSYS;
+
+	//return context->Process->Handle[fd]->ReadDirectory(dirp, count);
+}
+
+// sys32_getdents64
+//
+sys32_long_t sys32_getdents64(sys32_context_t context, sys32_int_t fd, sys32_uchar_t* dirp, sys32_uint_t count)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_getdents64, context, fd, dirp, count));
+}
+
+#ifdef _M_X64
+// sys64_getdents64
+//
+sys64_long_t sys64_getdents64(sys64_context_t context, sys64_int_t fd, sys64_uchar_t* dirp, sys64_sizeis_t count)
+{
+	return SystemCall::Invoke(sys_getdents64, context, fd, dirp, count);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
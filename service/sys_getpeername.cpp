@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "Process.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_getpeername
+//
+// Gets the address of the peer connected to a socket
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Socket file descriptor
+//	addr		- Receives the address of the peer socket
+//	addrlen		- Length of the addr buffer; receives the length of the address
+
+uapi::long_t sys_getpeername(const Context* context, int fd, void* addr, void* addrlen)
+{
+	return -LINUX_ENOSYS;
+
+	//if((addr == nullptr) || (addrlen == nullptr)) return -LINUX_EFAULT;
+
+	//auto socket = std::dynamic_pointer_cast<UnixSocket>(context->Process->Handle[fd]);
+	//if(!socket) return -LINUX_ENOTSOCK;
+
+	//uapi::sockaddr_un address;
+	//uint32_t length = 0;
+
+	//context->Process->ReadMemory(addrlen, &length, sizeof(uint32_t));
+	//uint32_t required = static_cast<uint32_t>(socket->GetPeerName(&address));
+
+	//// The address is truncated if the buffer is too small, the required length is always reported
+	//context->Process->WriteMemory(addr, &address, std::min(length, required));
+	//context->Process->WriteMemory(addrlen, &required, sizeof(uint32_t));
+
+	//return 0;
+}
+
+// sys32_getpeername
+//
+sys32_long_t sys32_getpeername(sys32_context_t context, sys32_int_t fd, sys32_addr_t addr, sys32_addr_t addrlen)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_getpeername, context, fd, reinterpret_cast<void*>(addr), reinterpret_cast<void*>(addrlen)));
+}
+
+#ifdef _M_X64
+// sys64_getpeername
+//
+sys64_long_t sys64_getpeername(sys64_context_t context, sys64_int_t fd, sys64_addr_t addr, sys64_addr_t addrlen)
+{
+	return SystemCall::Invoke(sys_getpeername, context, fd, reinterpret_cast<void*>(addr), reinterpret_cast<void*>(addrlen));
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
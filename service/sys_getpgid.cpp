@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "Namespace.h"
+#include "Pid.h"
+#include "PidNamespace.h"
+#include "Process.h"
+#include "ProcessGroup.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_getpgid
+//
+// Gets the process group identifier of a process
+//
+// Arguments:
+//
+//	context		- System call context object
+//	pid			- Process identifier, zero indicates the calling process
+
+uapi::long_t sys_getpgid(const Context* context, uapi::pid_t pid)
+{
+	// The 32-bit context handle is a SystemCallContext instance (see sys32_exit)
+	auto caller = reinterpret_cast<const SystemCallContext*>(context)->Process;
+	if(caller == nullptr) return -LINUX_ESRCH;
+
+	// Identifiers are interpreted in and reported for the pid namespace of the caller
+	auto pids = caller->Namespace->Pids;
+
+	auto process = (pid == 0) ? caller : pids->FindProcess(pid);
+	if(process == nullptr) return -LINUX_ESRCH;
+
+	return process->ProcessGroup->ProcessGroupId->getValue(pids);
+}
+
+// sys32_getpgid
+//
+sys32_long_t sys32_getpgid(sys32_context_t context, sys32_pid_t pid)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_getpgid, context, pid));
+}
+
+#ifdef _M_X64
+// sys64_getpgid
+//
+sys64_long_t sys64_getpgid(sys64_context_t context, sys64_pid_t pid)
+{
+	return SystemCall::Invoke(sys_getpgid, context, pid);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
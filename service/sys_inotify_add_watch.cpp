@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "Inotify.h"
+#include "Process.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_inotify_add_watch
+//
+// Adds a watch to an inotify instance or modifies an existing watch
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Inotify instance file descriptor
+//	pathname	- Path to the file system object to be watched
+//	mask		- IN_xxx events and flags
+
+uapi::long_t sys_inotify_add_watch(const Context* context, int fd, const uapi::char_t* pathname, uint32_t mask)
+{
+	return -LINUX_ENOSYS;
+
+	//auto instance = std::dynamic_pointer_cast<Inotify>(context->Process->Handle[fd]);
+	//if(!instance) return -LINUX_EINVAL;
+
+	//if(pathname == nullptr) return -LINUX_EFAULT;
+
+	//// IN_DONT_FOLLOW watches a symbolic link itself rather than the object it refers to
+	//auto path = FileSystem::LookupPath(context->Process->Namespace, context->Process->RootPath, context->Process->WorkingPath, pathname,
+	//	(mask & LINUX_IN_DONT_FOLLOW) ? LINUX_O_NOFOLLOW : 0);
+
+	//return instance->AddWatch(path->Alias->Node, mask);
+}
+
+// sys32_inotify_add_watch
+//
+sys32_long_t sys32_inotify_add_watch(sys32_context_t context, sys32_int_t fd, const sys32_char_t* pathname, sys32_uint_t mask)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_inotify_add_watch, context, fd, pathname, mask));
+}
+
+#ifdef _M_X64
+// sys64_inotify_add_watch
+//
+sys64_long_t sys64_inotify_add_watch(sys64_context_t context, sys64_int_t fd, const sys64_char_t* pathname, sys64_uint_t mask)
+{
+	return SystemCall::Invoke(sys_inotify_add_watch, context, fd, pathname, mask);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
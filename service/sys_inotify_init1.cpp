@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "Inotify.h"
+#include "Process.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_inotify_init1
+//
+// Creates an inotify instance
+//
+// Arguments:
+//
+//	context		- System call context object
+//	flags		- IN_CLOEXEC and IN_NONBLOCK flags
+
+uapi::long_t sys_inotify_init1(const Context* context, int flags)
+{
+	return -LINUX_ENOSYS;
+
+	//if(flags & ~(LINUX_IN_CLOEXEC | LINUX_IN_NONBLOCK)) return -LINUX_EINVAL;
+
+	//auto instance = Inotify::Create((flags & LINUX_IN_NONBLOCK) ? FileSystem::HandleFlags::NonBlocking : FileSystem::HandleFlags::None);
+	//return context->Process->AddHandle(instance, (flags & LINUX_IN_CLOEXEC) == LINUX_IN_CLOEXEC);
+}
+
+// sys32_inotify_init1
+//
+sys32_long_t sys32_inotify_init1(sys32_context_t context, sys32_int_t flags)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_inotify_init1, context, flags));
+}
+
+#ifdef _M_X64
+// sys64_inotify_init1
+//
+sys64_long_t sys64_inotify_init1(sys64_context_t context, sys64_int_t flags)
+{
+	return SystemCall::Invoke(sys_inotify_init1, context, flags);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
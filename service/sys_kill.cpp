@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "Namespace.h"
+#include "Pid.h"
+#include "PidNamespace.h"
+#include "Process.h"
+#include "ProcessGroup.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_kill
+//
+// Sends a signal to a process or a group of processes
+//
+// Arguments:
+//
+//	context		- System call context object
+//	pid			- Target process or process group identifier
+//	sig			- Signal to send, zero only checks that the target exists
+
+uapi::long_t sys_kill(const Context* context, uapi::pid_t pid, int sig)
+{
+	uapi::siginfo			siginfo;			// Signal information
+
+	if((sig < 0) || (sig > LINUX__NSIG)) return -LINUX_EINVAL;
+
+	// The 32-bit context handle is a SystemCallContext instance (see sys32_exit)
+	auto caller = reinterpret_cast<const SystemCallContext*>(context)->Process;
+	if(caller == nullptr) return -LINUX_ESRCH;
+
+	// Target identifiers are interpreted in the pid namespace of the caller
+	auto pids = caller->Namespace->Pids;
+
+	memset(&siginfo, 0, sizeof(uapi::siginfo));
+	siginfo.si_signo = sig;
+	siginfo.si_code = LINUX_SI_USER;
+	siginfo.linux_si_pid = caller->ProcessId->getValue(pids);
+	siginfo.linux_si_uid = 0;
+
+	// pid > 0: Signal the specified process
+	if(pid > 0) {
+
+		auto process = pids->FindProcess(pid);
+		if(process == nullptr) return -LINUX_ESRCH;
+
+		if(sig) process->Signal(siginfo);
+		return 0;
+	}
+
+	// pid == 0: Signal the caller's process group, pid < -1: signal process group -pid
+	if(pid != -1) {
+
+		auto pgroup = (pid == 0) ? caller->ProcessGroup : pids->FindProcessGroup(-pid);
+		if(pgroup == nullptr) return -LINUX_ESRCH;
+
+		if(sig) pgroup->Signal(siginfo);
+		return 0;
+	}
+
+	// pid == -1: Signal every process in the namespace except init and the caller
+	bool found = false;
+	for(auto const& process : pids->Processes) {
+
+		if((process == caller) || (process->ProcessId->getValue(pids) == 1)) continue;
+
+		found = true;
+		if(sig) process->Signal(siginfo);
+	}
+
+	return (found) ? 0 : -LINUX_ESRCH;
+}
+
+// sys32_kill
+//
+sys32_long_t sys32_kill(sys32_context_t context, sys32_pid_t pid, sys32_int_t sig)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_kill, context, pid, sig));
+}
+
+#ifdef _M_X64
+// sys64_kill
+//
+sys64_long_t sys64_kill(sys64_context_t context, sys64_pid_t pid, sys64_int_t sig)
+{
+	return SystemCall::Invoke(sys_kill, context, pid, sig);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
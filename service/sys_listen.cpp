@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "Process.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_listen
+//
+// Listens for connections on a socket
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Socket file descriptor
+//	backlog		- Maximum length of the pending connection queue
+
+uapi::long_t sys_listen(const Context* context, int fd, int backlog)
+{
+	return -LINUX_ENOSYS;
+
+	//auto socket = std::dynamic_pointer_cast<UnixSocket>(context->Process->Handle[fd]);
+	//if(!socket) return -LINUX_ENOTSOCK;
+
+	//socket->Listen(backlog);
+	//return 0;
+}
+
+// sys32_listen
+//
+sys32_long_t sys32_listen(sys32_context_t context, sys32_int_t fd, sys32_int_t backlog)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_listen, context, fd, backlog));
+}
+
+#ifdef _M_X64
+// sys64_listen
+//
+sys64_long_t sys64_listen(sys64_context_t context, sys64_int_t fd, sys64_int_t backlog)
+{
+	return SystemCall::Invoke(sys_listen, context, fd, backlog);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#pragma warning(push, 4)
+
+// sys_pipe2.cpp
+//
+uapi::long_t sys_pipe2(const Context* context, int* fds, int flags);
+
+//-----------------------------------------------------------------------------
+// sys_pipe
+//
+// Creates an anonymous pipe
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fds			- Receives the read and write end file descriptors
+
+uapi::long_t sys_pipe(const Context* context, int* fds)
+{
+	return -LINUX_ENOSYS;
+
+	//// sys_pipe() is equivalent to sys_pipe2() without any flags
+	//return sys_pipe2(context, fds, 0);
+}
+
+// sys32_pipe
+//
+sys32_long_t sys32_pipe(sys32_context_t context, sys32_int_t* fds)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_pipe, context, fds));
+}
+
+#ifdef _M_X64
+// sys64_pipe
+//
+sys64_long_t sys64_pipe(sys64_context_t context, sys64_int_t* fds)
+{
+	return SystemCall::Invoke(sys_pipe, context, fds);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "PipeFileSystem.h"
+#include "Process.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_pipe2
+//
+// Creates an anonymous pipe
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fds			- Receives the read and write end file descriptors
+//	flags		- O_CLOEXEC, O_DIRECT and/or O_NONBLOCK
+
+uapi::long_t sys_pipe2(const Context* context, int* fds, int flags)
+{
+	// todo: Process does not yet maintain a file descriptor table to receive the pipe handles
+	return -LINUX_ENOSYS;
+
+	//if(fds == nullptr) return -LINUX_EFAULT;
+	//if(flags & ~(LINUX_O_CLOEXEC | LINUX_O_DIRECT | LINUX_O_NONBLOCK)) return -LINUX_EINVAL;
+
+	//// todo: O_DIRECT (packet mode) is accepted but the pipe always operates in stream mode
+	//auto pipe = PipeFileSystem::CreatePipe(FileSystem::HandleFlags(flags & LINUX_O_NONBLOCK), context->UserId, context->GroupId);
+
+	//// Both ends must be added to the process before the descriptors are reported back
+	//int reader = context->Process->AddHandle(pipe.first, (flags & LINUX_O_CLOEXEC) == LINUX_O_CLOEXEC);
+	//try { fds[1] = context->Process->AddHandle(pipe.second, (flags & LINUX_O_CLOEXEC) == LINUX_O_CLOEXEC); }
+	//catch(...) { context->Process->RemoveHandle(reader); throw; }
+
+	//fds[0] = reader;
+	//return 0;
+}
+
+// sys32_pipe2
+//
+sys32_long_t sys32_pipe2(sys32_context_t context, sys32_int_t* fds, sys32_int_t flags)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_pipe2, context, fds, flags));
+}
+
+#ifdef _M_X64
+// sys64_pipe2
+//
+sys64_long_t sys64_pipe2(sys64_context_t context, sys64_int_t* fds, sys64_int_t flags)
+{
+	return SystemCall::Invoke(sys_pipe2, context, fds, flags);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
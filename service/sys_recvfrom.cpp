@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "Process.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_recvfrom
+//
+// Receives a message from a socket
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Socket file descriptor
+//	buf			- Receives the data
+//	len			- Length of the buf buffer
+//	flags		- MSG_xxx flags
+//	src_addr	- Optionally receives the address of the source socket
+//	addrlen		- Length of the src_addr buffer; receives the length of the address
+
+uapi::long_t sys_recvfrom(const Context* context, int fd, void* buf, uapi::size_t len, int flags, void* src_addr, void* addrlen)
+{
+	return -LINUX_ENOSYS;
+
+	//auto socket = std::dynamic_pointer_cast<UnixSocket>(context->Process->Handle[fd]);
+	//if(!socket) return -LINUX_ENOTSOCK;
+
+	//uapi::sockaddr_un address;
+	//size_t required = 0;
+
+	//uapi::size_t received = socket->Receive(buf, len, flags, nullptr, &address, &required);
+
+	//// The source address is only reported if the caller provided a buffer for it
+	//if(src_addr != nullptr) {
+
+	//	uint32_t length = 0;
+	//	uint32_t reported = static_cast<uint32_t>(required);
+	//	context->Process->ReadMemory(addrlen, &length, sizeof(uint32_t));
+
+	//	context->Process->WriteMemory(src_addr, &address, std::min(length, reported));
+	//	context->Process->WriteMemory(addrlen, &reported, sizeof(uint32_t));
+	//}
+
+	//return static_cast<uapi::long_t>(received);
+}
+
+// sys32_recvfrom
+//
+sys32_long_t sys32_recvfrom(sys32_context_t context, sys32_int_t fd, sys32_uchar_t* buf, sys32_size_t len, sys32_uint_t flags, sys32_addr_t src_addr, sys32_addr_t addrlen)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_recvfrom, context, fd, buf, len, static_cast<int>(flags), reinterpret_cast<void*>(src_addr), reinterpret_cast<void*>(addrlen)));
+}
+
+#ifdef _M_X64
+// sys64_recvfrom
+//
+sys64_long_t sys64_recvfrom(sys64_context_t context, sys64_int_t fd, sys64_uchar_t* buf, sys64_sizeis_t len, sys64_uint_t flags, sys64_addr_t src_addr, sys64_addr_t addrlen)
+{
+	return SystemCall::Invoke(sys_recvfrom, context, fd, buf, len, static_cast<int>(flags), reinterpret_cast<void*>(src_addr), reinterpret_cast<void*>(addrlen));
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,198 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "HeapBuffer.h"
+#include "Process.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_recvmsg
+//
+// Receives a message and any SCM_RIGHTS file descriptors from a socket
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Socket file descriptor
+//	msg			- Message header
+//	flags		- MSG_xxx flags
+
+uapi::long_t sys_recvmsg(const Context* context, int fd, uapi::msghdr* msg, int flags)
+{
+	return -LINUX_ENOSYS;
+
+	//if(msg == nullptr) return -LINUX_EFAULT;
+
+	//auto socket = std::dynamic_pointer_cast<UnixSocket>(context->Process->Handle[fd]);
+	//if(!socket) return -LINUX_ENOTSOCK;
+
+	//// The scatter/gather array has been marshalled with the header, calculate the total length
+	//if(msg->msg_iovlen > LINUX_UIO_MAXIOV) return -LINUX_EMSGSIZE;
+	//auto iov = msg->msg_iov;
+
+	//size_t total = 0;
+	//for(size_t index = 0; index < msg->msg_iovlen; index++) total += iov[index].iov_len;
+
+	//// Receive into a single intermediate buffer large enough for the entire scatter/gather array
+	//HeapBuffer<uint8_t> buffer(total);
+	//UnixSocket::handlelist_t handles;
+	//uapi::sockaddr_un address;
+	//size_t addresslength = 0;
+
+	//uapi::size_t received = socket->Receive(&buffer, total, flags, &handles, &address, &addresslength);
+
+	//// Scatter the received data into the calling process; MSG_TRUNC can report more than was copied
+	//size_t offset = 0;
+	//for(size_t index = 0; (index < msg->msg_iovlen) && (offset < std::min(received, total)); index++)
+	//	offset += context->Process->WriteMemory(iov[index].iov_base, &buffer + offset, std::min(iov[index].iov_len, std::min(received, total) - offset));
+
+	//msg->msg_flags = (received > total) ? LINUX_MSG_TRUNC : 0;
+
+	//// The source address is only reported if the caller provided a buffer for it
+	//if(msg->msg_name != nullptr) {
+
+	//	context->Process->WriteMemory(msg->msg_name, &address, std::min(static_cast<size_t>(msg->msg_namelen), addresslength));
+	//	msg->msg_namelen = static_cast<int>(addresslength);
+	//}
+
+	//// Received handles are added to the calling process and reported as a single SCM_RIGHTS message,
+	//// any that will not fit into the control buffer are released and MSG_CTRUNC is reported
+	//size_t controllength = 0;
+	//if(!handles.empty()) {
+
+	//	size_t space = (msg->msg_controllen > sizeof(uapi::cmsghdr)) ? (msg->msg_controllen - sizeof(uapi::cmsghdr)) / sizeof(int) : 0;
+	//	size_t count = std::min(handles.size(), space);
+	//	if(count < handles.size()) msg->msg_flags |= LINUX_MSG_CTRUNC;
+
+	//	if(count > 0) {
+
+	//		// The control message buffer has been marshalled with the header and is written directly
+	//		auto cmsg = reinterpret_cast<uapi::cmsghdr*>(msg->msg_control);
+	//		cmsg->cmsg_len = sizeof(uapi::cmsghdr) + (count * sizeof(int));
+	//		cmsg->cmsg_level = LINUX_SOL_SOCKET;
+	//		cmsg->cmsg_type = LINUX_SCM_RIGHTS;
+
+	//		auto fds = reinterpret_cast<int*>(cmsg + 1);
+	//		for(size_t index = 0; index < count; index++) 
+	//			fds[index] = context->Process->AddHandle(handles[index], (flags & LINUX_MSG_CMSG_CLOEXEC) == LINUX_MSG_CMSG_CLOEXEC);
+
+	//		controllength = cmsg->cmsg_len;
+	//	}
+	//}
+
+	//msg->msg_controllen = controllength;
+	//return static_cast<uapi::long_t>(received);
+}
+
+#ifndef _M_X64
+// sys32_recvmsg (32-bit)
+//
+sys32_long_t sys32_recvmsg(sys32_context_t context, sys32_int_t fd, sys32_msghdr_t* msg, sys32_uint_t flags)
+{
+	static_assert(sizeof(uapi::msghdr) == sizeof(sys32_msghdr_t), "uapi::msghdr is not equivalent to sys32_msghdr_t");
+	return SystemCall::Invoke(sys_recvmsg, context, fd, reinterpret_cast<uapi::msghdr*>(msg), static_cast<int>(flags));
+}
+#else
+// sys32_recvmsg (64-bit)
+//
+sys32_long_t sys32_recvmsg(sys32_context_t context, sys32_int_t fd, sys32_msghdr_t* msg, sys32_uint_t flags)
+{
+	if(msg == nullptr) return -LINUX_EFAULT;
+	if(msg->msg_iovlen > LINUX_UIO_MAXIOV) return -LINUX_EMSGSIZE;
+
+	// uapi::iovec and sys32_iovec_t are not equivalent structures; iov array must be converted
+	HeapBuffer<uapi::iovec> vector(std::max(msg->msg_iovlen, 1UL));
+	for(size_t index = 0; index < msg->msg_iovlen; index++) {
+
+		vector[index].iov_base = reinterpret_cast<void*>(msg->msg_iov[index].iov_base);
+		vector[index].iov_len = static_cast<uapi::size_t>(msg->msg_iov[index].iov_len);
+	}
+
+	// Control messages are received into a local buffer that leaves the same amount of room for the
+	// data of a single message as the caller's buffer does, and are converted back afterwards
+	size_t capacity = (msg->msg_controllen > sizeof(sys32_cmsghdr_t)) ? (msg->msg_controllen - sizeof(sys32_cmsghdr_t) + sizeof(uapi::cmsghdr)) : 0;
+	HeapBuffer<uint8_t> control(std::max(capacity, static_cast<size_t>(1)));
+
+	uapi::msghdr header;
+	header.msg_name = reinterpret_cast<void*>(msg->msg_name);
+	header.msg_namelen = msg->msg_namelen;
+	header.msg_iov = vector;
+	header.msg_iovlen = msg->msg_iovlen;
+	header.msg_control = (capacity > 0) ? &control : nullptr;
+	header.msg_controllen = capacity;
+	header.msg_flags = msg->msg_flags;
+
+	sys32_long_t result = static_cast<sys32_long_t>(SystemCall::Invoke(sys_recvmsg, context, fd, &header, static_cast<int>(flags)));
+	if(result < 0) return result;
+
+	// uapi::cmsghdr and sys32_cmsghdr_t are not equivalent structures; convert each received control
+	// message into the caller's buffer and report MSG_CTRUNC for any that will not fit
+	size_t controllen = 0;
+	for(size_t offset = 0; offset + sizeof(uapi::cmsghdr) <= header.msg_controllen;) {
+
+		auto cmsg64 = reinterpret_cast<const uapi::cmsghdr*>(&control + offset);
+		size_t datalen = cmsg64->cmsg_len - sizeof(uapi::cmsghdr);
+
+		if(sizeof(sys32_cmsghdr_t) + datalen > msg->msg_controllen - controllen) { header.msg_flags |= LINUX_MSG_CTRUNC; break; }
+
+		auto cmsg = reinterpret_cast<sys32_cmsghdr_t*>(msg->msg_control + controllen);
+		cmsg->cmsg_len = static_cast<sys32_size_t>(sizeof(sys32_cmsghdr_t) + datalen);
+		cmsg->cmsg_level = cmsg64->cmsg_level;
+		cmsg->cmsg_type = cmsg64->cmsg_type;
+		memcpy(cmsg + 1, cmsg64 + 1, datalen);
+
+		controllen = std::min(controllen + align::up(cmsg->cmsg_len, sizeof(sys32_size_t)), static_cast<size_t>(msg->msg_controllen));
+		offset += align::up(cmsg64->cmsg_len, sizeof(uapi::size_t));
+	}
+
+	// Copy the updated fields back into the caller's structure
+	msg->msg_namelen = header.msg_namelen;
+	msg->msg_controllen = static_cast<sys32_size_t>(controllen);
+	msg->msg_flags = header.msg_flags;
+
+	return result;
+}
+
+#endif
+
+#ifdef _M_X64
+// sys64_recvmsg
+//
+sys64_long_t sys64_recvmsg(sys64_context_t context, sys64_int_t fd, sys64_msghdr_t* msg, sys64_uint_t flags)
+{
+	static_assert(sizeof(uapi::msghdr) == sizeof(sys64_msghdr_t), "uapi::msghdr is not equivalent to sys64_msghdr_t");
+
+	// The lengths were truncated to 32 bits to marshal the scatter/gather array and control messages
+	if((msg != nullptr) && ((msg->msg_iovlen_h != 0) || (msg->msg_controllen_h != 0))) return -LINUX_EINVAL;
+	return SystemCall::Invoke(sys_recvmsg, context, fd, reinterpret_cast<uapi::msghdr*>(msg), static_cast<int>(flags));
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "Process.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_sendfile
+//
+// Transfers data between two file descriptors without passing it through the caller
+//
+// Arguments:
+//
+//	context		- System call context object
+//	out_fd		- File descriptor open for writing
+//	in_fd		- File descriptor open for reading
+//	offset		- Optional input offset; the input file position is used if NULL
+//	count		- Number of bytes to transfer
+
+uapi::long_t sys_sendfile(const Context* context, int out_fd, int in_fd, uapi::loff_t* offset, size_t count)
+{
+	return -LINUX_ENOSYS;
+
+	//auto in = context->Process->Handle[in_fd];
+	//auto out = context->Process->Handle[out_fd];
+
+	//// The data is moved between the handles entirely within the service
+	//return static_cast<uapi::long_t>(FileSystem::CopyHandleData(in, offset, out, nullptr, count));
+}
+
+// sys32_sendfile
+//
+sys32_long_t sys32_sendfile(sys32_context_t context, sys32_int_t out_fd, sys32_int_t in_fd, sys32_off_t* offset, sys32_size_t count)
+{
+	// The 32-bit offset must be widened into a loff_t for the generic system call
+	uapi::loff_t position = (offset) ? *offset : 0;
+
+	sys32_long_t result = static_cast<sys32_long_t>(SystemCall::Invoke(sys_sendfile, context, out_fd, in_fd, (offset) ? &position : nullptr, count));
+	if((result >= 0) && (offset)) *offset = static_cast<sys32_off_t>(position);
+
+	return result;
+}
+
+#ifdef _M_X64
+// sys64_sendfile
+//
+sys64_long_t sys64_sendfile(sys64_context_t context, sys64_int_t out_fd, sys64_int_t in_fd, sys64_loff_t* offset, sys64_size_t count)
+{
+	return SystemCall::Invoke(sys_sendfile, context, out_fd, in_fd, offset, count);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,184 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "HeapBuffer.h"
+#include "Process.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_sendmsg
+//
+// Sends a message and any SCM_RIGHTS file descriptors on a socket
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Socket file descriptor
+//	msg			- Message header
+//	flags		- MSG_xxx flags
+
+uapi::long_t sys_sendmsg(const Context* context, int fd, const uapi::msghdr* msg, int flags)
+{
+	return -LINUX_ENOSYS;
+
+	//if(msg == nullptr) return -LINUX_EFAULT;
+
+	//auto socket = std::dynamic_pointer_cast<UnixSocket>(context->Process->Handle[fd]);
+	//if(!socket) return -LINUX_ENOTSOCK;
+
+	//// The scatter/gather array has been marshalled with the header, calculate the total length
+	//if(msg->msg_iovlen > LINUX_UIO_MAXIOV) return -LINUX_EMSGSIZE;
+	//auto iov = msg->msg_iov;
+
+	//size_t total = 0;
+	//for(size_t index = 0; index < msg->msg_iovlen; index++) total += iov[index].iov_len;
+
+	//// Gather the data from the calling process into a single intermediate buffer
+	//HeapBuffer<uint8_t> buffer(total);
+	//size_t offset = 0;
+	//for(size_t index = 0; index < msg->msg_iovlen; index++) 
+	//	offset += context->Process->ReadMemory(iov[index].iov_base, &buffer + offset, iov[index].iov_len);
+
+	//// SCM_RIGHTS control messages are converted into references to the calling process' handles
+	//UnixSocket::handlelist_t handles;
+	//if((msg->msg_control != nullptr) && (msg->msg_controllen > 0)) {
+
+	//	auto control = reinterpret_cast<uint8_t const*>(msg->msg_control);
+
+	//	size_t cmsgoffset = 0;
+	//	while(cmsgoffset + sizeof(uapi::cmsghdr) <= msg->msg_controllen) {
+
+	//		auto cmsg = reinterpret_cast<uapi::cmsghdr const*>(control + cmsgoffset);
+	//		if((cmsg->cmsg_len < sizeof(uapi::cmsghdr)) || (cmsg->cmsg_len > msg->msg_controllen - cmsgoffset)) return -LINUX_EINVAL;
+
+	//		if((cmsg->cmsg_level == LINUX_SOL_SOCKET) && (cmsg->cmsg_type == LINUX_SCM_RIGHTS)) {
+
+	//			auto fds = reinterpret_cast<int const*>(cmsg + 1);
+	//			for(size_t index = 0; index < (cmsg->cmsg_len - sizeof(uapi::cmsghdr)) / sizeof(int); index++) 
+	//				handles.push_back(context->Process->Handle[fds[index]]);
+	//		}
+
+	//		cmsgoffset += align::up(cmsg->cmsg_len, sizeof(uapi::size_t));
+	//	}
+	//}
+
+	//// An optional destination address can be provided for datagram sockets
+	//uapi::sockaddr_un address;
+	//if(msg->msg_name != nullptr) {
+
+	//	if((msg->msg_namelen < 0) || (msg->msg_namelen > sizeof(uapi::sockaddr_un))) return -LINUX_EINVAL;
+	//	context->Process->ReadMemory(msg->msg_name, &address, msg->msg_namelen);
+	//}
+
+	//// todo: EPIPE should also raise SIGPIPE unless MSG_NOSIGNAL was specified
+	//return static_cast<uapi::long_t>(socket->Send(&buffer, offset, flags, std::move(handles), 
+	//	(msg->msg_name != nullptr) ? &address : nullptr, msg->msg_namelen));
+}
+
+#ifndef _M_X64
+// sys32_sendmsg (32-bit)
+//
+sys32_long_t sys32_sendmsg(sys32_context_t context, sys32_int_t fd, const sys32_msghdr_t* msg, sys32_uint_t flags)
+{
+	static_assert(sizeof(uapi::msghdr) == sizeof(sys32_msghdr_t), "uapi::msghdr is not equivalent to sys32_msghdr_t");
+	return SystemCall::Invoke(sys_sendmsg, context, fd, reinterpret_cast<const uapi::msghdr*>(msg), static_cast<int>(flags));
+}
+#else
+// sys32_sendmsg (64-bit)
+//
+sys32_long_t sys32_sendmsg(sys32_context_t context, sys32_int_t fd, const sys32_msghdr_t* msg, sys32_uint_t flags)
+{
+	if(msg == nullptr) return -LINUX_EFAULT;
+	if(msg->msg_iovlen > LINUX_UIO_MAXIOV) return -LINUX_EMSGSIZE;
+
+	// uapi::iovec and sys32_iovec_t are not equivalent structures; iov array must be converted
+	HeapBuffer<uapi::iovec> vector(std::max(msg->msg_iovlen, 1UL));
+	for(size_t index = 0; index < msg->msg_iovlen; index++) {
+
+		vector[index].iov_base = reinterpret_cast<void*>(msg->msg_iov[index].iov_base);
+		vector[index].iov_len = static_cast<uapi::size_t>(msg->msg_iov[index].iov_len);
+	}
+
+	// uapi::cmsghdr and sys32_cmsghdr_t are not equivalent structures either, and the messages are 
+	// aligned differently; the length of the converted control messages has to be calculated first
+	size_t controllen = 0;
+	for(size_t offset = 0; offset + sizeof(sys32_cmsghdr_t) <= msg->msg_controllen;) {
+
+		auto cmsg = reinterpret_cast<const sys32_cmsghdr_t*>(msg->msg_control + offset);
+		if((cmsg->cmsg_len < sizeof(sys32_cmsghdr_t)) || (cmsg->cmsg_len > msg->msg_controllen - offset)) return -LINUX_EINVAL;
+
+		controllen += align::up(sizeof(uapi::cmsghdr) + (cmsg->cmsg_len - sizeof(sys32_cmsghdr_t)), sizeof(uapi::size_t));
+		offset += align::up(cmsg->cmsg_len, sizeof(sys32_size_t));
+	}
+
+	HeapBuffer<uint8_t> control(std::max(controllen, static_cast<size_t>(1)));
+	for(size_t offset = 0, converted = 0; converted < controllen;) {
+
+		auto cmsg = reinterpret_cast<const sys32_cmsghdr_t*>(msg->msg_control + offset);
+		auto cmsg64 = reinterpret_cast<uapi::cmsghdr*>(&control + converted);
+		size_t datalen = cmsg->cmsg_len - sizeof(sys32_cmsghdr_t);
+
+		cmsg64->cmsg_len = sizeof(uapi::cmsghdr) + datalen;
+		cmsg64->cmsg_level = cmsg->cmsg_level;
+		cmsg64->cmsg_type = cmsg->cmsg_type;
+		memcpy(cmsg64 + 1, cmsg + 1, datalen);
+
+		converted += align::up(cmsg64->cmsg_len, sizeof(uapi::size_t));
+		offset += align::up(cmsg->cmsg_len, sizeof(sys32_size_t));
+	}
+
+	uapi::msghdr header;
+	header.msg_name = reinterpret_cast<void*>(msg->msg_name);
+	header.msg_namelen = msg->msg_namelen;
+	header.msg_iov = vector;
+	header.msg_iovlen = msg->msg_iovlen;
+	header.msg_control = (controllen > 0) ? &control : nullptr;
+	header.msg_controllen = controllen;
+	header.msg_flags = msg->msg_flags;
+
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_sendmsg, context, fd, &header, static_cast<int>(flags)));
+}
+
+#endif
+
+#ifdef _M_X64
+// sys64_sendmsg
+//
+sys64_long_t sys64_sendmsg(sys64_context_t context, sys64_int_t fd, const sys64_msghdr_t* msg, sys64_uint_t flags)
+{
+	static_assert(sizeof(uapi::msghdr) == sizeof(sys64_msghdr_t), "uapi::msghdr is not equivalent to sys64_msghdr_t");
+
+	// The lengths were truncated to 32 bits to marshal the scatter/gather array and control messages
+	if((msg != nullptr) && ((msg->msg_iovlen_h != 0) || (msg->msg_controllen_h != 0))) return -LINUX_EINVAL;
+	return SystemCall::Invoke(sys_sendmsg, context, fd, reinterpret_cast<const uapi::msghdr*>(msg), static_cast<int>(flags));
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "Process.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_sendto
+//
+// Sends a message on a socket
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd			- Socket file descriptor
+//	buf			- Data to be sent
+//	len			- Length of the data to be sent
+//	flags		- MSG_xxx flags
+//	dest_addr	- Optional address of the destination socket
+//	addrlen		- Length of the destination socket address
+
+uapi::long_t sys_sendto(const Context* context, int fd, const void* buf, uapi::size_t len, int flags, const void* dest_addr, uint32_t addrlen)
+{
+	return -LINUX_ENOSYS;
+
+	//auto socket = std::dynamic_pointer_cast<UnixSocket>(context->Process->Handle[fd]);
+	//if(!socket) return -LINUX_ENOTSOCK;
+
+	//// todo: EPIPE should also raise SIGPIPE unless MSG_NOSIGNAL was specified
+	//return static_cast<uapi::long_t>(socket->Send(buf, len, flags, UnixSocket::handlelist_t(), reinterpret_cast<const uapi::sockaddr_un*>(dest_addr), addrlen));
+}
+
+// sys32_sendto
+//
+sys32_long_t sys32_sendto(sys32_context_t context, sys32_int_t fd, const sys32_uchar_t* buf, sys32_size_t len, sys32_uint_t flags, const sys32_uchar_t* dest_addr, sys32_uint_t addrlen)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_sendto, context, fd, buf, len, static_cast<int>(flags), dest_addr, addrlen));
+}
+
+#ifdef _M_X64
+// sys64_sendto
+//
+sys64_long_t sys64_sendto(sys64_context_t context, sys64_int_t fd, const sys64_uchar_t* buf, sys64_sizeis_t len, sys64_uint_t flags, const sys64_uchar_t* dest_addr, sys64_uint_t addrlen)
+{
+	return SystemCall::Invoke(sys_sendto, context, fd, buf, len, static_cast<int>(flags), dest_addr, addrlen);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
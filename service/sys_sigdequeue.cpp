@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "Thread.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_sigdequeue
+//
+// Dequeues the next deliverable signal for the calling thread
+//
+// Arguments:
+//
+//	context		- System call context object
+//	blocked		- Blocked signal mask of the calling thread
+//	siginfo		- Receives the dequeued signal information
+//	action		- Receives the action to take for the dequeued signal
+
+uapi::long_t sys_sigdequeue(const Context* context, uapi::sigset_t blocked, uapi::siginfo* siginfo, uapi::sigaction* action)
+{
+	// The 32-bit context handle is a SystemCallContext instance (see sys32_exit)
+	auto thread = reinterpret_cast<const SystemCallContext*>(context)->Thread;
+	if(thread == nullptr) return 0;
+
+	// Dequeue the next signal and the action to take for it, zero indicates that
+	// there were no deliverable signals pending for the thread
+	return thread->DequeueSignal(blocked, siginfo, action);
+}
+
+// sys32_sigdequeue
+//
+sys32_long_t sys32_sigdequeue(sys32_context_t context, sys32_sigset_t blocked, sys32_siginfo_t* siginfo, sys32_sigaction_t* action)
+{
+	uapi::sigaction				sigaction;			// Action to be converted
+
+	static_assert(sizeof(uapi::siginfo) == sizeof(sys32_siginfo_t), "uapi::siginfo is not equivalent to sys32_siginfo_t");
+
+	memset(siginfo, 0, sizeof(sys32_siginfo_t));
+	memset(&sigaction, 0, sizeof(uapi::sigaction));
+	sys32_long_t result = static_cast<sys32_long_t>(SystemCall::Invoke(sys_sigdequeue, context, blocked, reinterpret_cast<uapi::siginfo*>(siginfo), &sigaction));
+
+	// Convert the signal action into the 32-bit structure
+	action->sa_handler = static_cast<sys32_addr_t>(reinterpret_cast<uintptr_t>(sigaction.sa_handler));
+	action->sa_flags = static_cast<sys32_ulong_t>(sigaction.sa_flags);
+	action->sa_restorer = static_cast<sys32_addr_t>(reinterpret_cast<uintptr_t>(sigaction.sa_restorer));
+	action->sa_mask = sigaction.sa_mask;
+
+	return result;
+}
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
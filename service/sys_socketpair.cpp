@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "Process.h"
+#include "UnixSocket.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_socketpair
+//
+// Creates a pair of connected sockets
+//
+// Arguments:
+//
+//	context		- System call context object
+//	domain		- Communication domain (address family)
+//	type		- Socket type and SOCK_CLOEXEC/SOCK_NONBLOCK flags
+//	protocol	- Protocol to be used with the sockets
+//	sv			- Receives the file descriptors of the connected sockets
+
+uapi::long_t sys_socketpair(const Context* context, int domain, int type, int protocol, int* sv)
+{
+	return -LINUX_ENOSYS;
+
+	//if(sv == nullptr) return -LINUX_EFAULT;
+
+	//// todo: only AF_UNIX sockets are implemented
+	//if(domain != LINUX_AF_UNIX) return -LINUX_EAFNOSUPPORT;
+	//if(type & ~(LINUX_SOCK_TYPE_MASK | LINUX_SOCK_CLOEXEC | LINUX_SOCK_NONBLOCK)) return -LINUX_EINVAL;
+	//if(protocol != 0) return -LINUX_EPROTONOSUPPORT;
+
+	//uapi::ucred credentials{ context->Process->ProcessId, context->UserId, context->GroupId };
+	//auto pair = UnixSocket::CreatePair(type & LINUX_SOCK_TYPE_MASK, FileSystem::HandleFlags(type & LINUX_SOCK_NONBLOCK), credentials);
+
+	//// Both sockets must be added to the process before the descriptors are reported back
+	//int first = context->Process->AddHandle(pair.first, (type & LINUX_SOCK_CLOEXEC) == LINUX_SOCK_CLOEXEC);
+	//try { sv[1] = context->Process->AddHandle(pair.second, (type & LINUX_SOCK_CLOEXEC) == LINUX_SOCK_CLOEXEC); }
+	//catch(...) { context->Process->RemoveHandle(first); throw; }
+
+	//sv[0] = first;
+	//return 0;
+}
+
+// sys32_socketpair
+//
+sys32_long_t sys32_socketpair(sys32_context_t context, sys32_int_t domain, sys32_int_t type, sys32_int_t protocol, sys32_int_t* sv)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_socketpair, context, domain, type, protocol, sv));
+}
+
+#ifdef _M_X64
+// sys64_socketpair
+//
+sys64_long_t sys64_socketpair(sys64_context_t context, sys64_int_t domain, sys64_int_t type, sys64_int_t protocol, sys64_int_t* sv)
+{
+	return SystemCall::Invoke(sys_socketpair, context, domain, type, protocol, sv);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "Process.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_splice
+//
+// Moves data between two file descriptors, one of which must refer to a pipe
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fd_in		- File descriptor open for reading
+//	off_in		- Optional input offset; must be NULL if fd_in refers to a pipe
+//	fd_out		- File descriptor open for writing
+//	off_out		- Optional output offset; must be NULL if fd_out refers to a pipe
+//	len			- Number of bytes to transfer
+//	flags		- SPLICE_F_xxx flags
+
+uapi::long_t sys_splice(const Context* context, int fd_in, uapi::loff_t* off_in, int fd_out, uapi::loff_t* off_out, size_t len, unsigned int flags)
+{
+	return -LINUX_ENOSYS;
+
+	//if(flags & ~LINUX_SPLICE_F_ALL) return -LINUX_EINVAL;
+
+	//auto in = context->Process->Handle[fd_in];
+	//auto out = context->Process->Handle[fd_out];
+
+	//// todo: verify that at least one of the handles refers to a pipe and that the offset for
+	//// that handle is NULL (ESPIPE); the transfer itself is the same as sendfile/copy_file_range
+	//return static_cast<uapi::long_t>(FileSystem::CopyHandleData(in, off_in, out, off_out, len));
+}
+
+// sys32_splice
+//
+sys32_long_t sys32_splice(sys32_context_t context, sys32_int_t fd_in, sys32_loff_t* off_in, sys32_int_t fd_out, sys32_loff_t* off_out, sys32_size_t len, sys32_uint_t flags)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_splice, context, fd_in, off_in, fd_out, off_out, len, flags));
+}
+
+#ifdef _M_X64
+// sys64_splice
+//
+sys64_long_t sys64_splice(sys64_context_t context, sys64_int_t fd_in, sys64_loff_t* off_in, sys64_int_t fd_out, sys64_loff_t* off_out, sys64_size_t len, sys64_uint_t flags)
+{
+	return SystemCall::Invoke(sys_splice, context, fd_in, off_in, fd_out, off_out, len, flags);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SystemCall.h"
+
+#include "SystemCallContext.h"
+#include "FileSystem.h"
+#include "Process.h"
+
+#pragma warning(push, 4)
+
+//-----------------------------------------------------------------------------
+// sys_tee
+//
+// Duplicates data from one pipe into another without consuming it
+//
+// Arguments:
+//
+//	context		- System call context object
+//	fdin		- File descriptor of the input pipe
+//	fdout		- File descriptor of the output pipe
+//	len			- Maximum number of bytes to duplicate
+//	flags		- SPLICE_F_xxx flags
+
+uapi::long_t sys_tee(const Context* context, int fdin, int fdout, size_t len, unsigned int flags)
+{
+	return -LINUX_ENOSYS;
+
+	//if(flags & ~LINUX_SPLICE_F_ALL) return -LINUX_EINVAL;
+
+	//// todo: tee() requires both descriptors to refer to pipes and a non-consuming read from
+	//// the input pipe; until pipe handles exist neither descriptor can satisfy the requirement
+	//return -LINUX_EINVAL;
+}
+
+// sys32_tee
+//
+sys32_long_t sys32_tee(sys32_context_t context, sys32_int_t fdin, sys32_int_t fdout, sys32_size_t len, sys32_uint_t flags)
+{
+	return static_cast<sys32_long_t>(SystemCall::Invoke(sys_tee, context, fdin, fdout, len, flags));
+}
+
+#ifdef _M_X64
+// sys64_tee
+//
+sys64_long_t sys64_tee(sys64_context_t context, sys64_int_t fdin, sys64_int_t fdout, sys64_size_t len, sys64_uint_t flags)
+{
+	return SystemCall::Invoke(sys_tee, context, fdin, fdout, len, flags);
+}
+#endif
+
+//---------------------------------------------------------------------------
+
+#pragma warning(pop)
@@ -23,6 +23,13 @@
 #include "stdafx.h"
 #include "SystemCall.h"
 
+#include "SystemCallContext.h"
+#include "Namespace.h"
+#include "Pid.h"
+#include "PidNamespace.h"
+#include "Process.h"
+#include "Thread.h"
+
 #pragma warning(push, 4)
 
 //-----------------------------------------------------------------------------
@@ -39,14 +46,29 @@
 
 uapi::long_t sys_tgkill(const Context* context, uapi::pid_t tgid, uapi::pid_t pid, int sig)
 {
-	return -LINUX_ENOSYS;
+	uapi::siginfo			siginfo;			// Signal information
+
+	if((tgid <= 0) || (pid <= 0) || (sig < 0) || (sig > LINUX__NSIG)) return -LINUX_EINVAL;
+
+	// The 32-bit context handle is a SystemCallContext instance (see sys32_exit)
+	auto caller = reinterpret_cast<const SystemCallContext*>(context)->Process;
+	if(caller == nullptr) return -LINUX_ESRCH;
+
+	// Target identifiers are interpreted in the pid namespace of the caller
+	auto pids = caller->Namespace->Pids;
+
+	// The thread must exist and must be a member of the specified thread group
+	auto thread = pids->FindThread(pid);
+	if((thread == nullptr) || (thread->Process->ProcessId->getValue(pids) != tgid)) return -LINUX_ESRCH;
 
-	//(context);
-	//(tgid);
-	//(pid);
-	//(sig);
+	memset(&siginfo, 0, sizeof(uapi::siginfo));
+	siginfo.si_signo = sig;
+	siginfo.si_code = LINUX_SI_TKILL;
+	siginfo.linux_si_pid = caller->ProcessId->getValue(pids);
+	siginfo.linux_si_uid = 0;
 
-	//return 0;
+	if(sig) thread->Signal(siginfo);
+	return 0;
 }
 
 // sys32_tgkill
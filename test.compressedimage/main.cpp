@@ -0,0 +1,225 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+
+#include <string>
+#include <vector>
+#include <linux/stat.h>
+#include "CompressedImage.h"
+#include "CompressedImageWriter.h"
+
+// CHECK
+//
+// Reports a failed test condition and counts the failure
+#define CHECK(condition) \
+	if(!(condition)) { fprintf(stderr, "FAILED (line %d): %s\n", __LINE__, #condition); ++g_failures; }
+
+// g_failures
+//
+// Number of failed test conditions
+static int g_failures = 0;
+
+// BLOCK_SHIFT
+//
+// Data block size of the test image, as a power of two (4 KiB)
+static const uint16_t BLOCK_SHIFT = 12;
+
+//-----------------------------------------------------------------------------
+// GenerateData
+//
+// Generates file data that spans several blocks: a compressible block, an
+// incompressible block, a sparse block and a partial final block
+//
+// Arguments:
+//
+//	NONE
+
+static std::vector<uint8_t> GenerateData(void)
+{
+	const size_t blocksize = static_cast<size_t>(1) << BLOCK_SHIFT;
+	std::vector<uint8_t> data(blocksize * 4 + 100, 0);
+
+	uint32_t seed = 0x12345678;
+	for(size_t index = 0; index < data.size(); index++) {
+
+		seed = (seed * 1103515245) + 12345;
+
+		// Block 0 and block 3 repeat a short pattern, block 1 and the final partial
+		// block are pseudo-random and block 2 is left as zeros
+		switch(index / blocksize) {
+
+			case 0: case 3: data[index] = static_cast<uint8_t>(index % 7); break;
+			case 1: case 4: data[index] = static_cast<uint8_t>(seed >> 16); break;
+		}
+	}
+
+	return data;
+}
+
+//-----------------------------------------------------------------------------
+// ReadAll
+//
+// Reads the entire contents of a file node, using an odd transfer size so that
+// reads span block boundaries
+//
+// Arguments:
+//
+//	image		- Image instance
+//	node		- File node table entry
+
+static std::vector<uint8_t> ReadAll(CompressedImage& image, const image_node_t& node)
+{
+	std::vector<uint8_t> result;
+	uint8_t buffer[1000];
+
+	size_t read = 0;
+	while((read = image.Read(node, result.size(), buffer, sizeof(buffer))) > 0) result.insert(result.end(), buffer, buffer + read);
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// main
+//
+// Builds an image with CompressedImageWriter and verifies that CompressedImage
+// reads back the same tree
+//
+// Arguments:
+//
+//	argc		- Number of command line arguments
+//	argv		- Command line arguments
+
+int main(int argc, char** argv)
+{
+	UNREFERENCED_PARAMETER(argc);
+	UNREFERENCED_PARAMETER(argv);
+
+	const char text[] = "The quick brown fox jumps over the lazy dog.\n";
+	auto bigdata = GenerateData();
+
+	CompressedImageWriter writer(BLOCK_SHIFT);
+
+	uint32_t root = writer.AddDirectory(0755, 0, 0, 1000);
+	uint32_t subdir = writer.AddDirectory(0700, 1, 2, 2000);
+	uint32_t textfile = writer.AddFile(0644, 0, 0, 3000, text, sizeof(text) - 1);
+	uint32_t bigfile = writer.AddFile(0600, 0, 0, 4000, bigdata.data(), bigdata.size());
+	uint32_t emptyfile = writer.AddFile(0644, 0, 0, 5000, nullptr, 0);
+	uint32_t link = writer.AddSymbolicLink(0777, 0, 0, 6000, "../a.txt");
+	uint32_t device = writer.AddSpecialFile(LINUX_S_IFCHR | 0666, 0, 0, 7000, 0x0103);
+
+	// Names are chosen to exercise the byte order of the directory entries
+	writer.Link(root, "a.txt", textfile);
+	writer.Link(root, "ab", emptyfile);
+	writer.Link(root, "B", bigfile);
+	writer.Link(root, "\xC3\xA9", subdir);
+	writer.Link(subdir, "link", link);
+	writer.Link(subdir, "null", device);
+	writer.Link(subdir, "hardlink", textfile);
+
+	auto data = writer.Write(root);
+
+	// Use a single cached block so that the cache has to evict blocks
+	CompressedImage image(data.data(), data.size(), 1);
+
+	CHECK(image.BlockSize == (static_cast<size_t>(1) << BLOCK_SHIFT));
+	CHECK(image.NodeCount == 7);
+	CHECK(image.RootNode == root);
+
+	auto const& rootnode = image.GetNode(image.RootNode);
+	CHECK((rootnode.mode & LINUX_S_IFMT) == LINUX_S_IFDIR);
+	CHECK((rootnode.mode & ~LINUX_S_IFMT) == 0755);
+	CHECK(rootnode.mtime == 1000);
+	CHECK(rootnode.size == 4);
+	CHECK(rootnode.nlink == 3);
+
+	// Directory entries must be sorted in byte order, shorter names first
+	const char* expected[] = { "B", "a.txt", "ab", "\xC3\xA9" };
+	for(uint64_t index = 0; index < rootnode.size; index++) {
+
+		auto const& entry = image.GetDirectoryEntry(rootnode, index);
+		CHECK(std::string(image.GetName(entry.name, entry.namelength), entry.namelength) == expected[index]);
+	}
+
+	uint32_t found = 0;
+	CHECK(image.Lookup(rootnode, "a.txt", 5, &found) && (found == textfile));
+	CHECK(image.Lookup(rootnode, "B", 1, &found) && (found == bigfile));
+	CHECK(image.Lookup(rootnode, "ab", 2, &found) && (found == emptyfile));
+	CHECK(image.Lookup(rootnode, "\xC3\xA9", 2, &found) && (found == subdir));
+	CHECK(!image.Lookup(rootnode, "a.tx", 4, &found));
+	CHECK(!image.Lookup(rootnode, "b", 1, &found));
+
+	// Small file, stored as a single partial block
+	auto const& textnode = image.GetNode(textfile);
+	CHECK((textnode.mode & LINUX_S_IFMT) == LINUX_S_IFREG);
+	CHECK(textnode.nlink == 2);
+	auto textread = ReadAll(image, textnode);
+	CHECK(std::string(textread.begin(), textread.end()) == text);
+
+	// Multiple block file; compressed, uncompressed, sparse and partial blocks
+	auto const& bignode = image.GetNode(bigfile);
+	CHECK(bignode.size == bigdata.size());
+	CHECK(ReadAll(image, bignode) == bigdata);
+
+	uint8_t buffer[100];
+	CHECK(image.Read(bignode, bignode.size, buffer, sizeof(buffer)) == 0);
+	CHECK(image.Read(bignode, bignode.size - 10, buffer, sizeof(buffer)) == 10);
+	CHECK(memcmp(buffer, bigdata.data() + bigdata.size() - 10, 10) == 0);
+	CHECK(image.Read(bignode, image.BlockSize - 50, buffer, sizeof(buffer)) == sizeof(buffer));
+	CHECK(memcmp(buffer, bigdata.data() + image.BlockSize - 50, sizeof(buffer)) == 0);
+
+	// Empty file
+	auto const& emptynode = image.GetNode(emptyfile);
+	CHECK(emptynode.size == 0);
+	CHECK(image.Read(emptynode, 0, buffer, sizeof(buffer)) == 0);
+
+	// Subdirectory, symbolic link and special file
+	auto const& subdirnode = image.GetNode(subdir);
+	CHECK(subdirnode.uid == 1);
+	CHECK(subdirnode.gid == 2);
+	CHECK(subdirnode.nlink == 2);
+	CHECK(subdirnode.size == 3);
+
+	CHECK(image.Lookup(subdirnode, "link", 4, &found) && (found == link));
+	auto const& linknode = image.GetNode(link);
+	CHECK((linknode.mode & LINUX_S_IFMT) == LINUX_S_IFLNK);
+	CHECK(std::string(image.GetName(linknode.start, linknode.size), static_cast<size_t>(linknode.size)) == "../a.txt");
+
+	CHECK(image.Lookup(subdirnode, "null", 4, &found) && (found == device));
+	auto const& devicenode = image.GetNode(device);
+	CHECK((devicenode.mode & LINUX_S_IFMT) == LINUX_S_IFCHR);
+	CHECK(devicenode.rdev == 0x0103);
+
+	// Damaged images must be rejected
+	auto badmagic = data;
+	badmagic[0] ^= 0xFF;
+	try { CompressedImage bad(badmagic.data(), badmagic.size(), 1); CHECK(false); }
+	catch(Exception&) { /* expected */ }
+
+	try { CompressedImage bad(data.data(), sizeof(image_header_t) + 8, 1); CHECK(false); }
+	catch(Exception&) { /* expected */ }
+
+	if(g_failures == 0) printf("CompressedImage: all tests passed\n");
+	return (g_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//-----------------------------------------------------------------------------
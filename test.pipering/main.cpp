@@ -0,0 +1,229 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "stdafx.h"
+
+#include "PipeRing.h"
+
+// CHECK
+//
+// Reports a failed test condition and counts the failure
+#define CHECK(condition) \
+	if(!(condition)) { fprintf(stderr, "FAILED (line %d): %s\n", __LINE__, #condition); ++g_failures; }
+
+// g_failures
+//
+// Number of failed test conditions
+static int g_failures = 0;
+
+// CAPACITY
+//
+// Capacity of the test ring data area
+static const size_t CAPACITY = 4096;
+
+// PRODUCER_OFFSET / CONSUMER_OFFSET
+//
+// Offsets of the free-running positions in the ring control structure, which
+// places the producer and consumer positions on the second and third cache lines
+static const size_t PRODUCER_OFFSET = 64;
+static const size_t CONSUMER_OFFSET = 128;
+
+//-----------------------------------------------------------------------------
+// SetPositions
+//
+// Overwrites the producer and consumer positions of a ring, as a misbehaving
+// process sharing the ring could
+//
+// Arguments:
+//
+//	base		- Base address of the ring memory block
+//	head		- New producer position
+//	tail		- New consumer position
+
+static void SetPositions(void* base, uint32_t head, uint32_t tail)
+{
+	uint8_t* block = reinterpret_cast<uint8_t*>(base);
+
+	reinterpret_cast<std::atomic<uint32_t>*>(block + PRODUCER_OFFSET)->store(head);
+	reinterpret_cast<std::atomic<uint32_t>*>(block + CONSUMER_OFFSET)->store(tail);
+}
+
+//-----------------------------------------------------------------------------
+// TestTransfer
+//
+// Moves a patterned stream of bytes through a ring from a producer thread to
+// a consumer thread with mismatched chunk sizes, so that the copies wrap around
+// the end of the data area at every possible offset
+//
+// Arguments:
+//
+//	base		- Base address of the ring memory block
+//	total		- Total number of bytes to transfer
+
+static void TestTransfer(void* base, size_t total)
+{
+	PipeRing producer(base);
+	PipeRing consumer(base);
+	size_t mismatch = total;
+
+	std::thread reader([&]() -> void {
+
+		std::vector<uint8_t> buffer(1021);
+		size_t received = 0;
+
+		while(received < total) {
+
+			size_t read = consumer.Read(buffer.data(), buffer.size());
+			for(size_t index = 0; index < read; index++) 
+				if((buffer[index] != static_cast<uint8_t>((received + index) % 251)) && (mismatch == total)) mismatch = received + index;
+
+			received += read;
+			if(read == 0) std::this_thread::yield();
+		}
+	});
+
+	std::vector<uint8_t> buffer(1499);
+	size_t sent = 0;
+
+	while(sent < total) {
+
+		size_t count = std::min(buffer.size(), total - sent);
+		for(size_t index = 0; index < count; index++) buffer[index] = static_cast<uint8_t>((sent + index) % 251);
+
+		for(size_t written = 0; written < count;) {
+
+			size_t result = producer.Write(buffer.data() + written, count - written, false);
+			if(result == 0) std::this_thread::yield();
+			written += result;
+		}
+
+		sent += count;
+	}
+
+	reader.join();
+	CHECK(mismatch == total);
+	CHECK(consumer.getAvailable() == 0);
+}
+
+//-----------------------------------------------------------------------------
+// main
+//
+// Executes the PipeRing tests.  The property accessors are called directly so
+// that the test can also be built with g++ using -D"__declspec(x)="
+//
+// Arguments:
+//
+//	NONE
+
+int main(int, char**)
+{
+	std::vector<uint64_t> block((PipeRing::RequiredLength(CAPACITY) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	void* base = block.data();
+
+	uint8_t data[CAPACITY * 2];
+	uint8_t buffer[CAPACITY * 2];
+	for(size_t index = 0; index < sizeof(data); index++) data[index] = static_cast<uint8_t>(index * 7);
+
+	// Initialization
+	CHECK(PipeRing::Initialize(nullptr, PipeRing::RequiredLength(CAPACITY)) == 0);
+	CHECK(PipeRing::Initialize(base, PipeRing::RequiredLength(CAPACITY) - 1) == 0);
+	CHECK(PipeRing::Initialize(base, PipeRing::RequiredLength(CAPACITY)) == CAPACITY);
+
+	PipeRing ring(base);
+	CHECK(ring.getCapacity() == CAPACITY);
+	CHECK(ring.getAvailable() == 0);
+	CHECK(ring.getFree() == CAPACITY);
+
+	// Open ends
+	ring.AddReader();
+	ring.AddWriter();
+	ring.AddWriter();
+	CHECK((ring.getReaders() == 1) && (ring.getWriters() == 2));
+	CHECK(ring.ReleaseWriter() == 1);
+	CHECK(ring.ReleaseReader() == 0);
+
+	// Empty ring
+	CHECK(ring.Read(buffer, sizeof(buffer)) == 0);
+	CHECK(ring.Peek(buffer, sizeof(buffer)) == 0);
+
+	// Partial writes stop at the capacity, whole writes are all or nothing
+	CHECK(ring.Write(data, 1000, false) == 1000);
+	CHECK(ring.Write(data, CAPACITY, true) == 0);
+	CHECK(ring.Write(data + 1000, CAPACITY, false) == CAPACITY - 1000);
+	CHECK(ring.getFree() == 0);
+	CHECK(ring.Write(data, 1, false) == 0);
+
+	// Peek does not release the data, Read does
+	CHECK(ring.Peek(buffer, 100) == 100);
+	CHECK(memcmp(buffer, data, 100) == 0);
+	CHECK(ring.getAvailable() == CAPACITY);
+	CHECK(ring.Read(buffer, 1500) == 1500);
+	CHECK(memcmp(buffer, data, 1500) == 0);
+	CHECK(ring.getAvailable() == CAPACITY - 1500);
+
+	// A write that wraps around the end of the data area and a read that follows it
+	CHECK(ring.Write(data + 5000, 1500, true) == 1500);
+	CHECK(ring.Read(buffer, sizeof(buffer)) == CAPACITY);
+	CHECK(memcmp(buffer, data + 1500, CAPACITY - 1500) == 0);
+	CHECK(memcmp(buffer + CAPACITY - 1500, data + 5000, 1500) == 0);
+	CHECK(ring.getReadPosition() == ring.getWritePosition());
+
+	// The free-running positions wrap around at 2^32
+	SetPositions(base, 0xFFFFFF00, 0xFFFFFF00);
+	CHECK(ring.Write(data, 1000, true) == 1000);
+	CHECK(ring.getWritePosition() == 1000 - 0x100);
+	CHECK(ring.getAvailable() == 1000);
+	CHECK(ring.Read(buffer, sizeof(buffer)) == 1000);
+	CHECK(memcmp(buffer, data, 1000) == 0);
+
+	// Positions further apart than the capacity must not overrun the data area
+	SetPositions(base, 100 + CAPACITY + 1, 100);
+	CHECK(ring.getAvailable() == 0);
+	CHECK(ring.getFree() == 0);
+	CHECK(ring.Peek(buffer, sizeof(buffer)) == 0);
+	CHECK(ring.Read(buffer, sizeof(buffer)) == 0);
+	CHECK(ring.Write(data, 1, false) == 0);
+
+	SetPositions(base, 100, 200);
+	CHECK(ring.getAvailable() == 0);
+	CHECK(ring.getFree() == 0);
+	CHECK(ring.Read(buffer, sizeof(buffer)) == 0);
+	CHECK(ring.Write(data, 1, false) == 0);
+
+	// Wait flags are consumed exactly once
+	SetPositions(base, 0, 0);
+	CHECK(!ring.ConsumeReadWait());
+	ring.PrepareReadWait();
+	CHECK(ring.ConsumeReadWait());
+	CHECK(!ring.ConsumeReadWait());
+	ring.PrepareWriteWait();
+	CHECK(ring.ConsumeWriteWait());
+	CHECK(!ring.ConsumeWriteWait());
+
+	// Concurrent producer and consumer
+	TestTransfer(base, 64 << 20);
+
+	if(g_failures == 0) printf("PipeRing: all tests passed\n");
+	return (g_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//-----------------------------------------------------------------------------